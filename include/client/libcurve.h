@@ -268,6 +268,18 @@ int AioWrite(int fd, CurveAioContext* aioctx);
  */
 int AioDiscard(int fd, CurveAioContext* aioctx);
 
+/**
+ * @brief Submit a batch of asynchronous requests
+ * @param fd file descriptor
+ * @param aioctxs async request contexts, op of each context decides whether
+ *        it's a read, write or discard, cb is called once for each context
+ * @param count number of contexts
+ * @return 0 means all contexts are submitted, otherwise none of them is
+ *         submitted, e.g. -LIBCURVE_ERROR::NOT_ALIGNED if any read/write
+ *         is not aligned
+ */
+int AioSubmit(int fd, CurveAioContext** aioctxs, size_t count);
+
 /**
  * 重命名文件
  * @param: userinfo是用户信息
@@ -537,6 +549,17 @@ class CurveClient {
      */
     virtual int AioDiscard(int fd, CurveAioContext* aioctx);
 
+    /**
+     * @brief Submit a batch of asynchronous requests
+     * @param fd file descriptor
+     * @param aioctxs async request contexts
+     * @param count number of contexts
+     * @param dataType type of user buffer
+     * @return return error code, 0(LIBCURVE_ERROR::OK) means success
+     */
+    virtual int AioSubmit(int fd, CurveAioContext** aioctxs, size_t count,
+                          UserDataType dataType);
+
     /**
      * 测试使用，设置fileclient
      * @param client 需要设置的fileclient
@@ -86,6 +86,54 @@ void ChunkServiceImpl::DeleteChunk(RpcController *controller,
     req->Process();
 }
 
+void ChunkServiceImpl::DeleteChunks(RpcController *controller,
+                                    const ChunkRequest *request,
+                                    ChunkResponse *response,
+                                    Closure *done) {
+    ChunkServiceClosure* closure =
+        new (std::nothrow) ChunkServiceClosure(inflightThrottle_,
+                                               request,
+                                               response,
+                                               done);
+    CHECK(nullptr != closure) << "new chunk service closure failed";
+
+    brpc::ClosureGuard doneGuard(closure);
+
+    if (inflightThrottle_->IsOverLoad()) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD);
+        LOG_EVERY_N(WARNING, 100)
+            << "DeleteChunks: "
+            << "too many inflight requests to process in chunkserver";
+        return;
+    }
+
+    if (request->optype() != CHUNK_OP_TYPE::CHUNK_OP_DELETE_BATCH
+        || request->chunkids_size() == 0) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+        LOG(ERROR) << "delete chunks failed, invalid request: "
+                   << request->ShortDebugString();
+        return;
+    }
+
+    // 判断copyset是否存在
+    auto nodePtr = copysetNodeManager_->GetCopysetNode(request->logicpoolid(),
+                                                       request->copysetid());
+    if (nullptr == nodePtr) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST);
+        LOG(WARNING) << "delete chunks failed, copyset node is not found:"
+                     << request->logicpoolid() << "," << request->copysetid();
+        return;
+    }
+
+    std::shared_ptr<BatchDeleteChunkRequest>
+        req = std::make_shared<BatchDeleteChunkRequest>(nodePtr,
+                                                        controller,
+                                                        request,
+                                                        response,
+                                                        doneGuard.release());
+    req->Process();
+}
+
 void ChunkServiceImpl::WriteChunk(RpcController *controller,
                                   const ChunkRequest *request,
                                   ChunkResponse *response,
@@ -305,6 +353,127 @@ void ChunkServiceImpl::RecoverChunk(RpcController *controller,
     req->Process();
 }
 
+void ChunkServiceImpl::CreateCloneChunks(RpcController *controller,
+                                         const ChunkRequest *request,
+                                         ChunkResponse *response,
+                                         Closure *done) {
+    ChunkServiceClosure* closure =
+        new (std::nothrow) ChunkServiceClosure(inflightThrottle_,
+                                               request,
+                                               response,
+                                               done);
+    CHECK(nullptr != closure) << "new chunk service closure failed";
+
+    brpc::ClosureGuard doneGuard(closure);
+
+    if (inflightThrottle_->IsOverLoad()) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD);
+        LOG_EVERY_N(WARNING, 100)
+            << "CreateCloneChunks: "
+            << "too many inflight requests to process in chunkserver";
+        return;
+    }
+
+    // 请求创建的chunk大小和copyset配置的大小不一致
+    if (request->optype() != CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH
+        || request->batchitems_size() == 0
+        || request->size() != maxChunkSize_) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+        LOG(ERROR) << "create clone chunks failed, invalid request: "
+                   << request->ShortDebugString()
+                   << " copyset size: " << maxChunkSize_;
+        return;
+    }
+
+    // 判断copyset是否存在
+    auto nodePtr = copysetNodeManager_->GetCopysetNode(request->logicpoolid(),
+                                                       request->copysetid());
+    if (nullptr == nodePtr) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST);
+        LOG(WARNING) << "create clone chunks failed, "
+                     << "copyset node is not found:"
+                     << request->logicpoolid() << "," << request->copysetid();
+        return;
+    }
+
+    std::shared_ptr<BatchCreateCloneChunkRequest>
+        req = std::make_shared<BatchCreateCloneChunkRequest>(
+            nodePtr, controller, request, response, doneGuard.release());
+    req->Process();
+}
+
+void ChunkServiceImpl::RecoverChunks(RpcController *controller,
+                                     const ChunkRequest *request,
+                                     ChunkResponse *response,
+                                     Closure *done) {
+    ChunkServiceClosure* closure =
+        new (std::nothrow) ChunkServiceClosure(inflightThrottle_,
+                                               request,
+                                               response,
+                                               done);
+    CHECK(nullptr != closure) << "new chunk service closure failed";
+
+    brpc::ClosureGuard doneGuard(closure);
+
+    if (inflightThrottle_->IsOverLoad()) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD);
+        LOG_EVERY_N(WARNING, 100)
+            << "RecoverChunks: "
+            << "too many inflight requests to process in chunkserver";
+        return;
+    }
+
+    // 判断request参数是否合法
+    bool valid = request->optype() == CHUNK_OP_TYPE::CHUNK_OP_RECOVER_BATCH
+        && request->batchitems_size() > 0;
+    for (int i = 0; valid && i < request->batchitems_size(); ++i) {
+        valid = CheckRequestOffsetAndLength(request->batchitems(i).offset(),
+                                            request->batchitems(i).size());
+    }
+    if (!valid) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST);
+        LOG(ERROR) << "recover chunks failed, invalid request: "
+                   << request->ShortDebugString()
+                   << " max size: " << maxChunkSize_;
+        return;
+    }
+
+    // 判断copyset是否存在
+    auto nodePtr = copysetNodeManager_->GetCopysetNode(request->logicpoolid(),
+                                                       request->copysetid());
+    if (nullptr == nodePtr) {
+        response->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_COPYSET_NOTEXIST);
+        LOG(WARNING) << "recover chunks failed, copyset node is not found:"
+                     << request->logicpoolid() << "," << request->copysetid();
+        return;
+    }
+
+    /**
+     * recover不走raft, 每个chunk拆成一个RecoverChunk子请求,
+     * 与单个chunk的RecoverChunk请求共用ReadChunkRequest的处理流程
+     */
+    BatchRecoverChunkContext *ctx = new BatchRecoverChunkContext(
+        request, response, doneGuard.release());
+    for (int i = 0; i < ctx->GetSubRequestNum(); ++i) {
+        ChunkServiceClosure* subClosure =
+            new (std::nothrow) ChunkServiceClosure(inflightThrottle_,
+                                                   ctx->GetSubRequest(i),
+                                                   ctx->GetSubResponse(i),
+                                                   ctx->NewSubRequestDone());
+        CHECK(nullptr != subClosure) << "new chunk service closure failed";
+        std::shared_ptr<ReadChunkRequest> req =
+            std::make_shared<ReadChunkRequest>(
+                nodePtr,
+                chunkServiceOptions_.cloneManager,
+                nullptr,
+                ctx->GetSubRequest(i),
+                ctx->GetSubResponse(i),
+                subClosure);
+        req->Process();
+    }
+    ctx->Release();
+}
+
 void ChunkServiceImpl::ReadChunkSnapshot(RpcController *controller,
                                          const ChunkRequest *request,
                                          ChunkResponse *response,
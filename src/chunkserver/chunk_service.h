@@ -48,6 +48,11 @@ class ChunkServiceImpl : public ChunkService {
                      ChunkResponse *response,
                      Closure *done);
 
+    void DeleteChunks(RpcController *controller,
+                      const ChunkRequest *request,
+                      ChunkResponse *response,
+                      Closure *done);
+
     void ReadChunk(RpcController *controller,
                    const ChunkRequest *request,
                    ChunkResponse *response,
@@ -81,6 +86,16 @@ class ChunkServiceImpl : public ChunkService {
                       ChunkResponse *response,
                       Closure *done);
 
+    void CreateCloneChunks(RpcController *controller,
+                           const ChunkRequest *request,
+                           ChunkResponse *response,
+                           Closure *done);
+
+    void RecoverChunks(RpcController *controller,
+                       const ChunkRequest *request,
+                       ChunkResponse *response,
+                       Closure *done);
+
     void GetChunkInfo(RpcController *controller,
                       const GetChunkInfoRequest *request,
                       GetChunkInfoResponse *response,
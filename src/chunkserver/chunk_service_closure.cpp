@@ -151,5 +151,70 @@ void ChunkServiceClosure::OnResonse() {
     }
 }
 
+BatchRecoverChunkContext::BatchRecoverChunkContext(
+    const ChunkRequest *request,
+    ChunkResponse *response,
+    google::protobuf::Closure *done)
+    : response_(response),
+      done_(done),
+      subRequests_(request->batchitems_size()),
+      subResponses_(request->batchitems_size()),
+      refCount_(1) {
+    for (int i = 0; i < request->batchitems_size(); ++i) {
+        const BatchChunkItem &item = request->batchitems(i);
+        ChunkRequest &subRequest = subRequests_[i];
+        subRequest.set_optype(CHUNK_OP_TYPE::CHUNK_OP_RECOVER);
+        subRequest.set_logicpoolid(request->logicpoolid());
+        subRequest.set_copysetid(request->copysetid());
+        subRequest.set_chunkid(item.chunkid());
+        subRequest.set_offset(item.offset());
+        subRequest.set_size(item.size());
+        subResponses_[i].set_status(
+            CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
+    }
+}
+
+google::protobuf::Closure *BatchRecoverChunkContext::NewSubRequestDone() {
+    refCount_.fetch_add(1, std::memory_order_relaxed);
+    return new SubRequestDone(this);
+}
+
+void BatchRecoverChunkContext::Release() {
+    if (refCount_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        OnAllDone();
+        delete this;
+    }
+}
+
+void BatchRecoverChunkContext::OnAllDone() {
+    brpc::ClosureGuard doneGuard(done_);
+
+    /**
+     * 每个chunk的结果放在batchStatus中; 如果有子请求因为leader变更
+     * 或者过载失败, 整个请求返回对应的错误, 由client重试整个请求
+     */
+    CHUNK_OP_STATUS status = CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS;
+    uint64_t appliedIndex = 0;
+    response_->clear_batchstatus();
+    response_->clear_batchaccessed();
+    for (const auto &subResponse : subResponses_) {
+        response_->add_batchstatus(subResponse.status());
+        response_->add_batchaccessed(subResponse.accessed());
+        if (subResponse.status() ==
+            CHUNK_OP_STATUS::CHUNK_OP_STATUS_REDIRECTED) {
+            status = CHUNK_OP_STATUS::CHUNK_OP_STATUS_REDIRECTED;
+        } else if (subResponse.status() ==
+                   CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD &&
+                   status == CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS) {
+            status = CHUNK_OP_STATUS::CHUNK_OP_STATUS_OVERLOAD;
+        }
+        if (subResponse.appliedindex() > appliedIndex) {
+            appliedIndex = subResponse.appliedindex();
+        }
+    }
+    response_->set_status(status);
+    response_->set_appliedindex(appliedIndex);
+}
+
 }  // namespace chunkserver
 }  // namespace curve
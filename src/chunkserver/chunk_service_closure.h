@@ -24,7 +24,9 @@
 #define SRC_CHUNKSERVER_CHUNK_SERVICE_CLOSURE_H_
 
 #include <brpc/closure_guard.h>
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include "proto/chunk.pb.h"
 #include "src/chunkserver/op_request.h"
@@ -87,6 +89,64 @@ class ChunkServiceClosure : public braft::Closure {
     uint64_t receivedTimeUs_;
 };
 
+/**
+ * 批量recover请求的上下文, 请求中的每个chunk拆成一个CHUNK_OP_RECOVER子请求
+ * 分别处理, 所有子请求都完成后按顺序汇总每个chunk的结果再返回
+ */
+class BatchRecoverChunkContext {
+ public:
+    BatchRecoverChunkContext(const ChunkRequest *request,
+                             ChunkResponse *response,
+                             google::protobuf::Closure *done);
+
+    ~BatchRecoverChunkContext() = default;
+
+    int GetSubRequestNum() const {
+        return subRequests_.size();
+    }
+
+    const ChunkRequest *GetSubRequest(int index) const {
+        return &subRequests_[index];
+    }
+
+    ChunkResponse *GetSubResponse(int index) {
+        return &subResponses_[index];
+    }
+
+    /**
+     * 生成一个子请求的回调, 子请求处理完成时调用
+     */
+    google::protobuf::Closure *NewSubRequestDone();
+
+    /**
+     * 所有子请求都发起之后调用, 最后一个完成的子请求负责返回并释放上下文
+     */
+    void Release();
+
+ private:
+    class SubRequestDone : public google::protobuf::Closure {
+     public:
+        explicit SubRequestDone(BatchRecoverChunkContext *ctx) : ctx_(ctx) {}
+        void Run() override {
+            std::unique_ptr<SubRequestDone> selfGuard(this);
+            ctx_->Release();
+        }
+
+     private:
+        BatchRecoverChunkContext *ctx_;
+    };
+
+    void OnAllDone();
+
+ private:
+    ChunkResponse *response_;
+    google::protobuf::Closure *done_;
+    std::vector<ChunkRequest> subRequests_;
+    std::vector<ChunkResponse> subResponses_;
+    // 未完成的子请求数, 加上发起子请求的流程本身
+    std::atomic<int> refCount_;
+};
+
 }  // namespace chunkserver
 }  // namespace curve
 
@@ -597,6 +597,10 @@ void ChunkServer::InitCopyerOptions(
     } else {
         copyerOptions->s3Client = std::make_shared<S3Adapter>();
     }
+    if (!conf->GetBoolValue("clone.s3_object_layout",
+        &copyerOptions->s3ObjectLayout)) {
+        copyerOptions->s3ObjectLayout = false;
+    }
 }
 
 void ChunkServer::InitCloneOptions(
@@ -636,6 +640,14 @@ void ChunkServer::InitHeartbeatOptions(
         &heartbeatOptions->intervalSec));
     LOG_IF(FATAL, !conf->GetUInt32Value("mds.heartbeat_timeout",
         &heartbeatOptions->timeout));
+    if (!conf->GetBoolValue("mds.heartbeat_delta_report",
+        &heartbeatOptions->enableDeltaReport)) {
+        heartbeatOptions->enableDeltaReport = false;
+    }
+    if (!conf->GetUInt32Value("mds.heartbeat_full_report_interval_s",
+        &heartbeatOptions->fullReportIntervalSec)) {
+        heartbeatOptions->fullReportIntervalSec = 300;
+    }
 }
 
 void ChunkServer::InitRegisterOptions(
@@ -21,6 +21,12 @@
  */
 
 #include "src/chunkserver/clone_copyer.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+
 #include "src/chunkserver/clone_core.h"
 
 namespace curve {
@@ -34,6 +40,54 @@ std::ostream& operator<<(std::ostream& out, const AsyncDownloadContext& rhs) {
     return out;
 }
 
+using curve::common::ObjectExtent;
+using curve::common::LayoutDecodeStatus;
+using curve::common::CompressType;
+using curve::common::Decompress;
+
+// 首次读取对象末尾的长度，足以容纳常见的layout
+const size_t kLayoutProbeSize = 4096;
+
+// 一次下载拆分为多个s3请求时，所有请求完成后再回调
+struct S3DownloadTracker {
+    S3DownloadTracker(DownloadClosure* closure, int count)
+        : done(closure), pending(count), failed(false) {}
+
+    void Finish(bool success) {
+        if (!success) {
+            failed.store(true);
+        }
+        if (pending.fetch_sub(1) == 1) {
+            brpc::ClosureGuard doneGuard(done);
+            if (failed.load()) {
+                done->SetFailed();
+            }
+        }
+    }
+
+    DownloadClosure* done;
+    std::atomic<int> pending;
+    std::atomic<bool> failed;
+};
+
+// 解压一个分片，把需要的区域拷贝到dest中
+bool DecompressPart(const std::vector<char>& data,
+                    const ObjectExtent& extent,
+                    uint32_t partSize,
+                    char* dest) {
+    if (extent.partOffset == 0 && extent.length == partSize) {
+        return Decompress(extent.compressType, data.data(), data.size(),
+                          dest, partSize);
+    }
+    std::unique_ptr<char[]> part(new char[partSize]);
+    if (!Decompress(extent.compressType, data.data(), data.size(),
+                    part.get(), partSize)) {
+        return false;
+    }
+    memcpy(dest, part.get() + extent.partOffset, extent.length);
+    return true;
+}
+
 struct CurveAioCombineContext {
     DownloadClosure* done;
     CurveAioContext curveCtx;
@@ -54,11 +108,15 @@ void CurveAioCallback(struct CurveAioContext* context) {
 
 OriginCopyer::OriginCopyer()
     : curveClient_(nullptr)
-    , s3Client_(nullptr) {}
+    , s3Client_(nullptr)
+    , s3ObjectLayout_(false)
+    , layoutCacheSize_(0) {}
 
 int OriginCopyer::Init(const CopyerOptions& options) {
     curveClient_ = options.curveClient;
     s3Client_ = options.s3Client;
+    s3ObjectLayout_ = options.s3ObjectLayout;
+    layoutCacheSize_ = options.layoutCacheSize;
     if (curveClient_ != nullptr) {
         int errorCode = curveClient_->Init(options.curveConf.c_str());
         if (errorCode != 0) {
@@ -113,7 +171,23 @@ void OriginCopyer::DownloadAsync(DownloadClosure* done) {
                           done);
         doneGuard.release();
     } else if (type == OriginType::S3Origin) {
-        DownloadFromS3(originPath, context->offset,
+        DownloadFromS3(originPath, 0, 0, context->offset,
+                       context->size, context->buf,
+                       done);
+        doneGuard.release();
+    } else if (type == OriginType::S3PackOrigin) {
+        std::string objectName;
+        uint64_t base = 0;
+        uint64_t length = 0;
+        bool parseSuccess = LocationOperator::ParseS3PackPath(
+            originPath, &objectName, &base, &length);
+        if (!parseSuccess || length == 0) {
+            LOG(ERROR) << "Parse s3 pack path failed."
+                       << "originPath: " << originPath;
+            done->SetFailed();
+            return;
+        }
+        DownloadFromS3(objectName, base, length, context->offset,
                        context->size, context->buf,
                        done);
         doneGuard.release();
@@ -125,6 +199,8 @@ void OriginCopyer::DownloadAsync(DownloadClosure* done) {
 }
 
 void OriginCopyer::DownloadFromS3(const string& objectName,
+                                 uint64_t base,
+                                 uint64_t objectLength,
                                  off_t off,
                                  size_t size,
                                  char* buf,
@@ -137,24 +213,177 @@ void OriginCopyer::DownloadFromS3(const string& objectName,
         return;
     }
 
+    // 对象不会带有layout时直接按原样读取，省去首次读取时对末尾的探测
+    std::shared_ptr<ChunkObjectLayout> layout;
+    if (s3ObjectLayout_ &&
+        GetObjectLayout(objectName, base, objectLength, &layout) != 0) {
+        done->SetFailed();
+        return;
+    }
+
+    // 稀疏或压缩存储的对象需要把chunk上的区域映射到对象上，全0的区域不用读取
+    std::vector<ObjectExtent> extents;
+    if (layout == nullptr) {
+        ObjectExtent extent;
+        extent.chunkOffset = off;
+        extent.objectOffset = base + off;
+        extent.length = size;
+        extent.hole = false;
+        extent.objectLength = size;
+        extent.compressType = CompressType::None;
+        extent.partOffset = 0;
+        extents.push_back(extent);
+    } else if (!layout->MapRange(off, size, &extents)) {
+        LOG(ERROR) << "Download range out of chunk object."
+                   << "object name: " << objectName
+                   << ", offset: " << off
+                   << ", size: " << size
+                   << ", chunk size: " << layout->GetChunkSize();
+        done->SetFailed();
+        return;
+    }
+
+    int count = 0;
+    for (const auto& extent : extents) {
+        if (extent.hole) {
+            memset(buf + extent.chunkOffset - off, 0, extent.length);
+        } else {
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+
+    auto tracker = std::make_shared<S3DownloadTracker>(done, count);
     GetObjectAsyncCallBack cb =
-        [=] (const S3Adapter* adapter,
-             const std::shared_ptr<GetObjectAsyncContext>& context) {
-            brpc::ClosureGuard doneGuard(done);
-            if (context->retCode != 0) {
-                done->SetFailed();
-            }
+        [tracker] (const S3Adapter* adapter,
+                   const std::shared_ptr<GetObjectAsyncContext>& context) {
+            tracker->Finish(context->retCode == 0);
         };
 
-    auto context = std::make_shared<GetObjectAsyncContext>();
-    context->key = objectName;
-    context->buf = buf;
-    context->offset = off;
-    context->len = size;
-    context->cb = cb;
-
-    s3Client_->GetObjectAsync(context);
     doneGuard.release();
+    for (const auto& extent : extents) {
+        if (extent.hole) {
+            continue;
+        }
+        char* dest = buf + extent.chunkOffset - off;
+        auto context = std::make_shared<GetObjectAsyncContext>();
+        // 去重存储的分片从以内容hash命名的对象中读取
+        context->key = extent.objectKey.empty() ? objectName
+                                                : extent.objectKey;
+        // pack中的chunk数据需要加上其在pack对象中的起始偏移
+        context->offset = extent.objectKey.empty() && layout != nullptr
+            ? base + extent.objectOffset : extent.objectOffset;
+        context->len = extent.objectLength;
+        if (extent.compressType == CompressType::None) {
+            context->buf = dest;
+            context->cb = cb;
+        } else {
+            // 压缩的分片先读到临时缓冲区，每个分片读完后立即解压
+            auto data = std::make_shared<std::vector<char>>(
+                extent.objectLength);
+            uint32_t partSize = layout->GetPartSize();
+            context->buf = data->data();
+            context->cb = [tracker, data, extent, partSize, dest] (
+                const S3Adapter* adapter,
+                const std::shared_ptr<GetObjectAsyncContext>& context) {
+                tracker->Finish(context->retCode == 0 &&
+                    DecompressPart(*data, extent, partSize, dest));
+            };
+        }
+        s3Client_->GetObjectAsync(context);
+    }
+}
+
+int OriginCopyer::GetObjectLayout(const string& objectName,
+                                  uint64_t base,
+                                  uint64_t objectLength,
+                                  std::shared_ptr<ChunkObjectLayout>* layout) {
+    // pack对象中的每段chunk数据有各自的layout
+    std::string cacheKey = objectLength == 0 ? objectName :
+        objectName + ":" + std::to_string(base) + ":" +
+        std::to_string(objectLength);
+    {
+        std::unique_lock<std::mutex> lock(layoutMtx_);
+        auto iter = layoutMap_.find(cacheKey);
+        if (iter != layoutMap_.end()) {
+            layoutList_.splice(layoutList_.begin(), layoutList_,
+                               iter->second);
+            *layout = iter->second->second;
+            return 0;
+        }
+    }
+
+    std::string tail;
+    if (GetObjectTail(objectName, base, objectLength,
+                      kLayoutProbeSize, &tail) != 0) {
+        return -1;
+    }
+    ChunkObjectLayout decoded;
+    size_t needLen = 0;
+    LayoutDecodeStatus status = ChunkObjectLayout::Decode(
+        tail.data(), tail.size(), &decoded, &needLen);
+    if (status == LayoutDecodeStatus::NeedMore &&
+        tail.size() >= kLayoutProbeSize) {
+        if (GetObjectTail(objectName, base, objectLength,
+                          needLen, &tail) != 0) {
+            return -1;
+        }
+        status = ChunkObjectLayout::Decode(
+            tail.data(), tail.size(), &decoded, &needLen);
+    }
+
+    if (status == LayoutDecodeStatus::OK) {
+        *layout = std::make_shared<ChunkObjectLayout>(decoded);
+    } else if (status == LayoutDecodeStatus::NotLayout) {
+        *layout = nullptr;
+    } else {
+        LOG(ERROR) << "Decode layout of s3 object failed."
+                   << "object name: " << cacheKey
+                   << ", status: " << static_cast<int>(status);
+        return -1;
+    }
+
+    std::unique_lock<std::mutex> lock(layoutMtx_);
+    auto iter = layoutMap_.find(cacheKey);
+    if (iter != layoutMap_.end()) {
+        // 并发读取同一个对象时已被其他请求缓存
+        layoutList_.splice(layoutList_.begin(), layoutList_, iter->second);
+        iter->second->second = *layout;
+        return 0;
+    }
+    layoutList_.emplace_front(cacheKey, *layout);
+    layoutMap_[cacheKey] = layoutList_.begin();
+    while (layoutMap_.size() > layoutCacheSize_) {
+        layoutMap_.erase(layoutList_.back().first);
+        layoutList_.pop_back();
+    }
+    return 0;
+}
+
+int OriginCopyer::GetObjectTail(const string& objectName,
+                                uint64_t base,
+                                uint64_t objectLength,
+                                size_t len,
+                                std::string* tail) {
+    int ret = 0;
+    if (objectLength == 0) {
+        ret = s3Client_->GetObjectTail(objectName, len, tail);
+    } else {
+        len = std::min<uint64_t>(len, objectLength);
+        tail->resize(len);
+        ret = s3Client_->GetObject(objectName, &(*tail)[0],
+                                   base + objectLength - len, len);
+    }
+    if (ret != 0) {
+        LOG(ERROR) << "Get tail of s3 object failed."
+                   << "object name: " << objectName
+                   << ", base: " << base
+                   << ", length: " << objectLength;
+        return -1;
+    }
+    return 0;
 }
 
 void OriginCopyer::DownloadFromCurve(const string& fileName,
@@ -24,9 +24,12 @@
 #define SRC_CHUNKSERVER_CLONE_COPYER_H_
 
 #include <glog/logging.h>
+#include <list>
 #include <memory>
 #include <unordered_map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "include/chunkserver/chunkserver_common.h"
 #include "src/common/location_operator.h"
@@ -35,6 +38,7 @@
 #include "src/client/client_common.h"
 #include "include/client/libcurve.h"
 #include "src/common/s3_adapter.h"
+#include "src/common/chunk_object_layout.h"
 
 namespace curve {
 namespace chunkserver {
@@ -46,6 +50,7 @@ using curve::common::LocationOperator;
 using curve::common::OriginType;
 using curve::common::GetObjectAsyncCallBack;
 using curve::common::GetObjectAsyncContext;
+using curve::common::ChunkObjectLayout;
 using std::string;
 
 class DownloadClosure;
@@ -61,6 +66,11 @@ struct CopyerOptions {
     std::shared_ptr<FileClient> curveClient;
     // s3 adapter的对象指针
     std::shared_ptr<S3Adapter> s3Client;
+    // s3上的chunk数据末尾是否可能带有layout（稀疏、压缩或去重存储），
+    // 为false时按原样读取，不需要在首次读取对象时探测其末尾
+    bool s3ObjectLayout = false;
+    // 缓存的layout的最大条目数，超过后淘汰最久未使用的
+    uint32_t layoutCacheSize = 100000;
 };
 
 struct AsyncDownloadContext {
@@ -102,7 +112,17 @@ class OriginCopyer {
     virtual void DownloadAsync(DownloadClosure* done);
 
  private:
+    /**
+     * 从s3下载chunk数据
+     * @param objectName: 对象名
+     * @param base: chunk数据在对象中的起始偏移
+     * @param objectLength: chunk数据在对象中的长度，0表示整个对象
+     * @param off: 下载数据在chunk中的偏移
+     * @param size: 下载数据的长度
+     */
     void DownloadFromS3(const string& objectName,
+                       uint64_t base,
+                       uint64_t objectLength,
                        off_t off,
                        size_t size,
                        char* buf,
@@ -112,6 +132,27 @@ class OriginCopyer {
                           size_t size,
                           char* buf,
                           DownloadClosure* done);
+    /**
+     * 获取s3上chunk数据的layout，结果会被缓存
+     * @param objectName: 对象名
+     * @param base: chunk数据在对象中的起始偏移
+     * @param objectLength: chunk数据在对象中的长度，0表示整个对象
+     * @param[out] layout: chunk数据的layout，按chunk原样存储时返回nullptr
+     * @return: 成功返回0，失败返回-1
+     */
+    int GetObjectLayout(const string& objectName,
+                        uint64_t base,
+                        uint64_t objectLength,
+                        std::shared_ptr<ChunkObjectLayout>* layout);
+    /**
+     * 读取s3上chunk数据末尾的一段
+     * @param len: 读取的长度，超过chunk数据长度时读取全部数据
+     */
+    int GetObjectTail(const string& objectName,
+                      uint64_t base,
+                      uint64_t objectLength,
+                      size_t len,
+                      std::string* tail);
 
  private:
     // curvefs上的root用户信息
@@ -124,6 +165,20 @@ class OriginCopyer {
     std::mutex  mtx_;
     // 文件名->文件fd 的映射
     std::unordered_map<std::string, int> fdMap_;
+    // s3上的chunk数据是否可能带有layout
+    bool s3ObjectLayout_;
+    // 缓存的layout的最大条目数
+    uint32_t layoutCacheSize_;
+    // 保护layoutList_和layoutMap_的互斥锁
+    std::mutex  layoutMtx_;
+    // chunk数据的位置和layout，按最近使用的顺序排列，
+    // 按chunk原样存储时layout为nullptr
+    using LayoutItem =
+        std::pair<std::string, std::shared_ptr<ChunkObjectLayout>>;
+    std::list<LayoutItem> layoutList_;
+    // chunk数据的位置->layoutList_中的位置
+    std::unordered_map<std::string,
+                       std::list<LayoutItem>::iterator> layoutMap_;
 };
 
 }  // namespace chunkserver
@@ -166,6 +166,11 @@ int CloneCore::CloneReadByLocalInfo(
                     (chunkInfo.bitmap->NextClearBit(beginIndex, endIndex)
                      != Bitmap::NO_POS);
     if (needClone) {
+        if (CHUNK_OP_TYPE::CHUNK_OP_READ == request->optype()) {
+            RecordUserRead(request->chunkid());
+        } else if (IsUserRead(request->chunkid())) {
+            readRequest->response_->set_accessed(true);
+        }
         // TODO(yyk) 这一块可以优化，但是优化方法判断条件可能比较复杂
         // 目前只根据是否存在未写过的page来决定是否要触发拷贝
         // chunk中请求读取范围内的数据存在page未被写过，则需要从源端拷贝数据
@@ -187,6 +192,8 @@ int CloneCore::CloneReadByLocalInfo(
     // 执行到这一步说明不需要拷贝数据，如果是recover请求可以直接返回成功
     // 如果是ReadChunk请求，则直接读chunk并返回
     if (CHUNK_OP_TYPE::CHUNK_OP_RECOVER == request->optype()) {
+        // 请求区域已经被用户写过，snapshotcloneserver据此记录热点数据
+        readRequest->response_->set_accessed(true);
         SetResponse(readRequest, CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
     } else if (CHUNK_OP_TYPE::CHUNK_OP_READ == request->optype()) {
         // 出错或处理结束调用closure返回给用户
@@ -199,6 +206,11 @@ void CloneCore::CloneReadByRequestInfo(std::shared_ptr<ReadChunkRequest>
     readRequest, Closure* done) {
     brpc::ClosureGuard doneGuard(done);
     const ChunkRequest*  chunkRequest = readRequest->request_;
+    if (CHUNK_OP_TYPE::CHUNK_OP_READ == chunkRequest->optype()) {
+        RecordUserRead(chunkRequest->chunkid());
+    } else if (IsUserRead(chunkRequest->chunkid())) {
+        readRequest->response_->set_accessed(true);
+    }
 
     auto func = ::curve::common::LocationOperator::GenerateCurveLocation;
     std::string location = func(chunkRequest->clonefilesource(),
@@ -459,6 +471,23 @@ void CloneCore::PasteCloneData(std::shared_ptr<ReadChunkRequest> readRequest,
     req->Process();
 }
 
+void CloneCore::RecordUserRead(ChunkID id) {
+    std::lock_guard<std::mutex> lock(userReadMtx_);
+    if (!userReadChunks_.insert(id).second) {
+        return;
+    }
+    userReadOrder_.push_back(id);
+    if (userReadOrder_.size() > kMaxUserReadChunkNum) {
+        userReadChunks_.erase(userReadOrder_.front());
+        userReadOrder_.pop_front();
+    }
+}
+
+bool CloneCore::IsUserRead(ChunkID id) {
+    std::lock_guard<std::mutex> lock(userReadMtx_);
+    return userReadChunks_.count(id) > 0;
+}
+
 inline void CloneCore::SetResponse(
     std::shared_ptr<ReadChunkRequest> readRequest, CHUNK_OP_STATUS status) {
     auto applyIndex = readRequest->node_->GetAppliedIndex();
@@ -27,7 +27,10 @@
 #include <google/protobuf/message.h>
 #include <google/protobuf/stubs/callback.h>
 #include <brpc/controller.h>
+#include <deque>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_set>
 
 #include "proto/chunk.pb.h"
 #include "include/chunkserver/chunkserver_common.h"
@@ -190,13 +193,32 @@ class CloneCore : public std::enable_shared_from_this<CloneCore> {
     inline void SetResponse(std::shared_ptr<ReadChunkRequest> readRequest,
                             CHUNK_OP_STATUS status);
 
+    /**
+     * 记录被用户读过且需要从源端拷贝数据的clone chunk，
+     * 之后恢复该chunk时告知snapshotcloneserver该chunk是热点
+     * @param id: chunk id
+     */
+    void RecordUserRead(ChunkID id);
+
+    /**
+     * 判断chunk在恢复前是否被用户读过
+     * @param id: chunk id
+     */
+    bool IsUserRead(ChunkID id);
+
  private:
+    // 最多记录的被用户读过的chunk数量，超过后淘汰最早记录的chunk
+    static const size_t kMaxUserReadChunkNum = 100000;
     // 每次拷贝的slice的大小
     uint32_t sliceSize_;
     // 判断read chunk类型的请求是否需要paste, true需要paste，false表示不需要
     bool enablePaste_;
     // 负责从源端下载数据
     std::shared_ptr<OriginCopyer> copyer_;
+    // 被用户读过的clone chunk，按记录的先后顺序保存在userReadOrder_中
+    std::unordered_set<ChunkID> userReadChunks_;
+    std::deque<ChunkID> userReadOrder_;
+    std::mutex userReadMtx_;
 };
 
 }  // namespace chunkserver
@@ -257,8 +257,12 @@ void CopysetNode::on_apply(::braft::Iterator &iter) {
                                   opRequest,
                                   iter.index(),
                                   doneGuard.release());
-            concurrentapply_->Push(
-                opRequest->ChunkId(), opRequest->OpType(), task);
+            if (IsMultiChunkOp(opRequest->OpType())) {
+                ApplyMultiChunkOp(task);
+            } else {
+                concurrentapply_->Push(
+                    opRequest->ChunkId(), opRequest->OpType(), task);
+            }
         } else {
             // 获取log entry
             butil::IOBuf log = iter.data();
@@ -273,16 +277,30 @@ void CopysetNode::on_apply(::braft::Iterator &iter) {
             auto opReq = ChunkOpRequest::Decode(log, &request, &data,
                                                 iter.index(), GetLeaderId());
             auto chunkId = request.chunkid();
-            auto task = std::bind(&ChunkOpRequest::OnApplyFromLog,
+            auto opType = request.optype();
+            auto task = std::bind(&CopysetNode::ApplyOpFromLog,
+                                  this,
                                   opReq,
-                                  dataStore_,
                                   std::move(request),
-                                  data);
-            concurrentapply_->Push(chunkId, request.optype(), task);
+                                  data,
+                                  iter.index());
+            if (IsMultiChunkOp(opType)) {
+                ApplyMultiChunkOp(task);
+            } else {
+                concurrentapply_->Push(chunkId, opType, task);
+            }
         }
     }
 }
 
+void CopysetNode::ApplyOpFromLog(std::shared_ptr<ChunkOpRequest> opReq,
+                                 const ChunkRequest &request,
+                                 const butil::IOBuf &data,
+                                 uint64_t index) {
+    opReq->OnApplyFromLog(dataStore_, request, data);
+    UpdateAppliedIndex(index);
+}
+
 void CopysetNode::on_shutdown() {
     LOG(INFO) << GroupIdString() << " is shutdown";
 }
@@ -54,6 +54,7 @@ using ::curve::mds::heartbeat::ConfigChangeType;
 using ::curve::common::Peer;
 
 class CopysetNodeManager;
+class ChunkOpRequest;
 
 extern const char *kCurveConfEpochFilename;
 
@@ -225,6 +226,19 @@ class CopysetNode : public braft::StateMachine,
      */
     virtual uint64_t GetAppliedIndex() const;
 
+    /**
+     * 回放日志中的op，apply完成后推进applied index，
+     * follower上的读请求依据applied index判断本地数据是否足够新
+     * @param opReq: 从日志中反序列化得到的op
+     * @param request: 反序列化后得到的request
+     * @param data: 反序列化后得到的request要处理的数据
+     * @param index: op对应日志的index
+     */
+    void ApplyOpFromLog(std::shared_ptr<ChunkOpRequest> opReq,
+                        const ChunkRequest &request,
+                        const butil::IOBuf &data,
+                        uint64_t index);
+
     /**
      * @brief: 查询配置变更的状态
      * @param type[out]: 配置变更类型
@@ -411,6 +425,24 @@ class CopysetNode : public braft::StateMachine,
         return ToGroupIdString(logicPoolId_, copysetId_);
     }
 
+    /**
+     * 是否是涉及多个chunk的op, 这类op不能按chunk id分发到并发apply队列
+     */
+    static bool IsMultiChunkOp(CHUNK_OP_TYPE opType) {
+        return opType == CHUNK_OP_TYPE::CHUNK_OP_DELETE_BATCH
+            || opType == CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH;
+    }
+
+    /**
+     * 同步apply涉及多个chunk的op: 先等之前的op都apply完成再执行,
+     * 之后的op在执行完成后才会被分发, 保证同一个chunk上op的apply顺序
+     */
+    template<class F>
+    void ApplyMultiChunkOp(F &&task) {
+        concurrentapply_->Flush();
+        task();
+    }
+
  private:
     // 逻辑池 id
     LogicPoolID logicPoolId_;
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include "src/chunkserver/copyset_report_tracker.h"
+
+#include <glog/logging.h>
+
+namespace curve {
+namespace chunkserver {
+
+using curve::mds::heartbeat::HeartbeatStatusCode;
+
+void CopysetReportTracker::BeginReport(uint64_t nowSec,
+                                       HeartbeatRequest* request) {
+    pendingCopysets_.clear();
+    reportSec_ = nowSec;
+    fullReport_ = needFullReport_ || ackedVersion_ == 0 ||
+                  nowSec >= lastFullReportSec_ + fullReportIntervalSec_;
+
+    request->set_reportversion(ackedVersion_ + 1);
+    if (!fullReport_) {
+        request->set_baseversion(ackedVersion_);
+    }
+}
+
+void CopysetReportTracker::AddCopyset(
+    GroupNid groupId, const curve::mds::heartbeat::CopySetInfo& info,
+    bool valid, HeartbeatRequest* request) {
+    // io统计信息不参与比较
+    std::string state;
+    if (valid) {
+        curve::mds::heartbeat::CopySetInfo copy(info);
+        copy.clear_stats();
+        copy.SerializeToString(&state);
+    }
+
+    // 正在进行的配置变更每次都上报，mds据此跟踪变更进度
+    bool report = fullReport_ || !valid || info.has_configchangeinfo();
+    if (!report) {
+        auto iter = ackedCopysets_.find(groupId);
+        report = iter == ackedCopysets_.end() || iter->second != state;
+    }
+
+    pendingCopysets_[groupId] = std::move(state);
+    if (report) {
+        *request->add_copysetinfos() = info;
+    }
+}
+
+void CopysetReportTracker::EndReport(HeartbeatRequest* request) {
+    if (fullReport_) {
+        return;
+    }
+
+    for (const auto& item : ackedCopysets_) {
+        if (pendingCopysets_.count(item.first) == 0) {
+            auto removed = request->add_removedcopysets();
+            removed->set_logicalpoolid(GetPoolID(item.first));
+            removed->set_copysetid(GetCopysetID(item.first));
+        }
+    }
+}
+
+void CopysetReportTracker::OnReportAcked(const HeartbeatRequest& request,
+                                         const HeartbeatResponse& response) {
+    // mds拒绝了请求或者无法应用增量，下次全量上报
+    if (response.needfullreport() ||
+        (response.statuscode() != HeartbeatStatusCode::hbOK &&
+         response.statuscode() != HeartbeatStatusCode::hbRequestNoCopyset)) {
+        LOG(INFO) << "mds require full copyset report, status code: "
+                  << response.statuscode()
+                  << ", need full report: " << response.needfullreport();
+        needFullReport_ = true;
+        pendingCopysets_.clear();
+        return;
+    }
+
+    ackedCopysets_.swap(pendingCopysets_);
+    pendingCopysets_.clear();
+    ackedVersion_ = request.reportversion();
+    needFullReport_ = false;
+    if (fullReport_) {
+        lastFullReportSec_ = reportSec_;
+    }
+}
+
+void CopysetReportTracker::OnReportFailed() {
+    // mds可能已经应用了本次上报，下次增量的baseVersion与mds记录的版本
+    // 不一致时，mds会要求全量上报
+    pendingCopysets_.clear();
+}
+
+}  // namespace chunkserver
+}  // namespace curve
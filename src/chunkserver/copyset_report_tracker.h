@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#ifndef SRC_CHUNKSERVER_COPYSET_REPORT_TRACKER_H_
+#define SRC_CHUNKSERVER_COPYSET_REPORT_TRACKER_H_
+
+#include <string>
+#include <unordered_map>
+
+#include "include/chunkserver/chunkserver_common.h"
+#include "proto/heartbeat.pb.h"
+
+namespace curve {
+namespace chunkserver {
+
+using HeartbeatRequest  = curve::mds::heartbeat::ChunkServerHeartbeatRequest;
+using HeartbeatResponse = curve::mds::heartbeat::ChunkServerHeartbeatResponse;
+
+/**
+ * 记录已上报给mds的copyset状态，用于增量心跳
+ *
+ * 增量心跳中只上报相比mds已确认版本(baseVersion)发生变化的copyset，
+ * 以及被删除的copyset。以下情况发送全量心跳:
+ * 1. 第一次心跳，或者mds要求全量上报(mds重启、切换或丢失了某次心跳)
+ * 2. 距离上次全量上报超过fullReportIntervalSec
+ *
+ * copyset的io统计信息变化不算作状态变化，只在copyset有其他变化或
+ * 全量上报时更新到mds
+ */
+class CopysetReportTracker {
+ public:
+    explicit CopysetReportTracker(uint32_t fullReportIntervalSec)
+        : fullReportIntervalSec_(fullReportIntervalSec),
+          ackedVersion_(0),
+          lastFullReportSec_(0),
+          needFullReport_(true),
+          fullReport_(true),
+          reportSec_(0) {}
+
+    /**
+     * @brief 开始构建一次心跳的copyset信息
+     * @param[in] nowSec 当前时间
+     * @param[out] request 设置本次心跳的上报版本
+     */
+    void BeginReport(uint64_t nowSec, HeartbeatRequest* request);
+
+    /**
+     * @brief 将copyset信息加入心跳，全量上报或copyset有变化时才加入
+     * @param[in] groupId copyset的id
+     * @param[in] info 构建好的copyset信息
+     * @param[in] valid 构建copyset信息是否成功，不成功的下次总会上报
+     * @param[out] request 心跳请求
+     */
+    void AddCopyset(GroupNid groupId,
+                    const curve::mds::heartbeat::CopySetInfo& info,
+                    bool valid,
+                    HeartbeatRequest* request);
+
+    /**
+     * @brief 结束构建，增量心跳中加入被删除的copyset
+     * @param[out] request 心跳请求
+     */
+    void EndReport(HeartbeatRequest* request);
+
+    /**
+     * @brief 心跳发送成功后根据mds的回应更新已确认的状态
+     */
+    void OnReportAcked(const HeartbeatRequest& request,
+                       const HeartbeatResponse& response);
+
+    /**
+     * @brief 心跳发送失败，保持已确认的状态不变
+     */
+    void OnReportFailed();
+
+    bool IsFullReport() const {
+        return fullReport_;
+    }
+
+ private:
+    // 增量心跳开启时全量上报的间隔
+    const uint32_t fullReportIntervalSec_;
+    // 被mds确认的上报版本
+    uint64_t ackedVersion_;
+    // 上次全量上报的时间
+    uint64_t lastFullReportSec_;
+    // mds要求全量上报
+    bool needFullReport_;
+    // 本次心跳是否为全量上报
+    bool fullReport_;
+    // 本次心跳的构建时间
+    uint64_t reportSec_;
+    // 被mds确认的各copyset状态
+    std::unordered_map<GroupNid, std::string> ackedCopysets_;
+    // 本次心跳中各copyset的状态，mds确认后替换ackedCopysets_
+    std::unordered_map<GroupNid, std::string> pendingCopysets_;
+};
+
+}  // namespace chunkserver
+}  // namespace curve
+
+#endif  // SRC_CHUNKSERVER_COPYSET_REPORT_TRACKER_H_
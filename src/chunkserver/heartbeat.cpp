@@ -95,6 +95,13 @@ int Heartbeat::Init(const HeartbeatOptions &options) {
 
     // init scanManager
     scanMan_ = options.scanManager;
+
+    if (options_.enableDeltaReport) {
+        reportTracker_.reset(
+            new CopysetReportTracker(options_.fullReportIntervalSec));
+        LOG(INFO) << "Heartbeat delta report enabled, full report interval: "
+                  << options_.fullReportIntervalSec << "s";
+    }
     return 0;
 }
 
@@ -286,10 +293,23 @@ int Heartbeat::BuildRequest(HeartbeatRequest* req) {
     req->set_copysetcount(copysets.size());
     int leaders = 0;
 
+    if (reportTracker_ != nullptr) {
+        reportTracker_->BeginReport(
+            ::curve::common::TimeUtility::GetTimeofDaySec(), req);
+    }
+
     for (CopysetNodePtr copyset : copysets) {
-        curve::mds::heartbeat::CopySetInfo* info = req->add_copysetinfos();
+        // 增量心跳时先构建到临时变量中，由reportTracker_决定是否上报
+        curve::mds::heartbeat::CopySetInfo deltaInfo;
+        curve::mds::heartbeat::CopySetInfo* info =
+            reportTracker_ == nullptr ? req->add_copysetinfos() : &deltaInfo;
 
         ret = BuildCopysetInfo(info, copyset);
+        if (reportTracker_ != nullptr) {
+            reportTracker_->AddCopyset(
+                ToGroupNid(copyset->GetLogicPoolId(), copyset->GetCopysetId()),
+                *info, ret == 0, req);
+        }
         if (ret != 0) {
             LOG(ERROR) << "Failed to build heartbeat information of copyset "
                        << ToGroupIdStr(copyset->GetLogicPoolId(),
@@ -302,6 +322,10 @@ int Heartbeat::BuildRequest(HeartbeatRequest* req) {
     }
     req->set_leadercount(leaders);
 
+    if (reportTracker_ != nullptr) {
+        reportTracker_->EndReport(req);
+    }
+
     return 0;
 }
 
@@ -587,10 +611,17 @@ void Heartbeat::HeartbeatWorker() {
         ret = SendHeartbeat(req, &resp);
         if (ret != 0) {
             LOG(WARNING) << "Failed to send heartbeat to MDS";
+            if (reportTracker_ != nullptr) {
+                reportTracker_->OnReportFailed();
+            }
             ::sleep(errorIntervalSec);
             continue;
         }
 
+        if (reportTracker_ != nullptr) {
+            reportTracker_->OnReportAcked(req, resp);
+        }
+
         LOG(INFO) << "executing heartbeat info";
         ret = ExecTask(resp);
         if (ret != 0) {
@@ -36,6 +36,7 @@
 
 #include "include/chunkserver/chunkserver_common.h"
 #include "src/chunkserver/copyset_node_manager.h"
+#include "src/chunkserver/copyset_report_tracker.h"
 #include "src/common/wait_interval.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/chunkserver/scan_manager.h"
@@ -74,6 +75,10 @@ struct HeartbeatOptions {
     uint32_t                timeout;
     CopysetNodeManager*     copysetNodeManager;
     ScanManager*            scanManager;
+    // 是否开启增量心跳，只上报有变化的copyset
+    bool                    enableDeltaReport = false;
+    // 增量心跳开启时全量上报copyset的间隔
+    uint32_t                fullReportIntervalSec = 300;
 
     std::shared_ptr<LocalFileSystem> fs;
 };
@@ -191,6 +196,9 @@ class Heartbeat {
     uint64_t startUpTime_;
 
     ScanManager *scanMan_;
+
+    // 增量心跳记录已上报的copyset状态，未开启增量心跳时为nullptr
+    std::unique_ptr<CopysetReportTracker> reportTracker_;
 };
 
 }  // namespace chunkserver
@@ -158,6 +158,10 @@ std::shared_ptr<ChunkOpRequest> ChunkOpRequest::Decode(butil::IOBuf log,
             return std::make_shared<WriteChunkRequest>();
         case CHUNK_OP_TYPE::CHUNK_OP_DELETE:
             return std::make_shared<DeleteChunkRequest>();
+        case CHUNK_OP_TYPE::CHUNK_OP_DELETE_BATCH:
+            return std::make_shared<BatchDeleteChunkRequest>();
+        case CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH:
+            return std::make_shared<BatchCreateCloneChunkRequest>();
         case CHUNK_OP_TYPE::CHUNK_OP_READ_SNAP:
             return std::make_shared<ReadSnapshotRequest>();
         case CHUNK_OP_TYPE::CHUNK_OP_DELETE_SNAP:
@@ -226,6 +230,72 @@ void DeleteChunkRequest::OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
     }
 }
 
+void BatchDeleteChunkRequest::OnApply(uint64_t index,
+                                      ::google::protobuf::Closure *done) {
+    brpc::ClosureGuard doneGuard(done);
+
+    response_->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+    for (int i = 0; i < request_->chunkids_size(); ++i) {
+        ChunkID chunkId = request_->chunkids(i);
+        auto ret = datastore_->DeleteChunk(chunkId, request_->sn());
+        if (CSErrorCode::Success == ret) {
+            continue;
+        }
+
+        if (CSErrorCode::InternalError == ret) {
+            LOG(FATAL) << "batch delete chunk failed: "
+                       << " logic pool id: " << request_->logicpoolid()
+                       << " copyset id: " << request_->copysetid()
+                       << " chunkid: " << chunkId
+                       << " data store return: " << ret;
+        } else {
+            // 继续删除其他chunk, 失败的由mds重试整个请求
+            LOG(ERROR) << "batch delete chunk failed: "
+                       << " logic pool id: " << request_->logicpoolid()
+                       << " copyset id: " << request_->copysetid()
+                       << " chunkid: " << chunkId
+                       << " data store return: " << ret;
+            response_->set_status(
+                CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
+        }
+    }
+
+    if (response_->status() == CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS) {
+        node_->UpdateAppliedIndex(index);
+    }
+    auto maxIndex =
+        (index > node_->GetAppliedIndex() ? index : node_->GetAppliedIndex());
+    response_->set_appliedindex(maxIndex);
+}
+
+void BatchDeleteChunkRequest::OnApplyFromLog(
+    std::shared_ptr<CSDataStore> datastore,
+    const ChunkRequest &request,
+    const butil::IOBuf &data) {
+    // NOTE: 处理过程中优先使用参数传入的datastore/request
+    for (int i = 0; i < request.chunkids_size(); ++i) {
+        auto ret = datastore->DeleteChunk(request.chunkids(i),
+                                          request.sn());
+        if (CSErrorCode::Success == ret) {
+            continue;
+        }
+
+        if (CSErrorCode::InternalError == ret) {
+            LOG(FATAL) << "batch delete failed: "
+                       << request.logicpoolid() << ", "
+                       << request.copysetid()
+                       << " chunkid: " << request.chunkids(i)
+                       << " data store return: " << ret;
+        } else {
+            LOG(ERROR) << "batch delete failed: "
+                       << request.logicpoolid() << ", "
+                       << request.copysetid()
+                       << " chunkid: " << request.chunkids(i)
+                       << " data store return: " << ret;
+        }
+    }
+}
+
 ReadChunkRequest::ReadChunkRequest(std::shared_ptr<CopysetNode> nodePtr,
                                    CloneManager* cloneMgr,
                                    RpcController *cntl,
@@ -241,7 +311,11 @@ ReadChunkRequest::ReadChunkRequest(std::shared_ptr<CopysetNode> nodePtr,
 void ReadChunkRequest::Process() {
     brpc::ClosureGuard doneGuard(done_);
 
-    if (!node_->IsLeaderTerm()) {
+    /**
+     * hedged read可以发给follower，只要follower的applied index不小于client
+     * 已知的applied index，就可以直接读本地数据，否则返回重定向
+     */
+    if (!node_->IsLeaderTerm() && !CanReadOnFollower()) {
         RedirectChunkRequest();
         return;
     }
@@ -327,6 +401,12 @@ void ReadChunkRequest::OnApply(uint64_t index,
         }
         // 如果需要从源端拷贝数据，需要将请求转发给clone manager处理
         if ( needLazyClone || NeedClone(chunkInfo) ) {
+            // follower无法paste数据，交给leader处理
+            if (!node_->IsLeaderTerm()) {
+                RedirectChunkRequest();
+                break;
+            }
+
             applyIndex = index;
             std::shared_ptr<CloneTask> cloneTask =
             cloneMgr_->GenerateCloneTask(
@@ -353,6 +433,7 @@ void ReadChunkRequest::OnApply(uint64_t index,
         // 如果是recover请求，说明请求区域已经被写过了，可以直接返回成功
         if (request_->optype() == CHUNK_OP_TYPE::CHUNK_OP_RECOVER) {
             response_->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+            response_->set_accessed(true);
         }
     } while (false);
 
@@ -373,6 +454,13 @@ void ReadChunkRequest::OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
     // read什么都不用做
 }
 
+bool ReadChunkRequest::CanReadOnFollower() const {
+    return request_->optype() == CHUNK_OP_TYPE::CHUNK_OP_READ
+        && request_->has_followerread() && request_->followerread()
+        && request_->has_appliedindex()
+        && node_->GetAppliedIndex() >= request_->appliedindex();
+}
+
 bool ReadChunkRequest::NeedClone(const CSChunkInfo& chunkInfo) {
     // 如果不是 clone chunk，就不需要拷贝
     if (chunkInfo.isClone) {
@@ -792,6 +880,82 @@ void CreateCloneChunkRequest::OnApplyFromLog(std::shared_ptr<CSDataStore> datast
     }
 }
 
+void BatchCreateCloneChunkRequest::OnApply(uint64_t index,
+                                           ::google::protobuf::Closure *done) {
+    brpc::ClosureGuard doneGuard(done);
+
+    // 单个chunk的失败不影响其他chunk, 由调用方根据batchStatus重试
+    response_->clear_batchstatus();
+    for (int i = 0; i < request_->batchitems_size(); ++i) {
+        response_->add_batchstatus(
+            CreateOne(datastore_, *request_, request_->batchitems(i)));
+    }
+    response_->set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+    node_->UpdateAppliedIndex(index);
+
+    auto maxIndex =
+        (index > node_->GetAppliedIndex() ? index : node_->GetAppliedIndex());
+    response_->set_appliedindex(maxIndex);
+}
+
+void BatchCreateCloneChunkRequest::OnApplyFromLog(
+    std::shared_ptr<CSDataStore> datastore,
+    const ChunkRequest &request,
+    const butil::IOBuf &data) {
+    // NOTE: 处理过程中优先使用参数传入的datastore/request
+    for (int i = 0; i < request.batchitems_size(); ++i) {
+        CreateOne(datastore, request, request.batchitems(i));
+    }
+}
+
+CHUNK_OP_STATUS BatchCreateCloneChunkRequest::CreateOne(
+    std::shared_ptr<CSDataStore> datastore,
+    const ChunkRequest &request,
+    const BatchChunkItem &item) {
+    auto ret = datastore->CreateCloneChunk(item.chunkid(),
+                                           item.sn(),
+                                           request.correctedsn(),
+                                           request.size(),
+                                           item.location());
+    if (CSErrorCode::Success == ret) {
+        return CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS;
+    }
+
+    if (CSErrorCode::ChunkConflictError == ret) {
+        LOG(WARNING) << "create clone chunk exist: "
+                     << " logic pool id: " << request.logicpoolid()
+                     << " copyset id: " << request.copysetid()
+                     << " chunkid: " << item.chunkid()
+                     << " sn " << item.sn()
+                     << " correctedSn: " << request.correctedsn()
+                     << " location: " << item.location();
+        return CHUNK_OP_STATUS::CHUNK_OP_STATUS_CHUNK_EXIST;
+    }
+
+    if (CSErrorCode::InternalError == ret ||
+        CSErrorCode::CrcCheckError == ret ||
+        CSErrorCode::FileFormatError == ret) {
+        // 与CreateCloneChunkRequest一致, 直接fatal退出
+        LOG(FATAL) << "batch create clone failed: "
+                   << " logic pool id: " << request.logicpoolid()
+                   << " copyset id: " << request.copysetid()
+                   << " chunkid: " << item.chunkid()
+                   << " sn " << item.sn()
+                   << " correctedSn: " << request.correctedsn()
+                   << " location: " << item.location();
+    } else {
+        LOG(ERROR) << "batch create clone failed: "
+                   << " logic pool id: " << request.logicpoolid()
+                   << " copyset id: " << request.copysetid()
+                   << " chunkid: " << item.chunkid()
+                   << " sn " << item.sn()
+                   << " correctedSn: " << request.correctedsn()
+                   << " location: " << item.location()
+                   << " data store return: " << ret;
+    }
+    return CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN;
+}
+
 void PasteChunkInternalRequest::Process() {
     brpc::ClosureGuard doneGuard(done_);
     /**
@@ -203,6 +203,32 @@ class DeleteChunkRequest : public ChunkOpRequest {
                         const butil::IOBuf &data) override;
 };
 
+/**
+ * 批量删除同一个copyset上的chunk, 一条op log entry删除多个chunk,
+ * apply时需要等之前的op都apply完, 见CopysetNode::on_apply
+ */
+class BatchDeleteChunkRequest : public ChunkOpRequest {
+ public:
+    BatchDeleteChunkRequest() :
+        ChunkOpRequest() {}
+    BatchDeleteChunkRequest(std::shared_ptr<CopysetNode> nodePtr,
+                            RpcController *cntl,
+                            const ChunkRequest *request,
+                            ChunkResponse *response,
+                            ::google::protobuf::Closure *done) :
+        ChunkOpRequest(nodePtr,
+                       cntl,
+                       request,
+                       response,
+                       done) {}
+    virtual ~BatchDeleteChunkRequest() = default;
+
+    void OnApply(uint64_t index, ::google::protobuf::Closure *done) override;
+    void OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
+                        const ChunkRequest &request,
+                        const butil::IOBuf &data) override;
+};
+
 class ReadChunkRequest : public ChunkOpRequest {
     friend class CloneCore;
     friend class PasteChunkInternalRequest;
@@ -234,6 +260,8 @@ class ReadChunkRequest : public ChunkOpRequest {
     bool NeedClone(const CSChunkInfo& chunkInfo);
     // 从chunk文件中读数据
     void ReadChunk();
+    // 非leader时，判断是否可以作为follower直接读
+    bool CanReadOnFollower() const;
 
  private:
     CloneManager* cloneMgr_;
@@ -331,6 +359,40 @@ class CreateCloneChunkRequest : public ChunkOpRequest {
                         const butil::IOBuf &data) override;
 };
 
+/**
+ * 批量创建同一个copyset上的clone chunk, 一条op log entry创建多个chunk,
+ * 每个chunk的结果按顺序填到response的batchStatus中
+ */
+class BatchCreateCloneChunkRequest : public ChunkOpRequest {
+ public:
+    BatchCreateCloneChunkRequest() :
+        ChunkOpRequest() {}
+    BatchCreateCloneChunkRequest(std::shared_ptr<CopysetNode> nodePtr,
+                                 RpcController *cntl,
+                                 const ChunkRequest *request,
+                                 ChunkResponse *response,
+                                 ::google::protobuf::Closure *done) :
+        ChunkOpRequest(nodePtr,
+                       cntl,
+                       request,
+                       response,
+                       done) {}
+    virtual ~BatchCreateCloneChunkRequest() = default;
+
+    void OnApply(uint64_t index, ::google::protobuf::Closure *done) override;
+    void OnApplyFromLog(std::shared_ptr<CSDataStore> datastore,
+                        const ChunkRequest &request,
+                        const butil::IOBuf &data) override;
+
+ private:
+    /**
+     * 创建一个clone chunk, 返回该chunk的结果
+     */
+    static CHUNK_OP_STATUS CreateOne(std::shared_ptr<CSDataStore> datastore,
+                                     const ChunkRequest &request,
+                                     const BatchChunkItem &item);
+};
+
 class PasteChunkInternalRequest : public ChunkOpRequest {
  public:
     PasteChunkInternalRequest() :
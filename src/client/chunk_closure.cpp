@@ -25,6 +25,7 @@
 #include <string>
 #include <memory>
 #include <algorithm>
+#include <vector>
 
 #include "src/client/client_common.h"
 #include "src/client/copyset_client.h"
@@ -33,6 +34,7 @@
 #include "src/client/request_context.h"
 #include "src/client/service_helper.h"
 #include "src/client/io_tracker.h"
+#include "src/common/timeutility.h"
 
 // TODO(tongguangxun) :优化重试逻辑，将重试逻辑与RPC返回逻辑拆开
 namespace curve {
@@ -167,6 +169,11 @@ void ClientClosure::Run() {
     fileMetric_ = reqDone_->GetMetric();
     reqCtx_ = reqDone_->GetReqCtx();
     chunkIdInfo_ = reqCtx_->idinfo_;
+    if (reqCtx_->trace_.sampled && reqCtx_->trace_.rpcStartUs != 0) {
+        reqCtx_->trace_.rpcUs += curve::common::TimeUtility::GetTimeofDayUs() -
+                                 reqCtx_->trace_.rpcStartUs;
+        reqCtx_->trace_.rpcStartUs = 0;
+    }
     status_ = -1;
     cntlstatus_ = cntl_->ErrorCode();
 
@@ -415,7 +422,15 @@ void ClientClosure::OnRetry() {
                     << ", request id = " << reqCtx_->id_;
     }
 
-    PreProcessBeforeRetry(status_, cntlstatus_);
+    if (reqCtx_->trace_.sampled) {
+        uint64_t startUs = curve::common::TimeUtility::GetTimeofDayUs();
+        PreProcessBeforeRetry(status_, cntlstatus_);
+        reqCtx_->trace_.retryBackoffUs +=
+            curve::common::TimeUtility::GetTimeofDayUs() - startUs;
+    } else {
+        PreProcessBeforeRetry(status_, cntlstatus_);
+    }
+
     SendRetryRequest();
 }
 
@@ -586,6 +601,46 @@ void RecoverChunkClosure::SendRetryRequest() {
                           done_);
 }
 
+void BatchChunkClosure::OnSuccess() {
+    ClientClosure::OnSuccess();
+
+    std::vector<ChunkBatchItem>* items = reqCtx_->batchItems_;
+    if (response_->batchstatus_size() != static_cast<int>(items->size())) {
+        LOG(ERROR) << OpTypeToString(reqCtx_->optype_)
+            << " batch status size mismatch, " << *reqCtx_
+            << ", request chunks = " << items->size()
+            << ", response status = " << response_->batchstatus_size()
+            << ", remote side = "
+            << butil::endpoint2str(cntl_->remote_side()).c_str();
+        reqDone_->SetFailed(CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
+        return;
+    }
+
+    for (int i = 0; i < response_->batchstatus_size(); ++i) {
+        LIBCURVE_ERROR errcode = LIBCURVE_ERROR::OK;
+        IOTracker::ChunkServerErr2LibcurveErr(response_->batchstatus(i),
+                                              &errcode);
+        (*items)[i].retCode = -errcode;
+        // 老版本的chunkserver不返回batchAccessed
+        (*items)[i].accessed = i < response_->batchaccessed_size() &&
+                               response_->batchaccessed(i);
+    }
+}
+
+void CreateCloneChunksClosure::SendRetryRequest() {
+    client_->CreateCloneChunks(reqCtx_->idinfo_,
+                               reqCtx_->batchItems_,
+                               reqCtx_->correctedSeq_,
+                               reqCtx_->chunksize_,
+                               done_);
+}
+
+void RecoverChunksClosure::SendRetryRequest() {
+    client_->RecoverChunks(reqCtx_->idinfo_,
+                           reqCtx_->batchItems_,
+                           done_);
+}
+
 int ClientClosure::UpdateLeaderWithRedirectInfo(const std::string& leaderInfo) {
     ChunkServerID leaderId = 0;
     ChunkServerAddr leaderAddr;
@@ -305,6 +305,34 @@ class RecoverChunkClosure : public ClientClosure {
     void SendRetryRequest() override;
 };
 
+/**
+ * 批量请求的closure, 请求成功后把每个chunk的结果填到request context的
+ * batchItems_中
+ */
+class BatchChunkClosure : public ClientClosure {
+ public:
+    BatchChunkClosure(CopysetClient* client, Closure* done)
+        : ClientClosure(client, done) {}
+
+    void OnSuccess() override;
+};
+
+class CreateCloneChunksClosure : public BatchChunkClosure {
+ public:
+    CreateCloneChunksClosure(CopysetClient* client, Closure* done)
+        : BatchChunkClosure(client, done) {}
+
+    void SendRetryRequest() override;
+};
+
+class RecoverChunksClosure : public BatchChunkClosure {
+ public:
+    RecoverChunksClosure(CopysetClient* client, Closure* done)
+        : BatchChunkClosure(client, done) {}
+
+    void SendRetryRequest() override;
+};
+
 }   // namespace client
 }   // namespace curve
 
@@ -64,6 +64,8 @@ enum class OpType {
     RECOVER_CHUNK,
     GET_CHUNK_INFO,
     DISCARD,
+    CREATE_CLONE_BATCH,
+    RECOVER_CHUNK_BATCH,
     UNKNOWN
 };
 
@@ -104,6 +106,21 @@ typedef struct ChunkInfoDetail {
     std::vector<uint64_t> chunkSn;
 } ChunkInfoDetail_t;
 
+// 批量CreateCloneChunk/RecoverChunk中的一个chunk, 同一批chunk属于同一个copyset
+typedef struct ChunkBatchItem {
+    ChunkIDInfo idinfo;
+    // for CreateCloneChunk, 源chunk的location和chunk的版本号
+    std::string location;
+    uint64_t sn = 0;
+    // for RecoverChunk, 需要恢复的区域
+    uint64_t offset = 0;
+    uint64_t len = 0;
+    // 请求完成后该chunk的返回值, 与单个chunk请求的返回值含义相同
+    int retCode = -LIBCURVE_ERROR::FAILED;
+    // for RecoverChunk, chunk在恢复前是否已被用户读写过
+    bool accessed = false;
+} ChunkBatchItem_t;
+
 typedef struct LeaseSession {
     std::string sessionID;
     uint32_t leaseTime;
@@ -253,6 +270,10 @@ inline const char* OpTypeToString(OpType optype) {
         return "GetChunkInfo";
     case OpType::DISCARD:
         return "Discard";
+    case OpType::CREATE_CLONE_BATCH:
+        return "CreateCloneChunks";
+    case OpType::RECOVER_CHUNK_BATCH:
+        return "RecoverChunks";
     case OpType::UNKNOWN:
     default:
         return "Unknown";
@@ -69,6 +69,32 @@ int ClientConfig::Init(const char* configpath) {
     LOG_IF(ERROR, ret == false) << "config no chunkserver.enableAppliedIndexRead info";     // NOLINT
     RETURN_IF_FALSE(ret);
 
+    HedgedReadOption& hedgedReadOpt =
+        fileServiceOption_.ioOpt.ioSenderOpt.hedgedReadOpt;
+    ret = conf_.GetBoolValue("chunkserver.hedgedRead.enable",
+                             &hedgedReadOpt.enable);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.hedgedRead.enable info, "
+        << "using default value " << hedgedReadOpt.enable;
+
+    ret = conf_.GetUInt32Value("chunkserver.hedgedRead.latencyPercentile",
+                               &hedgedReadOpt.latencyPercentile);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.hedgedRead.latencyPercentile info, "
+        << "using default value " << hedgedReadOpt.latencyPercentile;
+
+    ret = conf_.GetUInt32Value("chunkserver.hedgedRead.minDelayMS",
+                               &hedgedReadOpt.minDelayMS);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.hedgedRead.minDelayMS info, "
+        << "using default value " << hedgedReadOpt.minDelayMS;
+
+    ret = conf_.GetUInt32Value("chunkserver.hedgedRead.maxDelayMS",
+                               &hedgedReadOpt.maxDelayMS);
+    LOG_IF(WARNING, ret == false)
+        << "config no chunkserver.hedgedRead.maxDelayMS info, "
+        << "using default value " << hedgedReadOpt.maxDelayMS;
+
     ret = conf_.GetUInt32Value("chunkserver.opMaxRetry",
           &fileServiceOption_.ioOpt.ioSenderOpt.failRequestOpt.chunkserverOPMaxRetry);    // NOLINT
     LOG_IF(ERROR, ret == false) << "config no chunkserver.opMaxRetry info";
@@ -143,6 +169,27 @@ int ClientConfig::Init(const char* configpath) {
     LOG_IF(ERROR, ret == false) << "config no metacache.getLeaderTimeOutMS info";   // NOLINT
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetBoolValue("metacache.segmentPrefetch.enable",
+        &fileServiceOption_.ioOpt.metaCacheOpt.segmentPrefetchOpt.enable);
+    LOG_IF(WARNING, ret == false)
+        << "config no metacache.segmentPrefetch.enable info, "
+        << "using default value "
+        << fileServiceOption_.ioOpt.metaCacheOpt.segmentPrefetchOpt.enable;
+
+    ret = conf_.GetBoolValue("metacache.segmentPrefetch.async",
+        &fileServiceOption_.ioOpt.metaCacheOpt.segmentPrefetchOpt.async);
+    LOG_IF(WARNING, ret == false)
+        << "config no metacache.segmentPrefetch.async info, "
+        << "using default value "
+        << fileServiceOption_.ioOpt.metaCacheOpt.segmentPrefetchOpt.async;
+
+    ret = conf_.GetUInt32Value("metacache.segmentPrefetch.copysetBatchSize",
+        &fileServiceOption_.ioOpt.metaCacheOpt.segmentPrefetchOpt.copysetBatchSize);  // NOLINT
+    LOG_IF(WARNING, ret == false)
+        << "config no metacache.segmentPrefetch.copysetBatchSize info, "
+        << "using default value "
+        << fileServiceOption_.ioOpt.metaCacheOpt.segmentPrefetchOpt.copysetBatchSize;  // NOLINT
+
     ret = conf_.GetUInt32Value("schedule.queueCapacity",
         &fileServiceOption_.ioOpt.reqSchdulerOpt.scheduleQueueCapacity);
     LOG_IF(ERROR, ret == false) << "config no schedule.queueCapacity info";
@@ -187,6 +234,20 @@ int ClientConfig::Init(const char* configpath) {
         }
     }
 
+    std::string followerReadAddr;
+    if (conf_.GetStringValue("mds.followerRead.addr", &followerReadAddr)) {
+        std::vector<std::string> followerAddrs;
+        common::SplitString(followerReadAddr, ",", &followerAddrs);
+        for (auto& addr : followerAddrs) {
+            if (!curve::common::NetCommon::CheckAddressValid(addr)) {
+                LOG(ERROR) << "follower read address invalid: " << addr;
+                return -1;
+            }
+        }
+        fileServiceOption_.metaServerOpt.mdsFollowerReadAddrs.swap(
+            followerAddrs);
+    }
+
     ret = conf_.GetUInt64Value("mds.rpcTimeoutMS",
         &fileServiceOption_.metaServerOpt.mdsRPCTimeoutMs);
     LOG_IF(ERROR, ret == false) << "config no mds.rpcTimeoutMS info";
@@ -271,6 +332,75 @@ int ClientConfig::Init(const char* configpath) {
     LOG_IF(ERROR, ret == false) << "config no discard.taskDelayMs info";
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetBoolValue("readahead.enable",
+                             &fileServiceOption_.ioOpt.readaheadOpt.enable);
+    LOG_IF(WARNING, ret == false)
+        << "config no readahead.enable info, using default value "
+        << fileServiceOption_.ioOpt.readaheadOpt.enable;
+
+    ret = conf_.GetBoolValue(
+        "readahead.enableForSharedOpen",
+        &fileServiceOption_.ioOpt.readaheadOpt.enableForSharedOpen);
+    LOG_IF(WARNING, ret == false)
+        << "config no readahead.enableForSharedOpen info, using default value "
+        << fileServiceOption_.ioOpt.readaheadOpt.enableForSharedOpen;
+
+    ret = conf_.GetUInt32Value(
+        "readahead.cacheBlockSizeKB",
+        &fileServiceOption_.ioOpt.readaheadOpt.cacheBlockSizeKB);
+    LOG_IF(WARNING, ret == false)
+        << "config no readahead.cacheBlockSizeKB info, using default value "
+        << fileServiceOption_.ioOpt.readaheadOpt.cacheBlockSizeKB;
+
+    ret = conf_.GetUInt32Value(
+        "readahead.cacheCapacityMB",
+        &fileServiceOption_.ioOpt.readaheadOpt.cacheCapacityMB);
+    LOG_IF(WARNING, ret == false)
+        << "config no readahead.cacheCapacityMB info, using default value "
+        << fileServiceOption_.ioOpt.readaheadOpt.cacheCapacityMB;
+
+    ret = conf_.GetUInt32Value(
+        "readahead.minWindowKB",
+        &fileServiceOption_.ioOpt.readaheadOpt.minWindowKB);
+    LOG_IF(WARNING, ret == false)
+        << "config no readahead.minWindowKB info, using default value "
+        << fileServiceOption_.ioOpt.readaheadOpt.minWindowKB;
+
+    ret = conf_.GetUInt32Value(
+        "readahead.maxWindowKB",
+        &fileServiceOption_.ioOpt.readaheadOpt.maxWindowKB);
+    LOG_IF(WARNING, ret == false)
+        << "config no readahead.maxWindowKB info, using default value "
+        << fileServiceOption_.ioOpt.readaheadOpt.maxWindowKB;
+
+    ret = conf_.GetUInt32Value(
+        "readahead.sequentialTriggerCount",
+        &fileServiceOption_.ioOpt.readaheadOpt.sequentialTriggerCount);
+    LOG_IF(WARNING, ret == false)
+        << "config no readahead.sequentialTriggerCount info, "
+        << "using default value "
+        << fileServiceOption_.ioOpt.readaheadOpt.sequentialTriggerCount;
+
+    ret = conf_.GetBoolValue("ioTrace.enable",
+                             &fileServiceOption_.ioOpt.ioTraceOpt.enable);
+    LOG_IF(WARNING, ret == false)
+        << "config no ioTrace.enable info, using default value "
+        << fileServiceOption_.ioOpt.ioTraceOpt.enable;
+
+    ret = conf_.GetUInt32Value(
+        "ioTrace.sampleRate",
+        &fileServiceOption_.ioOpt.ioTraceOpt.sampleRate);
+    LOG_IF(WARNING, ret == false)
+        << "config no ioTrace.sampleRate info, using default value "
+        << fileServiceOption_.ioOpt.ioTraceOpt.sampleRate;
+
+    ret = conf_.GetUInt32Value(
+        "ioTrace.slowIOThresholdMS",
+        &fileServiceOption_.ioOpt.ioTraceOpt.slowIOThresholdMS);
+    LOG_IF(WARNING, ret == false)
+        << "config no ioTrace.slowIOThresholdMS info, using default value "
+        << fileServiceOption_.ioOpt.ioTraceOpt.slowIOThresholdMS;
+
     return 0;
 }
 
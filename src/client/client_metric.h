@@ -102,6 +102,80 @@ struct DiscardMetric {
     bvar::Adder<int64_t> pending;
 };
 
+struct ReadaheadMetric {
+    explicit ReadaheadMetric(const std::string& prefix)
+        : hit(prefix, "readahead_hit"),
+          miss(prefix, "readahead_miss"),
+          issued(prefix, "readahead_issued"),
+          issuedBytes(prefix, "readahead_issued_bytes"),
+          dropped(prefix, "readahead_dropped"),
+          cachedBytes(prefix, "readahead_cached_bytes"),
+          completedBytes(prefix, "readahead_completed_bytes"),
+          failed(prefix, "readahead_failed"),
+          latency(prefix, "readahead_lat") {}
+
+    bvar::Adder<int64_t> hit;
+    bvar::Adder<int64_t> miss;
+    bvar::Adder<int64_t> issued;
+    bvar::Adder<int64_t> issuedBytes;
+    // readahead data dropped because of concurrent write or failure
+    bvar::Adder<int64_t> dropped;
+    bvar::Adder<int64_t> cachedBytes;
+    // readahead io is not counted in user read metric
+    bvar::Adder<int64_t> completedBytes;
+    bvar::Adder<int64_t> failed;
+    bvar::LatencyRecorder latency;
+};
+
+struct HedgedReadMetric {
+    explicit HedgedReadMetric(const std::string& prefix)
+        : issued(prefix, "hedged_read_issued"),
+          won(prefix, "hedged_read_won"),
+          lost(prefix, "hedged_read_lost"),
+          failed(prefix, "hedged_read_failed") {}
+
+    // hedge request sent to follower
+    bvar::Adder<int64_t> issued;
+    // follower response returned first and used
+    bvar::Adder<int64_t> won;
+    // leader response returned first, hedge request is canceled
+    bvar::Adder<int64_t> lost;
+    // hedge request failed, e.g. follower applied index is behind
+    bvar::Adder<int64_t> failed;
+};
+
+// latency of each stage of sampled user read/write io
+struct IOStageMetric {
+    explicit IOStageMetric(const std::string& prefix)
+        : throttle(prefix, "io_stage_throttle"),
+          split(prefix, "io_stage_split"),
+          queue(prefix, "io_stage_queue"),
+          inflightWait(prefix, "io_stage_inflight_wait"),
+          leaderLookup(prefix, "io_stage_leader_lookup"),
+          rpc(prefix, "io_stage_rpc"),
+          retryBackoff(prefix, "io_stage_retry_backoff"),
+          total(prefix, "io_stage_total"),
+          slowIO(prefix, "io_stage_slow_io") {}
+
+    // wait for throttle
+    bvar::LatencyRecorder throttle;
+    // split user io into chunk requests
+    bvar::LatencyRecorder split;
+    // wait in scheduler queue
+    bvar::LatencyRecorder queue;
+    // wait for inflight rpc token
+    bvar::LatencyRecorder inflightWait;
+    // get leader from metacache, including refresh from mds
+    bvar::LatencyRecorder leaderLookup;
+    // rpc time, including all retries
+    bvar::LatencyRecorder rpc;
+    // sleep before retry
+    bvar::LatencyRecorder retryBackoff;
+    bvar::LatencyRecorder total;
+    // number of sampled io exceeding slow io threshold
+    bvar::Adder<int64_t> slowIO;
+};
+
 // 文件级别metric信息统计
 struct FileMetric {
     const std::string prefix = "curve_client";
@@ -136,6 +210,12 @@ struct FileMetric {
 
     DiscardMetric discardMetric;
 
+    ReadaheadMetric readaheadMetric;
+
+    HedgedReadMetric hedgedReadMetric;
+
+    IOStageMetric ioStageMetric;
+
     explicit FileMetric(const std::string& name)
         : filename(name),
           inflightRPCNum(prefix, filename + "_inflight_rpc_num"),
@@ -149,7 +229,10 @@ struct FileMetric {
           userDiscard(prefix, filename + "_discard"),
           getLeaderRetryQPS(prefix, filename + "_get_leader_retry_rpc"),
           suspendRPCMetric(prefix, filename + "_suspend_io_num"),
-          discardMetric(prefix + filename) {}
+          discardMetric(prefix + filename),
+          readaheadMetric(prefix + filename),
+          hedgedReadMetric(prefix + filename),
+          ioStageMetric(prefix + filename) {}
 };
 
 // 用于全局mds接口统计信息调用信息统计
@@ -176,6 +259,8 @@ struct MDSClientMetric {
     InterfaceMetric getOrAllocateSegment;
     // DeAllocateSegment接口统计信息
     InterfaceMetric deAllocateSegment;
+    // ListSegment接口统计信息
+    InterfaceMetric listSegment;
     // RenameFile接口统计信息
     InterfaceMetric renameFile;
     // Extend接口统计信息
@@ -212,6 +297,7 @@ struct MDSClientMetric {
           getServerList(prefix, "getServerList"),
           getOrAllocateSegment(prefix, "getOrAllocateSegment"),
           deAllocateSegment(prefix, "deAllocateSegment"),
+          listSegment(prefix, "listSegment"),
           renameFile(prefix, "renameFile"),
           extendFile(prefix, "extendFile"),
           deleteFile(prefix, "deleteFile"),
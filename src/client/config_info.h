@@ -78,6 +78,9 @@ struct MetaServerOption {
     uint64_t mdsWaitSleepMs = 10000;  // 10 seconds
 
     std::vector<std::string> mdsAddrs;
+
+    // 提供只读namespace服务的mds地址，为空时所有请求都发往leader
+    std::vector<std::string> mdsFollowerReadAddrs;
 };
 
 /**
@@ -151,16 +154,33 @@ struct FailureRequestOption {
     uint64_t chunkserverMaxRetryTimesBeforeConsiderSuspend = 20;
 };
 
+/**
+ * hedged read配置，leader读请求超过延迟阈值仍未返回时，向一个follower发送
+ * 相同的读请求，先返回的结果生效，另一个请求被取消
+ * @enable: 是否开启hedged read，依赖chunkserverEnableAppliedIndexRead
+ * @latencyPercentile: 延迟阈值取文件read rpc延迟的分位值，如99表示p99
+ * @minDelayMS: 延迟阈值下限
+ * @maxDelayMS: 延迟阈值上限，应小于chunkserver rpc超时时间
+ */
+struct HedgedReadOption {
+    bool enable = false;
+    uint32_t latencyPercentile = 99;
+    uint32_t minDelayMS = 5;
+    uint32_t maxDelayMS = 200;
+};
+
 /**
  * 发送rpc给chunkserver的配置
  * @chunkserverEnableAppliedIndexRead: 是否开启使用appliedindex read
  * @inflightOpt: 一个文件向chunkserver发送请求时的inflight 请求控制配置
  * @failRequestOpt: rpc发送失败之后，需要进行rpc重试的相关配置
+ * @hedgedReadOpt: hedged read相关配置
  */
 struct IOSenderOption {
     bool chunkserverEnableAppliedIndexRead;
     InFlightIOCntlInfo inflightOpt;
     FailureRequestOption failRequestOpt;
+    HedgedReadOption hedgedReadOpt;
 };
 
 /**
@@ -193,6 +213,18 @@ struct RequestScheduleOption {
  * @metacacheGetLeaderBackupRequestLbName: 为getleader backup rpc
  *                            选择底层服务节点的策略
  */
+/**
+ * segment prefetch config, used to warm up metacache when opening a file
+ * @enable: list all allocated segments and their copysets when open file
+ * @async: do prefetch in background, open file returns immediately
+ * @copysetBatchSize: max copysets number in one GetServerList request
+ */
+struct SegmentPrefetchOption {
+    bool enable = false;
+    bool async = true;
+    uint32_t copysetBatchSize = 256;
+};
+
 struct MetaCacheOption {
     uint32_t metacacheGetLeaderRetry = 3;
     uint32_t metacacheRPCRetryIntervalUS = 500;
@@ -201,6 +233,7 @@ struct MetaCacheOption {
     uint32_t discardGranularity = 4096;
     std::string metacacheGetLeaderBackupRequestLbName = "rr";
     ChunkServerUnstableOption chunkserverUnstableOption;
+    SegmentPrefetchOption segmentPrefetchOpt;
 };
 
 /**
@@ -244,6 +277,42 @@ struct ThrottleOption {
     bool enable = false;
 };
 
+/**
+ * sequential readahead and read cache config
+ * @enable: enable/disable readahead
+ * @enableForSharedOpen: whether enable readahead for files opened in readonly
+ *                       mode, other clients may write these files, so cached
+ *                       data can be stale, disabled by default
+ * @cacheBlockSizeKB: cache block size, readahead is aligned to this size
+ * @cacheCapacityMB: max bytes of cached data for a file
+ * @minWindowKB: initial readahead window once a sequential stream is detected
+ * @maxWindowKB: max readahead window
+ * @sequentialTriggerCount: a stream is considered sequential after this
+ *                          number of continuous reads
+ */
+struct ReadaheadOption {
+    bool enable = false;
+    bool enableForSharedOpen = false;
+    uint32_t cacheBlockSizeKB = 128;
+    uint32_t cacheCapacityMB = 64;
+    uint32_t minWindowKB = 256;
+    uint32_t maxWindowKB = 4096;
+    uint32_t sequentialTriggerCount = 2;
+};
+
+/**
+ * per-stage io latency trace config
+ * @enable: enable/disable io stage trace
+ * @sampleRate: trace one of every sampleRate user read/write requests
+ * @slowIOThresholdMS: sampled io slower than this is logged with its
+ *                     per-stage breakdown
+ */
+struct IOTraceOption {
+    bool enable = false;
+    uint32_t sampleRate = 100;
+    uint32_t slowIOThresholdMS = 1000;
+};
+
 /**
  * IOOption存储了当前io 操作所需要的所有配置信息
  */
@@ -256,6 +325,8 @@ struct IOOption {
     CloseFdThreadOption closeFdThreadOption;
     ThrottleOption throttleOption;
     DiscardOption discardOption;
+    ReadaheadOption readaheadOpt;
+    IOTraceOption ioTraceOpt;
 };
 
 /**
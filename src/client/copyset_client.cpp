@@ -24,14 +24,17 @@
 
 #include <glog/logging.h>
 #include <unistd.h>
+#include <algorithm>
 #include <memory>
 #include <utility>
 
+#include "src/client/hedged_read.h"
 #include "src/client/request_sender.h"
 #include "src/client/metacache.h"
 #include "src/client/client_config.h"
 #include "src/client/request_scheduler.h"
 #include "src/client/request_closure.h"
+#include "src/common/timeutility.h"
 
 namespace curve {
 namespace client {
@@ -124,13 +127,53 @@ int CopysetClient::ReadChunk(const ChunkIDInfo& idinfo, uint64_t sn,
 
     auto task = [&](Closure* done, std::shared_ptr<RequestSender> senderPtr) {
         ReadChunkClosure *readDone = new ReadChunkClosure(this, done);
-        senderPtr->ReadChunk(idinfo, sn, offset, length,
-                             appliedindex, sourceInfo, readDone);
+        if (NeedHedgedRead(appliedindex)) {
+            HedgedReadChunk(idinfo, offset, length, appliedindex, sourceInfo,
+                            std::move(senderPtr), readDone);
+        } else {
+            senderPtr->ReadChunk(idinfo, sn, offset, length,
+                                 appliedindex, sourceInfo, readDone);
+        }
     };
 
     return DoRPCTask(idinfo, task, doneGuard.release());
 }
 
+bool CopysetClient::NeedHedgedRead(uint64_t appliedindex) const {
+    // follower can only serve reads carrying applied index
+    return iosenderopt_.hedgedReadOpt.enable &&
+           iosenderopt_.chunkserverEnableAppliedIndexRead &&
+           appliedindex > 0;
+}
+
+void CopysetClient::HedgedReadChunk(const ChunkIDInfo& idinfo,
+                                    off_t offset, size_t length,
+                                    uint64_t appliedindex,
+                                    const RequestSourceInfo& sourceInfo,
+                                    std::shared_ptr<RequestSender> leader,
+                                    ReadChunkClosure* readDone) {
+    RequestClosure* reqclosure =
+        static_cast<RequestClosure*>(readDone->GetClosure());
+    FileMetric* fileMetric = reqclosure->GetMetric();
+    MetricHelper::IncremRPCRPSCount(fileMetric, OpType::READ);
+
+    HedgedReadChunkTask::Param param;
+    param.idinfo = idinfo;
+    param.offset = offset;
+    param.length = length;
+    param.appliedIndex = appliedindex;
+    param.sourceInfo = sourceInfo;
+    param.timeoutMS =
+        std::max(reqclosure->GetNextTimeoutMS(),
+                 iosenderopt_.failRequestOpt.chunkserverRPCTimeoutMS);
+    param.hedgeDelayUS = HedgedReadChunkTask::CalcHedgeDelayUS(
+        iosenderopt_.hedgedReadOpt, fileMetric);
+
+    HedgedReadChunkTask::Start(param, std::move(leader), metaCache_,
+                               senderManager_, iosenderopt_, fileMetric,
+                               readDone);
+}
+
 int CopysetClient::WriteChunk(const ChunkIDInfo& idinfo, uint64_t sn,
                               const butil::IOBuf& data,
                               off_t offset, size_t length,
@@ -240,10 +283,42 @@ int CopysetClient::RecoverChunk(const ChunkIDInfo& idinfo,
     return DoRPCTask(idinfo, task, done);
 }
 
+int CopysetClient::CreateCloneChunks(const ChunkIDInfo& idinfo,
+                                     std::vector<ChunkBatchItem>* items,
+                                     uint64_t correntSn, uint64_t chunkSize,
+                                     Closure* done) {
+    auto task = [&](Closure* done, std::shared_ptr<RequestSender> senderPtr) {
+        CreateCloneChunksClosure* createClonesDone =
+            new CreateCloneChunksClosure(this, done);
+        senderPtr->CreateCloneChunks(idinfo, createClonesDone, *items,
+                                     correntSn, chunkSize);
+    };
+
+    return DoRPCTask(idinfo, task, done);
+}
+
+int CopysetClient::RecoverChunks(const ChunkIDInfo& idinfo,
+                                 std::vector<ChunkBatchItem>* items,
+                                 Closure* done) {
+    auto task = [&](Closure* done, std::shared_ptr<RequestSender> senderPtr) {
+        RecoverChunksClosure* recoverChunksDone =
+            new RecoverChunksClosure(this, done);
+        senderPtr->RecoverChunks(idinfo, recoverChunksDone, *items);
+    };
+
+    return DoRPCTask(idinfo, task, done);
+}
+
 int CopysetClient::DoRPCTask(const ChunkIDInfo& idinfo,
     std::function<void(Closure* done,
     std::shared_ptr<RequestSender> senderptr)> task, Closure *done) {
     RequestClosure* reqclosure = static_cast<RequestClosure*>(done);
+    RequestContext* reqctx = reqclosure->GetReqCtx();
+    RequestStageTrace* trace =
+        (reqctx != nullptr && reqctx->trace_.sampled) ? &reqctx->trace_
+                                                      : nullptr;
+    const uint64_t startUs =
+        trace ? curve::common::TimeUtility::GetTimeofDayUs() : 0;
 
     ChunkServerID leaderId;
     butil::EndPoint leaderAddr;
@@ -262,6 +337,12 @@ int CopysetClient::DoRPCTask(const ChunkIDInfo& idinfo,
         auto senderPtr = senderManager_->GetOrCreateSender(leaderId,
                                         leaderAddr, iosenderopt_);
         if (nullptr != senderPtr) {
+            if (trace != nullptr) {
+                // leader lookup includes waiting for a valid leader
+                uint64_t nowUs = curve::common::TimeUtility::GetTimeofDayUs();
+                trace->leaderLookupUs += nowUs - startUs;
+                trace->rpcStartUs = nowUs;
+            }
             task(doneGuard.release(), senderPtr);
             break;
         } else {
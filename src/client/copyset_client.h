@@ -28,6 +28,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "include/curve_compiler_specific.h"
 #include "src/client/client_common.h"
@@ -45,6 +46,7 @@ using ::google::protobuf::Closure;
 
 // TODO(tongguangxun) :后续除了read、write的接口也需要调整重试逻辑
 class MetaCache;
+class ReadChunkClosure;
 class RequestScheduler;
 /**
  * 负责管理 ChunkServer 的链接，向上层提供访问
@@ -177,6 +179,34 @@ class CopysetClient {
                   uint64_t len,
                   Closure *done);
 
+    /**
+    * @brief 批量创建同一个copyset上的clone chunk
+    * @param idinfo为copyset相关的id信息
+    * @param items:需要创建的chunk, 由调用方持有直到done被调用,
+    *              每个chunk的结果在请求完成后填到其中
+    * @param:correntSn CreateCloneChunk时候用于修改chunk的correctedSn
+    * @param:chunkSize chunk的大小
+    * @param done:上一层异步回调的closure
+    * @return 错误码
+    */
+    int CreateCloneChunks(const ChunkIDInfo& idinfo,
+                          std::vector<ChunkBatchItem> *items,
+                          uint64_t correntSn,
+                          uint64_t chunkSize,
+                          Closure *done);
+
+   /**
+    * @brief 批量恢复同一个copyset上的chunk数据
+    * @param idinfo为copyset相关的id信息
+    * @param items:需要恢复的chunk, 由调用方持有直到done被调用,
+    *              每个chunk的结果在请求完成后填到其中
+    * @param done:上一层异步回调的closure
+    * @return 错误码
+    */
+    int RecoverChunks(const ChunkIDInfo& idinfo,
+                      std::vector<ChunkBatchItem> *items,
+                      Closure *done);
+
     /**
      * @brief 如果csId对应的RequestSender不健康，就进行重置
      * @param csId chunkserver id
@@ -232,6 +262,21 @@ class CopysetClient {
         std::function<void(Closure*, std::shared_ptr<RequestSender>)> task,
         Closure *done);
 
+    // 是否对本次读请求开启hedged read
+    bool NeedHedgedRead(uint64_t appliedindex) const;
+
+    /**
+     * 先向leader发送读请求，超过延迟阈值未返回时再向follower发送相同请求
+     * @param[in]: leader为当前leader的sender
+     * @param[in]: readDone为读请求的closure
+     */
+    void HedgedReadChunk(const ChunkIDInfo& idinfo,
+                         off_t offset, size_t length,
+                         uint64_t appliedindex,
+                         const RequestSourceInfo& sourceInfo,
+                         std::shared_ptr<RequestSender> leader,
+                         ReadChunkClosure* readDone);
+
  private:
     // 元数据缓存
     MetaCache            *metaCache_;
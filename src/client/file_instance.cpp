@@ -52,6 +52,12 @@ bool FileInstance::Initialize(const std::string& filename,
                               bool readonly) {
     readonly_ = readonly;
     fileopt_ = fileservicopt;
+
+    // file opened in readonly mode may be written by other clients,
+    // so cached readahead data can be stale
+    if (readonly_ && !fileopt_.ioOpt.readaheadOpt.enableForSharedOpen) {
+        fileopt_.ioOpt.readaheadOpt.enable = false;
+    }
     bool ret = false;
     do {
         if (!userinfo.Valid()) {
@@ -144,6 +150,22 @@ int FileInstance::AioDiscard(CurveAioContext* aioctx) {
     return -1;
 }
 
+int FileInstance::AioSubmit(CurveAioContext** aioctxs, size_t count,
+                            UserDataType dataType) {
+    if (readonly_) {
+        for (size_t i = 0; i < count; ++i) {
+            if (aioctxs[i]->op != LIBCURVE_OP::LIBCURVE_OP_READ) {
+                LOG(ERROR) << "Open with read only, not support "
+                           << "AioSubmit with write or discard";
+                return -1;
+            }
+        }
+    }
+
+    return iomanager4file_.AioSubmit(aioctxs, count, mdsclient_.get(),
+                                     dataType);
+}
+
 // 两种场景会造成在Open的时候返回LIBCURVE_ERROR::FILE_OCCUPIED
 // 1. 强制重启qemu不会调用close逻辑，然后启动的时候原来的文件sessio还没过期.
 //    导致再次去发起open的时候，返回被占用，这种情况可以通过load sessionmap
@@ -163,6 +185,9 @@ int FileInstance::Open(const std::string& filename,
         iomanager4file_.UpdateFileThrottleParams(finfo_.throttleParams);
         ret = leaseExecutor_->Start(finfo_, lease) ? LIBCURVE_ERROR::OK
                                                    : LIBCURVE_ERROR::FAILED;
+        if (ret == LIBCURVE_ERROR::OK) {
+            iomanager4file_.PrefetchSegments(mdsclient_.get());
+        }
         if (nullptr != sessionId) {
             sessionId->assign(lease.sessionID);
         }
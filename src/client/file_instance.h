@@ -124,6 +124,16 @@ class CURVE_CACHELINE_ALIGNMENT FileInstance {
      */
     int AioDiscard(CurveAioContext* aioctx);
 
+    /**
+     * @brief Submit a batch of asynchronous requests
+     * @param aioctxs async request contexts
+     * @param count number of contexts
+     * @param dataType type of user buffer
+     * @return 0 means success, otherwise it means failure
+     */
+    int AioSubmit(CurveAioContext** aioctxs, size_t count,
+                  UserDataType dataType);
+
     int Close();
 
     void UnInitialize();
@@ -0,0 +1,287 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include "src/client/hedged_read.h"
+
+#include <butil/time.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "src/client/metacache.h"
+
+namespace curve {
+namespace client {
+
+void HedgedReadChunkTask::Start(const Param& param,
+                                std::shared_ptr<RequestSender> leader,
+                                MetaCache* metaCache,
+                                RequestSenderManager* senderManager,
+                                const IOSenderOption& senderOpt,
+                                FileMetric* metric,
+                                ReadChunkClosure* done) {
+    HedgedReadChunkTask* task = new HedgedReadChunkTask(
+        param, metaCache, senderManager, senderOpt, metric, done);
+    task->leaderId_ = leader->GetChunkServerID();
+
+    Leg* leg = task->NewLeg(false, *leader);
+    task->leaderCallId_ = leg->cntl->call_id();
+
+    // one ref for leader rpc, one for hedge timer
+    task->refs_.store(2, std::memory_order_relaxed);
+    task->timerAdded_ = true;
+    int ret = bthread_timer_add(
+        &task->timerId_, butil::microseconds_from_now(param.hedgeDelayUS),
+        OnHedgeTimer, task);
+    if (ret != 0) {
+        LOG(WARNING) << "add hedged read timer failed, ret = " << ret;
+        task->timerAdded_ = false;
+        task->refs_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    task->SendLeg(leg, leader.get());
+}
+
+uint64_t HedgedReadChunkTask::CalcHedgeDelayUS(const HedgedReadOption& opt,
+                                               FileMetric* metric) {
+    uint64_t minDelayUS = static_cast<uint64_t>(opt.minDelayMS) * 1000;
+    uint64_t maxDelayUS = std::max<uint64_t>(
+        static_cast<uint64_t>(opt.maxDelayMS) * 1000, minDelayUS);
+    if (metric == nullptr) {
+        return maxDelayUS;
+    }
+
+    double ratio = std::min<uint32_t>(opt.latencyPercentile, 99) / 100.0;
+    int64_t latencyUS = metric->readRPC.latency.latency_percentile(ratio);
+    if (latencyUS <= 0) {
+        return maxDelayUS;
+    }
+
+    return std::min(std::max(static_cast<uint64_t>(latencyUS), minDelayUS),
+                    maxDelayUS);
+}
+
+HedgedReadChunkTask::HedgedReadChunkTask(const Param& param,
+                                         MetaCache* metaCache,
+                                         RequestSenderManager* senderManager,
+                                         const IOSenderOption& senderOpt,
+                                         FileMetric* metric,
+                                         ReadChunkClosure* done)
+    : param_(param),
+      metaCache_(metaCache),
+      senderManager_(senderManager),
+      senderOpt_(senderOpt),
+      metric_(metric),
+      done_(done),
+      leaderId_(0),
+      refs_(0),
+      finished_(false),
+      timerAdded_(false),
+      timerId_(0),
+      followerSent_(false),
+      followerDone_(false),
+      pendingLeader_(nullptr) {}
+
+HedgedReadChunkTask::Leg* HedgedReadChunkTask::NewLeg(
+    bool isFollower, const RequestSender& sender) {
+    Leg* leg = new Leg();
+    leg->task = this;
+    leg->isFollower = isFollower;
+    leg->csId = sender.GetChunkServerID();
+    leg->csEndPoint = sender.GetChunkServerEndPoint();
+    leg->cntl = new brpc::Controller();
+    leg->cntl->set_timeout_ms(param_.timeoutMS);
+    leg->response = new ChunkResponse();
+    return leg;
+}
+
+void HedgedReadChunkTask::SendLeg(Leg* leg, RequestSender* sender) {
+    sender->ReadChunk(param_.idinfo, param_.offset, param_.length,
+                      param_.appliedIndex, param_.sourceInfo, leg->isFollower,
+                      leg->cntl, leg->response, leg);
+}
+
+void HedgedReadChunkTask::OnHedgeTimer(void* arg) {
+    HedgedReadChunkTask* task = static_cast<HedgedReadChunkTask*>(arg);
+    task->SendHedge();
+    task->Unref();
+}
+
+void HedgedReadChunkTask::SendHedge() {
+    auto follower = ChooseFollower();
+    if (follower == nullptr) {
+        return;
+    }
+
+    Leg* leg = NewLeg(true, *follower);
+    {
+        std::lock_guard<bthread::Mutex> lk(mtx_);
+        if (finished_ || pendingLeader_ != nullptr) {
+            DestroyLeg(leg);
+            return;
+        }
+
+        followerSent_ = true;
+        followerCallId_ = leg->cntl->call_id();
+        refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (metric_ != nullptr) {
+        metric_->hedgedReadMetric.issued << 1;
+    }
+
+    DVLOG(9) << "send hedged read to follower " << leg->csId
+             << ", logicpool id = " << param_.idinfo.lpid_
+             << ", copyset id = " << param_.idinfo.cpid_
+             << ", chunk id = " << param_.idinfo.cid_
+             << ", offset = " << param_.offset
+             << ", length = " << param_.length;
+
+    SendLeg(leg, follower.get());
+}
+
+std::shared_ptr<RequestSender> HedgedReadChunkTask::ChooseFollower() {
+    CopysetInfo cpinfo = metaCache_->GetCopysetinfo(param_.idinfo.lpid_,
+                                                    param_.idinfo.cpid_);
+    std::vector<const CopysetPeerInfo*> candidates;
+    for (const auto& peer : cpinfo.csinfos_) {
+        if (peer.chunkserverID != leaderId_) {
+            candidates.push_back(&peer);
+        }
+    }
+
+    if (candidates.empty()) {
+        return nullptr;
+    }
+
+    const CopysetPeerInfo* peer = candidates[std::rand() % candidates.size()];
+    return senderManager_->GetOrCreateSender(
+        peer->chunkserverID, peer->externalAddr.addr_, senderOpt_);
+}
+
+void HedgedReadChunkTask::Leg::Run() {
+    task->OnLegDone(this);
+}
+
+void HedgedReadChunkTask::OnLegDone(Leg* leg) {
+    const bool success =
+        !leg->cntl->Failed() &&
+        leg->response->status() == CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS;
+
+    std::unique_lock<bthread::Mutex> lk(mtx_);
+    if (finished_) {
+        lk.unlock();
+        DestroyLeg(leg);
+        Unref();
+        return;
+    }
+
+    if (leg->isFollower) {
+        followerDone_ = true;
+        if (!success) {
+            // hedge failed, result is decided by leader
+            Leg* pending = pendingLeader_;
+            pendingLeader_ = nullptr;
+            if (pending != nullptr) {
+                finished_ = true;
+            }
+            lk.unlock();
+
+            if (metric_ != nullptr) {
+                metric_->hedgedReadMetric.failed << 1;
+            }
+            DestroyLeg(leg);
+            if (pending != nullptr) {
+                Finish(pending);
+            }
+            Unref();
+            return;
+        }
+    } else if (!success && followerSent_ && !followerDone_) {
+        // leader failed, give the hedge a chance
+        pendingLeader_ = leg;
+        return;
+    }
+
+    finished_ = true;
+    Leg* pending = pendingLeader_;
+    pendingLeader_ = nullptr;
+    const bool hedgeInFlight = followerSent_ && !followerDone_;
+    const bool cancelOther = leg->isFollower || hedgeInFlight;
+    const brpc::CallId otherCallId =
+        leg->isFollower ? leaderCallId_ : followerCallId_;
+    lk.unlock();
+
+    if (metric_ != nullptr) {
+        if (leg->isFollower) {
+            metric_->hedgedReadMetric.won << 1;
+        } else if (hedgeInFlight) {
+            metric_->hedgedReadMetric.lost << 1;
+        }
+    }
+
+    if (timerAdded_ && bthread_timer_del(timerId_) == 0) {
+        // timer is not triggered yet, release its ref
+        Unref();
+    }
+
+    if (pending != nullptr) {
+        DestroyLeg(pending);
+        Unref();
+    } else if (cancelOther) {
+        brpc::StartCancel(otherCallId);
+    }
+
+    Finish(leg);
+}
+
+void HedgedReadChunkTask::Finish(Leg* leg) {
+    // hand over rpc context to ReadChunkClosure, it owns cntl and response
+    done_->SetCntl(leg->cntl);
+    done_->SetResponse(leg->response);
+    done_->SetChunkServerID(leg->csId);
+    done_->SetChunkServerEndPoint(leg->csEndPoint);
+    leg->cntl = nullptr;
+    leg->response = nullptr;
+    DestroyLeg(leg);
+
+    done_->Run();
+    Unref();
+}
+
+void HedgedReadChunkTask::DestroyLeg(Leg* leg) {
+    delete leg->cntl;
+    delete leg->response;
+    delete leg;
+}
+
+void HedgedReadChunkTask::Unref() {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete this;
+    }
+}
+
+}  // namespace client
+}  // namespace curve
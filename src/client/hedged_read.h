@@ -0,0 +1,159 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#ifndef SRC_CLIENT_HEDGED_READ_H_
+#define SRC_CLIENT_HEDGED_READ_H_
+
+#include <brpc/controller.h>
+#include <bthread/mutex.h>
+#include <bthread/unstable.h>
+#include <google/protobuf/stubs/callback.h>
+
+#include <atomic>
+#include <memory>
+
+#include "src/client/chunk_closure.h"
+#include "src/client/client_common.h"
+#include "src/client/client_metric.h"
+#include "src/client/config_info.h"
+#include "src/client/request_sender.h"
+#include "src/client/request_sender_manager.h"
+
+namespace curve {
+namespace client {
+
+class MetaCache;
+
+/**
+ * HedgedReadChunkTask sends a read request to copyset leader, and if it
+ * doesn't come back within the hedge delay, sends the same request to one of
+ * the followers. The follower serves the read only if its applied index is
+ * not less than the applied index carried by the request.
+ *
+ * The first successful response is handed to the ReadChunkClosure, and the
+ * other rpc is canceled. A failed hedge never decides the result, the leader
+ * response is always waited in that case, so retry logic in ClientClosure
+ * works the same as a normal read.
+ */
+class HedgedReadChunkTask {
+ public:
+    struct Param {
+        ChunkIDInfo idinfo;
+        off_t offset = 0;
+        size_t length = 0;
+        uint64_t appliedIndex = 0;
+        RequestSourceInfo sourceInfo;
+        uint64_t timeoutMS = 0;
+        uint64_t hedgeDelayUS = 0;
+    };
+
+    /**
+     * @brief start a hedged read
+     * @param param read request info
+     * @param leader sender to current copyset leader
+     * @param metaCache used to choose a follower
+     * @param senderManager used to get sender to the follower
+     * @param senderOpt option for creating sender
+     * @param metric file metric, can be nullptr
+     * @param done closure to run when read is done
+     */
+    static void Start(const Param& param,
+                      std::shared_ptr<RequestSender> leader,
+                      MetaCache* metaCache,
+                      RequestSenderManager* senderManager,
+                      const IOSenderOption& senderOpt,
+                      FileMetric* metric,
+                      ReadChunkClosure* done);
+
+    /**
+     * @brief calculate hedge delay by read rpc latency percentile
+     * @return delay in microseconds
+     */
+    static uint64_t CalcHedgeDelayUS(const HedgedReadOption& opt,
+                                     FileMetric* metric);
+
+ private:
+    struct Leg : public google::protobuf::Closure {
+        HedgedReadChunkTask* task = nullptr;
+        bool isFollower = false;
+        ChunkServerID csId = 0;
+        butil::EndPoint csEndPoint;
+        brpc::Controller* cntl = nullptr;
+        ChunkResponse* response = nullptr;
+
+        void Run() override;
+    };
+
+    HedgedReadChunkTask(const Param& param,
+                        MetaCache* metaCache,
+                        RequestSenderManager* senderManager,
+                        const IOSenderOption& senderOpt,
+                        FileMetric* metric,
+                        ReadChunkClosure* done);
+
+    Leg* NewLeg(bool isFollower, const RequestSender& sender);
+
+    void SendLeg(Leg* leg, RequestSender* sender);
+
+    static void OnHedgeTimer(void* arg);
+
+    void SendHedge();
+
+    std::shared_ptr<RequestSender> ChooseFollower();
+
+    void OnLegDone(Leg* leg);
+
+    void Finish(Leg* leg);
+
+    static void DestroyLeg(Leg* leg);
+
+    void Unref();
+
+ private:
+    const Param param_;
+    MetaCache* metaCache_;
+    RequestSenderManager* senderManager_;
+    const IOSenderOption senderOpt_;
+    FileMetric* metric_;
+    ReadChunkClosure* done_;
+
+    ChunkServerID leaderId_;
+
+    // refs held by leader rpc, follower rpc and hedge timer
+    std::atomic<int> refs_;
+
+    bthread::Mutex mtx_;
+    bool finished_;
+    bool timerAdded_;
+    bthread_timer_t timerId_;
+    brpc::CallId leaderCallId_;
+    brpc::CallId followerCallId_;
+    bool followerSent_;
+    bool followerDone_;
+    // leader failed while hedge is still in flight
+    Leg* pendingLeader_;
+};
+
+}  // namespace client
+}  // namespace curve
+
+#endif  // SRC_CLIENT_HEDGED_READ_H_
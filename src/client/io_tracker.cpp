@@ -43,6 +43,7 @@ using curve::chunkserver::CHUNK_OP_STATUS;
 
 std::atomic<uint64_t> IOTracker::tracekerID_(1);
 DiscardOption IOTracker::discardOption_;
+IOTraceOption IOTracker::traceOption_;
 
 IOTracker::IOTracker(IOManager* iomanager,
                      MetaCache* mc,
@@ -65,6 +66,10 @@ IOTracker::IOTracker(IOManager* iomanager,
     reqlist_.clear();
     reqcount_.store(0, std::memory_order_release);
     opStartTimePoint_ = curve::common::TimeUtility::GetTimeofDayUs();
+    sampled_    = false;
+    readahead_  = false;
+    throttleDoneTimePoint_ = 0;
+    splitDoneTimePoint_    = 0;
 }
 
 void IOTracker::ReleaseAllSegmentLocks() {
@@ -102,13 +107,20 @@ void IOTracker::StartAioRead(CurveAioContext* ctx, MDSClient* mdsclient,
 
 void IOTracker::DoRead(MDSClient* mdsclient, const FInfo_t* fileInfo,
                        Throttle* throttle) {
+    sampled_ = ShouldTrace();
+
     if (throttle) {
         throttle->Add(true, length_);
     }
 
+    if (sampled_) {
+        throttleDoneTimePoint_ = TimeUtility::GetTimeofDayUs();
+    }
+
     int ret = Splitor::IO2ChunkRequests(this, mc_, &reqlist_, nullptr, offset_,
                                         length_, mdsclient, fileInfo);
     if (ret == 0) {
+        StartStageTrace();
         PrepareReadIOBuffers(reqlist_.size());
         uint32_t subIoIndex = 0;
         std::vector<RequestContext*> originReadVec;
@@ -204,13 +216,20 @@ void IOTracker::DoWrite(MDSClient* mdsclient, const FInfo_t* fileInfo,
             break;
     }
 
+    sampled_ = ShouldTrace();
+
     if (throttle) {
         throttle->Add(false, length_);
     }
 
+    if (sampled_) {
+        throttleDoneTimePoint_ = TimeUtility::GetTimeofDayUs();
+    }
+
     int ret = Splitor::IO2ChunkRequests(this, mc_, &reqlist_, &writeData_,
                                         offset_, length_, mdsclient, fileInfo);
     if (ret == 0) {
+        StartStageTrace();
         uint32_t subIoIndex = 0;
 
         reqcount_.store(reqlist_.size(), std::memory_order_release);
@@ -428,6 +447,71 @@ void IOTracker::RecoverChunk(const ChunkIDInfo& cinfo, uint64_t offset,
     }
 }
 
+void IOTracker::CreateCloneChunks(std::vector<ChunkBatchItem>* items,
+                                  uint64_t correntSn, uint64_t chunkSize,
+                                  SnapCloneClosure* scc) {
+    type_ = OpType::CREATE_CLONE_BATCH;
+    scc_ = scc;
+
+    int ret = -1;
+    do {
+        if (items->empty()) {
+            break;
+        }
+        RequestContext* newreqNode = RequestContext::NewInitedRequestContext();
+        if (newreqNode == nullptr) {
+            break;
+        }
+
+        newreqNode->chunksize_   = chunkSize;
+        newreqNode->correctedSeq_  = correntSn;
+        newreqNode->batchItems_  = items;
+        FillCommonFields(items->front().idinfo, newreqNode);
+
+        reqlist_.push_back(newreqNode);
+        reqcount_.store(reqlist_.size(), std::memory_order_release);
+
+        ret = scheduler_->ScheduleRequest(reqlist_);
+    } while (false);
+
+    if (ret == -1) {
+        LOG(ERROR) << "CreateCloneChunks request schedule failed,"
+                   << " return and recycle resource!";
+        ReturnOnFail();
+    }
+}
+
+void IOTracker::RecoverChunks(std::vector<ChunkBatchItem>* items,
+                              SnapCloneClosure* scc) {
+    type_ = OpType::RECOVER_CHUNK_BATCH;
+    scc_ = scc;
+
+    int ret = -1;
+    do {
+        if (items->empty()) {
+            break;
+        }
+        RequestContext* newreqNode = RequestContext::NewInitedRequestContext();
+        if (newreqNode == nullptr) {
+            break;
+        }
+
+        newreqNode->batchItems_  = items;
+        FillCommonFields(items->front().idinfo, newreqNode);
+
+        reqlist_.push_back(newreqNode);
+        reqcount_.store(reqlist_.size(), std::memory_order_release);
+
+        ret = scheduler_->ScheduleRequest(reqlist_);
+    } while (false);
+
+    if (ret == -1) {
+        LOG(ERROR) << "RecoverChunks request schedule failed,"
+                   << " return and recycle resource!";
+        ReturnOnFail();
+    }
+}
+
 void IOTracker::FillCommonFields(ChunkIDInfo idinfo, RequestContext* req) {
     req->optype_      = type_;
     req->idinfo_      = idinfo;
@@ -455,6 +539,97 @@ void IOTracker::InitDiscardOption(const DiscardOption& opt) {
     discardOption_ = opt;
 }
 
+void IOTracker::InitTraceOption(const IOTraceOption& opt) {
+    traceOption_ = opt;
+}
+
+bool IOTracker::ShouldTrace() {
+    if (!traceOption_.enable) {
+        return false;
+    }
+
+    // thread local counter, avoid contention between io threads
+    static thread_local uint64_t counter = 0;
+    return counter++ % std::max<uint32_t>(traceOption_.sampleRate, 1) == 0;
+}
+
+void IOTracker::StartStageTrace() {
+    if (!sampled_) {
+        return;
+    }
+
+    splitDoneTimePoint_ = TimeUtility::GetTimeofDayUs();
+    for (auto req : reqlist_) {
+        req->trace_.sampled = true;
+        req->trace_.scheduleUs = splitDoneTimePoint_;
+    }
+}
+
+void IOTracker::RecordStageTrace() {
+    if (splitDoneTimePoint_ == 0 || fileMetric_ == nullptr) {
+        return;
+    }
+
+    const uint64_t total =
+        TimeUtility::GetTimeofDayUs() - opStartTimePoint_;
+    const uint64_t throttle = throttleDoneTimePoint_ - opStartTimePoint_;
+    const uint64_t split = splitDoneTimePoint_ - throttleDoneTimePoint_;
+
+    // sub requests are sent concurrently, so take the slowest one of
+    // each stage as the cost of that stage
+    uint64_t queue = 0;
+    uint64_t inflightWait = 0;
+    uint64_t leaderLookup = 0;
+    uint64_t rpc = 0;
+    uint64_t retryBackoff = 0;
+    for (const auto req : reqlist_) {
+        const RequestStageTrace& trace = req->trace_;
+        // fake request is not sent to chunkserver
+        if (trace.dequeueUs == 0) {
+            continue;
+        }
+
+        queue = std::max(queue, trace.dequeueUs - trace.scheduleUs);
+        if (trace.tokenUs != 0) {
+            inflightWait =
+                std::max(inflightWait, trace.tokenUs - trace.dequeueUs);
+        }
+        leaderLookup = std::max(leaderLookup, trace.leaderLookupUs);
+        rpc = std::max(rpc, trace.rpcUs);
+        retryBackoff = std::max(retryBackoff, trace.retryBackoffUs);
+    }
+
+    IOStageMetric& metric = fileMetric_->ioStageMetric;
+    metric.throttle << throttle;
+    metric.split << split;
+    metric.queue << queue;
+    metric.inflightWait << inflightWait;
+    metric.leaderLookup << leaderLookup;
+    metric.rpc << rpc;
+    metric.retryBackoff << retryBackoff;
+    metric.total << total;
+
+    if (total < traceOption_.slowIOThresholdMS * 1000ull) {
+        return;
+    }
+
+    metric.slowIO << 1;
+    LOG(WARNING) << "slow io, file = " << fileMetric_->filename
+                 << ", OpType = " << OpTypeToString(type_)
+                 << ", offset = " << offset_
+                 << ", length = " << length_
+                 << ", request count = " << reqlist_.size()
+                 << ", IO id = " << id_
+                 << ", total(us) = " << total
+                 << ", throttle = " << throttle
+                 << ", split = " << split
+                 << ", queue = " << queue
+                 << ", inflight wait = " << inflightWait
+                 << ", leader lookup = " << leaderLookup
+                 << ", rpc = " << rpc
+                 << ", retry backoff = " << retryBackoff;
+}
+
 int IOTracker::Wait() {
     return iocv_.Wait();
 }
@@ -466,8 +641,13 @@ void IOTracker::Done() {
 
     if (errcode_ == LIBCURVE_ERROR::OK) {
         uint64_t duration = TimeUtility::GetTimeofDayUs() - opStartTimePoint_;
-        MetricHelper::UserLatencyRecord(fileMetric_, duration, type_);
-        MetricHelper::IncremUserQPSCount(fileMetric_, length_, type_);
+        if (!readahead_) {
+            MetricHelper::UserLatencyRecord(fileMetric_, duration, type_);
+            MetricHelper::IncremUserQPSCount(fileMetric_, length_, type_);
+        } else if (fileMetric_ != nullptr) {
+            fileMetric_->readaheadMetric.latency << duration;
+            fileMetric_->readaheadMetric.completedBytes << length_;
+        }
 
         // copy read data to user buffer
         if (OpType::READ == type_ || OpType::READ_SNAP == type_) {
@@ -503,7 +683,11 @@ void IOTracker::Done() {
             }
         }
     } else {
-        MetricHelper::IncremUserEPSCount(fileMetric_, type_);
+        if (!readahead_) {
+            MetricHelper::IncremUserEPSCount(fileMetric_, type_);
+        } else if (fileMetric_ != nullptr) {
+            fileMetric_->readaheadMetric.failed << 1;
+        }
         if (type_ == OpType::READ || type_ == OpType::WRITE) {
             LOG(ERROR) << "file [" << fileMetric_->filename << "]"
                     << ", IO Error, OpType = " << OpTypeToString(type_)
@@ -520,8 +704,17 @@ void IOTracker::Done() {
         }
     }
 
+    if (sampled_) {
+        RecordStageTrace();
+    }
+
     DestoryRequestList();
 
+    // 在通知用户之前处理IO结束，保证用户看到IO结束时其影响已经生效
+    if (iomanager_ != nullptr) {
+        iomanager_->HandleIODone(this);
+    }
+
     // scc_和aioctx都为空的时候肯定是个同步调用
     if (scc_ == nullptr && aioctx_ == nullptr) {
         iocv_.Complete(ToReturnCode());
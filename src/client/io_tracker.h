@@ -170,6 +170,34 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
     void RecoverChunk(const ChunkIDInfo& chunkIdInfo, uint64_t offset,
                       uint64_t len, SnapCloneClosure* scc);
 
+    /**
+     * @brief 批量创建同一个copyset上的clone chunk
+     * @param:items 需要创建的chunk, 每个chunk的结果填在其中
+     * @param:correntSn CreateCloneChunk时候用于修改chunk的correctedSn
+     * @param:chunkSize chunk的大小
+     * @param: scc是异步回调
+     */
+    void CreateCloneChunks(std::vector<ChunkBatchItem>* items,
+                           uint64_t correntSn, uint64_t chunkSize,
+                           SnapCloneClosure* scc);
+
+    /**
+     * @brief 批量恢复同一个copyset上的chunk数据
+     * @param:items 需要恢复的chunk, 每个chunk的结果填在其中
+     * @param: scc是异步回调
+     */
+    void RecoverChunks(std::vector<ChunkBatchItem>* items,
+                       SnapCloneClosure* scc);
+
+    /**
+     * chunkserver errcode转化为libcurve client的errode
+     * @param: errcode为chunkserver侧的errode
+     * @param[out]: errout为libcurve自己的errode
+     */
+    static void ChunkServerErr2LibcurveErr(
+        curve::chunkserver::CHUNK_OP_STATUS errcode,
+        LIBCURVE_ERROR* errout);
+
     /**
      * Wait用于同步接口等待，因为用户下来的IO被client内部线程接管之后
      * 调用就可以向上返回了，但是用户的同步IO语意是要等到结果返回才能向上
@@ -223,8 +251,24 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
         return disableStripe_;
     }
 
+    // readahead issued by client itself is counted in readahead metric
+    // instead of user io metric
+    void SetReadahead() {
+        readahead_ = true;
+    }
+
+    off_t Offset() const {
+        return offset_;
+    }
+
+    uint64_t Length() const {
+        return length_;
+    }
+
     static void InitDiscardOption(const DiscardOption& opt);
 
+    static void InitTraceOption(const IOTraceOption& opt);
+
  private:
     void ReleaseAllSegmentLocks();
 
@@ -237,6 +281,23 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
      * 在io拆分或者，io分发失败的时候需要调用，设置返回状态，并向上返回
      */
     void ReturnOnFail();
+
+    /**
+     * @brief decide whether current io is traced, one of every
+     *        sampleRate read/write io is sampled
+     */
+    static bool ShouldTrace();
+
+    /**
+     * @brief mark all sub requests as sampled after io is split
+     */
+    void StartStageTrace();
+
+    /**
+     * @brief record latency of each stage of a sampled io, and log the
+     *        breakdown if it's slow
+     */
+    void RecordStageTrace();
     /**
      * 用户下来的大IO会被拆分成多个子IO，这里在返回之前将子IO资源回收
      */
@@ -249,14 +310,6 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
      */
     void FillCommonFields(ChunkIDInfo idinfo, RequestContext* req);
 
-    /**
-     * chunkserver errcode转化为libcurve client的errode
-     * @param: errcode为chunkserver侧的errode
-     * @param[out]: errout为libcurve自己的errode
-     */
-    void ChunkServerErr2LibcurveErr(curve::chunkserver::CHUNK_OP_STATUS errcode,
-                                    LIBCURVE_ERROR* errout);
-
     /**
      * 获取一个初始化后的RequestContext
      * return: 如果分配失败或者初始化失败，返回nullptr
@@ -346,6 +399,14 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
     // 发起时间
     uint64_t opStartTimePoint_;
 
+    // whether current io is sampled by io stage trace
+    bool sampled_;
+    // whether current io is a readahead
+    bool readahead_;
+    // time of passing throttle and finishing split, only for sampled io
+    uint64_t throttleDoneTimePoint_;
+    uint64_t splitDoneTimePoint_;
+
     // client端的metric统计信息
     FileMetric* fileMetric_;
 
@@ -365,6 +426,8 @@ class CURVE_CACHELINE_ALIGNMENT IOTracker {
     static std::atomic<uint64_t> tracekerID_;
 
     static DiscardOption discardOption_;
+
+    static IOTraceOption traceOption_;
 };
 }   // namespace client
 }   // namespace curve
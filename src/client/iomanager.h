@@ -66,6 +66,12 @@ class IOManager {
      */
     virtual void HandleAsyncIOResponse(IOTracker* iotracker) = 0;
 
+    /**
+     * @brief IO处理结束、通知用户之前调用
+     * @param: iotracker是处理结束的IO
+     */
+    virtual void HandleIODone(IOTracker* iotracker) {}
+
  protected:
     // iomanager id目的是为了让底层RPC知道自己归属于哪个iomanager
     IOManagerID id_;
@@ -98,6 +98,22 @@ int IOManager4Chunk::RecoverChunk(const ChunkIDInfo& chunkIdInfo,
     return 0;
 }
 
+int IOManager4Chunk::CreateCloneChunks(std::vector<ChunkBatchItem>* items,
+                                       uint64_t correntSn,
+                                       uint64_t chunkSize,
+                                       SnapCloneClosure* scc) {
+    IOTracker* ioTracker = new IOTracker(this, &mc_, scheduler_);
+    ioTracker->CreateCloneChunks(items, correntSn, chunkSize, scc);
+    return 0;
+}
+
+int IOManager4Chunk::RecoverChunks(std::vector<ChunkBatchItem>* items,
+                                   SnapCloneClosure* scc) {
+    IOTracker* ioTracker = new IOTracker(this, &mc_, scheduler_);
+    ioTracker->RecoverChunks(items, scc);
+    return 0;
+}
+
 void IOManager4Chunk::HandleAsyncIOResponse(IOTracker* iotracker) {
     delete iotracker;
 }
@@ -26,6 +26,7 @@
 #include <atomic>
 #include <mutex>    // NOLINT
 #include <string>
+#include <vector>
 #include <condition_variable>   // NOLINT
 
 #include "src/client/metacache.h"
@@ -108,6 +109,30 @@ class IOManager4Chunk : public IOManager {
     int RecoverChunk(const ChunkIDInfo& chunkIdInfo, uint64_t offset,
                      uint64_t len, SnapCloneClosure* scc);
 
+    /**
+     * @brief 批量创建同一个copyset上的clone chunk
+     * @param:items 需要创建的chunk, 由调用方持有直到scc被调用,
+     *              每个chunk的结果填在其中
+     * @param:correntSn CreateCloneChunk时候用于修改chunk的correctedSn
+     * @param:chunkSize chunk的大小
+     * @param: scc是异步回调
+     * @return 成功返回0， 否则-1
+     */
+    int CreateCloneChunks(std::vector<ChunkBatchItem>* items,
+                          uint64_t correntSn,
+                          uint64_t chunkSize,
+                          SnapCloneClosure* scc);
+
+    /**
+     * @brief 批量恢复同一个copyset上的chunk数据
+     * @param items 需要恢复的chunk, 由调用方持有直到scc被调用,
+     *              每个chunk的结果填在其中
+     * @param scc 异步回调
+     * @return 成功返回0， 否则-1
+     */
+    int RecoverChunks(std::vector<ChunkBatchItem>* items,
+                      SnapCloneClosure* scc);
+
     /**
      * 因为curve client底层都是异步IO，每个IO会分配一个IOtracker跟踪IO
      * 当这个IO做完之后，底层需要告知当前io manager来释放这个IOTracker，
@@ -22,7 +22,13 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <chrono>   // NOLINT
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
 
 #include "src/client/metacache.h"
 #include "src/client/iomanager4file.h"
@@ -32,8 +38,33 @@
 
 namespace curve {
 namespace client {
+
+namespace {
+
+struct ReadaheadAioContext : public CurveAioContext {
+    ReadaheadCache* cache;
+    ReadaheadRange range;
+    butil::IOBuf data;
+};
+
+void ReadaheadCallback(CurveAioContext* ctx) {
+    ReadaheadAioContext* raCtx = static_cast<ReadaheadAioContext*>(ctx);
+    if (ctx->ret == static_cast<int>(raCtx->range.length)) {
+        raCtx->cache->Insert(raCtx->range, raCtx->data);
+    } else {
+        LOG(WARNING) << "readahead failed, offset = " << raCtx->range.offset
+                     << ", length = " << raCtx->range.length
+                     << ", ret = " << ctx->ret;
+    }
+
+    delete raCtx;
+}
+
+}  // namespace
+
 Atomic<uint64_t> IOManager::idRecorder_(1);
-IOManager4File::IOManager4File() : scheduler_(nullptr), exit_(false) {}
+IOManager4File::IOManager4File()
+    : scheduler_(nullptr), exit_(false), stopPrefetch_(false) {}
 
 bool IOManager4File::Initialize(const std::string& filename,
                                 const IOOption& ioOpt,
@@ -44,6 +75,7 @@ bool IOManager4File::Initialize(const std::string& filename,
     mc_.Init(ioopt_.metaCacheOpt, mdsclient);
 
     IOTracker::InitDiscardOption(ioopt_.discardOption);
+    IOTracker::InitTraceOption(ioopt_.ioTraceOpt);
     Splitor::Init(ioopt_.ioSplitOpt);
 
     inflightRpcCntl_.SetMaxInflightNum(
@@ -87,6 +119,11 @@ bool IOManager4File::Initialize(const std::string& filename,
     discardTaskManager_.reset(
         new DiscardTaskManager(&(fileMetric_->discardMetric)));
 
+    if (ioopt_.readaheadOpt.enable) {
+        readaheadCache_.reset(new ReadaheadCache(
+            ioopt_.readaheadOpt, &(fileMetric_->readaheadMetric)));
+    }
+
     LOG(INFO) << "iomanager init success, conf info: "
               << "isolationTaskThreadPoolSize = "
               << ioopt_.taskThreadOpt.isolationTaskThreadPoolSize
@@ -96,6 +133,12 @@ bool IOManager4File::Initialize(const std::string& filename,
 }
 
 void IOManager4File::UnInitialize() {
+    // stop segment prefetch, it may still be waiting for mds
+    stopPrefetch_.store(true, std::memory_order_relaxed);
+    if (prefetchThread_.joinable()) {
+        prefetchThread_.join();
+    }
+
     // stop throttle first
     if (throttle_) {
         throttle_->Stop();
@@ -127,6 +170,9 @@ void IOManager4File::UnInitialize() {
 
     discardTaskManager_->Stop();
 
+    // all readahead have come back after waiting inflight io
+    readaheadCache_.reset();
+
     {
         // 这个锁保证设置exit_和delete scheduler_是原子的
         // 这样保证在scheduler_被析构的时候lease线程不会使用scheduler_
@@ -147,11 +193,34 @@ int IOManager4File::Read(char* buf, off_t offset,
 
     butil::IOBuf data;
 
+    ReadaheadRange range;
+    bool needReadahead = false;
+    if (readaheadCache_) {
+        bool hit = readaheadCache_->Read(offset, length, &data);
+        needReadahead = readaheadCache_->OnUserRead(
+            offset, length, GetFileInfo()->length, &range);
+        if (hit) {
+            if (needReadahead) {
+                DoReadahead(range, mdsclient);
+            }
+
+            MetricHelper::IncremUserQPSCount(fileMetric_, length,
+                                             OpType::READ);
+            size_t nc = data.copy_to(buf, length);
+            return nc == length ? static_cast<int>(length)
+                                : -LIBCURVE_ERROR::FAILED;
+        }
+    }
+
     IOTracker temp(this, &mc_, scheduler_, fileMetric_, disableStripe_);
     temp.SetUserDataType(UserDataType::IOBuffer);
     temp.StartRead(&data, offset, length, mdsclient, this->GetFileInfo(),
                    throttle_.get());
 
+    if (needReadahead) {
+        DoReadahead(range, mdsclient);
+    }
+
     int rc = temp.Wait();
 
     if (rc < 0) {
@@ -168,6 +237,7 @@ int IOManager4File::Write(const char* buf,
                           MDSClient* mdsclient) {
     MetricHelper::IncremUserRPSCount(fileMetric_, OpType::WRITE);
     FlightIOGuard guard(this);
+    InvalidateReadahead(offset, length);
 
     butil::IOBuf data;
     data.append_user_data(const_cast<char*>(buf), length, TrivialDeleter);
@@ -196,7 +266,12 @@ int IOManager4File::AioRead(CurveAioContext* ctx, MDSClient* mdsclient,
 
     temp->SetUserDataType(dataType);
     inflightCntl_.IncremInflightNum();
-    auto task = [this, ctx, mdsclient, temp]() {
+    auto task = [this, ctx, mdsclient, temp, dataType]() {
+        if (readaheadCache_) {
+            AioReadWithReadahead(ctx, mdsclient, temp, dataType);
+            return;
+        }
+
         temp->StartAioRead(ctx, mdsclient, this->GetFileInfo(),
                            throttle_.get());
     };
@@ -220,6 +295,7 @@ int IOManager4File::AioWrite(CurveAioContext* ctx, MDSClient* mdsclient,
 
     temp->SetUserDataType(dataType);
     inflightCntl_.IncremInflightNum();
+    InvalidateReadahead(ctx->offset, ctx->length);
     auto task = [this, ctx, mdsclient, temp]() {
         temp->StartAioWrite(ctx, mdsclient, this->GetFileInfo(),
                             throttle_.get());
@@ -237,6 +313,7 @@ int IOManager4File::Discard(off_t offset, size_t length, MDSClient* mdsclient) {
     }
 
     FlightIOGuard guard(this);
+    InvalidateReadahead(offset, length);
 
     IOTracker tracker(this, &mc_, scheduler_, fileMetric_);
     tracker.StartDiscard(offset, length, mdsclient, GetFileInfo(),
@@ -264,6 +341,7 @@ int IOManager4File::AioDiscard(CurveAioContext* aioctx, MDSClient* mdsclient) {
     }
 
     inflightCntl_.IncremInflightNum();
+    InvalidateReadahead(aioctx->offset, aioctx->length);
     auto task = [this, aioctx, mdsclient, ioTracker]() {
         ioTracker->StartAioDiscard(aioctx, mdsclient, this->GetFileInfo(),
                                    discardTaskManager_.get());
@@ -273,6 +351,272 @@ int IOManager4File::AioDiscard(CurveAioContext* aioctx, MDSClient* mdsclient) {
     return LIBCURVE_ERROR::OK;
 }
 
+int IOManager4File::AioSubmit(CurveAioContext** aioctxs, size_t count,
+                              MDSClient* mdsclient, UserDataType dataType) {
+    using AioBatch = std::vector<std::pair<CurveAioContext*, IOTracker*>>;
+    std::shared_ptr<AioBatch> batch = std::make_shared<AioBatch>();
+    batch->reserve(count);
+
+    // trackers are created in caller thread, and started in one task
+    for (size_t i = 0; i < count; ++i) {
+        CurveAioContext* ctx = aioctxs[i];
+        const bool isDiscard = ctx->op == LIBCURVE_OP::LIBCURVE_OP_DISCARD;
+        MetricHelper::IncremUserRPSCount(
+            fileMetric_, isDiscard ? OpType::DISCARD
+                                   : (ctx->op == LIBCURVE_OP::LIBCURVE_OP_READ
+                                          ? OpType::READ
+                                          : OpType::WRITE));
+
+        if (ctx->length == 0 || (isDiscard && !IsNeedDiscard(ctx->length))) {
+            ctx->ret = 0;
+            ctx->cb(ctx);
+            continue;
+        }
+
+        IOTracker* tracker = new (std::nothrow) IOTracker(
+            this, &mc_, scheduler_, fileMetric_,
+            isDiscard ? false : disableStripe_);
+        if (tracker == nullptr) {
+            ctx->ret = -LIBCURVE_ERROR::FAILED;
+            ctx->cb(ctx);
+            LOG(ERROR) << "allocate tracker failed!";
+            continue;
+        }
+
+        if (!isDiscard) {
+            tracker->SetUserDataType(dataType);
+        }
+        if (ctx->op != LIBCURVE_OP::LIBCURVE_OP_READ) {
+            InvalidateReadahead(ctx->offset, ctx->length);
+        }
+
+        inflightCntl_.IncremInflightNum();
+        batch->emplace_back(ctx, tracker);
+    }
+
+    if (batch->empty()) {
+        return LIBCURVE_ERROR::OK;
+    }
+
+    auto task = [this, mdsclient, dataType, batch]() {
+        for (const auto& item : *batch) {
+            CurveAioContext* ctx = item.first;
+            IOTracker* tracker = item.second;
+            switch (ctx->op) {
+                case LIBCURVE_OP::LIBCURVE_OP_READ:
+                    if (readaheadCache_) {
+                        AioReadWithReadahead(ctx, mdsclient, tracker,
+                                             dataType);
+                    } else {
+                        tracker->StartAioRead(ctx, mdsclient, GetFileInfo(),
+                                              throttle_.get());
+                    }
+                    break;
+                case LIBCURVE_OP::LIBCURVE_OP_WRITE:
+                    tracker->StartAioWrite(ctx, mdsclient, GetFileInfo(),
+                                           throttle_.get());
+                    break;
+                default:
+                    tracker->StartAioDiscard(ctx, mdsclient, GetFileInfo(),
+                                             discardTaskManager_.get());
+                    break;
+            }
+        }
+    };
+
+    taskPool_.Enqueue(task);
+    return LIBCURVE_ERROR::OK;
+}
+
+void IOManager4File::AioReadWithReadahead(CurveAioContext* ctx,
+                                          MDSClient* mdsclient,
+                                          IOTracker* tracker,
+                                          UserDataType dataType) {
+    // hold inflight count until readahead is issued, so that UnInitialize
+    // will wait for it even if user io has already come back
+    FlightIOGuard guard(this);
+
+    butil::IOBuf data;
+    bool hit = readaheadCache_->Read(ctx->offset, ctx->length, &data);
+
+    ReadaheadRange range;
+    bool needReadahead = readaheadCache_->OnUserRead(
+        ctx->offset, ctx->length, GetFileInfo()->length, &range);
+
+    if (!hit) {
+        tracker->StartAioRead(ctx, mdsclient, GetFileInfo(), throttle_.get());
+    } else {
+        switch (dataType) {
+            case UserDataType::RawBuffer:
+                data.copy_to(ctx->buf, ctx->length);
+                break;
+            case UserDataType::IOBuffer:
+                *reinterpret_cast<butil::IOBuf*>(ctx->buf) = data;
+                break;
+        }
+
+        MetricHelper::IncremUserQPSCount(fileMetric_, ctx->length,
+                                         OpType::READ);
+        ctx->ret = ctx->length;
+        ctx->cb(ctx);
+        HandleAsyncIOResponse(tracker);
+    }
+
+    if (needReadahead) {
+        DoReadahead(range, mdsclient);
+    }
+}
+
+void IOManager4File::DoReadahead(const ReadaheadRange& range,
+                                 MDSClient* mdsclient) {
+    ReadaheadAioContext* raCtx = new (std::nothrow) ReadaheadAioContext();
+    IOTracker* tracker = new (std::nothrow)
+        IOTracker(this, &mc_, scheduler_, fileMetric_, disableStripe_);
+    if (raCtx == nullptr || tracker == nullptr) {
+        LOG(ERROR) << "allocate readahead context failed!";
+        delete raCtx;
+        delete tracker;
+        return;
+    }
+
+    raCtx->offset = range.offset;
+    raCtx->length = range.length;
+    raCtx->op = LIBCURVE_OP_READ;
+    raCtx->cb = ReadaheadCallback;
+    raCtx->buf = &raCtx->data;
+    raCtx->cache = readaheadCache_.get();
+    raCtx->range = range;
+
+    DVLOG(9) << "issue readahead, offset = " << range.offset
+             << ", length = " << range.length;
+
+    // readahead takes the same throttle tokens as user read
+    tracker->SetUserDataType(UserDataType::IOBuffer);
+    tracker->SetReadahead();
+    inflightCntl_.IncremInflightNum();
+    tracker->StartAioRead(raCtx, mdsclient, GetFileInfo(), throttle_.get());
+}
+
+void IOManager4File::PrefetchSegments(MDSClient* mdsclient) {
+    if (!ioopt_.metaCacheOpt.segmentPrefetchOpt.enable) {
+        return;
+    }
+
+    if (prefetchThread_.joinable()) {
+        // reopen, metacache is already warmed up
+        return;
+    }
+
+    if (ioopt_.metaCacheOpt.segmentPrefetchOpt.async) {
+        prefetchThread_ = std::thread(&IOManager4File::DoPrefetchSegments,
+                                      this, mdsclient);
+    } else {
+        DoPrefetchSegments(mdsclient);
+    }
+}
+
+void IOManager4File::DoPrefetchSegments(MDSClient* mdsclient) {
+    const FInfo fileInfo = *mc_.GetFileInfo();
+    if (fileInfo.segmentsize == 0 || fileInfo.chunksize == 0) {
+        return;
+    }
+
+    std::vector<SegmentInfo> segInfos;
+    LIBCURVE_ERROR errCode =
+        mdsclient->ListSegment(&fileInfo, 0, 0, &segInfos);
+    if (errCode != LIBCURVE_ERROR::OK) {
+        LOG(WARNING) << "prefetch segments failed, filename = "
+                     << fileInfo.fullPathName << ", error = " << errCode;
+        return;
+    }
+
+    // group copysets by logical pool, skip those already in metacache
+    std::map<LogicPoolID, std::set<CopysetID>> copysets;
+    for (const auto& segInfo : segInfos) {
+        for (auto cpid : segInfo.lpcpIDInfo.cpidVec) {
+            if (mc_.GetCopysetinfo(segInfo.lpcpIDInfo.lpid, cpid)
+                    .csinfos_.empty()) {
+                copysets[segInfo.lpcpIDInfo.lpid].insert(cpid);
+            }
+        }
+    }
+
+    // copyset info must be ready before chunk info is visible to IO path
+    const uint32_t batchSize =
+        std::max<uint32_t>(1,
+            ioopt_.metaCacheOpt.segmentPrefetchOpt.copysetBatchSize);
+    for (const auto& pool : copysets) {
+        std::vector<CopysetID> batch;
+        for (auto cpid : pool.second) {
+            batch.push_back(cpid);
+            if (batch.size() >= batchSize) {
+                if (stopPrefetch_.load(std::memory_order_relaxed) ||
+                    !PrefetchCopysets(mdsclient, pool.first, batch)) {
+                    return;
+                }
+                batch.clear();
+            }
+        }
+
+        if (!batch.empty()) {
+            if (stopPrefetch_.load(std::memory_order_relaxed) ||
+                !PrefetchCopysets(mdsclient, pool.first, batch)) {
+                return;
+            }
+        }
+    }
+
+    for (const auto& segInfo : segInfos) {
+        if (stopPrefetch_.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        SegmentIndex segmentIndex = segInfo.startoffset / fileInfo.segmentsize;
+        FileSegment* fileSegment = mc_.GetFileSegment(segmentIndex);
+        FileSegmentReadLockGuard lk(fileSegment);
+
+        uint64_t chunkOffset = segInfo.startoffset;
+        for (const auto& chunkIdInfo : segInfo.chunkvec) {
+            ChunkIndex chunkIdx = chunkOffset / fileInfo.chunksize;
+            chunkOffset += fileInfo.chunksize;
+
+            // IO path may already have fetched this chunk
+            ChunkIDInfo cached;
+            if (mc_.GetChunkInfoByIndex(chunkIdx, &cached) ==
+                MetaCacheErrorType::OK) {
+                continue;
+            }
+            mc_.UpdateChunkInfoByIndex(chunkIdx, chunkIdInfo);
+        }
+    }
+
+    LOG(INFO) << "prefetch segments success, filename = "
+              << fileInfo.fullPathName
+              << ", segment num = " << segInfos.size();
+}
+
+bool IOManager4File::PrefetchCopysets(MDSClient* mdsclient, LogicPoolID lpid,
+                                      const std::vector<CopysetID>& copysets) {
+    std::vector<CopysetInfo> copysetInfos;
+    LIBCURVE_ERROR errCode =
+        mdsclient->GetServerList(lpid, copysets, &copysetInfos);
+    if (errCode != LIBCURVE_ERROR::OK) {
+        LOG(WARNING) << "prefetch copysets failed, logicpool id = " << lpid
+                     << ", copyset num = " << copysets.size();
+        return false;
+    }
+
+    for (const auto& copysetInfo : copysetInfos) {
+        for (const auto& peerInfo : copysetInfo.csinfos_) {
+            mc_.AddCopysetIDInfo(peerInfo.chunkserverID,
+                                 CopysetIDInfo(lpid, copysetInfo.cpid_));
+        }
+        mc_.UpdateCopysetInfo(lpid, copysetInfo.cpid_, copysetInfo);
+    }
+
+    return true;
+}
+
 void IOManager4File::UpdateFileInfo(const FInfo_t& fi) {
     mc_.UpdateFileInfo(fi);
 }
@@ -293,6 +637,15 @@ void IOManager4File::HandleAsyncIOResponse(IOTracker* iotracker) {
     delete iotracker;
 }
 
+void IOManager4File::HandleIODone(IOTracker* iotracker) {
+    // readahead issued while the write or discard is inflight may read old
+    // data, invalidate again so that it is dropped or evicted
+    const OpType type = iotracker->Optype();
+    if (type == OpType::WRITE || type == OpType::DISCARD) {
+        InvalidateReadahead(iotracker->Offset(), iotracker->Length());
+    }
+}
+
 bool IOManager4File::IsNeedDiscard(size_t len) const {
     if (ioopt_.discardOption.enable &&
         len >= ioopt_.metaCacheOpt.discardGranularity) {
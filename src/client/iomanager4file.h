@@ -31,6 +31,7 @@
 #include <mutex>               // NOLINT
 #include <string>
 #include <memory>
+#include <thread>  // NOLINT
 
 #include "include/curve_compiler_specific.h"
 #include "src/client/client_common.h"
@@ -43,6 +44,7 @@
 #include "src/common/concurrent/task_thread_pool.h"
 #include "src/common/throttle.h"
 #include "src/client/discard_task.h"
+#include "src/client/readahead_cache.h"
 
 namespace curve {
 namespace client {
@@ -127,6 +129,20 @@ class IOManager4File : public IOManager {
      */
     int AioDiscard(CurveAioContext* aioctx, MDSClient* mdsclient);
 
+    /**
+     * @brief Submit a batch of asynchronous read/write/discard requests,
+     *        all requests are started in order by one task, so the cost of
+     *        entering task queue is paid once for the whole batch
+     * @param aioctxs async request contexts, op of each one decides the
+     *        request type, contexts are validated by caller
+     * @param count number of contexts
+     * @param mdsclient for communicate with MDS
+     * @param dataType type of aioctx->buf of read/write requests
+     * @return 0 means success, otherwise it means failure
+     */
+    int AioSubmit(CurveAioContext** aioctxs, size_t count,
+                  MDSClient* mdsclient, UserDataType dataType);
+
     /**
      * @brief 获取rpc发送令牌
      */
@@ -181,6 +197,15 @@ class IOManager4File : public IOManager {
         return mc_.GetFileInfo();
     }
 
+    /**
+     * @brief list all allocated segments of current file and their copysets
+     *        from mds, and fill them into metacache, so that the first IO on
+     *        each segment doesn't need to ask mds again.
+     *        Failure is ignored, segments are still fetched on demand.
+     * @param mdsclient used to communicate with mds
+     */
+    void PrefetchSegments(MDSClient* mdsclient);
+
     /**
      * 返回文件最新版本号
      */
@@ -235,6 +260,12 @@ class IOManager4File : public IOManager {
      */
     void HandleAsyncIOResponse(IOTracker* iotracker) override;
 
+    /**
+     * 写和discard结束时再次失效预读缓存，丢弃期间发起的预读读到的旧数据
+     * @param: iotracker是处理结束的IO
+     */
+    void HandleIODone(IOTracker* iotracker) override;
+
     class FlightIOGuard {
      public:
         explicit FlightIOGuard(IOManager4File* iomana) {
@@ -252,6 +283,39 @@ class IOManager4File : public IOManager {
 
     bool IsNeedDiscard(size_t len) const;
 
+    void DoPrefetchSegments(MDSClient* mdsclient);
+
+    /**
+     * @brief get server list of copysets in batch and update metacache
+     * @return true if success
+     */
+    bool PrefetchCopysets(MDSClient* mdsclient, LogicPoolID lpid,
+                          const std::vector<CopysetID>& copysets);
+
+    /**
+     * @brief serve an async read with readahead cache enabled,
+     *        the read is either served by the cache or sent by tracker,
+     *        and a readahead is issued if sequential pattern is detected
+     */
+    void AioReadWithReadahead(CurveAioContext* ctx, MDSClient* mdsclient,
+                              IOTracker* tracker, UserDataType dataType);
+
+    /**
+     * @brief issue a readahead through the normal read path,
+     *        data is inserted into readahead cache when it comes back
+     */
+    void DoReadahead(const ReadaheadRange& range, MDSClient* mdsclient);
+
+    /**
+     * @brief invalidate cached data before write or discard,
+     *        and again when it is done
+     */
+    void InvalidateReadahead(off_t offset, size_t length) {
+        if (readaheadCache_) {
+            readaheadCache_->Invalidate(offset, length);
+        }
+    }
+
  private:
     // 每个IOManager都有其IO配置，保存在iooption里
     IOOption ioopt_;
@@ -298,6 +362,13 @@ class IOManager4File : public IOManager {
     bool disableStripe_;
 
     std::unique_ptr<DiscardTaskManager> discardTaskManager_;
+
+    // sequential readahead and read cache, nullptr if disabled
+    std::unique_ptr<ReadaheadCache> readaheadCache_;
+
+    // background segment prefetch thread
+    std::thread prefetchThread_;
+    std::atomic<bool> stopPrefetch_;
 };
 
 }  // namespace client
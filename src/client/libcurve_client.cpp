@@ -123,6 +123,11 @@ int CurveClient::AioDiscard(int fd, CurveAioContext* aioctx) {
     return fileClient_->AioDiscard(fd, aioctx);
 }
 
+int CurveClient::AioSubmit(int fd, CurveAioContext** aioctxs, size_t count,
+                           UserDataType dataType) {
+    return fileClient_->AioSubmit(fd, aioctxs, count, dataType);
+}
+
 void CurveClient::SetFileClient(FileClient* client) {
     delete fileClient_;
     fileClient_ = client;
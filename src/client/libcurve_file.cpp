@@ -401,6 +401,44 @@ int FileClient::AioDiscard(int fd, CurveAioContext* aioctx) {
     }
 }
 
+int FileClient::AioSubmit(int fd, CurveAioContext** aioctxs, size_t count,
+                          UserDataType dataType) {
+    if (count == 0) {
+        return -LIBCURVE_ERROR::OK;
+    }
+
+    if (aioctxs == nullptr) {
+        LOG(ERROR) << "AioSubmit with null contexts, fd = " << fd;
+        return -LIBCURVE_ERROR::FAILED;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const CurveAioContext* ctx = aioctxs[i];
+        if (ctx == nullptr || ctx->op >= LIBCURVE_OP::LIBCURVE_OP_MAX) {
+            LOG(ERROR) << "AioSubmit with invalid context, index = " << i
+                       << ", fd = " << fd;
+            return -LIBCURVE_ERROR::FAILED;
+        }
+
+        if (ctx->op != LIBCURVE_OP::LIBCURVE_OP_DISCARD &&
+            CheckAligned(ctx->offset, ctx->length) == false) {
+            LOG(ERROR) << "AioSubmit request not aligned, index = " << i
+                       << ", length = " << ctx->length
+                       << ", offset = " << ctx->offset << ", fd = " << fd;
+            return -LIBCURVE_ERROR::NOT_ALIGNED;
+        }
+    }
+
+    ReadLockGuard lk(rwlock_);
+    auto iter = fileserviceMap_.find(fd);
+    if (CURVE_UNLIKELY(iter == fileserviceMap_.end())) {
+        LOG(ERROR) << "invalid fd!";
+        return -LIBCURVE_ERROR::BAD_FD;
+    }
+
+    return iter->second->AioSubmit(aioctxs, count, dataType);
+}
+
 int FileClient::Rename(const UserInfo_t& userinfo,
     const std::string& oldpath, const std::string& newpath) {
     LIBCURVE_ERROR ret;
@@ -803,6 +841,16 @@ int AioDiscard(int fd, CurveAioContext* aioctx) {
     return globalclient->AioDiscard(fd, aioctx);
 }
 
+int AioSubmit(int fd, CurveAioContext** aioctxs, size_t count) {
+    if (globalclient == nullptr) {
+        LOG(ERROR) << "not inited!";
+        return -LIBCURVE_ERROR::FAILED;
+    }
+
+    DVLOG(9) << "AioSubmit fd: " << fd << " count: " << count;
+    return globalclient->AioSubmit(fd, aioctxs, count);
+}
+
 int Create(const char* filename, const C_UserInfo_t* userinfo, size_t size) {
     if (globalclient == nullptr) {
         LOG(ERROR) << "not inited!";
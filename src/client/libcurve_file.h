@@ -187,6 +187,21 @@ class FileClient {
      */
     virtual int AioDiscard(int fd, CurveAioContext* aioctx);
 
+    /**
+     * @brief Submit a batch of asynchronous read/write/discard requests,
+     *        fd is looked up only once for the whole batch.
+     *        The batch is validated before submitting, if any context is
+     *        invalid, none of them is submitted.
+     * @param fd file descriptor
+     * @param aioctxs async request contexts, op of each one decides the
+     *        request type, cb is called once for every context
+     * @param count number of contexts
+     * @param dataType type of aioctx->buf, default is `UserDataType::RawBuffer`
+     * @return 0 means success, otherwise it means failure
+     */
+    virtual int AioSubmit(int fd, CurveAioContext** aioctxs, size_t count,
+                          UserDataType dataType = UserDataType::RawBuffer);
+
     /**
      * 重命名文件
      * @param: userinfo是用户信息
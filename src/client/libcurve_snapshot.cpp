@@ -267,6 +267,19 @@ int SnapshotClient::RecoverChunk(const ChunkIDInfo &chunkidinfo,
     return iomanager4chunk_.RecoverChunk(chunkidinfo, offset, len, scc);
 }
 
+int SnapshotClient::CreateCloneChunks(std::vector<ChunkBatchItem>* items,
+                                      uint64_t correntSn,
+                                      uint64_t chunkSize,
+                                      SnapCloneClosure* scc) {
+    return iomanager4chunk_.CreateCloneChunks(items, correntSn,
+                                              chunkSize, scc);
+}
+
+int SnapshotClient::RecoverChunks(std::vector<ChunkBatchItem>* items,
+                                  SnapCloneClosure* scc) {
+    return iomanager4chunk_.RecoverChunks(items, scc);
+}
+
 int SnapshotClient::ReadChunkSnapshot(ChunkIDInfo cidinfo,
                                         uint64_t seq,
                                         uint64_t offset,
@@ -201,6 +201,37 @@ class SnapshotClient {
                    uint64_t offset, uint64_t len,
                    SnapCloneClosure* scc);
 
+  /**
+   * @brief 批量创建同一个copyset上的clone chunk
+   * @detail
+   *  - items中的chunk必须属于同一个copyset, 每个chunk填写idinfo/location/sn
+   *  - 回调的返回值表示整个请求的结果, 成功时每个chunk的结果在其retCode中
+   *
+   * @param:items 需要创建的chunk, 由调用方持有直到scc被调用
+   * @param:correntSn CreateCloneChunk时候用于修改chunk的correctedSn
+   * @param:chunkSize chunk的大小
+   * @param: scc是异步回调
+   *
+   * @return 错误码
+   */
+  int CreateCloneChunks(std::vector<ChunkBatchItem>* items,
+                        uint64_t correntSn, uint64_t chunkSize,
+                        SnapCloneClosure* scc);
+
+  /**
+   * @brief 批量恢复同一个copyset上的chunk数据
+   * @detail
+   *  - items中的chunk必须属于同一个copyset, 每个chunk填写idinfo/offset/len
+   *  - 回调的返回值表示整个请求的结果, 成功时每个chunk的结果在其retCode中
+   *
+   * @param:items 需要恢复的chunk, 由调用方持有直到scc被调用
+   * @param: scc是异步回调
+   *
+   * @return 错误码
+   */
+  int RecoverChunks(std::vector<ChunkBatchItem>* items,
+                    SnapCloneClosure* scc);
+
   /**
    * @brief 通知mds完成Clone Meta
    *
@@ -132,6 +132,50 @@ LIBCURVE_ERROR MDSClient::MDSRPCExcutor::DoRPCTask(RPCFunc rpctask,
     }
 }
 
+void MDSClient::MDSRPCExcutor::SetOption(const MetaServerOption& option) {
+    metaServerOpt_ = option;
+
+    followerChannels_.clear();
+    for (const auto& addr : metaServerOpt_.mdsFollowerReadAddrs) {
+        std::unique_ptr<brpc::Channel> channel(new brpc::Channel());
+        if (channel->Init(addr.c_str(), nullptr) != 0) {
+            LOG(WARNING) << "Init follower read channel failed! addr = "
+                         << addr;
+            channel.reset();
+        }
+        followerChannels_.emplace_back(std::move(channel));
+    }
+}
+
+LIBCURVE_ERROR MDSClient::MDSRPCExcutor::DoReadRPCTask(
+    RPCFunc rpctask, uint64_t maxRetryTimeMS) {
+    const auto& followerAddrs = metaServerOpt_.mdsFollowerReadAddrs;
+    if (followerAddrs.empty()) {
+        return DoRPCTask(rpctask, maxRetryTimeMS);
+    }
+
+    int index = followerReadIndex_.fetch_add(1, std::memory_order_relaxed) %
+                followerAddrs.size();
+    const std::string& addr = followerAddrs[index];
+    brpc::Channel* channel = followerChannels_[index].get();
+    int retcode = -1;
+    if (channel != nullptr) {
+        brpc::Controller cntl;
+        cntl.set_log_id(GetLogId());
+        cntl.set_timeout_ms(metaServerOpt_.mdsRPCTimeoutMs);
+        retcode = rpctask(index, metaServerOpt_.mdsRPCTimeoutMs,
+                          channel, &cntl);
+        if (retcode == LIBCURVE_ERROR::OK) {
+            return LIBCURVE_ERROR::OK;
+        }
+    }
+
+    // 只读服务的缓存可能过期或不可用，由leader给出最终结果
+    LOG_EVERY_N(INFO, 100) << "read from " << addr << " failed, retcode = "
+                           << retcode << ", retry on leader";
+    return DoRPCTask(rpctask, maxRetryTimeMS);
+}
+
 bool MDSClient::MDSRPCExcutor::GoOnRetry(uint64_t startTimeMS,
                                          uint64_t maxRetryTimeMS) {
     uint64_t currentTime = TimeUtility::GetTimeofDayMs();
@@ -411,7 +455,7 @@ LIBCURVE_ERROR MDSClient::GetFileInfo(const std::string& filename,
             << ", log id = " << cntl->log_id();
         return retcode;
     };
-    return rpcExcutor.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS);
+    return rpcExcutor.DoReadRPCTask(task, metaServerOpt_.mdsMaxRetryMS);
 }
 
 LIBCURVE_ERROR MDSClient::CreateSnapShot(const std::string& filename,
@@ -761,6 +805,13 @@ LIBCURVE_ERROR MDSClient::GetServerList(
                 copysetseverl.AddCopysetPeerInfo(csinfo);
                 copyset_peer.append(internalIp).append(":")
                             .append(std::to_string(port)).append(", ");
+
+                // leader reported by chunkserver heartbeat, it may be stale,
+                // but saves a GetLeader rpc in most cases
+                if (info.has_leaderid() &&
+                    info.leaderid() == csl.chunkserverid()) {
+                    copysetseverl.UpdateLeaderIndex(j);
+                }
             }
             cpinfoVec->push_back(copysetseverl);
             DVLOG(9) << "copyset id : " << copysetseverl.cpid_
@@ -945,9 +996,83 @@ LIBCURVE_ERROR MDSClient::GetOrAllocateSegment(bool allocate,
         }
         return LIBCURVE_ERROR::OK;
     };
+    if (!allocate) {
+        return rpcExcutor.DoReadRPCTask(task,
+                                        metaServerOpt_.mdsMaxRetryMsInIOPath);
+    }
     return rpcExcutor.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMsInIOPath);
 }
 
+LIBCURVE_ERROR MDSClient::ListSegment(const FInfo_t* fi,
+                                      uint64_t offset,
+                                      uint64_t length,
+                                      std::vector<SegmentInfo>* segInfos) {
+    const uint64_t endOffset = length == 0 ? fi->length : offset + length;
+    uint64_t pageOffset = offset;
+    uint64_t nextOffset = 0;
+    segInfos->clear();
+
+    auto task = RPCTaskDefine {
+        ListSegmentResponse response;
+        mdsClientMetric_.listSegment.qps.count << 1;
+        LatencyGuard lg(&mdsClientMetric_.listSegment.latency);
+        MDSClientBase::ListSegment(fi, pageOffset,
+                                   length == 0 ? 0 : endOffset - pageOffset,
+                                   &response, cntl, channel);
+        if (cntl->Failed()) {
+            mdsClientMetric_.listSegment.eps.count << 1;
+            LOG(WARNING) << "ListSegment failed, error = "
+                         << cntl->ErrorText()
+                         << ", filename = " << fi->fullPathName
+                         << ", log id = " << cntl->log_id();
+            return -cntl->ErrorCode();
+        }
+
+        auto statusCode = response.statuscode();
+        if (statusCode != StatusCode::kOK) {
+            LOG(WARNING) << "ListSegment mds return failed, error = "
+                         << mds::StatusCode_Name(statusCode)
+                         << ", filename = " << fi->fullPathName;
+            LIBCURVE_ERROR errCode;
+            MDSStatusCode2LibcurveError(statusCode, &errCode);
+            return errCode;
+        }
+
+        for (const auto& pfs : response.pagefilesegments()) {
+            SegmentInfo segInfo;
+            segInfo.chunksize = pfs.chunksize();
+            segInfo.segmentsize = pfs.segmentsize();
+            segInfo.startoffset = pfs.startoffset();
+            segInfo.lpcpIDInfo.lpid = pfs.logicalpoolid();
+            for (const auto& chunk : pfs.chunks()) {
+                segInfo.lpcpIDInfo.cpidVec.push_back(chunk.copysetid());
+                segInfo.chunkvec.emplace_back(chunk.chunkid(),
+                                              pfs.logicalpoolid(),
+                                              chunk.copysetid());
+            }
+            segInfos->push_back(std::move(segInfo));
+        }
+        // 老版本mds不分页，一次返回整个范围
+        nextOffset = response.has_nextoffset() ? response.nextoffset()
+                                               : endOffset;
+
+        return LIBCURVE_ERROR::OK;
+    };
+
+    // mds每次最多返回limit个segment，分多次获取整个范围
+    while (true) {
+        LIBCURVE_ERROR ret =
+            rpcExcutor.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS);
+        if (ret != LIBCURVE_ERROR::OK) {
+            return ret;
+        }
+        if (nextOffset <= pageOffset || nextOffset >= endOffset) {
+            return LIBCURVE_ERROR::OK;
+        }
+        pageOffset = nextOffset;
+    }
+}
+
 LIBCURVE_ERROR MDSClient::DeAllocateSegment(const FInfo* fileInfo,
                                             uint64_t offset) {
     auto task = RPCTaskDefine {
@@ -1215,7 +1340,7 @@ LIBCURVE_ERROR MDSClient::Listdir(const std::string& dirpath,
         }
         return retcode;
     };
-    return rpcExcutor.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS);
+    return rpcExcutor.DoReadRPCTask(task, metaServerOpt_.mdsMaxRetryMS);
 }
 
 LIBCURVE_ERROR MDSClient::GetChunkServerInfo(const ChunkServerAddr& csAddr,
@@ -27,6 +27,7 @@
 #include <brpc/controller.h>
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -133,6 +134,20 @@ class MDSClient : public MDSClientBase,
     virtual LIBCURVE_ERROR DeAllocateSegment(const FInfo* fileInfo,
                                              uint64_t offset);
 
+    /**
+     * 批量获取文件[offset, offset + length)范围内已分配的segment信息，
+     * mds每次返回的segment数量有上限，范围较大时分多次rpc获取
+     * @param: fi是当前文件的基本信息
+     * @param: offset为起始偏移，需要与segment对齐
+     * @param: length为获取的长度，为0时获取到文件末尾
+     * @param[out]: segInfos保存获取到的segment信息，未分配的segment不返回
+     * @return: 成功返回LIBCURVE_ERROR::OK，否则返回对应错误码
+     */
+    LIBCURVE_ERROR ListSegment(const FInfo_t* fi,
+                               uint64_t offset,
+                               uint64_t length,
+                               std::vector<SegmentInfo>* segInfos);
+
     /**
      * 获取文件信息，fi是出参
      * @param: filename是文件名
@@ -404,11 +419,14 @@ class MDSClient : public MDSClientBase,
     class MDSRPCExcutor {
      public:
         MDSRPCExcutor()
-            : metaServerOpt_(), currentWorkingMDSAddrIndex_(0), cntlID_(1) {}
+            : metaServerOpt_(), currentWorkingMDSAddrIndex_(0), cntlID_(1),
+              followerReadIndex_(0) {}
 
-        void SetOption(const MetaServerOption& option) {
-            metaServerOpt_ = option;
-        }
+        /**
+         * 设置配置，并为每个提供只读服务的mds地址创建一个channel，
+         * 只读请求复用这些channel，不在每次rpc时创建
+         */
+        void SetOption(const MetaServerOption& option);
 
         /**
          * 将client与mds的重试相关逻辑抽离
@@ -418,6 +436,15 @@ class MDSClient : public MDSClientBase,
          */
         LIBCURVE_ERROR DoRPCTask(RPCFunc task, uint64_t maxRetryTimeMS);
 
+        /**
+         * 只读请求优先发往提供只读服务的mds，轮流选择地址，只尝试一次，
+         * 失败或返回错误时再通过DoRPCTask发往leader，避免读到过期的错误结果
+         * @param: task为当前要进行的具体rpc任务，不能有副作用
+         * @param: maxRetryTimeMS是发往leader时最大的重试时间
+         * @return: 返回当前RPC的结果
+         */
+        LIBCURVE_ERROR DoReadRPCTask(RPCFunc task, uint64_t maxRetryTimeMS);
+
         /**
          * 测试使用: 设置当前正在服务的mdsindex
          */
@@ -513,6 +540,12 @@ class MDSClient : public MDSClientBase,
         // controller id，用于trace整个rpc IO链路
         // 这里直接用uint64即可，在可预测的范围内，不会溢出
         std::atomic<uint64_t> cntlID_;
+
+        // 用于轮流选择只读服务的mds地址
+        std::atomic<uint64_t> followerReadIndex_;
+
+        // 与mdsFollowerReadAddrs一一对应，初始化失败的为nullptr
+        std::vector<std::unique_ptr<brpc::Channel>> followerChannels_;
     };
 
     /**
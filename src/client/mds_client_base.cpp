@@ -391,6 +391,27 @@ void MDSClientBase::DeAllocateSegment(const FInfo* fileInfo,
     stub.DeAllocateSegment(cntl, &request, response, nullptr);
 }
 
+void MDSClientBase::ListSegment(const FInfo_t* fi,
+                                uint64_t offset,
+                                uint64_t length,
+                                ListSegmentResponse* response,
+                                brpc::Controller* cntl,
+                                brpc::Channel* channel) {
+    ListSegmentRequest request;
+    request.set_filename(fi->fullPathName);
+    request.set_offset(offset);
+    request.set_length(length);
+    FillUserInfo(&request, fi->userinfo);
+
+    LOG(INFO) << "ListSegment: filename = " << fi->fullPathName
+              << ", owner = " << fi->owner
+              << ", offset = " << offset << ", length = " << length
+              << ", log id = " << cntl->log_id();
+
+    curve::mds::CurveFSService_Stub stub(channel);
+    stub.ListSegment(cntl, &request, response, nullptr);
+}
+
 void MDSClientBase::RenameFile(const UserInfo_t& userinfo,
                                const std::string& origin,
                                const std::string& destination,
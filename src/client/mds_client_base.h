@@ -72,6 +72,8 @@ using curve::mds::GetOrAllocateSegmentRequest;
 using curve::mds::GetOrAllocateSegmentResponse;
 using curve::mds::DeAllocateSegmentRequest;
 using curve::mds::DeAllocateSegmentResponse;
+using curve::mds::ListSegmentRequest;
+using curve::mds::ListSegmentResponse;
 using curve::mds::CheckSnapShotStatusRequest;
 using curve::mds::CheckSnapShotStatusResponse;
 using curve::mds::ListSnapShotFileInfoRequest;
@@ -331,6 +333,22 @@ class MDSClientBase {
                            DeAllocateSegmentResponse* response,
                            brpc::Controller* cntl, brpc::Channel* channel);
 
+    /**
+     * 批量获取文件已分配的segment信息，用于打开文件时预热metacache
+     * @param: fi是当前文件的基本信息
+     * @param: offset为起始偏移，需要与segment对齐
+     * @param: length为获取的长度，为0时获取到文件末尾
+     * @param[out]: response为该rpc的response，提供给外部处理
+     * @param[in|out]: cntl既是入参，也是出参，返回RPC状态
+     * @param[in]:channel是当前与mds建立的通道
+     */
+    void ListSegment(const FInfo_t* fi,
+                     uint64_t offset,
+                     uint64_t length,
+                     ListSegmentResponse* response,
+                     brpc::Controller* cntl,
+                     brpc::Channel* channel);
+
     /**
      * @brief 重名文件
      * @param:userinfo 用户信息
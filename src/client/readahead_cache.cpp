@@ -0,0 +1,226 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include "src/client/readahead_cache.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+
+namespace curve {
+namespace client {
+
+ReadaheadCache::ReadaheadCache(const ReadaheadOption& opt,
+                               ReadaheadMetric* metric)
+    : option_(opt),
+      blockSize_(std::max<uint64_t>(opt.cacheBlockSizeKB, 4) * 1024),
+      capacity_(static_cast<uint64_t>(opt.cacheCapacityMB) * 1024 * 1024),
+      minWindow_(static_cast<uint64_t>(opt.minWindowKB) * 1024),
+      maxWindow_(std::max<uint64_t>(opt.maxWindowKB, opt.minWindowKB) * 1024),
+      cachedBytes_(0),
+      generation_(0),
+      lastReadEnd_(0),
+      sequentialCount_(0),
+      window_(minWindow_),
+      readaheadEnd_(0),
+      metric_(metric) {}
+
+bool ReadaheadCache::Read(uint64_t offset, uint64_t length,
+                          butil::IOBuf* data) {
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+
+    const uint64_t end = offset + length;
+    for (uint64_t block = AlignDown(offset); block < end; block += blockSize_) {
+        if (blocks_.find(block) == blocks_.end()) {
+            if (metric_ != nullptr) {
+                metric_->miss << 1;
+            }
+            return false;
+        }
+    }
+
+    data->clear();
+    for (uint64_t block = AlignDown(offset); block < end; block += blockSize_) {
+        auto iter = blocks_.find(block);
+        uint64_t pos = std::max(offset, block) - block;
+        uint64_t len = std::min(end, block + blockSize_) - block - pos;
+        iter->second->second.append_to(data, len, pos);
+
+        // move to the front of lru list
+        lru_.splice(lru_.begin(), lru_, iter->second);
+    }
+
+    if (metric_ != nullptr) {
+        metric_->hit << 1;
+    }
+
+    return true;
+}
+
+bool ReadaheadCache::OnUserRead(uint64_t offset, uint64_t length,
+                                uint64_t fileLength, ReadaheadRange* range) {
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+
+    if (offset == lastReadEnd_) {
+        ++sequentialCount_;
+    } else {
+        // random read, reset the readahead window
+        sequentialCount_ = 1;
+        window_ = minWindow_;
+        readaheadEnd_ = 0;
+    }
+
+    lastReadEnd_ = offset + length;
+
+    if (sequentialCount_ < option_.sequentialTriggerCount) {
+        return false;
+    }
+
+    // still have enough prefetched data ahead of current read position,
+    // readahead is triggered again when half of the window is consumed
+    if (readaheadEnd_ >= lastReadEnd_ + window_ / 2) {
+        return false;
+    }
+
+    uint64_t start = std::max(readaheadEnd_, AlignDown(lastReadEnd_));
+    uint64_t end = std::min(AlignUp(lastReadEnd_ + window_),
+                            AlignDown(fileLength));
+    if (start >= end) {
+        return false;
+    }
+
+    range->offset = start;
+    range->length = end - start;
+    range->generation = generation_;
+
+    readaheadEnd_ = end;
+    window_ = std::min(window_ * 2, maxWindow_);
+
+    if (metric_ != nullptr) {
+        metric_->issued << 1;
+        metric_->issuedBytes << range->length;
+    }
+
+    return true;
+}
+
+void ReadaheadCache::Insert(const ReadaheadRange& range,
+                            const butil::IOBuf& data) {
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+
+    if (range.generation != generation_ || data.size() != range.length) {
+        DVLOG(9) << "drop readahead data, offset = " << range.offset
+                 << ", length = " << range.length
+                 << ", data size = " << data.size()
+                 << ", generation = " << range.generation
+                 << ", current generation = " << generation_;
+        if (metric_ != nullptr) {
+            metric_->dropped << 1;
+        }
+        return;
+    }
+
+    butil::IOBuf remain(data);
+    for (uint64_t block = range.offset; block < range.offset + range.length;
+         block += blockSize_) {
+        butil::IOBuf blockData;
+        remain.cutn(&blockData, blockSize_);
+        InsertBlockLocked(block, &blockData);
+    }
+
+    EvictLocked();
+}
+
+void ReadaheadCache::Invalidate(uint64_t offset, uint64_t length) {
+    std::lock_guard<bthread::Mutex> lk(mtx_);
+
+    // readahead issued before this write will be dropped when it comes back
+    ++generation_;
+    readaheadEnd_ = 0;
+
+    if (blocks_.empty()) {
+        return;
+    }
+
+    const uint64_t begin = AlignDown(offset);
+    const uint64_t end = offset + length;
+    if ((end - begin) / blockSize_ > blocks_.size()) {
+        for (auto iter = lru_.begin(); iter != lru_.end();) {
+            if (iter->first >= begin && iter->first < end) {
+                cachedBytes_ -= iter->second.size();
+                if (metric_ != nullptr) {
+                    metric_->cachedBytes << -static_cast<int64_t>(
+                        iter->second.size());
+                }
+                blocks_.erase(iter->first);
+                iter = lru_.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+        return;
+    }
+
+    for (uint64_t block = begin; block < end; block += blockSize_) {
+        EraseLocked(block);
+    }
+}
+
+void ReadaheadCache::InsertBlockLocked(uint64_t blockOffset,
+                                       butil::IOBuf* block) {
+    EraseLocked(blockOffset);
+
+    cachedBytes_ += block->size();
+    if (metric_ != nullptr) {
+        metric_->cachedBytes << static_cast<int64_t>(block->size());
+    }
+
+    lru_.emplace_front(blockOffset, butil::IOBuf());
+    lru_.front().second.swap(*block);
+    blocks_.emplace(blockOffset, lru_.begin());
+}
+
+void ReadaheadCache::EvictLocked() {
+    while (cachedBytes_ > capacity_ && !lru_.empty()) {
+        EraseLocked(lru_.back().first);
+    }
+}
+
+void ReadaheadCache::EraseLocked(uint64_t blockOffset) {
+    auto iter = blocks_.find(blockOffset);
+    if (iter == blocks_.end()) {
+        return;
+    }
+
+    cachedBytes_ -= iter->second->second.size();
+    if (metric_ != nullptr) {
+        metric_->cachedBytes << -static_cast<int64_t>(
+            iter->second->second.size());
+    }
+
+    lru_.erase(iter->second);
+    blocks_.erase(iter);
+}
+
+}  // namespace client
+}  // namespace curve
@@ -0,0 +1,150 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#ifndef SRC_CLIENT_READAHEAD_CACHE_H_
+#define SRC_CLIENT_READAHEAD_CACHE_H_
+
+#include <butil/iobuf.h>
+#include <bthread/mutex.h>
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#include "src/client/client_metric.h"
+#include "src/client/config_info.h"
+
+namespace curve {
+namespace client {
+
+/**
+ * Range that should be prefetched after a user read,
+ * offset and length are both aligned to cache block size
+ */
+struct ReadaheadRange {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    // cache generation when this readahead is issued,
+    // data will be dropped if any write happened in between
+    uint64_t generation = 0;
+};
+
+/**
+ * ReadaheadCache detects sequential read pattern of a file and keeps
+ * prefetched data in a bounded LRU cache of fixed size blocks.
+ *
+ * The readahead window starts at minWindowKB once a stream is considered
+ * sequential and doubles on every readahead until maxWindowKB, a random
+ * read resets the window.
+ *
+ * Any local write or discard invalidates the overlapped blocks and
+ * bumps the cache generation, so that readahead issued before the write
+ * will not insert stale data when it comes back.
+ */
+class ReadaheadCache {
+ public:
+    ReadaheadCache(const ReadaheadOption& opt, ReadaheadMetric* metric);
+
+    /**
+     * @brief read [offset, offset + length) from cache
+     * @param[out] data the cached data, only valid when return true
+     * @return true if the whole range is cached, otherwise false
+     */
+    bool Read(uint64_t offset, uint64_t length, butil::IOBuf* data);
+
+    /**
+     * @brief update sequential detector with a user read
+     * @param fileLength current file length, readahead never exceeds it
+     * @param[out] range range to prefetch
+     * @return true if a readahead should be issued
+     */
+    bool OnUserRead(uint64_t offset, uint64_t length, uint64_t fileLength,
+                    ReadaheadRange* range);
+
+    /**
+     * @brief insert data of a finished readahead
+     * @param range the readahead range returned by OnUserRead
+     * @param data data read from chunkserver
+     */
+    void Insert(const ReadaheadRange& range, const butil::IOBuf& data);
+
+    /**
+     * @brief invalidate cached blocks overlapped with [offset, offset+length)
+     */
+    void Invalidate(uint64_t offset, uint64_t length);
+
+    uint64_t CachedBytes() const {
+        return cachedBytes_;
+    }
+
+    uint64_t WindowBytes() const {
+        return window_;
+    }
+
+ private:
+    using LRUList = std::list<std::pair<uint64_t, butil::IOBuf>>;
+
+    uint64_t AlignDown(uint64_t value) const {
+        return value / blockSize_ * blockSize_;
+    }
+
+    uint64_t AlignUp(uint64_t value) const {
+        return (value + blockSize_ - 1) / blockSize_ * blockSize_;
+    }
+
+    void InsertBlockLocked(uint64_t blockOffset, butil::IOBuf* block);
+
+    void EvictLocked();
+
+    void EraseLocked(uint64_t blockOffset);
+
+ private:
+    const ReadaheadOption option_;
+    const uint64_t blockSize_;
+    const uint64_t capacity_;
+    const uint64_t minWindow_;
+    const uint64_t maxWindow_;
+
+    bthread::Mutex mtx_;
+
+    // lru list, front is the most recently used block
+    LRUList lru_;
+    std::unordered_map<uint64_t, LRUList::iterator> blocks_;
+    uint64_t cachedBytes_;
+
+    // bumped on each invalidation
+    uint64_t generation_;
+
+    // sequential detector
+    uint64_t lastReadEnd_;
+    uint32_t sequentialCount_;
+    uint64_t window_;
+    // end offset of data already prefetched or being prefetched
+    uint64_t readaheadEnd_;
+
+    ReadaheadMetric* metric_;
+};
+
+}  // namespace client
+}  // namespace curve
+
+#endif  // SRC_CLIENT_READAHEAD_CACHE_H_
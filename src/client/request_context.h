@@ -27,6 +27,7 @@
 
 #include <atomic>
 #include <string>
+#include <vector>
 
 #include "src/client/client_common.h"
 #include "src/client/request_closure.h"
@@ -58,6 +59,30 @@ inline std::ostream& operator<<(std::ostream& os,
     return os;
 }
 
+/**
+ * Timestamps and durations of a sampled request at each stage boundary,
+ * all in microseconds. Only filled when the owner IOTracker is sampled.
+ * Fields are written sequentially by scheduler thread and rpc callbacks,
+ * and read by IOTracker after the request is done.
+ */
+struct RequestStageTrace {
+    bool sampled = false;
+    // pushed into scheduler queue
+    uint64_t scheduleUs = 0;
+    // taken out of scheduler queue
+    uint64_t dequeueUs = 0;
+    // got inflight rpc token
+    uint64_t tokenUs = 0;
+    // send time of current rpc
+    uint64_t rpcStartUs = 0;
+    // accumulated time of fetching leader from metacache
+    uint64_t leaderLookupUs = 0;
+    // accumulated rpc time of all tries
+    uint64_t rpcUs = 0;
+    // accumulated sleep time before retry
+    uint64_t retryBackoffUs = 0;
+};
+
 struct CURVE_CACHELINE_ALIGNMENT RequestContext {
     RequestContext() : id_(GetNextRequestContextId()) {}
 
@@ -110,9 +135,16 @@ struct CURVE_CACHELINE_ALIGNMENT RequestContext {
     // create clone chunk时候用于修改chunk的correctedSn
     uint64_t            correctedSeq_ = 0;
 
+    // 批量create clone chunk/recover chunk的chunk列表, 由调用方持有,
+    // 请求完成后每个chunk的返回值填在其中
+    std::vector<ChunkBatchItem>* batchItems_ = nullptr;
+
     // 当前request context id
     uint64_t            id_ = 0;
 
+    // per-stage latency trace of sampled io
+    RequestStageTrace   trace_;
+
     static RequestContext* NewInitedRequestContext() {
         RequestContext* ctx = new (std::nothrow) RequestContext();
         if (ctx && ctx->Init()) {
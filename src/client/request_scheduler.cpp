@@ -28,6 +28,7 @@
 #include "src/client/request_context.h"
 #include "src/client/request_closure.h"
 #include "src/client/chunk_closure.h"
+#include "src/common/timeutility.h"
 
 namespace curve {
 namespace client {
@@ -159,18 +160,35 @@ void RequestScheduler::Process() {
     }
 }
 
+void RequestScheduler::TraceDequeue(RequestContext* ctx) {
+    // rescheduled request only records its first dequeue
+    if (ctx->trace_.sampled && ctx->trace_.dequeueUs == 0) {
+        ctx->trace_.dequeueUs = curve::common::TimeUtility::GetTimeofDayUs();
+    }
+}
+
+void RequestScheduler::TraceGetToken(RequestContext* ctx) {
+    if (ctx->trace_.sampled && ctx->trace_.tokenUs == 0) {
+        ctx->trace_.tokenUs = curve::common::TimeUtility::GetTimeofDayUs();
+    }
+}
+
 void RequestScheduler::ProcessOne(RequestContext* ctx) {
     brpc::ClosureGuard guard(ctx->done_);
 
     switch (ctx->optype_) {
         case OpType::READ:
+            TraceDequeue(ctx);
             ctx->done_->GetInflightRPCToken();
+            TraceGetToken(ctx);
             client_.ReadChunk(ctx->idinfo_, ctx->seq_, ctx->offset_,
                               ctx->rawlength_, ctx->appliedindex_,
                               ctx->sourceInfo_, guard.release());
             break;
         case OpType::WRITE:
+            TraceDequeue(ctx);
             ctx->done_->GetInflightRPCToken();
+            TraceGetToken(ctx);
             client_.WriteChunk(ctx->idinfo_, ctx->seq_, ctx->writeData_,
                                ctx->offset_, ctx->rawlength_, ctx->sourceInfo_,
                                guard.release());
@@ -195,6 +213,15 @@ void RequestScheduler::ProcessOne(RequestContext* ctx) {
             client_.RecoverChunk(ctx->idinfo_, ctx->offset_, ctx->rawlength_,
                                  guard.release());
             break;
+        case OpType::CREATE_CLONE_BATCH:
+            client_.CreateCloneChunks(ctx->idinfo_, ctx->batchItems_,
+                                      ctx->correctedSeq_, ctx->chunksize_,
+                                      guard.release());
+            break;
+        case OpType::RECOVER_CHUNK_BATCH:
+            client_.RecoverChunks(ctx->idinfo_, ctx->batchItems_,
+                                  guard.release());
+            break;
         default:
             /* TODO(wudemiao) 后期整个链路错误发统一了在处理 */
             ctx->done_->SetFailed(-1);
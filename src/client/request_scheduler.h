@@ -140,6 +140,12 @@ class RequestScheduler : public Uncopyable {
 
     void ProcessOne(RequestContext* ctx);
 
+    /**
+     * record dequeue and inflight token time of sampled request
+     */
+    static void TraceDequeue(RequestContext* ctx);
+    static void TraceGetToken(RequestContext* ctx);
+
     void WaitValidSession() {
         // lease续约失败的时候需要阻塞IO直到续约成功
         if (blockIO_.load(std::memory_order_acquire) && blockingQueue_) {
@@ -87,6 +87,19 @@ int RequestSender::ReadChunk(const ChunkIDInfo& idinfo,
     UpdateRpcRPS(done, OpType::READ);
     SetRpcStuff(done, cntl, response);
 
+    return ReadChunk(idinfo, offset, length, appliedindex, sourceInfo, false,
+                     cntl, response, doneGuard.release());
+}
+
+int RequestSender::ReadChunk(const ChunkIDInfo& idinfo,
+                             off_t offset,
+                             size_t length,
+                             uint64_t appliedindex,
+                             const RequestSourceInfo& sourceInfo,
+                             bool followerRead,
+                             brpc::Controller* cntl,
+                             ChunkResponse* response,
+                             Closure* done) {
     ChunkRequest request;
     request.set_optype(curve::chunkserver::CHUNK_OP_TYPE::CHUNK_OP_READ);
     request.set_logicpoolid(idinfo.lpid_);
@@ -102,10 +115,13 @@ int RequestSender::ReadChunk(const ChunkIDInfo& idinfo,
 
     if (iosenderopt_.chunkserverEnableAppliedIndexRead && appliedindex > 0) {
         request.set_appliedindex(appliedindex);
+        if (followerRead) {
+            request.set_followerread(true);
+        }
     }
 
     ChunkService_Stub stub(&channel_);
-    stub.ReadChunk(cntl, &request, response, doneGuard.release());
+    stub.ReadChunk(cntl, &request, response, done);
 
     return 0;
 }
@@ -267,6 +283,70 @@ int RequestSender::RecoverChunk(const ChunkIDInfo& idinfo,
     stub.RecoverChunk(cntl, &request, response, doneGuard.release());
 }
 
+int RequestSender::CreateCloneChunks(const ChunkIDInfo& idinfo,
+                                     ClientClosure *done,
+                                     const std::vector<ChunkBatchItem> &items,
+                                     uint64_t correntSn,
+                                     uint64_t chunkSize) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller *cntl = new brpc::Controller();
+    ChunkResponse *response = new ChunkResponse();
+
+    UpdateRpcRPS(done, OpType::CREATE_CLONE_BATCH);
+    SetRpcStuff(done, cntl, response);
+
+    ChunkRequest request;
+    request.set_optype(
+        curve::chunkserver::CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH);
+    request.set_logicpoolid(idinfo.lpid_);
+    request.set_copysetid(idinfo.cpid_);
+    request.set_chunkid(idinfo.cid_);
+    request.set_correctedsn(correntSn);
+    request.set_size(chunkSize);
+    for (const auto &item : items) {
+        curve::chunkserver::BatchChunkItem *batchItem =
+            request.add_batchitems();
+        batchItem->set_chunkid(item.idinfo.cid_);
+        batchItem->set_location(item.location);
+        batchItem->set_sn(item.sn);
+    }
+
+    ChunkService_Stub stub(&channel_);
+    stub.CreateCloneChunks(cntl, &request, response, doneGuard.release());
+
+    return 0;
+}
+
+int RequestSender::RecoverChunks(const ChunkIDInfo& idinfo,
+                                 ClientClosure *done,
+                                 const std::vector<ChunkBatchItem> &items) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller *cntl = new brpc::Controller();
+    ChunkResponse *response = new ChunkResponse();
+
+    UpdateRpcRPS(done, OpType::RECOVER_CHUNK_BATCH);
+    SetRpcStuff(done, cntl, response);
+
+    ChunkRequest request;
+    request.set_optype(
+        curve::chunkserver::CHUNK_OP_TYPE::CHUNK_OP_RECOVER_BATCH);
+    request.set_logicpoolid(idinfo.lpid_);
+    request.set_copysetid(idinfo.cpid_);
+    request.set_chunkid(idinfo.cid_);
+    for (const auto &item : items) {
+        curve::chunkserver::BatchChunkItem *batchItem =
+            request.add_batchitems();
+        batchItem->set_chunkid(item.idinfo.cid_);
+        batchItem->set_offset(item.offset);
+        batchItem->set_size(item.len);
+    }
+
+    ChunkService_Stub stub(&channel_);
+    stub.RecoverChunks(cntl, &request, response, doneGuard.release());
+
+    return 0;
+}
+
 int RequestSender::ResetSender(ChunkServerID chunkServerId,
                                butil::EndPoint serverEndPoint) {
     chunkServerId_ = chunkServerId;
@@ -28,6 +28,7 @@
 #include <butil/iobuf.h>
 
 #include <string>
+#include <vector>
 
 #include "src/client/client_config.h"
 #include "src/client/client_common.h"
@@ -71,6 +72,28 @@ class RequestSender {
                   const RequestSourceInfo& sourceInfo,
                   ClientClosure *done);
 
+    /**
+     * 读Chunk，cntl和response由调用方管理，用于hedged read
+     * @param idinfo为chunk相关的id信息
+     * @param offset:读的偏移
+     * @param length:读的长度
+     * @param appliedindex:需要读到>=appliedIndex的数据
+     * @param sourceInfo 数据源信息
+     * @param followerRead:是否允许follower直接读
+     * @param cntl:rpc controller，超时时间由调用方设置
+     * @param response:rpc response
+     * @param done:rpc返回后的回调
+     */
+    int ReadChunk(const ChunkIDInfo& idinfo,
+                  off_t offset,
+                  size_t length,
+                  uint64_t appliedindex,
+                  const RequestSourceInfo& sourceInfo,
+                  bool followerRead,
+                  brpc::Controller* cntl,
+                  ChunkResponse* response,
+                  google::protobuf::Closure* done);
+
     /**
    * 写Chunk
    * @param idinfo为chunk相关的id信息
@@ -159,6 +182,34 @@ class RequestSender {
     */
     int RecoverChunk(const ChunkIDInfo& idinfo,
                      ClientClosure* done, uint64_t offset, uint64_t len);
+
+   /**
+    * @brief 批量创建同一个copyset上的clone chunk
+    * @param idinfo为copyset相关的id信息
+    * @param done:上一层异步回调的closure
+    * @param items:需要创建的chunk, 每个chunk的location和sn
+    * @param:correntSn CreateCloneChunk时候用于修改chunk的correctedSn
+    * @param:chunkSize chunk的大小
+    *
+    * @return 错误码
+    */
+    int CreateCloneChunks(const ChunkIDInfo& idinfo,
+                          ClientClosure *done,
+                          const std::vector<ChunkBatchItem> &items,
+                          uint64_t correntSn,
+                          uint64_t chunkSize);
+
+   /**
+    * @brief 批量恢复同一个copyset上的chunk数据
+    * @param idinfo为copyset相关的id信息
+    * @param done:上一层异步回调的closure
+    * @param items:需要恢复的chunk, 每个chunk的offset和len
+    *
+    * @return 错误码
+    */
+    int RecoverChunks(const ChunkIDInfo& idinfo,
+                      ClientClosure *done,
+                      const std::vector<ChunkBatchItem> &items);
     /**
      * 重置和Chunk Server的链接
      * @param chunkServerId:Chunk Server唯一标识
@@ -172,6 +223,14 @@ class RequestSender {
        return channel_.CheckHealth() == 0;
     }
 
+    ChunkServerID GetChunkServerID() const {
+        return chunkServerId_;
+    }
+
+    butil::EndPoint GetChunkServerEndPoint() const {
+        return serverEndPoint_;
+    }
+
  private:
     void UpdateRpcRPS(ClientClosure* done, OpType type) const;
 
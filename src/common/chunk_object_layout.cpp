@@ -0,0 +1,356 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include "src/common/chunk_object_layout.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "src/common/crc32.h"
+
+namespace curve {
+namespace common {
+
+namespace {
+
+const char kLayoutMagic[] = "CVCHKLYT";
+const size_t kMagicSize = sizeof(kLayoutMagic) - 1;
+// body中分片信息之前的固定部分：partSize + partNum
+const size_t kBodyHeadSize = 8;
+// 用bitmap记录分片是否存在
+const uint32_t kVersionBitmap = 1;
+// 记录每个分片的长度和压缩算法
+const uint32_t kVersionPartTable = 2;
+// 记录每个分片的长度、压缩算法和内容hash
+const uint32_t kVersionPartRef = 3;
+// v2中每个分片信息的长度
+const size_t kPartEntrySize = 5;
+// 去重存储的分片对象名的前缀
+const char kPartObjectPrefix[] = "chunkpart-";
+
+void PutFixed32(std::string *out, uint32_t value) {
+    char buf[4];
+    buf[0] = static_cast<char>(value & 0xff);
+    buf[1] = static_cast<char>((value >> 8) & 0xff);
+    buf[2] = static_cast<char>((value >> 16) & 0xff);
+    buf[3] = static_cast<char>((value >> 24) & 0xff);
+    out->append(buf, sizeof(buf));
+}
+
+uint32_t GetFixed32(const char *buf) {
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(buf);
+    return static_cast<uint32_t>(p[0]) |
+           (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+}  // namespace
+
+const size_t ChunkObjectLayout::kTrailerSize = 12 + kMagicSize;
+const size_t ChunkObjectLayout::kPartHashSize;
+
+bool IsZeroBuffer(const char *buf, size_t len) {
+    // 按块做或运算，块内没有分支便于编译器向量化，每块检查一次以尽早退出
+    const size_t kBlockSize = 256;
+    size_t pos = 0;
+    while (pos + kBlockSize <= len) {
+        uint64_t acc = 0;
+        for (size_t i = 0; i < kBlockSize; i += sizeof(uint64_t)) {
+            uint64_t value;
+            memcpy(&value, buf + pos + i, sizeof(value));
+            acc |= value;
+        }
+        if (acc != 0) {
+            return false;
+        }
+        pos += kBlockSize;
+    }
+    for (; pos < len; ++pos) {
+        if (buf[pos] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ChunkObjectLayout::ChunkObjectLayout(uint32_t partSize, uint32_t partNum)
+    : partSize_(partSize),
+      partNum_(partNum),
+      parts_(partNum, PartEntry{0, CompressType::None, 0, ""}) {}
+
+void ChunkObjectLayout::SetPartPresent(uint32_t index) {
+    SetPart(index, partSize_, CompressType::None);
+}
+
+void ChunkObjectLayout::SetPart(uint32_t index, uint32_t storedLength,
+                                CompressType type) {
+    if (index >= partNum_) {
+        return;
+    }
+    parts_[index].storedLength = storedLength;
+    parts_[index].compressType = type;
+    parts_[index].hash.clear();
+    UpdateObjectOffset();
+}
+
+void ChunkObjectLayout::SetPartRef(uint32_t index, uint32_t storedLength,
+                                   CompressType type,
+                                   const std::string &hash) {
+    if (index >= partNum_ || hash.size() != kPartHashSize) {
+        return;
+    }
+    parts_[index].storedLength = storedLength;
+    parts_[index].compressType = type;
+    parts_[index].hash = hash;
+    UpdateObjectOffset();
+}
+
+void ChunkObjectLayout::UpdateObjectOffset() {
+    uint64_t objectOffset = 0;
+    for (auto &part : parts_) {
+        if (!part.hash.empty()) {
+            part.objectOffset = 0;
+            continue;
+        }
+        part.objectOffset = objectOffset;
+        objectOffset += part.storedLength;
+    }
+}
+
+bool ChunkObjectLayout::IsPartPresent(uint32_t index) const {
+    return index < partNum_ && parts_[index].storedLength != 0;
+}
+
+uint32_t ChunkObjectLayout::GetStoredLength(uint32_t index) const {
+    return index < partNum_ ? parts_[index].storedLength : 0;
+}
+
+CompressType ChunkObjectLayout::GetCompressType(uint32_t index) const {
+    return index < partNum_ ? parts_[index].compressType : CompressType::None;
+}
+
+std::string ChunkObjectLayout::GetPartHash(uint32_t index) const {
+    return index < partNum_ ? parts_[index].hash : std::string();
+}
+
+bool ChunkObjectLayout::HasPartRef() const {
+    for (const auto &part : parts_) {
+        if (!part.hash.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string ChunkObjectLayout::PartObjectKey(const std::string &hash) {
+    static const char kHexChars[] = "0123456789abcdef";
+    std::string key(kPartObjectPrefix);
+    for (unsigned char c : hash) {
+        key.push_back(kHexChars[c >> 4]);
+        key.push_back(kHexChars[c & 0x0f]);
+    }
+    return key;
+}
+
+uint64_t ChunkObjectLayout::GetDataLength() const {
+    uint64_t length = 0;
+    for (const auto &part : parts_) {
+        if (part.hash.empty()) {
+            length += part.storedLength;
+        }
+    }
+    return length;
+}
+
+bool ChunkObjectLayout::AllPartsRaw() const {
+    for (const auto &part : parts_) {
+        if (part.storedLength != 0 &&
+            (part.compressType != CompressType::None ||
+             part.storedLength != partSize_)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ChunkObjectLayout::Encode(std::string *out) const {
+    std::string body;
+    PutFixed32(&body, partSize_);
+    PutFixed32(&body, partNum_);
+    uint32_t version;
+    if (HasPartRef()) {
+        version = kVersionPartRef;
+        const std::string zeroHash(kPartHashSize, '\0');
+        for (const auto &part : parts_) {
+            PutFixed32(&body, part.storedLength);
+            body.push_back(static_cast<char>(part.compressType));
+            body.append(part.hash.empty() ? zeroHash : part.hash);
+        }
+    } else if (AllPartsRaw()) {
+        version = kVersionBitmap;
+        std::string bitmap((partNum_ + 7) / 8, '\0');
+        for (uint32_t i = 0; i < partNum_; ++i) {
+            if (parts_[i].storedLength != 0) {
+                bitmap[i / 8] |= static_cast<char>(1 << (i % 8));
+            }
+        }
+        body.append(bitmap);
+    } else {
+        version = kVersionPartTable;
+        for (const auto &part : parts_) {
+            PutFixed32(&body, part.storedLength);
+            body.push_back(static_cast<char>(part.compressType));
+        }
+    }
+
+    out->append(body);
+    PutFixed32(out, body.size());
+    PutFixed32(out, CRC32(body.data(), body.size()));
+    PutFixed32(out, version);
+    out->append(kLayoutMagic, kMagicSize);
+}
+
+LayoutDecodeStatus ChunkObjectLayout::Decode(const char *tail, size_t len,
+                                             ChunkObjectLayout *layout,
+                                             size_t *needLen) {
+    if (len < kTrailerSize ||
+        memcmp(tail + len - kMagicSize, kLayoutMagic, kMagicSize) != 0) {
+        return LayoutDecodeStatus::NotLayout;
+    }
+
+    const char *trailer = tail + len - kTrailerSize;
+    uint32_t bodyLen = GetFixed32(trailer);
+    uint32_t crc = GetFixed32(trailer + 4);
+    uint32_t version = GetFixed32(trailer + 8);
+    if (version != kVersionBitmap && version != kVersionPartTable &&
+        version != kVersionPartRef) {
+        return LayoutDecodeStatus::Corrupted;
+    }
+    if (bodyLen + kTrailerSize > len) {
+        *needLen = bodyLen + kTrailerSize;
+        return LayoutDecodeStatus::NeedMore;
+    }
+
+    const char *body = trailer - bodyLen;
+    if (bodyLen < kBodyHeadSize || CRC32(body, bodyLen) != crc) {
+        return LayoutDecodeStatus::Corrupted;
+    }
+    uint32_t partSize = GetFixed32(body);
+    uint32_t partNum = GetFixed32(body + 4);
+    size_t entrySize = kPartEntrySize +
+        (version == kVersionPartRef ? kPartHashSize : 0);
+    size_t expectLen = kBodyHeadSize + (version == kVersionBitmap ?
+        (partNum + 7) / 8 : static_cast<size_t>(partNum) * entrySize);
+    if (partSize == 0 || bodyLen != expectLen) {
+        return LayoutDecodeStatus::Corrupted;
+    }
+
+    *layout = ChunkObjectLayout(partSize, partNum);
+    const char *entry = body + kBodyHeadSize;
+    for (uint32_t i = 0; i < partNum; ++i) {
+        PartEntry &part = layout->parts_[i];
+        if (version == kVersionBitmap) {
+            if (entry[i / 8] & (1 << (i % 8))) {
+                part.storedLength = partSize;
+            }
+            continue;
+        }
+        part.storedLength = GetFixed32(entry);
+        part.compressType = static_cast<CompressType>(entry[4]);
+        if (version == kVersionPartRef &&
+            !IsZeroBuffer(entry + kPartEntrySize, kPartHashSize)) {
+            part.hash.assign(entry + kPartEntrySize, kPartHashSize);
+        }
+        entry += entrySize;
+        if (part.compressType > CompressType::Zlib ||
+            (!part.hash.empty() && part.storedLength == 0) ||
+            (part.compressType == CompressType::None &&
+             part.storedLength != 0 && part.storedLength != partSize)) {
+            return LayoutDecodeStatus::Corrupted;
+        }
+    }
+    layout->UpdateObjectOffset();
+    return LayoutDecodeStatus::OK;
+}
+
+bool ChunkObjectLayout::MapRange(uint64_t offset, uint64_t length,
+                                 std::vector<ObjectExtent> *extents) const {
+    extents->clear();
+    if (partSize_ == 0 || offset + length > GetChunkSize()) {
+        return false;
+    }
+
+    uint64_t end = offset + length;
+    uint64_t pos = offset;
+    while (pos < end) {
+        uint32_t index = pos / partSize_;
+        const PartEntry &part = parts_[index];
+        uint64_t partStart = static_cast<uint64_t>(index) * partSize_;
+        uint64_t len = std::min(end, partStart + partSize_) - pos;
+        bool hole = part.storedLength == 0;
+        bool compressed = !hole && part.compressType != CompressType::None;
+        bool ref = !hole && !part.hash.empty();
+
+        ObjectExtent extent;
+        extent.chunkOffset = pos;
+        extent.length = len;
+        extent.hole = hole;
+        extent.compressType = hole ? CompressType::None : part.compressType;
+        extent.partOffset = pos - partStart;
+        if (hole) {
+            extent.objectOffset = 0;
+            extent.objectLength = 0;
+        } else if (compressed) {
+            // 压缩的分片只能整体读取后解压
+            extent.objectOffset = part.objectOffset;
+            extent.objectLength = part.storedLength;
+        } else {
+            extent.objectOffset = part.objectOffset + extent.partOffset;
+            extent.objectLength = len;
+        }
+        if (ref) {
+            extent.objectKey = PartObjectKey(part.hash);
+        }
+        pos += len;
+
+        // 相邻的未压缩分片在对象中也是相邻的，合并为一次读
+        if (!compressed && !ref && !extents->empty()) {
+            ObjectExtent &last = extents->back();
+            if (last.hole == hole &&
+                last.compressType == CompressType::None &&
+                last.objectKey.empty() &&
+                (hole || last.objectOffset + last.objectLength ==
+                         extent.objectOffset)) {
+                last.length += len;
+                last.objectLength += extent.objectLength;
+                continue;
+            }
+        }
+        extents->push_back(extent);
+    }
+    return true;
+}
+
+}  // namespace common
+}  // namespace curve
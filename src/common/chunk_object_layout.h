@@ -0,0 +1,213 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#ifndef SRC_COMMON_CHUNK_OBJECT_LAYOUT_H_
+#define SRC_COMMON_CHUNK_OBJECT_LAYOUT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "src/common/compression.h"
+
+namespace curve {
+namespace common {
+
+/**
+ * 判断buf中的数据是否全为0
+ */
+bool IsZeroBuffer(const char *buf, size_t len);
+
+// chunk中的一段数据在对象中的位置
+struct ObjectExtent {
+    // 在chunk中的偏移
+    uint64_t chunkOffset;
+    // 在对象中的偏移，hole为true时无意义
+    uint64_t objectOffset;
+    uint64_t length;
+    // 为true表示这段数据全为0，没有存储在对象中
+    bool hole;
+    // 需要从对象中读取的长度，压缩的分片需要读取整个分片
+    uint64_t objectLength;
+    // 分片的压缩算法，压缩的分片解压后再取出需要的区域
+    CompressType compressType;
+    // 压缩的分片中，需要的区域在解压后的分片中的偏移
+    uint64_t partOffset;
+    // 分片按内容去重存储在单独的对象中时为该对象的名字，为空表示chunk对象本身
+    std::string objectKey;
+};
+
+enum class LayoutDecodeStatus {
+    // 解析成功
+    OK = 0,
+    // 对象尾部没有layout，是按chunk原样存储的对象
+    NotLayout = 1,
+    // 传入的数据不足以解析出整个layout
+    NeedMore = 2,
+    // layout数据损坏
+    Corrupted = 3,
+};
+
+/**
+ * 快照chunk对象的稀疏、压缩存储格式
+ *
+ * chunk按partSize切分为partNum个分片，全为0的分片不写入对象，
+ * 其余分片可以单独压缩，按序紧密存放，对象末尾追加一个layout描述各分片：
+ *
+ *   | part | part | ... | body | trailer |
+ *   body v1: partSize(4) | partNum(4) | bitmap
+ *   body v2: partSize(4) | partNum(4) | {storedLen(4) | compressType(1)} ...
+ *   body v3: partSize(4) | partNum(4)
+ *            | {storedLen(4) | compressType(1) | hash(32)} ...
+ *   trailer: bodyLen(4) | crc32c(body)(4) | version(4) | magic(8)
+ *
+ * 所有分片都未压缩时使用v1，否则使用v2，v2中storedLen为0表示分片全为0。
+ * 有分片按内容去重存储时使用v3，这类分片以数据的sha256命名存放在单独的
+ * 对象中(见PartObjectKey)，不占用chunk对象的空间，hash全为0表示分片在
+ * chunk对象中。
+ * 整数均为小端序。读取时先读对象尾部，根据magic区分是否为原样存储的对象，
+ * 再通过MapRange把chunk上的读请求映射为对象上的range读
+ */
+class ChunkObjectLayout {
+ public:
+    ChunkObjectLayout() : partSize_(0), partNum_(0) {}
+    ChunkObjectLayout(uint32_t partSize, uint32_t partNum);
+
+    uint32_t GetPartSize() const {
+        return partSize_;
+    }
+
+    uint32_t GetPartNum() const {
+        return partNum_;
+    }
+
+    uint64_t GetChunkSize() const {
+        return static_cast<uint64_t>(partSize_) * partNum_;
+    }
+
+    /**
+     * 标记分片未压缩存储在对象中，对象中的分片按index递增的顺序存放
+     */
+    void SetPartPresent(uint32_t index);
+
+    /**
+     * 设置分片在对象中的存储方式
+     * @param index 分片序号
+     * @param storedLength 分片在对象中的长度，0表示不存在
+     * @param type 分片的压缩算法
+     */
+    void SetPart(uint32_t index, uint32_t storedLength, CompressType type);
+
+    /**
+     * 设置分片存储在以内容hash命名的对象中
+     * @param index 分片序号
+     * @param storedLength 分片在对象中的长度
+     * @param type 分片的压缩算法
+     * @param hash 分片原始数据的sha256，长度为kPartHashSize
+     */
+    void SetPartRef(uint32_t index, uint32_t storedLength, CompressType type,
+                    const std::string &hash);
+
+    bool IsPartPresent(uint32_t index) const;
+
+    // 分片的内容hash，分片不是去重存储时返回空
+    std::string GetPartHash(uint32_t index) const;
+
+    // 是否有分片去重存储在单独的对象中
+    bool HasPartRef() const;
+
+    uint32_t GetStoredLength(uint32_t index) const;
+
+    CompressType GetCompressType(uint32_t index) const;
+
+    // 对象中存储的分片数据长度，即layout在对象中的起始位置
+    uint64_t GetDataLength() const;
+
+    /**
+     * 序列化layout，结果追加到out中
+     */
+    void Encode(std::string *out) const;
+
+    /**
+     * 从对象尾部的数据中解析layout
+     * @param tail 对象尾部的数据
+     * @param len tail的长度
+     * @param[out] layout 解析出的layout
+     * @param[out] needLen 返回NeedMore时，解析需要的对象尾部的长度
+     * @return 解析结果
+     */
+    static LayoutDecodeStatus Decode(const char *tail, size_t len,
+                                     ChunkObjectLayout *layout,
+                                     size_t *needLen);
+
+    /**
+     * 把chunk上的一段区域映射为对象上的若干段区域，相邻的未压缩分片会被合并，
+     * 压缩的分片和去重存储的分片单独映射为一段区域
+     * @param offset chunk上的偏移
+     * @param length 长度
+     * @param[out] extents 映射的结果
+     * @return 区域超出chunk范围时返回false
+     */
+    bool MapRange(uint64_t offset, uint64_t length,
+                  std::vector<ObjectExtent> *extents) const;
+
+    /**
+     * 去重存储的分片数据所在对象的名字，快照文件名以'/'开头，不会与之冲突
+     * @param hash 分片原始数据的sha256
+     */
+    static std::string PartObjectKey(const std::string &hash);
+
+ public:
+    // trailer的长度
+    static const size_t kTrailerSize;
+    // 分片内容hash的长度
+    static const size_t kPartHashSize = 32;
+
+ private:
+    struct PartEntry {
+        // 分片在对象中的长度，0表示不存在
+        uint32_t storedLength;
+        CompressType compressType;
+        // 分片在对象中的偏移
+        uint64_t objectOffset;
+        // 分片的内容hash，为空表示分片在chunk对象中
+        std::string hash;
+    };
+
+    // 所有存在的分片都未压缩
+    bool AllPartsRaw() const;
+
+    // 根据chunk对象中各分片的长度计算在对象中的偏移
+    void UpdateObjectOffset();
+
+ private:
+    uint32_t partSize_;
+    uint32_t partNum_;
+    std::vector<PartEntry> parts_;
+};
+
+}  // namespace common
+}  // namespace curve
+
+#endif  // SRC_COMMON_CHUNK_OBJECT_LAYOUT_H_
@@ -0,0 +1,133 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include "src/common/compression.h"
+
+#include <glog/logging.h>
+#include <string.h>
+#include <zlib.h>
+#include <butil/third_party/snappy/snappy.h>
+
+namespace curve {
+namespace common {
+
+bool ParseCompressType(const std::string &name, CompressType *type) {
+    if (name == "none") {
+        *type = CompressType::None;
+    } else if (name == "snappy") {
+        *type = CompressType::Snappy;
+    } else if (name == "zlib") {
+        *type = CompressType::Zlib;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *CompressTypeName(CompressType type) {
+    switch (type) {
+        case CompressType::None:
+            return "none";
+        case CompressType::Snappy:
+            return "snappy";
+        case CompressType::Zlib:
+            return "zlib";
+        default:
+            return "unknown";
+    }
+}
+
+bool Compress(CompressType type, int level,
+              const char *in, size_t len, std::string *out) {
+    switch (type) {
+        case CompressType::None: {
+            out->assign(in, len);
+            return true;
+        }
+        case CompressType::Snappy: {
+            out->resize(butil::snappy::MaxCompressedLength(len));
+            size_t outLen = 0;
+            butil::snappy::RawCompress(in, len, &(*out)[0], &outLen);
+            out->resize(outLen);
+            return true;
+        }
+        case CompressType::Zlib: {
+            uLongf outLen = compressBound(len);
+            out->resize(outLen);
+            int ret = compress2(reinterpret_cast<Bytef *>(&(*out)[0]),
+                                &outLen,
+                                reinterpret_cast<const Bytef *>(in),
+                                len, level);
+            if (ret != Z_OK) {
+                LOG(ERROR) << "zlib compress failed, ret = " << ret
+                           << ", level = " << level;
+                return false;
+            }
+            out->resize(outLen);
+            return true;
+        }
+        default:
+            LOG(ERROR) << "unknown compress type "
+                       << static_cast<int>(type);
+            return false;
+    }
+}
+
+bool Decompress(CompressType type, const char *in, size_t len,
+                char *out, size_t outLen) {
+    switch (type) {
+        case CompressType::None: {
+            if (len != outLen) {
+                return false;
+            }
+            memcpy(out, in, len);
+            return true;
+        }
+        case CompressType::Snappy: {
+            size_t rawLen = 0;
+            if (!butil::snappy::GetUncompressedLength(in, len, &rawLen) ||
+                rawLen != outLen) {
+                LOG(ERROR) << "snappy data corrupted, len = " << len;
+                return false;
+            }
+            return butil::snappy::RawUncompress(in, len, out);
+        }
+        case CompressType::Zlib: {
+            uLongf rawLen = outLen;
+            int ret = uncompress(reinterpret_cast<Bytef *>(out), &rawLen,
+                                 reinterpret_cast<const Bytef *>(in), len);
+            if (ret != Z_OK || rawLen != outLen) {
+                LOG(ERROR) << "zlib uncompress failed, ret = " << ret
+                           << ", len = " << len;
+                return false;
+            }
+            return true;
+        }
+        default:
+            LOG(ERROR) << "unknown compress type "
+                       << static_cast<int>(type);
+            return false;
+    }
+}
+
+}  // namespace common
+}  // namespace curve
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#ifndef SRC_COMMON_COMPRESSION_H_
+#define SRC_COMMON_COMPRESSION_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+
+namespace curve {
+namespace common {
+
+// 压缩算法，数值会持久化到对象中，不能修改
+enum class CompressType : uint8_t {
+    None = 0,
+    // 压缩和解压速度快，压缩率一般
+    Snappy = 1,
+    // 压缩率高，速度较慢，支持设置压缩级别
+    Zlib = 2,
+};
+
+/**
+ * 根据名字解析压缩算法，名字为none/snappy/zlib
+ * @param name 算法名字
+ * @param[out] type 压缩算法
+ * @return 名字不合法时返回false
+ */
+bool ParseCompressType(const std::string &name, CompressType *type);
+
+const char *CompressTypeName(CompressType type);
+
+/**
+ * 压缩数据
+ * @param type 压缩算法
+ * @param level 压缩级别，只对zlib有效，取值1-9
+ * @param in 待压缩的数据
+ * @param len 待压缩的数据长度
+ * @param[out] out 压缩后的数据
+ * @return 成功返回true
+ */
+bool Compress(CompressType type, int level,
+              const char *in, size_t len, std::string *out);
+
+/**
+ * 解压数据
+ * @param type 压缩算法
+ * @param in 待解压的数据
+ * @param len 待解压的数据长度
+ * @param[out] out 解压后的数据
+ * @param outLen 解压后的数据长度，与实际长度不一致时解压失败
+ * @return 成功返回true
+ */
+bool Decompress(CompressType type, const char *in, size_t len,
+                char *out, size_t outLen);
+
+}  // namespace common
+}  // namespace curve
+
+#endif  // SRC_COMMON_COMPRESSION_H_
@@ -32,6 +32,18 @@ std::string LocationOperator::GenerateS3Location(
     return location;
 }
 
+std::string LocationOperator::GenerateS3PackLocation(
+    const std::string& objectName, uint64_t offset, uint64_t length) {
+    std::string location(objectName);
+    location.append(kOriginPathSeprator)
+            .append(std::to_string(offset))
+            .append(kOriginPathSeprator)
+            .append(std::to_string(length))
+            .append(kOriginTypeSeprator)
+            .append(S3_PACK_TYPE);
+    return location;
+}
+
 std::string LocationOperator::GenerateCurveLocation(
     const std::string& fileName, off_t offset) {
     std::string location(fileName);
@@ -62,6 +74,8 @@ OriginType LocationOperator::ParseLocation(
         type = OriginType::CurveOrigin;
     } else if (typeStr.compare(S3_TYPE) == 0) {
         type = OriginType::S3Origin;
+    } else if (typeStr.compare(S3_PACK_TYPE) == 0) {
+        type = OriginType::S3PackOrigin;
     }
 
     return type;
@@ -91,5 +105,42 @@ bool LocationOperator::ParseCurveChunkPath(
     return true;
 }
 
+bool LocationOperator::ParseS3PackPath(const std::string& originPath,
+                                       std::string* objectName,
+                                       uint64_t* offset,
+                                       uint64_t* length) {
+    // 从后往前解析，对象名中可能包含“:”
+    std::string::size_type lenPos =
+        originPath.find_last_of(kOriginPathSeprator);
+    if (std::string::npos == lenPos || lenPos == 0) {
+        return false;
+    }
+    std::string::size_type offPos =
+        originPath.find_last_of(kOriginPathSeprator, lenPos - 1);
+    if (std::string::npos == offPos) {
+        return false;
+    }
+
+    std::string object = originPath.substr(0, offPos);
+    std::string offStr = originPath.substr(offPos + 1, lenPos - offPos - 1);
+    std::string lenStr = originPath.substr(lenPos + 1);
+    if (object.empty() || offStr.empty() || lenStr.empty() ||
+        offStr.find_first_not_of("0123456789") != std::string::npos ||
+        lenStr.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+
+    if (objectName != nullptr) {
+        *objectName = object;
+    }
+    if (offset != nullptr) {
+        *offset = std::stoull(offStr);
+    }
+    if (length != nullptr) {
+        *length = std::stoull(lenStr);
+    }
+    return true;
+}
+
 }  // namespace common
 }  // namespace curve
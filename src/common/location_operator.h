@@ -23,6 +23,8 @@
 #ifndef SRC_COMMON_LOCATION_OPERATOR_H_
 #define SRC_COMMON_LOCATION_OPERATOR_H_
 
+#include <stdint.h>
+
 #include <string>
 #include <vector>
 
@@ -31,6 +33,7 @@ namespace common {
 
 const char CURVE_TYPE[] = "cs";
 const char S3_TYPE[] = "s3";
+const char S3_PACK_TYPE[] = "s3pack";
 const char kOriginTypeSeprator[] = "@";
 const char kOriginPathSeprator[] = ":";
 
@@ -38,6 +41,8 @@ enum class OriginType {
     S3Origin = 0,
     CurveOrigin = 1,
     InvalidOrigin = 2,
+    // chunk数据是s3上一个pack对象中的一段
+    S3PackOrigin = 3,
 };
 
 class LocationOperator {
@@ -49,6 +54,17 @@ class LocationOperator {
      * @return:生成的location
      */
     static std::string GenerateS3Location(const std::string& objectName);
+    /**
+     * 生成s3 pack对象中一段数据的location
+     * location格式:${objectname}:${offset}:${length}@s3pack
+     * @param objectName:s3上pack对象的名称
+     * @param offset:chunk数据在pack对象中的偏移
+     * @param length:chunk数据在pack对象中的长度
+     * @return:生成的location
+     */
+    static std::string GenerateS3PackLocation(const std::string& objectName,
+                                              uint64_t offset,
+                                              uint64_t length);
     /**
      * 生成curve的location
      * location格式:${filename}:${offset}@cs
@@ -60,6 +76,7 @@ class LocationOperator {
      * location格式:
      * s3示例：${objectname}@s3
      * curve示例：${filename}:${offset}@cs
+     * s3 pack示例：${objectname}:${offset}:${length}@s3pack
      *
      * @param location[in]:数据源的位置，其格式为originPath@originType
      * @param originPath[out]:表示数据源在源端的路径
@@ -80,6 +97,20 @@ class LocationOperator {
     static bool ParseCurveChunkPath(const std::string& originPath,
                                     std::string* fileName,
                                     off_t* offset);
+
+    /**
+     * 解析s3 pack的originPath
+     * 格式:${objectname}:${offset}:${length}
+     * @param originPath[in]:数据源在s3上的路径
+     * @param objectName[out]:pack对象名
+     * @param offset[out]:chunk数据在pack对象中的偏移
+     * @param length[out]:chunk数据在pack对象中的长度
+     * @return: 解析成功返回true，失败返回false
+     */
+    static bool ParseS3PackPath(const std::string& originPath,
+                                std::string* objectName,
+                                uint64_t* offset,
+                                uint64_t* length);
 };
 
 }  // namespace common
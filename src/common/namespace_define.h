@@ -62,6 +62,10 @@ const char CLONEINFOKEYEND[] = "13";
 const char DISCARDSEGMENTKEYPREFIX[] = "13";
 const char DISCARDSEGMENTKEYEND[] = "14";
 
+const char CHUNKPARTREFKEYPREFIX[] = "14";
+const char CHUNKPARTREFKEYEND[] = "15";
+const char CHUNKDEDUPFLAGKEY[] = "15";
+
 // TODO(hzsunjianliang): if use single prefix for snapshot file?
 const int COMMON_PREFIX_LENGTH = 2;
 const int LEADER_PREFIX_LENGTH = 8;
@@ -280,6 +280,30 @@ int S3Adapter::GetObject(const std::string &key,
     }
 }
 
+int S3Adapter::GetObjectTail(const std::string &key,
+                             size_t len,
+                             std::string *data) {
+    Aws::S3::Model::GetObjectRequest request;
+    request.SetBucket(bucketName_);
+    request.SetKey(key.c_str());
+    request.SetRange(("bytes=-" + std::to_string(len)).c_str());
+    if (throttle_) {
+        throttle_->Add(true, len);
+    }
+    auto response = s3Client_->GetObject(request);
+    if (response.IsSuccess()) {
+        std::stringstream ss;
+        ss << response.GetResult().GetBody().rdbuf();
+        *data = ss.str();
+        return 0;
+    } else {
+        LOG(ERROR) << "GetObjectTail error: "
+                << response.GetError().GetExceptionName()
+                << response.GetError().GetMessage();
+        return -1;
+    }
+}
+
 void S3Adapter::GetObjectAsync(std::shared_ptr<GetObjectAsyncContext> context) {
     Aws::S3::Model::GetObjectRequest request;
     request.SetBucket(bucketName_);
@@ -472,5 +496,29 @@ int S3Adapter::AbortMultiUpload(const Aws::String &key,
             return -1;
         }
 }
+
+int S3Adapter::ListMultiUploads(const Aws::String &prefix,
+    std::vector<std::pair<Aws::String, Aws::String>> *uploads) {
+    Aws::S3::Model::ListMultipartUploadsRequest request;
+    request.WithBucket(bucketName_);
+    request.SetPrefix(prefix);
+    while (true) {
+        auto response = s3Client_->ListMultipartUploads(request);
+        if (!response.IsSuccess()) {
+            LOG(ERROR) << "ListMultiUploads error: "
+                       << response.GetError().GetMessage();
+            return -1;
+        }
+        const auto &result = response.GetResult();
+        for (const auto &upload : result.GetUploads()) {
+            uploads->emplace_back(upload.GetKey(), upload.GetUploadId());
+        }
+        if (!result.GetIsTruncated()) {
+            return 0;
+        }
+        request.SetKeyMarker(result.GetNextKeyMarker());
+        request.SetUploadIdMarker(result.GetNextUploadIdMarker());
+    }
+}
 }  // namespace common
 }  // namespace curve
@@ -25,6 +25,8 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <utility>
+#include <vector>
 #include <aws/core/utils/memory/AWSMemory.h>  //NOLINT
 #include <aws/core/Aws.h>   //NOLINT
 #include <aws/s3/S3Client.h>  //NOLINT
@@ -41,6 +43,7 @@
 #include <aws/s3/model/UploadPartRequest.h>  //NOLINT
 #include <aws/s3/model/CompleteMultipartUploadRequest.h>  //NOLINT
 #include <aws/s3/model/AbortMultipartUploadRequest.h>   //NOLINT
+#include <aws/s3/model/ListMultipartUploadsRequest.h>   //NOLINT
 #include <aws/core/http/HttpRequest.h>  //NOLINT
 #include <aws/s3/model/CompletedPart.h>  //NOLINT
 #include <aws/core/http/Scheme.h>  //NOLINT
@@ -131,6 +134,16 @@ class S3Adapter {
      */
     virtual int GetObject(const std::string &key, char *buf, off_t offset, size_t len);   //NOLINT
 
+    /**
+     * 读取对象末尾的数据
+     * @param 对象名
+     * @param 读取的长度，对象长度小于该值时读取整个对象
+     * @param[out] 返回读取的数据
+     * @return 0 成功 / -1 失败
+     */
+    virtual int GetObjectTail(const std::string &key, size_t len,
+                              std::string *data);
+
     /**
      * @brief 异步从对象存储读取数据
      *
@@ -197,6 +210,14 @@ class S3Adapter {
      */
     virtual int AbortMultiUpload(const Aws::String &key,
                         const Aws::String &uploadId);
+    /**
+     * 列出未完成的分片上传任务
+     * @param 对象名前缀
+     * @param[out] 未完成的分片上传任务的对象名和任务id
+     * @return 0 成功/ -1 失败
+     */
+    virtual int ListMultiUploads(const Aws::String &prefix,
+        std::vector<std::pair<Aws::String, Aws::String>> *uploads);
     void SetBucketName(const Aws::String &name) {
         bucketName_ = name;
     }
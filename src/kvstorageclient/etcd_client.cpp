@@ -207,6 +207,28 @@ int EtcdClientImp::TxnN(const std::vector<Operation> &ops) {
     return errCode;
 }
 
+int EtcdClientImp::TxnNWithRevision(const std::vector<Operation> &ops,
+    int64_t *revision) {
+    if (ops.empty()) {
+        LOG(ERROR) << "empty txn";
+        return EtcdErrCode::EtcdInvalidArgument;
+    }
+
+    bool needRetry = false;
+    int retry = 0;
+    int errCode;
+    do {
+        EtcdClientTxnN_return res = EtcdClientTxnN(timeout_,
+            const_cast<Operation*>(ops.data()), ops.size());
+        if (res.r0 == EtcdErrCode::EtcdOK) {
+            *revision = res.r1;
+        }
+        errCode = res.r0;
+        needRetry = NeedRetry(errCode);
+    } while (needRetry && ++retry <= retryTimes_);
+    return errCode;
+}
+
 int EtcdClientImp::GetCurrentRevision(int64_t *revision) {
     bool needRetry = false;
     int retry = 0;
@@ -278,6 +300,74 @@ int EtcdClientImp::ListWithLimitAndRevision(const std::string &startKey,
     return errCode;
 }
 
+int EtcdClientImp::CountWithRevision(const std::string &startKey,
+    const std::string &endKey, int64_t revision, int64_t minModRevision,
+    int64_t *count) {
+    bool needRetry = false;
+    int retry = 0;
+    int errCode;
+    do {
+        EtcdClientCountWithRevision_return res = EtcdClientCountWithRevision(
+            timeout_, const_cast<char*>(startKey.c_str()),
+            const_cast<char*>(endKey.c_str()), startKey.size(),
+            endKey.size(), revision, minModRevision);
+        errCode = res.r0;
+        needRetry = NeedRetry(errCode);
+        if (errCode != EtcdErrCode::EtcdOK) {
+            LOG(WARNING) << "CountWithRevision [start:" << startKey
+                         << ", end:" << endKey << "] at revision: "
+                         << revision << " err: " << errCode
+                         << ", retry: " << retry
+                         << ", needRetry: " << needRetry;
+        } else {
+            *count = res.r1;
+        }
+    } while (needRetry && ++retry <= retryTimes_);
+
+    return errCode;
+}
+
+int EtcdClientImp::WatchWithPrefix(const std::string &prefix,
+    int64_t startRevision, uint32_t timeoutMs,
+    std::vector<WatchEvent> *events) {
+    events->clear();
+    EtcdClientWatch_return res = EtcdClientWatch(
+        timeoutMs, const_cast<char*>(prefix.c_str()), prefix.size(),
+        startRevision);
+    if (res.r0 == EtcdErrCode::EtcdWatchTimeout) {
+        return res.r0;
+    } else if (res.r0 != EtcdErrCode::EtcdOK) {
+        LOG(WARNING) << "watch prefix " << prefix << " from revision "
+                     << startRevision << " err: " << res.r0;
+        return res.r0;
+    }
+
+    int errCode = EtcdErrCode::EtcdOK;
+    for (int i = 0; i < res.r2; i++) {
+        EtcdClientGetWatchEvent_return objRes =
+            EtcdClientGetWatchEvent(res.r1, i);
+        if (objRes.r0 != EtcdErrCode::EtcdOK) {
+            LOG(ERROR) << "get watch event:" << res.r1 << " index:" << i
+                       << ", count:" << res.r2 << " err: " << objRes.r0;
+            errCode = objRes.r0;
+            break;
+        }
+
+        WatchEvent event;
+        event.type = objRes.r1;
+        event.value = std::string(objRes.r2, objRes.r2 + objRes.r3);
+        event.key = std::string(objRes.r4, objRes.r4 + objRes.r5);
+        event.revision = objRes.r6;
+        events->emplace_back(std::move(event));
+        free(objRes.r2);
+        free(objRes.r4);
+    }
+    if (res.r2 > 0) {
+        EtcdClientRemoveObject(res.r1);
+    }
+    return errCode;
+}
+
 int EtcdClientImp::CompareAndSwap(const std::string &key,
     const std::string &preV, const std::string &target) {
     bool needRetry = false;
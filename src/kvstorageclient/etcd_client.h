@@ -30,6 +30,16 @@
 
 namespace curve {
 namespace kvstorage {
+
+// a change of key returned by watch
+struct WatchEvent {
+    OpType type;
+    std::string key;
+    // empty if type is OpDelete
+    std::string value;
+    int64_t revision;
+};
+
 class KVStorageClient {
  public:
     KVStorageClient() {}
@@ -120,6 +130,17 @@ class KVStorageClient {
     */
     virtual int TxnN(const std::vector<Operation> &ops) = 0;
 
+    /*
+    * @brief TxnNWithRevision Operate transactions in the order of ops[0] ops[1] ..., any number of operations is supported //NOLINT
+    *
+    * @param[in] ops Operation set, keys in it must be different
+    * @param[out] revision Revision of the transaction
+    *
+    * @return error code
+    */
+    virtual int TxnNWithRevision(const std::vector<Operation> &ops,
+        int64_t *revision) = 0;
+
     /**
      * @brief CompareAndSwap Transaction, to achieve CAS
      *
@@ -174,6 +195,9 @@ class EtcdClientImp : public KVStorageClient {
 
     int TxnN(const std::vector<Operation> &ops) override;
 
+    int TxnNWithRevision(const std::vector<Operation> &ops,
+        int64_t *revision) override;
+
     int CompareAndSwap(const std::string &key, const std::string &preV,
         const std::string &target) override;
 
@@ -195,6 +219,45 @@ class EtcdClientImp : public KVStorageClient {
         const std::string &endKey, int64_t limit, int64_t revision,
         std::vector<std::string> *values, std::string *lastKey);
 
+    /**
+     * @brief CountWithRevision count the keys between [startKey, endKey)
+     *        at the specified revision
+     *
+     * @param[in] startKey start key
+     * @param[in] endKey end key, not included
+     * @param[in] revision count the keys at this revision
+     * @param[in] minModRevision only count the keys modified at or after
+     *            minModRevision if it is greater than 0
+     * @param[out] count number of the keys
+     *
+     * @return EtcdErrCode::EtcdOK success, EtcdErrCode::EtcdOutOfRange if
+     *         revision has been compacted, others fail
+     */
+    virtual int CountWithRevision(const std::string &startKey,
+        const std::string &endKey, int64_t revision, int64_t minModRevision,
+        int64_t *count);
+
+    /**
+     * @brief WatchWithPrefix wait for changes of keys with the prefix since
+     *        startRevision, return when changes come or timeout. Changes
+     *        before the watch starts are in history and sent by etcd in
+     *        the background, so timeout does not prove nothing changed.
+     *
+     * @param[in] prefix prefix of the keys
+     * @param[in] startRevision watch changes whose revision >= startRevision
+     * @param[in] timeoutMs max time to wait for changes
+     * @param[out] events changes in revision order
+     *
+     * @return EtcdErrCode::EtcdOK success with at least one change,
+     *         EtcdErrCode::EtcdWatchTimeout if no change comes in timeoutMs,
+     *         EtcdErrCode::EtcdWatchClosed if the watch is closed,
+     *         EtcdErrCode::EtcdOutOfRange if startRevision has been
+     *         compacted, others fail
+     */
+    virtual int WatchWithPrefix(const std::string &prefix,
+        int64_t startRevision, uint32_t timeoutMs,
+        std::vector<WatchEvent> *events);
+
     /**
      * @brief CampaignLeader Leader campaign through etcd, return directly if
      *                       the election is successful. Otherwise, if
@@ -22,10 +22,13 @@
 
 #include "src/mds/chunkserverclient/chunkserver_client.h"
 
+#include <brpc/errno.pb.h>
+
 #include <string>
 #include <chrono>  //NOLINT
 #include <thread>  //NOLINT
 #include <utility>
+#include <vector>
 
 using ::curve::mds::topology::ChunkServer;
 using ::curve::mds::topology::SplitPeerId;
@@ -228,6 +231,128 @@ int ChunkServerClient::DeleteChunk(ChunkServerIdType leaderId,
     return kMdsSuccess;
 }
 
+int ChunkServerClient::DeleteChunks(ChunkServerIdType leaderId,
+    LogicalPoolID logicalPoolId,
+    CopysetID copysetId,
+    const std::vector<ChunkID> &chunkIds,
+    uint64_t sn) {
+    if (chunkIds.empty()) {
+        return kMdsSuccess;
+    }
+
+    // don't send DeleteChunks to the chunkserver which is known not to
+    // support it, until it restarts
+    uint64_t startUpTime = GetChunkServerStartUpTime(leaderId);
+    if (IsDeleteChunksNotSupported(leaderId, startUpTime)) {
+        return kCsClientNotSupported;
+    }
+
+    ChannelPtr channelPtr;
+    int res = GetOrInitChannel(leaderId, &channelPtr);
+    if (res != kMdsSuccess) {
+        return res;
+    }
+    ChunkService_Stub stub(channelPtr.get());
+
+    brpc::Controller cntl;
+    cntl.set_timeout_ms(rpcTimeoutMs_);
+
+    ChunkRequest request;
+    request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_DELETE_BATCH);
+    request.set_logicpoolid(logicalPoolId);
+    request.set_copysetid(copysetId);
+    request.set_chunkid(chunkIds[0]);
+    request.set_sn(sn);
+    for (auto chunkId : chunkIds) {
+        request.add_chunkids(chunkId);
+    }
+
+    ChunkResponse response;
+    uint32_t retry = 0;
+    do {
+        cntl.Reset();
+        cntl.set_timeout_ms(rpcTimeoutMs_);
+        stub.DeleteChunks(&cntl,
+            &request,
+            &response,
+            nullptr);
+        LOG(INFO) << "Send DeleteChunks[log_id=" << cntl.log_id()
+                  << "] from " << cntl.local_side()
+                  << " to " << cntl.remote_side()
+                  << ", logicalPoolId = " << logicalPoolId
+                  << ", copysetId = " << copysetId
+                  << ", chunk num = " << chunkIds.size()
+                  << ", sn = " << sn;
+        if (cntl.Failed()) {
+            // chunkserver which is not upgraded has no DeleteChunks rpc
+            if (cntl.ErrorCode() == brpc::ENOMETHOD) {
+                LOG(WARNING) << "Send DeleteChunks error, not supported by "
+                             << cntl.remote_side()
+                             << ", cntl.errorText = " << cntl.ErrorText();
+                SetDeleteChunksNotSupported(leaderId, startUpTime);
+                return kCsClientNotSupported;
+            }
+            LOG(WARNING) << "Send DeleteChunks error, "
+                       << "cntl.errorText = "
+                       << cntl.ErrorText()
+                       << ", retry, time = "
+                       << retry;
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(rpcRetryIntervalMs_));
+        }
+        retry++;
+    } while (cntl.Failed() && retry < rpcRetryTimes_);
+
+    if (cntl.Failed()) {
+        LOG(ERROR) << "Send DeleteChunks error, retry fail,"
+                   << "cntl.errorText = "
+                   << cntl.ErrorText() << std::endl;
+        return kRpcFail;
+    } else {
+        switch (response.status()) {
+            case CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS:
+            case CHUNK_OP_STATUS::CHUNK_OP_STATUS_CHUNK_NOTEXIST: {
+                    LOG(INFO) << "Received DeleteChunks[log_id="
+                          << cntl.log_id()
+                          << "] from " << cntl.remote_side()
+                          << " to " << cntl.local_side()
+                          << ". [ChunkResponse] "
+                          << response.DebugString();
+                    return kMdsSuccess;
+                }
+            case CHUNK_OP_STATUS::CHUNK_OP_STATUS_REDIRECTED: {
+                    LOG(INFO) << "Received DeleteChunks, not leader, redirect."
+                              << " [log_id=" << cntl.log_id()
+                              << "] from " << cntl.remote_side()
+                              << " to " << cntl.local_side()
+                              << ". [ChunkResponse] "
+                              << response.DebugString();
+                    return kCsClientNotLeader;
+                }
+            case CHUNK_OP_STATUS::CHUNK_OP_STATUS_INVALID_REQUEST: {
+                    LOG(WARNING) << "Received DeleteChunks, not supported."
+                                 << " [log_id=" << cntl.log_id()
+                                 << "] from " << cntl.remote_side()
+                                 << " to " << cntl.local_side()
+                                 << ". [ChunkResponse] "
+                                 << response.DebugString();
+                    SetDeleteChunksNotSupported(leaderId, startUpTime);
+                    return kCsClientNotSupported;
+                }
+            default: {
+                    LOG(ERROR) << "Received DeleteChunks error, [log_id="
+                              << cntl.log_id()
+                              << "] from " << cntl.remote_side()
+                              << " to " << cntl.local_side()
+                              << ". [ChunkResponse] "
+                              << response.DebugString();
+                    return kCsClientReturnFail;
+                }
+        }
+    }
+    return kMdsSuccess;
+}
+
 int ChunkServerClient::GetLeader(ChunkServerIdType csId,
     LogicalPoolID logicalPoolId,
     CopysetID copysetId,
@@ -339,6 +464,35 @@ int ChunkServerClient::GetOrInitChannel(ChunkServerIdType csId,
     return kMdsSuccess;
 }
 
+uint64_t ChunkServerClient::GetChunkServerStartUpTime(
+    ChunkServerIdType csId) {
+    ChunkServer chunkServer;
+    if (true != topology_->GetChunkServer(csId, &chunkServer)) {
+        return 0;
+    }
+    return chunkServer.GetStartUpTime();
+}
+
+bool ChunkServerClient::IsDeleteChunksNotSupported(ChunkServerIdType csId,
+                                                   uint64_t startUpTime) {
+    ::curve::common::LockGuard guard(deleteChunksNotSupportedMtx_);
+    auto iter = deleteChunksNotSupported_.find(csId);
+    if (iter == deleteChunksNotSupported_.end()) {
+        return false;
+    }
+    if (iter->second != startUpTime) {
+        deleteChunksNotSupported_.erase(iter);
+        return false;
+    }
+    return true;
+}
+
+void ChunkServerClient::SetDeleteChunksNotSupported(ChunkServerIdType csId,
+                                                    uint64_t startUpTime) {
+    ::curve::common::LockGuard guard(deleteChunksNotSupportedMtx_);
+    deleteChunksNotSupported_[csId] = startUpTime;
+}
+
 }  // namespace chunkserverclient
 }  // namespace mds
 }  // namespace curve
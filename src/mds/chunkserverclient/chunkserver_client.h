@@ -28,7 +28,10 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
+#include "src/common/concurrent/concurrent.h"
 #include "src/mds/common/mds_define.h"
 #include "src/mds/topology/topology.h"
 #include "proto/cli2.pb.h"
@@ -94,6 +97,24 @@ class ChunkServerClient {
         ChunkID chunkId,
         uint64_t sn);
 
+    /**
+     * @brief delete chunks of one copyset in one request, the chunks are
+     *        deleted in one raft log entry on chunkserver
+     *
+     * @param leaderId
+     * @param logicalPoolId
+     * @param copysetId
+     * @param chunkIds chunk file IDs
+     * @param sn file version number
+     *
+     * @return error code
+     */
+    virtual int DeleteChunks(ChunkServerIdType leaderId,
+        LogicalPoolID logicalPoolId,
+        CopysetID copysetId,
+        const std::vector<ChunkID> &chunkIds,
+        uint64_t sn);
+
     /**
      * @brief get the leader
      * @detail
@@ -126,11 +147,38 @@ class ChunkServerClient {
     int GetOrInitChannel(ChunkServerIdType csId,
                          ChannelPtr* channelPtr);
 
+    /**
+     * @brief get the startup time of the chunkserver from the topology
+     *
+     * @param csId ID of target chunkserver
+     *
+     * @return startup time, 0 if the chunkserver is not found
+     */
+    uint64_t GetChunkServerStartUpTime(ChunkServerIdType csId);
+
+    /**
+     * @brief whether the chunkserver has returned kCsClientNotSupported
+     *        for DeleteChunks since its last startup
+     *
+     * @param csId ID of target chunkserver
+     * @param startUpTime current startup time of the chunkserver
+     */
+    bool IsDeleteChunksNotSupported(ChunkServerIdType csId,
+                                    uint64_t startUpTime);
+
+    void SetDeleteChunksNotSupported(ChunkServerIdType csId,
+                                     uint64_t startUpTime);
+
     std::shared_ptr<Topology> topology_;
     uint32_t rpcTimeoutMs_;
     uint32_t rpcRetryTimes_;
     uint32_t rpcRetryIntervalMs_;
     std::shared_ptr<ChannelPool> channelPool_;
+
+    // chunkservers not supporting DeleteChunks and their startup time,
+    // they are asked again after restart, which may be an upgrade
+    std::unordered_map<ChunkServerIdType, uint64_t> deleteChunksNotSupported_;
+    ::curve::common::Mutex deleteChunksNotSupportedMtx_;
 };
 
 }  // namespace chunkserverclient
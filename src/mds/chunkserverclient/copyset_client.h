@@ -24,6 +24,7 @@
 #define SRC_MDS_CHUNKSERVERCLIENT_COPYSET_CLIENT_H_
 
 #include <memory>
+#include <vector>
 #include "src/mds/common/mds_define.h"
 #include "src/mds/topology/topology.h"
 
@@ -92,6 +93,21 @@ class CopysetClient {
         ChunkID chunkId,
         uint64_t sn);
 
+    /**
+     * @brief delete chunk files of one copyset in one request
+     *
+     * @param logicPoolId
+     * @param copysetId
+     * @param chunkIds
+     * @param sn file version number
+     *
+     * @return error code
+     */
+    int DeleteChunks(LogicalPoolID logicalPoolId,
+        CopysetID copysetId,
+        const std::vector<ChunkID> &chunkIds,
+        uint64_t sn);
+
     /**
      * @brief update leader
      *
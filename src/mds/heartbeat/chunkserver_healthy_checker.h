@@ -46,6 +46,8 @@ struct HeartbeatOption {
         this->heartbeatIntervalMs = heartbeatInterval;
         this->heartbeatMissTimeOutMs = heartbeatMissTimeout;
         this->offLineTimeOutMs = offLineTimeout;
+        this->workerNum = 0;
+        this->workerQueueCapacity = 1024;
     }
 
     // heartbeatIntervalMs: normal heartbeat interval.
@@ -69,6 +71,15 @@ struct HeartbeatOption {
 
     // the time when the mds start (fetch from system)
     steady_clock::time_point mdsStartTime;
+
+    // number of workers handling heartbeats, heartbeats of a chunkserver
+    // are always handled by the same worker. 0 means heartbeats are
+    // handled in brpc workers directly
+    uint32_t workerNum;
+
+    // max number of heartbeats queued in a worker, heartbeats are rejected
+    // when the queue is full
+    uint32_t workerQueueCapacity;
 };
 
 struct HeartbeatInfo {
@@ -20,9 +20,13 @@
  * Author: lixiaocui
  */
 
+#include <brpc/closure_guard.h>
 #include <glog/logging.h>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
 #include <utility>
 #include <set>
+#include <unordered_set>
 #include "src/mds/heartbeat/heartbeat_manager.h"
 #include "src/common/string_util.h"
 #include "src/mds/topology/topology_stat.h"
@@ -37,6 +41,9 @@ using ::curve::mds::topology::ChunkServerStatus;
 using ::curve::mds::topology::ChunkServerStat;
 using ::curve::mds::topology::CopysetStat;
 using ::curve::mds::topology::SplitPeerId;
+using ::curve::common::UniqueLock;
+using ::curve::common::ReadLockGuard;
+using ::curve::common::WriteLockGuard;
 
 namespace curve {
 namespace mds {
@@ -46,7 +53,11 @@ HeartbeatManager::HeartbeatManager(HeartbeatOption option,
     std::shared_ptr<TopologyStat> topologyStat,
     std::shared_ptr<Coordinator> coordinator)
     : topology_(topology),
-      topologyStat_(topologyStat) {
+      topologyStat_(topologyStat),
+      coordinator_(coordinator),
+      workerNum_(option.workerNum),
+      workerQueueCapacity_(option.workerQueueCapacity),
+      workersRunning_(false) {
     healthyChecker_ =
         std::make_shared<ChunkserverHealthyChecker>(option, topology);
 
@@ -73,6 +84,7 @@ void HeartbeatManager::Init() {
 
 void HeartbeatManager::Run() {
     if (isStop_.exchange(false)) {
+        StartWorkers();
         backEndThread_ =
             Thread(&HeartbeatManager::ChunkServerHealthyChecker, this);
     }
@@ -81,6 +93,7 @@ void HeartbeatManager::Run() {
 void HeartbeatManager::Stop() {
     if (!isStop_.exchange(true)) {
         LOG(INFO) << "stop heartbeatManager...";
+        StopWorkers();
         sleeper_.interrupt();
         backEndThread_.join();
         LOG(INFO) << "stop heartbeatManager ok.";
@@ -89,10 +102,165 @@ void HeartbeatManager::Stop() {
     }
 }
 
+void HeartbeatManager::StartWorkers() {
+    if (workerNum_ == 0) {
+        return;
+    }
+    if (workerQueueCapacity_ == 0) {
+        LOG(ERROR) << "start heartbeat worker fail, queue capacity = "
+                   << workerQueueCapacity_
+                   << ", heartbeats will be handled inline";
+        return;
+    }
+
+    WriteLockGuard wlock(workersLock_);
+    workers_.clear();
+    for (uint32_t i = 0; i < workerNum_; ++i) {
+        std::unique_ptr<HeartbeatWorker> worker(new HeartbeatWorker());
+        worker->thread = Thread(&HeartbeatManager::HeartbeatWorkerFunc,
+                                this, worker.get());
+        workers_.emplace_back(std::move(worker));
+    }
+    workersRunning_ = true;
+    LOG(INFO) << "start " << workerNum_ << " heartbeat workers ok,"
+              << " queue capacity = " << workerQueueCapacity_;
+}
+
+void HeartbeatManager::StopWorkers() {
+    // no heartbeat can be queued after the write lock is acquired,
+    // and heartbeats queued are handled before the workers exit,
+    // otherwise their closures are never run
+    WriteLockGuard wlock(workersLock_);
+    if (!workersRunning_) {
+        return;
+    }
+    workersRunning_ = false;
+    for (auto &worker : workers_) {
+        {
+            UniqueLock lk(worker->mtx);
+            worker->stop = true;
+        }
+        worker->cond.notify_one();
+    }
+    for (auto &worker : workers_) {
+        worker->thread.join();
+    }
+    workers_.clear();
+}
+
+void HeartbeatManager::HeartbeatWorkerFunc(HeartbeatWorker *worker) {
+    while (true) {
+        std::deque<HeartbeatTask> tasks;
+        {
+            UniqueLock lk(worker->mtx);
+            worker->cond.wait(lk, [worker] {
+                return worker->stop || !worker->queue.empty();
+            });
+            if (worker->queue.empty()) {
+                return;
+            }
+            tasks.swap(worker->queue);
+        }
+
+        std::vector<::curve::mds::topology::CopySetInfo> leaderCopySetInfos;
+        for (auto &task : tasks) {
+            HandleChunkServerHeartbeat(
+                *task.request, task.response, &leaderCopySetInfos);
+        }
+
+        // a copyset may be reported by several leaders in one batch, e.g.
+        // leader transferred, only the report with the largest epoch is
+        // applied, the later one wins if epochs are equal
+        std::map<CopySetKey, size_t> latest;
+        std::vector<::curve::mds::topology::CopySetInfo> toUpdate;
+        for (auto &info : leaderCopySetInfos) {
+            auto iter = latest.find(info.GetCopySetKey());
+            if (iter == latest.end()) {
+                latest.emplace(info.GetCopySetKey(), toUpdate.size());
+                toUpdate.emplace_back(info);
+            } else if (toUpdate[iter->second].GetEpoch() <= info.GetEpoch()) {
+                toUpdate[iter->second] = info;
+            }
+        }
+        if (!toUpdate.empty()) {
+            topoUpdater_->UpdateTopo(toUpdate);
+        }
+
+        // responses are sent after topology is updated
+        for (auto &task : tasks) {
+            task.done->Run();
+        }
+    }
+}
+
+bool HeartbeatManager::AsyncChunkServerHeartbeat(
+    const ChunkServerHeartbeatRequest *request,
+    ChunkServerHeartbeatResponse *response,
+    google::protobuf::Closure *done) {
+    {
+        ReadLockGuard rlock(workersLock_);
+        if (workersRunning_) {
+            // chunkserverid is a required field, a request without it is
+            // rejected by CheckRequest in any worker
+            HeartbeatWorker *worker =
+                workers_[request->chunkserverid() % workers_.size()].get();
+            {
+                UniqueLock lk(worker->mtx);
+                // reject instead of blocking the brpc worker, the
+                // chunkserver retries in its next heartbeat
+                if (worker->queue.size() >= workerQueueCapacity_) {
+                    LOG_EVERY_N(WARNING, 100)
+                        << "heartbeat queue is full, reject heartbeat of"
+                        << " chunkserver " << request->chunkserverid();
+                    return false;
+                }
+                worker->queue.push_back(HeartbeatTask{request, response, done});
+            }
+            worker->cond.notify_one();
+            return true;
+        }
+    }
+
+    brpc::ClosureGuard doneGuard(done);
+    ChunkServerHeartbeat(*request, response);
+    return true;
+}
+
 void HeartbeatManager::ChunkServerHealthyChecker() {
     while (sleeper_.wait_for(
         std::chrono::milliseconds(chunkserverHealthyCheckerRunInter_))) {
         healthyChecker_->CheckHeartBeatInterval();
+        PruneChunkServerReports();
+    }
+}
+
+void HeartbeatManager::PruneChunkServerReports() {
+    {
+        ReadLockGuard lk(reportsLock_);
+        if (reports_.empty()) {
+            return;
+        }
+    }
+
+    auto inCluster = topology_->GetChunkServerInCluster(
+        [] (const ChunkServer &cs) {
+            return cs.GetStatus() != ChunkServerStatus::RETIRED;
+        });
+    std::unordered_set<ChunkServerIdType> alive(inCluster.begin(),
+                                                inCluster.end());
+
+    // a heartbeat being handled may still hold the pruned report, the next
+    // heartbeat of the chunkserver starts a new one and asks for full report
+    WriteLockGuard lk(reportsLock_);
+    for (auto iter = reports_.begin(); iter != reports_.end();) {
+        if (alive.count(iter->first) != 0) {
+            ++iter;
+            continue;
+        }
+
+        LOG(INFO) << "heartbeatManager prune last report of chunkserver "
+                  << iter->first << ", it is retired or removed";
+        iter = reports_.erase(iter);
     }
 }
 
@@ -120,7 +288,8 @@ void HeartbeatManager::UpdateChunkServerDiskStatus(
 }
 
 void HeartbeatManager::UpdateChunkServerStatistics(
-    const ChunkServerHeartbeatRequest &request) {
+    const ChunkServerHeartbeatRequest &request,
+    ChunkServerReport *report) {
     ChunkServerStat stat;
     stat.leaderCount = request.leadercount();
     stat.copysetCount = request.copysetcount();
@@ -170,9 +339,21 @@ void HeartbeatManager::UpdateChunkServerStatistics(
                              << ", " << cstat.copysetId << "} "
                              << "do not have CopysetStatistics";
             }
-            stat.copysetStats.push_back(cstat);
+            if (report != nullptr) {
+                report->copysetStats[CopySetKey(
+                    cstat.logicalPoolId, cstat.copysetId)] = cstat;
+            } else {
+                stat.copysetStats.push_back(cstat);
+            }
         }
 
+        // stats of copysets not in delta heartbeat are kept as last report
+        if (report != nullptr) {
+            stat.copysetStats.reserve(report->copysetStats.size());
+            for (const auto &item : report->copysetStats) {
+                stat.copysetStats.push_back(item.second);
+            }
+        }
     } else {
         LOG(WARNING) << "hearbeat manager receive request "
                      << "do not have ChunkServerStatisticInfo";
@@ -183,6 +364,17 @@ void HeartbeatManager::UpdateChunkServerStatistics(
 void HeartbeatManager::ChunkServerHeartbeat(
     const ChunkServerHeartbeatRequest &request,
     ChunkServerHeartbeatResponse *response) {
+    std::vector<::curve::mds::topology::CopySetInfo> leaderCopySetInfos;
+    HandleChunkServerHeartbeat(request, response, &leaderCopySetInfos);
+    if (!leaderCopySetInfos.empty()) {
+        topoUpdater_->UpdateTopo(leaderCopySetInfos);
+    }
+}
+
+void HeartbeatManager::HandleChunkServerHeartbeat(
+    const ChunkServerHeartbeatRequest &request,
+    ChunkServerHeartbeatResponse *response,
+    std::vector<::curve::mds::topology::CopySetInfo> *leaderCopySetInfos) {
     response->set_statuscode(HeartbeatStatusCode::hbOK);
     // check validity of heartbeat request
     HeartbeatStatusCode ret = CheckRequest(request);
@@ -204,13 +396,31 @@ void HeartbeatManager::ChunkServerHeartbeat(
 
     UpdateChunkServerDiskStatus(request);
 
-    UpdateChunkServerStatistics(request);
+    // chunkserver supporting delta heartbeat reports version of copysets,
+    // its last report is locked until the heartbeat is handled
+    std::shared_ptr<ChunkServerReport> report;
+    UniqueLock reportLock;
+    if (request.has_reportversion()) {
+        report = GetChunkServerReport(request.chunkserverid());
+        reportLock = UniqueLock(report->mtx);
+        if (!ApplyReportVersion(request, report.get())) {
+            response->set_needfullreport(true);
+            reportLock.unlock();
+            report = nullptr;
+        }
+    }
+    const bool deltaApplied =
+        report != nullptr && request.has_baseversion();
+
+    UpdateChunkServerStatistics(request, report.get());
     // no copyset info in the request
-    if (request.copysetinfos_size() == 0) {
+    if (request.copysetinfos_size() == 0 && !deltaApplied) {
         response->set_statuscode(HeartbeatStatusCode::hbRequestNoCopyset);
     }
     // dealing with copysets included in the heartbeat request
+    std::set<CopySetKey> reported;
     for (auto &value : request.copysetinfos()) {
+        reported.emplace(value.logicalpoolid(), value.copysetid());
         // discard copysets of invalid logical pool
         ::curve::mds::topology::LogicalPool lPool;
         if (topology_->GetLogicalPool(value.logicalpoolid(), &lPool)) {
@@ -242,9 +452,95 @@ void HeartbeatManager::ChunkServerHeartbeat(
         }
 
         // if a copyset is the leader, update (e.g. epoch) topology according
-        // to its info
+        // to its info, copysets are collected and updated in one batch
         if (request.chunkserverid() == reportCopySetInfo.GetLeader()) {
-            topoUpdater_->UpdateTopo(reportCopySetInfo);
+            leaderCopySetInfos->emplace_back(reportCopySetInfo);
+        }
+
+        if (report != nullptr) {
+            if (request.chunkserverid() == reportCopySetInfo.GetLeader()) {
+                report->leaderCopysets[reportCopySetInfo.GetCopySetKey()] =
+                    reportCopySetInfo;
+            } else {
+                report->leaderCopysets.erase(
+                    reportCopySetInfo.GetCopySetKey());
+            }
+        }
+    }
+
+    if (deltaApplied) {
+        DispatchUnreportedCopysets(
+            request.chunkserverid(), reported, *report, response);
+    }
+}
+
+std::shared_ptr<HeartbeatManager::ChunkServerReport>
+HeartbeatManager::GetChunkServerReport(ChunkServerIdType id) {
+    {
+        ReadLockGuard lk(reportsLock_);
+        auto iter = reports_.find(id);
+        if (iter != reports_.end()) {
+            return iter->second;
+        }
+    }
+
+    WriteLockGuard lk(reportsLock_);
+    auto &report = reports_[id];
+    if (report == nullptr) {
+        report = std::make_shared<ChunkServerReport>();
+    }
+    return report;
+}
+
+bool HeartbeatManager::ApplyReportVersion(
+    const ChunkServerHeartbeatRequest &request, ChunkServerReport *report) {
+    // full report, replace the last one
+    if (!request.has_baseversion()) {
+        report->version = request.reportversion();
+        report->copysetStats.clear();
+        report->leaderCopysets.clear();
+        return true;
+    }
+
+    // the delta is not based on what mds has, e.g. mds restarted or
+    // the last heartbeat is lost
+    if (report->version == 0 || report->version != request.baseversion()) {
+        LOG(INFO) << "heartbeatManager can not apply delta heartbeat from "
+                  << "chunkserver " << request.chunkserverid()
+                  << ", base version: " << request.baseversion()
+                  << ", applied version: " << report->version
+                  << ", ask for full report";
+        report->version = 0;
+        report->copysetStats.clear();
+        report->leaderCopysets.clear();
+        return false;
+    }
+
+    report->version = request.reportversion();
+    for (const auto &removed : request.removedcopysets()) {
+        CopySetKey key(removed.logicalpoolid(), removed.copysetid());
+        report->copysetStats.erase(key);
+        report->leaderCopysets.erase(key);
+    }
+    return true;
+}
+
+void HeartbeatManager::DispatchUnreportedCopysets(
+    ChunkServerIdType csId, const std::set<CopySetKey> &reported,
+    const ChunkServerReport &report,
+    ChunkServerHeartbeatResponse *response) {
+    // unchanged copysets need no topology update, but operators generated
+    // by scheduler are dispatched through leader's heartbeat
+    for (const auto &item : report.leaderCopysets) {
+        if (reported.count(item.first) != 0 ||
+            !coordinator_->HasOperator(item.first)) {
+            continue;
+        }
+
+        CopySetConf conf;
+        if (copysetConfGenerator_->GenCopysetConf(
+                csId, item.second, ConfigChangeInfo(), &conf)) {
+            *response->add_needupdatecopysets() = conf;
         }
     }
 }
@@ -24,10 +24,13 @@
 #define SRC_MDS_HEARTBEAT_HEARTBEAT_MANAGER_H_
 
 #include <vector>
+#include <deque>
 #include <map>
 #include <atomic>
 #include <string>
 #include <memory>
+#include <set>
+#include <unordered_map>
 
 #include "src/mds/topology/topology.h"
 #include "src/mds/common/mds_define.h"
@@ -45,11 +48,15 @@ using ::curve::mds::topology::PoolIdType;
 using ::curve::mds::topology::CopySetIdType;
 using ::curve::mds::topology::Topology;
 using ::curve::mds::topology::TopologyStat;
+using ::curve::mds::topology::CopySetKey;
+using ::curve::mds::topology::CopysetStat;
 using ::curve::mds::schedule::Coordinator;
 
 using ::curve::common::Thread;
 using ::curve::common::Atomic;
 using ::curve::common::RWLock;
+using ::curve::common::Mutex;
+using ::curve::common::ConditionVariable;
 using ::curve::common::InterruptibleSleeper;
 
 namespace curve {
@@ -70,6 +77,16 @@ namespace heartbeat {
 // 3. update topology information
 //    - update epoch, copy relationship and other statistical data of topology
 //      according to the copyset information reported by the chunkserver
+// 4. apply delta heartbeats
+//    - chunkserver may only report copysets changed since the last report
+//      acked by mds, mds keeps the last report of each chunkserver, and
+//      asks for a full report when a delta can not be applied
+// 5. shard heartbeat handling
+//    - heartbeats can be queued into worker shards keyed by chunkserver id,
+//      so heartbeats of one chunkserver are handled in order and brpc
+//      workers are not occupied by heartbeat handling
+//    - heartbeats queued in a shard are handled in batches, leader copysets
+//      of a batch are applied to topology together
 
 class HeartbeatManager {
  public:
@@ -110,7 +127,91 @@ class HeartbeatManager {
     void ChunkServerHeartbeat(const ChunkServerHeartbeatRequest &request,
                                 ChunkServerHeartbeatResponse *response);
 
+    /**
+     * @brief AsyncChunkServerHeartbeat Queue heartbeat request to the worker
+     *        shard of the chunkserver, the request is handled inline if
+     *        workers are not enabled or not running
+     *
+     * @param[in] request RPC heartbeat request
+     * @param[out] response Response of heartbeat request
+     * @param[in] done Closure run after the request is handled
+     *
+     * @return false if the queue of the shard is full, the request is
+     *         rejected and done is not run
+     */
+    bool AsyncChunkServerHeartbeat(const ChunkServerHeartbeatRequest *request,
+                                   ChunkServerHeartbeatResponse *response,
+                                   google::protobuf::Closure *done);
+
+    /**
+     * @brief PruneChunkServerReports Drop last reports of chunkservers
+     *        retired or removed from topology, called periodically by
+     *        the background thread
+     */
+    void PruneChunkServerReports();
+
  private:
+    // heartbeat queued in a worker shard
+    struct HeartbeatTask {
+        const ChunkServerHeartbeatRequest *request;
+        ChunkServerHeartbeatResponse *response;
+        google::protobuf::Closure *done;
+    };
+
+    // worker shard handling queued heartbeats in batches
+    struct HeartbeatWorker {
+        Mutex mtx;
+        ConditionVariable cond;
+        std::deque<HeartbeatTask> queue;
+        bool stop = false;
+        Thread thread;
+    };
+
+    // copysets reported by a chunkserver, used for applying delta heartbeats
+    struct ChunkServerReport {
+        Mutex mtx;
+        // version of the last applied report, 0 if none
+        uint64_t version = 0;
+        // stats of all copysets on the chunkserver
+        std::map<CopySetKey, CopysetStat> copysetStats;
+        // copysets whose leader is the chunkserver, in topology format
+        std::map<CopySetKey, ::curve::mds::topology::CopySetInfo>
+            leaderCopysets;
+    };
+
+    /**
+     * @brief Get the last report of chunkserver, create if not exist
+     */
+    std::shared_ptr<ChunkServerReport> GetChunkServerReport(
+        ChunkServerIdType id);
+
+    /**
+     * @brief Apply version info of the request to the last report of
+     *        chunkserver
+     *
+     * @param[in] request Heartbeat request
+     * @param[in] report Last report of the chunkserver, locked by caller
+     *
+     * @return false if the request is a delta heartbeat that can not be
+     *         applied, chunkserver should make a full report
+     */
+    bool ApplyReportVersion(const ChunkServerHeartbeatRequest &request,
+                            ChunkServerReport *report);
+
+    /**
+     * @brief Dispatch pending operators of leader copysets that are not
+     *        reported in delta heartbeat, since they are unchanged
+     *
+     * @param[in] csId Chunkserver sending the heartbeat
+     * @param[in] reported Copysets reported in the heartbeat
+     * @param[in] report Last report of the chunkserver
+     * @param[out] response Response of heartbeat request
+     */
+    void DispatchUnreportedCopysets(ChunkServerIdType csId,
+                                    const std::set<CopySetKey> &reported,
+                                    const ChunkServerReport &report,
+                                    ChunkServerHeartbeatResponse *response);
+
     /**
      * @brief Update disk status data of chunkserver
      *
@@ -123,13 +224,47 @@ class HeartbeatManager {
      * @brief Update statistical data of chunkserver
      *
      * @param request Heartbeat request
-     * @param response response of heartbeat request
+     * @param report Last report of the chunkserver, copyset stats reported
+     *               are merged into it, nullptr if not delta heartbeat
      */
     void UpdateChunkServerStatistics(
-        const ChunkServerHeartbeatRequest &request);
+        const ChunkServerHeartbeatRequest &request,
+        ChunkServerReport *report);
+
+    /**
+     * @brief Handle a heartbeat request except applying its leader copysets
+     *        to topology, so that copysets of several heartbeats can be
+     *        applied in one batch
+     *
+     * @param[in] request RPC heartbeat request
+     * @param[out] response Response of heartbeat request
+     * @param[out] leaderCopySetInfos Leader copysets of the request are
+     *             appended to it
+     */
+    void HandleChunkServerHeartbeat(
+        const ChunkServerHeartbeatRequest &request,
+        ChunkServerHeartbeatResponse *response,
+        std::vector<::curve::mds::topology::CopySetInfo> *leaderCopySetInfos);
 
     /**
-     * @brief Background thread for heartbeat timeout inspection
+     * @brief Start workers handling heartbeats
+     */
+    void StartWorkers();
+
+    /**
+     * @brief Stop workers after heartbeats queued are all handled
+     */
+    void StopWorkers();
+
+    /**
+     * @brief Worker thread, takes all heartbeats queued each time and
+     *        handles them as a batch, exits when stopped and queue is empty
+     */
+    void HeartbeatWorkerFunc(HeartbeatWorker *worker);
+
+    /**
+     * @brief Background thread for heartbeat timeout inspection and
+     *        pruning last reports of chunkservers no longer in cluster
      */
     void ChunkServerHealthyChecker();
 
@@ -183,6 +318,20 @@ class HeartbeatManager {
     // 3. chunkserver in not included in latest copyset
     std::shared_ptr<CopysetConfGenerator> copysetConfGenerator_;
 
+    // last report of each chunkserver for delta heartbeats, reports of
+    // retired or removed chunkservers are pruned by background thread
+    std::unordered_map<ChunkServerIdType, std::shared_ptr<ChunkServerReport>>
+        reports_;
+    RWLock reportsLock_;
+
+    // workers handling heartbeats, heartbeat of chunkserver is handled by
+    // workers_[chunkserverId % workerNum_]
+    uint32_t workerNum_;
+    uint32_t workerQueueCapacity_;
+    std::vector<std::unique_ptr<HeartbeatWorker>> workers_;
+    bool workersRunning_;
+    RWLock workersLock_;
+
     // Manage chunkserverHealthyChecker threads
     Thread backEndThread_;
 
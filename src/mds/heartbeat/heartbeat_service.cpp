@@ -20,6 +20,8 @@
  * Author: lixiaocui
  */
 
+#include <brpc/controller.h>
+#include <errno.h>
 #include <memory>
 #include "src/mds/heartbeat/heartbeat_service.h"
 
@@ -37,7 +39,14 @@ void HeartbeatServiceImpl::ChunkServerHeartbeat(
     ::curve::mds::heartbeat::ChunkServerHeartbeatResponse *response,
     ::google::protobuf::Closure *done) {
     brpc::ClosureGuard doneGuard(done);
-    heartbeatManager_->ChunkServerHeartbeat(*request, response);
+    if (heartbeatManager_->AsyncChunkServerHeartbeat(
+            request, response, done)) {
+        doneGuard.release();
+        return;
+    }
+
+    brpc::Controller *cntl = static_cast<brpc::Controller *>(controller);
+    cntl->SetFailed(EBUSY, "heartbeat queue of mds is full");
 }
 }  // namespace heartbeat
 }  // namespace mds
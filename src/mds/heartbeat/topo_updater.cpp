@@ -27,6 +27,46 @@ namespace curve {
 namespace mds {
 namespace heartbeat {
 void TopoUpdater::UpdateTopo(const CopySetInfo &reportCopySetInfo) {
+    if (!NeedUpdate(reportCopySetInfo)) {
+        return;
+    }
+
+    // update changes to database and RAM
+    int updateCode = topo_->UpdateCopySetTopo(reportCopySetInfo);
+    if (::curve::mds::topology::kTopoErrCodeSuccess != updateCode) {
+        LOG(ERROR) << "topoUpdater update copyset("
+                   << reportCopySetInfo.GetLogicalPoolId()
+                   << "," << reportCopySetInfo.GetId()
+                   << ") got error code: " << updateCode;
+    }
+}
+
+void TopoUpdater::UpdateTopo(
+    const std::vector<CopySetInfo> &reportCopySetInfos) {
+    std::vector<CopySetInfo> toUpdate;
+    for (const auto &reportCopySetInfo : reportCopySetInfos) {
+        if (NeedUpdate(reportCopySetInfo)) {
+            toUpdate.emplace_back(reportCopySetInfo);
+        }
+    }
+    if (toUpdate.empty()) {
+        return;
+    }
+
+    // update changes to database and RAM in one batch
+    std::vector<int> errCodes;
+    topo_->UpdateCopySetsTopo(toUpdate, &errCodes);
+    for (size_t i = 0; i < toUpdate.size() && i < errCodes.size(); ++i) {
+        if (::curve::mds::topology::kTopoErrCodeSuccess != errCodes[i]) {
+            LOG(ERROR) << "topoUpdater update copyset("
+                       << toUpdate[i].GetLogicalPoolId()
+                       << "," << toUpdate[i].GetId()
+                       << ") got error code: " << errCodes[i];
+        }
+    }
+}
+
+bool TopoUpdater::NeedUpdate(const CopySetInfo &reportCopySetInfo) {
     CopySetInfo recordCopySetInfo;
 
     if (!topo_->GetCopySet(
@@ -36,7 +76,7 @@ void TopoUpdater::UpdateTopo(const CopySetInfo &reportCopySetInfo) {
             << reportCopySetInfo.GetLogicalPoolId()
             << "," << reportCopySetInfo.GetId()
             << ") information, but can not get info from topology";
-        return;
+        return false;
     }
     // here we compare epoch number reported by heartbeat and stored in mds
     // record, and there're three possible cases:
@@ -94,7 +134,7 @@ void TopoUpdater::UpdateTopo(const CopySetInfo &reportCopySetInfo) {
                 << recordCopySetInfo.GetCopySetMembersStr()
                 << ", but epoch is same: "
                 << recordCopySetInfo.GetEpoch();
-            return;
+            return false;
         }
 
         // no configuration changes in heartbeat report (no candidate)
@@ -161,25 +201,15 @@ void TopoUpdater::UpdateTopo(const CopySetInfo &reportCopySetInfo) {
         }
 
 
-        return;
+        return false;
     }
 
-    // update changes to database and RAM
     if (needUpdate) {
         LOG(INFO) << "topoUpdater find copyset("
                   << reportCopySetInfo.GetLogicalPoolId() << ","
                   << reportCopySetInfo.GetId() << ") need to update";
-
-        int updateCode =
-            topo_->UpdateCopySetTopo(reportCopySetInfo);
-        if (::curve::mds::topology::kTopoErrCodeSuccess != updateCode) {
-            LOG(ERROR) << "topoUpdater update copyset("
-                       << reportCopySetInfo.GetLogicalPoolId()
-                       << "," << reportCopySetInfo.GetId()
-                       << ") got error code: " << updateCode;
-            return;
-        }
     }
+    return needUpdate;
 }
 }  // namespace heartbeat
 }  // namespace mds
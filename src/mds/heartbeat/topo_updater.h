@@ -24,6 +24,7 @@
 #define SRC_MDS_HEARTBEAT_TOPO_UPDATER_H_
 
 #include <memory>
+#include <vector>
 #include "src/mds/topology/topology_item.h"
 #include "src/mds/topology/topology.h"
 
@@ -46,7 +47,21 @@ class TopoUpdater {
     */
     void UpdateTopo(const CopySetInfo &reportCopySetInfo);
 
+   /*
+    * @brief UpdateTopo update a batch of copysets reported by one
+    *                   chunkserver, copysets need to update are applied
+    *                   to topology in one batch
+    * @param[in] reportCopySetInfos copysets info reported by chunkserver
+    */
+    void UpdateTopo(const std::vector<CopySetInfo> &reportCopySetInfos);
+
  private:
+   /*
+    * @brief NeedUpdate compare reported copyset with topology record
+    * @return true if topology record need to update
+    */
+    bool NeedUpdate(const CopySetInfo &reportCopySetInfo);
+
     std::shared_ptr<Topology> topo_;
 };
 }  // namespace heartbeat
@@ -128,7 +128,7 @@ void AllocStatistic::CalculateSegmentAlloc() {
     int res;
     do {
         res =  AllocStatisticHelper::CalculateSegmentAlloc(
-            curRevision_, client_, &segmentAlloc_);
+            curRevision_, client_, calculateConcurrency_, &segmentAlloc_);
     } while (HandleResult(res));
 
     LOG(INFO) << "calculate segment alloc revision not bigger than "
@@ -74,15 +74,19 @@ class AllocStatistic {
      * @param[in] retryInterMs Retry time interval after the failure of getting
      *                         segment of the specified revision from Etcd
      * @param[in] client Etcd client
+     * @param[in] calculateConcurrency Number of key ranges of segments
+     *                                 scanned concurrently from Etcd
      */
     AllocStatistic(uint64_t periodicPersistInterMs, uint64_t retryInterMs,
-        std::shared_ptr<EtcdClientImp> client) :
+        std::shared_ptr<EtcdClientImp> client,
+        uint32_t calculateConcurrency = 1) :
         client_(client),
         currentValueAvalible_(false),
         segmentAllocFromEtcdOK_(false),
         stop_(true),
         periodicPersistInterMs_(periodicPersistInterMs),
-        retryInterMs_(retryInterMs) {}
+        retryInterMs_(retryInterMs),
+        calculateConcurrency_(calculateConcurrency) {}
 
     ~AllocStatistic() {
         Stop();
@@ -224,6 +228,10 @@ class AllocStatistic {
     // Persistence interval in ms
     uint64_t periodicPersistInterMs_;
 
+    // Number of key ranges scanned concurrently when calculating
+    // allocated segment size from Etcd
+    uint32_t calculateConcurrency_;
+
     // When stop_ is true, stop the persistent thread and the statistical
     // thread that counts the segment allocation in Etcd
     Atomic<bool> stop_;
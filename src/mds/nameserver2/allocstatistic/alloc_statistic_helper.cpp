@@ -20,6 +20,11 @@
  * Author: lixiaocui
  */
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+
+#include <algorithm>
+#include <atomic>
 #include <vector>
 #include <string>
 #include "src/mds/nameserver2/allocstatistic/alloc_statistic_helper.h"
@@ -27,6 +32,7 @@
 #include "proto/nameserver2.pb.h"
 #include "src/common/timeutility.h"
 #include "src/common/namespace_define.h"
+#include "src/common/concurrent/concurrent.h"
 
 namespace curve {
 namespace mds {
@@ -35,7 +41,13 @@ using ::curve::common::SEGMENTALLOCSIZEKEYEND;
 using ::curve::common::SEGMENTALLOCSIZEKEY;
 using ::curve::common::SEGMENTINFOKEYPREFIX;
 using ::curve::common::SEGMENTINFOKEYEND;
+using ::curve::common::INODESTOREKEY;
+using ::curve::common::Thread;
+using ::google::protobuf::io::CodedInputStream;
+using ::google::protobuf::internal::WireFormatLite;
 const int GETBUNDLE = 1000;
+// number of key ranges for each worker when scan concurrently
+const uint32_t RANGESPERWORKER = 4;
 int AllocStatisticHelper::GetExistSegmentAllocValues(
     std::map<PoolIdType, int64_t> *out,
     const std::shared_ptr<EtcdClientImp> &client) {
@@ -68,11 +80,116 @@ int AllocStatisticHelper::GetExistSegmentAllocValues(
 int AllocStatisticHelper::CalculateSegmentAlloc(
     int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
     std::map<PoolIdType, int64_t> *out) {
+    return CalculateSegmentAlloc(revision, client, 1, out);
+}
+
+int AllocStatisticHelper::CalculateSegmentAlloc(
+    int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
+    uint32_t concurrency, std::map<PoolIdType, int64_t> *out) {
     LOG(INFO) << "start calculate segment alloc, revision: " << revision
-              << ", bundle size: " << GETBUNDLE;
+              << ", bundle size: " << GETBUNDLE
+              << ", concurrency: " << concurrency;
     uint64_t startTime = ::curve::common::TimeUtility::GetTimeofDayMs();
 
-    std::string startKey = SEGMENTINFOKEYPREFIX;
+    std::vector<std::pair<std::string, std::string>> ranges;
+    if (concurrency <= 1) {
+        ranges.emplace_back(SEGMENTINFOKEYPREFIX, SEGMENTINFOKEYEND);
+    } else if (SplitSegmentKeyRange(
+        client, concurrency * RANGESPERWORKER, &ranges) != 0) {
+        return -1;
+    }
+
+    std::vector<std::map<PoolIdType, int64_t>> rangeAlloc(ranges.size());
+    std::vector<int> rangeRes(ranges.size(), 0);
+    uint32_t workerNum = std::min<uint32_t>(
+        std::max<uint32_t>(concurrency, 1), ranges.size());
+    // workers take ranges in order, segments of different files are not
+    // evenly distributed on inode id, so there are more ranges than workers
+    std::atomic<uint32_t> next(0);
+    std::atomic<bool> failed(false);
+    auto worker = [&]() {
+        while (!failed.load(std::memory_order_relaxed)) {
+            uint32_t index = next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= ranges.size()) {
+                break;
+            }
+            rangeRes[index] = CalculateSegmentAllocInRange(
+                revision, client, ranges[index].first, ranges[index].second,
+                &rangeAlloc[index]);
+            if (rangeRes[index] != 0) {
+                failed.store(true);
+            }
+        }
+    };
+
+    std::vector<Thread> workers;
+    for (uint32_t i = 1; i < workerNum; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto &t : workers) {
+        t.join();
+    }
+
+    if (failed.load()) {
+        return -1;
+    }
+    for (const auto &alloc : rangeAlloc) {
+        for (const auto &item : alloc) {
+            (*out)[item.first] += item.second;
+        }
+    }
+
+    LOG(INFO) << "calculate segment alloc ok, range num: " << ranges.size()
+              << ", time spend: "
+              << (::curve::common::TimeUtility::GetTimeofDayMs() - startTime)
+              << " ms";
+    return 0;
+}
+
+bool AllocStatisticHelper::DecodeSegmentAlloc(
+    const std::string &value, PoolIdType *lid, uint64_t *segmentSize) {
+    // fields are serialized in field number order, so logicalPoolID and
+    // segmentSize come before the chunk list, which is not parsed
+    CodedInputStream input(
+        reinterpret_cast<const uint8_t *>(value.data()), value.size());
+    bool hasLid = false;
+    bool hasSegmentSize = false;
+    uint32_t tag;
+    while ((tag = input.ReadTag()) != 0) {
+        uint32_t field = WireFormatLite::GetTagFieldNumber(tag);
+        bool isVarint = WireFormatLite::GetTagWireType(tag) ==
+                        WireFormatLite::WIRETYPE_VARINT;
+        uint32_t fieldValue;
+        if (field == PageFileSegment::kLogicalPoolIDFieldNumber && isVarint) {
+            if (!input.ReadVarint32(&fieldValue)) {
+                return false;
+            }
+            *lid = fieldValue;
+            hasLid = true;
+        } else if (field == PageFileSegment::kSegmentSizeFieldNumber &&
+                   isVarint) {
+            if (!input.ReadVarint32(&fieldValue)) {
+                return false;
+            }
+            *segmentSize = fieldValue;
+            hasSegmentSize = true;
+        } else if (!WireFormatLite::SkipField(&input, tag)) {
+            return false;
+        }
+
+        if (hasLid && hasSegmentSize) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int AllocStatisticHelper::CalculateSegmentAllocInRange(
+    int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
+    const std::string &startKey, const std::string &endKey,
+    std::map<PoolIdType, int64_t> *out) {
+    std::string listKey = startKey;
     std::vector<std::string> values;
     std::string lastKey;
     do {
@@ -83,40 +200,70 @@ int AllocStatisticHelper::CalculateSegmentAlloc(
         // get segments in bundles from Etcd, GETBUNDLE is the number of items
         // to fetch
         int res = client->ListWithLimitAndRevision(
-           startKey, SEGMENTINFOKEYEND, GETBUNDLE, revision, &values, &lastKey);
+           listKey, endKey, GETBUNDLE, revision, &values, &lastKey);
         if (res != EtcdErrCode::EtcdOK) {
-            LOG(ERROR) << "list [" << startKey << "," << SEGMENTINFOKEYEND
+            LOG(ERROR) << "list [" << listKey << "," << endKey
                        << ") at revision: " << revision
                        << " with bundle: " << GETBUNDLE
                        << " fail, errCode: " << res;
             return -1;
         }
 
-        // decode the obtained value
+        // decode the obtained value, the first one is the last one of
+        // previous bundle except for the first bundle
         int startPos = 1;
-        if (startKey == SEGMENTINFOKEYPREFIX) {
+        if (listKey == startKey) {
             startPos = 0;
         }
         for ( ; startPos < values.size(); startPos++) {
-            PageFileSegment segment;
-            bool res = NameSpaceStorageCodec::DecodeSegment(
-                values[startPos], &segment);
+            PoolIdType lid;
+            uint64_t segmentSize;
+            bool res = DecodeSegmentAlloc(values[startPos], &lid, &segmentSize);
             if (false == res) {
                 LOG(ERROR) << "decode segment item{"
                           << values[startPos] << "} fail";
                 return -1;
             } else {
-                (*out)[segment.logicalpoolid()] += segment.segmentsize();
+                (*out)[lid] += segmentSize;
             }
         }
 
-        startKey = lastKey;
+        listKey = lastKey;
     } while (values.size() >= GETBUNDLE);
 
-    LOG(INFO) << "calculate segment alloc ok, time spend: "
-              << (::curve::common::TimeUtility::GetTimeofDayMs() - startTime)
-              << " ms";
     return 0;
 }
+
+int AllocStatisticHelper::SplitSegmentKeyRange(
+    const std::shared_ptr<EtcdClientImp> &client, uint32_t rangeNum,
+    std::vector<std::pair<std::string, std::string>> *ranges) {
+    // segment keys are ordered by inode id, and inode ids are never bigger
+    // than the allocated value of inode id generator
+    std::string out;
+    uint64_t maxInodeId = 0;
+    int res = client->Get(INODESTOREKEY, &out);
+    if (res == EtcdErrCode::EtcdKeyNotExist) {
+        maxInodeId = 0;
+    } else if (res != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "get inode id store key fail, errCode: " << res;
+        return -1;
+    } else if (!NameSpaceStorageCodec::DecodeID(out, &maxInodeId)) {
+        LOG(ERROR) << "decode inode id: " << out << " fail";
+        return -1;
+    }
+
+    rangeNum = std::max<uint64_t>(std::min<uint64_t>(rangeNum, maxInodeId), 1);
+    uint64_t step = maxInodeId / rangeNum + 1;
+    std::string startKey = SEGMENTINFOKEYPREFIX;
+    for (uint32_t i = 1; i < rangeNum; i++) {
+        std::string endKey =
+            NameSpaceStorageCodec::EncodeSegmentStoreKey(i * step, 0);
+        ranges->emplace_back(startKey, endKey);
+        startKey = endKey;
+    }
+    ranges->emplace_back(startKey, SEGMENTINFOKEYEND);
+    return 0;
+}
+
 }  // namespace mds
 }  // namespace curve
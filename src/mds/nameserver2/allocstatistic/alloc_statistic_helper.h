@@ -25,6 +25,9 @@
 
 #include <map>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 #include "src/mds/common/mds_define.h"
 #include "src/kvstorageclient/etcd_client.h"
 
@@ -45,6 +48,44 @@ class AllocStatisticHelper {
     static int CalculateSegmentAlloc(
         int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
         std::map<PoolIdType, int64_t> *out);
+
+    /**
+     * @brief CalculateSegmentAlloc split the segment keyspace into
+     *        concurrency ranges by inode id, and scan them concurrently at
+     *        the same revision
+     *
+     * @param[in] revision
+     * @param[in] client
+     * @param[in] concurrency number of key ranges scanned concurrently,
+     *                        1 means scan the keyspace from one thread
+     * @param[out] out allocated size of each logical pool
+     *
+     * @return 0 if succeeded, -1 if failed
+     */
+    static int CalculateSegmentAlloc(
+        int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
+        uint32_t concurrency, std::map<PoolIdType, int64_t> *out);
+
+    /**
+     * @brief DecodeSegmentAlloc get logical pool id and segment size from
+     *        encoded PageFileSegment, without parsing the chunk list
+     *
+     * @return true if both fields are found, false otherwise
+     */
+    static bool DecodeSegmentAlloc(
+        const std::string &value, PoolIdType *lid, uint64_t *segmentSize);
+
+ private:
+    // scan segments in key range [startKey, endKey) at revision
+    static int CalculateSegmentAllocInRange(
+        int64_t revision, const std::shared_ptr<EtcdClientImp> &client,
+        const std::string &startKey, const std::string &endKey,
+        std::map<PoolIdType, int64_t> *out);
+
+    // split segment keyspace into at most rangeNum ranges by inode id
+    static int SplitSegmentKeyRange(
+        const std::shared_ptr<EtcdClientImp> &client, uint32_t rangeNum,
+        std::vector<std::pair<std::string, std::string>> *ranges);
 };
 }  // namespace mds
 }  // namespace curve
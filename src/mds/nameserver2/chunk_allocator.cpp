@@ -75,15 +75,16 @@ bool ChunkSegmentAllocatorImpl::AllocateChunkSegment(FileType type,
 
         segment->set_logicalpoolid(logicalpoolId);
 
+        // generate chunk ids of the whole segment at once
+        std::vector<ChunkID> chunkIDs;
+        if (!chunkIDGenerator_->GenChunkIDs(chunkNum, &chunkIDs)) {
+            LOG(ERROR) << "allocate error";
+            return false;
+        }
+
         for (uint32_t i = 0; i < chunkNum ; i++) {
             PageFileChunkInfo* chunkinfo =  segment->add_chunks();
-
-            ChunkID chunkID;
-            if (!chunkIDGenerator_->GenChunkID(&chunkID)) {
-                LOG(ERROR) << "allocate error";
-                return false;
-            }
-            chunkinfo->set_chunkid(chunkID);
+            chunkinfo->set_chunkid(chunkIDs[i]);
             chunkinfo->set_copysetid(copysets[i].copySetId);
         }
         return true;
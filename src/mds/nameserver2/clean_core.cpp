@@ -22,6 +22,14 @@
 
 #include "src/mds/nameserver2/clean_core.h"
 
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "src/common/concurrent/count_down_event.h"
+
 namespace curve {
 namespace mds {
 StatusCode CleanCore::CleanSnapShotFile(const FileInfo & fileInfo,
@@ -104,23 +112,40 @@ StatusCode CleanCore::CleanFile(const FileInfo & commonFile,
 
     int  segmentNum = commonFile.length() / commonFile.segmentsize();
     uint64_t segmentSize = commonFile.segmentsize();
-    for (int i = 0; i != segmentNum; i++) {
-        // load  segment
-        PageFileSegment segment;
-        StoreStatus storeRet = storage_->GetSegment(commonFile.id(),
-                                    i * segmentSize, &segment);
-        if (storeRet == StoreStatus::KeyNotExist) {
+    int segmentsPerRound = std::max<uint32_t>(option_.segmentsPerRound, 1);
+    std::vector<PageFileSegment> segments;
+    std::vector<uint64_t> offsets;
+    segments.reserve(segmentsPerRound);
+    offsets.reserve(segmentsPerRound);
+    for (int start = 0; start < segmentNum; start += segmentsPerRound) {
+        int end = std::min(start + segmentsPerRound, segmentNum);
+
+        // load segments of this round
+        segments.clear();
+        offsets.clear();
+        for (int i = start; i != end; i++) {
+            PageFileSegment segment;
+            StoreStatus storeRet = storage_->GetSegment(commonFile.id(),
+                                        i * segmentSize, &segment);
+            if (storeRet == StoreStatus::KeyNotExist) {
+                continue;
+            } else if (storeRet !=  StoreStatus::OK) {
+                LOG(ERROR) << "Clean common File Error: "
+                    << "GetSegment Error, inodeid = " << commonFile.id()
+                    << ", filename = " << commonFile.filename()
+                    << ", offset = " << i * segmentSize;
+                progress->SetStatus(TaskStatus::FAILED);
+                return StatusCode::kCommonFileDeleteError;
+            }
+            segments.emplace_back(std::move(segment));
+            offsets.push_back(i * segmentSize);
+        }
+
+        if (segments.empty()) {
             continue;
-        } else if (storeRet !=  StoreStatus::OK) {
-            LOG(ERROR) << "Clean common File Error: "
-                << "GetSegment Error, inodeid = " << commonFile.id()
-                << ", filename = " << commonFile.filename()
-                << ", offset = " << i * segmentSize;
-            progress->SetStatus(TaskStatus::FAILED);
-            return StatusCode::kCommonFileDeleteError;
         }
 
-        int ret = DeleteChunksInSegment(segment, commonFile.seqnum());
+        int ret = DeleteChunksInSegments(segments, commonFile.seqnum());
         if (ret != 0) {
             LOG(ERROR) << "Clean common File Error: "
                        << ", ret = " << ret
@@ -131,22 +156,24 @@ StatusCode CleanCore::CleanFile(const FileInfo & commonFile,
             return StatusCode::kCommonFileDeleteError;
         }
 
-        // delete segment
-        int64_t revision;
-        storeRet = storage_->DeleteSegment(
-            commonFile.id(), i * segmentSize, &revision);
-        if (storeRet != StoreStatus::OK) {
-            LOG(ERROR) << "Clean common File Error: "
-            << "DeleteSegment Error, inodeid = " << commonFile.id()
-            << ", filename = " << commonFile.filename()
-            << ", offset = " << i * segmentSize
-            << ", sequenceNum = " << commonFile.seqnum();
-            progress->SetStatus(TaskStatus::FAILED);
-            return StatusCode::kCommonFileDeleteError;
+        // delete segments after all chunks in them are deleted
+        for (size_t i = 0; i != segments.size(); i++) {
+            int64_t revision;
+            StoreStatus storeRet = storage_->DeleteSegment(
+                commonFile.id(), offsets[i], &revision);
+            if (storeRet != StoreStatus::OK) {
+                LOG(ERROR) << "Clean common File Error: "
+                << "DeleteSegment Error, inodeid = " << commonFile.id()
+                << ", filename = " << commonFile.filename()
+                << ", offset = " << offsets[i]
+                << ", sequenceNum = " << commonFile.seqnum();
+                progress->SetStatus(TaskStatus::FAILED);
+                return StatusCode::kCommonFileDeleteError;
+            }
+            allocStatistic_->DeAllocSpace(segments[i].logicalpoolid(),
+                segments[i].segmentsize(), revision);
         }
-        allocStatistic_->DeAllocSpace(segment.logicalpoolid(),
-            segment.segmentsize(), revision);
-        progress->SetProgress(100 * (i + 1) / segmentNum);
+        progress->SetProgress(100 * end / segmentNum);
     }
 
     // delete the storage
@@ -221,25 +248,132 @@ StatusCode CleanCore::CleanDiscardSegment(
 
 int CleanCore::DeleteChunksInSegment(const PageFileSegment& segment,
                                      const SeqNum& seq) {
-    const LogicalPoolID logicalPoolId = segment.logicalpoolid();
-    for (int i = 0; i < segment.chunks_size(); ++i) {
-        int ret = copysetClient_->DeleteChunk(
-            logicalPoolId,
-            segment.chunks()[i].copysetid(),
-            segment.chunks()[i].chunkid(),
-            seq);
+    return DeleteChunksInSegments(
+        std::vector<PageFileSegment>{segment}, seq);
+}
 
-        if (ret != 0) {
-            LOG(ERROR) << "DeleteChunk failed, ret = " << ret
-                       << ", logicalpoolid = " << logicalPoolId
-                       << ", copysetid = " << segment.chunks()[i].copysetid()
-                       << ", chunkid = " << segment.chunks()[i].chunkid()
-                       << ", seq = " << seq;
-            return ret;
+int CleanCore::DeleteChunksInSegments(
+    const std::vector<PageFileSegment>& segments, const SeqNum& seq) {
+    std::vector<DeleteChunkTask> tasks;
+    BuildDeleteChunkTasks(segments, &tasks);
+
+    uint32_t concurrency = std::min<uint32_t>(
+        std::max<uint32_t>(option_.deleteChunkConcurrency, 1), tasks.size());
+    if (concurrency <= 1) {
+        for (const auto &task : tasks) {
+            int ret = DoDeleteChunkTask(task, seq);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+        return 0;
+    }
+
+    // workers take tasks in order, stop taking new tasks once one failed
+    std::atomic<uint32_t> next(0);
+    std::atomic<int> firstError(0);
+    auto worker = [&]() {
+        while (firstError.load(std::memory_order_relaxed) == 0) {
+            uint32_t index = next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= tasks.size()) {
+                break;
+            }
+            int ret = DoDeleteChunkTask(tasks[index], seq);
+            if (ret != 0) {
+                int expected = 0;
+                firstError.compare_exchange_strong(expected, ret);
+            }
+        }
+    };
+
+    // the pool may be busy with other files, the calling thread works too,
+    // so the round always makes progress
+    ::curve::common::CountDownEvent workersDone(concurrency - 1);
+    for (uint32_t i = 1; i < concurrency; ++i) {
+        deleteChunkWorkers_.Enqueue([&]() {
+            worker();
+            workersDone.Signal();
+        });
+    }
+    worker();
+    workersDone.Wait();
+
+    return firstError.load();
+}
+
+void CleanCore::BuildDeleteChunkTasks(
+    const std::vector<PageFileSegment>& segments,
+    std::vector<DeleteChunkTask>* tasks) {
+    if (!option_.batchDeleteChunk) {
+        for (const auto &segment : segments) {
+            const LogicalPoolID logicalPoolId = segment.logicalpoolid();
+            for (int i = 0; i < segment.chunks_size(); ++i) {
+                tasks->emplace_back(DeleteChunkTask{
+                    logicalPoolId,
+                    segment.chunks(i).copysetid(),
+                    {segment.chunks(i).chunkid()}});
+            }
         }
+        return;
     }
 
-    return 0;
+    // group chunks by copyset, each batch has at most maxChunksPerBatch
+    uint32_t maxChunksPerBatch = std::max<uint32_t>(
+        option_.maxChunksPerBatch, 1);
+    std::map<std::pair<LogicalPoolID, CopysetID>, size_t> openBatch;
+    for (const auto &segment : segments) {
+        LogicalPoolID logicalPoolId = segment.logicalpoolid();
+        for (int i = 0; i < segment.chunks_size(); ++i) {
+            CopysetID copysetId = segment.chunks(i).copysetid();
+            auto key = std::make_pair(logicalPoolId, copysetId);
+            auto iter = openBatch.find(key);
+            if (iter == openBatch.end() ||
+                (*tasks)[iter->second].chunkIds.size() >= maxChunksPerBatch) {
+                tasks->emplace_back(DeleteChunkTask{
+                    logicalPoolId, copysetId, {}});
+                openBatch[key] = tasks->size() - 1;
+                iter = openBatch.find(key);
+            }
+            (*tasks)[iter->second].chunkIds.push_back(
+                segment.chunks(i).chunkid());
+        }
+    }
+}
+
+int CleanCore::DoDeleteChunkTask(const DeleteChunkTask& task,
+                                 const SeqNum& seq) {
+    int ret = kCsClientNotSupported;
+    if (option_.batchDeleteChunk) {
+        ret = copysetClient_->DeleteChunks(
+            task.logicalPoolId, task.copysetId, task.chunkIds, seq);
+        if (ret == kCsClientNotSupported) {
+            LOG(WARNING) << "DeleteChunks not supported by chunkserver, "
+                         << "delete chunks one by one, logicalpoolid = "
+                         << task.logicalPoolId
+                         << ", copysetid = " << task.copysetId;
+        }
+    }
+    // chunkserver may not be upgraded during rolling upgrade
+    if (ret == kCsClientNotSupported) {
+        ret = 0;
+        for (auto chunkId : task.chunkIds) {
+            ret = copysetClient_->DeleteChunk(
+                task.logicalPoolId, task.copysetId, chunkId, seq);
+            if (ret != 0) {
+                break;
+            }
+        }
+    }
+
+    if (ret != 0) {
+        LOG(ERROR) << "DeleteChunk failed, ret = " << ret
+                   << ", logicalpoolid = " << task.logicalPoolId
+                   << ", copysetid = " << task.copysetId
+                   << ", first chunkid = " << task.chunkIds[0]
+                   << ", chunk num = " << task.chunkIds.size()
+                   << ", seq = " << seq;
+    }
+    return ret;
 }
 
 }  // namespace mds
@@ -25,12 +25,14 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "src/mds/nameserver2/namespace_storage.h"
 #include "src/mds/common/mds_define.h"
 #include "src/mds/nameserver2/task_progress.h"
 #include "src/mds/chunkserverclient/copyset_client.h"
 #include "src/mds/topology/topology.h"
 #include "src/mds/nameserver2/allocstatistic/alloc_statistic.h"
+#include "src/common/concurrent/task_thread_pool.h"
 
 using ::curve::mds::chunkserverclient::CopysetClient;
 using ::curve::mds::topology::Topology;
@@ -38,14 +40,42 @@ using ::curve::mds::topology::Topology;
 namespace curve {
 namespace mds {
 
+struct CleanCoreOption {
+    // 是否使用批量删除chunk的rpc, 需要所有chunkserver先升级到支持DeleteChunks
+    bool batchDeleteChunk = false;
+    // 批量删除时一次rpc最多删除的chunk数量
+    uint32_t maxChunksPerBatch = 64;
+    // 并发删除chunk的rpc数量
+    uint32_t deleteChunkConcurrency = 1;
+    // CleanFile时每轮处理的segment数量, 同一轮segment的chunk一起删除
+    uint32_t segmentsPerRound = 1;
+};
+
 class CleanCore {
  public:
     CleanCore(std::shared_ptr<NameServerStorage> storage,
         std::shared_ptr<CopysetClient> copysetClient,
         std::shared_ptr<AllocStatistic> allocStatistic)
+        : CleanCore(storage, copysetClient, allocStatistic,
+                    CleanCoreOption()) {}
+
+    CleanCore(std::shared_ptr<NameServerStorage> storage,
+        std::shared_ptr<CopysetClient> copysetClient,
+        std::shared_ptr<AllocStatistic> allocStatistic,
+        const CleanCoreOption &option)
         : storage_(storage),
           copysetClient_(copysetClient),
-          allocStatistic_(allocStatistic) {}
+          allocStatistic_(allocStatistic),
+          option_(option) {
+        // 发起删除的线程自己也会执行删除任务
+        if (option_.deleteChunkConcurrency > 1) {
+            deleteChunkWorkers_.Start(option_.deleteChunkConcurrency - 1);
+        }
+    }
+
+    ~CleanCore() {
+        deleteChunkWorkers_.Stop();
+    }
 
     /**
      * @brief 删除快照文件，更新task状态
@@ -74,12 +104,36 @@ class CleanCore {
                                    TaskProgress* progress);
 
  private:
+    // 一次删除rpc的参数, 同一个copyset上的一个或多个chunk
+    struct DeleteChunkTask {
+        LogicalPoolID logicalPoolId;
+        CopysetID copysetId;
+        std::vector<ChunkID> chunkIds;
+    };
+
     int DeleteChunksInSegment(const PageFileSegment& segment,
                               const SeqNum& seq);
 
+    /**
+     * @brief 删除多个segment中的chunk
+     *        开启batchDeleteChunk时按copyset分组批量删除,
+     *        最多deleteChunkConcurrency个rpc并发执行
+     * @return 成功返回0, 否则返回第一个失败的错误码
+     */
+    int DeleteChunksInSegments(const std::vector<PageFileSegment>& segments,
+                               const SeqNum& seq);
+
+    void BuildDeleteChunkTasks(const std::vector<PageFileSegment>& segments,
+                               std::vector<DeleteChunkTask>* tasks);
+
+    int DoDeleteChunkTask(const DeleteChunkTask& task, const SeqNum& seq);
+
     std::shared_ptr<NameServerStorage> storage_;
     std::shared_ptr<CopysetClient> copysetClient_;
     std::shared_ptr<AllocStatistic> allocStatistic_;
+    CleanCoreOption option_;
+    // 并发删除chunk的线程池, 所有删除任务共用
+    ::curve::common::TaskThreadPool<> deleteChunkWorkers_;
 };
 
 }  // namespace mds
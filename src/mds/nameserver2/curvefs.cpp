@@ -103,6 +103,17 @@ bool CurveFS::InitRecycleBinDir() {
     }
 }
 
+std::unique_ptr<CurveFS> CurveFS::CreateReadOnly(
+    std::shared_ptr<NameServerStorage> storage,
+    const RootAuthOption &authOptions) {
+    std::unique_ptr<CurveFS> curvefs(new CurveFS());
+    curvefs->startTime_ = std::chrono::steady_clock::now();
+    curvefs->storage_ = storage;
+    curvefs->rootAuthOptions_ = authOptions;
+    curvefs->InitRootFile();
+    return curvefs;
+}
+
 bool CurveFS::Init(std::shared_ptr<NameServerStorage> storage,
                 std::shared_ptr<InodeIDGenerator> InodeIDGenerator,
                 std::shared_ptr<ChunkSegmentAllocator> chunkSegAllocator,
@@ -177,12 +188,15 @@ StatusCode CurveFS::WalkPath(const std::string &fileName,
     *lastEntry = paths.back();
     uint64_t parentID = rootFileInfo_.id();
 
+    // directories on the path are shared with the storage cache,
+    // only the parent of the last entry is copied out
+    std::shared_ptr<const FileInfo> dirInfo;
     for (uint32_t i = 0; i < paths.size() - 1; i++) {
-        auto ret = storage_->GetFile(parentID, paths[i], fileInfo);
+        auto ret = storage_->GetFile(parentID, paths[i], &dirInfo);
 
         if (ret ==  StoreStatus::OK) {
-            if (fileInfo->filetype() !=  FileType::INODE_DIRECTORY) {
-                LOG(INFO) << fileInfo->filename() << " is not an directory";
+            if (dirInfo->filetype() !=  FileType::INODE_DIRECTORY) {
+                LOG(INFO) << dirInfo->filename() << " is not an directory";
                 return StatusCode::kNotDirectory;
             }
         } else if (ret == StoreStatus::KeyNotExist) {
@@ -191,8 +205,11 @@ StatusCode CurveFS::WalkPath(const std::string &fileName,
             LOG(ERROR) << "GetFile error, errcode = " << ret;
             return StatusCode::kStorageError;
         }
-        // assert(fileInfo->parentid() != parentID);
-        parentID =  fileInfo->id();
+        // assert(dirInfo->parentid() != parentID);
+        parentID =  dirInfo->id();
+    }
+    if (dirInfo != nullptr) {
+        fileInfo->CopyFrom(*dirInfo);
     }
     return StatusCode::kOK;
 }
@@ -1193,6 +1210,151 @@ StatusCode CurveFS::GetOrAllocateSegment(const std::string & filename,
     }
 }
 
+StatusCode CurveFS::ListSegment(const std::string& filename,
+                                uint64_t offset, uint64_t length,
+                                uint32_t maxSegmentNum,
+                                std::vector<PageFileSegment>* segments,
+                                uint64_t* nextOffset) {
+    assert(segments != nullptr);
+    assert(nextOffset != nullptr);
+
+    FileInfo fileInfo;
+    auto ret = GetFileInfo(filename, &fileInfo);
+    if (ret != StatusCode::kOK) {
+        LOG(INFO) << "get source file error, errCode = " << ret;
+        return ret;
+    }
+
+    if (fileInfo.filetype() != FileType::INODE_PAGEFILE) {
+        LOG(INFO) << "not pageFile, can't do this";
+        return StatusCode::kParaError;
+    }
+
+    if (offset % fileInfo.segmentsize() != 0 || maxSegmentNum == 0) {
+        LOG(INFO) << "offset not align with segment";
+        return StatusCode::kParaError;
+    }
+
+    uint64_t endOffset = fileInfo.length();
+    if (length != 0 && offset + length < endOffset) {
+        endOffset = offset + length;
+    }
+    // segments are keyed by start offset, so limiting the range also
+    // limits the number of segments returned by storage
+    uint64_t maxLength =
+        static_cast<uint64_t>(maxSegmentNum) * fileInfo.segmentsize();
+    if (offset < endOffset && endOffset - offset > maxLength) {
+        endOffset = offset + maxLength;
+    }
+
+    *nextOffset = endOffset;
+    auto storeRet = storage_->ListSegmentInRange(fileInfo.id(), offset,
+                                                 endOffset, segments);
+    if (storeRet != StoreStatus::OK) {
+        LOG(ERROR) << "list segment fail, filename = " << filename
+                   << ", offset = " << offset << ", length = " << length;
+        return StatusCode::kStorageError;
+    }
+
+    return StatusCode::kOK;
+}
+
+StatusCode CurveFS::PreallocateSegment(const std::string& filename,
+                                       uint64_t offset, uint64_t length,
+                                       uint32_t maxSegmentNum,
+                                       uint64_t* nextOffset) {
+    assert(nextOffset != nullptr);
+
+    FileInfo fileInfo;
+    auto ret = GetFileInfo(filename, &fileInfo);
+    if (ret != StatusCode::kOK) {
+        LOG(INFO) << "get source file error, errCode = " << ret;
+        return ret;
+    }
+
+    if (fileInfo.filetype() != FileType::INODE_PAGEFILE) {
+        LOG(INFO) << "not pageFile, can't do this";
+        return StatusCode::kParaError;
+    }
+
+    if (offset % fileInfo.segmentsize() != 0 || maxSegmentNum == 0) {
+        LOG(INFO) << "offset not align with segment";
+        return StatusCode::kParaError;
+    }
+
+    // check the range before computing its end, offset + length may
+    // overflow for a malformed request
+    uint64_t fileLength = fileInfo.length();
+    if (offset > fileLength || length > fileLength - offset) {
+        LOG(INFO) << "preallocate range exceeds file length, filename = "
+                  << filename << ", offset = " << offset
+                  << ", length = " << length
+                  << ", file length = " << fileLength;
+        return StatusCode::kParaError;
+    }
+
+    uint64_t endOffset = length == 0 ? fileLength : offset + length;
+
+    *nextOffset = endOffset;
+    if (offset >= endOffset) {
+        return StatusCode::kOK;
+    }
+
+    std::vector<PageFileSegment> allocated;
+    auto storeRet = storage_->ListSegmentInRange(fileInfo.id(), offset,
+                                                 endOffset, &allocated);
+    if (storeRet != StoreStatus::OK) {
+        LOG(ERROR) << "list segment fail, filename = " << filename
+                   << ", offset = " << offset << ", length = " << length;
+        return StatusCode::kStorageError;
+    }
+
+    std::set<uint64_t> allocatedOffsets;
+    for (const auto& segment : allocated) {
+        allocatedOffsets.insert(segment.startoffset());
+    }
+
+    std::vector<PageFileSegment> segments;
+    uint64_t off = offset;
+    for (; off < endOffset && segments.size() < maxSegmentNum;
+         off += fileInfo.segmentsize()) {
+        if (allocatedOffsets.count(off) != 0) {
+            continue;
+        }
+
+        PageFileSegment segment;
+        if (!chunkSegAllocator_->AllocateChunkSegment(
+                fileInfo.filetype(), fileInfo.segmentsize(),
+                fileInfo.chunksize(), off, &segment)) {
+            LOG(ERROR) << "AllocateChunkSegment error, filename = "
+                       << filename << ", offset = " << off;
+            return StatusCode::kSegmentAllocateError;
+        }
+        segments.emplace_back(std::move(segment));
+    }
+
+    int64_t revision;
+    if (storage_->PutSegments(fileInfo.id(), segments, &revision)
+        != StoreStatus::OK) {
+        LOG(ERROR) << "PutSegments fail, fileInfo.id() = " << fileInfo.id()
+                   << ", offset = " << offset
+                   << ", segment num = " << segments.size();
+        return StatusCode::kStorageError;
+    }
+
+    for (const auto& segment : segments) {
+        allocStatistic_->AllocSpace(segment.logicalpoolid(),
+                                    segment.segmentsize(), revision);
+    }
+
+    *nextOffset = off;
+    LOG(INFO) << "preallocate segment success, fileInfo.id() = "
+              << fileInfo.id() << ", offset = " << offset
+              << ", next offset = " << off
+              << ", segment num = " << segments.size();
+    return StatusCode::kOK;
+}
+
 StatusCode CurveFS::DeAllocateSegment(const std::string& fileName,
                                       uint64_t offset) {
     FileInfo fileInfo;
@@ -1875,17 +2037,17 @@ StatusCode CurveFS::CheckPathOwnerInternal(const std::string &filename,
     uint64_t tempParentID = rootFileInfo_.id();
 
     for (uint32_t i = 0; i < paths.size() - 1; i++) {
-        FileInfo  fileInfo;
+        std::shared_ptr<const FileInfo> fileInfo;
         auto ret = storage_->GetFile(tempParentID, paths[i], &fileInfo);
 
         if (ret ==  StoreStatus::OK) {
-            if (fileInfo.filetype() !=  FileType::INODE_DIRECTORY) {
-                LOG(INFO) << fileInfo.filename() << " is not an directory";
+            if (fileInfo->filetype() !=  FileType::INODE_DIRECTORY) {
+                LOG(INFO) << fileInfo->filename() << " is not an directory";
                 return StatusCode::kNotDirectory;
             }
 
-            if (fileInfo.owner() != owner) {
-                LOG(ERROR) << fileInfo.filename() << " auth fail, owner = "
+            if (fileInfo->owner() != owner) {
+                LOG(ERROR) << fileInfo->filename() << " auth fail, owner = "
                            << owner;
                 return StatusCode::kOwnerAuthFail;
             }
@@ -1896,7 +2058,7 @@ StatusCode CurveFS::CheckPathOwnerInternal(const std::string &filename,
             LOG(ERROR) << "GetFile " << paths[i] << " error, errcode = " << ret;
             return StatusCode::kStorageError;
         }
-        tempParentID =  fileInfo.id();
+        tempParentID =  fileInfo->id();
     }
 
     *parentID = tempParentID;
@@ -1941,11 +2103,11 @@ StatusCode CurveFS::CheckDestinationOwner(const std::string &filename,
     }
 
     // if the file exists, verify the owner, if not, return kOK
-    FileInfo  fileInfo;
+    std::shared_ptr<const FileInfo> fileInfo;
     auto ret1 = storage_->GetFile(parentID, lastEntry, &fileInfo);
 
     if (ret1 == StoreStatus::OK) {
-        if (fileInfo.owner() != owner) {
+        if (fileInfo->owner() != owner) {
             return StatusCode::kOwnerAuthFail;
         }
         return StatusCode::kOK;
@@ -2055,11 +2217,11 @@ StatusCode CurveFS::CheckFileOwner(const std::string &filename,
         return ret;
     }
 
-    FileInfo  fileInfo;
+    std::shared_ptr<const FileInfo> fileInfo;
     auto ret1 = storage_->GetFile(parentID, lastEntry, &fileInfo);
 
     if (ret1 == StoreStatus::OK) {
-        if (fileInfo.owner() != owner) {
+        if (fileInfo->owner() != owner) {
             return StatusCode::kOwnerAuthFail;
         }
         return StatusCode::kOK;
@@ -2101,11 +2263,11 @@ StatusCode CurveFS::CheckRecycleFileOwner(const std::string &filename,
         return StatusCode::kOwnerAuthFail;
     }
 
-    FileInfo  fileInfo;
+    std::shared_ptr<const FileInfo> fileInfo;
     auto ret1 = storage_->GetFile(RECYCLEBININODEID, paths[1], &fileInfo);
 
     if (ret1 == StoreStatus::OK) {
-        if (fileInfo.owner() != owner) {
+        if (fileInfo->owner() != owner) {
             return StatusCode::kOwnerAuthFail;
         }
         return StatusCode::kOK;
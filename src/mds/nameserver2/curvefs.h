@@ -91,6 +91,19 @@ class CurveFS {
         return curvefs;
     }
 
+    /**
+     *  @brief create a read-only CurveFS, which is not the singleton.
+     *         Only read methods which do not allocate can be called,
+     *         such as CheckFileOwner, GetFileInfo, ReadDir and
+     *         GetOrAllocateSegment without allocating
+     *  @param storage: storage to read from
+     *         authOptions: root auth options
+     *  @return the read-only CurveFS
+     */
+    static std::unique_ptr<CurveFS> CreateReadOnly(
+        std::shared_ptr<NameServerStorage> storage,
+        const RootAuthOption &authOptions);
+
     /**
      *  @brief CurveFS initialization
      *  @param NameServerStorage:
@@ -281,6 +294,43 @@ class CurveFS {
      */
     StatusCode DeAllocateSegment(const std::string& filename, uint64_t offset);
 
+    /**
+     * @brief list allocated segments of a file in [offset, offset + length)
+     *        with one storage round trip, used by client to warm up its
+     *        metacache when opening a volume
+     * @param filename
+     * @param offset: start offset, must be aligned with segment size
+     * @param length: list length, 0 means up to the end of the file
+     * @param maxSegmentNum: at most maxSegmentNum segment slots are scanned
+     *        in this call, which bounds the number of listed segments
+     * @param[out] segments: allocated segments, sorted by start offset
+     * @param[out] nextOffset: offset where the next call should start,
+     *             not less than the end of the range if all segments are done
+     * @return On success, return StatusCode::kOK
+     */
+    StatusCode ListSegment(const std::string& filename, uint64_t offset,
+                           uint64_t length, uint32_t maxSegmentNum,
+                           std::vector<PageFileSegment>* segments,
+                           uint64_t* nextOffset);
+
+    /**
+     * @brief preallocate segments of a file in [offset, offset + length),
+     *        allocated segments are skipped, at most maxSegmentNum segments
+     *        are allocated and stored in one storage transaction
+     * @param filename
+     * @param offset: start offset, must be aligned with segment size
+     * @param length: preallocate length, 0 means up to the end of the file,
+     *        the range must not exceed the file length
+     * @param maxSegmentNum: max number of segments allocated in this call
+     * @param[out] nextOffset: offset where the next call should start,
+     *             not less than the end of the range if all segments are done
+     * @return On success, return StatusCode::kOK
+     */
+    StatusCode PreallocateSegment(const std::string& filename,
+                                  uint64_t offset, uint64_t length,
+                                  uint32_t maxSegmentNum,
+                                  uint64_t* nextOffset);
+
     /**
      *  @brief get the root file info
      *  @param
@@ -0,0 +1,214 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include "src/mds/nameserver2/etcd_write_batcher.h"
+
+#include <glog/logging.h>
+
+#include <mutex>  // NOLINT
+#include <unordered_set>
+
+#include "src/common/timeutility.h"
+
+namespace curve {
+namespace mds {
+
+using ::curve::common::TimeUtility;
+
+using LockGuard = std::lock_guard<bthread::Mutex>;
+using UniqueLock = std::unique_lock<bthread::Mutex>;
+
+EtcdWriteBatcher::EtcdWriteBatcher(std::shared_ptr<KVStorageClient> client,
+                                   const EtcdWriteBatchOption &option)
+    : client_(client), option_(option), running_(false) {}
+
+EtcdWriteBatcher::~EtcdWriteBatcher() {
+    Stop();
+}
+
+void EtcdWriteBatcher::Start() {
+    LockGuard lk(mtx_);
+    if (running_) {
+        return;
+    }
+
+    running_ = true;
+    flushThread_ = ::curve::common::Thread(&EtcdWriteBatcher::FlushLoop, this);
+    LOG(INFO) << "etcd write batcher started, max batch size = "
+              << option_.maxBatchSize
+              << ", batch window us = " << option_.batchWindowUs;
+}
+
+void EtcdWriteBatcher::Stop() {
+    {
+        LockGuard lk(mtx_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+
+    pendingCond_.notify_all();
+    flushThread_.join();
+    LOG(INFO) << "etcd write batcher stopped";
+}
+
+int EtcdWriteBatcher::Put(const std::string &key, const std::string &value,
+                          int64_t *revision) {
+    Request req{OpType::OpPut, &key, &value, 0, false, 0, 0};
+    int errCode = Submit(&req);
+    if (errCode == EtcdErrCode::EtcdOK && revision != nullptr) {
+        *revision = req.revision;
+    }
+    return errCode;
+}
+
+int EtcdWriteBatcher::Delete(const std::string &key, int64_t *revision) {
+    Request req{OpType::OpDelete, &key, nullptr, 0, false, 0, 0};
+    int errCode = Submit(&req);
+    if (errCode == EtcdErrCode::EtcdOK && revision != nullptr) {
+        *revision = req.revision;
+    }
+    return errCode;
+}
+
+int EtcdWriteBatcher::Submit(Request *req) {
+    req->submitTimeUs = TimeUtility::GetTimeofDayUs();
+
+    UniqueLock lk(mtx_);
+    if (!running_) {
+        lk.unlock();
+        if (req->type == OpType::OpPut) {
+            return client_->PutRewithRevision(*req->key, *req->value,
+                                              &req->revision);
+        }
+        return client_->DeleteRewithRevision(*req->key, &req->revision);
+    }
+
+    pending_.push_back(req);
+    if (pending_.size() == 1 || pending_.size() >= option_.maxBatchSize) {
+        pendingCond_.notify_one();
+    }
+
+    while (!req->done) {
+        doneCond_.wait(lk);
+    }
+    lk.unlock();
+
+    metric_.writeLatency_ << TimeUtility::GetTimeofDayUs() - req->submitTimeUs;
+    return req->errCode;
+}
+
+void EtcdWriteBatcher::FlushLoop() {
+    std::vector<Request*> batch;
+    batch.reserve(option_.maxBatchSize);
+
+    while (true) {
+        {
+            UniqueLock lk(mtx_);
+            while (running_ && pending_.empty()) {
+                pendingCond_.wait(lk);
+            }
+            if (pending_.empty()) {
+                // stopped and all pending writes are committed
+                return;
+            }
+
+            // a lone write is committed at once, writes coming during its
+            // commit are gathered into the next batch. Wait a small window
+            // for more writes only when other writers are already waiting,
+            // commit at once if the batch is full or batcher is stopping
+            if (option_.batchWindowUs > 0 && pending_.size() > 1) {
+                uint64_t deadlineUs =
+                    TimeUtility::GetTimeofDayUs() + option_.batchWindowUs;
+                while (running_ && pending_.size() < option_.maxBatchSize) {
+                    uint64_t nowUs = TimeUtility::GetTimeofDayUs();
+                    if (nowUs >= deadlineUs) {
+                        break;
+                    }
+                    pendingCond_.wait_for(lk, deadlineUs - nowUs);
+                }
+            }
+
+            TakeBatchLocked(&batch);
+        }
+
+        Commit(batch);
+
+        {
+            LockGuard lk(mtx_);
+            for (auto req : batch) {
+                req->done = true;
+            }
+        }
+        doneCond_.notify_all();
+        batch.clear();
+    }
+}
+
+void EtcdWriteBatcher::TakeBatchLocked(std::vector<Request*> *batch) {
+    std::unordered_set<std::string> keys;
+    auto iter = pending_.begin();
+    while (iter != pending_.end() && batch->size() < option_.maxBatchSize) {
+        if (!keys.insert(*(*iter)->key).second) {
+            ++iter;
+            continue;
+        }
+
+        batch->push_back(*iter);
+        iter = pending_.erase(iter);
+    }
+}
+
+void EtcdWriteBatcher::Commit(const std::vector<Request*> &batch) {
+    std::vector<Operation> ops;
+    ops.reserve(batch.size());
+    for (auto req : batch) {
+        const std::string *value = req->value;
+        ops.emplace_back(Operation{
+            req->type,
+            const_cast<char*>(req->key->c_str()),
+            const_cast<char*>(value == nullptr ? "" : value->c_str()),
+            static_cast<int>(req->key->size()),
+            static_cast<int>(value == nullptr ? 0 : value->size())});
+    }
+
+    uint64_t startUs = TimeUtility::GetTimeofDayUs();
+    int64_t revision = 0;
+    int errCode = client_->TxnNWithRevision(ops, &revision);
+    metric_.commitLatency_ << TimeUtility::GetTimeofDayUs() - startUs;
+    metric_.batchSize_ << batch.size();
+
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "commit etcd write batch failed, batch size = "
+                   << batch.size() << ", err: " << errCode;
+        metric_.failedOps_ << batch.size();
+    }
+
+    for (auto req : batch) {
+        req->errCode = errCode;
+        req->revision = revision;
+    }
+}
+
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#ifndef SRC_MDS_NAMESERVER2_ETCD_WRITE_BATCHER_H_
+#define SRC_MDS_NAMESERVER2_ETCD_WRITE_BATCHER_H_
+
+#include <bthread/condition_variable.h>
+#include <bthread/mutex.h>
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/concurrent/concurrent.h"
+#include "src/kvstorageclient/etcd_client.h"
+#include "src/mds/nameserver2/metric.h"
+
+namespace curve {
+namespace mds {
+
+using ::curve::kvstorage::KVStorageClient;
+
+struct EtcdWriteBatchOption {
+    // whether batch independent writes into one etcd txn
+    bool enable = false;
+    // max number of operations in one txn, should not exceed
+    // --max-txn-ops of etcd server
+    uint32_t maxBatchSize = 64;
+    // time to wait for more writes before committing a batch, only waited
+    // when other writes are pending, a lone write is committed at once
+    uint32_t batchWindowUs = 500;
+};
+
+/**
+ * EtcdWriteBatcher gathers concurrent independent writes and commits them
+ * in one etcd txn (group commit), so concurrent writers share a round trip.
+ *
+ * Writers block until the txn containing their operation is committed,
+ * then get the result of the whole txn. Writers are usually bthreads of
+ * brpc workers, so they are blocked on bthread primitives to keep the
+ * worker pthreads free. Operations on the same key are
+ * never put into the same txn, and they are committed in submit order.
+ */
+class EtcdWriteBatcher {
+ public:
+    EtcdWriteBatcher(std::shared_ptr<KVStorageClient> client,
+                     const EtcdWriteBatchOption &option);
+
+    ~EtcdWriteBatcher();
+
+    void Start();
+
+    /**
+     * @brief Stop the batcher, pending writes are committed before return,
+     *        writes after stop go to etcd directly
+     */
+    void Stop();
+
+    /**
+     * @brief put key-value in a batch
+     *
+     * @param[in] key
+     * @param[in] value
+     * @param[out] revision revision of the txn, can be nullptr
+     *
+     * @return error code of EtcdErrCode
+     */
+    int Put(const std::string &key, const std::string &value,
+            int64_t *revision);
+
+    /**
+     * @brief delete key in a batch
+     *
+     * @param[in] key
+     * @param[out] revision revision of the txn, can be nullptr
+     *
+     * @return error code of EtcdErrCode
+     */
+    int Delete(const std::string &key, int64_t *revision);
+
+ private:
+    struct Request {
+        OpType type;
+        const std::string *key;
+        const std::string *value;
+        uint64_t submitTimeUs;
+        bool done;
+        int errCode;
+        int64_t revision;
+    };
+
+    int Submit(Request *req);
+
+    void FlushLoop();
+
+    /**
+     * @brief take requests with different keys from pending queue,
+     *        requests on a key already in the batch are left in queue,
+     *        so the order of operations on the same key is kept
+     */
+    void TakeBatchLocked(std::vector<Request*> *batch);
+
+    void Commit(const std::vector<Request*> &batch);
+
+ private:
+    std::shared_ptr<KVStorageClient> client_;
+    const EtcdWriteBatchOption option_;
+
+    bthread::Mutex mtx_;
+    // notify flush thread that new requests come
+    bthread::ConditionVariable pendingCond_;
+    // notify writers that their requests are committed
+    bthread::ConditionVariable doneCond_;
+    std::list<Request*> pending_;
+    bool running_;
+
+    ::curve::common::Thread flushThread_;
+
+    EtcdWriteBatchMetric metric_;
+};
+
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_NAMESERVER2_ETCD_WRITE_BATCHER_H_
@@ -21,14 +21,54 @@
  */
 
 #include "src/mds/nameserver2/file_record.h"
+
+#include <algorithm>
+
 #include "src/mds/common/mds_define.h"
 #include "src/common/timeutility.h"
 
 namespace curve {
 namespace mds {
 
+using curve::common::LockGuard;
+using curve::common::TimeUtility;
+
+namespace {
+// used before Init, e.g. by mocks in tests
+const uint32_t kDefaultShardNum = 64;
+}  // namespace
+
+FileRecordManager::FileRecordManager()
+    : tickUs_(1), lastTick_(0) {
+    fileRecordOptions_.fileRecordExpiredTimeUs = 0;
+    fileRecordOptions_.scanIntervalTimeUs = 0;
+    fileRecordOptions_.shardNum = kDefaultShardNum;
+    Reset();
+}
+
 void FileRecordManager::Init(const FileRecordOptions& fileRecordOptions) {
     fileRecordOptions_ = fileRecordOptions;
+    if (fileRecordOptions_.shardNum == 0) {
+        fileRecordOptions_.shardNum = kDefaultShardNum;
+    }
+    Reset();
+}
+
+void FileRecordManager::Reset() {
+    shards_.clear();
+    for (uint32_t i = 0; i < fileRecordOptions_.shardNum; ++i) {
+        shards_.emplace_back(new Shard());
+    }
+
+    // a record expires at most 10 * expiredTime after it is scheduled,
+    // so the wheel can hold it within one round
+    LockGuard lk(wheelMtx_);
+    tickUs_ = std::max<uint64_t>(fileRecordOptions_.scanIntervalTimeUs, 1);
+    uint64_t slots =
+        10ULL * fileRecordOptions_.fileRecordExpiredTimeUs / tickUs_ + 2;
+    wheel_.clear();
+    wheel_.resize(slots);
+    lastTick_ = TimeUtility::GetTimeofDayUs() / tickUs_;
 }
 
 void FileRecordManager::Start() {
@@ -46,16 +86,31 @@ void FileRecordManager::Stop() {
     }
 }
 
+FileRecordManager::Shard* FileRecordManager::GetShard(
+    const std::string& fileName) const {
+    return shards_[std::hash<std::string>()(fileName) % shards_.size()].get();
+}
+
+uint64_t FileRecordManager::GetOpenFileNum() const {
+    uint64_t num = 0;
+    for (const auto& shard : shards_) {
+        ReadLockGuard lk(shard->rwlock);
+        num += shard->records.size();
+    }
+    return num;
+}
+
 bool FileRecordManager::GetFileClientVersion(
     const std::string& fileName, std::string *clientVersion) const {
-    ReadLockGuard lk(rwlock_);
+    Shard* shard = GetShard(fileName);
+    ReadLockGuard lk(shard->rwlock);
 
-    auto it = fileRecords_.find(fileName);
-    if (it == fileRecords_.end()) {
+    auto it = shard->records.find(fileName);
+    if (it == shard->records.end()) {
         return false;
     }
 
-    *clientVersion = it->second.GetClientVersion();
+    *clientVersion = it->second->GetClientVersion();
     return true;
 }
 
@@ -63,53 +118,133 @@ void FileRecordManager::UpdateFileRecord(const std::string& fileName,
                                          const std::string& clientVersion,
                                          const std::string& clientIP,
                                          uint32_t clientPort) {
+    Shard* shard = GetShard(fileName);
     do {
-        ReadLockGuard lk(rwlock_);
+        ReadLockGuard lk(shard->rwlock);
 
-        auto it = fileRecords_.find(fileName);
-        if (it == fileRecords_.end()) {
+        auto it = shard->records.find(fileName);
+        if (it == shard->records.end()) {
             break;
         }
 
         // update record
-        it->second.Update(clientVersion, clientIP, clientPort);
+        it->second->Update(clientVersion, clientIP, clientPort);
         return;
     } while (0);
 
-    FileRecord record(fileRecordOptions_.fileRecordExpiredTimeUs,
-                      clientVersion,
-                      clientIP,
-                      clientPort);
+    auto record = std::make_shared<FileRecord>(
+        fileRecordOptions_.fileRecordExpiredTimeUs,
+        clientVersion,
+        clientIP,
+        clientPort);
+    {
+        WriteLockGuard lk(shard->rwlock);
+        auto ret = shard->records.emplace(fileName, record);
+        if (!ret.second) {
+            // added by another refresh of the same file
+            ret.first->second->Update(clientVersion, clientIP, clientPort);
+            return;
+        }
+    }
+
     LOG(INFO) << "Add new file record, filename = " << fileName
               << ", clientVersion = " << clientVersion
               << ", clientIP = " << clientIP
               << ", clientPort = " << clientPort;
-    WriteLockGuard lk(rwlock_);
-    fileRecords_.emplace(fileName, record);
+    LockGuard lk(wheelMtx_);
+    ScheduleLocked(WheelEntry{fileName, record}, record->GetExpireTime());
 }
 
 void FileRecordManager::RemoveFileRecord(const std::string& filename) {
-    WriteLockGuard lk(rwlock_);
-    fileRecords_.erase(filename);
+    // entry in the timer wheel is dropped when its slot is due
+    Shard* shard = GetShard(filename);
+    WriteLockGuard lk(shard->rwlock);
+    shard->records.erase(filename);
+}
+
+void FileRecordManager::ScheduleLocked(WheelEntry entry,
+                                       uint64_t expireTimeUs) {
+    // the slot is due after the expire time, and never in the past
+    uint64_t tick = expireTimeUs / tickUs_ + 1;
+    tick = std::max(tick, lastTick_ + 1);
+    tick = std::min<uint64_t>(tick, lastTick_ + wheel_.size());
+    wheel_[tick % wheel_.size()].emplace_back(std::move(entry));
+}
+
+void FileRecordManager::ExpireSlot(uint64_t tick) {
+    std::vector<WheelEntry> entries;
+    {
+        LockGuard lk(wheelMtx_);
+        entries.swap(wheel_[tick % wheel_.size()]);
+    }
+
+    std::vector<WheelEntry> alive;
+    for (auto& entry : entries) {
+        auto record = entry.record.lock();
+        if (record == nullptr) {
+            // removed already
+            continue;
+        }
+
+        if (!record->IsTimeout()) {
+            alive.emplace_back(std::move(entry));
+            continue;
+        }
+
+        Shard* shard = GetShard(entry.fileName);
+        WriteLockGuard lk(shard->rwlock);
+        auto iter = shard->records.find(entry.fileName);
+        if (iter == shard->records.end() || iter->second != record) {
+            // removed or replaced by a new record
+            continue;
+        }
+
+        // check again, it may be refreshed before we get the lock
+        if (!record->IsTimeout()) {
+            alive.emplace_back(std::move(entry));
+            continue;
+        }
+
+        LOG(INFO) << "Remove timeout file record, filename = "
+                  << entry.fileName
+                  << ", last update time = "
+                  << curve::common::TimeUtility::TimeStampToStandard(
+                         record->GetUpdateTime() / 1000000);
+        shard->records.erase(iter);
+    }
+
+    if (alive.empty()) {
+        return;
+    }
+
+    LockGuard lk(wheelMtx_);
+    for (auto& entry : alive) {
+        auto record = entry.record.lock();
+        if (record != nullptr) {
+            ScheduleLocked(std::move(entry), record->GetExpireTime());
+        }
+    }
 }
 
 void FileRecordManager::Scan() {
     while (sleeper_.wait_for(
             std::chrono::microseconds(fileRecordOptions_.scanIntervalTimeUs))) {
-        WriteLockGuard lk(rwlock_);
-
-        auto iter = fileRecords_.begin();
-        while (iter != fileRecords_.end()) {
-            if (iter->second.IsTimeout()) {
-                LOG(INFO) << "Remove timeout file record, filename = "
-                          << iter->first
-                          << ", last update time = "
-                          << curve::common::TimeUtility::TimeStampToStandard(
-                                 iter->second.GetUpdateTime() / 1000000);
-                iter = fileRecords_.erase(iter);
-            } else {
-                ++iter;
+        uint64_t currentTick = TimeUtility::GetTimeofDayUs() / tickUs_;
+        while (true) {
+            uint64_t tick;
+            {
+                LockGuard lk(wheelMtx_);
+                if (lastTick_ >= currentTick) {
+                    break;
+                }
+                // all slots are due if we are late for a whole round
+                if (currentTick - lastTick_ > wheel_.size()) {
+                    lastTick_ = currentTick - wheel_.size();
+                }
+                tick = ++lastTick_;
             }
+
+            ExpireSlot(tick);
         }
     }
 }
@@ -125,10 +260,10 @@ void FileRecordManager::GetRecordParam(ProtoSession* protoSession) const {
 std::set<ClientIpPortType> FileRecordManager::ListAllClient() const {
     std::set<ClientIpPortType> res;
 
-    {
-        ReadLockGuard lk(rwlock_);
-        for (const auto& r : fileRecords_) {
-            const auto& ipPort = r.second.GetClientIpPort();
+    for (const auto& shard : shards_) {
+        ReadLockGuard lk(shard->rwlock);
+        for (const auto& r : shard->records) {
+            const auto& ipPort = r.second->GetClientIpPort();
             if (ipPort.second != kInvalidPort) {
                 res.emplace(ipPort);
             }
@@ -140,13 +275,14 @@ std::set<ClientIpPortType> FileRecordManager::ListAllClient() const {
 
 bool FileRecordManager::FindFileMountPoint(const std::string& fileName,
                                            ClientIpPortType* ipPort) const {
-    ReadLockGuard lk(rwlock_);
-    auto iter = fileRecords_.find(fileName);
-    if (iter == fileRecords_.end()) {
+    Shard* shard = GetShard(fileName);
+    ReadLockGuard lk(shard->rwlock);
+    auto iter = shard->records.find(fileName);
+    if (iter == shard->records.end()) {
         return false;
     }
 
-    *ipPort = iter->second.GetClientIpPort();
+    *ipPort = iter->second->GetClientIpPort();
     return true;
 }
 
@@ -23,10 +23,13 @@
 #ifndef SRC_MDS_NAMESERVER2_FILE_RECORD_H_
 #define SRC_MDS_NAMESERVER2_FILE_RECORD_H_
 
+#include <atomic>
+#include <memory>
 #include <unordered_map>
 #include <utility>
 #include <string>
 #include <set>
+#include <vector>
 
 #include "src/common/concurrent/rw_lock.h"
 #include "src/common/interruptible_sleeper.h"
@@ -45,6 +48,8 @@ struct FileRecordOptions {
     uint32_t fileRecordExpiredTimeUs;
     // time interval of scanning file record map (in μs)
     uint32_t scanIntervalTimeUs;
+    // number of shards of file record map
+    uint32_t shardNum = 64;
 };
 
 class FileRecord {
@@ -58,15 +63,25 @@ class FileRecord {
           clientPort_(clientPort) {}
 
     FileRecord(const FileRecord& fileRecord)
-        : updateTimeUs_(fileRecord.updateTimeUs_),
-          timeoutUs_(fileRecord.timeoutUs_),
-          clientVersion_(fileRecord.clientVersion_),
-          clientIP_(fileRecord.clientIP_),
-          clientPort_(fileRecord.clientPort_) {}
+        : updateTimeUs_(fileRecord.GetUpdateTime()),
+          timeoutUs_(fileRecord.timeoutUs_) {
+        curve::common::LockGuard lk(fileRecord.mtx_);
+        clientVersion_ = fileRecord.clientVersion_;
+        clientIP_ = fileRecord.clientIP_;
+        clientPort_ = fileRecord.clientPort_;
+    }
 
     FileRecord& operator=(const FileRecord& fileRecord) {
-        updateTimeUs_ = fileRecord.updateTimeUs_;
+        if (this == &fileRecord) {
+            return *this;
+        }
+
+        updateTimeUs_.store(fileRecord.GetUpdateTime(),
+                            std::memory_order_relaxed);
         timeoutUs_ = fileRecord.timeoutUs_;
+        std::lock(mtx_, fileRecord.mtx_);
+        curve::common::LockGuard lk1(mtx_, std::adopt_lock);
+        curve::common::LockGuard lk2(fileRecord.mtx_, std::adopt_lock);
         clientVersion_ = fileRecord.clientVersion_;
         clientIP_ = fileRecord.clientIP_;
         clientPort_ = fileRecord.clientPort_;
@@ -78,21 +93,23 @@ class FileRecord {
      * @return true if timeout, false if not
      */
     bool IsTimeout() const {
-        curve::common::LockGuard lk(mtx_);
         uint64_t currentTimeUs = curve::common::TimeUtility::GetTimeofDayUs();
-        return currentTimeUs > updateTimeUs_ + 10 * timeoutUs_;
+        return currentTimeUs > GetExpireTime();
     }
 
     /**
-     * @brief Update time
+     * @brief Update time, the timestamp is updated without lock,
+     *        so IsTimeout never waits for a refresh
      */
     void Update(const std::string& clientVersion, const std::string& clientIP,
                 uint32_t clientPort) {
+        updateTimeUs_.store(curve::common::TimeUtility::GetTimeofDayUs(),
+                            std::memory_order_relaxed);
+
         curve::common::LockGuard lk(mtx_);
-        updateTimeUs_ = curve::common::TimeUtility::GetTimeofDayUs();
         clientVersion_ = clientVersion;
         clientIP_ = clientIP;
-        clientPort_ = clientPort_;
+        clientPort_ = clientPort;
     }
 
     /**
@@ -108,8 +125,15 @@ class FileRecord {
      * @return last updated time
      */
     uint64_t GetUpdateTime() const {
-        curve::common::LockGuard lk(mtx_);
-        return updateTimeUs_;
+        return updateTimeUs_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the time after which the record is timeout
+     * @return expire time in μs
+     */
+    uint64_t GetExpireTime() const {
+        return GetUpdateTime() + 10 * timeoutUs_;
     }
 
     /**
@@ -117,16 +141,18 @@ class FileRecord {
      * @return version number, null if has no version
      */
     std::string GetClientVersion() const {
+        curve::common::LockGuard lk(mtx_);
         return clientVersion_;
     }
 
     ClientIpPortType GetClientIpPort() const {
+        curve::common::LockGuard lk(mtx_);
         return {clientIP_, clientPort_};
     }
 
  private:
     // latest update time in μs
-    uint64_t updateTimeUs_;
+    std::atomic<uint64_t> updateTimeUs_;
     // timeout
     uint64_t timeoutUs_;
     // client version
@@ -135,12 +161,29 @@ class FileRecord {
     std::string clientIP_;
     // client port
     uint32_t clientPort_;
-    // mutex for updating the time
+    // mutex for client info
     mutable curve::common::Mutex mtx_;
 };
 
+/**
+ * FileRecordManager keeps the sessions of opened files.
+ *
+ * Records are spread over several shards by filename, each shard has its
+ * own rwlock, so refreshes of different files rarely contend. Refreshing an
+ * existing record only takes the shard read lock.
+ *
+ * Expiration is driven by a timer wheel with one slot per scan interval.
+ * A record is put into the slot of its expire time when it's created, and
+ * the wheel is not touched on refresh. When a slot is due, its records are
+ * checked, timeout ones are removed and others are put back into the slot
+ * of their new expire time. So the scan thread only visits each record
+ * about once per expire period, instead of walking all records every scan
+ * interval.
+ */
 class FileRecordManager {
  public:
+    FileRecordManager();
+
     virtual ~FileRecordManager() = default;
 
     /**
@@ -153,10 +196,7 @@ class FileRecordManager {
      * @brief Get the opened file number
      * @return the number of the opened files
      */
-    uint64_t GetOpenFileNum() const {
-        ReadLockGuard lk(rwlock_);
-        return fileRecords_.size();
-    }
+    uint64_t GetOpenFileNum() const;
 
     /**
      * @brief Get the expired time of the file
@@ -210,15 +250,53 @@ class FileRecordManager {
                                     ClientIpPortType* ipPort) const;
 
  private:
+    struct Shard {
+        // file records
+        std::unordered_map<std::string, std::shared_ptr<FileRecord>> records;
+        // rwlock for records
+        mutable curve::common::RWLock rwlock;
+    };
+
+    struct WheelEntry {
+        std::string fileName;
+        // the record is removed if it's expired or replaced
+        std::weak_ptr<FileRecord> record;
+    };
+
+    Shard* GetShard(const std::string& fileName) const;
+
+    /**
+     * @brief Create shards and timer wheel according to options
+     */
+    void Reset();
+
+    /**
+     * @brief Put the record into the wheel slot of its expire time
+     */
+    void ScheduleLocked(WheelEntry entry, uint64_t expireTimeUs);
+
+    /**
+     * @brief Check records in the slot of tick, remove timeout ones and
+     *        reschedule others
+     */
+    void ExpireSlot(uint64_t tick);
+
     /**
      * @brief Function for periodic scanning, it deletes timed-out file records
      */
     void Scan();
 
-    // file recoreds
-    std::unordered_map<std::string, FileRecord> fileRecords_;
-    // rwlock for fileRecords_
-    mutable curve::common::RWLock rwlock_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // timer wheel, each slot covers a scan interval
+    std::vector<std::vector<WheelEntry>> wheel_;
+    // length of a slot in μs
+    uint64_t tickUs_;
+    // the last tick that has been processed
+    uint64_t lastTick_;
+    // mutex for wheel_ and lastTick_
+    curve::common::Mutex wheelMtx_;
+
     // the thread for scanning in backend
     curve::common::Thread scanThread_;
 
@@ -0,0 +1,207 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include "src/mds/nameserver2/follower_namespace_service.h"
+
+#include <glog/logging.h>
+
+#include <cerrno>
+#include <vector>
+
+#include "src/common/timeutility.h"
+#include "src/mds/nameserver2/namespace_service.h"
+
+namespace curve {
+namespace mds {
+
+using ::curve::common::ExpiredTime;
+
+void FollowerNameSpaceService::GetFileInfo(
+                        ::google::protobuf::RpcController* controller,
+                        const ::curve::mds::GetFileInfoRequest* request,
+                        ::curve::mds::GetFileInfoResponse* response,
+                        ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    ExpiredTime expiredTime;
+
+    if (!CheckFresh(cntl)) {
+        return;
+    }
+
+    if (!isPathValid(request->filename())) {
+        response->set_statuscode(StatusCode::kParaError);
+        LOG(ERROR) << "logid = " << cntl->log_id()
+            << ", follower GetFileInfo request path is invalid, filename = "
+            << request->filename();
+        return;
+    }
+
+    StatusCode retCode = curvefs_->CheckFileOwner(request->filename(),
+        request->owner(), request->signature(), request->date());
+    if (retCode == StatusCode::kOK) {
+        retCode = curvefs_->GetFileInfo(request->filename(),
+                                        response->mutable_fileinfo());
+    }
+    response->set_statuscode(retCode);
+    if (retCode != StatusCode::kOK) {
+        response->clear_fileinfo();
+        LOG_IF(WARNING, google::ERROR != GetMdsLogLevel(retCode))
+            << "logid = " << cntl->log_id()
+            << ", follower GetFileInfo fail, filename = "
+            << request->filename()
+            << ", owner = " << request->owner()
+            << ", StatusCode_Name = " << StatusCode_Name(retCode);
+        LOG_IF(ERROR, google::ERROR == GetMdsLogLevel(retCode))
+            << "logid = " << cntl->log_id()
+            << ", follower GetFileInfo fail, filename = "
+            << request->filename()
+            << ", owner = " << request->owner()
+            << ", StatusCode_Name = " << StatusCode_Name(retCode);
+        return;
+    }
+
+    DVLOG(6) << "logid = " << cntl->log_id()
+             << ", follower GetFileInfo ok, filename = " << request->filename()
+             << ", cost " << expiredTime.ExpiredMs() << " ms";
+}
+
+void FollowerNameSpaceService::GetOrAllocateSegment(
+                    ::google::protobuf::RpcController* controller,
+                    const ::curve::mds::GetOrAllocateSegmentRequest* request,
+                    ::curve::mds::GetOrAllocateSegmentResponse* response,
+                    ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    ExpiredTime expiredTime;
+
+    if (request->allocateifnotexist()) {
+        cntl->SetFailed(EPERM, "allocating segment is not allowed");
+        return;
+    }
+
+    if (!CheckFresh(cntl)) {
+        return;
+    }
+
+    if (!isPathValid(request->filename())) {
+        response->set_statuscode(StatusCode::kParaError);
+        LOG(ERROR) << "logid = " << cntl->log_id()
+            << ", follower GetOrAllocateSegment request path is invalid, "
+            << "filename = " << request->filename();
+        return;
+    }
+
+    StatusCode retCode = curvefs_->CheckFileOwner(request->filename(),
+        request->owner(), request->signature(), request->date());
+    uint64_t offset = request->offset();
+    if (retCode == StatusCode::kOK) {
+        retCode = curvefs_->GetOrAllocateSegment(request->filename(), offset,
+            false, response->mutable_pagefilesegment());
+    }
+
+    response->set_statuscode(retCode);
+    if (retCode != StatusCode::kOK) {
+        response->clear_pagefilesegment();
+        LOG_IF(WARNING, google::ERROR != GetMdsLogLevel(retCode))
+            << "logid = " << cntl->log_id()
+            << ", follower GetOrAllocateSegment fail, filename = "
+            << request->filename() << ", offset = " << offset
+            << ", StatusCode_Name = " << StatusCode_Name(retCode);
+        LOG_IF(ERROR, google::ERROR == GetMdsLogLevel(retCode))
+            << "logid = " << cntl->log_id()
+            << ", follower GetOrAllocateSegment fail, filename = "
+            << request->filename() << ", offset = " << offset
+            << ", StatusCode_Name = " << StatusCode_Name(retCode);
+        return;
+    }
+
+    DVLOG(6) << "logid = " << cntl->log_id()
+             << ", follower GetOrAllocateSegment ok, filename = "
+             << request->filename() << ", offset = " << offset
+             << ", cost " << expiredTime.ExpiredMs() << " ms";
+}
+
+void FollowerNameSpaceService::ListDir(
+                       ::google::protobuf::RpcController* controller,
+                       const ::curve::mds::ListDirRequest* request,
+                       ::curve::mds::ListDirResponse* response,
+                       ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    ExpiredTime expiredTime;
+
+    if (!CheckFresh(cntl)) {
+        return;
+    }
+
+    if (!isPathValid(request->filename())) {
+        response->set_statuscode(StatusCode::kParaError);
+        LOG(ERROR) << "logid = " << cntl->log_id()
+            << ", follower ListDir request path is invalid, filename = "
+            << request->filename();
+        return;
+    }
+
+    StatusCode retCode = curvefs_->CheckFileOwner(request->filename(),
+        request->owner(), request->signature(), request->date());
+    std::vector<FileInfo> files;
+    if (retCode == StatusCode::kOK) {
+        retCode = curvefs_->ReadDir(request->filename(), &files);
+    }
+
+    response->set_statuscode(retCode);
+    if (retCode != StatusCode::kOK) {
+        LOG_IF(WARNING, google::ERROR != GetMdsLogLevel(retCode))
+            << "logid = " << cntl->log_id()
+            << ", follower ListDir fail, filename = " << request->filename()
+            << ", owner = " << request->owner()
+            << ", StatusCode_Name = " << StatusCode_Name(retCode);
+        LOG_IF(ERROR, google::ERROR == GetMdsLogLevel(retCode))
+            << "logid = " << cntl->log_id()
+            << ", follower ListDir fail, filename = " << request->filename()
+            << ", owner = " << request->owner()
+            << ", StatusCode_Name = " << StatusCode_Name(retCode);
+        return;
+    }
+
+    for (auto &file : files) {
+        response->add_fileinfo()->Swap(&file);
+    }
+    DVLOG(6) << "logid = " << cntl->log_id()
+             << ", follower ListDir ok, filename = " << request->filename()
+             << ", cost " << expiredTime.ExpiredMs() << " ms";
+}
+
+bool FollowerNameSpaceService::CheckFresh(brpc::Controller* cntl) {
+    if (cache_->IsFresh()) {
+        return true;
+    }
+    cntl->SetFailed(EAGAIN, "namespace cache is stale");
+    LOG_EVERY_N(WARNING, 1000) << "namespace cache is stale, "
+                               << "synced revision = "
+                               << cache_->GetSyncedRevision();
+    return false;
+}
+
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#ifndef SRC_MDS_NAMESERVER2_FOLLOWER_NAMESPACE_SERVICE_H_
+#define SRC_MDS_NAMESERVER2_FOLLOWER_NAMESPACE_SERVICE_H_
+
+#include <brpc/closure_guard.h>
+#include <brpc/controller.h>
+
+#include <memory>
+#include <string>
+
+#include "proto/nameserver2.pb.h"
+#include "src/mds/nameserver2/curvefs.h"
+#include "src/mds/nameserver2/namespace_follower_cache.h"
+
+namespace curve {
+namespace mds {
+
+/**
+ * FollowerNameSpaceService serves read-only namespace rpcs from
+ * NameSpaceFollowerCache, it runs on every mds including followers.
+ *
+ * If the cache is not confirmed to be in sync with etcd within
+ * maxStalenessMs, rpcs fail with EAGAIN, and clients retry on the leader.
+ * Rpcs not implemented here fail too, so they always go to the leader.
+ */
+class FollowerNameSpaceService : public CurveFSService {
+ public:
+    FollowerNameSpaceService(std::shared_ptr<NameSpaceFollowerCache> cache,
+                             const RootAuthOption &authOption)
+        : cache_(cache),
+          curvefs_(CurveFS::CreateReadOnly(
+              std::make_shared<NameSpaceFollowerStorage>(cache),
+              authOption)) {}
+
+    void GetFileInfo(::google::protobuf::RpcController* controller,
+                     const ::curve::mds::GetFileInfoRequest* request,
+                     ::curve::mds::GetFileInfoResponse* response,
+                     ::google::protobuf::Closure* done) override;
+
+    /**
+     * @brief only segments which have been allocated are returned,
+     *        allocating requests fail with EPERM
+     */
+    void GetOrAllocateSegment(::google::protobuf::RpcController* controller,
+                    const ::curve::mds::GetOrAllocateSegmentRequest* request,
+                    ::curve::mds::GetOrAllocateSegmentResponse* response,
+                    ::google::protobuf::Closure* done) override;
+
+    void ListDir(::google::protobuf::RpcController* controller,
+                 const ::curve::mds::ListDirRequest* request,
+                 ::curve::mds::ListDirResponse* response,
+                 ::google::protobuf::Closure* done) override;
+
+ private:
+    /**
+     * @brief refuse the request if the cache is stale
+     *
+     * @return true if the request can be served
+     */
+    bool CheckFresh(brpc::Controller* cntl);
+
+ private:
+    std::shared_ptr<NameSpaceFollowerCache> cache_;
+    // read-only CurveFS on the cache
+    std::unique_ptr<CurveFS> curvefs_;
+};
+
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_NAMESERVER2_FOLLOWER_NAMESPACE_SERVICE_H_
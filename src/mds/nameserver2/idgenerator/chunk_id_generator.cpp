@@ -31,5 +31,9 @@ namespace mds {
 bool ChunkIDGeneratorImp::GenChunkID(ChunkID *id) {
     return generator_->GenID(id);
 }
+
+bool ChunkIDGeneratorImp::GenChunkIDs(uint32_t num, std::vector<ChunkID> *ids) {
+    return generator_->GenIDs(num, ids);
+}
 }  // namespace mds
 }  // namespace curve
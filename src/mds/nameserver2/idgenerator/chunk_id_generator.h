@@ -24,6 +24,7 @@
 #define SRC_MDS_NAMESERVER2_IDGENERATOR_CHUNK_ID_GENERATOR_H_
 
 #include <memory>
+#include <vector>
 #include "src/mds/common/mds_define.h"
 #include "src/common/namespace_define.h"
 #include "src/common/concurrent/concurrent.h"
@@ -50,6 +51,26 @@ class ChunkIDGenerator {
     * @return true if succeeded, false if failed
     */
     virtual bool GenChunkID(ChunkID *id) = 0;
+
+    /*
+    * @brief GenChunkIDs Generate a batch of globally incremented IDs
+    *
+    * @param[in] num Number of IDs to generate
+    * @param[out] ids IDs generated
+    *
+    * @return true if succeeded, false if failed
+    */
+    virtual bool GenChunkIDs(uint32_t num, std::vector<ChunkID> *ids) {
+        ids->clear();
+        for (uint32_t i = 0; i < num; i++) {
+            ChunkID id;
+            if (!GenChunkID(&id)) {
+                return false;
+            }
+            ids->push_back(id);
+        }
+        return true;
+    }
 };
 
 class ChunkIDGeneratorImp : public ChunkIDGenerator {
@@ -62,6 +83,8 @@ class ChunkIDGeneratorImp : public ChunkIDGenerator {
 
     bool GenChunkID(ChunkID *id) override;
 
+    bool GenChunkIDs(uint32_t num, std::vector<ChunkID> *ids) override;
+
  private:
     std::shared_ptr<EtcdIdGenerator> generator_;
 };
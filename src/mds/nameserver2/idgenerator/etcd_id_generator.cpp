@@ -21,7 +21,9 @@
  */
 
 #include <glog/logging.h>
+#include <algorithm>
 #include <string>
+#include <vector>
 #include "src/mds/nameserver2/idgenerator/etcd_id_generator.h"
 #include "src/common/string_util.h"
 #include "src/mds/nameserver2/helper/namespace_helper.h"
@@ -40,6 +42,24 @@ bool EtcdIdGenerator::GenID(InodeID *id) {
     return true;
 }
 
+bool EtcdIdGenerator::GenIDs(uint32_t num, std::vector<uint64_t> *ids) {
+    ids->clear();
+    ids->reserve(num);
+
+    ::curve::common::WriteLockGuard guard(lock_);
+    while (ids->size() < num) {
+        if (nextId_ > bundleEnd_ || nextId_ == initialize_) {
+            // apply at least the remaining number of ids in one bundle
+            uint64_t remain = num - ids->size();
+            if (!AllocateBundleIds(std::max(bundle_, remain))) {
+                return false;
+            }
+        }
+        ids->push_back(nextId_++);
+    }
+    return true;
+}
+
 bool EtcdIdGenerator::AllocateBundleIds(int requiredNum) {
     // get the maximum value that has been allocated
     std::string out = "";
@@ -24,6 +24,7 @@
 #define SRC_MDS_NAMESERVER2_IDGENERATOR_ETCD_ID_GENERATOR_H_
 
 #include <string>
+#include <vector>
 #include <memory>
 #include "src/mds/common/mds_define.h"
 #include "src/kvstorageclient/etcd_client.h"
@@ -46,6 +47,17 @@ class EtcdIdGenerator {
 
     bool GenID(InodeID *id);
 
+    /*
+    * @brief GenIDs generate a batch of IDs under one lock, a new bundle is
+    *        applied from storage if the current one is not enough
+    *
+    * @param[in] num number of IDs to generate
+    * @param[out] ids IDs generated
+    *
+    * @return false if failed, true if succeeded
+    */
+    bool GenIDs(uint32_t num, std::vector<uint64_t> *ids);
+
  private:
     /*
     * @brief apply for IDs in batches from storage
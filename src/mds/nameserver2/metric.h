@@ -86,6 +86,30 @@ class SegmentDiscardMetric {
     bvar::Adder<int64_t> pendingSize_;
 };
 
+class EtcdWriteBatchMetric {
+ public:
+    EtcdWriteBatchMetric()
+        : prefix_("mds_nameserver_etcd_write_batch"),
+          batchSize_(prefix_, "size"),
+          commitLatency_(prefix_, "commit"),
+          writeLatency_(prefix_, "write"),
+          failedOps_(prefix_ + "_failed_op_count") {}
+
+    ~EtcdWriteBatchMetric() = default;
+
+ public:
+    const std::string prefix_;
+
+    // number of operations in one txn, LatencyRecorder is used
+    // for its percentiles
+    bvar::LatencyRecorder batchSize_;
+    // latency of one txn commit, in us
+    bvar::LatencyRecorder commitLatency_;
+    // latency of one write, including the time waiting in queue, in us
+    bvar::LatencyRecorder writeLatency_;
+    bvar::Adder<int64_t> failedOps_;
+};
+
 }  // namespace mds
 }  // namespace curve
 
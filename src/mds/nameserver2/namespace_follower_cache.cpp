@@ -0,0 +1,437 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include "src/mds/nameserver2/namespace_follower_cache.h"
+
+#include <glog/logging.h>
+
+#include <chrono>  // NOLINT
+#include <utility>
+
+#include "src/common/namespace_define.h"
+#include "src/common/timeutility.h"
+#include "src/mds/nameserver2/helper/namespace_helper.h"
+
+namespace curve {
+namespace mds {
+
+using ::curve::common::ReadLockGuard;
+using ::curve::common::WriteLockGuard;
+using ::curve::common::TimeUtility;
+using ::curve::common::FILEINFOKEYPREFIX;
+using ::curve::common::FILEINFOKEYEND;
+
+// number of file infos loaded from etcd in one list
+const int kLoadFileBundle = 1000;
+
+NameSpaceFollowerCache::NameSpaceFollowerCache(
+    std::shared_ptr<EtcdClientImp> client, const FollowerReadOption &option)
+    : client_(client),
+      option_(option),
+      syncedRevision_(0),
+      lastSyncTimeMs_(0),
+      running_(false) {}
+
+NameSpaceFollowerCache::~NameSpaceFollowerCache() {
+    Stop();
+}
+
+bool NameSpaceFollowerCache::Init() {
+    return Load();
+}
+
+void NameSpaceFollowerCache::Start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    syncThread_ = ::curve::common::Thread(
+        &NameSpaceFollowerCache::SyncLoop, this);
+    LOG(INFO) << "namespace follower cache started, synced revision = "
+              << syncedRevision_.load();
+}
+
+void NameSpaceFollowerCache::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    sleeper_.interrupt();
+    syncThread_.join();
+    LOG(INFO) << "namespace follower cache stopped";
+}
+
+bool NameSpaceFollowerCache::Load() {
+    uint64_t startMs = TimeUtility::GetTimeofDayMs();
+    int64_t revision;
+    int res = client_->GetCurrentRevision(&revision);
+    if (res != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "get current revision fail, errCode: " << res;
+        return false;
+    }
+
+    // list the whole keyspace at the same revision, so it is a snapshot
+    std::map<std::string, std::shared_ptr<const FileInfo>> files;
+    std::string listKey = FILEINFOKEYPREFIX;
+    std::vector<std::string> values;
+    std::string lastKey;
+    do {
+        values.clear();
+        lastKey.clear();
+        res = client_->ListWithLimitAndRevision(listKey, FILEINFOKEYEND,
+            kLoadFileBundle, revision, &values, &lastKey);
+        if (res != EtcdErrCode::EtcdOK) {
+            LOG(ERROR) << "list [" << listKey << "," << FILEINFOKEYEND
+                       << ") at revision: " << revision
+                       << " fail, errCode: " << res;
+            return false;
+        }
+
+        // the first one is the last one of previous bundle
+        // except for the first bundle
+        size_t startPos = (listKey == FILEINFOKEYPREFIX) ? 0 : 1;
+        for (; startPos < values.size(); startPos++) {
+            auto fileInfo = std::make_shared<FileInfo>();
+            if (!NameSpaceStorageCodec::DecodeFileInfo(values[startPos],
+                                                       fileInfo.get())) {
+                LOG(ERROR) << "decode file info fail";
+                return false;
+            }
+            std::string key = NameSpaceStorageCodec::EncodeFileStoreKey(
+                fileInfo->parentid(), fileInfo->filename());
+            files.emplace(std::move(key), std::move(fileInfo));
+        }
+        listKey = lastKey;
+    } while (values.size() >= kLoadFileBundle);
+
+    size_t fileNum = files.size();
+    {
+        WriteLockGuard guard(filesLock_);
+        files_.swap(files);
+    }
+    syncedRevision_.store(revision);
+    lastSyncTimeMs_.store(startMs);
+    LOG(INFO) << "load namespace follower cache ok, file num = "
+              << fileNum << ", revision = " << revision;
+    return true;
+}
+
+bool NameSpaceFollowerCache::SyncOnce() {
+    uint64_t startMs = TimeUtility::GetTimeofDayMs();
+    int64_t currentRevision;
+    int res = client_->GetCurrentRevision(&currentRevision);
+    if (res != EtcdErrCode::EtcdOK) {
+        LOG(WARNING) << "get current revision fail, errCode: " << res;
+        return false;
+    }
+
+    // catch up with the current revision, or wait for new changes
+    // if already caught up
+    std::vector<WatchEvent> events;
+    do {
+        int64_t startRevision = syncedRevision_.load() + 1;
+        res = client_->WatchWithPrefix(FILEINFOKEYPREFIX, startRevision,
+                                       option_.watchTimeoutMs, &events);
+        if (res == EtcdErrCode::EtcdWatchTimeout) {
+            if (startRevision > currentRevision) {
+                // caught up and no new change
+                break;
+            }
+            // history may still be on the way, only skip to the current
+            // revision if files in etcd did not change
+            bool changed;
+            res = FilesChanged(startRevision, currentRevision, &changed);
+            if (res == EtcdErrCode::EtcdOK && !changed) {
+                syncedRevision_.store(currentRevision);
+                break;
+            }
+        }
+
+        if (res == EtcdErrCode::EtcdOutOfRange) {
+            LOG(WARNING) << "revision " << startRevision
+                         << " has been compacted, reload namespace cache";
+            return Load();
+        } else if (res != EtcdErrCode::EtcdOK) {
+            LOG(WARNING) << "watch file keyspace from revision "
+                         << startRevision << " fail, errCode: " << res;
+            return false;
+        } else if (events.empty()) {
+            // files changed but the watch has not caught up yet
+            LOG(WARNING) << "no change watched from revision "
+                         << startRevision << " in "
+                         << option_.watchTimeoutMs
+                         << "ms, but files changed before revision "
+                         << currentRevision;
+            return false;
+        }
+
+        ApplyEvents(events);
+        syncedRevision_.store(events.back().revision);
+    } while (syncedRevision_.load() < currentRevision && running_.load());
+
+    if (syncedRevision_.load() >= currentRevision) {
+        // all changes before startMs are applied
+        lastSyncTimeMs_.store(startMs);
+    }
+    return true;
+}
+
+int NameSpaceFollowerCache::FilesChanged(int64_t startRevision,
+                                         int64_t endRevision,
+                                         bool *changed) {
+    // any file put in [startRevision, endRevision] is still there or has
+    // been deleted, so files are unchanged if no file is modified in this
+    // range and the number of files stays the same
+    int64_t modified, before, after;
+    int res = client_->CountWithRevision(FILEINFOKEYPREFIX, FILEINFOKEYEND,
+        endRevision, startRevision, &modified);
+    if (res != EtcdErrCode::EtcdOK) {
+        return res;
+    }
+    if (modified > 0) {
+        *changed = true;
+        return EtcdErrCode::EtcdOK;
+    }
+
+    res = client_->CountWithRevision(FILEINFOKEYPREFIX, FILEINFOKEYEND,
+        startRevision - 1, 0, &before);
+    if (res != EtcdErrCode::EtcdOK) {
+        return res;
+    }
+    res = client_->CountWithRevision(FILEINFOKEYPREFIX, FILEINFOKEYEND,
+        endRevision, 0, &after);
+    if (res != EtcdErrCode::EtcdOK) {
+        return res;
+    }
+    *changed = (before != after);
+    return EtcdErrCode::EtcdOK;
+}
+
+void NameSpaceFollowerCache::SyncLoop() {
+    while (running_.load()) {
+        if (!SyncOnce()) {
+            sleeper_.wait_for(
+                std::chrono::milliseconds(option_.retryIntervalMs));
+        }
+    }
+}
+
+void NameSpaceFollowerCache::ApplyEvents(
+    const std::vector<WatchEvent> &events) {
+    if (events.empty()) {
+        return;
+    }
+
+    WriteLockGuard guard(filesLock_);
+    for (const auto &event : events) {
+        if (event.type == OpType::OpDelete) {
+            files_.erase(event.key);
+            continue;
+        }
+
+        auto fileInfo = std::make_shared<FileInfo>();
+        if (!NameSpaceStorageCodec::DecodeFileInfo(event.value,
+                                                   fileInfo.get())) {
+            LOG(ERROR) << "decode file info fail, revision = "
+                       << event.revision;
+            files_.erase(event.key);
+            continue;
+        }
+        files_[event.key] = std::move(fileInfo);
+    }
+}
+
+StoreStatus NameSpaceFollowerCache::GetFile(InodeID parentId,
+                                            const std::string &fileName,
+                                            FileInfo *fileInfo) const {
+    std::shared_ptr<const FileInfo> out;
+    StoreStatus ret = GetFile(parentId, fileName, &out);
+    if (ret == StoreStatus::OK) {
+        fileInfo->CopyFrom(*out);
+    }
+    return ret;
+}
+
+StoreStatus NameSpaceFollowerCache::GetFile(InodeID parentId,
+    const std::string &fileName,
+    std::shared_ptr<const FileInfo> *fileInfo) const {
+    std::string key =
+        NameSpaceStorageCodec::EncodeFileStoreKey(parentId, fileName);
+    ReadLockGuard guard(filesLock_);
+    auto iter = files_.find(key);
+    if (iter == files_.end()) {
+        return StoreStatus::KeyNotExist;
+    }
+    *fileInfo = iter->second;
+    return StoreStatus::OK;
+}
+
+StoreStatus NameSpaceFollowerCache::ListFile(InodeID startId, InodeID endId,
+    std::vector<FileInfo> *files) const {
+    std::string startKey =
+        NameSpaceStorageCodec::EncodeFileStoreKey(startId, "");
+    std::string endKey =
+        NameSpaceStorageCodec::EncodeFileStoreKey(endId, "");
+    ReadLockGuard guard(filesLock_);
+    auto end = files_.lower_bound(endKey);
+    for (auto iter = files_.lower_bound(startKey); iter != end; ++iter) {
+        files->emplace_back(*iter->second);
+    }
+    return StoreStatus::OK;
+}
+
+StoreStatus NameSpaceFollowerCache::GetSegment(InodeID id, uint64_t offset,
+    PageFileSegment *segment) const {
+    std::string key = NameSpaceStorageCodec::EncodeSegmentStoreKey(id, offset);
+    std::string out;
+    int res = client_->Get(key, &out);
+    if (res == EtcdErrCode::EtcdKeyNotExist) {
+        return StoreStatus::KeyNotExist;
+    } else if (res != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "get segment fail, inode id = " << id
+                   << ", offset = " << offset << ", errCode: " << res;
+        return StoreStatus::InternalError;
+    }
+
+    if (!NameSpaceStorageCodec::DecodeSegment(out, segment)) {
+        LOG(ERROR) << "decode segment fail, inode id = " << id
+                   << ", offset = " << offset;
+        return StoreStatus::InternalError;
+    }
+    return StoreStatus::OK;
+}
+
+bool NameSpaceFollowerCache::IsFresh() const {
+    uint64_t lastSyncTimeMs = lastSyncTimeMs_.load();
+    uint64_t now = TimeUtility::GetTimeofDayMs();
+    return lastSyncTimeMs != 0 &&
+           now - lastSyncTimeMs <= option_.maxStalenessMs;
+}
+
+StoreStatus NameSpaceFollowerStorage::GetFile(InodeID id,
+    const std::string &filename, FileInfo *fileInfo) {
+    return cache_->GetFile(id, filename, fileInfo);
+}
+
+StoreStatus NameSpaceFollowerStorage::GetFile(InodeID id,
+    const std::string &filename, std::shared_ptr<const FileInfo> *fileInfo) {
+    return cache_->GetFile(id, filename, fileInfo);
+}
+
+StoreStatus NameSpaceFollowerStorage::ListFile(InodeID startid,
+    InodeID endid, std::vector<FileInfo> *files) {
+    return cache_->ListFile(startid, endid, files);
+}
+
+StoreStatus NameSpaceFollowerStorage::GetSegment(InodeID id, uint64_t off,
+    PageFileSegment *segment) {
+    return cache_->GetSegment(id, off, segment);
+}
+
+// the storage is read-only, and only files and segments are readable
+
+StoreStatus NameSpaceFollowerStorage::PutFile(const FileInfo &fileInfo) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::DeleteFile(InodeID id,
+    const std::string &filename) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::DeleteSnapshotFile(InodeID id,
+    const std::string &filename) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::RenameFile(const FileInfo &oldfileInfo,
+    const FileInfo &newfileInfo) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::ReplaceFileAndRecycleOldFile(
+    const FileInfo &oldFInfo, const FileInfo &newFInfo,
+    const FileInfo &conflictFInfo, const FileInfo &recycleFInfo) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::MoveFileToRecycle(
+    const FileInfo &originFileInfo, const FileInfo &recycleFileInfo) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::ListSegment(InodeID id,
+    std::vector<PageFileSegment> *segments) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::ListSegmentInRange(InodeID id,
+    uint64_t startOffset, uint64_t endOffset,
+    std::vector<PageFileSegment> *segments) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::ListSnapshotFile(InodeID startid,
+    InodeID endid, std::vector<FileInfo> *files) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::PutSegment(InodeID id, uint64_t off,
+    const PageFileSegment *segment, int64_t *revision) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::PutSegments(InodeID id,
+    const std::vector<PageFileSegment> &segments, int64_t *revision) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::DeleteSegment(InodeID id, uint64_t off,
+    int64_t *revision) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::DiscardSegment(const FileInfo &fileInfo,
+    const PageFileSegment &segment) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::CleanDiscardSegment(uint64_t segmentSize,
+    const std::string &key, int64_t *revision) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::ListDiscardSegment(
+    std::map<std::string, DiscardSegmentInfo> *out) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::SnapShotFile(
+    const FileInfo *originalFileInfo, const FileInfo *snapshotFileInfo) {
+    return StoreStatus::InternalError;
+}
+
+StoreStatus NameSpaceFollowerStorage::LoadSnapShotFile(
+    std::vector<FileInfo> *snapShotFiles) {
+    return StoreStatus::InternalError;
+}
+
+}  // namespace mds
+}  // namespace curve
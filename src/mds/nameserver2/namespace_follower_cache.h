@@ -0,0 +1,246 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#ifndef SRC_MDS_NAMESERVER2_NAMESPACE_FOLLOWER_CACHE_H_
+#define SRC_MDS_NAMESERVER2_NAMESPACE_FOLLOWER_CACHE_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "proto/nameserver2.pb.h"
+#include "src/common/concurrent/concurrent.h"
+#include "src/common/concurrent/rw_lock.h"
+#include "src/common/interruptible_sleeper.h"
+#include "src/kvstorageclient/etcd_client.h"
+#include "src/mds/common/mds_define.h"
+#include "src/mds/nameserver2/namespace_storage.h"
+
+namespace curve {
+namespace mds {
+
+using ::curve::kvstorage::EtcdClientImp;
+using ::curve::kvstorage::WatchEvent;
+
+struct FollowerReadOption {
+    // whether serve read-only namespace rpcs on every mds
+    bool enable = false;
+    // address of the read-only rpc server
+    std::string listenAddr;
+    // max time of one etcd watch round
+    uint32_t watchTimeoutMs = 1000;
+    // reads are refused if the cache is not confirmed to be in sync
+    // with etcd within this time
+    uint32_t maxStalenessMs = 3000;
+    // interval to retry after watch or reload fails
+    uint32_t retryIntervalMs = 1000;
+};
+
+/**
+ * NameSpaceFollowerCache keeps all file infos in memory and in sync with
+ * etcd, so mds followers can serve read-only namespace rpcs.
+ *
+ * It loads the whole file keyspace at a revision, then watches changes
+ * after that revision. If the watched revision has been compacted, the
+ * keyspace is loaded again. Segments are not cached because of their
+ * number, they are read from etcd directly.
+ */
+class NameSpaceFollowerCache {
+ public:
+    NameSpaceFollowerCache(std::shared_ptr<EtcdClientImp> client,
+                           const FollowerReadOption &option);
+
+    ~NameSpaceFollowerCache();
+
+    /**
+     * @brief load file infos from etcd
+     *
+     * @return true if success
+     */
+    bool Init();
+
+    /**
+     * @brief start the thread syncing changes from etcd
+     */
+    void Start();
+
+    void Stop();
+
+    StoreStatus GetFile(InodeID parentId, const std::string &fileName,
+                        FileInfo *fileInfo) const;
+
+    /**
+     * @brief get the cached file info without copying it,
+     *        the returned file info is shared and must not be modified
+     */
+    StoreStatus GetFile(InodeID parentId, const std::string &fileName,
+                        std::shared_ptr<const FileInfo> *fileInfo) const;
+
+    /**
+     * @brief list files whose parent id is in [startId, endId)
+     */
+    StoreStatus ListFile(InodeID startId, InodeID endId,
+                         std::vector<FileInfo> *files) const;
+
+    StoreStatus GetSegment(InodeID id, uint64_t offset,
+                           PageFileSegment *segment) const;
+
+    /**
+     * @brief whether the cache is confirmed to be in sync with etcd
+     *        within maxStalenessMs
+     */
+    bool IsFresh() const;
+
+    // revision that all changes before it have been applied
+    int64_t GetSyncedRevision() const {
+        return syncedRevision_.load();
+    }
+
+    /**
+     * @brief apply changes until the revision when it is called,
+     *        wait watchTimeoutMs for changes if nothing changed
+     *
+     * @return true if success
+     */
+    bool SyncOnce();
+
+ private:
+    bool Load();
+
+    void SyncLoop();
+
+    void ApplyEvents(const std::vector<WatchEvent> &events);
+
+    /**
+     * @brief check whether files in etcd at endRevision differ from
+     *        those at startRevision - 1
+     *
+     * @param[out] changed true if files changed
+     * @return EtcdErrCode::EtcdOK success, others fail
+     */
+    int FilesChanged(int64_t startRevision, int64_t endRevision,
+                     bool *changed);
+
+ private:
+    std::shared_ptr<EtcdClientImp> client_;
+    const FollowerReadOption option_;
+
+    // store key -> file info, file infos are immutable once inserted,
+    // so readers can share them after releasing filesLock_
+    std::map<std::string, std::shared_ptr<const FileInfo>> files_;
+    mutable ::curve::common::RWLock filesLock_;
+
+    std::atomic<int64_t> syncedRevision_;
+    // time when the cache is confirmed to be in sync with etcd
+    std::atomic<uint64_t> lastSyncTimeMs_;
+
+    std::atomic<bool> running_;
+    ::curve::common::Thread syncThread_;
+    ::curve::common::InterruptibleSleeper sleeper_;
+};
+
+/**
+ * NameSpaceFollowerStorage is a read-only NameServerStorage backed by
+ * NameSpaceFollowerCache, so CurveFS read methods can run on followers.
+ * Files and segments can be read, other operations fail with
+ * StoreStatus::InternalError.
+ */
+class NameSpaceFollowerStorage : public NameServerStorage {
+ public:
+    explicit NameSpaceFollowerStorage(
+        std::shared_ptr<NameSpaceFollowerCache> cache)
+        : cache_(cache) {}
+
+    StoreStatus PutFile(const FileInfo &fileInfo) override;
+
+    StoreStatus GetFile(InodeID id, const std::string &filename,
+                        FileInfo *fileInfo) override;
+
+    StoreStatus GetFile(InodeID id, const std::string &filename,
+                        std::shared_ptr<const FileInfo> *fileInfo) override;
+
+    StoreStatus DeleteFile(InodeID id, const std::string &filename) override;
+
+    StoreStatus DeleteSnapshotFile(InodeID id,
+                                   const std::string &filename) override;
+
+    StoreStatus RenameFile(const FileInfo &oldfileInfo,
+                           const FileInfo &newfileInfo) override;
+
+    StoreStatus ReplaceFileAndRecycleOldFile(const FileInfo &oldFInfo,
+        const FileInfo &newFInfo, const FileInfo &conflictFInfo,
+        const FileInfo &recycleFInfo) override;
+
+    StoreStatus MoveFileToRecycle(const FileInfo &originFileInfo,
+                                  const FileInfo &recycleFileInfo) override;
+
+    StoreStatus ListFile(InodeID startid, InodeID endid,
+                         std::vector<FileInfo> *files) override;
+
+    StoreStatus ListSegment(InodeID id,
+                            std::vector<PageFileSegment> *segments) override;
+
+    StoreStatus ListSegmentInRange(InodeID id, uint64_t startOffset,
+        uint64_t endOffset, std::vector<PageFileSegment> *segments) override;
+
+    StoreStatus ListSnapshotFile(InodeID startid, InodeID endid,
+                                 std::vector<FileInfo> *files) override;
+
+    StoreStatus GetSegment(InodeID id, uint64_t off,
+                           PageFileSegment *segment) override;
+
+    StoreStatus PutSegment(InodeID id, uint64_t off,
+                           const PageFileSegment *segment,
+                           int64_t *revision) override;
+
+    StoreStatus PutSegments(InodeID id,
+                            const std::vector<PageFileSegment> &segments,
+                            int64_t *revision) override;
+
+    StoreStatus DeleteSegment(InodeID id, uint64_t off,
+                              int64_t *revision) override;
+
+    StoreStatus DiscardSegment(const FileInfo &fileInfo,
+                               const PageFileSegment &segment) override;
+
+    StoreStatus CleanDiscardSegment(uint64_t segmentSize,
+                                    const std::string &key,
+                                    int64_t *revision) override;
+
+    StoreStatus ListDiscardSegment(
+        std::map<std::string, DiscardSegmentInfo> *out) override;
+
+    StoreStatus SnapShotFile(const FileInfo *originalFileInfo,
+                             const FileInfo *snapshotFileInfo) override;
+
+    StoreStatus LoadSnapShotFile(std::vector<FileInfo> *snapShotFiles) override;
+
+ private:
+    std::shared_ptr<NameSpaceFollowerCache> cache_;
+};
+
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_NAMESERVER2_NAMESPACE_FOLLOWER_CACHE_H_
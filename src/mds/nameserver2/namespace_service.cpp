@@ -110,6 +110,10 @@ void NameSpaceService::CreateFile(::google::protobuf::RpcController* controller,
         LOG(INFO) << "logid = " << cntl->log_id()
                   << ", CreateFile ok, filename = " << request->filename()
                   << ", cost " << expiredTime.ExpiredMs() << " ms";
+        if (request->preallocate() &&
+            request->filetype() == FileType::INODE_PAGEFILE) {
+            AsyncPreallocateSegment(request->filename(), 0, 0);
+        }
     }
     return;
 }
@@ -565,6 +569,224 @@ void NameSpaceService::DeAllocateSegment(
     return;
 }
 
+void NameSpaceService::ListSegment(
+    ::google::protobuf::RpcController* controller,
+    const ::curve::mds::ListSegmentRequest* request,
+    ::curve::mds::ListSegmentResponse* response,
+    ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    butil::Timer timer;
+    timer.start();
+
+    if (!isPathValid(request->filename())) {
+        response->set_statuscode(StatusCode::kParaError);
+        LOG(ERROR) << "logid = " << cntl->log_id()
+                   << ", ListSegment request path is invalid, "
+                   << request->ShortDebugString();
+        return;
+    }
+
+    LOG(INFO) << "logid = " << cntl->log_id() << ", ListSegment request, "
+              << request->ShortDebugString();
+
+    FileReadLockGuard guard(fileLockManager_, request->filename());
+
+    std::string signature;
+    if (request->has_signature()) {
+        signature = request->signature();
+    }
+
+    StatusCode retCode;
+    retCode = kCurveFS.CheckFileOwner(request->filename(), request->owner(),
+                                      signature, request->date());
+    if (retCode != StatusCode::kOK) {
+        response->set_statuscode(retCode);
+        if (google::ERROR != GetMdsLogLevel(retCode)) {
+            LOG(WARNING) << "logid = " << cntl->log_id()
+                         << ", ListSegment CheckFileOwner fail, "
+                         << request->ShortDebugString()
+                         << ", retCode = " << retCode;
+        } else {
+            LOG(ERROR) << "logid = " << cntl->log_id()
+                       << ", ListSegment CheckFileOwner fail, "
+                       << request->ShortDebugString()
+                       << ", retCode = " << retCode;
+        }
+
+        return;
+    }
+
+    uint64_t offset = request->has_offset() ? request->offset() : 0;
+    uint64_t length = request->has_length() ? request->length() : 0;
+    uint32_t limit = kListSegmentMaxLimit;
+    if (request->has_limit() && request->limit() > 0 &&
+        request->limit() < limit) {
+        limit = request->limit();
+    }
+    std::vector<PageFileSegment> segments;
+    uint64_t nextOffset = 0;
+    retCode = kCurveFS.ListSegment(request->filename(), offset, length,
+                                   limit, &segments, &nextOffset);
+
+    timer.stop();
+    if (retCode != StatusCode::kOK) {
+        response->set_statuscode(retCode);
+        if (google::ERROR != GetMdsLogLevel(retCode)) {
+            LOG(WARNING) << "logid = " << cntl->log_id()
+                         << ", ListSegment fail, "
+                         << request->ShortDebugString()
+                         << ", statusCode = " << retCode
+                         << ", StatusCode_Name = " << StatusCode_Name(retCode)
+                         << ", cost " << timer.m_elapsed(0.0) << " ms";
+        } else {
+            LOG(ERROR) << "logid = " << cntl->log_id()
+                       << ", ListSegment fail, "
+                       << request->ShortDebugString()
+                       << ", statusCode = " << retCode
+                       << ", StatusCode_Name = " << StatusCode_Name(retCode)
+                       << ", cost " << timer.m_elapsed(0.0) << " ms";
+        }
+    } else {
+        response->set_statuscode(StatusCode::kOK);
+        response->set_nextoffset(nextOffset);
+        for (auto& segment : segments) {
+            response->add_pagefilesegments()->Swap(&segment);
+        }
+        LOG(INFO) << "logid = " << cntl->log_id() << ", ListSegment ok, "
+                  << "filename = " << request->filename()
+                  << ", segment num = " << response->pagefilesegments_size()
+                  << ", next offset = " << nextOffset
+                  << ", cost " << timer.m_elapsed(0.0) << " ms";
+    }
+
+    return;
+}
+
+void NameSpaceService::PreallocateSegment(
+    ::google::protobuf::RpcController* controller,
+    const ::curve::mds::PreallocateSegmentRequest* request,
+    ::curve::mds::PreallocateSegmentResponse* response,
+    ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    ExpiredTime expiredTime;
+
+    if (!isPathValid(request->filename())) {
+        response->set_statuscode(StatusCode::kParaError);
+        LOG(ERROR) << "logid = " << cntl->log_id()
+                   << ", PreallocateSegment request path is invalid, "
+                   << request->ShortDebugString();
+        return;
+    }
+
+    LOG(INFO) << "logid = " << cntl->log_id()
+              << ", PreallocateSegment request, "
+              << request->ShortDebugString();
+
+    StatusCode retCode;
+    {
+        FileReadLockGuard guard(fileLockManager_, request->filename());
+
+        std::string signature;
+        if (request->has_signature()) {
+            signature = request->signature();
+        }
+
+        retCode = kCurveFS.CheckFileOwner(request->filename(),
+                                          request->owner(), signature,
+                                          request->date());
+        if (retCode == StatusCode::kOK) {
+            FileInfo fileInfo;
+            retCode = kCurveFS.GetFileInfo(request->filename(), &fileInfo);
+            // reject range beyond the file before computing its end,
+            // offset + length may overflow
+            if (retCode == StatusCode::kOK &&
+                (fileInfo.filetype() != FileType::INODE_PAGEFILE ||
+                 request->offset() % fileInfo.segmentsize() != 0 ||
+                 request->offset() > fileInfo.length() ||
+                 request->length() >
+                    fileInfo.length() - request->offset())) {
+                retCode = StatusCode::kParaError;
+            }
+        }
+    }
+
+    if (retCode != StatusCode::kOK) {
+        response->set_statuscode(retCode);
+        if (google::ERROR != GetMdsLogLevel(retCode)) {
+            LOG(WARNING) << "logid = " << cntl->log_id()
+                         << ", PreallocateSegment fail, "
+                         << request->ShortDebugString()
+                         << ", statusCode = " << retCode
+                         << ", StatusCode_Name = " << StatusCode_Name(retCode)
+                         << ", cost " << expiredTime.ExpiredMs() << " ms";
+        } else {
+            LOG(ERROR) << "logid = " << cntl->log_id()
+                       << ", PreallocateSegment fail, "
+                       << request->ShortDebugString()
+                       << ", statusCode = " << retCode
+                       << ", StatusCode_Name = " << StatusCode_Name(retCode)
+                       << ", cost " << expiredTime.ExpiredMs() << " ms";
+        }
+        return;
+    }
+
+    AsyncPreallocateSegment(request->filename(), request->offset(),
+                            request->length());
+    response->set_statuscode(StatusCode::kOK);
+    LOG(INFO) << "logid = " << cntl->log_id()
+              << ", PreallocateSegment submitted, filename = "
+              << request->filename()
+              << ", cost " << expiredTime.ExpiredMs() << " ms";
+    return;
+}
+
+void NameSpaceService::AsyncPreallocateSegment(const std::string& filename,
+                                               uint64_t offset,
+                                               uint64_t length) {
+    preallocateWorkers_.Enqueue(&NameSpaceService::DoPreallocateSegment,
+                                this, filename, offset, length);
+}
+
+void NameSpaceService::DoPreallocateSegment(const std::string& filename,
+                                            uint64_t offset,
+                                            uint64_t length) {
+    // track the remaining length instead of the end offset,
+    // so neither offset + length nor end - offset can wrap around
+    uint64_t remain = length;
+    while (!stopPreallocate_) {
+        uint64_t nextOffset = offset;
+        StatusCode retCode;
+        {
+            FileWriteLockGuard guard(fileLockManager_, filename);
+            retCode = kCurveFS.PreallocateSegment(
+                filename, offset, remain, kPreallocateSegmentBatch,
+                &nextOffset);
+        }
+
+        if (retCode != StatusCode::kOK) {
+            LOG(WARNING) << "preallocate segment fail, filename = "
+                         << filename << ", offset = " << offset
+                         << ", statusCode = " << retCode;
+            return;
+        }
+
+        // no more segments to allocate
+        if (nextOffset <= offset ||
+            (length != 0 && nextOffset - offset >= remain)) {
+            break;
+        }
+        if (length != 0) {
+            remain -= nextOffset - offset;
+        }
+        offset = nextOffset;
+    }
+
+    LOG(INFO) << "preallocate segment done, filename = " << filename
+              << ", offset = " << offset << ", length = " << length;
+}
+
 void NameSpaceService::RenameFile(::google::protobuf::RpcController* controller,
                          const ::curve::mds::RenameFileRequest* request,
                          ::curve::mds::RenameFileResponse* response,
@@ -728,6 +950,21 @@ void NameSpaceService::ExtendFile(::google::protobuf::RpcController* controller,
         return;
     }
 
+    // file lock is held, so the length is not changed by others before extend
+    FileInfo oldFileInfo;
+    if (request->preallocate()) {
+        retCode = kCurveFS.GetFileInfo(request->filename(), &oldFileInfo);
+        if (retCode != StatusCode::kOK) {
+            response->set_statuscode(retCode);
+            LOG(WARNING) << "logid = " << cntl->log_id()
+                         << ", ExtendFile get file info fail, filename = "
+                         << request->filename()
+                         << ", statusCode = " << retCode
+                         << ", StatusCode_Name = " << StatusCode_Name(retCode);
+            return;
+        }
+    }
+
     retCode = kCurveFS.ExtendFile(request->filename(),
            request->newsize());
     if (retCode != StatusCode::kOK)  {
@@ -755,6 +992,12 @@ void NameSpaceService::ExtendFile(::google::protobuf::RpcController* controller,
                   << ", ExtendFile ok, filename = " << request->filename()
                   << ", newsize = " << request->newsize() << ", cost "
                   << expiredTime.ExpiredMs() << " ms";
+        if (request->preallocate() &&
+            request->newsize() > oldFileInfo.length()) {
+            // only the extended range needs to be allocated
+            AsyncPreallocateSegment(request->filename(), oldFileInfo.length(),
+                request->newsize() - oldFileInfo.length());
+        }
     }
 
     return;
@@ -25,8 +25,10 @@
 
 #include <brpc/closure_guard.h>
 #include <brpc/controller.h>
+#include <atomic>
 #include <string>
 #include "proto/nameserver2.pb.h"
+#include "src/common/concurrent/task_thread_pool.h"
 #include "src/mds/nameserver2/file_lock.h"
 
 namespace curve {
@@ -65,11 +67,15 @@ uint32_t GetMdsLogLevel(StatusCode code);
 
 class NameSpaceService: public CurveFSService {
  public:
-    explicit NameSpaceService(FileLockManager *fileLockManager) {
-        fileLockManager_ = fileLockManager;
+    explicit NameSpaceService(FileLockManager *fileLockManager)
+        : fileLockManager_(fileLockManager), stopPreallocate_(false) {
+        preallocateWorkers_.Start(kPreallocateThreadNum);
     }
 
-    virtual ~NameSpaceService() {}
+    virtual ~NameSpaceService() {
+        stopPreallocate_ = true;
+        preallocateWorkers_.Stop();
+    }
 
     void CreateFile(::google::protobuf::RpcController* controller,
                        const ::curve::mds::CreateFileRequest* request,
@@ -102,6 +108,12 @@ class NameSpaceService: public CurveFSService {
         ::curve::mds::DeAllocateSegmentResponse* response,
         ::google::protobuf::Closure* done) override;
 
+    void ListSegment(
+        ::google::protobuf::RpcController* controller,
+        const ::curve::mds::ListSegmentRequest* request,
+        ::curve::mds::ListSegmentResponse* response,
+        ::google::protobuf::Closure* done) override;
+
     void RenameFile(::google::protobuf::RpcController* controller,
                        const ::curve::mds::RenameFileRequest* request,
                        ::curve::mds::RenameFileResponse* response,
@@ -192,8 +204,38 @@ class NameSpaceService: public CurveFSService {
         ::curve::mds::UpdateFileThrottleParamsResponse* response,
         ::google::protobuf::Closure* done) override;
 
+    void PreallocateSegment(
+        ::google::protobuf::RpcController* controller,
+        const ::curve::mds::PreallocateSegmentRequest* request,
+        ::curve::mds::PreallocateSegmentResponse* response,
+        ::google::protobuf::Closure* done) override;
+
+ private:
+    /**
+     *  @brief preallocate segments of file in [offset, offset + length) in
+     *         background, the file lock is taken for every batch of segments,
+     *         so client io on the file is only blocked for a short while
+     *  @param filename
+     *  @param offset start offset
+     *  @param length preallocate length, 0 means up to the end of the file
+     */
+    void AsyncPreallocateSegment(const std::string& filename,
+                                 uint64_t offset, uint64_t length);
+
+    void DoPreallocateSegment(const std::string& filename,
+                              uint64_t offset, uint64_t length);
+
  private:
+    // number of segments allocated and stored in one transaction
+    static const uint32_t kPreallocateSegmentBatch = 32;
+    static const int kPreallocateThreadNum = 1;
+    // max number of segments returned by one ListSegment call
+    static const uint32_t kListSegmentMaxLimit = 1024;
+
     FileLockManager *fileLockManager_;
+
+    std::atomic<bool> stopPreallocate_;
+    ::curve::common::TaskThreadPool<> preallocateWorkers_;
 };
 }  // namespace mds
 }  // namespace curve
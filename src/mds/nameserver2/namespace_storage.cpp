@@ -21,6 +21,7 @@
  */
 
 #include <glog/logging.h>
+#include <memory>
 #include <utility>
 #include "src/mds/nameserver2/namespace_storage.h"
 #include "src/mds/nameserver2/helper/namespace_helper.h"
@@ -39,9 +40,30 @@ std::ostream& operator << (std::ostream & os, StoreStatus &s) {
     return os;
 }
 
+StoreStatus NameServerStorage::GetFile(InodeID id,
+    const std::string &filename, std::shared_ptr<const FileInfo> *fileInfo) {
+    auto out = std::make_shared<FileInfo>();
+    StoreStatus ret = GetFile(id, filename, out.get());
+    if (ret == StoreStatus::OK) {
+        *fileInfo = std::move(out);
+    }
+    return ret;
+}
+
+StoreStatus NameServerStorage::GetSegment(InodeID id, uint64_t off,
+    std::shared_ptr<const PageFileSegment> *segment) {
+    auto out = std::make_shared<PageFileSegment>();
+    StoreStatus ret = GetSegment(id, off, out.get());
+    if (ret == StoreStatus::OK) {
+        *segment = std::move(out);
+    }
+    return ret;
+}
+
 NameServerStorageImp::NameServerStorageImp(
-    std::shared_ptr<KVStorageClient> client, std::shared_ptr<Cache> cache)
-    : client_(client), cache_(cache), discardMetric_() {}
+    std::shared_ptr<KVStorageClient> client, std::shared_ptr<Cache> cache,
+    std::shared_ptr<EtcdWriteBatcher> batcher)
+    : cache_(cache), client_(client), batcher_(batcher), discardMetric_() {}
 
 StoreStatus NameServerStorageImp::PutFile(const FileInfo &fileInfo) {
     std::string storeKey;
@@ -59,13 +81,13 @@ StoreStatus NameServerStorageImp::PutFile(const FileInfo &fileInfo) {
         return StoreStatus::InternalError;
     }
 
-    int errCode = client_->Put(storeKey, encodeFileInfo);
+    int errCode = PutKV(storeKey, encodeFileInfo, nullptr);
     if (errCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "put file: [" << fileInfo.filename() << "] err: "
                     << errCode;
     } else {
         // update to cache
-        cache_->Put(storeKey, encodeFileInfo);
+        cache_->Put(storeKey, std::make_shared<const FileInfo>(fileInfo));
     }
 
     return getErrorCode(errCode);
@@ -74,6 +96,16 @@ StoreStatus NameServerStorageImp::PutFile(const FileInfo &fileInfo) {
 StoreStatus NameServerStorageImp::GetFile(InodeID parentid,
                                           const std::string &filename,
                                           FileInfo *fileInfo) {
+    std::shared_ptr<const FileInfo> out;
+    StoreStatus ret = GetFile(parentid, filename, &out);
+    if (ret == StoreStatus::OK) {
+        fileInfo->CopyFrom(*out);
+    }
+    return ret;
+}
+
+StoreStatus NameServerStorageImp::GetFile(InodeID parentid,
+    const std::string &filename, std::shared_ptr<const FileInfo> *fileInfo) {
     std::string storeKey;
     if (GetStoreKey(FileType::INODE_PAGEFILE, parentid, filename, &storeKey)
         != StoreStatus::OK) {
@@ -81,19 +113,28 @@ StoreStatus NameServerStorageImp::GetFile(InodeID parentid,
         return StoreStatus::InternalError;
     }
 
-    int errCode = EtcdErrCode::EtcdOK;
-    std::string out;
-    if (!cache_->Get(storeKey, &out)) {
-        errCode = client_->Get(storeKey, &out);
-
-        if (errCode == EtcdErrCode::EtcdOK) {
-            cache_->Put(storeKey, out);
+    // cached value is already decoded and immutable, share it without copy,
+    // file store key is always mapped to a FileInfo, or nullptr which is
+    // a negative entry indicating the file does not exist
+    CacheValue cached;
+    if (cache_->Get(storeKey, &cached)) {
+        if (cached == nullptr) {
+            return StoreStatus::KeyNotExist;
         }
+        *fileInfo = std::static_pointer_cast<const FileInfo>(cached);
+        return StoreStatus::OK;
     }
 
+    uint64_t revision = cache_->GetRevision(storeKey);
+    std::string out;
+    int errCode = client_->Get(storeKey, &out);
     if (errCode == EtcdErrCode::EtcdOK) {
-        bool decodeOK = NameSpaceStorageCodec::DecodeFileInfo(out, fileInfo);
+        auto decoded = std::make_shared<FileInfo>();
+        bool decodeOK = NameSpaceStorageCodec::DecodeFileInfo(out,
+                                                              decoded.get());
         if (decodeOK) {
+            cache_->PutIfRevisionMatch(storeKey, decoded, revision);
+            *fileInfo = std::move(decoded);
             return StoreStatus::OK;
         } else {
             LOG(ERROR) << "decode info error. parentid: " << parentid
@@ -103,6 +144,10 @@ StoreStatus NameServerStorageImp::GetFile(InodeID parentid,
     } else if (errCode == EtcdErrCode::EtcdKeyNotExist) {
         LOG(INFO) << "file not exist. parentid: " << parentid
                   << ", filename: " << filename;
+        // cache the negative entry, it is overwritten by PutFile/RenameFile
+        // when the file is created, so lookups of missing paths don't go
+        // to etcd every time
+        cache_->PutIfRevisionMatch(storeKey, nullptr, revision);
     } else {
         LOG(ERROR) << "get file err: " << errCode << "."
                    << " parentid: " << parentid << ", filename: " << filename;
@@ -208,7 +253,7 @@ StoreStatus NameServerStorageImp::RenameFile(const FileInfo &oldFInfo,
                    << errCode;
     } else {
         // update to cache at last
-        cache_->Put(newStoreKey, encodeNewFileInfo);
+        cache_->Put(newStoreKey, std::make_shared<const FileInfo>(newFInfo));
     }
     return getErrorCode(errCode);
 }
@@ -299,8 +344,9 @@ StoreStatus NameServerStorageImp::ReplaceFileAndRecycleOldFile(
                    << errCode;
     } else {
         // update to cache
-        cache_->Put(recycleStoreKey, encodeRecycleFInfo);
-        cache_->Put(newStoreKey, encodeNewFInfo);
+        cache_->Put(recycleStoreKey,
+                    std::make_shared<const FileInfo>(recycleFInfo));
+        cache_->Put(newStoreKey, std::make_shared<const FileInfo>(newFInfo));
     }
     return getErrorCode(errCode);
 }
@@ -356,7 +402,8 @@ StoreStatus NameServerStorageImp::MoveFileToRecycle(
                    << errCode;
     } else {
         // update to cache
-        cache_->Put(recycleFileInfoKey, encodeRecycleFInfo);
+        cache_->Put(recycleFileInfoKey,
+                    std::make_shared<const FileInfo>(recycleFileInfo));
     }
     return getErrorCode(errCode);
 }
@@ -389,6 +436,28 @@ StoreStatus NameServerStorageImp::ListSegment(InodeID id,
     std::string endStoreKey =
                 NameSpaceStorageCodec::EncodeSegmentStoreKey(id + 1, 0);
 
+    return ListSegmentInternal(startStoreKey, endStoreKey, segments);
+}
+
+StoreStatus NameServerStorageImp::ListSegmentInRange(InodeID id,
+                                    uint64_t startOffset,
+                                    uint64_t endOffset,
+                                    std::vector<PageFileSegment> *segments) {
+    if (startOffset >= endOffset) {
+        return StoreStatus::OK;
+    }
+
+    std::string startStoreKey =
+                NameSpaceStorageCodec::EncodeSegmentStoreKey(id, startOffset);
+    std::string endStoreKey =
+                NameSpaceStorageCodec::EncodeSegmentStoreKey(id, endOffset);
+
+    return ListSegmentInternal(startStoreKey, endStoreKey, segments);
+}
+
+StoreStatus NameServerStorageImp::ListSegmentInternal(
+    const std::string& startStoreKey, const std::string& endStoreKey,
+    std::vector<PageFileSegment> *segments) {
     std::vector<std::string> out;
     int errCode = client_->List(
         startStoreKey, endStoreKey, &out);
@@ -472,12 +541,56 @@ StoreStatus NameServerStorageImp::PutSegment(InodeID id,
         return StoreStatus::InternalError;
     }
 
-    int errCode = client_->PutRewithRevision(storeKey, encodeSegment, revision);
+    int errCode = PutKV(storeKey, encodeSegment, revision);
     if (errCode != EtcdErrCode::EtcdOK) {
         LOG(ERROR) << "put segment of logicalPoolId:"
                    << segment->logicalpoolid() << "err:" << errCode;
     } else {
-        cache_->Put(storeKey, encodeSegment);
+        cache_->Put(storeKey,
+                    std::make_shared<const PageFileSegment>(*segment));
+    }
+    return getErrorCode(errCode);
+}
+
+StoreStatus NameServerStorageImp::PutSegments(
+    InodeID id, const std::vector<PageFileSegment> &segments,
+    int64_t *revision) {
+    if (segments.empty()) {
+        return StoreStatus::OK;
+    }
+
+    std::vector<std::string> storeKeys;
+    std::vector<std::string> encodeSegments(segments.size());
+    storeKeys.reserve(segments.size());
+    for (size_t i = 0; i < segments.size(); i++) {
+        storeKeys.emplace_back(NameSpaceStorageCodec::EncodeSegmentStoreKey(
+            id, segments[i].startoffset()));
+        if (!NameSpaceStorageCodec::EncodeSegment(segments[i],
+                                                  &encodeSegments[i])) {
+            return StoreStatus::InternalError;
+        }
+    }
+
+    std::vector<Operation> ops;
+    ops.reserve(segments.size());
+    for (size_t i = 0; i < segments.size(); i++) {
+        ops.emplace_back(Operation{
+            OpType::OpPut,
+            const_cast<char*>(storeKeys[i].c_str()),
+            const_cast<char*>(encodeSegments[i].c_str()),
+            static_cast<int>(storeKeys[i].size()),
+            static_cast<int>(encodeSegments[i].size())});
+    }
+
+    int errCode = client_->TxnNWithRevision(ops, revision);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "put " << segments.size() << " segments of inodeid: "
+                   << id << " err: " << errCode;
+    } else {
+        for (size_t i = 0; i < segments.size(); i++) {
+            cache_->Put(storeKeys[i],
+                        std::make_shared<const PageFileSegment>(segments[i]));
+        }
     }
     return getErrorCode(errCode);
 }
@@ -485,17 +598,34 @@ StoreStatus NameServerStorageImp::PutSegment(InodeID id,
 StoreStatus NameServerStorageImp::GetSegment(InodeID id,
                                              uint64_t off,
                                              PageFileSegment *segment) {
+    std::shared_ptr<const PageFileSegment> out;
+    StoreStatus ret = GetSegment(id, off, &out);
+    if (ret == StoreStatus::OK) {
+        segment->CopyFrom(*out);
+    }
+    return ret;
+}
+
+StoreStatus NameServerStorageImp::GetSegment(InodeID id, uint64_t off,
+    std::shared_ptr<const PageFileSegment> *segment) {
     std::string storeKey =
         NameSpaceStorageCodec::EncodeSegmentStoreKey(id, off);
-    int errCode = EtcdErrCode::EtcdOK;
-    std::string out;
-    if (!cache_->Get(storeKey, &out)) {
-        errCode = client_->Get(storeKey, &out);
+    CacheValue cached;
+    if (cache_->Get(storeKey, &cached)) {
+        *segment = std::static_pointer_cast<const PageFileSegment>(cached);
+        return StoreStatus::OK;
     }
 
+    uint64_t revision = cache_->GetRevision(storeKey);
+    std::string out;
+    int errCode = client_->Get(storeKey, &out);
     if (errCode == EtcdErrCode::EtcdOK) {
-        bool decodeOK = NameSpaceStorageCodec::DecodeSegment(out, segment);
+        auto decoded = std::make_shared<PageFileSegment>();
+        bool decodeOK = NameSpaceStorageCodec::DecodeSegment(out,
+                                                             decoded.get());
         if (decodeOK) {
+            cache_->PutIfRevisionMatch(storeKey, decoded, revision);
+            *segment = std::move(decoded);
             return StoreStatus::OK;
         } else {
             LOG(ERROR) << "decode segment inodeid: " << id
@@ -515,7 +645,7 @@ StoreStatus NameServerStorageImp::DeleteSegment(
     InodeID id, uint64_t off, int64_t *revision) {
     std::string storeKey =
         NameSpaceStorageCodec::EncodeSegmentStoreKey(id, off);
-    int errCode = client_->DeleteRewithRevision(storeKey, revision);
+    int errCode = DeleteKV(storeKey, revision);
 
     // update the cache first, then update Etcd
     cache_->Remove(storeKey);
@@ -672,8 +802,10 @@ StoreStatus NameServerStorageImp::SnapShotFile(const FileInfo *originFInfo,
                    << ", fileinfo: " << originFInfo->filename() << "err";
     } else {
         // update cache at last
-        cache_->Put(originFileKey, encodeFileInfo);
-        cache_->Put(snapshotFileKey, encodeSnapshot);
+        cache_->Put(originFileKey,
+                    std::make_shared<const FileInfo>(*originFInfo));
+        cache_->Put(snapshotFileKey,
+                    std::make_shared<const FileInfo>(*snapshotFInfo));
     }
     return getErrorCode(errCode);
 }
@@ -718,6 +850,31 @@ StoreStatus NameServerStorageImp::getErrorCode(int errCode) {
     }
 }
 
+int NameServerStorageImp::PutKV(const std::string &key,
+                                const std::string &value,
+                                int64_t *revision) {
+    if (batcher_ != nullptr) {
+        return batcher_->Put(key, value, revision);
+    }
+
+    if (revision == nullptr) {
+        return client_->Put(key, value);
+    }
+    return client_->PutRewithRevision(key, value, revision);
+}
+
+int NameServerStorageImp::DeleteKV(const std::string &key,
+                                   int64_t *revision) {
+    if (batcher_ != nullptr) {
+        return batcher_->Delete(key, revision);
+    }
+
+    if (revision == nullptr) {
+        return client_->Delete(key);
+    }
+    return client_->DeleteRewithRevision(key, revision);
+}
+
 StoreStatus NameServerStorageImp::GetStoreKey(FileType filetype,
                                               InodeID id,
                                               const std::string& filename,
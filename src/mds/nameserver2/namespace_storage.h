@@ -34,6 +34,7 @@
 #include "src/mds/common/mds_define.h"
 #include "src/kvstorageclient/etcd_client.h"
 #include "src/mds/nameserver2/namespace_storage_cache.h"
+#include "src/mds/nameserver2/etcd_write_batcher.h"
 #include "src/mds/nameserver2/metric.h"
 
 namespace curve {
@@ -80,6 +81,22 @@ class NameServerStorage {
                                 const std::string &filename,
                                 FileInfo * fileInfo) = 0;
 
+    /**
+     * @brief GetFile Get metadata of the specified file without copying it,
+     *        the returned file info is shared and must not be modified.
+     *        The default implementation copies the result of the
+     *        FileInfo version.
+     *
+     * @param[in] id: Parent inode ID of the file to be obtained
+     * @param[in] filename
+     * @param[out] file info obtained
+     *
+     * @return StoreStatus: error code
+     */
+    virtual StoreStatus GetFile(InodeID id,
+                                const std::string &filename,
+                                std::shared_ptr<const FileInfo> *fileInfo);
+
     /**
      * @brief DeleteFile
      *
@@ -168,6 +185,23 @@ class NameServerStorage {
     virtual StoreStatus ListSegment(InodeID id,
                                     std::vector<PageFileSegment> *segments) = 0;
 
+    /**
+     * @brief ListSegmentInRange: Get all the segments of a file whose start
+     *                            offset is between [startOffset, endOffset)
+     *                            in one round trip
+     *
+     * @param[in] id: Inode ID of the file
+     * @param[in] startOffset: Start offset, included
+     * @param[in] endOffset: End offset, not included
+     * @param[out] segments: Segment list
+     *
+     * @return StoreStatus: error code
+     */
+    virtual StoreStatus ListSegmentInRange(InodeID id,
+                                    uint64_t startOffset,
+                                    uint64_t endOffset,
+                                    std::vector<PageFileSegment> *segments) = 0;
+
     /**
      * @brief ListSnapshotFile: Get all snapshot files between [startid, endid)
      *
@@ -194,6 +228,21 @@ class NameServerStorage {
                                     uint64_t off,
                                     PageFileSegment *segment) = 0;
 
+    /**
+     * @brief GetSegment: Obtain specified segment information without
+     *        copying it, the returned segment is shared and must not be
+     *        modified. The default implementation copies the result of
+     *        the PageFileSegment version.
+     *
+     * @param[in] id: Inode ID of the target file
+     * @param[in] off: Offset of the target segment
+     * @param[out] segment: Segment info
+     *
+     * @return StoreStatus: error code
+     */
+    virtual StoreStatus GetSegment(InodeID id, uint64_t off,
+        std::shared_ptr<const PageFileSegment> *segment);
+
     /**
      * @brief PutSegment: Store specified segment information
      *
@@ -209,6 +258,19 @@ class NameServerStorage {
                                     const PageFileSegment * segment,
                                     int64_t *revision) = 0;
 
+    /**
+     * @brief PutSegments: Store segments of a file in one transaction
+     *
+     * @param[in] id: Inode ID of the target file
+     * @param[in] segments: Segments to store, keyed by their start offset
+     * @param[out] revision: The version number of this operation
+     *
+     * @return StoreStatus: error code
+     */
+    virtual StoreStatus PutSegments(InodeID id,
+                                    const std::vector<PageFileSegment> &segments,
+                                    int64_t *revision) = 0;
+
     /**
      * @brief DeleteSegment: Delete the specified segment metadata
      *
@@ -277,8 +339,15 @@ class NameServerStorage {
 
 class NameServerStorageImp : public NameServerStorage {
  public:
-    explicit NameServerStorageImp(
-        std::shared_ptr<KVStorageClient> client, std::shared_ptr<Cache> cache);
+    /**
+     * @param[in] client underlying storage
+     * @param[in] cache namespace-meta cache
+     * @param[in] batcher if not nullptr, PutFile, PutSegment and
+     *            DeleteSegment are committed to etcd in batches
+     */
+    NameServerStorageImp(
+        std::shared_ptr<KVStorageClient> client, std::shared_ptr<Cache> cache,
+        std::shared_ptr<EtcdWriteBatcher> batcher = nullptr);
     ~NameServerStorageImp() {}
 
     StoreStatus PutFile(const FileInfo & fileInfo) override;
@@ -287,6 +356,10 @@ class NameServerStorageImp : public NameServerStorage {
                         const std::string &filename,
                         FileInfo * fileInfo) override;
 
+    StoreStatus GetFile(InodeID id,
+                        const std::string &filename,
+                        std::shared_ptr<const FileInfo> *fileInfo) override;
+
     StoreStatus DeleteFile(InodeID id,
                             const std::string &filename) override;
 
@@ -311,6 +384,11 @@ class NameServerStorageImp : public NameServerStorage {
     StoreStatus ListSegment(InodeID id,
                             std::vector<PageFileSegment> *segments) override;
 
+    StoreStatus ListSegmentInRange(InodeID id,
+                            uint64_t startOffset,
+                            uint64_t endOffset,
+                            std::vector<PageFileSegment> *segments) override;
+
     StoreStatus ListSnapshotFile(InodeID startid,
                         InodeID endid,
                         std::vector<FileInfo> * files) override;
@@ -319,11 +397,20 @@ class NameServerStorageImp : public NameServerStorage {
                             uint64_t off,
                             PageFileSegment *segment) override;
 
+    StoreStatus GetSegment(InodeID id,
+                           uint64_t off,
+                           std::shared_ptr<const PageFileSegment> *segment)
+                           override;
+
     StoreStatus PutSegment(InodeID id,
                             uint64_t off,
                             const PageFileSegment * segment,
                             int64_t *revision) override;
 
+    StoreStatus PutSegments(InodeID id,
+                            const std::vector<PageFileSegment> &segments,
+                            int64_t *revision) override;
+
     StoreStatus DeleteSegment(
         InodeID id, uint64_t off, int64_t *revision) override;
 
@@ -346,12 +433,19 @@ class NameServerStorageImp : public NameServerStorage {
     StoreStatus ListFileInternal(const std::string& startStoreKey,
                                  const std::string& endStoreKey,
                                  std::vector<FileInfo> *files);
+    StoreStatus ListSegmentInternal(const std::string& startStoreKey,
+                                    const std::string& endStoreKey,
+                                    std::vector<PageFileSegment> *segments);
     StoreStatus GetStoreKey(FileType filetype,
                             InodeID id,
                             const std::string& filename,
                             std::string* storekey);
     StoreStatus getErrorCode(int errCode);
 
+    int PutKV(const std::string &key, const std::string &value,
+              int64_t *revision);
+    int DeleteKV(const std::string &key, int64_t *revision);
+
  private:
     // namespace-meta cache
     std::shared_ptr<Cache> cache_;
@@ -359,6 +453,9 @@ class NameServerStorageImp : public NameServerStorage {
     // underlying storage
     std::shared_ptr<KVStorageClient> client_;
 
+    // group commit of independent writes, nullptr if disabled
+    std::shared_ptr<EtcdWriteBatcher> batcher_;
+
     // metric for discard
     SegmentDiscardMetric discardMetric_;
 };
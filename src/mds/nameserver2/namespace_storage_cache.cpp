@@ -21,19 +21,43 @@
  */
 
 #include <glog/logging.h>
+
+#include <algorithm>
+#include <functional>
+
 #include "src/mds/nameserver2/namespace_storage_cache.h"
 
 namespace curve {
 namespace mds {
-void LRUCache::Put(const std::string &key, const std::string &value) {
-    ::curve::common::WriteLockGuard guard(lock_);
-    PutLocked(key, value);
+
+LRUCache::LRUCache(int maxCount, int shardNum, int maxNegativeCount) {
+    shardNum = std::max(shardNum, 1);
+    maxCountPerShard_ =
+        maxCount <= 0 ? 0 : (maxCount + shardNum - 1) / shardNum;
+    if (maxNegativeCount < 0) {
+        maxNegativeCount = maxCount <= 0 ? 0 :
+            (maxCount + kNegativeCountRatio - 1) / kNegativeCountRatio;
+    }
+    maxNegativeCountPerShard_ = maxNegativeCount == 0 ? 0 :
+        (maxNegativeCount + shardNum - 1) / shardNum;
+    for (int i = 0; i < shardNum; ++i) {
+        shards_.emplace_back(new Shard());
+    }
+    cacheMetrics_ = std::make_shared<NameserverCacheMetrics>();
 }
 
-bool LRUCache::Get(const std::string &key, std::string *value) {
-    ::curve::common::WriteLockGuard guard(lock_);
-    auto iter = cache_.find(key);
-    if (iter == cache_.end()) {
+void LRUCache::Put(const std::string &key, const CacheValue &value) {
+    Shard *shard = GetShard(key);
+    ::curve::common::LockGuard guard(shard->mtx);
+    ++shard->revision;
+    PutLocked(shard, key, value);
+}
+
+bool LRUCache::Get(const std::string &key, CacheValue *value) {
+    Shard *shard = GetShard(key);
+    ::curve::common::LockGuard guard(shard->mtx);
+    auto iter = shard->cache.find(key);
+    if (iter == shard->cache.end()) {
         cacheMetrics_->OnCacheMiss();
         return false;
     }
@@ -41,67 +65,88 @@ bool LRUCache::Get(const std::string &key, std::string *value) {
     cacheMetrics_->OnCacheHit();
 
     // update the position of the target item in the list
-    MoveToFront(iter->second);
-    *value = cache_[key]->value;
+    std::list<Item> *ll = GetList(shard, iter->second->value);
+    ll->splice(ll->begin(), *ll, iter->second);
+    *value = iter->second->value;
     return true;
 }
 
 void LRUCache::Remove(const std::string &key) {
-    ::curve::common::WriteLockGuard guard(lock_);
-    RemoveLocked(key);
+    Shard *shard = GetShard(key);
+    ::curve::common::LockGuard guard(shard->mtx);
+    ++shard->revision;
+    RemoveLocked(shard, key);
+}
+
+uint64_t LRUCache::GetRevision(const std::string &key) {
+    Shard *shard = GetShard(key);
+    ::curve::common::LockGuard guard(shard->mtx);
+    return shard->revision;
+}
+
+bool LRUCache::PutIfRevisionMatch(const std::string &key,
+                                  const CacheValue &value,
+                                  uint64_t revision) {
+    Shard *shard = GetShard(key);
+    ::curve::common::LockGuard guard(shard->mtx);
+    if (shard->revision != revision) {
+        return false;
+    }
+
+    PutLocked(shard, key, value);
+    return true;
 }
 
 std::shared_ptr<NameserverCacheMetrics> LRUCache::GetCacheMetrics() const {
     return  cacheMetrics_;
 }
 
-void LRUCache::PutLocked(const std::string &key, const std::string &value) {
-    auto iter = cache_.find(key);
+LRUCache::Shard* LRUCache::GetShard(const std::string &key) {
+    return shards_[std::hash<std::string>()(key) % shards_.size()].get();
+}
+
+void LRUCache::PutLocked(Shard *shard, const std::string &key,
+                         const CacheValue &value) {
+    auto iter = shard->cache.find(key);
 
     // delete the old value if already exist
-    if (iter != cache_.end()) {
-        RemoveElement(iter->second);
+    if (iter != shard->cache.end()) {
+        RemoveElement(shard, iter->second);
     }
 
     // put new value
-    Item kv{key, value};
-    ll_.push_front(kv);
-    cache_[key] = ll_.begin();
+    uint64_t size = key.size() + (value ? value->ByteSizeLong() : 0);
+    std::list<Item> *ll = GetList(shard, value);
+    ll->push_front(Item{key, value, size});
+    shard->cache[key] = ll->begin();
     cacheMetrics_->UpdateAddToCacheCount();
-    cacheMetrics_->UpdateAddToCacheBytes(key.size() + value.size());
-    if (maxCount_ != 0 && ll_.size() > maxCount_) {
-        RemoveOldest();
+    cacheMetrics_->UpdateAddToCacheBytes(size);
+    uint64_t maxCount =
+        value ? maxCountPerShard_ : maxNegativeCountPerShard_;
+    if (maxCount != 0 && ll->size() > maxCount) {
+        RemoveElement(shard, --ll->end());
     }
 }
 
-void LRUCache::RemoveLocked(const std::string &key) {
-    auto iter = cache_.find(key);
-    if (iter != cache_.end()) {
-        RemoveElement(iter->second);
+void LRUCache::RemoveLocked(Shard *shard, const std::string &key) {
+    auto iter = shard->cache.find(key);
+    if (iter != shard->cache.end()) {
+        RemoveElement(shard, iter->second);
     }
 }
 
-void LRUCache::MoveToFront(const std::list<Item>::iterator &elem) {
-    Item duplica{elem->key, elem->value};
-    ll_.erase(elem);
-    ll_.push_front(duplica);
-    cache_[duplica.key] = ll_.begin();
-}
+void LRUCache::RemoveElement(Shard *shard,
+                             const std::list<Item>::iterator &elem) {
+    cacheMetrics_->UpdateRemoveFromCacheCount();
+    cacheMetrics_->UpdateRemoveFromCacheBytes(elem->size);
 
-void LRUCache::RemoveOldest() {
-    if (ll_.begin() != ll_.end()) {
-        RemoveElement(--ll_.end());
-    }
+    shard->cache.erase(elem->key);
+    GetList(shard, elem->value)->erase(elem);
 }
 
-void LRUCache::RemoveElement(const std::list<Item>::iterator &elem) {
-    cacheMetrics_->UpdateRemoveFromCacheCount();
-    cacheMetrics_->UpdateRemoveFromCacheBytes(
-        elem->key.size() + elem->value.size());
-
-    auto iter = cache_.find(elem->key);
-    cache_.erase(iter);
-    ll_.erase(elem);
+std::list<LRUCache::Item>* LRUCache::GetList(Shard *shard,
+                                             const CacheValue &value) {
+    return value ? &shard->ll : &shard->negativeLl;
 }
 
 }  // namespace mds
@@ -23,29 +23,36 @@
 #ifndef SRC_MDS_NAMESERVER2_NAMESPACE_STORAGE_CACHE_H_
 #define SRC_MDS_NAMESERVER2_NAMESPACE_STORAGE_CACHE_H_
 
+#include <google/protobuf/message.h>
+
 #include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "src/common/concurrent/concurrent.h"
 #include "src/mds/nameserver2/metric.h"
 
 namespace curve {
 namespace mds {
-struct Item {
-    std::string key;
-    std::string value;
-};
+
+// decoded FileInfo or PageFileSegment, immutable once put into cache,
+// so readers can share it without holding any lock. nullptr is a negative
+// entry, which means the key does not exist in etcd
+using CacheValue = std::shared_ptr<const ::google::protobuf::Message>;
 
 class Cache {
  public:
+    virtual ~Cache() = default;
+
     /*
-    * @brief Store key-value to the cache
+    * @brief Store key-value to the cache, called after the value
+    *        has been written to etcd
     *
     * @param[in] key
     * @param[in] value
     */
-    virtual void Put(const std::string &key, const std::string &value) = 0;
+    virtual void Put(const std::string &key, const CacheValue &value) = 0;
 
     /*
     * @brief Get corresponding value of the key from the cache
@@ -55,7 +62,7 @@ class Cache {
     *
     * @return false if failed, true if succeeded
     */
-    virtual bool Get(const std::string &key, std::string *value) = 0;
+    virtual bool Get(const std::string &key, CacheValue *value) = 0;
 
     /*
     * @brief Remove Remove key-value from cache
@@ -63,66 +70,126 @@ class Cache {
     * @param[in] key
     */
     virtual void Remove(const std::string &key) = 0;
+
+    /*
+    * @brief Get current revision of the key, every Put/Remove of the key
+    *        changes it. Take the revision before reading value from etcd,
+    *        and fill the cache with PutIfRevisionMatch
+    *
+    * @param[in] key
+    *
+    * @return revision of the key
+    */
+    virtual uint64_t GetRevision(const std::string &key) = 0;
+
+    /*
+    * @brief Store key-value read from etcd, skipped if the key has been
+    *        modified since the revision, so a stale value read concurrently
+    *        with an update never overwrites the newer one
+    *
+    * @param[in] key
+    * @param[in] value
+    * @param[in] revision revision got before reading from etcd
+    *
+    * @return true if value is put into cache
+    */
+    virtual bool PutIfRevisionMatch(const std::string &key,
+                                    const CacheValue &value,
+                                    uint64_t revision) = 0;
 };
 
 class LRUCache : public Cache {
  public:
-    LRUCache() : maxCount_(0) {
-        cacheMetrics_ = std::make_shared<NameserverCacheMetrics>();
-    }
-    explicit LRUCache(int maxCount) : maxCount_(maxCount) {
-        cacheMetrics_ = std::make_shared<NameserverCacheMetrics>();
-    }
-
-    void Put(const std::string &key, const std::string &value) override;
-    bool Get(const std::string &key, std::string *value) override;
+    static const int kDefaultShardNum = 32;
+    // default max number of negative entries is 1/kNegativeCountRatio
+    // of maxCount
+    static const int kNegativeCountRatio = 10;
+
+    LRUCache() : LRUCache(0) {}
+
+    /*
+    * @param[in] maxCount max number of items, 0 indicates unlimited
+    * @param[in] shardNum keys are hashed into shards, each shard has its own
+    *            lock and lru list, and holds at most maxCount/shardNum items
+    * @param[in] maxNegativeCount max number of negative entries, they are
+    *            kept in their own lru lists and never evict real values.
+    *            0 indicates unlimited, -1 indicates
+    *            maxCount/kNegativeCountRatio
+    */
+    explicit LRUCache(int maxCount, int shardNum = kDefaultShardNum,
+                      int maxNegativeCount = -1);
+
+    void Put(const std::string &key, const CacheValue &value) override;
+    bool Get(const std::string &key, CacheValue *value) override;
     void Remove(const std::string &key) override;
+    uint64_t GetRevision(const std::string &key) override;
+    bool PutIfRevisionMatch(const std::string &key, const CacheValue &value,
+                            uint64_t revision) override;
     std::shared_ptr<NameserverCacheMetrics> GetCacheMetrics() const;
 
  private:
+    struct Item {
+        std::string key;
+        CacheValue value;
+        uint64_t size;
+    };
+
+    struct Shard {
+        ::curve::common::Mutex mtx;
+        // changed by every Put/Remove of keys in this shard
+        uint64_t revision = 0;
+        // dequeue for storing items
+        std::list<Item> ll;
+        // dequeue for storing negative entries
+        std::list<Item> negativeLl;
+        // record the position of the item corresponding to the key
+        std::unordered_map<std::string, std::list<Item>::iterator> cache;
+    };
+
+    Shard* GetShard(const std::string &key);
+
     /*
-    * @brief PutLocked Store key-value in cache, not thread safe
+    * @brief PutLocked Store key-value in shard, not thread safe
     *
+    * @param[in] shard
     * @param[in] key
     * @param[in] value
     */
-    void PutLocked(const std::string &key, const std::string &value);
+    void PutLocked(Shard *shard, const std::string &key,
+                   const CacheValue &value);
 
     /*
-    * @brief RemoveLocked Remove key-value from the cache, not thread safe
+    * @brief RemoveLocked Remove key-value from the shard, not thread safe
     *
+    * @param[in] shard
     * @param[in] key
     */
-    void RemoveLocked(const std::string &key);
+    void RemoveLocked(Shard *shard, const std::string &key);
 
     /*
-    * @brief MoveToFront Move the element hit this to the head of the list
+    * @brief RemoveElement Remove specified element
     *
-    * @param[in] elem Target element
-    */
-    void MoveToFront(const std::list<Item>::iterator &elem);
-
-    /*
-    * @brief RemoveOldest Remove elements exceeded maxCount
+    * @param[in] shard
+    * @param[in] elem Specified element
     */
-    void RemoveOldest();
+    void RemoveElement(Shard *shard, const std::list<Item>::iterator &elem);
 
     /*
-    * @brief RemoveElement Remove specified element
+    * @brief GetList Get the lru list which the value belongs to
     *
-    * @param[in] elem Specified element
+    * @param[in] shard
+    * @param[in] value
     */
-    void RemoveElement(const std::list<Item>::iterator &elem);
+    std::list<Item>* GetList(Shard *shard, const CacheValue &value);
 
  private:
-    ::curve::common::RWLock lock_;
-
-    // the maximum length of the queue. 0 indicates unlimited length
-    int maxCount_;
-    // dequeue for storing items
-    std::list<Item> ll_;
-    // record the position of the item corresponding to the key in the dequeue
-    std::unordered_map<std::string, std::list<Item>::iterator> cache_;
+    // the maximum length of the queue in each shard. 0 indicates unlimited
+    uint64_t maxCountPerShard_;
+    // the maximum length of the negative entry queue in each shard.
+    // 0 indicates unlimited
+    uint64_t maxNegativeCountPerShard_;
+
+    std::vector<std::unique_ptr<Shard>> shards_;
 
     // cache related metric data
     std::shared_ptr<NameserverCacheMetrics> cacheMetrics_;
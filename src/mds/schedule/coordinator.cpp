@@ -292,6 +292,11 @@ bool Coordinator::BuildCopySetConf(
     return true;
 }
 
+bool Coordinator::HasOperator(CopySetKey key) {
+    Operator op;
+    return opController_->GetOperatorById(key, &op);
+}
+
 bool Coordinator::ChunkserverGoingToAdd(
     ChunkServerIdType csId, CopySetKey key) {
     Operator op;
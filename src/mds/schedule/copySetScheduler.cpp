@@ -21,7 +21,10 @@
  */
 
 #include <glog/logging.h>
+#include <algorithm>
 #include <cmath>
+#include <random>
+#include <set>
 #include "src/mds/schedule/scheduler.h"
 #include "src/mds/schedule/operatorFactory.h"
 #include "src/mds/schedule/scheduler_helper.h"
@@ -115,8 +118,19 @@ bool CopySetScheduler::AddOperatorAndCreateCopyset(const Operator &op,
     return true;
 }
 
-int CopySetScheduler::NormalCopySetSchedule(const std::map<ChunkServerIdType,
-                                    std::vector<CopySetInfo>> &distribute) {
+std::vector<CopySetInfo> CopySetScheduler::GetCopySetInfosInChunkServer(
+    PoolIdType lid, ChunkServerIdType id) {
+    std::vector<CopySetInfo> out;
+    for (auto &info : topo_->GetCopySetInfosInChunkServer(id)) {
+        if (info.id.first == lid) {
+            out.emplace_back(info);
+        }
+    }
+    return out;
+}
+
+int CopySetScheduler::NormalCopySetSchedule(PoolIdType lid,
+    const std::vector<std::pair<ChunkServerIdType, int>> &distribute) {
     // 2. measure the average, range and standard deviation of number of copyset
     //    on chunkservers
     float avg;
@@ -154,7 +168,7 @@ int CopySetScheduler::NormalCopySetSchedule(const std::map<ChunkServerIdType,
     ChunkServerIdType target = UNINTIALIZE_ID;
     CopySetInfo choose;
     // this function call will select the source, target and the copyset
-    if (CopySetMigration(distribute, &op, &source, &target, &choose)) {
+    if (CopySetMigration(lid, distribute, &op, &source, &target, &choose)) {
         if (AddOperatorAndCreateCopyset(op, choose, target)) {
             oneRoundGenOp++;
         }
@@ -164,16 +178,18 @@ int CopySetScheduler::NormalCopySetSchedule(const std::map<ChunkServerIdType,
 }
 
 int CopySetScheduler::DoCopySetSchedule(PoolIdType lid) {
-    // 1. collect the chunkserver list and copyset list of the cluster, then
-    //    collect copyset on every online chunkserver
-    auto copysetList = topo_->GetCopySetInfosInLogicalPool(lid);
+    // 1. collect the chunkserver list of the logical pool, and copysets on
+    //    online pendding chunkservers
     auto chunkserverList = topo_->GetChunkServersInLogicalPool(lid);
 
     std::map<ChunkServerIdType, std::vector<CopySetInfo>> penddingDistribute;
-    SchedulerHelper::GetCopySetDistributionInOnlineChunkServer(
-        copysetList, chunkserverList, &penddingDistribute);
-    SchedulerHelper::FilterCopySetDistributions(ChunkServerStatus::PENDDING,
-                    chunkserverList, &penddingDistribute);
+    for (auto &cs : chunkserverList) {
+        if (cs.IsOffline() || cs.status != ChunkServerStatus::PENDDING) {
+            continue;
+        }
+        penddingDistribute[cs.info.id] =
+            GetCopySetInfosInChunkServer(lid, cs.info.id);
+    }
     if (!penddingDistribute.empty()) {
         int oneRoundGenOp = PenddingCopySetSchedule(penddingDistribute);
         // If generate pendding copy set schedule, return here.
@@ -183,40 +199,61 @@ int CopySetScheduler::DoCopySetSchedule(PoolIdType lid) {
     }
 
     // If no pendding copyset schedule operator generated,
-    // run NormalCopySetSchedule
-    std::map<ChunkServerIdType, std::vector<CopySetInfo>> normalDistribute;
-    SchedulerHelper::GetCopySetDistributionInOnlineChunkServer(
-        copysetList, chunkserverList, &normalDistribute);
-    SchedulerHelper::FilterCopySetDistributions(ChunkServerStatus::READWRITE,
-                    chunkserverList, &normalDistribute);
-    if (normalDistribute.empty()) {
+    // run NormalCopySetSchedule. The copyset number of chunkservers comes
+    // from the distribution index of topology in descending order, so
+    // copysets are not traversed here
+    std::set<ChunkServerIdType> normalChunkServers;
+    for (auto &cs : chunkserverList) {
+        if (!cs.IsOffline() && cs.status == ChunkServerStatus::READWRITE) {
+            normalChunkServers.emplace(cs.info.id);
+        }
+    }
+    if (normalChunkServers.empty()) {
         LOG(WARNING) << "no not-retired chunkserver in topology";
         return 0;
     }
-    return NormalCopySetSchedule(normalDistribute);
+
+    std::vector<std::pair<ChunkServerIdType, int>> normalDistribute;
+    for (auto &item : topo_->GetChunkServersOrderByCopySetNum(lid)) {
+        if (normalChunkServers.erase(item.first) > 0) {
+            normalDistribute.emplace_back(item.first, item.second);
+        }
+    }
+    // chunkservers with no copyset
+    for (auto id : normalChunkServers) {
+        normalDistribute.emplace_back(id, 0);
+    }
+
+    // shuffle chunkservers with the same copyset number, so that the
+    // source and target are not always the same ones
+    static std::random_device rd;
+    static std::mt19937 g(rd());
+    for (auto begin = normalDistribute.begin();
+         begin != normalDistribute.end();) {
+        auto end = begin;
+        while (end != normalDistribute.end() &&
+               end->second == begin->second) {
+            ++end;
+        }
+        std::shuffle(begin, end, g);
+        begin = end;
+    }
+
+    return NormalCopySetSchedule(lid, normalDistribute);
 }
 
 void CopySetScheduler::StatsCopysetDistribute(
-    const std::map<ChunkServerIdType, std::vector<CopySetInfo>> &distribute,
+    const std::vector<std::pair<ChunkServerIdType, int>> &distribute,
     float *avg, int *range, float *stdvariance) {
+    // distribute is in descending order of copyset number
     int num = 0;
-    int max = -1;
-    int min = -1;
-    ChunkServerIdType maxcsId = UNINTIALIZE_ID;
-    ChunkServerIdType mincsId = UNINTIALIZE_ID;
+    int max = distribute.front().second;
+    int min = distribute.back().second;
+    ChunkServerIdType maxcsId = distribute.front().first;
+    ChunkServerIdType mincsId = distribute.back().first;
     float variance = 0;
     for (auto &item : distribute) {
-        num += item.second.size();
-
-        if (max == -1 || item.second.size() > max) {
-            max = item.second.size();
-            maxcsId = item.first;
-        }
-
-        if (min == -1 || item.second.size() < min) {
-            min = item.second.size();
-            mincsId = item.first;
-        }
+        num += item.second;
     }
 
     // average
@@ -224,7 +261,7 @@ void CopySetScheduler::StatsCopysetDistribute(
 
     // variance
     for (auto &item : distribute) {
-        variance += std::pow(static_cast<int>(item.second.size()) - *avg, 2);
+        variance += std::pow(item.second - *avg, 2);
     }
     // range
     *range = max - min;
@@ -272,42 +309,46 @@ void CopySetScheduler::StatsCopysetDistribute(
  *          done
  *      done
  **/
-bool CopySetScheduler::CopySetMigration(
-    const std::map<ChunkServerIdType, std::vector<CopySetInfo>> &distribute,
+bool CopySetScheduler::CopySetMigration(PoolIdType lid,
+    const std::vector<std::pair<ChunkServerIdType, int>> &distribute,
     Operator *op, ChunkServerIdType *source, ChunkServerIdType *target,
     CopySetInfo *choose) {
     if (distribute.size() <= 1) {
         return false;
     }
 
-    // sort for distribute
-    std::vector<std::pair<ChunkServerIdType, std::vector<CopySetInfo>>> desc;
-    SchedulerHelper::SortDistribute(distribute, &desc);
     // select the chunkserver with the least number of copysets as the target
-    LOG(INFO) << "copyset scheduler after sort (max:" << desc[0].second.size()
-        << ",maxCsId:" << desc[0].first
-        << "), (min:" << desc[desc.size() - 1].second.size()
-        << ",minCsId:" << desc[desc.size() - 1].first << ")";
-    *target = desc[desc.size() - 1].first;
-    int copysetNumInTarget = desc[desc.size() - 1].second.size();
+    LOG(INFO) << "copyset scheduler after sort (max:"
+        << distribute.front().second
+        << ",maxCsId:" << distribute.front().first
+        << "), (min:" << distribute.back().second
+        << ",minCsId:" << distribute.back().first << ")";
+    *target = distribute.back().first;
+    int copysetNumInTarget = distribute.back().second;
     if (opController_->ChunkServerExceed(*target)) {
         LOG(INFO) << "copysetScheduler found target:"
                   << *target << " operator exceed";
         return false;
     }
 
-    // select copyset and source
+    // select copyset and source, copysets are fetched only for the
+    // possible sources
+    static std::random_device rd;
+    static std::mt19937 g(rd());
     *source = UNINTIALIZE_ID;
-    for (auto it = desc.begin(); it != desc.end()--; it++) {
+    for (auto it = distribute.begin(); it != distribute.end(); it++) {
         // there shouldn't be any migration if the difference of copyset number
-        // on possible source and target is less than 1
+        // on possible source and target is less than 1, the rest chunkservers
+        // have even less copysets
         ChunkServerIdType possibleSource = it->first;
-        int copysetNumInPossible = it->second.size();
+        int copysetNumInPossible = it->second;
         if (copysetNumInPossible - copysetNumInTarget <= 1) {
-            continue;
+            break;
         }
 
-        for (auto info : it->second) {
+        auto copysets = GetCopySetInfosInChunkServer(lid, possibleSource);
+        std::shuffle(copysets.begin(), copysets.end(), g);
+        for (auto &info : copysets) {
             // does not meet the basic conditions
             if (!CopySetSatisfiyBasicMigrationCond(info)) {
                 continue;
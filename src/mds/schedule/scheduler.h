@@ -201,13 +201,14 @@ class CopySetScheduler : public Scheduler {
      * @brief StatsCopysetDistribute Calculate the average number, range and
      *        standard deviation of copyset on chunkserver
      *
-     * @param[in] distribute Copyset on every chunkservers
+     * @param[in] distribute Copyset number of every chunkserver, in
+     *                       descending order of copyset number
      * @param[out] avg
      * @param[out] range
      * @param[out] standard deviation
      */
     void StatsCopysetDistribute(
-        const std::map<ChunkServerIdType, std::vector<CopySetInfo>> &distribute,
+        const std::vector<std::pair<ChunkServerIdType, int>> &distribute,
         float *avg, int *range, float *stdvariance);
 
     /**
@@ -215,9 +216,9 @@ class CopySetScheduler : public Scheduler {
      *                         distribution on Topology, and specify the source
      *                         and target
      *
-     * @param[in] chunkserverlist Every chunkservers in Topology,
-     *                            for avoiding duplicate fetching as a parameter
-     * @param[in] distribute Copyset on every chunkserver
+     * @param[in] lid Specified logical pool id
+     * @param[in] distribute Copyset number of every chunkserver, in
+     *                       descending order of copyset number
      * @param[out] op Operator generated
      * @param[out] source The chunkserver specified to remove copyset
      * @param[out] target The chunkserver specified to add copyset
@@ -225,8 +226,8 @@ class CopySetScheduler : public Scheduler {
      *
      * @return true if operator generated false if not
      */
-    bool CopySetMigration(
-        const std::map<ChunkServerIdType, std::vector<CopySetInfo>> &distribute,
+    bool CopySetMigration(PoolIdType lid,
+        const std::vector<std::pair<ChunkServerIdType, int>> &distribute,
         Operator *op, ChunkServerIdType *source, ChunkServerIdType *target,
         CopySetInfo *choose);
 
@@ -252,12 +253,14 @@ class CopySetScheduler : public Scheduler {
     /**
      * @brief migrate one copyset between online & no pendding chunkservers
      *
-     * @param[in] distribute Copyset on every online && no pendding chunkserver
+     * @param[in] lid Specified logical pool id
+     * @param[in] distribute Copyset number of every online && no pendding
+     *                       chunkserver, in descending order
      *
      * @return Source node of the migration
      */
-    int NormalCopySetSchedule(const std::map<ChunkServerIdType,
-                                    std::vector<CopySetInfo>> &distribute);
+    int NormalCopySetSchedule(PoolIdType lid,
+        const std::vector<std::pair<ChunkServerIdType, int>> &distribute);
 
     /**
      * @brief migrate one copyset from online && pendding chunkserver to
@@ -279,6 +282,15 @@ class CopySetScheduler : public Scheduler {
                                      const CopySetInfo &choose,
                                      const ChunkServerIdType &target);
 
+    /**
+     * @brief get copysets of the specified logical pool on the chunkserver
+     * @param[in] lid Specified logical pool id
+     * @param[in] id chunkserver id
+     * @return copysets on the chunkserver
+     */
+    std::vector<CopySetInfo> GetCopySetInfosInChunkServer(PoolIdType lid,
+                                                          ChunkServerIdType id);
+
  private:
     // Running interval of CopySetScheduler
     int64_t runInterval_;
@@ -274,6 +274,11 @@ std::vector<ChunkServerInfo> TopoAdapterImpl::GetChunkServersInLogicalPool(
     return infos;
 }
 
+std::vector<std::pair<ChunkServerIdType, uint32_t>>
+TopoAdapterImpl::GetChunkServersOrderByCopySetNum(PoolIdType lid) {
+    return topo_->GetChunkServersOrderByCopySetNum(lid);
+}
+
 int TopoAdapterImpl::GetStandardZoneNumInLogicalPool(PoolIdType id) {
     ::curve::mds::topology::LogicalPool logicalPool;
     if (topo_->GetLogicalPool(id, &logicalPool)) {
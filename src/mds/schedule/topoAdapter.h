@@ -27,6 +27,7 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <utility>
 #include "src/mds/topology/topology.h"
 #include "src/mds/topology/topology_service_manager.h"
 #include "src/mds/topology/topology_stat.h"
@@ -252,6 +253,19 @@ class TopoAdapter {
     virtual std::vector<ChunkServerInfo> GetChunkServersInLogicalPool(
         PoolIdType lid) = 0;
 
+    /**
+     * @brief GetChunkServersOrderByCopySetNum get the copyset number of
+     *                                         chunkservers in the specified
+     *                                         logical pool
+     *
+     * @prarm[in] lid the id of the logical pool
+     *
+     * @return chunkservers in descending order of copyset number,
+     *         chunkservers without any copyset are not included
+     */
+    virtual std::vector<std::pair<ChunkServerIdType, uint32_t>>
+        GetChunkServersOrderByCopySetNum(PoolIdType lid) = 0;
+
     /**
      * @brief GetStandardZoneNumInLogicalPool get the standard zone num of the
      *                                        logical pool
@@ -374,6 +388,9 @@ class TopoAdapterImpl : public TopoAdapter {
     std::vector<ChunkServerInfo> GetChunkServersInLogicalPool(
         PoolIdType lid) override;
 
+    std::vector<std::pair<ChunkServerIdType, uint32_t>>
+        GetChunkServersOrderByCopySetNum(PoolIdType lid) override;
+
     int GetStandardZoneNumInLogicalPool(PoolIdType id) override;
 
     int GetStandardReplicaNumInLogicalPool(PoolIdType id) override;
@@ -50,15 +50,25 @@ void MDS::InitMdsOptions(std::shared_ptr<Configuration> conf) {
     InitCopysetOption(&options_.copysetOption);
     InitChunkServerClientOption(&options_.chunkServerClientOption);
     InitSnapshotCloneClientOption(&options_.snapshotCloneClientOption);
+    InitEtcdWriteBatchOption(&options_.etcdWriteBatchOption);
+    InitFollowerReadOption(&options_.followerReadOption);
 
     conf_->GetValueFatalIfFail(
         "mds.segment.alloc.retryInterMs", &options_.retryInterTimes);
     conf_->GetValueFatalIfFail(
         "mds.segment.alloc.periodic.persistInterMs",
         &options_.periodicPersistInterMs);
+    if (!conf_->GetUInt32Value("mds.segment.alloc.calculateConcurrency",
+        &options_.segmentAllocCalculateConcurrency)) {
+        options_.segmentAllocCalculateConcurrency = 1;
+    }
 
     // cache size of namestorage
     conf_->GetValueFatalIfFail("mds.cache.count", &options_.mdsCacheCount);
+    if (!conf_->GetIntValue("mds.cache.negativeCount",
+        &options_.mdsNegativeCacheCount)) {
+        options_.mdsNegativeCacheCount = -1;
+    }
 
     conf_->GetValueFatalIfFail("mds.listen.addr", &options_.mdsListenAddr);
 
@@ -97,6 +107,9 @@ void MDS::StartCompaginLeader() {
     InitEtcdConf(&etcdConf);
     InitEtcdClient(etcdConf, etcdTimeout, etcdRetryTimes);
 
+    // serve read-only namespace rpcs while campaigning
+    StartFollowerRead();
+
     // leader election
     LeaderElectionOptions leaderElectionOp;
     InitMdsLeaderElectionOption(&leaderElectionOp);
@@ -114,8 +127,11 @@ void MDS::StartCompaginLeader() {
 
 void MDS::Init() {
     InitSegmentAllocStatistic(options_.retryInterTimes,
-                              options_.periodicPersistInterMs);
-    InitNameServerStorage(options_.mdsCacheCount);
+                              options_.periodicPersistInterMs,
+                              options_.segmentAllocCalculateConcurrency);
+    InitNameServerStorage(options_.mdsCacheCount,
+                          options_.mdsNegativeCacheCount,
+                          options_.etcdWriteBatchOption);
     InitTopology(options_.topologyOption);
     InitTopologyStat();
     InitTopologyChunkAllocator(options_.topologyOption);
@@ -154,6 +170,8 @@ void MDS::Run() {
 }
 
 void MDS::Stop() {
+    StopFollowerRead();
+
     if (!running_) {
         LOG(INFO) << "MDS is not running";
         return;
@@ -231,6 +249,43 @@ void MDS::StartServer() {
     server.RunUntilAskedToQuit();
 }
 
+void MDS::StartFollowerRead() {
+    const FollowerReadOption &option = options_.followerReadOption;
+    if (!option.enable) {
+        return;
+    }
+
+    followerCache_ =
+        std::make_shared<NameSpaceFollowerCache>(etcdClient_, option);
+    LOG_IF(FATAL, !followerCache_->Init())
+        << "init namespace follower cache fail";
+    followerCache_->Start();
+
+    followerService_.reset(
+        new FollowerNameSpaceService(followerCache_, options_.authOptions));
+    followerServer_.reset(new brpc::Server());
+    LOG_IF(FATAL, followerServer_->AddService(followerService_.get(),
+                          brpc::SERVER_DOESNT_OWN_SERVICE) != 0)
+        << "add follower namespace service error";
+
+    brpc::ServerOptions serverOption;
+    serverOption.idle_timeout_sec = -1;
+    LOG_IF(FATAL, followerServer_->Start(option.listenAddr.c_str(),
+                                         &serverOption) != 0)
+        << "start follower read server error";
+    LOG(INFO) << "start follower read server on " << option.listenAddr;
+}
+
+void MDS::StopFollowerRead() {
+    if (followerServer_ != nullptr) {
+        followerServer_->Stop(0);
+        followerServer_->Join();
+    }
+    if (followerCache_ != nullptr) {
+        followerCache_->Stop();
+    }
+}
+
 void MDS::InitEtcdClient(const EtcdConf& etcdConf,
                          int etcdTimeout,
                          int retryTimes) {
@@ -273,9 +328,11 @@ void MDS::InitMdsLeaderElectionOption(LeaderElectionOptions *electionOp) {
 }
 
 void MDS::InitSegmentAllocStatistic(uint64_t retryInterTimes,
-                                    uint64_t periodicPersistInterMs) {
+                                    uint64_t periodicPersistInterMs,
+                                    uint32_t calculateConcurrency) {
     segmentAllocStatistic_ = std::make_shared<AllocStatistic>(
-        periodicPersistInterMs, retryInterTimes, etcdClient_);
+        periodicPersistInterMs, retryInterTimes, etcdClient_,
+        calculateConcurrency);
     int res = segmentAllocStatistic_->Init();
     LOG_IF(FATAL, res != 0) << "int segment alloc statistic fail";
     LOG(INFO) << "init segmentAllocStatistic success.";
@@ -306,6 +363,22 @@ void MDS::InitTopologyOption(TopologyOption *topologyOption) {
     conf_->GetValueFatalIfFail(
         "mds.topology.enableLogicalPoolStatus",
         &topologyOption->enableLogicalPoolStatus);
+    if (!conf_->GetIntValue("mds.topology.chooseCopysetPolicy",
+                            &topologyOption->chooseCopysetPolicy)) {
+        topologyOption->chooseCopysetPolicy = 0;
+    }
+    if (!conf_->GetUInt32Value("mds.topology.copysetWeightUpdateIntervalMs",
+            &topologyOption->copysetWeightUpdateIntervalMs)) {
+        topologyOption->copysetWeightUpdateIntervalMs = 10000;
+    }
+    if (!conf_->GetUInt32Value("mds.topology.copysetWeightLoadPercent",
+            &topologyOption->copysetWeightLoadPercent)) {
+        topologyOption->copysetWeightLoadPercent = 100;
+    }
+    if (!conf_->GetUInt32Value("mds.topology.copysetWeightRebuildPercent",
+            &topologyOption->copysetWeightRebuildPercent)) {
+        topologyOption->copysetWeightRebuildPercent = 10;
+    }
 }
 
 void MDS::InitTopology(const TopologyOption& option) {
@@ -382,21 +455,79 @@ void MDS::InitCopysetOption(CopysetOption *copysetOption) {
 void MDS::InitTopologyChunkAllocator(const TopologyOption& option) {
     topologyChunkAllocator_ =
           std::make_shared<TopologyChunkAllocatorImpl>(topology_,
-               segmentAllocStatistic_, option);
+               segmentAllocStatistic_, option, topologyStat_);
     LOG(INFO) << "init topologyChunkAllocator success.";
 }
 
-void MDS::InitNameServerStorage(int mdsCacheCount) {
+void MDS::InitNameServerStorage(int mdsCacheCount, int mdsNegativeCacheCount,
+                                const EtcdWriteBatchOption &batchOption) {
     // init LRUCache
-    auto cache = std::make_shared<LRUCache>(mdsCacheCount);
+    auto cache = std::make_shared<LRUCache>(mdsCacheCount,
+        LRUCache::kDefaultShardNum, mdsNegativeCacheCount);
     LOG(INFO) << "init LRUCache success.";
 
+    // init EtcdWriteBatcher
+    std::shared_ptr<EtcdWriteBatcher> batcher;
+    if (batchOption.enable) {
+        batcher = std::make_shared<EtcdWriteBatcher>(etcdClient_,
+                                                     batchOption);
+        batcher->Start();
+        LOG(INFO) << "init EtcdWriteBatcher success.";
+    }
+
     // init NameServerStorage
     nameServerStorage_ = std::make_shared<NameServerStorageImp>(etcdClient_,
-                                                                cache);
+                                                                cache,
+                                                                batcher);
     LOG(INFO) << "init NameServerStorage success.";
 }
 
+void MDS::InitEtcdWriteBatchOption(EtcdWriteBatchOption *option) {
+    if (!conf_->GetBoolValue("mds.etcd.writeBatch.enable", &option->enable)) {
+        option->enable = false;
+    }
+    if (!conf_->GetUInt32Value("mds.etcd.writeBatch.maxBatchSize",
+                               &option->maxBatchSize)) {
+        option->maxBatchSize = 64;
+    }
+    if (!conf_->GetUInt32Value("mds.etcd.writeBatch.windowUs",
+                               &option->batchWindowUs)) {
+        option->batchWindowUs = 500;
+    }
+    if (option->maxBatchSize == 0) {
+        LOG(WARNING) << "mds.etcd.writeBatch.maxBatchSize is 0, use 1";
+        option->maxBatchSize = 1;
+    }
+}
+
+void MDS::InitFollowerReadOption(FollowerReadOption *option) {
+    if (!conf_->GetBoolValue("mds.followerRead.enable", &option->enable)) {
+        option->enable = false;
+    }
+    if (!option->enable) {
+        return;
+    }
+    conf_->GetValueFatalIfFail("mds.followerRead.listen.addr",
+                               &option->listenAddr);
+    if (!conf_->GetUInt32Value("mds.followerRead.watchTimeoutMs",
+                               &option->watchTimeoutMs)) {
+        option->watchTimeoutMs = 1000;
+    }
+    if (!conf_->GetUInt32Value("mds.followerRead.maxStalenessMs",
+                               &option->maxStalenessMs)) {
+        option->maxStalenessMs = 3000;
+    }
+    if (!conf_->GetUInt32Value("mds.followerRead.retryIntervalMs",
+                               &option->retryIntervalMs)) {
+        option->retryIntervalMs = 1000;
+    }
+    if (option->maxStalenessMs <= option->watchTimeoutMs) {
+        LOG(WARNING) << "mds.followerRead.maxStalenessMs should be larger "
+                     << "than mds.followerRead.watchTimeoutMs, "
+                     << "or reads are refused when nothing changes";
+    }
+}
+
 void MDS::InitSnapshotCloneClientOption(SnapshotCloneClientOption *option) {
     if (!conf_->GetValue("mds.snapshotcloneclient.addr",
         &option->snapshotCloneAddr)) {
@@ -461,6 +592,10 @@ void MDS::InitFileRecordOptions(FileRecordOptions *fileRecordOptions) {
         "mds.file.expiredTimeUs", &fileRecordOptions->fileRecordExpiredTimeUs);
     conf_->GetValueFatalIfFail(
         "mds.file.scanIntevalTimeUs", &fileRecordOptions->scanIntervalTimeUs);
+    if (!conf_->GetUInt32Value(
+            "mds.file.recordShardNum", &fileRecordOptions->shardNum)) {
+        fileRecordOptions->shardNum = 64;
+    }
 }
 
 void MDS::InitAuthOptions(RootAuthOption *authOptions) {
@@ -522,9 +657,12 @@ void MDS::InitCleanManager() {
         std::make_shared<CopysetClient>(topology_, chunkServerClientOption,
                                                         channelPool);
 
+    CleanCoreOption cleanCoreOption;
+    InitCleanCoreOption(&cleanCoreOption);
     auto cleanCore = std::make_shared<CleanCore>(nameServerStorage_,
                                                  copysetClient,
-                                                 segmentAllocStatistic_);
+                                                 segmentAllocStatistic_,
+                                                 cleanCoreOption);
 
     // init dlock options
     auto dlockOpts = std::make_shared<DLockOpts>();
@@ -536,6 +674,25 @@ void MDS::InitCleanManager() {
     LOG(INFO) << "init CleanManager success.";
 }
 
+void MDS::InitCleanCoreOption(CleanCoreOption *option) {
+    if (!conf_->GetBoolValue("mds.clean.batchDeleteChunk",
+                             &option->batchDeleteChunk)) {
+        option->batchDeleteChunk = false;
+    }
+    if (!conf_->GetUInt32Value("mds.clean.maxChunksPerBatch",
+                               &option->maxChunksPerBatch)) {
+        option->maxChunksPerBatch = 64;
+    }
+    if (!conf_->GetUInt32Value("mds.clean.deleteChunkConcurrency",
+                               &option->deleteChunkConcurrency)) {
+        option->deleteChunkConcurrency = 1;
+    }
+    if (!conf_->GetUInt32Value("mds.clean.segmentsPerRound",
+                               &option->segmentsPerRound)) {
+        option->segmentsPerRound = 1;
+    }
+}
+
 void MDS::InitChunkServerClientOption(ChunkServerClientOption *option) {
     conf_->GetValueFatalIfFail("mds.chunkserverclient.rpcTimeoutMs",
         &option->rpcTimeoutMs);
@@ -639,6 +796,14 @@ void MDS::InitHeartbeatOption(HeartbeatOption* heartbeatOption) {
                         &heartbeatOption->offLineTimeOutMs);
     conf_->GetValueFatalIfFail("mds.heartbeat.clean_follower_afterMs",
                         &heartbeatOption->cleanFollowerAfterMs);
+    if (!conf_->GetUInt32Value("mds.heartbeat.workerNum",
+                               &heartbeatOption->workerNum)) {
+        heartbeatOption->workerNum = 0;
+    }
+    if (!conf_->GetUInt32Value("mds.heartbeat.workerQueueCapacity",
+                               &heartbeatOption->workerQueueCapacity)) {
+        heartbeatOption->workerQueueCapacity = 1024;
+    }
 }
 }  // namespace mds
 }  // namespace curve
@@ -32,6 +32,8 @@
 
 #include "src/mds/nameserver2/namespace_storage.h"
 #include "src/mds/nameserver2/namespace_service.h"
+#include "src/mds/nameserver2/namespace_follower_cache.h"
+#include "src/mds/nameserver2/follower_namespace_service.h"
 #include "src/mds/nameserver2/curvefs.h"
 #include "src/mds/nameserver2/clean_manager.h"
 #include "src/mds/nameserver2/clean_core.h"
@@ -93,9 +95,16 @@ struct MDSOptions {
     // configuration of segmentAlloc
     uint64_t retryInterTimes;
     uint64_t periodicPersistInterMs;
+    uint32_t segmentAllocCalculateConcurrency;
     // cache size of namestorage
     int mdsCacheCount;
+    // max number of negative entries in namestorage cache
+    int mdsNegativeCacheCount;
     int mdsFilelockBucketNum;
+    // group commit of namespace writes
+    EtcdWriteBatchOption etcdWriteBatchOption;
+    // serve read-only namespace rpcs on every mds
+    FollowerReadOption followerReadOption;
 
     FileRecordOptions fileRecordOptions;
     RootAuthOption authOptions;
@@ -167,8 +176,14 @@ class MDS {
 
     void InitChunkServerClientOption(ChunkServerClientOption *option);
 
+    void InitCleanCoreOption(CleanCoreOption *option);
+
     void InitSnapshotCloneClientOption(SnapshotCloneClientOption *option);
 
+    void InitEtcdWriteBatchOption(EtcdWriteBatchOption *option);
+
+    void InitFollowerReadOption(FollowerReadOption *option);
+
     void InitEtcdClient(const EtcdConf& etcdConf,
                         int etcdTimeout,
                         int retryTimes);
@@ -176,12 +191,22 @@ class MDS {
     void InitLeaderElection(const LeaderElectionOptions& leaderElectionOp);
 
     void InitSegmentAllocStatistic(uint64_t retryInterTimes,
-                                   uint64_t periodicPersistInterMs);
+                                   uint64_t periodicPersistInterMs,
+                                   uint32_t calculateConcurrency);
 
-    void InitNameServerStorage(int mdsCacheCount);
+    void InitNameServerStorage(int mdsCacheCount, int mdsNegativeCacheCount,
+                               const EtcdWriteBatchOption &batchOption);
 
     void StartServer();
 
+    /**
+     * @brief start the read-only namespace server if enabled, it runs
+     *        whether this mds is the leader or not
+     */
+    void StartFollowerRead();
+
+    void StopFollowerRead();
+
     void InitTopologyModule();
 
     void InitTopology(const TopologyOption& option);
@@ -235,6 +260,9 @@ class MDS {
     char* etcdEndpoints_;
     FileLockManager* fileLockManager_;
     std::shared_ptr<SnapshotCloneClient> snapshotCloneClient_;
+    std::shared_ptr<NameSpaceFollowerCache> followerCache_;
+    std::unique_ptr<FollowerNameSpaceService> followerService_;
+    std::unique_ptr<brpc::Server> followerServer_;
 };
 
 }  // namespace mds
@@ -0,0 +1,143 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include "src/mds/topology/copyset_distribution.h"
+
+namespace curve {
+namespace mds {
+namespace topology {
+
+using ::curve::common::ReadLockGuard;
+using ::curve::common::WriteLockGuard;
+
+void CopySetDistribution::AddCopySet(
+    const CopySetKey &key, const std::set<ChunkServerIdType> &members) {
+    WriteLockGuard wlock(lock_);
+    for (auto id : members) {
+        AddMemberLocked(key, id);
+    }
+}
+
+void CopySetDistribution::RemoveCopySet(
+    const CopySetKey &key, const std::set<ChunkServerIdType> &members) {
+    WriteLockGuard wlock(lock_);
+    for (auto id : members) {
+        RemoveMemberLocked(key, id);
+    }
+}
+
+void CopySetDistribution::UpdateCopySet(
+    const CopySetKey &key,
+    const std::set<ChunkServerIdType> &oldMembers,
+    const std::set<ChunkServerIdType> &newMembers) {
+    if (oldMembers == newMembers) {
+        return;
+    }
+
+    WriteLockGuard wlock(lock_);
+    for (auto id : oldMembers) {
+        if (newMembers.count(id) == 0) {
+            RemoveMemberLocked(key, id);
+        }
+    }
+    for (auto id : newMembers) {
+        if (oldMembers.count(id) == 0) {
+            AddMemberLocked(key, id);
+        }
+    }
+}
+
+void CopySetDistribution::Clear() {
+    WriteLockGuard wlock(lock_);
+    chunkServerCopySets_.clear();
+    poolDistributions_.clear();
+}
+
+std::vector<CopySetKey> CopySetDistribution::GetCopySetsInChunkServer(
+    ChunkServerIdType id) const {
+    ReadLockGuard rlock(lock_);
+    auto it = chunkServerCopySets_.find(id);
+    if (it == chunkServerCopySets_.end()) {
+        return {};
+    }
+    return std::vector<CopySetKey>(it->second.begin(), it->second.end());
+}
+
+std::vector<std::pair<ChunkServerIdType, uint32_t>>
+CopySetDistribution::GetChunkServersOrderByCopySetNum(
+    PoolIdType logicalPoolId) const {
+    std::vector<std::pair<ChunkServerIdType, uint32_t>> ret;
+    ReadLockGuard rlock(lock_);
+    auto it = poolDistributions_.find(logicalPoolId);
+    if (it == poolDistributions_.end()) {
+        return ret;
+    }
+
+    ret.reserve(it->second.ordered.size());
+    for (auto ix = it->second.ordered.rbegin();
+         ix != it->second.ordered.rend(); ++ix) {
+        ret.emplace_back(ix->second, ix->first);
+    }
+    return ret;
+}
+
+void CopySetDistribution::AddMemberLocked(const CopySetKey &key,
+                                          ChunkServerIdType id) {
+    if (!chunkServerCopySets_[id].insert(key).second) {
+        return;
+    }
+
+    auto &pool = poolDistributions_[key.first];
+    uint32_t &num = pool.copysetNum[id];
+    if (num > 0) {
+        pool.ordered.erase(std::make_pair(num, id));
+    }
+    ++num;
+    pool.ordered.emplace(num, id);
+}
+
+void CopySetDistribution::RemoveMemberLocked(const CopySetKey &key,
+                                             ChunkServerIdType id) {
+    auto it = chunkServerCopySets_.find(id);
+    if (it == chunkServerCopySets_.end() || it->second.erase(key) == 0) {
+        return;
+    }
+    if (it->second.empty()) {
+        chunkServerCopySets_.erase(it);
+    }
+
+    auto &pool = poolDistributions_[key.first];
+    auto ix = pool.copysetNum.find(id);
+    if (ix == pool.copysetNum.end()) {
+        return;
+    }
+    pool.ordered.erase(std::make_pair(ix->second, id));
+    if (--ix->second == 0) {
+        pool.copysetNum.erase(ix);
+    } else {
+        pool.ordered.emplace(ix->second, id);
+    }
+}
+
+}  // namespace topology
+}  // namespace mds
+}  // namespace curve
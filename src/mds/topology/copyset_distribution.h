@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#ifndef SRC_MDS_TOPOLOGY_COPYSET_DISTRIBUTION_H_
+#define SRC_MDS_TOPOLOGY_COPYSET_DISTRIBUTION_H_
+
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "src/mds/topology/topology_item.h"
+#include "src/common/concurrent/rw_lock.h"
+
+namespace curve {
+namespace mds {
+namespace topology {
+
+/**
+ * @brief index of copysets on every chunkserver, it is updated along with
+ *        the copyset changes in topology, so that copysets on a chunkserver
+ *        and chunkservers ordered by copyset number are got without
+ *        traversing all copysets
+ */
+class CopySetDistribution {
+ public:
+    CopySetDistribution() = default;
+
+    void AddCopySet(const CopySetKey &key,
+                    const std::set<ChunkServerIdType> &members);
+
+    void RemoveCopySet(const CopySetKey &key,
+                       const std::set<ChunkServerIdType> &members);
+
+    /**
+     * @brief update members of a copyset, only the chunkservers that
+     *        join or leave the copyset are touched
+     */
+    void UpdateCopySet(const CopySetKey &key,
+                       const std::set<ChunkServerIdType> &oldMembers,
+                       const std::set<ChunkServerIdType> &newMembers);
+
+    void Clear();
+
+    /**
+     * @brief get copysets on the chunkserver, ordered by copyset key
+     */
+    std::vector<CopySetKey> GetCopySetsInChunkServer(
+        ChunkServerIdType id) const;
+
+    /**
+     * @brief get copyset number of chunkservers in the logical pool,
+     *        chunkservers without any copyset are not included
+     *
+     * @return chunkservers in descending order of copyset number
+     */
+    std::vector<std::pair<ChunkServerIdType, uint32_t>>
+        GetChunkServersOrderByCopySetNum(PoolIdType logicalPoolId) const;
+
+ private:
+    struct PoolDistribution {
+        std::unordered_map<ChunkServerIdType, uint32_t> copysetNum;
+        // (copyset number, chunkserver id), kept in step with copysetNum
+        std::set<std::pair<uint32_t, ChunkServerIdType>> ordered;
+    };
+
+    void AddMemberLocked(const CopySetKey &key, ChunkServerIdType id);
+
+    void RemoveMemberLocked(const CopySetKey &key, ChunkServerIdType id);
+
+ private:
+    std::unordered_map<ChunkServerIdType, std::set<CopySetKey>>
+        chunkServerCopySets_;
+    std::unordered_map<PoolIdType, PoolDistribution> poolDistributions_;
+    mutable ::curve::common::RWLock lock_;
+};
+
+}  // namespace topology
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_TOPOLOGY_COPYSET_DISTRIBUTION_H_
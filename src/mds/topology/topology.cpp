@@ -24,14 +24,35 @@
 #include "src/common/timeutility.h"
 #include "src/common/uuid.h"
 
+#include <algorithm>
 #include <chrono>  //NOLINT
 
 using ::curve::common::UUIDGenerator;
+using ::curve::common::LockGuard;
 
 namespace curve {
 namespace mds {
 namespace topology {
 
+std::vector<std::pair<ChunkServerIdType, uint32_t>>
+Topology::GetChunkServersOrderByCopySetNum(PoolIdType logicalPoolId) const {
+    std::map<ChunkServerIdType, uint32_t> copysetNum;
+    for (const auto &copyset : GetCopySetInfosInLogicalPool(logicalPoolId)) {
+        for (auto id : copyset.GetCopySetMembers()) {
+            copysetNum[id]++;
+        }
+    }
+
+    std::vector<std::pair<ChunkServerIdType, uint32_t>> ret(
+        copysetNum.begin(), copysetNum.end());
+    std::stable_sort(ret.begin(), ret.end(),
+        [](const std::pair<ChunkServerIdType, uint32_t> &a,
+           const std::pair<ChunkServerIdType, uint32_t> &b) {
+            return a.second > b.second;
+        });
+    return ret;
+}
+
 PoolIdType TopologyImpl::AllocateLogicalPoolId() {
     return idGenerator_->GenLogicalPoolId();
 }
@@ -501,8 +522,8 @@ int TopologyImpl::UpdateChunkServerDiskStatus(const ChunkServerState &state,
         return ret;
     }
 
-    // fetch write lock of the physical pool and read lock of chunkserver map
-    WriteLockGuard wlockPhysicalPool(physicalPoolMutex_);
+    // update chunkserver first, the write lock of physical pool is only
+    // needed when disk capacity changes, which is rare for heartbeats
     int64_t diff = 0;
     {
         ReadLockGuard rlockChunkServerMap(chunkServerMutex_);
@@ -519,7 +540,12 @@ int TopologyImpl::UpdateChunkServerDiskStatus(const ChunkServerState &state,
             return kTopoErrCodeChunkServerNotFound;
         }
     }
+    if (diff == 0) {
+        return kTopoErrCodeSuccess;
+    }
+
     // update physical pool
+    WriteLockGuard wlockPhysicalPool(physicalPoolMutex_);
     auto it = physicalPoolMap_.find(belongPhysicalPoolId);
     if (it != physicalPoolMap_.end()) {
         uint64_t totalCapacity = it->second.GetDiskCapacity();
@@ -985,6 +1011,12 @@ int TopologyImpl::Init(const TopologyOption &option) {
         return kTopoErrCodeStorgeFail;
     }
     idGenerator_->initCopySetIdGenerator(copySetIdMaxMap);
+    copySetDistribution_.Clear();
+    for (const auto &item : copySetMap_) {
+        copySetDistribution_.AddCopySet(
+            item.first, item.second.GetCopySetMembers());
+    }
+    BumpCopySetVersion();
     LOG(INFO) << "[TopologyImpl::init], LoadCopySet success, "
               << "copyset num = " << copySetMap_.size();
 
@@ -1030,7 +1062,10 @@ int TopologyImpl::CleanInvalidLogicalPoolAndCopyset() {
                     if (!storage_->DeleteCopySet(it->first)) {
                         return kTopoErrCodeStorgeFail;
                     }
+                    copySetDistribution_.RemoveCopySet(
+                        it->first, it->second.GetCopySetMembers());
                     it = copySetMap_.erase(it);
+                    BumpCopySetVersion();
                 } else {
                     it++;
                 }
@@ -1062,6 +1097,8 @@ int TopologyImpl::AddCopySet(const CopySetInfo &data) {
                 return kTopoErrCodeStorgeFail;
             }
             copySetMap_[key] = data;
+            copySetDistribution_.AddCopySet(key, data.GetCopySetMembers());
+            BumpCopySetVersion();
             return kTopoErrCodeSuccess;
         } else {
             return kTopoErrCodeIdDuplicated;
@@ -1078,7 +1115,11 @@ int TopologyImpl::RemoveCopySet(CopySetKey key) {
         if (!storage_->DeleteCopySet(key)) {
             return kTopoErrCodeStorgeFail;
         }
-        copySetMap_.erase(key);
+        copySetDistribution_.RemoveCopySet(
+            key, it->second.GetCopySetMembers());
+        copySetMap_.erase(it);
+        BumpCopySetVersion();
+        copySetAvailVersion_.fetch_add(1, std::memory_order_acq_rel);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeCopySetNotFound;
@@ -1087,12 +1128,54 @@ int TopologyImpl::RemoveCopySet(CopySetKey key) {
 
 int TopologyImpl::UpdateCopySetTopo(const CopySetInfo &data) {
     ReadLockGuard rlockCopySetMap(copySetMutex_);
+    bool changed = false;
+    int ret = UpdateCopySetTopoLocked(data, &changed);
+    if (changed) {
+        BumpCopySetVersion();
+    }
+    return ret;
+}
+
+void TopologyImpl::UpdateCopySetsTopo(const std::vector<CopySetInfo> &datas,
+                                      std::vector<int> *errCodes) {
+    errCodes->clear();
+    errCodes->reserve(datas.size());
+    ReadLockGuard rlockCopySetMap(copySetMutex_);
+    // bump once for the whole batch, so readers rebuild the snapshot at
+    // most once per batch
+    bool changed = false;
+    for (const auto &data : datas) {
+        errCodes->push_back(UpdateCopySetTopoLocked(data, &changed));
+    }
+    if (changed) {
+        BumpCopySetVersion();
+    }
+}
+
+int TopologyImpl::UpdateCopySetTopoLocked(const CopySetInfo &data,
+                                          bool *changed) {
     CopySetKey key(data.GetLogicalPoolId(), data.GetId());
     auto it = copySetMap_.find(key);
     if (it != copySetMap_.end()) {
         WriteLockGuard wlockCopySet(it->second.GetRWLockRef());
+        // a report repeating the recorded state leaves the snapshot valid
+        if (it->second.GetLeader() == data.GetLeader() &&
+            it->second.GetEpoch() == data.GetEpoch() &&
+            it->second.GetCopySetMembers() == data.GetCopySetMembers() &&
+            it->second.HasCandidate() == data.HasCandidate() &&
+            (!data.HasCandidate() ||
+             it->second.GetCandidate() == data.GetCandidate()) &&
+            !data.IsLatestScaning(it->second.GetScaning()) &&
+            !data.IsLatestLastScanSec(it->second.GetLastScanSec())) {
+            return kTopoErrCodeSuccess;
+        }
+        *changed = true;
         it->second.SetLeader(data.GetLeader());
         it->second.SetEpoch(data.GetEpoch());
+        // the copyset lock serializes updates of the same copyset, so old
+        // members here are the ones recorded in distribution index
+        copySetDistribution_.UpdateCopySet(key,
+            it->second.GetCopySetMembers(), data.GetCopySetMembers());
         it->second.SetCopySetMembers(data.GetCopySetMembers());
         if (data.HasCandidate()) {
             it->second.SetCandidate(data.GetCandidate());
@@ -1130,7 +1213,11 @@ int TopologyImpl::SetCopySetAvalFlag(const CopySetKey &key, bool aval) {
             LOG(ERROR) << "UpdateCopySet met storage error";
             return kTopoErrCodeStorgeFail;
         }
+        if (it->second.IsAvailable() != aval) {
+            copySetAvailVersion_.fetch_add(1, std::memory_order_acq_rel);
+        }
         it->second.SetAvailableFlag(aval);
+        BumpCopySetVersion();
         return kTopoErrCodeSuccess;
     } else {
         LOG(WARNING) << "SetCopySetAvalFlag can not find copyset, "
@@ -1152,14 +1239,50 @@ bool TopologyImpl::GetCopySet(CopySetKey key, CopySetInfo *out) const {
     }
 }
 
+std::shared_ptr<const CopySetSnapshot>
+TopologyImpl::GetCopySetSnapshot() const {
+    auto snapshot = std::atomic_load(&copySetSnapshot_);
+    if (snapshot != nullptr && snapshot->version ==
+        copySetVersion_.load(std::memory_order_acquire)) {
+        return snapshot;
+    }
+
+    LockGuard lockSnapshot(snapshotMutex_);
+    // version is loaded before copying, a change during copying bumps the
+    // version again and the snapshot is rebuilt by next reader
+    uint64_t version = copySetVersion_.load(std::memory_order_acquire);
+    snapshot = std::atomic_load(&copySetSnapshot_);
+    if (snapshot != nullptr && snapshot->version == version) {
+        return snapshot;
+    }
+
+    auto newSnapshot = std::make_shared<CopySetSnapshot>();
+    newSnapshot->version = version;
+    {
+        ReadLockGuard rlockCopySetMap(copySetMutex_);
+        for (const auto &item : copySetMap_) {
+            ReadLockGuard rlockCopySet(item.second.GetRWLockRef());
+            newSnapshot->copySets.emplace_hint(
+                newSnapshot->copySets.end(), item.first, item.second);
+        }
+    }
+    snapshot = newSnapshot;
+    std::atomic_store(&copySetSnapshot_, snapshot);
+    return snapshot;
+}
+
 std::vector<CopySetIdType> TopologyImpl::GetCopySetsInLogicalPool(
     PoolIdType logicalPoolId,
     CopySetFilter filter) const {
     std::vector<CopySetIdType> ret;
-    ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
-        if (filter(it.second) && it.first.first == logicalPoolId) {
-            ret.push_back(it.first.second);
+    auto snapshot = GetCopySetSnapshot();
+    // copysets are sorted by logical pool id first
+    for (auto it = snapshot->copySets.lower_bound(
+            CopySetKey(logicalPoolId, 0));
+         it != snapshot->copySets.end() && it->first.first == logicalPoolId;
+         ++it) {
+        if (filter(it->second)) {
+            ret.push_back(it->first.second);
         }
     }
     return ret;
@@ -1169,10 +1292,13 @@ std::vector<CopySetInfo> TopologyImpl::GetCopySetInfosInLogicalPool(
     PoolIdType logicalPoolId,
     CopySetFilter filter) const {
     std::vector<CopySetInfo> ret;
-    ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
-        if (filter(it.second) && it.first.first == logicalPoolId) {
-            ret.push_back(it.second);
+    auto snapshot = GetCopySetSnapshot();
+    for (auto it = snapshot->copySets.lower_bound(
+            CopySetKey(logicalPoolId, 0));
+         it != snapshot->copySets.end() && it->first.first == logicalPoolId;
+         ++it) {
+        if (filter(it->second)) {
+            ret.push_back(it->second);
         }
     }
     return ret;
@@ -1181,8 +1307,8 @@ std::vector<CopySetInfo> TopologyImpl::GetCopySetInfosInLogicalPool(
 std::vector<CopySetKey> TopologyImpl::GetCopySetsInCluster(
     CopySetFilter filter) const {
     std::vector<CopySetKey> ret;
-    ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
+    auto snapshot = GetCopySetSnapshot();
+    for (const auto &it : snapshot->copySets) {
         if (filter(it.second)) {
             ret.push_back(it.first);
         }
@@ -1194,15 +1320,28 @@ std::vector<CopySetKey> TopologyImpl::GetCopySetsInChunkServer(
     ChunkServerIdType id,
     CopySetFilter filter) const {
     std::vector<CopySetKey> ret;
-    ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
-        if (filter(it.second) && it.second.GetCopySetMembers().count(id) > 0) {
-            ret.push_back(it.first);
+    ReadLockGuard rlockCopySetMap(copySetMutex_);
+    for (const auto &key : copySetDistribution_.GetCopySetsInChunkServer(id)) {
+        auto it = copySetMap_.find(key);
+        if (it == copySetMap_.end()) {
+            continue;
+        }
+        ReadLockGuard rlockCopySet(it->second.GetRWLockRef());
+        if (filter(it->second) &&
+            it->second.GetCopySetMembers().count(id) > 0) {
+            ret.push_back(key);
         }
     }
     return ret;
 }
 
+std::vector<std::pair<ChunkServerIdType, uint32_t>>
+TopologyImpl::GetChunkServersOrderByCopySetNum(
+    PoolIdType logicalPoolId) const {
+    return copySetDistribution_.GetChunkServersOrderByCopySetNum(
+        logicalPoolId);
+}
+
 int TopologyImpl::Run() {
     if (isStop_.exchange(false)) {
         backEndThread_ = curve::common::Thread(
@@ -22,16 +22,19 @@
 #ifndef SRC_MDS_TOPOLOGY_TOPOLOGY_H_
 #define SRC_MDS_TOPOLOGY_TOPOLOGY_H_
 
+#include <atomic>
 #include <unordered_map>
 #include <string>
 #include <list>
 #include <memory>
 #include <vector>
 #include <map>
+#include <utility>
 
 #include "proto/topology.pb.h"
 #include "src/mds/common/mds_define.h"
 #include "src/mds/topology/topology_item.h"
+#include "src/mds/topology/copyset_distribution.h"
 #include "src/mds/topology/topology_id_generator.h"
 #include "src/mds/topology/topology_token_generator.h"
 #include "src/mds/topology/topology_storge.h"
@@ -55,6 +58,16 @@ using PhysicalPoolFilter = std::function<bool (const PhysicalPool&)>;
 using LogicalPoolFilter = std::function<bool(const LogicalPool&)>;
 using CopySetFilter = std::function<bool (const CopySetInfo&)>;
 
+/**
+ * @brief immutable view of all copysets in topology, it is rebuilt after
+ *        copysets change and shared by readers until next change
+ */
+struct CopySetSnapshot {
+    // version of copysets when the snapshot is built
+    uint64_t version = 0;
+    std::map<CopySetKey, CopySetInfo> copySets;
+};
+
 class Topology {
  public:
     Topology() {}
@@ -181,8 +194,34 @@ class Topology {
      */
     virtual int UpdateCopySetTopo(const CopySetInfo &data) = 0;
 
+    /**
+     * @brief update a batch of copysets reported by heartbeat, see
+     *        UpdateCopySetTopo
+     *
+     * @param datas copysets data
+     * @param[out] errCodes error code of each copyset
+     */
+    virtual void UpdateCopySetsTopo(const std::vector<CopySetInfo> &datas,
+                                    std::vector<int> *errCodes) {
+        errCodes->clear();
+        errCodes->reserve(datas.size());
+        for (const auto &data : datas) {
+            errCodes->push_back(UpdateCopySetTopo(data));
+        }
+    }
+
     virtual int SetCopySetAvalFlag(const CopySetKey &key, bool aval) = 0;
 
+    /**
+     * @brief get the version of copyset available flags, it changes when
+     *        any copyset becomes available or unavailable, or is removed
+     *
+     * @return version of copyset available flags
+     */
+    virtual uint64_t GetCopySetAvailVersion() const {
+        return 0;
+    }
+
     virtual PoolIdType
         FindLogicalPool(const std::string &logicalPoolName,
                         const std::string &physicalPoolName) const = 0;
@@ -326,6 +365,17 @@ class Topology {
         GetCopySetsInChunkServer(ChunkServerIdType id,
         CopySetFilter filter = [](const CopySetInfo&) {
             return true;}) const = 0;
+
+    /**
+     * @brief get copyset number of chunkservers in the logical pool,
+     *        chunkservers without any copyset are not included
+     *
+     * @param logicalPoolId logical pool id
+     *
+     * @return chunkservers in descending order of copyset number
+     */
+    virtual std::vector<std::pair<ChunkServerIdType, uint32_t>>
+        GetChunkServersOrderByCopySetNum(PoolIdType logicalPoolId) const;
 };
 
 class TopologyImpl : public Topology {
@@ -336,6 +386,8 @@ class TopologyImpl : public Topology {
         : idGenerator_(idGenerator),
           tokenGenerator_(tokenGenerator),
           storage_(storage),
+          copySetVersion_(1),
+          copySetAvailVersion_(1),
           isStop_(true) {
     }
 
@@ -396,8 +448,18 @@ class TopologyImpl : public Topology {
 
     int UpdateCopySetTopo(const CopySetInfo &data) override;
 
+    /**
+     * @brief update copysets under one acquisition of copyset map lock
+     */
+    void UpdateCopySetsTopo(const std::vector<CopySetInfo> &datas,
+                            std::vector<int> *errCodes) override;
+
     int SetCopySetAvalFlag(const CopySetKey &key, bool aval) override;
 
+    uint64_t GetCopySetAvailVersion() const override {
+        return copySetAvailVersion_.load(std::memory_order_acquire);
+    }
+
     PoolIdType FindLogicalPool(const std::string &logicalPoolName,
         const std::string &physicalPoolName) const override;
     PoolIdType FindPhysicalPool(
@@ -545,6 +607,19 @@ class TopologyImpl : public Topology {
         CopySetFilter filter = [](const CopySetInfo&) {
             return true;}) const override;
 
+    std::vector<std::pair<ChunkServerIdType, uint32_t>>
+        GetChunkServersOrderByCopySetNum(
+            PoolIdType logicalPoolId) const override;
+
+    /**
+     * @brief get the snapshot of copysets, readers share one snapshot
+     *        without holding any lock, the snapshot is rebuilt lazily by
+     *        the first reader after copysets change
+     *
+     * @return snapshot reflecting all changes finished before the call
+     */
+    std::shared_ptr<const CopySetSnapshot> GetCopySetSnapshot() const;
+
     /**
      * @brief get physicalPool Id that the chunkserver belongs to
      *
@@ -570,6 +645,23 @@ class TopologyImpl : public Topology {
  private:
     int LoadClusterInfo();
 
+    /**
+     * @brief update copyset info, copySetMutex_ is held by caller
+     *
+     * @param data copyset info reported
+     * @param[out] changed set to true if the copyset is modified, the
+     *             caller bumps copyset version then
+     */
+    int UpdateCopySetTopoLocked(const CopySetInfo &data, bool *changed);
+
+    /**
+     * @brief mark copysets changed, called after copySetMap_ or any
+     *        copyset in it is modified
+     */
+    void BumpCopySetVersion() {
+        copySetVersion_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
     int CleanInvalidLogicalPoolAndCopyset();
 
     void BackEndFunc();
@@ -604,6 +696,18 @@ class TopologyImpl : public Topology {
     mutable curve::common::RWLock chunkServerMutex_;
     mutable curve::common::RWLock copySetMutex_;
 
+    // snapshot of copySetMap_, snapshotMutex_ serializes rebuilding and
+    // is fetched before copySetMutex_
+    mutable std::shared_ptr<const CopySetSnapshot> copySetSnapshot_;
+    mutable curve::common::Mutex snapshotMutex_;
+    std::atomic<uint64_t> copySetVersion_;
+    // version of copyset available flags
+    std::atomic<uint64_t> copySetAvailVersion_;
+
+    // copysets on every chunkserver, updated along with copySetMap_,
+    // fetched after copySetMutex_
+    CopySetDistribution copySetDistribution_;
+
     TopologyOption option_;
     curve::common::Thread backEndThread_;
     curve::common::Atomic<bool> isStop_;
@@ -24,11 +24,16 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <ctime>
 #include <vector>
 #include <list>
 #include <random>
+#include <utility>
+
+#include "src/common/timeutility.h"
 
 
 namespace curve {
@@ -54,6 +59,18 @@ bool TopologyChunkAllocatorImpl::AllocateChunkRandomInSingleLogicalPool(
         return false;
     }
 
+    if (ChooseCopysetPolicy::kWeight == copysetPolicy_) {
+        auto table = GetCopySetWeightTable(logicalPoolChosenId);
+        if (nullptr == table) {
+            LOG(ERROR) << "[AllocateChunkRandomInSingleLogicalPool]:"
+                       << " Does not have any available copySets,"
+                       << " logicalPoolId = " << logicalPoolChosenId;
+            return false;
+        }
+        return AllocateChunkPolicy::AllocateChunkByWeightInSingleLogicalPool(
+            *table, logicalPoolChosenId, chunkNumber, infos);
+    }
+
     CopySetFilter filter = [](const CopySetInfo& copyset) {
             return copyset.IsAvailable();
     };
@@ -215,6 +232,137 @@ bool TopologyChunkAllocatorImpl::ChooseSingleLogicalPool(
     }
 }
 
+std::shared_ptr<const CopySetWeightTable>
+TopologyChunkAllocatorImpl::GetCopySetWeightTable(PoolIdType logicalPoolId) {
+    std::shared_ptr<const CopySetWeightTable> table;
+    {
+        ::curve::common::ReadLockGuard rlock(copysetWeightTablesLock_);
+        auto it = copysetWeightTables_.find(logicalPoolId);
+        if (it != copysetWeightTables_.end()) {
+            table = it->second;
+        }
+    }
+
+    uint64_t now = ::curve::common::TimeUtility::GetTimeofDayMs();
+    uint64_t availVersion = topology_->GetCopySetAvailVersion();
+    if (table != nullptr && table->availVersion == availVersion &&
+        now - table->updateTimeMs < copysetWeightUpdateIntervalMs_) {
+        return table;
+    }
+
+    // the table is out of date, update it if no one else is updating,
+    // otherwise use the old one. A table built before some copyset became
+    // unavailable can not be used, wait for the update then
+    ::curve::common::UniqueLock lk(copysetWeightUpdateLock_,
+                                   std::defer_lock);
+    if (table != nullptr && table->availVersion == availVersion) {
+        if (!lk.try_lock()) {
+            return table;
+        }
+    } else {
+        lk.lock();
+    }
+
+    {
+        ::curve::common::ReadLockGuard rlock(copysetWeightTablesLock_);
+        auto it = copysetWeightTables_.find(logicalPoolId);
+        if (it != copysetWeightTables_.end() &&
+            it->second->availVersion == availVersion &&
+            now - it->second->updateTimeMs < copysetWeightUpdateIntervalMs_) {
+            // updated by others before getting the lock
+            return it->second;
+        }
+    }
+
+    auto newTable = BuildCopySetWeightTable(logicalPoolId, availVersion,
+                                            table);
+    ::curve::common::WriteLockGuard wlock(copysetWeightTablesLock_);
+    if (nullptr == newTable) {
+        copysetWeightTables_.erase(logicalPoolId);
+    } else {
+        copysetWeightTables_[logicalPoolId] = newTable;
+    }
+    return newTable;
+}
+
+std::shared_ptr<const CopySetWeightTable>
+TopologyChunkAllocatorImpl::BuildCopySetWeightTable(
+    PoolIdType logicalPoolId,
+    uint64_t availVersion,
+    const std::shared_ptr<const CopySetWeightTable> &oldTable) {
+    CopySetFilter filter = [](const CopySetInfo& copyset) {
+            return copyset.IsAvailable();
+    };
+    std::vector<CopySetInfo> copysets =
+        topology_->GetCopySetInfosInLogicalPool(logicalPoolId, filter);
+    if (copysets.empty()) {
+        return nullptr;
+    }
+
+    std::map<ChunkServerIdType, ChunkServerStat> stats;
+    if (nullptr != topologyStat_) {
+        for (const auto &copyset : copysets) {
+            for (auto csId : copyset.GetCopySetMembers()) {
+                if (stats.count(csId) != 0) {
+                    continue;
+                }
+                ChunkServerStat stat;
+                if (topologyStat_->GetChunkServerStat(csId, &stat)) {
+                    stat.copysetStats.clear();
+                    stats.emplace(csId, std::move(stat));
+                }
+            }
+        }
+    }
+    std::map<ChunkServerIdType, double> csWeights;
+    AllocateChunkPolicy::CalcChunkServerWeights(
+        stats, copysetWeightLoadPercent_, &csWeights);
+
+    auto table = std::make_shared<CopySetWeightTable>();
+    table->updateTimeMs = ::curve::common::TimeUtility::GetTimeofDayMs();
+    table->availVersion = availVersion;
+    table->copySetIds.reserve(copysets.size());
+    table->weights.reserve(copysets.size());
+    for (const auto &copyset : copysets) {
+        table->copySetIds.push_back(copyset.GetId());
+        table->weights.push_back(AllocateChunkPolicy::CalcCopySetWeight(
+            copyset.GetCopySetMembers(), csWeights));
+    }
+
+    // reuse the alias table if copysets are the same and no weight changes
+    // more than the threshold compared with the weights it is built from
+    if (nullptr != oldTable && oldTable->copySetIds == table->copySetIds) {
+        double threshold = copysetWeightRebuildPercent_ / 100.0;
+        bool changed = false;
+        for (size_t i = 0; i < table->weights.size(); i++) {
+            double oldWeight = oldTable->weights[i];
+            if (std::fabs(table->weights[i] - oldWeight) >
+                oldWeight * threshold) {
+                changed = true;
+                break;
+            }
+        }
+        if (!changed) {
+            table->weights = oldTable->weights;
+            table->aliasTable = oldTable->aliasTable;
+            return table;
+        }
+    }
+
+    if (!table->aliasTable.Build(table->weights)) {
+        // chunkservers are all full, pools are limited by
+        // ChooseSingleLogicalPool, so fall back to random here
+        LOG(WARNING) << "weights of all copysets are 0, choose copysets"
+                     << " randomly, logicalPoolId = " << logicalPoolId;
+        std::fill(table->weights.begin(), table->weights.end(), 1.0);
+        table->aliasTable.Build(table->weights);
+    }
+    LOG(INFO) << "rebuild copyset weight table, logicalPoolId = "
+              << logicalPoolId
+              << ", copyset num = " << table->copySetIds.size();
+    return table;
+}
+
 bool AllocateChunkPolicy::AllocateChunkRandomInSingleLogicalPool(
     std::vector<CopySetIdType> copySetIds,
     PoolIdType logicalPoolId,
@@ -312,6 +460,127 @@ bool AllocateChunkPolicy::ChooseSingleLogicalPoolRandom(
     return true;
 }
 
+bool AllocateChunkPolicy::AllocateChunkByWeightInSingleLogicalPool(
+    const CopySetWeightTable &table,
+    PoolIdType logicalPoolId,
+    uint32_t chunkNumber,
+    std::vector<CopysetIdInfo> *infos) {
+    if (table.aliasTable.Size() == 0 ||
+        table.aliasTable.Size() != table.copySetIds.size()) {
+        return false;
+    }
+    infos->clear();
+    infos->reserve(chunkNumber);
+
+    static thread_local std::mt19937 gen(std::random_device{}());
+    for (uint32_t i = 0; i < chunkNumber; i++) {
+        CopysetIdInfo idInfo;
+        idInfo.logicalPoolId = logicalPoolId;
+        idInfo.copySetId = table.copySetIds[table.aliasTable.Sample(&gen)];
+        infos->push_back(idInfo);
+    }
+    return true;
+}
+
+void AllocateChunkPolicy::CalcChunkServerWeights(
+    const std::map<ChunkServerIdType, ChunkServerStat> &stats,
+    uint32_t loadPercent,
+    std::map<ChunkServerIdType, double> *weights) {
+    double totalIOPS = 0;
+    for (const auto &item : stats) {
+        totalIOPS += item.second.readIOPS + item.second.writeIOPS;
+    }
+    double avgIOPS = stats.empty() ? 0 : totalIOPS / stats.size();
+    double loadFactor = loadPercent / 100.0;
+
+    for (const auto &item : stats) {
+        const ChunkServerStat &stat = item.second;
+        uint64_t capacity = stat.chunkSizeUsedBytes + stat.chunkSizeLeftBytes;
+        double freeRatio = (0 == capacity) ? 1.0 :
+            static_cast<double>(stat.chunkSizeLeftBytes) / capacity;
+        double loadRatio = (avgIOPS > 0) ?
+            (stat.readIOPS + stat.writeIOPS) / avgIOPS : 0;
+        (*weights)[item.first] = freeRatio / (1.0 + loadFactor * loadRatio);
+    }
+}
+
+double AllocateChunkPolicy::CalcCopySetWeight(
+    const std::set<ChunkServerIdType> &members,
+    const std::map<ChunkServerIdType, double> &csWeights) {
+    if (members.empty()) {
+        return 0;
+    }
+    double weight = 1.0;
+    for (auto csId : members) {
+        auto it = csWeights.find(csId);
+        if (it != csWeights.end()) {
+            weight = std::min(weight, it->second);
+        }
+    }
+    return weight;
+}
+
+bool AliasTable::Build(const std::vector<double> &weights) {
+    double sum = 0;
+    for (double w : weights) {
+        sum += w;
+    }
+    if (weights.empty() || !(sum > 0)) {
+        prob_.clear();
+        alias_.clear();
+        return false;
+    }
+
+    uint32_t n = weights.size();
+    prob_.assign(n, 1.0);
+    alias_.resize(n);
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (uint32_t i = 0; i < n; i++) {
+        alias_[i] = i;
+        scaled[i] = weights[i] * n / sum;
+        if (scaled[i] < 1.0) {
+            small.push_back(i);
+        } else {
+            large.push_back(i);
+        }
+    }
+
+    // pair a small one with a large one, the large one fills the rest of
+    // the small one's bucket
+    while (!small.empty() && !large.empty()) {
+        uint32_t l = small.back();
+        small.pop_back();
+        uint32_t g = large.back();
+        large.pop_back();
+
+        prob_[l] = scaled[l];
+        alias_[l] = g;
+        scaled[g] = (scaled[g] + scaled[l]) - 1.0;
+        if (scaled[g] < 1.0) {
+            small.push_back(g);
+        } else {
+            large.push_back(g);
+        }
+    }
+    // the rest are 1 except for rounding errors
+    for (auto i : small) {
+        prob_[i] = 1.0;
+    }
+    for (auto i : large) {
+        prob_[i] = 1.0;
+    }
+    return true;
+}
+
+uint32_t AliasTable::Sample(std::mt19937 *gen) const {
+    std::uniform_int_distribution<uint32_t> indexDis(0, prob_.size() - 1);
+    std::uniform_real_distribution<double> probDis(0, 1);
+    uint32_t i = indexDis(*gen);
+    return probDis(*gen) < prob_[i] ? i : alias_[i];
+}
+
 }  // namespace topology
 }  // namespace mds
 }  // namespace curve
@@ -27,8 +27,11 @@
 #include <memory>
 #include <functional>
 #include <map>
+#include <random>
+#include <set>
 
 #include "src/mds/topology/topology.h"
+#include "src/mds/topology/topology_stat.h"
 #include "proto/nameserver2.pb.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/mds/topology/topology_item.h"
@@ -45,6 +48,59 @@ enum class ChoosePoolPolicy {
     kWeight,
 };
 
+enum class ChooseCopysetPolicy {
+    // choose copysets randomly
+    kRandom = 0,
+    // use free space and load of chunkservers as the weight for choosing
+    // copysets
+    kWeight,
+};
+
+/**
+ * @brief alias table for sampling an index by weight in O(1) (Vose's alias
+ *        method), building the table takes O(n)
+ */
+class AliasTable {
+ public:
+    /**
+     * @brief build the table from weights
+     *
+     * @param weights non-negative weights
+     *
+     * @retval true if succeeded
+     * @retval false if weights are empty or all of them are 0
+     */
+    bool Build(const std::vector<double> &weights);
+
+    /**
+     * @brief sample an index, the probability of index i is
+     *        weights[i] / sum of weights
+     */
+    uint32_t Sample(std::mt19937 *gen) const;
+
+    uint32_t Size() const {
+        return prob_.size();
+    }
+
+ private:
+    // probability of choosing index i itself rather than alias_[i]
+    std::vector<double> prob_;
+    std::vector<uint32_t> alias_;
+};
+
+/**
+ * @brief copysets of a logical pool with their weights and alias table
+ */
+struct CopySetWeightTable {
+    std::vector<CopySetIdType> copySetIds;
+    std::vector<double> weights;
+    AliasTable aliasTable;
+    // time that weights are calculated (in ms)
+    uint64_t updateTimeMs = 0;
+    // copyset available version that the table is built with
+    uint64_t availVersion = 0;
+};
+
 class TopologyChunkAllocator {
  public:
     TopologyChunkAllocator() {}
@@ -65,12 +121,19 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
  public:
     TopologyChunkAllocatorImpl(std::shared_ptr<Topology> topology,
         std::shared_ptr<AllocStatistic> allocStatistic,
-        const TopologyOption &option)
+        const TopologyOption &option,
+        std::shared_ptr<TopologyStat> topologyStat = nullptr)
         : topology_(topology),
         allocStatistic_(allocStatistic),
+        topologyStat_(topologyStat),
         poolUsagePercentLimit_(option.PoolUsagePercentLimit),
         policy_(static_cast<ChoosePoolPolicy>(option.choosePoolPolicy)),
-        enableLogicalPoolStatus_(option.enableLogicalPoolStatus) {
+        enableLogicalPoolStatus_(option.enableLogicalPoolStatus),
+        copysetPolicy_(
+            static_cast<ChooseCopysetPolicy>(option.chooseCopysetPolicy)),
+        copysetWeightUpdateIntervalMs_(option.copysetWeightUpdateIntervalMs),
+        copysetWeightLoadPercent_(option.copysetWeightLoadPercent),
+        copysetWeightRebuildPercent_(option.copysetWeightRebuildPercent) {
         std::srand(std::time(nullptr));
     }
     ~TopologyChunkAllocatorImpl() {}
@@ -123,12 +186,43 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
     bool ChooseSingleLogicalPool(curve::mds::FileType fileType,
         PoolIdType *poolOut);
 
+    /**
+     * @brief get the copyset weight table of the logical pool, the table is
+     *        updated if it is older than copysetWeightUpdateIntervalMs_,
+     *        or any copyset becomes available or unavailable after it is
+     *        built
+     *
+     * @param logicalPoolId logical pool id
+     *
+     * @return weight table, nullptr if there is no available copyset
+     */
+    std::shared_ptr<const CopySetWeightTable> GetCopySetWeightTable(
+        PoolIdType logicalPoolId);
+
+    /**
+     * @brief calculate weights of available copysets in the logical pool,
+     *        the alias table is reused if no weight changes much
+     *
+     * @param logicalPoolId logical pool id
+     * @param availVersion copyset available version got before building
+     * @param oldTable current table of the logical pool, can be nullptr
+     *
+     * @return new weight table, nullptr if there is no available copyset
+     */
+    std::shared_ptr<const CopySetWeightTable> BuildCopySetWeightTable(
+        PoolIdType logicalPoolId,
+        uint64_t availVersion,
+        const std::shared_ptr<const CopySetWeightTable> &oldTable);
+
  private:
     std::shared_ptr<Topology> topology_;
 
     // allocation statistic module
     std::shared_ptr<AllocStatistic> allocStatistic_;
 
+    // heartbeat statistic of chunkservers, used for copyset weights
+    std::shared_ptr<TopologyStat> topologyStat_;
+
     // usage limit of pool
     uint32_t poolUsagePercentLimit_;
 
@@ -144,6 +238,19 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
     ChoosePoolPolicy policy_;
     // enableLogicalPoolStatus
     bool enableLogicalPoolStatus_;
+
+    // policy for choosing copysets
+    ChooseCopysetPolicy copysetPolicy_;
+    uint32_t copysetWeightUpdateIntervalMs_;
+    uint32_t copysetWeightLoadPercent_;
+    uint32_t copysetWeightRebuildPercent_;
+    // copyset weight tables of logical pools, a table is immutable once
+    // built and replaced as a whole
+    std::map<PoolIdType, std::shared_ptr<const CopySetWeightTable>>
+        copysetWeightTables_;
+    ::curve::common::RWLock copysetWeightTablesLock_;
+    // only one thread updates the tables at a time, others use the old ones
+    ::curve::common::Mutex copysetWeightUpdateLock_;
 };
 
 /**
@@ -218,6 +325,48 @@ class AllocateChunkPolicy {
     static bool ChooseSingleLogicalPoolRandom(
         const std::vector<PoolIdType> &pools,
         PoolIdType *poolIdOut);
+
+    /**
+     * @brief allocate chunks in a single logical pool, copysets are chosen
+     *        by their weights in O(1) for every chunk
+     *
+     * @param table copyset weight table of the logical pool
+     * @param logicalPoolId logical pool id
+     * @param chunkNumber number of chunks to allocate
+     * @param infos copyset list that chunks allocated to
+     *
+     * @retval true if succeeded
+     * @retval false if failed
+     */
+    static bool AllocateChunkByWeightInSingleLogicalPool(
+        const CopySetWeightTable &table,
+        PoolIdType logicalPoolId,
+        uint32_t chunkNumber,
+        std::vector<CopysetIdInfo> *infos);
+
+    /**
+     * @brief calculate weight of chunkservers, weight is the ratio of free
+     *        space, decreased by the IOPS compared to average of all the
+     *        chunkservers:
+     *        weight = freeRatio / (1 + loadPercent / 100 * IOPS / avgIOPS)
+     *
+     * @param stats heartbeat statistic of chunkservers
+     * @param loadPercent how much the load affects the weight
+     * @param[out] weights weight of every chunkserver, in [0, 1]
+     */
+    static void CalcChunkServerWeights(
+        const std::map<ChunkServerIdType, ChunkServerStat> &stats,
+        uint32_t loadPercent,
+        std::map<ChunkServerIdType, double> *weights);
+
+    /**
+     * @brief calculate weight of a copyset, that is the minimal weight of
+     *        its members, since a chunk is written to all of them.
+     *        Members without weight are regarded as idle and empty.
+     */
+    static double CalcCopySetWeight(
+        const std::set<ChunkServerIdType> &members,
+        const std::map<ChunkServerIdType, double> &csWeights);
 };
 
 
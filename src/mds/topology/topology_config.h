@@ -46,6 +46,16 @@ struct TopologyOption {
     int choosePoolPolicy;
     // enable LogicalPool ALLOW/DENY status
     bool enableLogicalPoolStatus;
+    // policy of choosing copysets in a logical pool
+    int chooseCopysetPolicy;
+    // time interval for updating weights of copysets (in ms)
+    uint32_t copysetWeightUpdateIntervalMs;
+    // how much the load of chunkservers affects the weight of copysets
+    // (in percent), 0 means only free space is considered
+    uint32_t copysetWeightLoadPercent;
+    // the sampling table of a logical pool is rebuilt only when weight of
+    // some copyset changes more than this threshold (in percent)
+    uint32_t copysetWeightRebuildPercent;
 
     TopologyOption()
         : TopologyUpdateToRepoSec(0),
@@ -55,7 +65,11 @@ struct TopologyOption {
           UpdateMetricIntervalSec(0),
           PoolUsagePercentLimit(100),
           choosePoolPolicy(0),
-          enableLogicalPoolStatus(false) {}
+          enableLogicalPoolStatus(false),
+          chooseCopysetPolicy(0),
+          copysetWeightUpdateIntervalMs(10000),
+          copysetWeightLoadPercent(100),
+          copysetWeightRebuildPercent(10) {}
 };
 
 }  // namespace topology
@@ -1341,6 +1341,9 @@ void TopologyServiceManager::GetChunkServerListInCopySets(
         if (topology_->GetCopySet(key, &csInfo)) {
             CopySetServerInfo *cssInfo = response->add_csinfo();
             cssInfo->set_copysetid(csInfo.GetId());
+            if (csInfo.GetLeader() != UNINTIALIZE_ID) {
+                cssInfo->set_leaderid(csInfo.GetLeader());
+            }
             for (ChunkServerIdType csId : csInfo.GetCopySetMembers()) {
                 ChunkServer cs;
                 if (topology_->GetChunkServer(csId, &cs)) {
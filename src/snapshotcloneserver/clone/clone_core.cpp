@@ -26,6 +26,10 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <map>
+#include <set>
+#include <utility>
+#include <algorithm>
 
 #include "src/snapshotcloneserver/clone/clone_task.h"
 #include "src/common/location_operator.h"
@@ -507,7 +511,16 @@ int CloneCoreImpl::BuildFileInfoFromSnapshot(
         snapMeta.GetChunkDataName(chunkIndex, &chunkDataName);
         uint64_t segmentIndex = chunkIndex / chunkPerSegment;
         CloneChunkInfo info;
-        info.location = chunkDataName.ToDataChunkKey();
+        // 打包存储的chunk从pack对象中的对应区域读取
+        ChunkPackLocation packLocation;
+        if (snapMeta.GetChunkPackLocation(chunkIndex, &packLocation)) {
+            info.location = LocationOperator::GenerateS3PackLocation(
+                packLocation.packKey, packLocation.offset,
+                packLocation.length);
+        } else {
+            info.location = LocationOperator::GenerateS3Location(
+                chunkDataName.ToDataChunkKey());
+        }
         info.needRecover = true;
         if (IsRecover(task)) {
             info.seqNum = chunkDataName.chunkSeqNum_;
@@ -709,23 +722,74 @@ int CloneCoreImpl::CreateCloneChunk(
     } else {
         correctSn = fInfo.seqnum;
     }
+    if (cloneChunkBatchSize_ > 1) {
+        ret = CreateCloneChunkInBatch(task, correctSn, chunkSize, segInfos);
+    } else {
+        ret = CreateCloneChunkOneByOne(task, correctSn, chunkSize, segInfos);
+    }
+    if (ret < 0) {
+        return kErrCodeInternalError;
+    }
+
+    if (IsLazy(task) && IsFile(task)) {
+        task->GetCloneInfo().SetNextStep(CloneStep::kRecoverChunk);
+    } else {
+        task->GetCloneInfo().SetNextStep(CloneStep::kCompleteCloneMeta);
+    }
+    ret = metaStore_->UpdateCloneInfo(task->GetCloneInfo());
+    if (ret < 0) {
+        LOG(ERROR) << "UpdateCloneInfo after CreateCloneChunk error."
+                   << " ret = " << ret
+                   << ", taskid = " << task->GetTaskId();
+        return kErrCodeInternalError;
+    }
+    return kErrCodeSuccess;
+}
+
+std::string CloneCoreImpl::GetCloneChunkLocation(
+    std::shared_ptr<CloneTaskInfo> task,
+    const CloneChunkInfo &cloneChunkInfo) {
+    if (IsSnapshot(task)) {
+        return cloneChunkInfo.location;
+    }
+    return LocationOperator::GenerateCurveLocation(
+        task->GetCloneInfo().GetSrc(),
+        std::stoull(cloneChunkInfo.location));
+}
+
+void CloneCoreImpl::SplitChunksIntoBatches(
+    const std::vector<ChunkIDInfo> &chunkIds,
+    std::vector<std::vector<size_t>> *batches) {
+    batches->clear();
+    // key为(logicalPoolId, copysetId)，value为该copyset当前未满的批次
+    std::map<std::pair<LogicPoolID, CopysetID>, size_t> openBatches;
+    for (size_t i = 0; i < chunkIds.size(); i++) {
+        auto key = std::make_pair(chunkIds[i].lpid_, chunkIds[i].cpid_);
+        auto it = openBatches.find(key);
+        if (it == openBatches.end() ||
+            (*batches)[it->second].size() >= cloneChunkBatchSize_) {
+            batches->emplace_back();
+            openBatches[key] = batches->size() - 1;
+            batches->back().push_back(i);
+        } else {
+            (*batches)[it->second].push_back(i);
+        }
+    }
+}
+
+int CloneCoreImpl::CreateCloneChunkOneByOne(
+    std::shared_ptr<CloneTaskInfo> task,
+    uint64_t correctSn,
+    uint64_t chunkSize,
+    CloneSegmentMap *segInfos) {
+    int ret = kErrCodeSuccess;
     auto tracker = std::make_shared<CreateCloneChunkTaskTracker>();
     for (auto & cloneSegmentInfo : *segInfos) {
         for (auto & cloneChunkInfo : cloneSegmentInfo.second) {
-            std::string location;
-            if (IsSnapshot(task)) {
-                location = LocationOperator::GenerateS3Location(
-                    cloneChunkInfo.second.location);
-            } else {
-                location = LocationOperator::GenerateCurveLocation(
-                    task->GetCloneInfo().GetSrc(),
-                    std::stoull(cloneChunkInfo.second.location));
-            }
-            ChunkIDInfo cidInfo = cloneChunkInfo.second.chunkIdInfo;
-
             auto context = std::make_shared<CreateCloneChunkContext>();
-            context->location = location;
-            context->cidInfo = cidInfo;
+            context->location =
+                GetCloneChunkLocation(task, cloneChunkInfo.second);
+            context->cidInfo = cloneChunkInfo.second.chunkIdInfo;
             context->cloneChunkInfo = &cloneChunkInfo.second;
             context->sn = cloneChunkInfo.second.seqNum;
             context->csn = correctSn;
@@ -765,19 +829,75 @@ int CloneCoreImpl::CreateCloneChunk(
             return kErrCodeInternalError;
         }
     } while (true);
+    return kErrCodeSuccess;
+}
 
-    if (IsLazy(task) && IsFile(task)) {
-        task->GetCloneInfo().SetNextStep(CloneStep::kRecoverChunk);
-    } else {
-        task->GetCloneInfo().SetNextStep(CloneStep::kCompleteCloneMeta);
+int CloneCoreImpl::CreateCloneChunkInBatch(
+    std::shared_ptr<CloneTaskInfo> task,
+    uint64_t correctSn,
+    uint64_t chunkSize,
+    CloneSegmentMap *segInfos) {
+    int ret = kErrCodeSuccess;
+    std::vector<CloneChunkInfo *> chunks;
+    std::vector<ChunkIDInfo> chunkIds;
+    for (auto & cloneSegmentInfo : *segInfos) {
+        for (auto & cloneChunkInfo : cloneSegmentInfo.second) {
+            chunks.push_back(&cloneChunkInfo.second);
+            chunkIds.push_back(cloneChunkInfo.second.chunkIdInfo);
+        }
     }
-    ret = metaStore_->UpdateCloneInfo(task->GetCloneInfo());
-    if (ret < 0) {
-        LOG(ERROR) << "UpdateCloneInfo after CreateCloneChunk error."
-                   << " ret = " << ret
-                   << ", taskid = " << task->GetTaskId();
-        return kErrCodeInternalError;
+    std::vector<std::vector<size_t>> batches;
+    SplitChunksIntoBatches(chunkIds, &batches);
+
+    auto tracker = std::make_shared<CreateCloneChunkBatchTaskTracker>();
+    for (auto &batch : batches) {
+        auto context = std::make_shared<CreateCloneChunkBatchContext>();
+        for (size_t index : batch) {
+            ChunkBatchItem item;
+            item.idinfo = chunks[index]->chunkIdInfo;
+            item.location = GetCloneChunkLocation(task, *chunks[index]);
+            item.sn = chunks[index]->seqNum;
+            context->items.push_back(item);
+            context->cloneChunkInfos.push_back(chunks[index]);
+        }
+        context->csn = correctSn;
+        context->chunkSize = chunkSize;
+        context->taskid = task->GetTaskId();
+        context->startTime = TimeUtility::GetTimeofDaySec();
+        context->clientAsyncMethodRetryTimeSec =
+            clientAsyncMethodRetryTimeSec_;
+
+        ret = StartAsyncCreateCloneChunkBatch(task, tracker, context);
+        if (ret < 0) {
+            return kErrCodeInternalError;
+        }
+
+        if (tracker->GetTaskNum() >= createCloneChunkConcurrency_) {
+            tracker->WaitSome(1);
+        }
+        std::list<CreateCloneChunkBatchContextPtr> results =
+            tracker->PopResultContexts();
+        ret = HandleCreateCloneChunkBatchResultsAndRetry(
+            task, tracker, results);
+        if (ret < 0) {
+            return kErrCodeInternalError;
+        }
     }
+    // 最后剩余数量不足的任务
+    do {
+        tracker->WaitSome(1);
+        std::list<CreateCloneChunkBatchContextPtr> results =
+            tracker->PopResultContexts();
+        if (0 == results.size()) {
+            // 已经完成，没有新的结果了
+            break;
+        }
+        ret = HandleCreateCloneChunkBatchResultsAndRetry(
+            task, tracker, results);
+        if (ret < 0) {
+            return kErrCodeInternalError;
+        }
+    } while (true);
     return kErrCodeSuccess;
 }
 
@@ -858,6 +978,101 @@ int CloneCoreImpl::HandleCreateCloneChunkResultsAndRetry(
     return ret;
 }
 
+int CloneCoreImpl::StartAsyncCreateCloneChunkBatch(
+    std::shared_ptr<CloneTaskInfo> task,
+    std::shared_ptr<CreateCloneChunkBatchTaskTracker> tracker,
+    std::shared_ptr<CreateCloneChunkBatchContext> context) {
+    for (auto &item : context->items) {
+        item.retCode = -LIBCURVE_ERROR::FAILED;
+    }
+    CreateCloneChunkBatchClosure *cb =
+        new CreateCloneChunkBatchClosure(tracker, context);
+    tracker->AddOneTrace();
+    LOG(INFO) << "Doing CreateCloneChunks"
+              << ", logicalPoolId = " << context->items.front().idinfo.lpid_
+              << ", copysetId = " << context->items.front().idinfo.cpid_
+              << ", chunkNum = " << context->items.size()
+              << ", csn = " << context->csn
+              << ", taskid = " << task->GetTaskId();
+    int ret = client_->CreateCloneChunks(&context->items,
+        context->csn,
+        context->chunkSize,
+        cb);
+
+    if (ret != LIBCURVE_ERROR::OK) {
+        LOG(ERROR) << "CreateCloneChunks fail"
+                   << ", ret = " << ret
+                   << ", logicalPoolId = "
+                   << context->items.front().idinfo.lpid_
+                   << ", copysetId = " << context->items.front().idinfo.cpid_
+                   << ", chunkNum = " << context->items.size()
+                   << ", csn = " << context->csn
+                   << ", taskid = " << task->GetTaskId();
+        return ret;
+    }
+    return kErrCodeSuccess;
+}
+
+int CloneCoreImpl::HandleCreateCloneChunkBatchResultsAndRetry(
+    std::shared_ptr<CloneTaskInfo> task,
+    std::shared_ptr<CreateCloneChunkBatchTaskTracker> tracker,
+    const std::list<CreateCloneChunkBatchContextPtr> &results) {
+    for (auto context : results) {
+        int retCode = context->retCode;
+        if (retCode == LIBCURVE_ERROR::OK) {
+            // 去掉已完成的chunk，只重试失败的chunk
+            size_t remain = 0;
+            for (size_t i = 0; i < context->items.size(); i++) {
+                const ChunkBatchItem &item = context->items[i];
+                if (item.retCode == LIBCURVE_ERROR::OK) {
+                    continue;
+                }
+                if (item.retCode == -LIBCURVE_ERROR::EXISTS) {
+                    LOG(INFO) << "CreateCloneChunk chunk exist"
+                              << ", location = " << item.location
+                              << ", logicalPoolId = " << item.idinfo.lpid_
+                              << ", copysetId = " << item.idinfo.cpid_
+                              << ", chunkId = " << item.idinfo.cid_
+                              << ", seqNum = " << item.sn
+                              << ", csn = " << context->csn
+                              << ", taskid = " << task->GetTaskId();
+                    context->cloneChunkInfos[i]->needRecover = false;
+                    continue;
+                }
+                retCode = item.retCode;
+                context->items[remain] = item;
+                context->cloneChunkInfos[remain] =
+                    context->cloneChunkInfos[i];
+                remain++;
+            }
+            context->items.resize(remain);
+            context->cloneChunkInfos.resize(remain);
+            if (0 == remain) {
+                continue;
+            }
+        }
+        uint64_t nowTime = TimeUtility::GetTimeofDaySec();
+        if (nowTime - context->startTime <
+            context->clientAsyncMethodRetryTimeSec) {
+            // retry
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(
+                    clientAsyncMethodRetryIntervalMs_));
+            int ret = StartAsyncCreateCloneChunkBatch(
+                task, tracker, context);
+            if (ret < 0) {
+                return kErrCodeInternalError;
+            }
+        } else {
+            LOG(ERROR) << "CreateCloneChunks tracker GetResult fail"
+                       << ", ret = " << retCode
+                       << ", taskid = " << task->GetTaskId();
+            return kErrCodeInternalError;
+        }
+    }
+    return kErrCodeSuccess;
+}
+
 int CloneCoreImpl::CompleteCloneMeta(
     std::shared_ptr<CloneTaskInfo> task,
     const FInfo &fInfo,
@@ -898,12 +1113,6 @@ int CloneCoreImpl::RecoverChunk(
     int ret = kErrCodeSuccess;
     uint32_t chunkSize = fInfo.chunksize;
 
-    uint32_t totalProgress =
-        kProgressRecoverChunkEnd - kProgressRecoverChunkBegin;
-    uint32_t segNum = segInfos.size();
-    double progressPerData = static_cast<double>(totalProgress) / segNum;
-    uint32_t index = 0;
-
     if (0 == cloneChunkSplitSize_ ||
         chunkSize % cloneChunkSplitSize_ != 0) {
         LOG(ERROR) << "chunk is not align to cloneChunkSplitSize"
@@ -911,49 +1120,110 @@ int CloneCoreImpl::RecoverChunk(
         return kErrCodeChunkSizeNotAligned;
     }
 
-    auto tracker = std::make_shared<RecoverChunkTaskTracker>();
-    uint64_t workingChunkNum = 0;
-    // 为避免发往同一个chunk碰撞，异步请求不同的chunk
-    for (auto & cloneSegmentInfo : segInfos) {
-        for (auto & cloneChunkInfo : cloneSegmentInfo.second) {
-            if (!cloneChunkInfo.second.needRecover) {
-                continue;
-            }
-            // 当前并发工作的chunk数已大于要求的并发数时，先消化一部分
-            while (workingChunkNum >= recoverChunkConcurrency_) {
-                uint64_t completeChunkNum = 0;
-                ret = ContinueAsyncRecoverChunkPartAndWaitSomeChunkEnd(task,
-                    tracker,
-                    &completeChunkNum);
-                if (ret < 0) {
-                    return kErrCodeInternalError;
-                }
-                workingChunkNum -= completeChunkNum;
+    // 懒克隆从快照克隆时，之前从同一快照克隆的文件恢复前已被访问过的
+    // chunk很可能也是本次最先被访问的，优先恢复这些chunk
+    bool useHotChunk = IsLazy(task) && IsSnapshot(task);
+    ChunkIndexDataName hotIndexName;
+    std::vector<ChunkIndexType> hotChunkIndexes;
+    if (useHotChunk) {
+        SnapshotInfo snapInfo;
+        ret = metaStore_->GetSnapshotInfo(
+            task->GetCloneInfo().GetSrc(), &snapInfo);
+        if (ret < 0) {
+            LOG(WARNING) << "GetSnapshotInfo fail, skip hot chunk"
+                         << ", source = " << task->GetCloneInfo().GetSrc()
+                         << ", taskid = " << task->GetTaskId();
+            useHotChunk = false;
+        } else {
+            hotIndexName = ChunkIndexDataName(snapInfo.GetFileName(),
+                snapInfo.GetSeqNum());
+            if (dataStore_->GetHotChunkIndex(hotIndexName,
+                    &hotChunkIndexes) < 0) {
+                LOG(WARNING) << "GetHotChunkIndex fail"
+                             << ", taskid = " << task->GetTaskId();
+                hotChunkIndexes.clear();
             }
-            // 加入新的工作的chunk
-            workingChunkNum++;
-            auto context = std::make_shared<RecoverChunkContext>();
-            context->cidInfo = cloneChunkInfo.second.chunkIdInfo;
-            context->totalPartNum = chunkSize / cloneChunkSplitSize_;
-            context->partIndex = 0;
-            context->partSize = cloneChunkSplitSize_;
-            context->taskid = task->GetTaskId();
-            context->startTime = TimeUtility::GetTimeofDaySec();
-            context->clientAsyncMethodRetryTimeSec =
-                clientAsyncMethodRetryTimeSec_;
+        }
+    }
+    RecoverChunkList chunks;
+    BuildRecoverChunkList(fInfo, segInfos, hotChunkIndexes, &chunks);
 
-            LOG(INFO) << "RecoverChunk start"
-                       << ", logicalPoolId = "
-                       << context->cidInfo.lpid_
-                       << ", copysetId = " << context->cidInfo.cpid_
-                       << ", chunkId = " << context->cidInfo.cid_
-                       << ", len = " << context->partSize
-                       << ", taskid = " << task->GetTaskId();
+    // 只有批量请求的返回中带有chunk是否已被用户访问过的信息
+    std::set<uint64_t> accessedChunkIndexes;
+    if (cloneChunkBatchSize_ > 1) {
+        ret = RecoverChunkInBatch(task, chunkSize, chunks,
+            &accessedChunkIndexes);
+    } else {
+        ret = RecoverChunkOneByOne(task, chunkSize, chunks);
+    }
+    if (ret < 0) {
+        return kErrCodeInternalError;
+    }
+    // 重启后恢复或重试的任务，之前已恢复过的chunk也会在本地，不能记录
+    if (useHotChunk && cloneChunkBatchSize_ > 1 && !task->IsResumed()) {
+        SaveHotChunkIndex(task, hotIndexName, accessedChunkIndexes);
+    }
 
-            ret = StartAsyncRecoverChunkPart(task, tracker, context);
+    task->GetCloneInfo().SetNextStep(CloneStep::kCompleteCloneFile);
+    ret = metaStore_->UpdateCloneInfo(task->GetCloneInfo());
+    if (ret < 0) {
+        LOG(ERROR) << "UpdateCloneInfo after RecoverChunk error."
+                   << " ret = " << ret
+                   << ", taskid = " << task->GetTaskId();
+        return kErrCodeInternalError;
+    }
+    return kErrCodeSuccess;
+}
+
+int CloneCoreImpl::RecoverChunkOneByOne(
+    std::shared_ptr<CloneTaskInfo> task,
+    uint64_t chunkSize,
+    const RecoverChunkList &chunks) {
+    int ret = kErrCodeSuccess;
+    uint32_t totalProgress =
+        kProgressRecoverChunkEnd - kProgressRecoverChunkBegin;
+    double progressPerData =
+        static_cast<double>(totalProgress) / chunks.size();
+    uint32_t index = 0;
+
+    auto tracker = std::make_shared<RecoverChunkTaskTracker>();
+    uint64_t workingChunkNum = 0;
+    // 为避免发往同一个chunk碰撞，异步请求不同的chunk
+    for (auto &chunk : chunks) {
+        // 当前并发工作的chunk数已大于要求的并发数时，先消化一部分
+        while (workingChunkNum >= recoverChunkConcurrency_) {
+            uint64_t completeChunkNum = 0;
+            ret = ContinueAsyncRecoverChunkPartAndWaitSomeChunkEnd(task,
+                tracker,
+                &completeChunkNum);
             if (ret < 0) {
                 return kErrCodeInternalError;
             }
+            workingChunkNum -= completeChunkNum;
+        }
+        // 加入新的工作的chunk
+        workingChunkNum++;
+        auto context = std::make_shared<RecoverChunkContext>();
+        context->cidInfo = chunk.second->chunkIdInfo;
+        context->totalPartNum = chunkSize / cloneChunkSplitSize_;
+        context->partIndex = 0;
+        context->partSize = cloneChunkSplitSize_;
+        context->taskid = task->GetTaskId();
+        context->startTime = TimeUtility::GetTimeofDaySec();
+        context->clientAsyncMethodRetryTimeSec =
+            clientAsyncMethodRetryTimeSec_;
+
+        LOG(INFO) << "RecoverChunk start"
+                   << ", logicalPoolId = "
+                   << context->cidInfo.lpid_
+                   << ", copysetId = " << context->cidInfo.cpid_
+                   << ", chunkId = " << context->cidInfo.cid_
+                   << ", len = " << context->partSize
+                   << ", taskid = " << task->GetTaskId();
+
+        ret = StartAsyncRecoverChunkPart(task, tracker, context);
+        if (ret < 0) {
+            return kErrCodeInternalError;
         }
         task->SetProgress(static_cast<uint32_t>(
             kProgressRecoverChunkBegin + index * progressPerData));
@@ -971,18 +1241,188 @@ int CloneCoreImpl::RecoverChunk(
         }
         workingChunkNum -= completeChunkNum;
     }
+    return kErrCodeSuccess;
+}
 
-    task->GetCloneInfo().SetNextStep(CloneStep::kCompleteCloneFile);
-    ret = metaStore_->UpdateCloneInfo(task->GetCloneInfo());
-    if (ret < 0) {
-        LOG(ERROR) << "UpdateCloneInfo after RecoverChunk error."
-                   << " ret = " << ret
-                   << ", taskid = " << task->GetTaskId();
-        return kErrCodeInternalError;
+int CloneCoreImpl::RecoverChunkInBatch(
+    std::shared_ptr<CloneTaskInfo> task,
+    uint64_t chunkSize,
+    const RecoverChunkList &chunks,
+    std::set<uint64_t> *accessedChunkIndexes) {
+    int ret = kErrCodeSuccess;
+    std::vector<ChunkIDInfo> chunkIds;
+    for (auto &chunk : chunks) {
+        chunkIds.push_back(chunk.second->chunkIdInfo);
+    }
+    std::vector<std::vector<size_t>> batches;
+    SplitChunksIntoBatches(chunkIds, &batches);
+
+    uint32_t totalProgress =
+        kProgressRecoverChunkEnd - kProgressRecoverChunkBegin;
+    uint64_t completeChunkNum = 0;
+    auto updateProgress = [&] () {
+        task->SetProgress(static_cast<uint32_t>(kProgressRecoverChunkBegin +
+            static_cast<double>(totalProgress) * completeChunkNum /
+            chunkIds.size()));
+        task->UpdateMetric();
+    };
+
+    auto tracker = std::make_shared<RecoverChunkBatchTaskTracker>();
+    uint64_t workingBatchNum = 0;
+    for (auto &batch : batches) {
+        // 当前并发的批次数已大于要求的并发数时，先消化一部分
+        while (workingBatchNum >= recoverChunkConcurrency_) {
+            uint64_t completeBatchNum = 0;
+            ret = ContinueAsyncRecoverChunkBatchAndWaitSomeBatchEnd(task,
+                tracker,
+                &completeBatchNum,
+                &completeChunkNum,
+                accessedChunkIndexes);
+            if (ret < 0) {
+                return kErrCodeInternalError;
+            }
+            workingBatchNum -= completeBatchNum;
+            updateProgress();
+        }
+        workingBatchNum++;
+        auto context = std::make_shared<RecoverChunkBatchContext>();
+        for (size_t index : batch) {
+            ChunkBatchItem item;
+            item.idinfo = chunkIds[index];
+            item.offset = 0;
+            item.len = cloneChunkSplitSize_;
+            context->items.push_back(item);
+            context->partIndexes.push_back(0);
+            context->chunkIndexes.push_back(chunks[index].first);
+            context->retried.push_back(false);
+        }
+        context->totalPartNum = chunkSize / cloneChunkSplitSize_;
+        context->partSize = cloneChunkSplitSize_;
+        context->taskid = task->GetTaskId();
+        context->startTime = TimeUtility::GetTimeofDaySec();
+        context->clientAsyncMethodRetryTimeSec =
+            clientAsyncMethodRetryTimeSec_;
+
+        LOG(INFO) << "RecoverChunks start"
+                  << ", logicalPoolId = "
+                  << context->items.front().idinfo.lpid_
+                  << ", copysetId = " << context->items.front().idinfo.cpid_
+                  << ", chunkNum = " << context->items.size()
+                  << ", len = " << context->partSize
+                  << ", taskid = " << task->GetTaskId();
+
+        ret = StartAsyncRecoverChunkBatch(task, tracker, context);
+        if (ret < 0) {
+            return kErrCodeInternalError;
+        }
+    }
+
+    while (workingBatchNum > 0) {
+        uint64_t completeBatchNum = 0;
+        ret = ContinueAsyncRecoverChunkBatchAndWaitSomeBatchEnd(task,
+            tracker,
+            &completeBatchNum,
+            &completeChunkNum,
+            accessedChunkIndexes);
+        if (ret < 0) {
+            return kErrCodeInternalError;
+        }
+        workingBatchNum -= completeBatchNum;
+        updateProgress();
     }
     return kErrCodeSuccess;
 }
 
+void CloneCoreImpl::BuildRecoverChunkList(
+    const FInfo &fInfo,
+    const CloneSegmentMap &segInfos,
+    const std::vector<ChunkIndexType> &hotChunkIndexes,
+    RecoverChunkList *chunks) {
+    chunks->clear();
+    uint64_t chunkPerSegment = 0;
+    if (fInfo.chunksize != 0) {
+        chunkPerSegment = fInfo.segmentsize / fInfo.chunksize;
+    }
+    for (auto & cloneSegmentInfo : segInfos) {
+        for (auto & cloneChunkInfo : cloneSegmentInfo.second) {
+            if (cloneChunkInfo.second.needRecover) {
+                chunks->emplace_back(
+                    cloneSegmentInfo.first * chunkPerSegment +
+                        cloneChunkInfo.first,
+                    &cloneChunkInfo.second);
+            }
+        }
+    }
+    if (hotChunkIndexes.empty()) {
+        return;
+    }
+    // 按在hotChunkIndexes中的位置排序，其余chunk保持原有顺序排在最后
+    std::map<uint64_t, size_t> hotRank;
+    for (size_t i = 0; i < hotChunkIndexes.size(); i++) {
+        hotRank.emplace(hotChunkIndexes[i], i);
+    }
+    auto rankOf = [&hotRank] (uint64_t chunkIndex) {
+        auto it = hotRank.find(chunkIndex);
+        return it == hotRank.end() ? hotRank.size() : it->second;
+    };
+    std::stable_sort(chunks->begin(), chunks->end(),
+        [&rankOf] (const RecoverChunkList::value_type &a,
+                   const RecoverChunkList::value_type &b) {
+            return rankOf(a.first) < rankOf(b.first);
+        });
+}
+
+void CloneCoreImpl::SaveHotChunkIndex(
+    std::shared_ptr<CloneTaskInfo> task,
+    const ChunkIndexDataName &name,
+    const std::set<uint64_t> &accessedChunkIndexes) {
+    if (accessedChunkIndexes.empty()) {
+        return;
+    }
+    // 同一快照的其他克隆可能已更新记录，加锁后重新读取再合并
+    NameLockGuard lockGuard(hotChunkLock_, name.ToHotChunkIndexKey());
+    std::vector<ChunkIndexType> hotChunkIndexes;
+    int ret = dataStore_->GetHotChunkIndex(name, &hotChunkIndexes);
+    if (ret < 0) {
+        LOG(WARNING) << "GetHotChunkIndex fail, skip saving hot chunk"
+                     << ", ret = " << ret
+                     << ", fileName = " << name.fileName_
+                     << ", seqNum = " << name.fileSeqNum_
+                     << ", taskid = " << task->GetTaskId();
+        return;
+    }
+    std::vector<ChunkIndexType> newHotChunkIndexes(
+        accessedChunkIndexes.begin(), accessedChunkIndexes.end());
+    for (ChunkIndexType chunkIndex : hotChunkIndexes) {
+        if (newHotChunkIndexes.size() >= hotChunkListMaxSize_) {
+            break;
+        }
+        if (accessedChunkIndexes.count(chunkIndex) == 0) {
+            newHotChunkIndexes.push_back(chunkIndex);
+        }
+    }
+    if (newHotChunkIndexes.size() > hotChunkListMaxSize_) {
+        newHotChunkIndexes.resize(hotChunkListMaxSize_);
+    }
+    if (newHotChunkIndexes == hotChunkIndexes) {
+        return;
+    }
+    ret = dataStore_->PutHotChunkIndex(name, newHotChunkIndexes);
+    if (ret < 0) {
+        LOG(WARNING) << "PutHotChunkIndex fail"
+                     << ", ret = " << ret
+                     << ", fileName = " << name.fileName_
+                     << ", seqNum = " << name.fileSeqNum_
+                     << ", taskid = " << task->GetTaskId();
+        return;
+    }
+    LOG(INFO) << "PutHotChunkIndex success"
+              << ", fileName = " << name.fileName_
+              << ", seqNum = " << name.fileSeqNum_
+              << ", hotChunkNum = " << newHotChunkIndexes.size()
+              << ", taskid = " << task->GetTaskId();
+}
+
 int CloneCoreImpl::StartAsyncRecoverChunkPart(
     std::shared_ptr<CloneTaskInfo> task,
     std::shared_ptr<RecoverChunkTaskTracker> tracker,
@@ -1068,6 +1508,131 @@ int CloneCoreImpl::ContinueAsyncRecoverChunkPartAndWaitSomeChunkEnd(
     return kErrCodeSuccess;
 }
 
+int CloneCoreImpl::StartAsyncRecoverChunkBatch(
+    std::shared_ptr<CloneTaskInfo> task,
+    std::shared_ptr<RecoverChunkBatchTaskTracker> tracker,
+    std::shared_ptr<RecoverChunkBatchContext> context) {
+    for (auto &item : context->items) {
+        item.retCode = -LIBCURVE_ERROR::FAILED;
+        item.accessed = false;
+    }
+    RecoverChunkBatchClosure *cb =
+        new RecoverChunkBatchClosure(tracker, context);
+    tracker->AddOneTrace();
+    LOG_EVERY_SECOND(INFO) << "Doing RecoverChunks"
+               << ", logicalPoolId = "
+               << context->items.front().idinfo.lpid_
+               << ", copysetId = " << context->items.front().idinfo.cpid_
+               << ", chunkNum = " << context->items.size()
+               << ", len = " << context->partSize
+               << ", taskid = " << task->GetTaskId();
+    int ret = client_->RecoverChunks(&context->items, cb);
+    if (ret != LIBCURVE_ERROR::OK) {
+        LOG(ERROR) << "RecoverChunks fail"
+                   << ", ret = " << ret
+                   << ", logicalPoolId = "
+                   << context->items.front().idinfo.lpid_
+                   << ", copysetId = " << context->items.front().idinfo.cpid_
+                   << ", chunkNum = " << context->items.size()
+                   << ", len = " << context->partSize
+                   << ", taskid = " << task->GetTaskId();
+        return ret;
+    }
+    return kErrCodeSuccess;
+}
+
+int CloneCoreImpl::ContinueAsyncRecoverChunkBatchAndWaitSomeBatchEnd(
+    std::shared_ptr<CloneTaskInfo> task,
+    std::shared_ptr<RecoverChunkBatchTaskTracker> tracker,
+    uint64_t *completeBatchNum,
+    uint64_t *completeChunkNum,
+    std::set<uint64_t> *accessedChunkIndexes) {
+    *completeBatchNum = 0;
+    tracker->WaitSome(1);
+    std::list<RecoverChunkBatchContextPtr> results =
+        tracker->PopResultContexts();
+    for (auto context : results) {
+        int retCode = context->retCode;
+        if (retCode == LIBCURVE_ERROR::OK) {
+            // 完成分片的chunk开始下一个分片，全部分片完成的chunk移出批次
+            bool progress = false;
+            size_t remain = 0;
+            for (size_t i = 0; i < context->items.size(); i++) {
+                ChunkBatchItem item = context->items[i];
+                uint64_t partIndex = context->partIndexes[i];
+                uint64_t chunkIndex = context->chunkIndexes[i];
+                bool retried = context->retried[i];
+                if (item.retCode == LIBCURVE_ERROR::OK) {
+                    progress = true;
+                    // 只记录首次请求时就已被用户读写过的chunk，重试的分片
+                    // 可能已由之前失败的请求拷贝到本地
+                    if (item.accessed && !retried) {
+                        accessedChunkIndexes->insert(chunkIndex);
+                    }
+                    retried = false;
+                    partIndex++;
+                    if (partIndex >= context->totalPartNum) {
+                        LOG(INFO) << "RecoverChunk Complete"
+                                  << ", logicalPoolId = "
+                                  << item.idinfo.lpid_
+                                  << ", copysetId = " << item.idinfo.cpid_
+                                  << ", chunkId = " << item.idinfo.cid_
+                                  << ", len = " << context->partSize
+                                  << ", taskid = " << task->GetTaskId();
+                        (*completeChunkNum)++;
+                        continue;
+                    }
+                    item.offset = partIndex * context->partSize;
+                } else {
+                    retCode = item.retCode;
+                    retried = true;
+                }
+                context->items[remain] = item;
+                context->partIndexes[remain] = partIndex;
+                context->chunkIndexes[remain] = chunkIndex;
+                context->retried[remain] = retried;
+                remain++;
+            }
+            context->items.resize(remain);
+            context->partIndexes.resize(remain);
+            context->chunkIndexes.resize(remain);
+            context->retried.resize(remain);
+            if (0 == remain) {
+                (*completeBatchNum)++;
+                continue;
+            }
+            if (progress) {
+                // 有chunk完成了分片，立即发送下一轮请求，并重置开始时间
+                context->startTime = TimeUtility::GetTimeofDaySec();
+                int ret = StartAsyncRecoverChunkBatch(task, tracker, context);
+                if (ret < 0) {
+                    return ret;
+                }
+                continue;
+            }
+        }
+        uint64_t nowTime = TimeUtility::GetTimeofDaySec();
+        if (nowTime - context->startTime <
+            context->clientAsyncMethodRetryTimeSec) {
+            // retry
+            context->retried.assign(context->items.size(), true);
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(
+                    clientAsyncMethodRetryIntervalMs_));
+            int ret = StartAsyncRecoverChunkBatch(task, tracker, context);
+            if (ret < 0) {
+                return ret;
+            }
+        } else {
+            LOG(ERROR) << "RecoverChunks tracker GetResult fail"
+                       << ", ret = " << retCode
+                       << ", taskid = " << task->GetTaskId();
+            return retCode;
+        }
+    }
+    return kErrCodeSuccess;
+}
+
 int CloneCoreImpl::ChangeOwner(
     std::shared_ptr<CloneTaskInfo> task,
     const FInfo &fInfo) {
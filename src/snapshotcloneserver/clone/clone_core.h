@@ -28,6 +28,8 @@
 #include <vector>
 #include <map>
 #include <list>
+#include <set>
+#include <utility>
 
 #include "src/snapshotcloneserver/common/curvefs_client.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
@@ -200,7 +202,7 @@ class CloneCore {
 struct CloneChunkInfo {
     // 该chunk的id信息
     ChunkIDInfo chunkIdInfo;
-    // 位置信息，如果在s3上，是objectName，否则在curvefs上，则是offset
+    // 位置信息，如果在s3上，是完整的s3 location，否则在curvefs上，则是offset
     std::string location;
     // 该chunk的版本号
     uint64_t seqNum;
@@ -212,6 +214,9 @@ struct CloneChunkInfo {
 using CloneSegmentInfo = std::map<uint64_t, CloneChunkInfo>;
 // 克隆/恢复所需segment信息表，key是segmentIndex
 using CloneSegmentMap = std::map<uint64_t, CloneSegmentInfo>;
+// 待恢复的chunk列表，first是chunk在文件中的index，按恢复顺序排列
+using RecoverChunkList =
+    std::vector<std::pair<uint64_t, const CloneChunkInfo *>>;
 
 class CloneCoreImpl : public CloneCore {
  public:
@@ -237,7 +242,9 @@ class CloneCoreImpl : public CloneCore {
         recoverChunkConcurrency_(option.recoverChunkConcurrency),
         clientAsyncMethodRetryTimeSec_(option.clientAsyncMethodRetryTimeSec),
         clientAsyncMethodRetryIntervalMs_(
-            option.clientAsyncMethodRetryIntervalMs) {}
+            option.clientAsyncMethodRetryIntervalMs),
+        cloneChunkBatchSize_(option.cloneChunkBatchSize),
+        hotChunkListMaxSize_(option.hotChunkListMaxSize) {}
 
     ~CloneCoreImpl() {
     }
@@ -393,6 +400,63 @@ class CloneCoreImpl : public CloneCore {
         const FInfo &fInfo,
         CloneSegmentMap *segInfos);
 
+    /**
+     * @brief 获取chunk的数据源location
+     *
+     * @param task 任务信息
+     * @param cloneChunkInfo chunk信息
+     *
+     * @return 数据源location
+     */
+    std::string GetCloneChunkLocation(
+        std::shared_ptr<CloneTaskInfo> task,
+        const CloneChunkInfo &cloneChunkInfo);
+
+    /**
+     * @brief 将chunk按copyset分批
+     * @detail
+     *  同一个copyset上的chunk按顺序每cloneChunkBatchSize_个组成一批，
+     *  批次按其第一个chunk的顺序排列，以保持chunk原有的先后顺序
+     *
+     * @param chunkIds 所有chunk的id信息
+     * @param[out] batches 每批chunk在chunkIds中的下标
+     */
+    void SplitChunksIntoBatches(
+        const std::vector<ChunkIDInfo> &chunkIds,
+        std::vector<std::vector<size_t>> *batches);
+
+    /**
+     * @brief 逐个chunk创建新clone文件的chunk
+     *
+     * @param task 任务信息
+     * @param csn correctSn
+     * @param chunkSize chunk大小
+     * @param segInfos 新文件所需的segment信息
+     *
+     * @return 错误码
+     */
+    int CreateCloneChunkOneByOne(
+        std::shared_ptr<CloneTaskInfo> task,
+        uint64_t csn,
+        uint64_t chunkSize,
+        CloneSegmentMap *segInfos);
+
+    /**
+     * @brief 按copyset分批创建新clone文件的chunk
+     *
+     * @param task 任务信息
+     * @param csn correctSn
+     * @param chunkSize chunk大小
+     * @param segInfos 新文件所需的segment信息
+     *
+     * @return 错误码
+     */
+    int CreateCloneChunkInBatch(
+        std::shared_ptr<CloneTaskInfo> task,
+        uint64_t csn,
+        uint64_t chunkSize,
+        CloneSegmentMap *segInfos);
+
     /**
      * @brief 开始CreateCloneChunk的异步请求
      *
@@ -421,6 +485,34 @@ class CloneCoreImpl : public CloneCore {
         std::shared_ptr<CreateCloneChunkTaskTracker> tracker,
         const std::list<CreateCloneChunkContextPtr> &results);
 
+    /**
+     * @brief 开始一批CreateCloneChunk的异步请求
+     *
+     * @param task 任务信息
+     * @param tracker CreateCloneChunk批量任务追踪器
+     * @param context CreateCloneChunk批量上下文
+     *
+     * @return 错误码
+     */
+    int StartAsyncCreateCloneChunkBatch(
+        std::shared_ptr<CloneTaskInfo> task,
+        std::shared_ptr<CreateCloneChunkBatchTaskTracker> tracker,
+        std::shared_ptr<CreateCloneChunkBatchContext> context);
+
+    /**
+     * @brief 处理批量CreateCloneChunk的结果并重试失败的chunk
+     *
+     * @param task 任务信息
+     * @param tracker CreateCloneChunk批量任务追踪器
+     * @param results CreateCloneChunk批量结果列表
+     *
+     * @return 错误码
+     */
+    int HandleCreateCloneChunkBatchResultsAndRetry(
+        std::shared_ptr<CloneTaskInfo> task,
+        std::shared_ptr<CreateCloneChunkBatchTaskTracker> tracker,
+        const std::list<CreateCloneChunkBatchContextPtr> &results);
+
     /**
      * @brief 通知mds完成源数据创建步骤
      *
@@ -449,6 +541,68 @@ class CloneCoreImpl : public CloneCore {
         const FInfo &fInfo,
         const CloneSegmentMap &segInfos);
 
+    /**
+     * @brief 逐个chunk恢复数据
+     *
+     * @param task 任务信息
+     * @param chunkSize chunk大小
+     * @param chunks 待恢复的chunk列表
+     *
+     * @return 错误码
+     */
+    int RecoverChunkOneByOne(
+        std::shared_ptr<CloneTaskInfo> task,
+        uint64_t chunkSize,
+        const RecoverChunkList &chunks);
+
+    /**
+     * @brief 按copyset分批恢复chunk数据
+     *
+     * @param task 任务信息
+     * @param chunkSize chunk大小
+     * @param chunks 待恢复的chunk列表
+     * @param[out] accessedChunkIndexes 恢复前已被用户读写过的chunk的index
+     *
+     * @return 错误码
+     */
+    int RecoverChunkInBatch(
+        std::shared_ptr<CloneTaskInfo> task,
+        uint64_t chunkSize,
+        const RecoverChunkList &chunks,
+        std::set<uint64_t> *accessedChunkIndexes);
+
+    /**
+     * @brief 生成待恢复的chunk列表
+     * @detail
+     *  hotChunkIndexes中的chunk按其顺序排在最前面，其余chunk按index顺序
+     *
+     * @param fInfo 新文件的文件信息
+     * @param segInfos 新文件所需的segment信息
+     * @param hotChunkIndexes 热点chunk的index
+     * @param[out] chunks 待恢复的chunk列表
+     */
+    void BuildRecoverChunkList(
+        const FInfo &fInfo,
+        const CloneSegmentMap &segInfos,
+        const std::vector<ChunkIndexType> &hotChunkIndexes,
+        RecoverChunkList *chunks);
+
+    /**
+     * @brief 记录懒克隆恢复前已被用户读写过的chunk，作为后续克隆的热点chunk
+     * @detail
+     *  加锁后重新读取当前记录再合并，本次被访问的chunk排在最前面，
+     *  其余记录按原顺序排在后面，超过hotChunkListMaxSize_的部分丢弃，
+     *  有变化时才写入，写入失败不影响任务结果
+     *
+     * @param task 任务信息
+     * @param name 源快照的索引名
+     * @param accessedChunkIndexes 本次恢复前已被用户读写过的chunk的index
+     */
+    void SaveHotChunkIndex(
+        std::shared_ptr<CloneTaskInfo> task,
+        const ChunkIndexDataName &name,
+        const std::set<uint64_t> &accessedChunkIndexes);
+
     /**
      * @brief 开始RecoverChunk的异步请求
      *
@@ -477,6 +631,38 @@ class CloneCoreImpl : public CloneCore {
         std::shared_ptr<RecoverChunkTaskTracker> tracker,
         uint64_t *completeChunkNum);
 
+    /**
+     * @brief 开始一批RecoverChunk的异步请求
+     *
+     * @param task 任务信息
+     * @param tracker RecoverChunk批量任务跟踪器
+     * @param context RecoverChunk批量上下文
+     *
+     * @return 错误码
+     */
+    int StartAsyncRecoverChunkBatch(
+        std::shared_ptr<CloneTaskInfo> task,
+        std::shared_ptr<RecoverChunkBatchTaskTracker> tracker,
+        std::shared_ptr<RecoverChunkBatchContext> context);
+
+    /**
+     * @brief 继续各批chunk的下一个分片的请求以及等待完成某些批次
+     *
+     * @param task 任务信息
+     * @param tracker RecoverChunk批量任务跟踪器
+     * @param[out] completeBatchNum 完成的批次数
+     * @param[out] completeChunkNum 累加完成的chunk数
+     * @param[out] accessedChunkIndexes 加入恢复前已被用户读写过的chunk的index
+     *
+     * @return 错误码
+     */
+    int ContinueAsyncRecoverChunkBatchAndWaitSomeBatchEnd(
+        std::shared_ptr<CloneTaskInfo> task,
+        std::shared_ptr<RecoverChunkBatchTaskTracker> tracker,
+        uint64_t *completeBatchNum,
+        uint64_t *completeChunkNum,
+        std::set<uint64_t> *accessedChunkIndexes);
+
     /**
      * @brief 修改克隆文件的owner
      *
@@ -598,6 +784,12 @@ class CloneCoreImpl : public CloneCore {
     uint64_t clientAsyncMethodRetryTimeSec_;
     // 调用client异步方法重试时间间隔
     uint64_t clientAsyncMethodRetryIntervalMs_;
+    // 同一个copyset上的chunk合并为一个请求的最大数量
+    uint32_t cloneChunkBatchSize_;
+    // 每个快照记录的热点chunk的最大数量
+    uint32_t hotChunkListMaxSize_;
+    // 热点chunk记录的读改写锁，避免同一快照的克隆并发更新时互相覆盖
+    NameLock hotChunkLock_;
 };
 
 }  // namespace snapshotcloneserver
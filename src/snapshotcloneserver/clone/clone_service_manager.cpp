@@ -583,6 +583,7 @@ int CloneServiceManager::RecoverCloneTaskInternal(const CloneInfo &cloneInfo) {
     std::shared_ptr<CloneTaskInfo> taskInfo =
         std::make_shared<CloneTaskInfo>(
             cloneInfo, cloneInfoMetric, closure);
+    taskInfo->SetResumed();
     taskInfo->UpdateMetric();
     std::shared_ptr<CloneTask> task =
         std::make_shared<CloneTask>(
@@ -25,6 +25,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "src/snapshotcloneserver/clone/clone_core.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
@@ -48,7 +49,8 @@ class CloneTaskInfo : public TaskInfo {
         : TaskInfo(),
           cloneInfo_(cloneInfo),
           metric_(metric),
-          closure_(closure) {}
+          closure_(closure),
+          resumed_(false) {}
 
     CloneInfo& GetCloneInfo() {
         return cloneInfo_;
@@ -70,10 +72,24 @@ class CloneTaskInfo : public TaskInfo {
         return closure_;
     }
 
+    /**
+     * @brief 标记任务是重启后恢复或失败后重试的任务，
+     *  之前的执行可能已经恢复过部分chunk
+     */
+    void SetResumed() {
+        resumed_ = true;
+    }
+
+    bool IsResumed() const {
+        return resumed_;
+    }
+
  private:
     CloneInfo cloneInfo_;
     std::shared_ptr<CloneInfoMetric> metric_;
     std::shared_ptr<CloneClosure> closure_;
+    // 是否是重启后恢复或失败后重试的任务
+    bool resumed_;
 };
 
 std::ostream& operator<<(std::ostream& os, const CloneTaskInfo &taskInfo);
@@ -243,6 +259,103 @@ struct RecoverChunkClosure : public SnapCloneClosure {
     RecoverChunkContextPtr context_;
 };
 
+struct CreateCloneChunkBatchContext {
+    // 同一个copyset上的一批chunk
+    std::vector<ChunkBatchItem> items;
+    // 与items一一对应的chunk信息
+    std::vector<struct CloneChunkInfo *> cloneChunkInfos;
+    // correctSn
+    uint64_t csn;
+    // chunk size
+    uint64_t chunkSize;
+    // 整个请求的返回值
+    int retCode;
+    // taskid
+    TaskIdType taskid;
+    // 异步请求开始时间
+    uint64_t startTime;
+    // 异步请求重试总时间
+    uint64_t clientAsyncMethodRetryTimeSec;
+};
+
+struct CreateCloneChunkBatchClosure : public SnapCloneClosure {
+    CreateCloneChunkBatchClosure(
+        std::shared_ptr<CreateCloneChunkBatchTaskTracker> tracker,
+        CreateCloneChunkBatchContextPtr context)
+        : tracker_(tracker),
+          context_(context) {}
+    void Run() {
+        std::unique_ptr<CreateCloneChunkBatchClosure> self_guard(this);
+        context_->retCode = GetRetCode();
+        if (context_->retCode < 0) {
+            LOG(WARNING) << "CreateCloneChunkBatchClosure return fail"
+                         << ", ret = " << context_->retCode
+                         << ", logicalPoolId = "
+                         << context_->items.front().idinfo.lpid_
+                         << ", copysetId = "
+                         << context_->items.front().idinfo.cpid_
+                         << ", chunkNum = " << context_->items.size()
+                         << ", csn = " << context_->csn
+                         << ", taskid = " << context_->taskid;
+        }
+        tracker_->PushResultContext(context_);
+        tracker_->HandleResponse(context_->retCode);
+    }
+    std::shared_ptr<CreateCloneChunkBatchTaskTracker> tracker_;
+    CreateCloneChunkBatchContextPtr context_;
+};
+
+struct RecoverChunkBatchContext {
+    // 同一个copyset上正在恢复的一批chunk，每个chunk一次恢复一个分片
+    std::vector<ChunkBatchItem> items;
+    // 与items一一对应的chunk当前分片index
+    std::vector<uint64_t> partIndexes;
+    // 与items一一对应的chunk在文件中的index
+    std::vector<uint64_t> chunkIndexes;
+    // 与items一一对应的chunk当前分片是否重试过，
+    // 重试时数据可能已由之前的请求拷贝，不能据此判断为热点
+    std::vector<bool> retried;
+    // 总的chunk分片数
+    uint64_t totalPartNum;
+    // 分片大小
+    uint64_t partSize;
+    // 整个请求的返回值
+    int retCode;
+    // taskid
+    TaskIdType taskid;
+    // 异步请求开始时间，有chunk分片完成时重置
+    uint64_t startTime;
+    // 异步请求重试总时间
+    uint64_t clientAsyncMethodRetryTimeSec;
+};
+
+struct RecoverChunkBatchClosure : public SnapCloneClosure {
+    RecoverChunkBatchClosure(
+        std::shared_ptr<RecoverChunkBatchTaskTracker> tracker,
+        RecoverChunkBatchContextPtr context)
+        : tracker_(tracker),
+          context_(context) {}
+    void Run() {
+        std::unique_ptr<RecoverChunkBatchClosure> self_guard(this);
+        context_->retCode = GetRetCode();
+        if (context_->retCode < 0) {
+            LOG(WARNING) << "RecoverChunkBatchClosure return fail"
+                         << ", ret = " << context_->retCode
+                         << ", logicalPoolId = "
+                         << context_->items.front().idinfo.lpid_
+                         << ", copysetId = "
+                         << context_->items.front().idinfo.cpid_
+                         << ", chunkNum = " << context_->items.size()
+                         << ", partSize = " << context_->partSize
+                         << ", taskid = " << context_->taskid;
+        }
+        tracker_->PushResultContext(context_);
+        tracker_->HandleResponse(context_->retCode);
+    }
+    std::shared_ptr<RecoverChunkBatchTaskTracker> tracker_;
+    RecoverChunkBatchContextPtr context_;
+};
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
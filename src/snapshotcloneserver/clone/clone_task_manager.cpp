@@ -242,6 +242,7 @@ void CloneTaskManager::ScanStage2Tasks() {
                     taskInfo->GetCloneInfo().
                         SetStatus(CloneStatus::recovering);
                 }
+                taskInfo->SetResumed();
                 taskInfo->Reset();
                 stage2Pool_->PushTask(it->second);
             // 其他任务结束更新metric
@@ -61,12 +61,30 @@ struct SnapshotCloneServerOptions {
     uint32_t snapshotTaskManagerScanIntervalMs;
     // 转储chunk分片大小
     uint64_t chunkSplitSize;
+    // 是否以稀疏格式存储chunk对象
+    bool sparseChunkObject;
+    // chunk对象分片的压缩算法，none/snappy/zlib
+    std::string chunkObjectCompressType;
+    // chunk对象分片的压缩级别，只对zlib有效
+    int chunkObjectCompressLevel;
+    // 是否按内容对chunk分片去重存储
+    bool chunkDedup;
+    // 打包存储时pack对象的大小，0表示每个chunk单独存储为一个对象
+    uint64_t chunkPackSize;
+    // 写入pack对象的分片大小
+    uint64_t chunkPackPartSize;
+    // 删除快照后pack中有效数据的比例低于该值时重写pack
+    double chunkPackGcRatio;
     // CheckSnapShotStatus调用间隔
     uint32_t checkSnapshotStatusIntervalMs;
     // 最大快照数
     uint32_t maxSnapshotLimit;
     // snapshotcore threadpool threadNum
     uint32_t snapshotCoreThreadNum;
+    // 转储快照时上传chunk分片的线程数，0表示与snapshotCoreThreadNum相同
+    uint32_t snapshotUploadThreadNum;
+    // 转储快照时已读取尚未上传完成的分片总大小上限，0表示使用默认值
+    uint64_t snapshotTransferMemoryLimit;
     // mdsSessionTimeUs
     uint32_t mdsSessionTimeUs;
     // ReadChunkSnapshot同时进行的异步请求数量
@@ -90,6 +108,11 @@ struct SnapshotCloneServerOptions {
     uint32_t createCloneChunkConcurrency;
     // RecoverChunk同时进行的异步请求数量
     uint32_t recoverChunkConcurrency;
+    // 同一个copyset上的chunk合并为一个请求的最大数量，
+    // 小于等于1时每个chunk单独发送请求
+    uint32_t cloneChunkBatchSize = 1;
+    // 每个快照记录的懒克隆热点chunk的最大数量
+    uint32_t hotChunkListMaxSize = 1024;
     // 引用计数后台扫描每条记录间隔
     uint32_t backEndReferenceRecordScanIntervalMs;
     // 引用计数后台扫描每轮间隔
@@ -235,6 +235,36 @@ int CurveFsClientImpl::RecoverChunk(
         clientMethodRetryIntervalMs_);
 }
 
+int CurveFsClientImpl::CreateCloneChunks(
+    std::vector<ChunkBatchItem> *items,
+    uint64_t csn,
+    uint64_t chunkSize,
+    SnapCloneClosure* scc) {
+    RetryMethod method = [this, items, csn, chunkSize, scc] () {
+        return snapClient_->CreateCloneChunks(items, csn, chunkSize, scc);
+    };
+    RetryCondition condition = [] (int ret) {
+        return ret < 0;
+    };
+    RetryHelper retryHelper(method, condition);
+    return retryHelper.RetryTimeSecAndReturn(clientMethodRetryTimeSec_,
+        clientMethodRetryIntervalMs_);
+}
+
+int CurveFsClientImpl::RecoverChunks(
+    std::vector<ChunkBatchItem> *items,
+    SnapCloneClosure* scc) {
+    RetryMethod method = [this, items, scc] () {
+        return snapClient_->RecoverChunks(items, scc);
+    };
+    RetryCondition condition = [] (int ret) {
+        return ret < 0;
+    };
+    RetryHelper retryHelper(method, condition);
+    return retryHelper.RetryTimeSecAndReturn(clientMethodRetryTimeSec_,
+        clientMethodRetryIntervalMs_);
+}
+
 int CurveFsClientImpl::CompleteCloneMeta(
     const std::string &filename,
     const std::string &user) {
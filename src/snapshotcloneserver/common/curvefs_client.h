@@ -45,6 +45,7 @@ using ::curve::client::CopysetID;
 using ::curve::client::ChunkID;
 using ::curve::client::ChunkInfoDetail;
 using ::curve::client::ChunkIDInfo;
+using ::curve::client::ChunkBatchItem;
 using ::curve::client::FInfo;
 using ::curve::client::FileStatus;
 using ::curve::client::SnapCloneClosure;
@@ -277,6 +278,36 @@ class CurveFsClient {
         uint64_t len,
         SnapCloneClosure* scc) = 0;
 
+    /**
+     * @brief 批量lazy创建同一个copyset上的clone chunk
+     *
+     * @param items 目标chunk，填写idinfo/location/sn，
+     *        由调用方持有直到scc被调用
+     * @param csn correct sn
+     * @param chunkSize chunk的大小
+     * @param: scc是异步回调，成功时每个chunk的结果在其retCode中
+     *
+     * @return 错误码
+     */
+    virtual int CreateCloneChunks(
+        std::vector<ChunkBatchItem> *items,
+        uint64_t csn,
+        uint64_t chunkSize,
+        SnapCloneClosure* scc) = 0;
+
+    /**
+     * @brief 批量恢复同一个copyset上的chunk数据
+     *
+     * @param items 目标chunk，填写idinfo/offset/len，
+     *        由调用方持有直到scc被调用
+     * @param: scc是异步回调，成功时每个chunk的结果在其retCode中
+     *
+     * @return 错误码
+     */
+    virtual int RecoverChunks(
+        std::vector<ChunkBatchItem> *items,
+        SnapCloneClosure* scc) = 0;
+
     /**
      * @brief 通知mds完成Clone Meta
      *
@@ -474,6 +505,16 @@ class CurveFsClientImpl : public CurveFsClient {
         uint64_t len,
         SnapCloneClosure* scc) override;
 
+    int CreateCloneChunks(
+        std::vector<ChunkBatchItem> *items,
+        uint64_t csn,
+        uint64_t chunkSize,
+        SnapCloneClosure* scc) override;
+
+    int RecoverChunks(
+        std::vector<ChunkBatchItem> *items,
+        SnapCloneClosure* scc) override;
+
     int CompleteCloneMeta(
         const std::string &filename,
         const std::string &user) override;
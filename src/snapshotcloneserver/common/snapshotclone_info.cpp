@@ -142,5 +142,23 @@ std::ostream& operator<<(std::ostream& os, const SnapshotInfo &snapshotInfo) {
     return os;
 }
 
+bool ChunkPartRefInfo::SerializeToString(std::string *value) const {
+    ChunkPartRefData data;
+    data.set_hash(hash);
+    data.set_storedlength(storedLength);
+    data.set_compresstype(static_cast<int>(compressType));
+    return data.SerializeToString(value);
+}
+
+bool ChunkPartRefInfo::ParseFromString(const std::string &value) {
+    ChunkPartRefData data;
+    bool ret = data.ParseFromString(value);
+    hash = data.hash();
+    storedLength = data.storedlength();
+    compressType =
+        static_cast<::curve::common::CompressType>(data.compresstype());
+    return ret;
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
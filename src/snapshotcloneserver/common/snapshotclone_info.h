@@ -29,6 +29,7 @@
 #include <memory>
 
 #include "src/common/snapshotclone/snapshotclone_define.h"
+#include "src/common/compression.h"
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -441,6 +442,22 @@ class SnapshotInfo {
 
 std::ostream& operator<<(std::ostream& os, const SnapshotInfo &snapshotInfo);
 
+// 按内容去重存储的chunk分片，分片数据以内容hash命名存储在s3上，
+// 被多个chunk对象引用时只存储一份
+struct ChunkPartRefInfo {
+    // 分片原始数据的sha256
+    std::string hash;
+    // 分片数据在对象中的长度，为0表示分片数据不存在
+    uint32_t storedLength = 0;
+    // 分片数据的压缩算法
+    ::curve::common::CompressType compressType =
+        ::curve::common::CompressType::None;
+
+    bool SerializeToString(std::string *value) const;
+
+    bool ParseFromString(const std::string &value);
+};
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
@@ -145,6 +145,64 @@ class SnapshotCloneMetaStore {
      * @return: 0 获取成功/ -1 获取失败
      */
     virtual int GetCloneInfoList(std::vector<CloneInfo> *list) = 0;
+
+    /**
+     * @brief 获取去重存储的chunk分片数据的记录
+     * @param hash 分片原始数据的sha256
+     * @param[out] info 分片数据的记录，记录不存在时storedLength为0
+     * @return: 0 获取成功/ -1 获取失败
+     */
+    virtual int GetChunkPartRef(const std::string &hash,
+                                ChunkPartRefInfo *info) = 0;
+
+    /**
+     * @brief 批量记录一个chunk对象的分片对分片数据的引用，同时写入分片数据
+     *        的记录；引用按chunk对象名和分片序号记录，重复记录不会重复引用
+     * @param chunkName chunk对象名
+     * @param parts 分片序号 <=> 引用的分片数据的记录
+     * @return: 0 记录成功/ -1 记录失败，可能已记录了部分引用
+     */
+    virtual int AddChunkPartRefs(const std::string &chunkName,
+        const std::map<int, ChunkPartRefInfo> &parts) = 0;
+
+    /**
+     * @brief 批量删除一个chunk对象的分片对分片数据的引用，引用不存在时
+     *        也返回成功
+     * @param chunkName chunk对象名
+     * @param parts 分片序号 <=> 引用的分片数据的sha256
+     * @return: 0 删除成功/ -1 删除失败，可能已删除了部分引用
+     */
+    virtual int RemoveChunkPartRefs(const std::string &chunkName,
+        const std::map<int, std::string> &parts) = 0;
+
+    /**
+     * @brief 查询分片数据是否仍被chunk对象引用
+     * @param hash 分片原始数据的sha256
+     * @param[out] referenced 是否仍有引用
+     * @return: 0 查询成功/ -1 查询失败
+     */
+    virtual int HasChunkPartRef(const std::string &hash,
+                                bool *referenced) = 0;
+
+    /**
+     * @brief 删除一条chunk分片数据的记录
+     * @param hash 分片原始数据的sha256
+     * @return: 0 删除成功/ -1 删除失败
+     */
+    virtual int DeleteChunkPartRef(const std::string &hash) = 0;
+
+    /**
+     * @brief 记录曾经开启过chunk分片去重，记录后不会被删除
+     * @return: 0 记录成功/ -1 记录失败
+     */
+    virtual int SetChunkDedupFlag() = 0;
+
+    /**
+     * @brief 查询是否曾经开启过chunk分片去重
+     * @param[out] everEnabled 是否曾经开启过
+     * @return: 0 查询成功/ -1 查询失败
+     */
+    virtual int GetChunkDedupFlag(bool *everEnabled) = 0;
 };
 
 }  // namespace snapshotcloneserver
@@ -22,12 +22,18 @@
 
 #include "src/snapshotcloneserver/common/snapshotclone_meta_store_etcd.h"
 
+#include <algorithm>
 #include <vector>
 #include <string>
+#include <set>
+#include <utility>
 
 namespace curve {
 namespace snapshotcloneserver {
 
+// etcd单个事务的操作个数上限
+const size_t kMaxChunkPartRefOpsPerTxn = 128;
+
 int SnapshotCloneMetaStoreEtcd::Init() {
     int ret = LoadSnapshotInfos();
     if (ret < 0) {
@@ -294,6 +300,143 @@ int SnapshotCloneMetaStoreEtcd::GetCloneInfoList(std::vector<CloneInfo> *list) {
     return -1;
 }
 
+// chunk分片的引用记录数量与快照数据量成正比，不在内存中缓存，直接读写etcd
+int SnapshotCloneMetaStoreEtcd::GetChunkPartRef(const std::string &hash,
+    ChunkPartRefInfo *info) {
+    std::string key = codec_->EncodeChunkPartRefKey(hash);
+    std::string value;
+    int errCode = client_->Get(key, &value);
+    if (errCode == EtcdErrCode::EtcdKeyNotExist) {
+        info->hash = hash;
+        info->storedLength = 0;
+        info->compressType = ::curve::common::CompressType::None;
+        return 0;
+    }
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "Get chunk part ref from etcd err"
+                   << ", errcode = " << errCode;
+        return -1;
+    }
+    if (!codec_->DecodeChunkPartRefData(value, info)) {
+        LOG(ERROR) << "DecodeChunkPartRefData err";
+        return -1;
+    }
+    return 0;
+}
+
+int SnapshotCloneMetaStoreEtcd::AddChunkPartRefs(
+    const std::string &chunkName,
+    const std::map<int, ChunkPartRefInfo> &parts) {
+    std::vector<std::pair<std::string, std::string>> kvs;
+    std::set<std::string> hashes;
+    for (const auto &part : parts) {
+        const ChunkPartRefInfo &info = part.second;
+        // 同一事务中的key不能重复，多个分片引用同一分片数据时只写一次记录
+        if (hashes.insert(info.hash).second) {
+            std::string value;
+            if (!codec_->EncodeChunkPartRefData(info, &value)) {
+                LOG(ERROR) << "EncodeChunkPartRefData err";
+                return -1;
+            }
+            kvs.emplace_back(codec_->EncodeChunkPartRefKey(info.hash),
+                             value);
+        }
+        kvs.emplace_back(
+            codec_->EncodeChunkRefKey(info.hash, chunkName, part.first), "");
+    }
+    return TxnChunkPartRefs(OpType::OpPut, kvs);
+}
+
+int SnapshotCloneMetaStoreEtcd::RemoveChunkPartRefs(
+    const std::string &chunkName,
+    const std::map<int, std::string> &parts) {
+    std::vector<std::pair<std::string, std::string>> kvs;
+    for (const auto &part : parts) {
+        kvs.emplace_back(
+            codec_->EncodeChunkRefKey(part.second, chunkName, part.first), "");
+    }
+    return TxnChunkPartRefs(OpType::OpDelete, kvs);
+}
+
+int SnapshotCloneMetaStoreEtcd::HasChunkPartRef(const std::string &hash,
+    bool *referenced) {
+    std::vector<std::string> out;
+    int errCode = client_->List(SnapshotCloneCodec::GetChunkRefKeyPrefix(hash),
+        SnapshotCloneCodec::GetChunkRefKeyEnd(hash), &out);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "List chunk part ref from etcd err"
+                   << ", errcode = " << errCode;
+        return -1;
+    }
+    *referenced = !out.empty();
+    return 0;
+}
+
+int SnapshotCloneMetaStoreEtcd::TxnChunkPartRefs(OpType type,
+    const std::vector<std::pair<std::string, std::string>> &kvs) {
+    for (size_t start = 0; start < kvs.size();
+         start += kMaxChunkPartRefOpsPerTxn) {
+        size_t end = std::min(kvs.size(), start + kMaxChunkPartRefOpsPerTxn);
+        std::vector<Operation> ops;
+        for (size_t i = start; i < end; ++i) {
+            ops.emplace_back(Operation{type,
+                const_cast<char*>(kvs[i].first.c_str()),
+                const_cast<char*>(kvs[i].second.c_str()),
+                static_cast<int>(kvs[i].first.size()),
+                static_cast<int>(kvs[i].second.size())});
+        }
+        int64_t revision = 0;
+        int errCode = client_->TxnNWithRevision(ops, &revision);
+        if (errCode != EtcdErrCode::EtcdOK) {
+            LOG(ERROR) << "Txn chunk part refs into etcd err"
+                       << ", errcode = " << errCode
+                       << ", opType = " << static_cast<int>(type)
+                       << ", ops = " << ops.size();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int SnapshotCloneMetaStoreEtcd::DeleteChunkPartRef(const std::string &hash) {
+    std::string key = codec_->EncodeChunkPartRefKey(hash);
+    int errCode = client_->Delete(key);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "delete chunk part ref from etcd err"
+                   << ", errcode = " << errCode;
+        return -1;
+    }
+    return 0;
+}
+
+int SnapshotCloneMetaStoreEtcd::SetChunkDedupFlag() {
+    std::string key = SnapshotCloneCodec::GetChunkDedupFlagKey();
+    int errCode = client_->Put(key, "1");
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "put chunk dedup flag into etcd err"
+                   << ", errcode = " << errCode;
+        return -1;
+    }
+    return 0;
+}
+
+int SnapshotCloneMetaStoreEtcd::GetChunkDedupFlag(bool *everEnabled) {
+    std::string key = SnapshotCloneCodec::GetChunkDedupFlagKey();
+    std::string value;
+    int errCode = client_->Get(key, &value);
+    if (errCode == EtcdErrCode::EtcdKeyNotExist) {
+        *everEnabled = false;
+        return 0;
+    }
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "get chunk dedup flag from etcd err"
+                   << ", errcode = " << errCode;
+        return -1;
+    }
+    *everEnabled = true;
+    return 0;
+}
+
 int SnapshotCloneMetaStoreEtcd::LoadSnapshotInfos() {
     std::string startKey = SnapshotCloneCodec::GetSnapshotInfoKeyPrefix();
     std::string endKey = SnapshotCloneCodec::GetSnapshotInfoKeyEnd();
@@ -27,6 +27,7 @@
 #include <memory>
 #include <map>
 #include <string>
+#include <utility>
 
 #include "src/snapshotcloneserver/common/snapshotclone_meta_store.h"
 #include "src/kvstorageclient/etcd_client.h"
@@ -81,7 +82,33 @@ class SnapshotCloneMetaStoreEtcd : public SnapshotCloneMetaStore {
 
     int GetCloneInfoList(std::vector<CloneInfo> *list) override;
 
+    int GetChunkPartRef(const std::string &hash,
+                        ChunkPartRefInfo *info) override;
+
+    int AddChunkPartRefs(const std::string &chunkName,
+        const std::map<int, ChunkPartRefInfo> &parts) override;
+
+    int RemoveChunkPartRefs(const std::string &chunkName,
+        const std::map<int, std::string> &parts) override;
+
+    int HasChunkPartRef(const std::string &hash, bool *referenced) override;
+
+    int DeleteChunkPartRef(const std::string &hash) override;
+
+    int SetChunkDedupFlag() override;
+
+    int GetChunkDedupFlag(bool *everEnabled) override;
+
  private:
+    /**
+     * @brief 分批提交对chunk分片引用记录的修改，每批不超过etcd事务的操作数上限
+     * @param type 操作类型
+     * @param kvs 需要修改的key和value，删除时value为空
+     * @return 0 提交成功/ -1 提交失败，之前的批次已经生效
+     */
+    int TxnChunkPartRefs(OpType type,
+        const std::vector<std::pair<std::string, std::string>> &kvs);
+
     /**
      * @brief 加载快照信息
      *
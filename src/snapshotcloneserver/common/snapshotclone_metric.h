@@ -76,6 +76,42 @@ struct SnapshotMetric {
             GetSnapshotTotalNum, metaStore_.get()) {}
 };
 
+struct ChunkDedupMetric {
+    const std::string ChunkDedupMetricPrefix =
+        "snapshotcloneserver_chunk_dedup_metric_";
+
+    // 累计转储的非0分片数量
+    bvar::Adder<uint64_t> partTotal;
+    // 累计命中已有分片数据而跳过上传的分片数量
+    bvar::Adder<uint64_t> partDeduped;
+    // 累计转储的非0分片数据量
+    bvar::Adder<uint64_t> bytesTotal;
+    // 累计跳过上传的分片数据量
+    bvar::Adder<uint64_t> bytesDeduped;
+    // 累计因引用计数减为0而删除的分片数据数量
+    bvar::Adder<uint64_t> partReleased;
+    // 去重率，即跳过上传的数据量占转储数据量的比例
+    bvar::PassiveStatus<double> dedupRatio;
+
+    static double GetDedupRatio(void *arg) {
+        ChunkDedupMetric *metric = reinterpret_cast<ChunkDedupMetric*>(arg);
+        uint64_t total = metric->bytesTotal.get_value();
+        if (total == 0) {
+            return 0;
+        }
+        return static_cast<double>(metric->bytesDeduped.get_value()) / total;
+    }
+
+    ChunkDedupMetric() :
+        partTotal(ChunkDedupMetricPrefix, "part_total"),
+        partDeduped(ChunkDedupMetricPrefix, "part_deduped"),
+        bytesTotal(ChunkDedupMetricPrefix, "bytes_total"),
+        bytesDeduped(ChunkDedupMetricPrefix, "bytes_deduped"),
+        partReleased(ChunkDedupMetricPrefix, "part_released"),
+        dedupRatio(ChunkDedupMetricPrefix + "dedup_ratio",
+            GetDedupRatio, this) {}
+};
+
 struct SnapshotInfoMetric {
     const std::string SnapshotInfoMetricPrefix =
         "snapshotcloneserver_snapshotInfo_metric_";
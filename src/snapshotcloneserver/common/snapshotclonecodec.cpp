@@ -59,6 +59,32 @@ bool SnapshotCloneCodec::DecodeCloneInfoData(
     return data->ParseFromString(value);
 }
 
+std::string SnapshotCloneCodec::EncodeChunkPartRefKey(
+    const std::string &hash) {
+    std::string key = SnapshotCloneCodec::GetChunkPartRefKeyPrefix();
+    key += hash;
+    return key;
+}
+
+std::string SnapshotCloneCodec::EncodeChunkRefKey(
+    const std::string &hash, const std::string &chunkName, int partIndex) {
+    std::string key = SnapshotCloneCodec::GetChunkRefKeyPrefix(hash);
+    key += chunkName;
+    key += "/";
+    key += std::to_string(partIndex);
+    return key;
+}
+
+bool SnapshotCloneCodec::EncodeChunkPartRefData(
+    const ChunkPartRefInfo &data, std::string *value) {
+    return data.SerializeToString(value);
+}
+
+bool SnapshotCloneCodec::DecodeChunkPartRefData(
+    const std::string &value, ChunkPartRefInfo *data) {
+    return data->ParseFromString(value);
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
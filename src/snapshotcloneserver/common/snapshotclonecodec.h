@@ -32,6 +32,9 @@ using ::curve::common::SNAPINFOKEYPREFIX;
 using ::curve::common::SNAPINFOKEYEND;
 using ::curve::common::CLONEINFOKEYPREFIX;
 using ::curve::common::CLONEINFOKEYEND;
+using ::curve::common::CHUNKPARTREFKEYPREFIX;
+using ::curve::common::CHUNKPARTREFKEYEND;
+using ::curve::common::CHUNKDEDUPFLAGKEY;
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -46,6 +49,16 @@ class SnapshotCloneCodec {
     bool EncodeCloneInfoData(const CloneInfo &data, std::string *value);
     bool DecodeCloneInfoData(const std::string &value, CloneInfo *data);
 
+    std::string EncodeChunkPartRefKey(const std::string &hash);
+    // chunk对象的一个分片对分片数据的引用，按分片数据的hash前缀排列
+    std::string EncodeChunkRefKey(const std::string &hash,
+                                  const std::string &chunkName,
+                                  int partIndex);
+    bool EncodeChunkPartRefData(const ChunkPartRefInfo &data,
+                                std::string *value);
+    bool DecodeChunkPartRefData(const std::string &value,
+                                ChunkPartRefInfo *data);
+
     static std::string GetSnapshotInfoKeyPrefix() {
         return std::string(SNAPINFOKEYPREFIX);
     }
@@ -61,6 +74,28 @@ class SnapshotCloneCodec {
     static std::string GetCloneInfoKeyEnd() {
         return std::string(CLONEINFOKEYEND);
     }
+
+    static std::string GetChunkPartRefKeyPrefix() {
+        return std::string(CHUNKPARTREFKEYPREFIX);
+    }
+
+    static std::string GetChunkPartRefKeyEnd() {
+        return std::string(CHUNKPARTREFKEYEND);
+    }
+
+    // 引用同一分片数据的所有引用记录的key范围
+    static std::string GetChunkRefKeyPrefix(const std::string &hash) {
+        return std::string(CHUNKPARTREFKEYPREFIX) + hash + "/";
+    }
+
+    static std::string GetChunkRefKeyEnd(const std::string &hash) {
+        return std::string(CHUNKPARTREFKEYPREFIX) + hash + "0";
+    }
+
+    // 曾经开启过chunk分片去重的标记
+    static std::string GetChunkDedupFlagKey() {
+        return std::string(CHUNKDEDUPFLAGKEY);
+    }
 };
 
 }  // namespace snapshotcloneserver
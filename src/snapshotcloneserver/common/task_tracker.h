@@ -41,6 +41,8 @@ class TrackerTask;
 
 struct RecoverChunkContext;
 struct CreateCloneChunkContext;
+struct RecoverChunkBatchContext;
+struct CreateCloneChunkBatchContext;
 
 // 并发任务跟踪模块
 class TaskTracker : public std::enable_shared_from_this<TaskTracker> {
@@ -134,6 +136,15 @@ using CreateCloneChunkContextPtr = std::shared_ptr<CreateCloneChunkContext>;
 using CreateCloneChunkTaskTracker =
     ContextTaskTracker<CreateCloneChunkContextPtr>;
 
+using RecoverChunkBatchContextPtr = std::shared_ptr<RecoverChunkBatchContext>;
+using RecoverChunkBatchTaskTracker =
+    ContextTaskTracker<RecoverChunkBatchContextPtr>;
+
+using CreateCloneChunkBatchContextPtr =
+    std::shared_ptr<CreateCloneChunkBatchContext>;
+using CreateCloneChunkBatchTaskTracker =
+    ContextTaskTracker<CreateCloneChunkBatchContextPtr>;
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
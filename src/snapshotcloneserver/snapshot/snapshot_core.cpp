@@ -25,6 +25,7 @@
 #include <glog/logging.h>
 #include <utility>
 #include <algorithm>
+#include <set>
 
 #include "src/common/snapshotclone/snapshotclone_define.h"
 #include "src/snapshotcloneserver/snapshot/snapshot_task.h"
@@ -44,6 +45,12 @@ int SnapshotCoreImpl::Init() {
         LOG(ERROR) << "SnapshotCoreImpl, thread start fail, ret = " << ret;
         return ret;
     }
+    ret = uploadThreadPool_->Start();
+    if (ret < 0) {
+        LOG(ERROR) << "SnapshotCoreImpl, upload thread start fail"
+                   << ", ret = " << ret;
+        return ret;
+    }
     return kErrCodeSuccess;
 }
 
@@ -284,21 +291,41 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
     task->SetProgress(kProgressBuildSnapshotMapComplete);
     task->UpdateMetric();
 
+    // 与其他快照共用的chunk如果已打包存储，需要在索引中记录其位置，
+    // 未开启打包存储时也要记录，否则克隆时找不到这些chunk的数据
+    if (ReuseChunkPackLocation(fileSnapshotMap, &indexData)) {
+        ret = dataStore_->PutChunkIndexData(name, indexData);
+        if (ret < 0) {
+            LOG(ERROR) << "PutChunkIndexData error, "
+                       << " ret = " << ret
+                       << ", uuid = " << task->GetUuid();
+            HandleCreateSnapshotError(task);
+            return;
+        }
+    }
+
+    std::shared_ptr<ChunkPackWriter> packWriter =
+        dataStore_->NewChunkPackWriter(fileName);
     if (existIndexData) {
-        ret = TransferSnapshotData(indexData,
+        ret = TransferSnapshotData(&indexData,
             *info,
             segInfos,
-            [this] (const ChunkDataName &chunkDataName) {
-                return dataStore_->ChunkDataExist(chunkDataName);
+            [this, &indexData] (const ChunkDataName &chunkDataName) {
+                ChunkPackLocation location;
+                return indexData.GetChunkPackLocation(
+                           chunkDataName.chunkIndex_, &location) ||
+                       dataStore_->ChunkDataExist(chunkDataName);
             },
+            packWriter,
             task);
     } else {
-        ret = TransferSnapshotData(indexData,
+        ret = TransferSnapshotData(&indexData,
             *info,
             segInfos,
             [&fileSnapshotMap] (const ChunkDataName &chunkDataName) {
                 return fileSnapshotMap.IsExistChunk(chunkDataName);
             },
+            packWriter,
             task);
     }
     if (ret < 0) {
@@ -383,11 +410,20 @@ void SnapshotCoreImpl::CancelAfterTransferSnapshotData(
     LOG(INFO) << "Cancel After TransferSnapshotData"
               << ", uuid = " << task->GetUuid();
     std::vector<ChunkIndexType> chunkIndexVec = indexData.GetAllChunkIndex();
+    // 本次转储写入的pack中只有本快照的chunk，可以直接删除
+    std::set<std::string> packKeys;
     for (auto &chunkIndex : chunkIndexVec) {
         ChunkDataName chunkDataName;
         indexData.GetChunkDataName(chunkIndex, &chunkDataName);
-        if ((!fileSnapshotMap.IsExistChunk(chunkDataName)) &&
-            (dataStore_->ChunkDataExist(chunkDataName))) {
+        ChunkPackLocation location;
+        if (fileSnapshotMap.IsExistChunk(chunkDataName)) {
+            continue;
+        }
+        if (indexData.GetChunkPackLocation(chunkIndex, &location)) {
+            packKeys.insert(location.packKey);
+            continue;
+        }
+        if (dataStore_->ChunkDataExist(chunkDataName)) {
             int ret =  dataStore_->DeleteChunkData(chunkDataName);
             if (ret < 0) {
                 LOG(ERROR) << "DeleteChunkData error"
@@ -402,6 +438,18 @@ void SnapshotCoreImpl::CancelAfterTransferSnapshotData(
             }
         }
     }
+    for (auto &packKey : packKeys) {
+        int ret = dataStore_->DeleteChunkPack(packKey);
+        if (ret < 0) {
+            LOG(ERROR) << "DeleteChunkPack error "
+                       << "while canceling CreateSnapshot, "
+                       << " ret = " << ret
+                       << ", packKey = " << packKey
+                       << ", uuid = " << task->GetUuid();
+            HandleCreateSnapshotError(task);
+            return;
+        }
+    }
     CancelAfterCreateChunkIndexData(task);
 }
 
@@ -773,10 +821,11 @@ int SnapshotCoreImpl::BuildSegmentInfo(
 }
 
 int SnapshotCoreImpl::TransferSnapshotData(
-    const ChunkIndexData indexData,
+    ChunkIndexData *indexData,
     const SnapshotInfo &info,
     const std::map<uint64_t, SegmentInfo> &segInfos,
     const ChunkDataExistFilter &filter,
+    std::shared_ptr<ChunkPackWriter> packWriter,
     std::shared_ptr<SnapshotTaskInfo> task) {
     int ret = 0;
     uint64_t segmentSize = info.GetSegmentSize();
@@ -789,7 +838,7 @@ int SnapshotCoreImpl::TransferSnapshotData(
         return kErrCodeChunkSizeNotAligned;
     }
 
-    std::vector<ChunkIndexType> chunkIndexVec = indexData.GetAllChunkIndex();
+    std::vector<ChunkIndexType> chunkIndexVec = indexData->GetAllChunkIndex();
 
     uint32_t totalProgress = kProgressTransferSnapshotDataComplete -
         kProgressTransferSnapshotDataStart;
@@ -828,7 +877,7 @@ int SnapshotCoreImpl::TransferSnapshotData(
     auto tracker = std::make_shared<TaskTracker>();
     for (auto &chunkIndex : chunkIndexVec) {
         ChunkDataName chunkDataName;
-        indexData.GetChunkDataName(chunkIndex, &chunkDataName);
+        indexData->GetChunkDataName(chunkIndex, &chunkDataName);
         uint64_t segNum = chunkIndex / chunkPerSegment;
         uint64_t chunkIndexInSegment = chunkIndex % chunkPerSegment;
 
@@ -843,18 +892,24 @@ int SnapshotCoreImpl::TransferSnapshotData(
                         clientAsyncMethodRetryTimeSec_,
                         clientAsyncMethodRetryIntervalMs_,
                         readChunkSnapshotConcurrency_);
+                taskInfo->packWriter_ = packWriter;
                 UUID taskId = UUIDGenerator().GenerateUUID();
                 auto task = new TransferSnapshotDataChunkTask(
                     taskId,
                     taskInfo,
                     client_,
-                    dataStore_);
+                    dataStore_,
+                    uploadThreadPool_,
+                    bufferPool_);
                 task->SetTracker(tracker);
                 tracker->AddOneTrace();
                 threadPool_->PushTask(task);
             }
         }
-        if (tracker->GetTaskNum() >= snapshotCoreThreadNum_) {
+        // 读取完成的chunk仍在上传时读取线程已可以处理下一个chunk，
+        // 在途数据量由bufferPool_限制
+        if (tracker->GetTaskNum() >=
+            snapshotCoreThreadNum_ + snapshotUploadThreadNum_) {
             tracker->WaitSome(1);
         }
         ret = tracker->GetResult();
@@ -862,14 +917,25 @@ int SnapshotCoreImpl::TransferSnapshotData(
             LOG(ERROR) << "TransferSnapshotDataChunk tracker GetResult fail"
                        << ", ret = " << ret
                        << ", uuid = " << task->GetUuid();
+            FinishChunkPack(packWriter, tracker, false, indexData, info, task);
             return ret;
         }
+        // 每写完一个pack就记录到索引中，中断后重试时不需要再次转储
+        if (packWriter != nullptr) {
+            ret = SaveChunkPackLocation(packWriter, indexData, info, task);
+            if (ret < 0) {
+                FinishChunkPack(packWriter, tracker, false,
+                    indexData, info, task);
+                return ret;
+            }
+        }
 
         task->SetProgress(static_cast<uint32_t>(
                 kProgressTransferSnapshotDataStart + index * progressPerData));
         task->UpdateMetric();
         index++;
         if (task->IsCanceled()) {
+            FinishChunkPack(packWriter, tracker, false, indexData, info, task);
             return kErrCodeSuccess;
         }
     }
@@ -880,12 +946,81 @@ int SnapshotCoreImpl::TransferSnapshotData(
         LOG(ERROR) << "TransferSnapshotDataChunk tracker GetResult fail"
                    << ", ret = " << ret
                    << ", uuid = " << task->GetUuid();
+        FinishChunkPack(packWriter, tracker, false, indexData, info, task);
         return ret;
     }
 
+    return FinishChunkPack(packWriter, tracker, true, indexData, info, task);
+}
+
+int SnapshotCoreImpl::FinishChunkPack(
+    std::shared_ptr<ChunkPackWriter> packWriter,
+    std::shared_ptr<TaskTracker> tracker,
+    bool flush,
+    ChunkIndexData *indexData,
+    const SnapshotInfo &info,
+    std::shared_ptr<SnapshotTaskInfo> task) {
+    if (packWriter == nullptr) {
+        return kErrCodeSuccess;
+    }
+    // 等待所有chunk转储任务结束，之后不会再有数据追加到pack中
+    tracker->Wait();
+    int ret = kErrCodeSuccess;
+    if (flush) {
+        if (packWriter->Flush() < 0) {
+            LOG(ERROR) << "Flush chunk pack fail"
+                       << ", uuid = " << task->GetUuid();
+            ret = kErrCodeInternalError;
+        }
+    } else {
+        packWriter->Abort();
+    }
+    // 出错时已写完的pack也要记录，删除快照时才能清理
+    int saveRet = SaveChunkPackLocation(packWriter, indexData, info, task);
+    return ret < 0 ? ret : saveRet;
+}
+
+int SnapshotCoreImpl::SaveChunkPackLocation(
+    std::shared_ptr<ChunkPackWriter> packWriter,
+    ChunkIndexData *indexData,
+    const SnapshotInfo &info,
+    std::shared_ptr<SnapshotTaskInfo> task) {
+    auto sealed = packWriter->TakeSealedLocations();
+    if (sealed.empty()) {
+        return kErrCodeSuccess;
+    }
+    for (auto &chunk : sealed) {
+        indexData->PutChunkPackLocation(chunk.first.chunkIndex_,
+                                        chunk.second);
+    }
+    ChunkIndexDataName name(info.GetFileName(), info.GetSeqNum());
+    int ret = dataStore_->PutChunkIndexData(name, *indexData);
+    if (ret < 0) {
+        LOG(ERROR) << "PutChunkIndexData error, "
+                   << " ret = " << ret
+                   << ", uuid = " << task->GetUuid();
+        return kErrCodeInternalError;
+    }
     return kErrCodeSuccess;
 }
 
+bool SnapshotCoreImpl::ReuseChunkPackLocation(
+    const FileSnapMap &fileSnapshotMap,
+    ChunkIndexData *indexData) {
+    bool changed = false;
+    for (auto &chunkIndex : indexData->GetAllChunkIndex()) {
+        ChunkDataName chunkDataName;
+        ChunkPackLocation location;
+        indexData->GetChunkDataName(chunkIndex, &chunkDataName);
+        if (!indexData->GetChunkPackLocation(chunkIndex, &location) &&
+            fileSnapshotMap.GetChunkPackLocation(chunkDataName, &location)) {
+            indexData->PutChunkPackLocation(chunkIndex, location);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
 
 int SnapshotCoreImpl::DeleteSnapshotPre(
     UUID uuid,
@@ -1000,10 +1135,16 @@ void SnapshotCoreImpl::HandleDeleteSnapshotTask(
                   << "begin to DeleteChunkData, "
                   << "chunkDataNum =  " << chunkIndexVec.size();
 
+        // 有chunk数据不再被引用的pack
+        std::set<std::string> packKeys;
         for (auto &chunkIndex : chunkIndexVec) {
             ChunkDataName chunkDataName;
             indexData.GetChunkDataName(chunkIndex, &chunkDataName);
+            ChunkPackLocation location;
             if ((!fileSnapshotMap.IsExistChunk(chunkDataName)) &&
+                indexData.GetChunkPackLocation(chunkIndex, &location)) {
+                packKeys.insert(location.packKey);
+            } else if ((!fileSnapshotMap.IsExistChunk(chunkDataName)) &&
                 (dataStore_->ChunkDataExist(chunkDataName))) {
                 ret =  dataStore_->DeleteChunkData(chunkDataName);
                 if (ret < 0) {
@@ -1023,6 +1164,16 @@ void SnapshotCoreImpl::HandleDeleteSnapshotTask(
             task->UpdateMetric();
             index++;
         }
+        ret = CleanChunkPack(packKeys, &fileSnapshotMap, task);
+        if (ret < 0) {
+            LOG(ERROR) << "CleanChunkPack error, "
+                       << " ret = " << ret
+                       << ", fileName = " << task->GetFileName()
+                       << ", seqNum = " << seqNum
+                       << ", uuid = " << task->GetUuid();
+            HandleDeleteSnapshotError(task);
+            return;
+        }
         task->SetProgress(kDelProgressDeleteChunkDataComplete);
         ret = dataStore_->DeleteChunkIndexData(name);
         if (ret < 0) {
@@ -1127,12 +1278,190 @@ int SnapshotCoreImpl::BuildSnapshotMap(const std::string &fileName,
                 // 否则一旦某个失败的快照没有indexdata，所有快照都无法删除
             } else {
                 fileSnapshotMap->maps.push_back(std::move(indexData));
+                fileSnapshotMap->snaps.push_back(snap);
             }
         }
     }
     return kErrCodeSuccess;
 }
 
+int SnapshotCoreImpl::CleanChunkPack(
+    const std::set<std::string> &packKeys,
+    FileSnapMap *fileSnapshotMap,
+    std::shared_ptr<SnapshotTaskInfo> task) {
+    for (auto &packKey : packKeys) {
+        // 统计其他快照仍引用的数据，同一个chunk可能被多个快照引用
+        std::set<std::string> liveChunks;
+        uint64_t liveBytes = 0;
+        uint64_t packSize = 0;
+        for (auto &indexData : fileSnapshotMap->maps) {
+            for (auto &pack : indexData.GetAllChunkPackLocation()) {
+                if (pack.second.packKey != packKey) {
+                    continue;
+                }
+                ChunkDataName chunkDataName;
+                indexData.GetChunkDataName(pack.first, &chunkDataName);
+                if (liveChunks.insert(chunkDataName.ToDataChunkKey()).second) {
+                    liveBytes += pack.second.length;
+                }
+                packSize = pack.second.packSize;
+            }
+        }
+
+        if (liveChunks.empty()) {
+            int ret = dataStore_->DeleteChunkPack(packKey);
+            if (ret < 0) {
+                LOG(ERROR) << "DeleteChunkPack error, "
+                           << " ret = " << ret
+                           << ", packKey = " << packKey
+                           << ", uuid = " << task->GetUuid();
+                return kErrCodeInternalError;
+            }
+            continue;
+        }
+        if (liveBytes >= packSize * chunkPackGcRatio_) {
+            continue;
+        }
+        // 重写失败只是暂时不能回收空间，不影响删除快照
+        int ret = RewriteChunkPack(packKey, fileSnapshotMap, task);
+        if (ret < 0) {
+            LOG(WARNING) << "RewriteChunkPack fail, "
+                         << " ret = " << ret
+                         << ", packKey = " << packKey
+                         << ", liveBytes = " << liveBytes
+                         << ", packSize = " << packSize
+                         << ", uuid = " << task->GetUuid();
+        }
+    }
+    return kErrCodeSuccess;
+}
+
+int SnapshotCoreImpl::RewriteChunkPack(
+    const std::string &packKey,
+    FileSnapMap *fileSnapshotMap,
+    std::shared_ptr<SnapshotTaskInfo> task) {
+    auto packWriter = dataStore_->NewChunkPackWriter(task->GetFileName());
+    if (packWriter == nullptr) {
+        // 未开启打包存储时不重写，pack在所有引用它的快照删除后回收
+        return kErrCodeSuccess;
+    }
+
+    // 引用该pack的快照和其中的chunk
+    std::vector<size_t> refSnaps;
+    std::map<std::string, std::pair<ChunkDataName, ChunkPackLocation>> chunks;
+    for (size_t i = 0; i < fileSnapshotMap->maps.size(); i++) {
+        bool ref = false;
+        auto &indexData = fileSnapshotMap->maps[i];
+        for (auto &pack : indexData.GetAllChunkPackLocation()) {
+            if (pack.second.packKey == packKey) {
+                ChunkDataName chunkDataName;
+                indexData.GetChunkDataName(pack.first, &chunkDataName);
+                chunks.emplace(chunkDataName.ToDataChunkKey(),
+                    std::make_pair(chunkDataName, pack.second));
+                ref = true;
+            }
+        }
+        if (ref) {
+            refSnaps.push_back(i);
+        }
+    }
+
+    // 锁住引用该pack的快照，防止重写过程中有克隆读到旧的索引；
+    // 正在克隆的快照，其chunkserver可能还在读旧的pack，不能重写
+    std::vector<UUID> uuids;
+    for (auto i : refSnaps) {
+        uuids.push_back(fileSnapshotMap->snaps[i].GetUuid());
+    }
+    std::sort(uuids.begin(), uuids.end());
+    std::vector<std::unique_ptr<NameLockGuard>> guards;
+    for (auto &uuid : uuids) {
+        guards.emplace_back(
+            new NameLockGuard(snapshotRef_->GetSnapshotLock(), uuid));
+        if (snapshotRef_->GetSnapshotRef(uuid) > 0) {
+            LOG(INFO) << "Skip rewrite chunk pack, snapshot is cloning"
+                      << ", packKey = " << packKey
+                      << ", snapshot uuid = " << uuid
+                      << ", uuid = " << task->GetUuid();
+            return kErrCodeSuccess;
+        }
+    }
+
+    int ret = kErrCodeSuccess;
+    for (auto &chunk : chunks) {
+        std::string data;
+        if (dataStore_->GetChunkPackData(chunk.second.second, &data) < 0 ||
+            packWriter->Append(chunk.second.first, data) < 0) {
+            ret = kErrCodeInternalError;
+            break;
+        }
+    }
+    if (ret == kErrCodeSuccess && packWriter->Flush() < 0) {
+        ret = kErrCodeInternalError;
+    }
+    if (ret < 0) {
+        packWriter->Abort();
+    }
+    std::map<std::string, ChunkPackLocation> newLocations;
+    for (auto &chunk : packWriter->TakeSealedLocations()) {
+        newLocations.emplace(chunk.first.ToDataChunkKey(), chunk.second);
+    }
+    if (ret < 0 || newLocations.size() != chunks.size()) {
+        // 新的pack还没有被引用，直接删除
+        std::set<std::string> newPacks;
+        for (auto &location : newLocations) {
+            newPacks.insert(location.second.packKey);
+        }
+        for (auto &newPack : newPacks) {
+            dataStore_->DeleteChunkPack(newPack);
+        }
+        LOG(ERROR) << "Rewrite chunk data of pack fail"
+                   << ", packKey = " << packKey
+                   << ", uuid = " << task->GetUuid();
+        return kErrCodeInternalError;
+    }
+
+    // 更新引用旧pack的快照的索引，全部更新成功后才能删除旧pack
+    for (auto i : refSnaps) {
+        auto &indexData = fileSnapshotMap->maps[i];
+        auto &snap = fileSnapshotMap->snaps[i];
+        ChunkIndexData newIndexData = indexData;
+        for (auto &pack : indexData.GetAllChunkPackLocation()) {
+            if (pack.second.packKey != packKey) {
+                continue;
+            }
+            ChunkDataName chunkDataName;
+            indexData.GetChunkDataName(pack.first, &chunkDataName);
+            newIndexData.PutChunkPackLocation(pack.first,
+                newLocations[chunkDataName.ToDataChunkKey()]);
+        }
+        ChunkIndexDataName name(snap.GetFileName(), snap.GetSeqNum());
+        ret = dataStore_->PutChunkIndexData(name, newIndexData);
+        if (ret < 0) {
+            LOG(ERROR) << "PutChunkIndexData error, "
+                       << " ret = " << ret
+                       << ", fileName = " << snap.GetFileName()
+                       << ", seqNum = " << snap.GetSeqNum()
+                       << ", uuid = " << task->GetUuid();
+            return kErrCodeInternalError;
+        }
+        indexData = newIndexData;
+    }
+
+    ret = dataStore_->DeleteChunkPack(packKey);
+    if (ret < 0) {
+        LOG(ERROR) << "DeleteChunkPack error, "
+                   << " ret = " << ret
+                   << ", packKey = " << packKey
+                   << ", uuid = " << task->GetUuid();
+        return kErrCodeInternalError;
+    }
+    LOG(INFO) << "Rewrite chunk pack success"
+              << ", packKey = " << packKey
+              << ", chunkNum = " << chunks.size()
+              << ", uuid = " << task->GetUuid();
+    return kErrCodeSuccess;
+}
+
 int SnapshotCoreImpl::GetSnapshotList(std::vector<SnapshotInfo> *list) {
     metaStore_->GetSnapshotList(list);
     return kErrCodeSuccess;
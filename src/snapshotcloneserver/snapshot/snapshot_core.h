@@ -23,10 +23,12 @@
 #ifndef SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_CORE_H_
 #define SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_CORE_H_
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 
 #include "src/snapshotcloneserver/common/curvefs_client.h"
 #include "src/snapshotcloneserver/common/snapshotclone_meta_store.h"
@@ -36,6 +38,8 @@
 #include "src/snapshotcloneserver/common/snapshot_reference.h"
 #include "src/common/concurrent/name_lock.h"
 #include "src/snapshotcloneserver/common/thread_pool.h"
+#include "src/snapshotcloneserver/common/task_tracker.h"
+#include "src/snapshotcloneserver/snapshot/transfer_buffer_pool.h"
 
 using ::curve::common::NameLock;
 
@@ -49,6 +53,8 @@ class SnapshotTaskInfo;
  */
 struct FileSnapMap {
     std::vector<ChunkIndexData> maps;
+    // 与maps一一对应的快照信息
+    std::vector<SnapshotInfo> snaps;
 
     /**
      * @brief 获取当前映射表中是否存在当前chunk数据
@@ -68,6 +74,26 @@ struct FileSnapMap {
         }
         return find;
     }
+
+    /**
+     * @brief 获取当前映射表中chunk数据在pack对象中的位置
+     *
+     * @param name chunk数据对象
+     * @param[out] location chunk数据在pack对象中的位置
+     *
+     * @retval true 存在且打包存储
+     * @retval false 不存在或单独存储
+     */
+    bool GetChunkPackLocation(const ChunkDataName &name,
+                              ChunkPackLocation *location) const {
+        for (auto &v : maps) {
+            if (v.IsExistChunkDataName(name) &&
+                v.GetChunkPackLocation(name.chunkIndex_, location)) {
+                return true;
+            }
+        }
+        return false;
+    }
 };
 
 /**
@@ -195,15 +221,30 @@ class SnapshotCoreImpl : public SnapshotCore {
       clientAsyncMethodRetryTimeSec_(option.clientAsyncMethodRetryTimeSec),
       clientAsyncMethodRetryIntervalMs_(
                 option.clientAsyncMethodRetryIntervalMs),
-      readChunkSnapshotConcurrency_(option.readChunkSnapshotConcurrency) {
+      readChunkSnapshotConcurrency_(option.readChunkSnapshotConcurrency),
+      chunkPackGcRatio_(option.chunkPackGcRatio) {
         threadPool_ = std::make_shared<ThreadPool>(
             option.snapshotCoreThreadNum);
+        snapshotUploadThreadNum_ = option.snapshotUploadThreadNum > 0 ?
+            option.snapshotUploadThreadNum : option.snapshotCoreThreadNum;
+        uploadThreadPool_ = std::make_shared<ThreadPool>(
+            snapshotUploadThreadNum_);
+        // 未配置时与流水线之前每个线程最多同时读取的分片总量相同
+        uint64_t memoryLimit = option.snapshotTransferMemoryLimit;
+        if (memoryLimit == 0) {
+            memoryLimit = option.chunkSplitSize *
+                option.snapshotCoreThreadNum *
+                std::max<uint32_t>(1, option.readChunkSnapshotConcurrency);
+        }
+        bufferPool_ = std::make_shared<TransferBufferPool>(
+            option.chunkSplitSize, memoryLimit);
     }
 
     int Init();
 
     ~SnapshotCoreImpl() {
         threadPool_->Stop();
+        uploadThreadPool_->Stop();
     }
 
     // 公有接口定义见SnapshotCore接口注释
@@ -308,19 +349,102 @@ class SnapshotCoreImpl : public SnapshotCore {
     /**
      * @brief 转储快照过程
      *
-     * @param indexData 索引块
+     * @param indexData 索引块，打包存储时记录chunk数据在pack中的位置
      * @param info 快照信息
      * @param segInfos Segment信息
      * @param filter 转储数据块过滤器
+     * @param packWriter 打包存储时chunk数据写入的pack，为空时不打包
      * @param task 快照任务信息
      *
      * @return  错误码
      */
     int TransferSnapshotData(
-        const ChunkIndexData indexData,
+        ChunkIndexData *indexData,
         const SnapshotInfo &info,
         const std::map<uint64_t, SegmentInfo> &segInfos,
         const ChunkDataExistFilter &filter,
+        std::shared_ptr<ChunkPackWriter> packWriter,
+        std::shared_ptr<SnapshotTaskInfo> task);
+
+    /**
+     * @brief 结束转储时写完或终止pack，并记录已完成的pack
+     *
+     * @param packWriter 打包存储时chunk数据写入的pack
+     * @param tracker 转储chunk的任务追踪器
+     * @param flush 是否写完未写满的pack，否则终止
+     * @param indexData 索引块
+     * @param info 快照信息
+     * @param task 快照任务信息
+     *
+     * @return  错误码
+     */
+    int FinishChunkPack(
+        std::shared_ptr<ChunkPackWriter> packWriter,
+        std::shared_ptr<TaskTracker> tracker,
+        bool flush,
+        ChunkIndexData *indexData,
+        const SnapshotInfo &info,
+        std::shared_ptr<SnapshotTaskInfo> task);
+
+    /**
+     * @brief 把已完成的pack中chunk数据的位置记录到索引块并保存
+     *
+     * @param packWriter 打包存储时chunk数据写入的pack
+     * @param indexData 索引块
+     * @param info 快照信息
+     * @param task 快照任务信息
+     *
+     * @return  错误码
+     */
+    int SaveChunkPackLocation(
+        std::shared_ptr<ChunkPackWriter> packWriter,
+        ChunkIndexData *indexData,
+        const SnapshotInfo &info,
+        std::shared_ptr<SnapshotTaskInfo> task);
+
+    /**
+     * @brief 其他快照中已打包存储的chunk，在索引块中引用其所在的pack
+     *
+     * @param fileSnapshotMap 快照文件映射表
+     * @param indexData 索引块
+     *
+     * @retval true 索引块有变化
+     * @retval false 索引块没有变化
+     */
+    bool ReuseChunkPackLocation(
+        const FileSnapMap &fileSnapshotMap,
+        ChunkIndexData *indexData);
+
+    /**
+     * @brief 删除快照后清理其引用的pack
+     *
+     * 没有被其他快照引用的pack直接删除；有效数据比例低于chunkPackGcRatio_
+     * 的pack把仍被引用的chunk数据重写到新的pack中，更新引用它们的快照的
+     * 索引块后删除旧的pack
+     *
+     * @param packKeys 删除的快照中有chunk数据不再被引用的pack
+     * @param fileSnapshotMap 其他快照的文件映射表
+     * @param task 快照任务信息
+     *
+     * @return  错误码
+     */
+    int CleanChunkPack(
+        const std::set<std::string> &packKeys,
+        FileSnapMap *fileSnapshotMap,
+        std::shared_ptr<SnapshotTaskInfo> task);
+
+    /**
+     * @brief 把pack中仍被引用的chunk数据重写到新的pack中
+     *
+     * @param packKey 需要重写的pack
+     * @param fileSnapshotMap 其他快照的文件映射表
+     * @param task 快照任务信息
+     *
+     * @return  错误码
+     */
+    int RewriteChunkPack(
+        const std::string &packKey,
+        FileSnapMap *fileSnapshotMap,
         std::shared_ptr<SnapshotTaskInfo> task);
 
     /**
@@ -413,8 +537,12 @@ class SnapshotCoreImpl : public SnapshotCore {
     // 快照引用计数管理模块
     std::shared_ptr<SnapshotReference> snapshotRef_;
 
-    // 执行并发步骤的线程池
+    // 执行并发步骤的线程池，转储快照时用于读取chunk
     std::shared_ptr<ThreadPool> threadPool_;
+    // 转储快照时上传chunk分片的线程池
+    std::shared_ptr<ThreadPool> uploadThreadPool_;
+    // 转储快照时从chunkserver读取的分片buffer，限制在途数据总量
+    std::shared_ptr<TransferBufferPool> bufferPool_;
 
     // 锁住打快照的文件名，防止并发同时对其打快照，同一文件的快照需排队
     NameLock snapshotNameLock_;
@@ -427,6 +555,8 @@ class SnapshotCoreImpl : public SnapshotCore {
     uint32_t maxSnapshotLimit_;
     // 线程数
     uint32_t snapshotCoreThreadNum_;
+    // 上传分片的线程数
+    uint32_t snapshotUploadThreadNum_;
     // session超时时间
     uint32_t mdsSessionTimeUs_;
     // client异步回调请求的重试总时间
@@ -435,6 +565,8 @@ class SnapshotCoreImpl : public SnapshotCore {
     uint64_t clientAsyncMethodRetryIntervalMs_;
     // 异步ReadChunkSnapshot的并发数
     uint32_t readChunkSnapshotConcurrency_;
+    // 删除快照后pack中有效数据的比例低于该值时重写pack
+    double chunkPackGcRatio_;
 };
 
 }  // namespace snapshotcloneserver
@@ -65,6 +65,14 @@ bool ChunkIndexData::Serialize(std::string *data) const {
                 ChunkDataName(fileName_, m.second, m.first).
                 ToDataChunkKey()});
     }
+    for (const auto &m : this->packMap_) {
+        ChunkPackLocationData location;
+        location.set_packkey(m.second.packKey);
+        location.set_offset(m.second.offset);
+        location.set_length(m.second.length);
+        location.set_packsize(m.second.packSize);
+        map.mutable_packmap()->insert({m.first, location});
+    }
     // Todo：可以转化为stream给adpater接口使用SerializeToOstream
     return map.SerializeToString(data);
 }
@@ -82,6 +90,11 @@ bool ChunkIndexData::Unserialize(const std::string &data) {
                 return false;
             }
         }
+        for (const auto &m : map.packmap()) {
+            this->packMap_[m.first] = ChunkPackLocation(
+                m.second.packkey(), m.second.offset(),
+                m.second.length(), m.second.packsize());
+        }
         return true;
     } else {
         return false;
@@ -112,6 +125,16 @@ bool ChunkIndexData::IsExistChunkDataName(const ChunkDataName &name) const {
     return false;
 }
 
+bool ChunkIndexData::GetChunkPackLocation(ChunkIndexType index,
+    ChunkPackLocation *location) const {
+    auto it = packMap_.find(index);
+    if (it == packMap_.end()) {
+        return false;
+    }
+    *location = it->second;
+    return true;
+}
+
 std::vector<ChunkIndexType> ChunkIndexData::GetAllChunkIndex() const {
     std::vector<ChunkIndexType> ret;
     for (auto it : chunkMap_) {
@@ -31,11 +31,16 @@
 #include <list>
 #include <string>
 #include <memory>
+#include <utility>
+#include <algorithm>
 
 #include "src/common/concurrent/concurrent.h"
+#include "src/common/chunk_object_layout.h"
 
 using ::curve::common::SpinLock;
 using ::curve::common::LockGuard;
+using ::curve::common::ChunkObjectLayout;
+using ::curve::common::CompressType;
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -109,12 +114,43 @@ class ChunkIndexDataName {
             + std::to_string(this->fileSeqNum_);
     }
 
+    /**
+     * 构建快照热点chunk记录的名称 索引chunk的名称+"-hot"
+     * @return: 热点chunk记录的名称字符串
+     */
+    std::string ToHotChunkIndexKey() const {
+        return ToIndexDataChunkKey() + "-hot";
+    }
+
     // 文件名
     std::string fileName_;
     // 文件版本号
     SnapshotSeqType fileSeqNum_;
 };
 
+// 打包存储的chunk数据在pack对象中的位置
+struct ChunkPackLocation {
+    ChunkPackLocation() : offset(0), length(0), packSize(0) {}
+    ChunkPackLocation(const std::string &key, uint64_t off, uint64_t len,
+                      uint64_t size)
+        : packKey(key), offset(off), length(len), packSize(size) {}
+
+    // pack对象名
+    std::string packKey;
+    // chunk数据在pack对象中的偏移
+    uint64_t offset;
+    // chunk数据的长度
+    uint64_t length;
+    // pack对象的总长度
+    uint64_t packSize;
+};
+
+inline bool operator==(const ChunkPackLocation &lhs,
+                       const ChunkPackLocation &rhs) {
+    return lhs.packKey == rhs.packKey && lhs.offset == rhs.offset &&
+           lhs.length == rhs.length && lhs.packSize == rhs.packSize;
+}
+
 class ChunkIndexData {
  public:
     ChunkIndexData() {}
@@ -142,6 +178,30 @@ class ChunkIndexData {
 
     std::vector<ChunkIndexType> GetAllChunkIndex() const;
 
+    /**
+     * 记录chunk数据在pack对象中的位置
+     * @param index chunk索引，需要已通过PutChunkDataName加入索引
+     * @param location chunk数据在pack对象中的位置
+     */
+    void PutChunkPackLocation(ChunkIndexType index,
+                              const ChunkPackLocation &location) {
+        if (chunkMap_.find(index) != chunkMap_.end()) {
+            packMap_[index] = location;
+        }
+    }
+
+    /**
+     * 获取chunk数据在pack对象中的位置
+     * @return: true chunk打包存储/ false chunk单独存储或不存在
+     */
+    bool GetChunkPackLocation(ChunkIndexType index,
+                              ChunkPackLocation *location) const;
+
+    const std::map<ChunkIndexType, ChunkPackLocation> &
+        GetAllChunkPackLocation() const {
+        return packMap_;
+    }
+
     void SetFileName(const std::string &fileName) {
         fileName_ = fileName;
     }
@@ -155,6 +215,8 @@ class ChunkIndexData {
     std::string fileName_;
     // 快照文件索引信息map
     std::map<ChunkIndexType, SnapshotSeqType> chunkMap_;
+    // 打包存储的chunk在pack对象中的位置
+    std::map<ChunkIndexType, ChunkPackLocation> packMap_;
 };
 
 
@@ -164,10 +226,69 @@ class ChunkData{
     std::string data_;
 };
 
+/**
+ * 把多个chunk的数据依次写入pack对象，pack写满后封装为一个完整的对象，
+ * chunk数据在其所在的pack封装完成前不可读
+ */
+class ChunkPackWriter {
+ public:
+    virtual ~ChunkPackWriter() {}
+    /**
+     * 追加一个chunk的数据，可以被多个线程并发调用
+     * @param name chunk名
+     * @param data chunk的数据
+     * @return 0 成功/ -1 失败
+     */
+    virtual int Append(const ChunkDataName &name, const std::string &data) = 0;
+    /**
+     * 封装所有未写满的pack，并等待已追加的数据全部写入
+     * @return 0 成功/ -1 有pack写入失败
+     */
+    virtual int Flush() = 0;
+    /**
+     * 终止所有未封装的pack，已追加但未封装的数据被丢弃
+     */
+    virtual void Abort() = 0;
+    /**
+     * 取走已封装完成的pack中chunk数据的位置，每个chunk只返回一次
+     * @return chunk名和chunk数据在pack中的位置
+     */
+    virtual std::vector<std::pair<ChunkDataName, ChunkPackLocation>>
+        TakeSealedLocations() = 0;
+};
+
 class TransferTask {
  public:
-     TransferTask() {}
+     TransferTask()
+         : partSize_(0), partCount_(0), partRefsUnpinned_(false) {}
      std::string uploadId_;
+     // 打包存储时chunk数据写入的pack，为空时chunk单独存储为一个对象
+     std::shared_ptr<ChunkPackWriter> packWriter_;
+
+     /**
+      * 打包存储时暂存一个分片需要写入的数据，chunk转储完成时一起写入pack
+      * @param partIndex 分片序号
+      * @param data 分片需要写入的数据
+      */
+     void AddPartData(int partIndex, std::string *data) {
+         m_.Lock();
+         partData_[partIndex].swap(*data);
+         m_.UnLock();
+     }
+
+     /**
+      * 按分片序号取出暂存的数据，拼接为chunk数据
+      * @param[out] data chunk数据
+      */
+     void TakePartData(std::string *data) {
+         m_.Lock();
+         data->clear();
+         for (auto &part : partData_) {
+             data->append(part.second);
+         }
+         partData_.clear();
+         m_.UnLock();
+     }
 
      void AddPartInfo(int partNum, std::string etag) {
          m_.Lock();
@@ -179,10 +300,99 @@ class TransferTask {
          return partInfo_;
      }
 
+     /**
+      * 记录chunk的一个分片，用于生成chunk对象的layout
+      * @param partIndex 分片序号
+      * @param partSize 分片大小
+      * @param storedLength 分片写入对象的长度，0表示未写入
+      * @param type 分片的压缩算法
+      */
+     void AddPartLayout(int partIndex, int partSize,
+                        uint32_t storedLength, CompressType type) {
+         m_.Lock();
+         partSize_ = partSize;
+         partCount_ = std::max(partCount_, partIndex + 1);
+         if (storedLength != 0) {
+             storedParts_[partIndex] = std::make_pair(storedLength, type);
+         }
+         m_.UnLock();
+     }
+
+     /**
+      * 记录chunk的一个按内容去重存储的分片
+      * @param partIndex 分片序号
+      * @param partSize 分片大小
+      * @param storedLength 分片数据在对象中的长度
+      * @param type 分片数据的压缩算法
+      * @param hash 分片原始数据的sha256
+      */
+     void AddPartRef(int partIndex, int partSize, uint32_t storedLength,
+                     CompressType type, const std::string &hash) {
+         AddPartLayout(partIndex, partSize, storedLength, type);
+         m_.Lock();
+         partHashes_[partIndex] = hash;
+         m_.UnLock();
+     }
+
+     // 转储过程中按内容去重存储的分片 <=> 分片数据的sha256
+     std::map<int, std::string> GetPartRefs() {
+         m_.Lock();
+         std::map<int, std::string> hashes = partHashes_;
+         m_.UnLock();
+         return hashes;
+     }
+
+     /**
+      * 取出转储过程中引用的分片数据，在记录引用前这些分片数据不能被删除；
+      * 只有第一次调用时返回
+      * @return 分片数据的sha256，引用了几次就出现几次
+      */
+     std::vector<std::string> TakePinnedPartRefs() {
+         std::vector<std::string> hashes;
+         m_.Lock();
+         if (!partRefsUnpinned_) {
+             partRefsUnpinned_ = true;
+             for (const auto &part : partHashes_) {
+                 hashes.push_back(part.second);
+             }
+         }
+         m_.UnLock();
+         return hashes;
+     }
+
+     ChunkObjectLayout GetLayout() {
+         m_.Lock();
+         ChunkObjectLayout layout(partSize_, partCount_);
+         for (const auto &part : storedParts_) {
+             auto hash = partHashes_.find(part.first);
+             if (hash != partHashes_.end()) {
+                 layout.SetPartRef(part.first, part.second.first,
+                                   part.second.second, hash->second);
+             } else {
+                 layout.SetPart(part.first, part.second.first,
+                                part.second.second);
+             }
+         }
+         m_.UnLock();
+         return layout;
+     }
+
  private:
      mutable SpinLock m_;
      // partnumber <=> etag
      std::map<int, std::string> partInfo_;
+     // 分片大小
+     int partSize_;
+     // 分片个数
+     int partCount_;
+     // 写入了对象的分片 <=> (写入的长度, 压缩算法)
+     std::map<int, std::pair<uint32_t, CompressType>> storedParts_;
+     // 按内容去重存储的分片 <=> 分片数据的sha256
+     std::map<int, std::string> partHashes_;
+     // 引用的分片数据是否已经取出
+     bool partRefsUnpinned_;
+     // 打包存储时暂存的分片 <=> 分片需要写入的数据
+     std::map<int, std::string> partData_;
 };
 
 class SnapshotDataStore {
@@ -224,6 +434,23 @@ class SnapshotDataStore {
      * @return: true 存在/ false 不存在
      */
     virtual bool ChunkIndexDataExist(const ChunkIndexDataName &name) = 0;
+    /**
+     * 保存从快照lazy克隆的卷访问过的热点chunk，之后的克隆优先恢复这些chunk
+     * 快照元数据删除时一并删除
+     * @param 快照元数据对象名
+     * @param 热点chunk的索引，按优先恢复的顺序排列
+     * @return 0 保存成功/ -1 保存失败
+     */
+    virtual int PutHotChunkIndex(const ChunkIndexDataName &name,
+        const std::vector<ChunkIndexType> &indexes) = 0;
+    /**
+     * 获取快照的热点chunk
+     * @param 快照元数据对象名
+     * @param 保存热点chunk索引的指针，没有记录时为空
+     * @return 0 获取成功/ -1 获取失败
+     */
+    virtual int GetHotChunkIndex(const ChunkIndexDataName &name,
+        std::vector<ChunkIndexType> *indexes) = 0;
 /*
     // 存储快照文件的数据信息到datastore
     virtual int PutChunkData(const ChunkDataName &name,
@@ -289,6 +516,27 @@ class SnapshotDataStore {
      */
     virtual int DataChunkTranferAbort(const ChunkDataName &name,
                                       std::shared_ptr<TransferTask> task) = 0;
+    /**
+     * 创建把chunk数据打包写入pack对象的writer
+     * @param prefix pack对象名的前缀
+     * @return: 未开启打包存储时返回nullptr
+     */
+    virtual std::shared_ptr<ChunkPackWriter> NewChunkPackWriter(
+        const std::string &prefix) = 0;
+    /**
+     * 读取pack对象中一个chunk的数据
+     * @param location chunk数据在pack对象中的位置
+     * @param[out] data chunk数据
+     * @return: 0 读取成功/ -1 读取失败
+     */
+    virtual int GetChunkPackData(const ChunkPackLocation &location,
+                                 std::string *data) = 0;
+    /**
+     * 删除pack对象
+     * @param packKey pack对象名
+     * @return: 0 删除成功/ -1 删除失败
+     */
+    virtual int DeleteChunkPack(const std::string &packKey) = 0;
 };
 
 }   // namespace snapshotcloneserver
@@ -23,26 +23,105 @@
 #include "src/snapshotcloneserver/snapshot/snapshot_data_store_s3.h"
 #include <utility>
 #include <memory>
+#include <set>
 #include <glog/logging.h>    //NOLINT
+#include <openssl/evp.h>
 #include <aws/core/utils/memory/stl/AWSString.h>  //NOLINT
 #include <aws/core/utils/memory/stl/AWSMap.h>  //NOLINT
 #include <aws/core/utils/StringUtils.h>   //NOLINT
+
+#include "proto/snapshotcloneserver.pb.h"
+#include "src/common/uuid.h"
+
+using ::curve::common::IsZeroBuffer;
+using ::curve::common::Compress;
+using ::curve::common::NameLockGuard;
+using ::curve::common::LayoutDecodeStatus;
+using ::curve::common::UUIDGenerator;
+using ::curve::common::UniqueLock;
+
 namespace curve {
 namespace snapshotcloneserver {
 
+namespace {
+
+// pack对象名为"<文件名>-pack-<uuid>"
+const char kChunkPackKeyInfix[] = "-pack-";
+
+// 计算分片数据的sha256
+bool CalcPartHash(const char *buf, int len, std::string *hash) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestSize = 0;
+    if (EVP_Digest(buf, len, digest, &digestSize, EVP_sha256(), NULL) != 1 ||
+        digestSize != ChunkObjectLayout::kPartHashSize) {
+        return false;
+    }
+    hash->assign(reinterpret_cast<char *>(digest), digestSize);
+    return true;
+}
+
+}  // namespace
+
 // nos conf
 int S3SnapshotDataStore::Init(const std::string &path) {
     // Init server conf
     s3Adapter4Meta_->Init(path);
     s3Adapter4Data_->Init(path);
+    if (InitChunkDedupFlag() < 0) {
+        return -1;
+    }
     // create bucket if not exist
     if (!s3Adapter4Meta_->BucketExist()) {
         return s3Adapter4Meta_->CreateBucket();
     } else {
+        AbortChunkPackUploads();
         return 0;
     }
 }
 
+int S3SnapshotDataStore::InitChunkDedupFlag() {
+    if (metaStore_ == nullptr) {
+        dedupEverEnabled_ = false;
+        return 0;
+    }
+    // 先记录再去重存储chunk，删除chunk时据此决定是否读取layout
+    if (IsDedup()) {
+        if (metaStore_->SetChunkDedupFlag() < 0) {
+            LOG(ERROR) << "Failed to set chunk dedup flag";
+            return -1;
+        }
+        dedupEverEnabled_ = true;
+        return 0;
+    }
+    if (metaStore_->GetChunkDedupFlag(&dedupEverEnabled_) < 0) {
+        LOG(ERROR) << "Failed to get chunk dedup flag";
+        return -1;
+    }
+    return 0;
+}
+
+void S3SnapshotDataStore::AbortChunkPackUploads() {
+    std::vector<std::pair<Aws::String, Aws::String>> uploads;
+    if (s3Adapter4Data_->ListMultiUploads("", &uploads) < 0) {
+        LOG(WARNING) << "Failed to list multipart uploads, "
+                     << "skip aborting unsealed chunk packs";
+        return;
+    }
+    for (auto &upload : uploads) {
+        std::string key(upload.first.c_str(), upload.first.size());
+        if (key.find(kChunkPackKeyInfix) == std::string::npos) {
+            continue;
+        }
+        if (s3Adapter4Data_->AbortMultiUpload(upload.first,
+                                              upload.second) < 0) {
+            LOG(WARNING) << "Failed to abort unsealed chunk pack, key = "
+                         << key;
+        } else {
+            LOG(INFO) << "Abort unsealed chunk pack, key = " << key;
+        }
+    }
+}
+
 int S3SnapshotDataStore::PutChunkIndexData(const ChunkIndexDataName &name,
         const ChunkIndexData &indexData) {
     std::string key = name.ToIndexDataChunkKey();
@@ -103,7 +182,50 @@ bool S3SnapshotDataStore::ChunkDataExist(const ChunkDataName &name) {
     return false;
 }
 
+int S3SnapshotDataStore::PutHotChunkIndex(const ChunkIndexDataName &name,
+    const std::vector<ChunkIndexType> &indexes) {
+    HotChunkIndexData hotData;
+    for (auto index : indexes) {
+        hotData.add_chunkindex(index);
+    }
+    std::string data;
+    if (!hotData.SerializeToString(&data)) {
+        LOG(ERROR) << "Failed to serialize HotChunkIndexData";
+        return -1;
+    }
+    std::string key = name.ToHotChunkIndexKey();
+    const Aws::String aws_key(key.c_str(), key.size());
+    return s3Adapter4Meta_->PutObject(aws_key, data);
+}
+
+int S3SnapshotDataStore::GetHotChunkIndex(const ChunkIndexDataName &name,
+    std::vector<ChunkIndexType> *indexes) {
+    indexes->clear();
+    std::string key = name.ToHotChunkIndexKey();
+    const Aws::String aws_key(key.c_str(), key.size());
+    if (!s3Adapter4Meta_->ObjectExist(aws_key)) {
+        return 0;
+    }
+    std::string data;
+    HotChunkIndexData hotData;
+    if (s3Adapter4Meta_->GetObject(aws_key, &data) < 0 ||
+        !hotData.ParseFromString(data)) {
+        LOG(ERROR) << "Failed to get HotChunkIndexData, key = " << key;
+        return -1;
+    }
+    indexes->assign(hotData.chunkindex().begin(), hotData.chunkindex().end());
+    return 0;
+}
+
 int S3SnapshotDataStore::DeleteChunkIndexData(const ChunkIndexDataName &name) {
+    // 热点chunk记录只用于加速克隆，删除失败时不影响删除快照
+    std::string hotKey = name.ToHotChunkIndexKey();
+    const Aws::String aws_hot_key(hotKey.c_str(), hotKey.size());
+    if (s3Adapter4Meta_->ObjectExist(aws_hot_key) &&
+        s3Adapter4Meta_->DeleteObject(aws_hot_key) < 0) {
+        LOG(WARNING) << "Failed to delete HotChunkIndexData, key = "
+                     << hotKey;
+    }
     std::string key = name.ToIndexDataChunkKey();
     const Aws::String aws_key(key.c_str(), key.size());
     return s3Adapter4Meta_->DeleteObject(aws_key);
@@ -112,8 +234,139 @@ int S3SnapshotDataStore::DeleteChunkIndexData(const ChunkIndexDataName &name) {
 int S3SnapshotDataStore::DeleteChunkData(const ChunkDataName &name) {
     std::string key = name.ToDataChunkKey();
     const Aws::String aws_key(key.c_str(), key.size());
+    // 从未开启过去重时不需要读取layout
+    if (metaStore_ == nullptr || !dedupEverEnabled_) {
+        return s3Adapter4Meta_->DeleteObject(aws_key);
+    }
+    // 是否引用了分片数据由chunk对象的layout决定，与当前是否开启去重无关，
+    // 关闭去重后之前去重存储的chunk对象也要释放引用
+    ChunkObjectLayout layout;
+    bool isLayout = false;
+    if (GetChunkObjectLayout(key, &layout, &isLayout) < 0) {
+        return -1;
+    }
+    if (isLayout && layout.HasPartRef()) {
+        std::map<int, std::string> parts;
+        for (uint32_t i = 0; i < layout.GetPartNum(); ++i) {
+            std::string hash = layout.GetPartHash(i);
+            if (!hash.empty()) {
+                parts.emplace(i, hash);
+            }
+        }
+        // 先释放引用再删除chunk对象，释放引用可以重复执行，
+        // 中途失败时chunk对象仍在，重试删除时会继续释放
+        if (ReleasePartRefs(key, parts) < 0) {
+            LOG(ERROR) << "Failed to release parts of " << key;
+            return -1;
+        }
+    }
     return s3Adapter4Meta_->DeleteObject(aws_key);
 }
+
+int S3SnapshotDataStore::GetChunkObjectLayout(const std::string &key,
+                                              ChunkObjectLayout *layout,
+                                              bool *isLayout) {
+    // 去重存储的chunk对象只有layout，一般一次就能读出整个layout
+    const size_t kLayoutProbeSize = 4096;
+    std::string tail;
+    if (s3Adapter4Meta_->GetObjectTail(key, kLayoutProbeSize, &tail) < 0) {
+        LOG(ERROR) << "Failed to get tail of " << key;
+        return -1;
+    }
+    size_t needLen = 0;
+    LayoutDecodeStatus status = ChunkObjectLayout::Decode(
+        tail.data(), tail.size(), layout, &needLen);
+    if (status == LayoutDecodeStatus::NeedMore) {
+        if (s3Adapter4Meta_->GetObjectTail(key, needLen, &tail) < 0) {
+            LOG(ERROR) << "Failed to get tail of " << key;
+            return -1;
+        }
+        status = ChunkObjectLayout::Decode(
+            tail.data(), tail.size(), layout, &needLen);
+    }
+    if (status == LayoutDecodeStatus::OK) {
+        *isLayout = true;
+        return 0;
+    } else if (status == LayoutDecodeStatus::NotLayout) {
+        *isLayout = false;
+        return 0;
+    }
+    LOG(ERROR) << "Failed to decode layout of " << key
+               << ", status = " << static_cast<int>(status);
+    return -1;
+}
+
+int S3SnapshotDataStore::ReleasePartRefs(const std::string &chunkName,
+    const std::map<int, std::string> &parts) {
+    if (parts.empty()) {
+        return 0;
+    }
+    // 引用按chunk对象记录，重复删除不影响其他chunk对象的引用
+    if (metaStore_->RemoveChunkPartRefs(chunkName, parts) < 0) {
+        return -1;
+    }
+    std::set<std::string> hashes;
+    for (const auto &part : parts) {
+        hashes.insert(part.second);
+    }
+    for (const auto &hash : hashes) {
+        if (ReleasePartData(hash) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int S3SnapshotDataStore::ReleasePartData(const std::string &hash) {
+    NameLockGuard guard(partRefLock_, hash);
+    // 转储中的chunk还未记录对分片数据的引用
+    if (IsPartPinned(hash)) {
+        return 0;
+    }
+    bool referenced = false;
+    if (metaStore_->HasChunkPartRef(hash, &referenced) < 0) {
+        return -1;
+    }
+    if (referenced) {
+        return 0;
+    }
+    // 先删除记录使分片数据失效，再删除分片数据；中途失败时只会残留无记录的
+    // 分片数据，之后转储相同内容的分片时会重新写入
+    if (metaStore_->DeleteChunkPartRef(hash) < 0) {
+        return -1;
+    }
+    std::string key = ChunkObjectLayout::PartObjectKey(hash);
+    const Aws::String aws_key(key.c_str(), key.size());
+    if (s3Adapter4Data_->DeleteObject(aws_key) < 0) {
+        LOG(ERROR) << "Failed to delete part object " << key;
+        return -1;
+    }
+    if (dedupMetric_ != nullptr) {
+        dedupMetric_->partReleased << 1;
+    }
+    return 0;
+}
+
+void S3SnapshotDataStore::PinPart(const std::string &hash) {
+    LockGuard guard(pinnedPartsLock_);
+    pinnedParts_[hash]++;
+}
+
+void S3SnapshotDataStore::UnpinParts(const std::vector<std::string> &hashes) {
+    LockGuard guard(pinnedPartsLock_);
+    for (const auto &hash : hashes) {
+        auto it = pinnedParts_.find(hash);
+        if (it != pinnedParts_.end() && --it->second == 0) {
+            pinnedParts_.erase(it);
+        }
+    }
+}
+
+bool S3SnapshotDataStore::IsPartPinned(const std::string &hash) {
+    LockGuard guard(pinnedPartsLock_);
+    return pinnedParts_.count(hash) != 0;
+}
+
 /*
 int S3SnapshotDataStore::SetSnapshotFlag(const ChunkIndexDataName &name,
                                          int flag) {
@@ -144,6 +397,11 @@ int S3SnapshotDataStore::GetSnapshotFlag(const ChunkIndexDataName &name) {
 */
 int S3SnapshotDataStore::DataChunkTranferInit(const ChunkDataName &name,
                                     std::shared_ptr<TransferTask> task) {
+    // 去重存储时分片数据单独写入，chunk对象只有layout，在完成时一次写入；
+    // 打包存储时chunk数据在完成时整体追加到pack中
+    if (IsDedup() || task->packWriter_ != nullptr) {
+        return 0;
+    }
     std::string key = name.ToDataChunkKey();
     const Aws::String aws_key(key.c_str(), key.size());
     Aws::String aws_uploadId = s3Adapter4Data_->MultiUploadInit(aws_key);
@@ -161,12 +419,36 @@ int S3SnapshotDataStore::DataChunkTranferAddPart(const ChunkDataName &name,
                                         int partNum,
                                         int partSize,
                                         const char *buf) {
+    // 全0的分片不写入对象，由对象末尾的layout记录
+    if ((option_.sparse || IsDedup()) && IsZeroBuffer(buf, partSize)) {
+        task->AddPartLayout(partNum, partSize, 0, CompressType::None);
+        return 0;
+    }
+    if (IsDedup()) {
+        return AddPartRef(task, partNum, partSize, buf);
+    }
+    const char *data = nullptr;
+    int dataSize = 0;
+    CompressType compressType = CompressType::None;
+    std::string compressed;
+    if (PreparePartData(buf, partSize, &compressed,
+                        &data, &dataSize, &compressType) < 0) {
+        LOG(ERROR) << "Failed to compress part " << partNum
+                   << " of " << name.ToDataChunkKey();
+        return -1;
+    }
+    if (task->packWriter_ != nullptr) {
+        std::string partData(data, dataSize);
+        task->AddPartData(partNum, &partData);
+        task->AddPartLayout(partNum, partSize, dataSize, compressType);
+        return 0;
+    }
     std::string key = name.ToDataChunkKey();
     const Aws::String aws_key(key.c_str(), key.size());
     const Aws::String uploadId(task->uploadId_.c_str(), task->uploadId_.size());
     Aws::S3::Model::CompletedPart cp =
         s3Adapter4Data_->UploadOnePart(
-            aws_key, uploadId, partNum + 1, partSize, buf);
+            aws_key, uploadId, partNum + 1, dataSize, data);
     std::string etag(cp.GetETag().c_str(), cp.GetETag().size());
     int tmp_partnum = cp.GetPartNumber();
     if (etag == "errorTag" && tmp_partnum == -1) {
@@ -174,14 +456,142 @@ int S3SnapshotDataStore::DataChunkTranferAddPart(const ChunkDataName &name,
         return -1;
     }
     task->AddPartInfo(tmp_partnum, etag);
+    task->AddPartLayout(partNum, partSize, dataSize, compressType);
+    return 0;
+}
+
+int S3SnapshotDataStore::PreparePartData(const char *buf, int partSize,
+                                         std::string *compressed,
+                                         const char **data, int *dataSize,
+                                         CompressType *type) {
+    *data = buf;
+    *dataSize = partSize;
+    *type = CompressType::None;
+    if (option_.compressType == CompressType::None) {
+        return 0;
+    }
+    if (!Compress(option_.compressType, option_.compressLevel,
+                  buf, partSize, compressed)) {
+        return -1;
+    }
+    // 压缩后变小的分片才存储压缩后的数据
+    if (compressed->size() < static_cast<size_t>(partSize)) {
+        *data = compressed->data();
+        *dataSize = compressed->size();
+        *type = option_.compressType;
+    }
+    return 0;
+}
+
+int S3SnapshotDataStore::AddPartRef(std::shared_ptr<TransferTask> task,
+                                    int partNum, int partSize,
+                                    const char *buf) {
+    std::string hash;
+    if (!CalcPartHash(buf, partSize, &hash)) {
+        LOG(ERROR) << "Failed to calc hash of part " << partNum;
+        return -1;
+    }
+
+    NameLockGuard guard(partRefLock_, hash);
+    ChunkPartRefInfo info;
+    if (metaStore_->GetChunkPartRef(hash, &info) < 0) {
+        return -1;
+    }
+    bool deduped = info.storedLength > 0;
+    if (!deduped) {
+        // 先写入分片数据，chunk转储完成时再批量记录分片数据和引用，
+        // 中途失败时只会残留无引用的分片数据
+        const char *data = nullptr;
+        int dataSize = 0;
+        CompressType compressType = CompressType::None;
+        std::string compressed;
+        if (PreparePartData(buf, partSize, &compressed,
+                            &data, &dataSize, &compressType) < 0) {
+            LOG(ERROR) << "Failed to compress part " << partNum;
+            return -1;
+        }
+        std::string key = ChunkObjectLayout::PartObjectKey(hash);
+        const Aws::String aws_key(key.c_str(), key.size());
+        if (s3Adapter4Data_->PutObject(aws_key,
+                std::string(data, dataSize)) < 0) {
+            LOG(ERROR) << "Failed to put part object " << key;
+            return -1;
+        }
+        info.hash = hash;
+        info.storedLength = dataSize;
+        info.compressType = compressType;
+    }
+    // 记录引用前分片数据不能被删除
+    PinPart(hash);
+    task->AddPartRef(partNum, partSize, info.storedLength,
+                     info.compressType, hash);
+
+    if (dedupMetric_ != nullptr) {
+        dedupMetric_->partTotal << 1;
+        dedupMetric_->bytesTotal << partSize;
+        if (deduped) {
+            dedupMetric_->partDeduped << 1;
+            dedupMetric_->bytesDeduped << partSize;
+        }
+    }
     return 0;
 }
 
 int S3SnapshotDataStore::DataChunkTranferComplete(const ChunkDataName &name,
                                         std::shared_ptr<TransferTask> task) {
+    if (task->packWriter_ != nullptr) {
+        // 与单独存储时的chunk对象格式相同，layout在数据末尾
+        std::string data;
+        task->TakePartData(&data);
+        if (NeedLayout()) {
+            task->GetLayout().Encode(&data);
+        }
+        return task->packWriter_->Append(name, data);
+    }
     std::string key = name.ToDataChunkKey();
     const Aws::String aws_key(key.c_str(), key.size());
+    if (IsDedup()) {
+        // chunk的所有引用批量记录，记录后再写入chunk对象，
+        // 中途失败时由DataChunkTranferAbort删除已记录的引用
+        ChunkObjectLayout layout = task->GetLayout();
+        std::map<int, ChunkPartRefInfo> parts;
+        for (uint32_t i = 0; i < layout.GetPartNum(); ++i) {
+            std::string hash = layout.GetPartHash(i);
+            if (hash.empty()) {
+                continue;
+            }
+            ChunkPartRefInfo &info = parts[i];
+            info.hash = hash;
+            info.storedLength = layout.GetStoredLength(i);
+            info.compressType = layout.GetCompressType(i);
+        }
+        int ret = parts.empty() ? 0 : metaStore_->AddChunkPartRefs(key, parts);
+        UnpinParts(task->TakePinnedPartRefs());
+        if (ret < 0) {
+            LOG(ERROR) << "Failed to add part refs of " << key;
+            return -1;
+        }
+        std::string object;
+        layout.Encode(&object);
+        return s3Adapter4Data_->PutObject(aws_key, object);
+    }
     const Aws::String uploadId(task->uploadId_.c_str(), task->uploadId_.size());
+    // layout作为最后一个分片写入对象末尾，分片号可以不连续
+    if (NeedLayout()) {
+        ChunkObjectLayout layout = task->GetLayout();
+        std::string footer;
+        layout.Encode(&footer);
+        Aws::S3::Model::CompletedPart cp =
+            s3Adapter4Data_->UploadOnePart(aws_key, uploadId,
+                layout.GetPartNum() + 1, footer.size(), footer.data());
+        std::string etag(cp.GetETag().c_str(), cp.GetETag().size());
+        int tmp_partnum = cp.GetPartNumber();
+        if (etag == "errorTag" && tmp_partnum == -1) {
+            LOG(ERROR) << "Failed to upload chunk object layout";
+            return -1;
+        }
+        task->AddPartInfo(tmp_partnum, etag);
+    }
     Aws::Vector<Aws::S3::Model::CompletedPart> cp_v;
     for (auto &v : task->GetPartInfo()) {
         Aws::String str(v.second.c_str(), v.second.size());
@@ -194,11 +604,243 @@ int S3SnapshotDataStore::DataChunkTranferComplete(const ChunkDataName &name,
 
 int S3SnapshotDataStore::DataChunkTranferAbort(const ChunkDataName &name,
                                     std::shared_ptr<TransferTask> task) {
+    if (task->packWriter_ != nullptr) {
+        std::string discard;
+        task->TakePartData(&discard);
+        return 0;
+    }
     std::string key = name.ToDataChunkKey();
     const Aws::String aws_key(key.c_str(), key.size());
+    if (IsDedup()) {
+        UnpinParts(task->TakePinnedPartRefs());
+        // 写入chunk对象的结果未知时对象可能已存在，先删除再释放引用
+        if (s3Adapter4Data_->DeleteObject(aws_key) < 0) {
+            return -1;
+        }
+        return ReleasePartRefs(key, task->GetPartRefs());
+    }
     const Aws::String uploadId(task->uploadId_.c_str(), task->uploadId_.size());
     return s3Adapter4Data_->AbortMultiUpload(aws_key, uploadId);
 }
+
+std::shared_ptr<ChunkPackWriter> S3SnapshotDataStore::NewChunkPackWriter(
+    const std::string &prefix) {
+    if (!IsPack()) {
+        return nullptr;
+    }
+    return std::make_shared<S3ChunkPackWriter>(s3Adapter4Data_, prefix,
+        option_.packSize, option_.packPartSize);
+}
+
+int S3SnapshotDataStore::GetChunkPackData(const ChunkPackLocation &location,
+                                          std::string *data) {
+    data->resize(location.length);
+    if (location.length == 0) {
+        return 0;
+    }
+    if (s3Adapter4Data_->GetObject(location.packKey, &(*data)[0],
+            location.offset, location.length) < 0) {
+        LOG(ERROR) << "Failed to get chunk data from pack "
+                   << location.packKey
+                   << ", offset = " << location.offset
+                   << ", length = " << location.length;
+        return -1;
+    }
+    return 0;
+}
+
+int S3SnapshotDataStore::DeleteChunkPack(const std::string &packKey) {
+    const Aws::String aws_key(packKey.c_str(), packKey.size());
+    return s3Adapter4Data_->DeleteObject(aws_key);
+}
+
+int S3ChunkPackWriter::Append(const ChunkDataName &name,
+                              const std::string &data) {
+    std::vector<PackPart> parts;
+    std::shared_ptr<Pack> completePack;
+    {
+        LockGuard guard(mtx_);
+        if (failed_) {
+            return -1;
+        }
+        if (current_ == nullptr) {
+            auto pack = std::make_shared<Pack>();
+            pack->key = prefix_ + kChunkPackKeyInfix +
+                        UUIDGenerator().GenerateUUID();
+            const Aws::String aws_key(pack->key.c_str(), pack->key.size());
+            Aws::String uploadId = adapter_->MultiUploadInit(aws_key);
+            if (uploadId == "") {
+                LOG(ERROR) << "Init multiupload of pack failed, key = "
+                           << pack->key;
+                failed_ = true;
+                return -1;
+            }
+            pack->uploadId = std::string(uploadId.c_str(), uploadId.size());
+            current_ = pack;
+        }
+        std::shared_ptr<Pack> pack = current_;
+        pack->chunks.emplace_back(name,
+            ChunkPackLocation(pack->key, pack->size, data.size(), 0));
+        pack->buffer.append(data);
+        pack->size += data.size();
+        if (pack->size >= packSize_) {
+            current_ = nullptr;
+            if (ClosePack(pack, &parts)) {
+                completePack = pack;
+            }
+        } else if (pack->buffer.size() >= partSize_) {
+            parts.push_back(CutPart(pack));
+        }
+    }
+
+    // 分片在锁外上传，多个chunk转储线程的分片可以同时上传
+    int ret = 0;
+    for (auto &part : parts) {
+        if (UploadPart(&part) < 0) {
+            ret = -1;
+        }
+    }
+    if (completePack != nullptr) {
+        CompletePack(completePack);
+    }
+    return ret;
+}
+
+S3ChunkPackWriter::PackPart S3ChunkPackWriter::CutPart(
+    const std::shared_ptr<Pack> &pack) {
+    PackPart part;
+    part.pack = pack;
+    part.partNum = pack->nextPartNum++;
+    part.data.swap(pack->buffer);
+    pack->inflight++;
+    return part;
+}
+
+bool S3ChunkPackWriter::ClosePack(const std::shared_ptr<Pack> &pack,
+                                  std::vector<PackPart> *parts) {
+    pack->closed = true;
+    pendingPacks_++;
+    if (!pack->buffer.empty()) {
+        parts->push_back(CutPart(pack));
+    }
+    return pack->inflight == 0;
+}
+
+int S3ChunkPackWriter::UploadPart(PackPart *part) {
+    std::shared_ptr<Pack> pack = part->pack;
+    const Aws::String aws_key(pack->key.c_str(), pack->key.size());
+    const Aws::String uploadId(pack->uploadId.c_str(), pack->uploadId.size());
+    Aws::S3::Model::CompletedPart cp = adapter_->UploadOnePart(aws_key,
+        uploadId, part->partNum, part->data.size(), part->data.data());
+    std::string etag(cp.GetETag().c_str(), cp.GetETag().size());
+    bool success = !(etag == "errorTag" && cp.GetPartNumber() == -1);
+    part->data.clear();
+
+    bool complete = false;
+    {
+        LockGuard guard(mtx_);
+        if (success) {
+            pack->etags.emplace(cp.GetPartNumber(), etag);
+        } else {
+            LOG(ERROR) << "Failed to upload part " << part->partNum
+                       << " of pack " << pack->key;
+            pack->failed = true;
+            failed_ = true;
+        }
+        pack->inflight--;
+        complete = pack->closed && pack->inflight == 0;
+    }
+    if (complete) {
+        CompletePack(pack);
+    }
+    return success ? 0 : -1;
+}
+
+void S3ChunkPackWriter::CompletePack(const std::shared_ptr<Pack> &pack) {
+    // pack已关闭且没有正在上传的分片，此时只有当前线程访问pack
+    const Aws::String aws_key(pack->key.c_str(), pack->key.size());
+    const Aws::String uploadId(pack->uploadId.c_str(), pack->uploadId.size());
+    bool success = false;
+    if (!pack->failed) {
+        Aws::Vector<Aws::S3::Model::CompletedPart> cp_v;
+        for (auto &v : pack->etags) {
+            Aws::String str(v.second.c_str(), v.second.size());
+            cp_v.push_back(Aws::S3::Model::CompletedPart()
+                           .WithETag(str)
+                           .WithPartNumber(v.first));
+        }
+        success = adapter_->CompleteMultiUpload(aws_key, uploadId, cp_v) == 0;
+        if (!success) {
+            LOG(ERROR) << "Failed to complete pack " << pack->key;
+        }
+    }
+    if (!success) {
+        adapter_->AbortMultiUpload(aws_key, uploadId);
+    }
+
+    LockGuard guard(mtx_);
+    if (success) {
+        for (auto &chunk : pack->chunks) {
+            chunk.second.packSize = pack->size;
+            sealed_.push_back(chunk);
+        }
+    } else {
+        failed_ = true;
+    }
+    pendingPacks_--;
+    cond_.notify_all();
+}
+
+int S3ChunkPackWriter::Flush() {
+    std::vector<PackPart> parts;
+    std::shared_ptr<Pack> completePack;
+    {
+        LockGuard guard(mtx_);
+        if (current_ != nullptr) {
+            if (ClosePack(current_, &parts)) {
+                completePack = current_;
+            }
+            current_ = nullptr;
+        }
+    }
+    for (auto &part : parts) {
+        UploadPart(&part);
+    }
+    if (completePack != nullptr) {
+        CompletePack(completePack);
+    }
+
+    UniqueLock lock(mtx_);
+    cond_.wait(lock, [this] { return pendingPacks_ == 0; });
+    return failed_ ? -1 : 0;
+}
+
+void S3ChunkPackWriter::Abort() {
+    std::shared_ptr<Pack> pack;
+    {
+        UniqueLock lock(mtx_);
+        pack = current_;
+        current_ = nullptr;
+        if (pack != nullptr) {
+            failed_ = true;
+        }
+        cond_.wait(lock, [this] { return pendingPacks_ == 0; });
+    }
+    if (pack != nullptr) {
+        const Aws::String aws_key(pack->key.c_str(), pack->key.size());
+        const Aws::String uploadId(pack->uploadId.c_str(),
+                                   pack->uploadId.size());
+        adapter_->AbortMultiUpload(aws_key, uploadId);
+    }
+}
+
+std::vector<std::pair<ChunkDataName, ChunkPackLocation>>
+    S3ChunkPackWriter::TakeSealedLocations() {
+    LockGuard guard(mtx_);
+    std::vector<std::pair<ChunkDataName, ChunkPackLocation>> sealed;
+    sealed.swap(sealed_);
+    return sealed;
+}
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
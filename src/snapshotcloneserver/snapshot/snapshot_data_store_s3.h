@@ -28,18 +28,131 @@
 #include <list>
 #include <string>
 #include <memory>
+#include <utility>
 #include "src/snapshotcloneserver/snapshot/snapshot_data_store.h"
+#include "src/snapshotcloneserver/common/snapshotclone_meta_store.h"
+#include "src/snapshotcloneserver/common/snapshotclone_metric.h"
 #include "src/common/s3_adapter.h"
+#include "src/common/concurrent/name_lock.h"
 
 using ::curve::common::S3Adapter;
+using ::curve::common::NameLock;
 namespace curve {
 namespace snapshotcloneserver {
 
+struct ChunkObjectOption {
+    // 是否以稀疏格式存储chunk对象，全0的分片不写入对象
+    bool sparse = false;
+    // chunk对象分片的压缩算法
+    CompressType compressType = CompressType::None;
+    // 压缩级别，只对zlib有效
+    int compressLevel = 1;
+    // 是否按内容对分片去重，分片数据以sha256命名单独存储并在metastore中
+    // 记录引用计数，chunk对象中只保存layout
+    bool dedup = false;
+    // 打包存储时pack对象的大小，多个chunk的数据写入同一个pack对象，
+    // 0表示不打包，每个chunk单独存储为一个对象
+    uint64_t packSize = 0;
+    // 写入pack对象的每个分片的大小，不能小于对象存储分片上传的下限
+    uint64_t packPartSize = 16 * 1024 * 1024;
+};
+
+/**
+ * 把chunk数据打包写入s3上的pack对象
+ * 追加的数据先缓存在内存中，满一个分片后上传，pack写满packSize后完成分片上传
+ */
+class S3ChunkPackWriter : public ChunkPackWriter {
+ public:
+    S3ChunkPackWriter(std::shared_ptr<S3Adapter> adapter,
+                      const std::string &prefix,
+                      uint64_t packSize,
+                      uint64_t partSize)
+        : adapter_(adapter),
+          prefix_(prefix),
+          packSize_(packSize),
+          partSize_(partSize),
+          pendingPacks_(0),
+          failed_(false) {}
+    ~S3ChunkPackWriter() {
+        Abort();
+    }
+
+    int Append(const ChunkDataName &name, const std::string &data) override;
+    int Flush() override;
+    void Abort() override;
+    std::vector<std::pair<ChunkDataName, ChunkPackLocation>>
+        TakeSealedLocations() override;
+
+ private:
+    struct Pack {
+        Pack() : size(0), nextPartNum(1), inflight(0),
+                 closed(false), failed(false) {}
+        std::string key;
+        std::string uploadId;
+        // 已追加的数据长度
+        uint64_t size;
+        // 尚未上传的数据
+        std::string buffer;
+        int nextPartNum;
+        // 正在上传的分片数
+        int inflight;
+        // 不再追加数据，所有分片上传完成后即可完成分片上传
+        bool closed;
+        bool failed;
+        // partnumber <=> etag
+        std::map<int, std::string> etags;
+        // pack中的chunk和其数据的位置
+        std::vector<std::pair<ChunkDataName, ChunkPackLocation>> chunks;
+    };
+
+    struct PackPart {
+        std::shared_ptr<Pack> pack;
+        int partNum;
+        std::string data;
+    };
+
+    // 以下两个函数需要持有锁调用
+    // 把pack缓冲区中的数据取出作为一个待上传的分片
+    PackPart CutPart(const std::shared_ptr<Pack> &pack);
+    /**
+     * 关闭pack，剩余数据作为最后一个分片
+     * @param[out] parts 需要上传的分片
+     * @return 没有需要上传和正在上传的分片时返回true，由调用者完成pack
+     */
+    bool ClosePack(const std::shared_ptr<Pack> &pack,
+                   std::vector<PackPart> *parts);
+
+    int UploadPart(PackPart *part);
+    void CompletePack(const std::shared_ptr<Pack> &pack);
+
+ private:
+    std::shared_ptr<S3Adapter> adapter_;
+    std::string prefix_;
+    uint64_t packSize_;
+    uint64_t partSize_;
+    curve::common::Mutex mtx_;
+    curve::common::ConditionVariable cond_;
+    // 正在追加数据的pack
+    std::shared_ptr<Pack> current_;
+    // 已关闭但还未完成上传的pack数量
+    int pendingPacks_;
+    // 有pack上传失败
+    bool failed_;
+    // 已完成上传且未被取走的chunk位置
+    std::vector<std::pair<ChunkDataName, ChunkPackLocation>> sealed_;
+};
+
 class S3SnapshotDataStore : public SnapshotDataStore {
  public:
-     S3SnapshotDataStore() {
+     explicit S3SnapshotDataStore(
+         const ChunkObjectOption &option = ChunkObjectOption())
+         : option_(option),
+           dedupEverEnabled_(true) {
         s3Adapter4Meta_ = std::make_shared<S3Adapter>();
         s3Adapter4Data_ = std::make_shared<S3Adapter>();
+        if (option_.dedup) {
+            dedupMetric_ = std::make_shared<ChunkDedupMetric>();
+        }
     }
     ~S3SnapshotDataStore() {}
     int Init(const std::string &path) override;
@@ -49,6 +162,10 @@ class S3SnapshotDataStore : public SnapshotDataStore {
                           ChunkIndexData *meta) override;
     int DeleteChunkIndexData(const ChunkIndexDataName &name) override;
     bool ChunkIndexDataExist(const ChunkIndexDataName &name) override;
+    int PutHotChunkIndex(const ChunkIndexDataName &name,
+        const std::vector<ChunkIndexType> &indexes) override;
+    int GetHotChunkIndex(const ChunkIndexDataName &name,
+        std::vector<ChunkIndexType> *indexes) override;
     // int PutChunkData(const ChunkDataName &name,
     //                const ChunkData &data) override;
     // int GetChunkData(const ChunkDataName &name,
@@ -70,6 +187,11 @@ class S3SnapshotDataStore : public SnapshotDataStore {
                                 std::shared_ptr<TransferTask> task) override;
      int DataChunkTranferAbort(const ChunkDataName &name,
                                std::shared_ptr<TransferTask> task) override;
+     std::shared_ptr<ChunkPackWriter> NewChunkPackWriter(
+         const std::string &prefix) override;
+     int GetChunkPackData(const ChunkPackLocation &location,
+                          std::string *data) override;
+     int DeleteChunkPack(const std::string &packKey) override;
 
      void SetMetaAdapter(std::shared_ptr<S3Adapter> adapter) {
          s3Adapter4Meta_ = adapter;
@@ -83,10 +205,106 @@ class S3SnapshotDataStore : public SnapshotDataStore {
      std::shared_ptr<S3Adapter> GetDataAdapter(void) {
          return s3Adapter4Data_;
      }
+     // 去重存储时用于记录分片数据和引用
+     void SetMetaStore(std::shared_ptr<SnapshotCloneMetaStore> metaStore) {
+         metaStore_ = metaStore;
+     }
+
+ private:
+    bool IsPack() const {
+        return option_.packSize > 0 && !IsDedup();
+    }
+
+    /**
+     * 终止未完成的pack分片上传
+     * 只在成为leader后初始化时调用，此时没有正在写的pack，
+     * 未完成的都是上次退出时遗留的，不会再完成
+     */
+    void AbortChunkPackUploads();
+
+    /**
+     * 开启去重时在metastore中记录曾经开启过去重，否则读取该记录，
+     * 从未开启过去重时chunk对象都不会引用分片数据
+     * @return 0 成功/ -1 失败
+     */
+    int InitChunkDedupFlag();
+
+    // 是否需要在chunk对象末尾写入layout
+    bool NeedLayout() const {
+        return option_.sparse || option_.dedup ||
+               option_.compressType != CompressType::None;
+    }
+
+    bool IsDedup() const {
+        return option_.dedup && metaStore_ != nullptr;
+    }
+
+    /**
+     * 按配置压缩分片，压缩后变小时才使用压缩后的数据
+     * @param buf 分片数据
+     * @param partSize 分片大小
+     * @param[out] compressed 压缩后的数据
+     * @param[out] data 需要存储的数据
+     * @param[out] dataSize 需要存储的数据长度
+     * @param[out] type 需要存储的数据的压缩算法
+     * @return 0 成功/ -1 失败
+     */
+    int PreparePartData(const char *buf, int partSize,
+                        std::string *compressed, const char **data,
+                        int *dataSize, CompressType *type);
+
+    /**
+     * 按内容去重转储一个分片，已有相同内容的分片数据时不再写入，
+     * 引用在chunk转储完成时批量记录
+     * @return 0 成功/ -1 失败
+     */
+    int AddPartRef(std::shared_ptr<TransferTask> task, int partNum,
+                   int partSize, const char *buf);
+
+    /**
+     * 删除chunk对象对分片数据的引用，并删除不再被引用的分片数据
+     * @param chunkName chunk对象名
+     * @param parts 分片序号 <=> 分片原始数据的sha256
+     * @return 0 成功/ -1 失败
+     */
+    int ReleasePartRefs(const std::string &chunkName,
+                        const std::map<int, std::string> &parts);
+
+    /**
+     * 分片数据不再被引用且不在转储中时删除分片数据
+     * @param hash 分片原始数据的sha256
+     * @return 0 成功/ -1 失败
+     */
+    int ReleasePartData(const std::string &hash);
+
+    // 转储中的chunk引用的分片数据在记录引用前不能被删除
+    void PinPart(const std::string &hash);
+    void UnpinParts(const std::vector<std::string> &hashes);
+    bool IsPartPinned(const std::string &hash);
+
+    /**
+     * 读取chunk对象末尾的layout
+     * @param key chunk对象名
+     * @param[out] layout 对象的layout
+     * @param[out] isLayout 对象是否有layout
+     * @return 0 成功/ -1 失败
+     */
+    int GetChunkObjectLayout(const std::string &key,
+                             ChunkObjectLayout *layout, bool *isLayout);
 
  private:
     std::shared_ptr<curve::common::S3Adapter> s3Adapter4Data_;
     std::shared_ptr<curve::common::S3Adapter> s3Adapter4Meta_;
+    ChunkObjectOption option_;
+    std::shared_ptr<SnapshotCloneMetaStore> metaStore_;
+    // 是否曾经开启过去重，Init前不确定，按开启过处理
+    bool dedupEverEnabled_;
+    // 分片数据的写入和删除按hash加锁
+    NameLock partRefLock_;
+    // 转储中的chunk引用的分片数据 <=> 引用次数
+    std::map<std::string, int> pinnedParts_;
+    curve::common::Mutex pinnedPartsLock_;
+    std::shared_ptr<ChunkDedupMetric> dedupMetric_;
 };
 
 }   // namespace snapshotcloneserver
@@ -45,17 +45,83 @@ void ReadChunkSnapshotClosure::Run() {
     return;
 }
 
+void TransferSnapshotDataChunkContext::SetError(int retCode) {
+    int expected = kErrCodeSuccess;
+    retCode_.compare_exchange_strong(expected, retCode,
+        std::memory_order_acq_rel);
+}
+
+void TransferSnapshotDataChunkContext::Release() {
+    if (refCount_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        Finish();
+    }
+}
+
+void TransferSnapshotDataChunkContext::Finish() {
+    // 读取阶段和所有分片上传都已结束，此时只有当前线程访问transferTask
+    int ret = GetRetCode();
+    if (ret >= 0) {
+        ret = dataStore_->DataChunkTranferComplete(name_, transferTask_);
+        if (ret < 0) {
+            LOG(ERROR) << "DataChunkTranferComplete fail"
+                       << ", ret = " << ret
+                       << ", chunkDataName = " << name_.ToDataChunkKey()
+                       << ", logicalPool = " << cidInfo_.lpid_
+                       << ", copysetId = " << cidInfo_.cpid_
+                       << ", chunkId = " << cidInfo_.cid_;
+        }
+    }
+    if (ret < 0) {
+        int ret2 = dataStore_->DataChunkTranferAbort(name_, transferTask_);
+        if (ret2 < 0) {
+            LOG(ERROR) << "DataChunkTranferAbort fail"
+                       << ", ret = " << ret2
+                       << ", chunkDataName = " << name_.ToDataChunkKey()
+                       << ", logicalPool = " << cidInfo_.lpid_
+                       << ", copysetId = " << cidInfo_.cpid_
+                       << ", chunkId = " << cidInfo_.cid_;
+        }
+    }
+    tracker_->HandleResponse(ret);
+}
+
+void UploadSnapshotDataPartTask::Run() {
+    std::unique_ptr<UploadSnapshotDataPartTask> self_guard(this);
+    // chunk已经转储失败时不再上传，只归还buffer
+    if (chunkContext_->GetRetCode() >= 0) {
+        int ret = chunkContext_->GetDataStore()->DataChunkTranferAddPart(
+            chunkContext_->GetName(),
+            chunkContext_->GetTransferTask(),
+            partContext_->partIndex,
+            partContext_->len,
+            partContext_->buf->Data());
+        if (ret < 0) {
+            LOG(ERROR) << "DataChunkTranferAddPart fail"
+                       << ", ret = " << ret
+                       << ", chunkDataName = "
+                       << chunkContext_->GetName().ToDataChunkKey()
+                       << ", index = " << partContext_->partIndex;
+            chunkContext_->SetError(ret);
+        }
+    }
+    partContext_->buf.reset();
+    chunkContext_->Release();
+}
+
 /**
  * @brief 转储快照的单个chunk
  * @detail
  *  由于单个chunk过大，chunk转储分片进行，分片大小为chunkSplitSize_，
- *  步骤如下：
+ *  分片的读取和上传分别在两个线程池中流水线进行，步骤如下：
  *  1. 创建一个转储任务transferTask，并调用DataChunkTranferInit初始化
- *  2. 调用ReadChunkSnapshot从curvefs读取chunk的一个分片
- *  3. 调用DataChunkTranferAddPart转储一个分片
- *  4. 重复2、3直到所有分片转储完成，调用DataChunkTranferComplete结束转储任务
+ *  2. 从buffer池申请分片buffer，调用ReadChunkSnapshot从curvefs读取
+ *  chunk的一个分片
+ *  3. 读取成功的分片提交到上传线程池，调用DataChunkTranferAddPart转储，
+ *  转储完成后归还buffer
+ *  4. 重复2、3直到所有分片读取完成，读取线程即可处理下一个chunk，
+ *  最后完成的一个分片上传调用DataChunkTranferComplete结束转储任务
  *  5. 中间如有读取或转储发生错误，则调用DataChunkTranferAbort放弃转储，
- *  并返回错误码
+ *  并通过tracker返回错误码
  *
  * @return 错误码
  */
@@ -67,6 +133,7 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
 
     std::shared_ptr<TransferTask> transferTask =
         std::make_shared<TransferTask>();
+    transferTask->packWriter_ = taskInfo_->packWriter_;
     int ret = dataStore_->DataChunkTranferInit(name,
             transferTask);
     if (ret < 0) {
@@ -76,18 +143,29 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
                    << ", logicalPool = " << cidInfo.lpid_
                    << ", copysetId = " << cidInfo.cpid_
                    << ", chunkId = " << cidInfo.cid_;
+        GetTracker()->HandleResponse(ret);
         return ret;
     }
 
+    auto chunkContext = std::make_shared<TransferSnapshotDataChunkContext>(
+        name, cidInfo, transferTask, dataStore_, GetTracker());
     auto tracker = std::make_shared<ReadChunkSnapshotTaskTracker>();
     for (uint64_t i = 0;
         i < chunkSize / chunkSplitSize;
         i++) {
+        // 已有分片上传失败，不再继续读取
+        ret = chunkContext->GetRetCode();
+        if (ret < 0) {
+            break;
+        }
         auto context = std::make_shared<ReadChunkSnapshotContext>();
+        ret = AcquireBuffer(tracker, chunkContext, &context->buf);
+        if (ret < 0) {
+            break;
+        }
         context->cidInfo = taskInfo_->cidInfo_;
         context->seqNum = taskInfo_->name_.chunkSeqNum_;
         context->partIndex = i;
-        context->buf = std::unique_ptr<char[]>(new char[chunkSplitSize]);
         context->len = chunkSplitSize;
         context->startTime = TimeUtility::GetTimeofDaySec();
         context->clientAsyncMethodRetryTimeSec =
@@ -102,7 +180,7 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
         std::list<ReadChunkSnapshotContextPtr> results =
             tracker->PopResultContexts();
         ret = HandleReadChunkSnapshotResultsAndRetry(
-            tracker, transferTask, results);
+            tracker, chunkContext, results);
         if (ret < 0) {
             break;
         }
@@ -117,38 +195,44 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
                 break;
             }
             ret = HandleReadChunkSnapshotResultsAndRetry(
-                tracker, transferTask, results);
+                tracker, chunkContext, results);
             if (ret < 0) {
                 break;
             }
         } while (true);
-        if (ret >= 0) {
-            ret =
-                dataStore_->DataChunkTranferComplete(name, transferTask);
-            if (ret < 0) {
-                LOG(ERROR) << "DataChunkTranferComplete fail"
-                           << ", ret = " << ret
-                           << ", chunkDataName = " << name.ToDataChunkKey()
-                           << ", logicalPool = " << cidInfo.lpid_
-                           << ", copysetId = " << cidInfo.cpid_
-                           << ", chunkId = " << cidInfo.cid_;
-            }
-        }
     }
     if (ret < 0) {
-            int ret2 =
-                dataStore_->DataChunkTranferAbort(
-                name,
-                transferTask);
-            if (ret2 < 0) {
-                LOG(ERROR) << "DataChunkTranferAbort fail"
-                           << ", ret = " << ret2
-                           << ", chunkDataName = " << name.ToDataChunkKey()
-                           << ", logicalPool = " << cidInfo.lpid_
-                           << ", copysetId = " << cidInfo.cpid_
-                           << ", chunkId = " << cidInfo.cid_;
-            }
-        return ret;
+        chunkContext->SetError(ret);
+    }
+    // 读取阶段结束，分片上传全部完成后结束chunk的转储
+    chunkContext->Release();
+    return ret;
+}
+
+int TransferSnapshotDataChunkTask::AcquireBuffer(
+    std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
+    std::shared_ptr<TransferSnapshotDataChunkContext> chunkContext,
+    std::unique_ptr<TransferBuffer> *buf) {
+    *buf = bufferPool_->TryAcquire();
+    while (*buf == nullptr) {
+        // 先判断是否还有进行中的读取再取结果，保证取到全部已完成的读取
+        bool idle = tracker->GetTaskNum() == 0;
+        if (!idle) {
+            tracker->WaitSome(1);
+        }
+        std::list<ReadChunkSnapshotContextPtr> results =
+            tracker->PopResultContexts();
+        if (idle && results.empty()) {
+            // 本chunk的buffer都已交给上传阶段，等待上传完成归还buffer
+            *buf = bufferPool_->Acquire();
+            break;
+        }
+        int ret = HandleReadChunkSnapshotResultsAndRetry(
+            tracker, chunkContext, results);
+        if (ret < 0) {
+            return ret;
+        }
+        *buf = bufferPool_->TryAcquire();
     }
     return kErrCodeSuccess;
 }
@@ -171,7 +255,7 @@ int TransferSnapshotDataChunkTask::StartAsyncReadChunkSnapshot(
         context->seqNum,
         offset,
         context->len,
-        context->buf.get(),
+        context->buf->Data(),
         cb);
     if (ret < 0) {
         LOG(ERROR) << "ReadChunkSnapshot error, "
@@ -188,7 +272,7 @@ int TransferSnapshotDataChunkTask::StartAsyncReadChunkSnapshot(
 
 int TransferSnapshotDataChunkTask::HandleReadChunkSnapshotResultsAndRetry(
     std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
-    std::shared_ptr<TransferTask> transferTask,
+    std::shared_ptr<TransferSnapshotDataChunkContext> chunkContext,
     const std::list<ReadChunkSnapshotContextPtr> &results) {
     int ret = kErrCodeSuccess;
     for (auto context : results) {
@@ -211,20 +295,9 @@ int TransferSnapshotDataChunkTask::HandleReadChunkSnapshotResultsAndRetry(
                 return ret;
             }
         } else {
-            ret = dataStore_->DataChunkTranferAddPart(
-                taskInfo_->name_,
-                transferTask,
-                context->partIndex,
-                context->len,
-                context->buf.get());
-            if (ret < 0) {
-                LOG(ERROR) << "DataChunkTranferAddPart fail"
-                           << ", ret = " << ret
-                           << ", chunkDataName = "
-                           << taskInfo_->name_.ToDataChunkKey()
-                           << ", index = " << context->partIndex;
-                return ret;
-            }
+            chunkContext->AddRef();
+            uploadPool_->PushTask(new UploadSnapshotDataPartTask(
+                GetTaskId(), chunkContext, context));
         }
     }
     return ret;
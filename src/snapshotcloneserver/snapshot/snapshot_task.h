@@ -26,6 +26,7 @@
 #include <string>
 #include <memory>
 #include <list>
+#include <atomic>
 
 #include "src/snapshotcloneserver/snapshot/snapshot_core.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
@@ -33,6 +34,8 @@
 #include "src/snapshotcloneserver/common/task_info.h"
 #include "src/snapshotcloneserver/common/snapshotclone_metric.h"
 #include "src/snapshotcloneserver/common/task_tracker.h"
+#include "src/snapshotcloneserver/common/thread_pool.h"
+#include "src/snapshotcloneserver/snapshot/transfer_buffer_pool.h"
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -180,8 +183,8 @@ struct ReadChunkSnapshotContext {
     uint64_t seqNum;
     // 分片的索引
     uint64_t partIndex;
-    // 分片的buffer
-    std::unique_ptr<char[]> buf;
+    // 分片的buffer，从TransferBufferPool申请，上传完成后归还
+    std::unique_ptr<TransferBuffer> buf;
     // 分片长度
     uint64_t len;
     // 返回值
@@ -215,6 +218,8 @@ struct TransferSnapshotDataChunkTaskInfo : public TaskInfo {
     uint64_t clientAsyncMethodRetryTimeSec_;
     uint64_t clientAsyncMethodRetryIntervalMs_;
     uint32_t readChunkSnapshotConcurrency_;
+    // 打包存储时chunk数据写入的pack，为空时chunk单独存储为一个对象
+    std::shared_ptr<ChunkPackWriter> packWriter_;
 
     TransferSnapshotDataChunkTaskInfo(const ChunkDataName &name,
         uint64_t chunkSize,
@@ -232,16 +237,106 @@ struct TransferSnapshotDataChunkTaskInfo : public TaskInfo {
           readChunkSnapshotConcurrency_(readChunkSnapshotConcurrency) {}
 };
 
+/**
+ * @brief 转储单个chunk时读取阶段和上传阶段共享的上下文
+ * @detail
+ *  读取阶段和每个分片的上传各持有一个计数，最后一个释放计数的线程
+ *  结束chunk的转储并通知tracker，读取线程因此不需要等待上传完成。
+ */
+class TransferSnapshotDataChunkContext {
+ public:
+    TransferSnapshotDataChunkContext(const ChunkDataName &name,
+        const ChunkIDInfo &cidInfo,
+        std::shared_ptr<TransferTask> transferTask,
+        std::shared_ptr<SnapshotDataStore> dataStore,
+        std::shared_ptr<TaskTracker> tracker)
+        : name_(name),
+          cidInfo_(cidInfo),
+          transferTask_(transferTask),
+          dataStore_(dataStore),
+          tracker_(tracker),
+          refCount_(1),
+          retCode_(kErrCodeSuccess) {}
+
+    const ChunkDataName &GetName() const {
+        return name_;
+    }
+
+    std::shared_ptr<TransferTask> GetTransferTask() const {
+        return transferTask_;
+    }
+
+    std::shared_ptr<SnapshotDataStore> GetDataStore() const {
+        return dataStore_;
+    }
+
+    /**
+     * @brief 增加一个计数，在提交分片上传之前调用
+     */
+    void AddRef() {
+        refCount_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    /**
+     * @brief 释放一个计数，计数为0时完成或放弃chunk的转储
+     */
+    void Release();
+
+    /**
+     * @brief 记录错误，只保留第一个错误码
+     */
+    void SetError(int retCode);
+
+    int GetRetCode() const {
+        return retCode_.load(std::memory_order_acquire);
+    }
+
+ private:
+    void Finish();
+
+ private:
+    ChunkDataName name_;
+    ChunkIDInfo cidInfo_;
+    std::shared_ptr<TransferTask> transferTask_;
+    std::shared_ptr<SnapshotDataStore> dataStore_;
+    std::shared_ptr<TaskTracker> tracker_;
+    std::atomic<uint32_t> refCount_;
+    std::atomic<int> retCode_;
+};
+
+/**
+ * @brief 上传chunk的一个分片，在上传线程池中执行
+ */
+class UploadSnapshotDataPartTask : public Task {
+ public:
+    UploadSnapshotDataPartTask(const TaskIdType &taskId,
+        std::shared_ptr<TransferSnapshotDataChunkContext> chunkContext,
+        ReadChunkSnapshotContextPtr partContext)
+        : Task(taskId),
+          chunkContext_(chunkContext),
+          partContext_(partContext) {}
+
+    void Run() override;
+
+ private:
+    std::shared_ptr<TransferSnapshotDataChunkContext> chunkContext_;
+    ReadChunkSnapshotContextPtr partContext_;
+};
+
 class TransferSnapshotDataChunkTask : public TrackerTask {
  public:
     TransferSnapshotDataChunkTask(const TaskIdType &taskId,
         std::shared_ptr<TransferSnapshotDataChunkTaskInfo> taskInfo,
         std::shared_ptr<CurveFsClient> client,
-        std::shared_ptr<SnapshotDataStore> dataStore)
+        std::shared_ptr<SnapshotDataStore> dataStore,
+        std::shared_ptr<ThreadPool> uploadPool,
+        std::shared_ptr<TransferBufferPool> bufferPool)
         : TrackerTask(taskId),
           taskInfo_(taskInfo),
           client_(client),
-          dataStore_(dataStore) {}
+          dataStore_(dataStore),
+          uploadPool_(uploadPool),
+          bufferPool_(bufferPool) {}
 
     std::shared_ptr<TransferSnapshotDataChunkTaskInfo> GetTaskInfo() const {
         return taskInfo_;
@@ -249,18 +344,35 @@ class TransferSnapshotDataChunkTask : public TrackerTask {
 
     void Run() override {
         std::unique_ptr<TransferSnapshotDataChunkTask> self_guard(this);
-        int ret = TransferSnapshotDataChunk();
-        GetTracker()->HandleResponse(ret);
+        // chunk转储结束时由TransferSnapshotDataChunkContext通知tracker
+        TransferSnapshotDataChunk();
     }
 
  private:
     /**
-     * @brief 转储快照单个chunk
+     * @brief 读取快照单个chunk，读到的分片提交到上传线程池
      *
      * @return 错误码
      */
     int TransferSnapshotDataChunk();
 
+    /**
+     * @brief 申请分片buffer
+     * @detail
+     *  buffer用完时先处理本chunk已完成的读取，把buffer交给上传阶段，
+     *  本chunk没有进行中的读取时才阻塞等待，避免各chunk互相等待。
+     *
+     * @param tracker 异步ReadSnapshotChunk追踪器
+     * @param chunkContext chunk转储上下文
+     * @param[out] buf 分片buffer
+     *
+     * @return 错误码
+     */
+    int AcquireBuffer(
+        std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
+        std::shared_ptr<TransferSnapshotDataChunkContext> chunkContext,
+        std::unique_ptr<TransferBuffer> *buf);
+
     /**
      * @brief 开始异步ReadSnapshotChunk
      *
@@ -274,23 +386,27 @@ class TransferSnapshotDataChunkTask : public TrackerTask {
         std::shared_ptr<ReadChunkSnapshotContext> context);
 
     /**
-     * @brief 处理ReadChunkSnapshot的结果并重试
+     * @brief 处理ReadChunkSnapshot的结果并重试，读取成功的分片提交上传
      *
      * @param tracker 异步ReadSnapshotChunk追踪器
-     * @param transferTask 转储任务
+     * @param chunkContext chunk转储上下文
      * @param results ReadChunkSnapshot结果列表
      *
      * @return 错误码
      */
     int HandleReadChunkSnapshotResultsAndRetry(
         std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
-        std::shared_ptr<TransferTask> transferTask,
+        std::shared_ptr<TransferSnapshotDataChunkContext> chunkContext,
         const std::list<ReadChunkSnapshotContextPtr> &results);
 
  protected:
     std::shared_ptr<TransferSnapshotDataChunkTaskInfo> taskInfo_;
     std::shared_ptr<CurveFsClient> client_;
     std::shared_ptr<SnapshotDataStore> dataStore_;
+    // 分片上传线程池
+    std::shared_ptr<ThreadPool> uploadPool_;
+    // 分片buffer池
+    std::shared_ptr<TransferBufferPool> bufferPool_;
 };
 
 
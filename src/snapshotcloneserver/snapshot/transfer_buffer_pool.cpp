@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include "src/snapshotcloneserver/snapshot/transfer_buffer_pool.h"
+
+#include <algorithm>
+
+using ::curve::common::LockGuard;
+using ::curve::common::UniqueLock;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+TransferBuffer::~TransferBuffer() {
+    pool_->Release(data_);
+}
+
+TransferBufferPool::TransferBufferPool(uint64_t bufferSize,
+    uint64_t capacity)
+    : bufferSize_(bufferSize),
+      maxBufferNum_(bufferSize == 0 ? 1 :
+          std::min<uint64_t>(UINT32_MAX,
+              std::max<uint64_t>(1, capacity / bufferSize))),
+      inUseNum_(0) {}
+
+TransferBufferPool::~TransferBufferPool() {
+    for (auto data : freeBuffers_) {
+        delete[] data;
+    }
+}
+
+std::unique_ptr<TransferBuffer> TransferBufferPool::Acquire() {
+    char *data = nullptr;
+    {
+        UniqueLock lock(mtx_);
+        cond_.wait(lock, [this] { return inUseNum_ < maxBufferNum_; });
+        data = AllocLocked();
+    }
+    return std::unique_ptr<TransferBuffer>(
+        new TransferBuffer(shared_from_this(), data));
+}
+
+std::unique_ptr<TransferBuffer> TransferBufferPool::TryAcquire() {
+    char *data = nullptr;
+    {
+        LockGuard guard(mtx_);
+        if (inUseNum_ >= maxBufferNum_) {
+            return nullptr;
+        }
+        data = AllocLocked();
+    }
+    return std::unique_ptr<TransferBuffer>(
+        new TransferBuffer(shared_from_this(), data));
+}
+
+uint32_t TransferBufferPool::GetInUseNum() {
+    LockGuard guard(mtx_);
+    return inUseNum_;
+}
+
+char *TransferBufferPool::AllocLocked() {
+    inUseNum_++;
+    if (!freeBuffers_.empty()) {
+        char *data = freeBuffers_.back();
+        freeBuffers_.pop_back();
+        return data;
+    }
+    return new char[bufferSize_];
+}
+
+void TransferBufferPool::Release(char *data) {
+    LockGuard guard(mtx_);
+    inUseNum_--;
+    freeBuffers_.push_back(data);
+    cond_.notify_one();
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
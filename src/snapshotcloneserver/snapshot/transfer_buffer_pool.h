@@ -0,0 +1,133 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#ifndef SRC_SNAPSHOTCLONESERVER_SNAPSHOT_TRANSFER_BUFFER_POOL_H_
+#define SRC_SNAPSHOTCLONESERVER_SNAPSHOT_TRANSFER_BUFFER_POOL_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/common/concurrent/concurrent.h"
+
+using ::curve::common::Mutex;
+using ::curve::common::ConditionVariable;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+class TransferBufferPool;
+
+/**
+ * @brief 从TransferBufferPool申请的分片buffer，析构时归还
+ */
+class TransferBuffer {
+ public:
+    TransferBuffer(std::shared_ptr<TransferBufferPool> pool, char *data)
+        : pool_(pool),
+          data_(data) {}
+
+    ~TransferBuffer();
+
+    TransferBuffer(const TransferBuffer&) = delete;
+    TransferBuffer& operator=(const TransferBuffer&) = delete;
+
+    char *Data() const {
+        return data_;
+    }
+
+ private:
+    std::shared_ptr<TransferBufferPool> pool_;
+    char *data_;
+};
+
+/**
+ * @brief 快照转储的分片buffer池
+ * @detail
+ *  所有快照转储任务共用，限制从chunkserver读取后尚未上传完成的
+ *  数据总量。buffer用完时读取阶段阻塞等待上传阶段归还buffer，
+ *  由此在读取和上传之间形成反压。归还的buffer缓存起来复用。
+ */
+class TransferBufferPool :
+    public std::enable_shared_from_this<TransferBufferPool> {
+ public:
+    /**
+     * @brief 构造函数
+     *
+     * @param bufferSize 单个buffer大小，即转储分片大小
+     * @param capacity buffer总大小上限，至少可以申请1个buffer
+     */
+    TransferBufferPool(uint64_t bufferSize, uint64_t capacity);
+
+    ~TransferBufferPool();
+
+    /**
+     * @brief 申请一个buffer，已申请的buffer达到上限时阻塞
+     *
+     * @return buffer
+     */
+    std::unique_ptr<TransferBuffer> Acquire();
+
+    /**
+     * @brief 尝试申请一个buffer，不阻塞
+     *
+     * @return buffer，已申请的buffer达到上限时返回nullptr
+     */
+    std::unique_ptr<TransferBuffer> TryAcquire();
+
+    uint64_t GetBufferSize() const {
+        return bufferSize_;
+    }
+
+    uint32_t GetMaxBufferNum() const {
+        return maxBufferNum_;
+    }
+
+    /**
+     * @brief 获取已申请尚未归还的buffer数量
+     */
+    uint32_t GetInUseNum();
+
+ private:
+    friend class TransferBuffer;
+
+    // 调用者需持有mtx_
+    char *AllocLocked();
+
+    void Release(char *data);
+
+ private:
+    uint64_t bufferSize_;
+    uint32_t maxBufferNum_;
+    // 已申请尚未归还的buffer数量
+    uint32_t inUseNum_;
+    // 已归还可以复用的buffer
+    std::vector<char *> freeBuffers_;
+    Mutex mtx_;
+    ConditionVariable cond_;
+};
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
+
+#endif  // SRC_SNAPSHOTCLONESERVER_SNAPSHOT_TRANSFER_BUFFER_POOL_H_
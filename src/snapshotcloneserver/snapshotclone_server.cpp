@@ -70,6 +70,34 @@ void InitSnapshotCloneServerOptions(std::shared_ptr<Configuration> conf,
                &serverOption->snapshotTaskManagerScanIntervalMs);
     conf->GetValueFatalIfFail("server.chunkSplitSize",
                                         &serverOption->chunkSplitSize);
+    if (!conf->GetBoolValue("server.sparseChunkObject",
+                            &serverOption->sparseChunkObject)) {
+        serverOption->sparseChunkObject = false;
+    }
+    if (!conf->GetStringValue("server.chunkObjectCompressType",
+                              &serverOption->chunkObjectCompressType)) {
+        serverOption->chunkObjectCompressType = "none";
+    }
+    if (!conf->GetIntValue("server.chunkObjectCompressLevel",
+                           &serverOption->chunkObjectCompressLevel)) {
+        serverOption->chunkObjectCompressLevel = 1;
+    }
+    if (!conf->GetBoolValue("server.chunkDedup",
+                            &serverOption->chunkDedup)) {
+        serverOption->chunkDedup = false;
+    }
+    if (!conf->GetUInt64Value("server.chunkPackSize",
+                              &serverOption->chunkPackSize)) {
+        serverOption->chunkPackSize = 0;
+    }
+    if (!conf->GetUInt64Value("server.chunkPackPartSize",
+                              &serverOption->chunkPackPartSize)) {
+        serverOption->chunkPackPartSize = 16 * 1024 * 1024;
+    }
+    if (!conf->GetDoubleValue("server.chunkPackGcRatio",
+                              &serverOption->chunkPackGcRatio)) {
+        serverOption->chunkPackGcRatio = 0.5;
+    }
     conf->GetValueFatalIfFail(
                "server.checkSnapshotStatusIntervalMs",
                &serverOption->checkSnapshotStatusIntervalMs);
@@ -77,6 +105,14 @@ void InitSnapshotCloneServerOptions(std::shared_ptr<Configuration> conf,
                                         &serverOption->maxSnapshotLimit);
     conf->GetValueFatalIfFail("server.snapshotCoreThreadNum",
                                         &serverOption->snapshotCoreThreadNum);
+    if (!conf->GetUInt32Value("server.snapshotUploadThreadNum",
+                              &serverOption->snapshotUploadThreadNum)) {
+        serverOption->snapshotUploadThreadNum = 0;
+    }
+    if (!conf->GetUInt64Value("server.snapshotTransferMemoryLimit",
+                              &serverOption->snapshotTransferMemoryLimit)) {
+        serverOption->snapshotTransferMemoryLimit = 0;
+    }
     conf->GetValueFatalIfFail("server.mdsSessionTimeUs",
                                         &serverOption->mdsSessionTimeUs);
     conf->GetValueFatalIfFail("server.readChunkSnapshotConcurrency",
@@ -102,6 +138,14 @@ void InitSnapshotCloneServerOptions(std::shared_ptr<Configuration> conf,
                             &serverOption->createCloneChunkConcurrency);
     conf->GetValueFatalIfFail("server.recoverChunkConcurrency",
                             &serverOption->recoverChunkConcurrency);
+    if (!conf->GetUInt32Value("server.cloneChunkBatchSize",
+                              &serverOption->cloneChunkBatchSize)) {
+        serverOption->cloneChunkBatchSize = 1;
+    }
+    if (!conf->GetUInt32Value("server.hotChunkListMaxSize",
+                              &serverOption->hotChunkListMaxSize)) {
+        serverOption->hotChunkListMaxSize = 1024;
+    }
     conf->GetValueFatalIfFail("server.backEndReferenceRecordScanIntervalMs",
                         &serverOption->backEndReferenceRecordScanIntervalMs);
     conf->GetValueFatalIfFail("server.backEndReferenceFuncScanIntervalMs",
@@ -249,7 +293,43 @@ bool SnapShotCloneServer::Init() {
         return false;
     }
 
-    dataStore_ = std::make_shared<S3SnapshotDataStore>();
+    const SnapshotCloneServerOptions &serverOption =
+        snapshotCloneServerOptions_.serverOption;
+    ChunkObjectOption chunkObjectOption;
+    chunkObjectOption.sparse = serverOption.sparseChunkObject;
+    if (!curve::common::ParseCompressType(
+            serverOption.chunkObjectCompressType,
+            &chunkObjectOption.compressType)) {
+        LOG(ERROR) << "invalid chunk object compress type: "
+                   << serverOption.chunkObjectCompressType;
+        return false;
+    }
+    chunkObjectOption.compressLevel = serverOption.chunkObjectCompressLevel;
+    chunkObjectOption.dedup = serverOption.chunkDedup;
+    if (serverOption.chunkPackSize > 0) {
+        // 对象存储分片上传要求除最后一个分片外不小于5MB，且不超过10000个分片
+        const uint64_t kMinPartSize = 5 * 1024 * 1024;
+        const uint64_t kMaxPartNum = 10000;
+        if (serverOption.chunkDedup) {
+            LOG(ERROR) << "chunkPackSize and chunkDedup can not be "
+                       << "enabled at the same time";
+            return false;
+        }
+        if (serverOption.chunkPackPartSize < kMinPartSize ||
+            serverOption.chunkPackSize / serverOption.chunkPackPartSize >=
+                kMaxPartNum) {
+            LOG(ERROR) << "invalid chunk pack option, chunkPackSize = "
+                       << serverOption.chunkPackSize
+                       << ", chunkPackPartSize = "
+                       << serverOption.chunkPackPartSize;
+            return false;
+        }
+    }
+    chunkObjectOption.packSize = serverOption.chunkPackSize;
+    chunkObjectOption.packPartSize = serverOption.chunkPackPartSize;
+    auto s3DataStore = std::make_shared<S3SnapshotDataStore>(chunkObjectOption);
+    s3DataStore->SetMetaStore(metaStore_);
+    dataStore_ = s3DataStore;
     if (dataStore_->Init(snapshotCloneServerOptions_.s3ConfPath) < 0) {
         LOG(ERROR) << "dataStore init fail.";
         return false;
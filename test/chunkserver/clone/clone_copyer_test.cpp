@@ -195,9 +195,11 @@ TEST_F(CloneCopyerTest, BasicTest) {
 
 
         /* 用例:读s3上的数据，读取成功
-         * 预期:返回0
+         * 预期:对象不带layout，不探测对象末尾，返回0
          */
         context.location = "test@s3";
+        EXPECT_CALL(*s3Client_, GetObjectTail(_, _, _))
+            .Times(0);
         EXPECT_CALL(*s3Client_, GetObjectAsync(_))
             .WillOnce(Invoke(
                 [&] (const std::shared_ptr<GetObjectAsyncContext>& context) {
@@ -213,6 +215,8 @@ TEST_F(CloneCopyerTest, BasicTest) {
          * 预期:返回-1
          */
         context.location = "test@s3";
+        EXPECT_CALL(*s3Client_, GetObjectTail(_, _, _))
+            .Times(0);
         EXPECT_CALL(*s3Client_, GetObjectAsync(_))
             .WillOnce(Invoke(
                 [&] (const std::shared_ptr<GetObjectAsyncContext>& context) {
@@ -240,6 +244,411 @@ TEST_F(CloneCopyerTest, BasicTest) {
     }
 }
 
+TEST_F(CloneCopyerTest, SparseObjectTest) {
+    OriginCopyer copyer;
+    CopyerOptions options;
+    options.curveClient = nullptr;
+    options.s3Client = s3Client_;
+    options.s3Conf = S3_CONF;
+    options.s3ObjectLayout = true;
+    ASSERT_EQ(0, copyer.Init(options));
+
+    // 4个分片，只有第1和第2个分片存储在对象中
+    ChunkObjectLayout layout(1024, 4);
+    layout.SetPartPresent(1);
+    layout.SetPartPresent(2);
+    std::string footer;
+    layout.Encode(&footer);
+
+    char* buf = new char[4096];
+    AsyncDownloadContext context;
+    context.location = "sparse@s3";
+    context.offset = 0;
+    context.size = 4096;
+    context.buf = buf;
+    MockDownloadClosure closure(&context);
+
+    /* 用例:读取对象的layout失败
+     * 预期:返回失败，layout不被缓存
+     */
+    EXPECT_CALL(*s3Client_, GetObjectTail("sparse", _, _))
+        .WillOnce(Return(-1));
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .Times(0);
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+    closure.Reset();
+
+    /* 用例:读取整个chunk
+     * 预期:全0的分片直接填0，相邻的两个分片合并为一次读
+     */
+    memset(buf, 'x', 4096);
+    EXPECT_CALL(*s3Client_, GetObjectTail("sparse", _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(footer), Return(0)));
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .WillOnce(Invoke(
+            [&] (const std::shared_ptr<GetObjectAsyncContext>& ctx) {
+                ASSERT_EQ(0, ctx->offset);
+                ASSERT_EQ(2048, ctx->len);
+                ASSERT_EQ(buf + 1024, ctx->buf);
+                ctx->retCode = 0;
+                ctx->cb(s3Client_.get(), ctx);
+            }));
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_FALSE(closure.IsFailed());
+    for (int i = 0; i < 1024; ++i) {
+        ASSERT_EQ(0, buf[i]);
+        ASSERT_EQ(0, buf[3072 + i]);
+    }
+    closure.Reset();
+
+    /* 用例:读取的区域全为0
+     * 预期:不读取s3，直接返回成功
+     */
+    context.offset = 3072;
+    context.size = 1024;
+    EXPECT_CALL(*s3Client_, GetObjectTail(_, _, _))
+        .Times(0);
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .Times(0);
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_FALSE(closure.IsFailed());
+    closure.Reset();
+
+    /* 用例:读取的区域跨越两个分片，其中一个读取失败
+     * 预期:返回失败
+     */
+    context.offset = 1536;
+    context.size = 1024;
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .WillOnce(Invoke(
+            [&] (const std::shared_ptr<GetObjectAsyncContext>& ctx) {
+                ASSERT_EQ(512, ctx->offset);
+                ASSERT_EQ(1024, ctx->len);
+                ctx->retCode = -1;
+                ctx->cb(s3Client_.get(), ctx);
+            }));
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+    closure.Reset();
+
+    /* 用例:读取的区域超出chunk范围
+     * 预期:返回失败
+     */
+    context.offset = 4096;
+    context.size = 1024;
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .Times(0);
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+    closure.Reset();
+
+    delete [] buf;
+    EXPECT_CALL(*s3Client_, Deinit())
+        .Times(1);
+    ASSERT_EQ(0, copyer.Fini());
+}
+
+TEST_F(CloneCopyerTest, CompressedObjectTest) {
+    OriginCopyer copyer;
+    CopyerOptions options;
+    options.curveClient = nullptr;
+    options.s3Client = s3Client_;
+    options.s3Conf = S3_CONF;
+    options.s3ObjectLayout = true;
+    ASSERT_EQ(0, copyer.Init(options));
+
+    // 第0个分片压缩存储，第1个分片全为0
+    std::string raw;
+    for (int i = 0; i < 1024; ++i) {
+        raw.push_back('a' + i % 4);
+    }
+    std::string object;
+    ASSERT_TRUE(curve::common::Compress(curve::common::CompressType::Zlib,
+        1, raw.data(), raw.size(), &object));
+    ChunkObjectLayout layout(1024, 2);
+    layout.SetPart(0, object.size(), curve::common::CompressType::Zlib);
+    layout.Encode(&object);
+
+    char* buf = new char[1024];
+    AsyncDownloadContext context;
+    context.location = "compressed@s3";
+    context.offset = 512;
+    context.size = 1024;
+    context.buf = buf;
+    MockDownloadClosure closure(&context);
+
+    /* 用例:读取的区域一半在压缩的分片中，一半全为0
+     * 预期:读取整个压缩的分片，解压后拷贝需要的区域
+     */
+    EXPECT_CALL(*s3Client_, GetObjectTail("compressed", _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(object), Return(0)));
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .WillOnce(Invoke(
+            [&] (const std::shared_ptr<GetObjectAsyncContext>& ctx) {
+                ASSERT_EQ(0, ctx->offset);
+                ASSERT_EQ(layout.GetStoredLength(0), ctx->len);
+                memcpy(ctx->buf, object.data() + ctx->offset, ctx->len);
+                ctx->retCode = 0;
+                ctx->cb(s3Client_.get(), ctx);
+            }));
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_FALSE(closure.IsFailed());
+    ASSERT_EQ(0, memcmp(buf, raw.data() + 512, 512));
+    for (int i = 512; i < 1024; ++i) {
+        ASSERT_EQ(0, buf[i]);
+    }
+    closure.Reset();
+
+    /* 用例:读取到的压缩数据损坏
+     * 预期:返回失败
+     */
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .WillOnce(Invoke(
+            [&] (const std::shared_ptr<GetObjectAsyncContext>& ctx) {
+                memset(ctx->buf, 0xff, ctx->len);
+                ctx->retCode = 0;
+                ctx->cb(s3Client_.get(), ctx);
+            }));
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+    closure.Reset();
+
+    delete [] buf;
+    EXPECT_CALL(*s3Client_, Deinit())
+        .Times(1);
+    ASSERT_EQ(0, copyer.Fini());
+}
+
+TEST_F(CloneCopyerTest, DedupObjectTest) {
+    OriginCopyer copyer;
+    CopyerOptions options;
+    options.curveClient = nullptr;
+    options.s3Client = s3Client_;
+    options.s3Conf = S3_CONF;
+    options.s3ObjectLayout = true;
+    ASSERT_EQ(0, copyer.Init(options));
+
+    // 第0个分片在chunk对象中，第1个分片去重存储在单独的对象中
+    std::string hash(ChunkObjectLayout::kPartHashSize, 'h');
+    std::string partKey = ChunkObjectLayout::PartObjectKey(hash);
+    ChunkObjectLayout layout(1024, 2);
+    layout.SetPartPresent(0);
+    layout.SetPartRef(1, 1024, curve::common::CompressType::None, hash);
+    std::string object(1024, 'a');
+    layout.Encode(&object);
+    std::string part(1024, 'b');
+
+    char* buf = new char[1024];
+    AsyncDownloadContext context;
+    context.location = "dedup@s3";
+    context.offset = 512;
+    context.size = 1024;
+    context.buf = buf;
+    MockDownloadClosure closure(&context);
+
+    /* 用例:读取的区域跨越chunk对象中的分片和去重存储的分片
+     * 预期:分别从chunk对象和分片数据对象中读取
+     */
+    EXPECT_CALL(*s3Client_, GetObjectTail("dedup", _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(object), Return(0)));
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .Times(2)
+        .WillRepeatedly(Invoke(
+            [&] (const std::shared_ptr<GetObjectAsyncContext>& ctx) {
+                const std::string &data =
+                    ctx->key == partKey ? part : object;
+                if (ctx->key == partKey) {
+                    ASSERT_EQ(0, ctx->offset);
+                } else {
+                    ASSERT_EQ("dedup", ctx->key);
+                    ASSERT_EQ(512, ctx->offset);
+                }
+                ASSERT_EQ(512, ctx->len);
+                memcpy(ctx->buf, data.data() + ctx->offset, ctx->len);
+                ctx->retCode = 0;
+                ctx->cb(s3Client_.get(), ctx);
+            }));
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_FALSE(closure.IsFailed());
+    ASSERT_EQ(std::string(512, 'a'), std::string(buf, 512));
+    ASSERT_EQ(std::string(512, 'b'), std::string(buf + 512, 512));
+    closure.Reset();
+
+    delete [] buf;
+    EXPECT_CALL(*s3Client_, Deinit())
+        .Times(1);
+    ASSERT_EQ(0, copyer.Fini());
+}
+
+TEST_F(CloneCopyerTest, PackObjectTest) {
+    OriginCopyer copyer;
+    CopyerOptions options;
+    options.curveClient = nullptr;
+    options.s3Client = s3Client_;
+    options.s3Conf = S3_CONF;
+    options.s3ObjectLayout = true;
+    ASSERT_EQ(0, copyer.Init(options));
+
+    // pack对象中依次为: 100字节其他数据，稀疏存储的chunk，按原样存储的chunk
+    ChunkObjectLayout layout(1024, 2);
+    layout.SetPartPresent(1);
+    std::string sparse(1024, 'b');
+    layout.Encode(&sparse);
+    std::string pack(100, 'x');
+    uint64_t sparseBase = pack.size();
+    pack.append(sparse);
+    uint64_t rawBase = pack.size();
+    pack.append(2048, 'c');
+
+    char* buf = new char[1024];
+    AsyncDownloadContext context;
+    context.offset = 512;
+    context.size = 1024;
+    context.buf = buf;
+    MockDownloadClosure closure(&context);
+
+    auto readPack = [&] (const std::string& key, char* dest,
+                         off_t offset, size_t len) {
+        EXPECT_EQ("pack", key);
+        memcpy(dest, pack.data() + offset, len);
+        return 0;
+    };
+    auto readPackAsync =
+        [&] (const std::shared_ptr<GetObjectAsyncContext>& ctx) {
+            ASSERT_EQ("pack", ctx->key);
+            memcpy(ctx->buf, pack.data() + ctx->offset, ctx->len);
+            ctx->retCode = 0;
+            ctx->cb(s3Client_.get(), ctx);
+        };
+
+    /* 用例:读取pack中稀疏存储的chunk
+     * 预期:从该段数据末尾读取layout，只读取非空的分片，偏移加上起始位置
+     */
+    context.location = LocationOperator::GenerateS3PackLocation(
+        "pack", sparseBase, sparse.size());
+    EXPECT_CALL(*s3Client_, GetObject("pack", _, _, sparse.size()))
+        .WillOnce(Invoke(readPack));
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .WillOnce(Invoke(
+            [&] (const std::shared_ptr<GetObjectAsyncContext>& ctx) {
+                ASSERT_EQ(sparseBase, ctx->offset);
+                ASSERT_EQ(512, ctx->len);
+                readPackAsync(ctx);
+            }));
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_FALSE(closure.IsFailed());
+    ASSERT_EQ(std::string(512, '\0'), std::string(buf, 512));
+    ASSERT_EQ(std::string(512, 'b'), std::string(buf + 512, 512));
+    closure.Reset();
+
+    /* 用例:读取pack中按原样存储的chunk
+     * 预期:直接读取对应的区域
+     */
+    context.location = LocationOperator::GenerateS3PackLocation(
+        "pack", rawBase, 2048);
+    EXPECT_CALL(*s3Client_, GetObject("pack", _, _, 2048))
+        .WillOnce(Invoke(readPack));
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .WillOnce(Invoke(
+            [&] (const std::shared_ptr<GetObjectAsyncContext>& ctx) {
+                ASSERT_EQ(rawBase + 512, ctx->offset);
+                ASSERT_EQ(1024, ctx->len);
+                readPackAsync(ctx);
+            }));
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_FALSE(closure.IsFailed());
+    ASSERT_EQ(std::string(1024, 'c'), std::string(buf, 1024));
+    closure.Reset();
+
+    /* 用例:pack location格式不正确
+     * 预期:下载失败
+     */
+    context.location = "pack:0@s3pack";
+    copyer.DownloadAsync(&closure);
+    ASSERT_TRUE(closure.IsRun());
+    ASSERT_TRUE(closure.IsFailed());
+    closure.Reset();
+
+    delete [] buf;
+    EXPECT_CALL(*s3Client_, Deinit())
+        .Times(1);
+    ASSERT_EQ(0, copyer.Fini());
+}
+
+TEST_F(CloneCopyerTest, LayoutCacheTest) {
+    OriginCopyer copyer;
+    CopyerOptions options;
+    options.curveClient = nullptr;
+    options.s3Client = s3Client_;
+    options.s3Conf = S3_CONF;
+    options.s3ObjectLayout = true;
+    options.layoutCacheSize = 2;
+    ASSERT_EQ(0, copyer.Init(options));
+
+    ChunkObjectLayout layout(1024, 4);
+    layout.SetPartPresent(0);
+    std::string footer;
+    layout.Encode(&footer);
+
+    char* buf = new char[1024];
+    AsyncDownloadContext context;
+    context.offset = 0;
+    context.size = 1024;
+    context.buf = buf;
+    MockDownloadClosure closure(&context);
+    EXPECT_CALL(*s3Client_, GetObjectAsync(_))
+        .WillRepeatedly(Invoke(
+            [&] (const std::shared_ptr<GetObjectAsyncContext>& ctx) {
+                ctx->retCode = 0;
+                ctx->cb(s3Client_.get(), ctx);
+            }));
+
+    auto read = [&](const std::string& name, bool probe) {
+        context.location = name + "@s3";
+        if (probe) {
+            EXPECT_CALL(*s3Client_, GetObjectTail(name, _, _))
+                .WillOnce(DoAll(SetArgPointee<2>(footer), Return(0)));
+        } else {
+            EXPECT_CALL(*s3Client_, GetObjectTail(name, _, _))
+                .Times(0);
+        }
+        copyer.DownloadAsync(&closure);
+        ASSERT_TRUE(closure.IsRun());
+        ASSERT_FALSE(closure.IsFailed());
+        closure.Reset();
+    };
+
+    /* 用例:缓存容量为2，依次读取obj1、obj2，再读取obj1
+     * 预期:obj1和obj2各探测一次，再次读取obj1命中缓存
+     */
+    read("obj1", true);
+    read("obj2", true);
+    read("obj1", false);
+
+    /* 用例:读取obj3，缓存已满
+     * 预期:淘汰最久未使用的obj2，obj1仍在缓存中
+     */
+    read("obj3", true);
+    read("obj1", false);
+    read("obj2", true);
+
+    delete [] buf;
+    EXPECT_CALL(*s3Client_, Deinit())
+        .Times(1);
+    ASSERT_EQ(0, copyer.Fini());
+}
+
 TEST_F(CloneCopyerTest, DisableTest) {
     OriginCopyer copyer;
     CopyerOptions options;
@@ -595,6 +595,8 @@ TEST_F(CloneCoreTest, RecoverChunkTest1) {
     ASSERT_EQ(LAST_INDEX, closure->resContent_.appliedindex);
     ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
               closure->resContent_.status);
+    // 数据已在本地
+    ASSERT_TRUE(closure->resContent_.accessed);
 }
 
 /**
@@ -639,6 +641,7 @@ TEST_F(CloneCoreTest, RecoverChunkTest2) {
         ASSERT_EQ(LAST_INDEX, closure->resContent_.appliedindex);
         ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
                   closure->resContent_.status);
+        ASSERT_TRUE(closure->resContent_.accessed);
     }
 
     // case2
@@ -684,11 +687,14 @@ TEST_F(CloneCoreTest, RecoverChunkTest2) {
         ASSERT_TRUE(closure->isDone_);
         ASSERT_EQ(0, closure->resContent_.appliedindex);
         ASSERT_EQ(0, closure->resContent_.status);
+        // 数据从源端拷贝
+        ASSERT_FALSE(closure->resContent_.accessed);
     }
 }
 
 // case1: read chunk时，从远端拷贝数据，但是不会产生paste请求
-// case2: recover chunk时，从远端拷贝数据，会产生paste请求
+// case2: recover chunk时，从远端拷贝数据，会产生paste请求，
+//        且由于case1中用户读过该chunk，返回accessed
 TEST_F(CloneCoreTest, DisablePasteTest) {
     off_t offset = 0;
     size_t length = 5 * PAGE_SIZE;
@@ -782,6 +788,8 @@ TEST_F(CloneCoreTest, DisablePasteTest) {
         ASSERT_TRUE(closure->isDone_);
         ASSERT_EQ(0, closure->resContent_.appliedindex);
         ASSERT_EQ(0, closure->resContent_.status);
+        // case1中用户读过该chunk
+        ASSERT_TRUE(closure->resContent_.accessed);
     }
 }
 
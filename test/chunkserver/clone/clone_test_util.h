@@ -67,8 +67,9 @@ class FakeChunkClosure : public ::google::protobuf::Closure {
     struct ResponseContent {
         uint64_t appliedindex;
         int status;
+        bool accessed;
         butil::IOBuf attachment;
-        ResponseContent() : appliedindex(0), status(-1) {}
+        ResponseContent() : appliedindex(0), status(-1), accessed(false) {}
     };
 
  public:
@@ -87,6 +88,7 @@ class FakeChunkClosure : public ::google::protobuf::Closure {
         isDone_ = true;
         resContent_.appliedindex = response_->appliedindex();
         resContent_.status = response_->status();
+        resContent_.accessed = response_->accessed();
         resContent_.attachment.append(
             cntl_->response_attachment().to_string());
     }
@@ -42,6 +42,8 @@
 #include "src/chunkserver/raftsnapshot/curve_snapshot_attachment.h"
 #include "test/chunkserver/mock_curve_filesystem_adaptor.h"
 #include "src/chunkserver/concurrent_apply/concurrent_apply.h"
+#include "src/chunkserver/op_request.h"
+#include "src/common/concurrent/count_down_event.h"
 
 namespace curve {
 namespace chunkserver {
@@ -62,6 +64,7 @@ using curve::fs::MockLocalFileSystem;
 using curve::fs::FileSystemType;
 using curve::fs::MockLocalFileSystem;
 using curve::chunkserver::concurrent::ConcurrentApplyOption;
+using curve::common::CountDownEvent;
 
 const char copysetUri[] = "local://./copyset_node_test";
 const int port = 9044;
@@ -117,6 +120,14 @@ class FakeClosure : public braft::Closure {
     }
 };
 
+class CountDownClosure : public ::google::protobuf::Closure {
+ public:
+    void Run() {
+        event.Signal();
+    }
+    CountDownEvent event{1};
+};
+
 class CopysetNodeTest : public ::testing::Test {
  protected:
     void SetUp() {
@@ -1018,5 +1029,80 @@ TEST_F(CopysetNodeTest, get_leader_status) {
     }
 }
 
+TEST_F(CopysetNodeTest, follower_read_after_apply_from_log) {
+    LogicPoolID logicPoolID = 123;
+    CopysetID copysetID = 1345;
+    ChunkID chunkId = 1;
+    Configuration conf;
+    std::shared_ptr<CopysetNode> copysetNode =
+        std::make_shared<CopysetNode>(logicPoolID, copysetID, conf);
+    ASSERT_EQ(0, copysetNode->Init(defaultOptions_));
+    DataStoreOptions options;
+    options.baseDir = "./test-temp";
+    options.chunkSize = 16 * 1024 * 1024;
+    options.pageSize = 4 * 1024;
+    std::shared_ptr<LocalFileSystem> fs =
+        LocalFsFactory::CreateFs(FileSystemType::EXT4, "");
+    std::shared_ptr<FakeCSDataStore> dataStore =
+        std::make_shared<FakeCSDataStore>(options, fs);
+    copysetNode->SetCSDateStore(dataStore);
+    // 非leader
+    ASSERT_FALSE(copysetNode->IsLeaderTerm());
+
+    // follower回放index为5的write op后applied index推进到5
+    ChunkRequest writeRequest;
+    writeRequest.set_optype(CHUNK_OP_TYPE::CHUNK_OP_WRITE);
+    writeRequest.set_logicpoolid(logicPoolID);
+    writeRequest.set_copysetid(copysetID);
+    writeRequest.set_chunkid(chunkId);
+    writeRequest.set_sn(1);
+    writeRequest.set_offset(0);
+    writeRequest.set_size(4096);
+    butil::IOBuf data;
+    data.append(std::string(4096, 'a'));
+    copysetNode->ApplyOpFromLog(std::make_shared<WriteChunkRequest>(),
+                                writeRequest, data, 5);
+    ASSERT_EQ(5, copysetNode->GetAppliedIndex());
+
+    ChunkRequest readRequest;
+    readRequest.set_optype(CHUNK_OP_TYPE::CHUNK_OP_READ);
+    readRequest.set_logicpoolid(logicPoolID);
+    readRequest.set_copysetid(copysetID);
+    readRequest.set_chunkid(chunkId);
+    readRequest.set_sn(1);
+    readRequest.set_offset(0);
+    readRequest.set_size(4096);
+    readRequest.set_followerread(true);
+
+    // client已知的applied index不大于follower的applied index，follower直接读
+    {
+        readRequest.set_appliedindex(5);
+        brpc::Controller cntl;
+        ChunkResponse response;
+        CountDownClosure done;
+        auto req = std::make_shared<ReadChunkRequest>(copysetNode,
+            nullptr, &cntl, &readRequest, &response, &done);
+        req->Process();
+        done.event.Wait();
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                  response.status());
+        ASSERT_EQ(std::string(4096, 'a'),
+                  cntl.response_attachment().to_string());
+    }
+    // follower的数据落后于client已知的applied index，返回重定向
+    {
+        readRequest.set_appliedindex(6);
+        brpc::Controller cntl;
+        ChunkResponse response;
+        CountDownClosure done;
+        auto req = std::make_shared<ReadChunkRequest>(copysetNode,
+            nullptr, &cntl, &readRequest, &response, &done);
+        req->Process();
+        done.event.Wait();
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_REDIRECTED,
+                  response.status());
+    }
+}
+
 }  // namespace chunkserver
 }  // namespace curve
@@ -0,0 +1,189 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/chunkserver/copyset_report_tracker.h"
+
+namespace curve {
+namespace chunkserver {
+
+using curve::mds::heartbeat::CopySetInfo;
+using curve::mds::heartbeat::HeartbeatStatusCode;
+
+namespace {
+
+CopySetInfo BuildInfo(uint32_t copysetId, uint64_t epoch) {
+    CopySetInfo info;
+    info.set_logicalpoolid(1);
+    info.set_copysetid(copysetId);
+    info.set_epoch(epoch);
+    info.mutable_leaderpeer()->set_address("127.0.0.1:8200:0");
+    return info;
+}
+
+void SetStats(CopySetInfo* info, uint32_t iops) {
+    auto stats = info->mutable_stats();
+    stats->set_readrate(0);
+    stats->set_writerate(0);
+    stats->set_readiops(iops);
+    stats->set_writeiops(iops);
+}
+
+}  // namespace
+
+TEST(CopysetReportTrackerTest, delta_report) {
+    CopysetReportTracker tracker(300);
+    HeartbeatResponse response;
+    response.set_statuscode(HeartbeatStatusCode::hbOK);
+
+    // 1. 第一次心跳全量上报
+    HeartbeatRequest req1;
+    tracker.BeginReport(1000, &req1);
+    ASSERT_TRUE(tracker.IsFullReport());
+    tracker.AddCopyset(ToGroupNid(1, 1), BuildInfo(1, 1), true, &req1);
+    tracker.AddCopyset(ToGroupNid(1, 2), BuildInfo(2, 1), true, &req1);
+    tracker.EndReport(&req1);
+    ASSERT_EQ(1, req1.reportversion());
+    ASSERT_FALSE(req1.has_baseversion());
+    ASSERT_EQ(2, req1.copysetinfos_size());
+    tracker.OnReportAcked(req1, response);
+
+    // 2. 只有io统计变化，不上报
+    HeartbeatRequest req2;
+    tracker.BeginReport(1010, &req2);
+    ASSERT_FALSE(tracker.IsFullReport());
+    auto info = BuildInfo(1, 1);
+    SetStats(&info, 100);
+    tracker.AddCopyset(ToGroupNid(1, 1), info, true, &req2);
+    tracker.AddCopyset(ToGroupNid(1, 2), BuildInfo(2, 1), true, &req2);
+    tracker.EndReport(&req2);
+    ASSERT_EQ(2, req2.reportversion());
+    ASSERT_EQ(1, req2.baseversion());
+    ASSERT_EQ(0, req2.copysetinfos_size());
+    ASSERT_EQ(0, req2.removedcopysets_size());
+    tracker.OnReportAcked(req2, response);
+
+    // 3. epoch变化的copyset上报, 构建失败的copyset上报, 删除的copyset上报
+    HeartbeatRequest req3;
+    tracker.BeginReport(1020, &req3);
+    tracker.AddCopyset(ToGroupNid(1, 1), BuildInfo(1, 2), true, &req3);
+    tracker.AddCopyset(ToGroupNid(1, 3), BuildInfo(3, 1), false, &req3);
+    tracker.EndReport(&req3);
+    ASSERT_EQ(3, req3.reportversion());
+    ASSERT_EQ(2, req3.baseversion());
+    ASSERT_EQ(2, req3.copysetinfos_size());
+    ASSERT_EQ(1, req3.copysetinfos(0).copysetid());
+    ASSERT_EQ(3, req3.copysetinfos(1).copysetid());
+    ASSERT_EQ(1, req3.removedcopysets_size());
+    ASSERT_EQ(2, req3.removedcopysets(0).copysetid());
+
+    // 4. 发送失败，下次仍基于已确认的版本
+    tracker.OnReportFailed();
+    HeartbeatRequest req4;
+    tracker.BeginReport(1030, &req4);
+    tracker.AddCopyset(ToGroupNid(1, 1), BuildInfo(1, 2), true, &req4);
+    tracker.EndReport(&req4);
+    ASSERT_EQ(3, req4.reportversion());
+    ASSERT_EQ(2, req4.baseversion());
+    ASSERT_EQ(1, req4.copysetinfos_size());
+    ASSERT_EQ(1, req4.removedcopysets_size());
+    tracker.OnReportAcked(req4, response);
+
+    // 5. 正在配置变更的copyset每次都上报
+    HeartbeatRequest req5;
+    tracker.BeginReport(1040, &req5);
+    info = BuildInfo(1, 2);
+    auto confChange = info.mutable_configchangeinfo();
+    confChange->mutable_peer()->set_address("127.0.0.1:8201:0");
+    confChange->set_type(curve::mds::heartbeat::ADD_PEER);
+    confChange->set_finished(false);
+    tracker.AddCopyset(ToGroupNid(1, 1), info, true, &req5);
+    tracker.EndReport(&req5);
+    ASSERT_EQ(1, req5.copysetinfos_size());
+    tracker.OnReportAcked(req5, response);
+
+    HeartbeatRequest req6;
+    tracker.BeginReport(1050, &req6);
+    tracker.AddCopyset(ToGroupNid(1, 1), info, true, &req6);
+    tracker.EndReport(&req6);
+    ASSERT_EQ(1, req6.copysetinfos_size());
+}
+
+TEST(CopysetReportTrackerTest, full_report) {
+    CopysetReportTracker tracker(300);
+    HeartbeatResponse response;
+    response.set_statuscode(HeartbeatStatusCode::hbOK);
+
+    HeartbeatRequest req1;
+    tracker.BeginReport(1000, &req1);
+    tracker.AddCopyset(ToGroupNid(1, 1), BuildInfo(1, 1), true, &req1);
+    tracker.EndReport(&req1);
+    tracker.OnReportAcked(req1, response);
+
+    // 1. mds要求全量上报
+    HeartbeatRequest req2;
+    tracker.BeginReport(1010, &req2);
+    ASSERT_FALSE(tracker.IsFullReport());
+    tracker.AddCopyset(ToGroupNid(1, 1), BuildInfo(1, 1), true, &req2);
+    tracker.EndReport(&req2);
+    ASSERT_EQ(0, req2.copysetinfos_size());
+    response.set_needfullreport(true);
+    tracker.OnReportAcked(req2, response);
+    response.clear_needfullreport();
+
+    HeartbeatRequest req3;
+    tracker.BeginReport(1020, &req3);
+    ASSERT_TRUE(tracker.IsFullReport());
+    tracker.AddCopyset(ToGroupNid(1, 1), BuildInfo(1, 1), true, &req3);
+    tracker.EndReport(&req3);
+    ASSERT_EQ(2, req3.reportversion());
+    ASSERT_FALSE(req3.has_baseversion());
+    ASSERT_EQ(1, req3.copysetinfos_size());
+    tracker.OnReportAcked(req3, response);
+
+    // 2. mds返回错误，下次全量上报
+    HeartbeatRequest req4;
+    tracker.BeginReport(1030, &req4);
+    ASSERT_FALSE(tracker.IsFullReport());
+    tracker.EndReport(&req4);
+    response.set_statuscode(HeartbeatStatusCode::hbChunkserverUnknown);
+    tracker.OnReportAcked(req4, response);
+    response.set_statuscode(HeartbeatStatusCode::hbOK);
+
+    HeartbeatRequest req5;
+    tracker.BeginReport(1040, &req5);
+    ASSERT_TRUE(tracker.IsFullReport());
+    tracker.EndReport(&req5);
+    tracker.OnReportAcked(req5, response);
+
+    // 3. 超过全量上报间隔
+    HeartbeatRequest req6;
+    tracker.BeginReport(1040 + 299, &req6);
+    ASSERT_FALSE(tracker.IsFullReport());
+    HeartbeatRequest req7;
+    tracker.BeginReport(1040 + 300, &req7);
+    ASSERT_TRUE(tracker.IsFullReport());
+}
+
+}  // namespace chunkserver
+}  // namespace curve
@@ -217,6 +217,34 @@ TEST(ChunkOpRequestTest, encode) {
         ASSERT_EQ(chunkId, request.chunkid());
         delete opReq;
     }
+    /* for batch detele */
+    request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_DELETE_BATCH);
+    request.add_chunkids(chunkId);
+    request.add_chunkids(chunkId + 1);
+    {
+        ChunkOpRequest *opReq = new BatchDeleteChunkRequest(
+            nodePtr, cntl, &request, nullptr, nullptr);
+
+        butil::IOBuf log;
+        ASSERT_EQ(0, opReq->Encode(&request,
+                                   nullptr,
+                                   &log));
+
+        butil::IOBuf data;
+        auto req = ChunkOpRequest::Decode(log, &request,
+                        &data, 0, PeerId("127.0.0.1:9010:0"));
+        auto req1 = dynamic_cast<BatchDeleteChunkRequest*>(req.get());
+        ASSERT_TRUE(req1 != nullptr);
+
+        ASSERT_EQ(CHUNK_OP_TYPE::CHUNK_OP_DELETE_BATCH, request.optype());
+        ASSERT_EQ(logicPoolId, request.logicpoolid());
+        ASSERT_EQ(copysetId, request.copysetid());
+        ASSERT_EQ(2, request.chunkids_size());
+        ASSERT_EQ(chunkId, request.chunkids(0));
+        ASSERT_EQ(chunkId + 1, request.chunkids(1));
+        delete opReq;
+    }
+    request.clear_chunkids();
     /* for read snapshot */
     request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_READ_SNAP);
     request.set_sn(sn);
@@ -308,6 +336,45 @@ TEST(ChunkOpRequestTest, encode) {
         ASSERT_EQ(sn, request.sn());
         delete opReq;
     }
+    /* for batch create clone chunk */
+    request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH);
+    for (int i = 0; i < 2; ++i) {
+        BatchChunkItem *item = request.add_batchitems();
+        item->set_chunkid(chunkId + i);
+        item->set_location(location);
+        item->set_sn(sn + i);
+    }
+    {
+        ChunkOpRequest *opReq
+            = new BatchCreateCloneChunkRequest(nodePtr,
+                                               cntl,
+                                               &request,
+                                               nullptr,
+                                               nullptr);
+
+        butil::IOBuf log;
+        ASSERT_EQ(0, opReq->Encode(&request,
+                                   nullptr,
+                                   &log));
+
+        butil::IOBuf data;
+        auto req = ChunkOpRequest::Decode(log, &request,
+                        &data, 0, PeerId("127.0.0.1:9010:0"));
+        auto req1 = dynamic_cast<BatchCreateCloneChunkRequest*>(req.get());
+        ASSERT_TRUE(req1 != nullptr);
+
+        ASSERT_EQ(CHUNK_OP_TYPE::CHUNK_OP_CREATE_CLONE_BATCH,
+                  request.optype());
+        ASSERT_EQ(logicPoolId, request.logicpoolid());
+        ASSERT_EQ(copysetId, request.copysetid());
+        ASSERT_EQ(options.chunkSize, request.size());
+        ASSERT_EQ(2, request.batchitems_size());
+        ASSERT_EQ(chunkId + 1, request.batchitems(1).chunkid());
+        ASSERT_EQ(location, request.batchitems(1).location());
+        ASSERT_EQ(sn + 1, request.batchitems(1).sn());
+        delete opReq;
+    }
+    request.clear_batchitems();
     /* for scan */
     request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_SCAN);
     request.set_offset(offset);
@@ -803,6 +870,23 @@ TEST(ChunkOpRequestTest, OnApplyFromLogTest) {
         req.OnApplyFromLog(dataStore, request, data);
         ASSERT_FALSE(dataStore->HasInjectError());
     }
+    // batch delete
+    {
+        ChunkRequest request;
+        LogicPoolID logicPoolID = 1;
+        CopysetID copysetID = 1;
+        request.set_logicpoolid(logicPoolID);
+        request.set_copysetid(copysetID);
+        request.set_chunkid(1);
+        request.add_chunkids(1);
+        request.add_chunkids(2);
+        request.set_sn(sn);
+        request.set_optype(CHUNK_OP_TYPE::CHUNK_OP_DELETE_BATCH);
+        butil::IOBuf data;
+        BatchDeleteChunkRequest req;
+        req.OnApplyFromLog(dataStore, request, data);
+        ASSERT_FALSE(dataStore->HasInjectError());
+    }
     // delete snapshot
     {
         ChunkRequest request;
@@ -3193,6 +3193,151 @@ TEST_F(CopysetClientTest, recover_chunk_error_test) {
     }
 }
 
+/**
+ * batch create clone chunk and recover chunk testing
+ */
+TEST_F(CopysetClientTest, batch_clone_recover_test) {
+    MockChunkServiceImpl mockChunkService;
+    ASSERT_EQ(server_->AddService(&mockChunkService,
+                                  brpc::SERVER_DOESNT_OWN_SERVICE), 0);
+    ASSERT_EQ(server_->Start(listenAddr_.c_str(), nullptr), 0);
+
+    IOSenderOption ioSenderOpt;
+    ioSenderOpt.failRequestOpt.chunkserverRPCTimeoutMS = 5000;
+    ioSenderOpt.failRequestOpt.chunkserverOPMaxRetry = 3;
+    ioSenderOpt.failRequestOpt.chunkserverOPRetryIntervalUS = 500;
+
+    CopysetClient copysetClient;
+    MockMetaCache mockMetaCache;
+    mockMetaCache.DelegateToFake();
+    RequestScheduler scheduler;
+    copysetClient.Init(&mockMetaCache, ioSenderOpt, &scheduler);
+
+    LogicPoolID logicPoolId = 1;
+    CopysetID copysetId = 100001;
+    ChunkID chunkId = 1;
+    uint64_t sn = 1;
+
+    ChunkServerID leaderId = 10000;
+    butil::EndPoint leaderAddr;
+    std::string leaderStr = "127.0.0.1:9109";
+    butil::str2endpoint(leaderStr.c_str(), &leaderAddr);
+
+    FileMetric fm("test");
+    IOTracker iot(nullptr, nullptr, nullptr, &fm);
+
+    std::vector<ChunkBatchItem> items(2);
+    for (int i = 0; i < 2; ++i) {
+        items[i].idinfo = ChunkIDInfo(chunkId + i, logicPoolId, copysetId);
+        items[i].location = "test@s3";
+        items[i].sn = sn;
+        items[i].offset = 0;
+        items[i].len = 4096;
+    }
+
+    /* 批量创建，每个chunk的结果分别返回 */
+    {
+        RequestContext *reqCtx = new FakeRequestContext();
+        reqCtx->optype_ = OpType::CREATE_CLONE_BATCH;
+        reqCtx->idinfo_ = items[0].idinfo;
+        reqCtx->batchItems_ = &items;
+
+        curve::common::CountDownEvent cond(1);
+        RequestClosure *reqDone = new FakeRequestClosure(&cond, reqCtx);
+        reqDone->SetFileMetric(&fm);
+        reqDone->SetIOTracker(&iot);
+
+        reqCtx->done_ = reqDone;
+        ChunkResponse response;
+        response.set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        response.add_batchstatus(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        response.add_batchstatus(CHUNK_OP_STATUS::CHUNK_OP_STATUS_CHUNK_EXIST);
+        EXPECT_CALL(mockMetaCache, GetLeader(_, _, _, _, _, _))
+            .Times(AtLeast(1)).WillOnce(DoAll(SetArgPointee<2>(leaderId),
+                                              SetArgPointee<3>(leaderAddr),
+                                              Return(0)));
+        EXPECT_CALL(mockChunkService, CreateCloneChunks(_, _, _, _)).Times(1)
+            .WillOnce(DoAll(SetArgPointee<2>(response),
+                            Invoke(CreateCloneChunkFunc)));
+        copysetClient.CreateCloneChunks(reqCtx->idinfo_, &items, 0,
+                                        4096, reqDone);
+        cond.Wait();
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                  reqDone->GetErrorCode());
+        ASSERT_EQ(LIBCURVE_ERROR::OK, items[0].retCode);
+        ASSERT_EQ(-LIBCURVE_ERROR::EXISTS, items[1].retCode);
+    }
+    /* 不是 leader，重试整个请求 */
+    {
+        RequestContext *reqCtx = new FakeRequestContext();
+        reqCtx->optype_ = OpType::RECOVER_CHUNK_BATCH;
+        reqCtx->idinfo_ = items[0].idinfo;
+        reqCtx->batchItems_ = &items;
+
+        curve::common::CountDownEvent cond(1);
+        RequestClosure *reqDone = new FakeRequestClosure(&cond, reqCtx);
+        reqDone->SetFileMetric(&fm);
+        reqDone->SetIOTracker(&iot);
+
+        reqCtx->done_ = reqDone;
+        ChunkResponse response1;
+        response1.set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_REDIRECTED);
+        response1.set_redirect(leaderStr);
+        ChunkResponse response2;
+        response2.set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        response2.add_batchstatus(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        response2.add_batchstatus(
+            CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN);
+        response2.add_batchaccessed(true);
+        response2.add_batchaccessed(false);
+        EXPECT_CALL(mockMetaCache, GetLeader(_, _, _, _, _, _))
+            .Times(AtLeast(1)).WillRepeatedly(DoAll(SetArgPointee<2>(leaderId),
+                                              SetArgPointee<3>(leaderAddr),
+                                              Return(0)));
+        EXPECT_CALL(mockChunkService, RecoverChunks(_, _, _, _)).Times(2)
+            .WillOnce(DoAll(SetArgPointee<2>(response1),
+                            Invoke(RecoverChunkFunc)))
+            .WillOnce(DoAll(SetArgPointee<2>(response2),
+                            Invoke(RecoverChunkFunc)));
+        copysetClient.RecoverChunks(reqCtx->idinfo_, &items, reqDone);
+        cond.Wait();
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                  reqDone->GetErrorCode());
+        ASSERT_EQ(LIBCURVE_ERROR::OK, items[0].retCode);
+        ASSERT_EQ(-LIBCURVE_ERROR::FAILED, items[1].retCode);
+        ASSERT_TRUE(items[0].accessed);
+        ASSERT_FALSE(items[1].accessed);
+    }
+    /* 返回的结果数量与请求的chunk数量不一致 */
+    {
+        RequestContext *reqCtx = new FakeRequestContext();
+        reqCtx->optype_ = OpType::RECOVER_CHUNK_BATCH;
+        reqCtx->idinfo_ = items[0].idinfo;
+        reqCtx->batchItems_ = &items;
+
+        curve::common::CountDownEvent cond(1);
+        RequestClosure *reqDone = new FakeRequestClosure(&cond, reqCtx);
+        reqDone->SetFileMetric(&fm);
+        reqDone->SetIOTracker(&iot);
+
+        reqCtx->done_ = reqDone;
+        ChunkResponse response;
+        response.set_status(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        response.add_batchstatus(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS);
+        EXPECT_CALL(mockMetaCache, GetLeader(_, _, _, _, _, _))
+            .Times(AtLeast(1)).WillRepeatedly(DoAll(SetArgPointee<2>(leaderId),
+                                              SetArgPointee<3>(leaderAddr),
+                                              Return(0)));
+        EXPECT_CALL(mockChunkService, RecoverChunks(_, _, _, _)).Times(1)
+            .WillOnce(DoAll(SetArgPointee<2>(response),
+                            Invoke(RecoverChunkFunc)));
+        copysetClient.RecoverChunks(reqCtx->idinfo_, &items, reqDone);
+        cond.Wait();
+        ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN,
+                  reqDone->GetErrorCode());
+    }
+}
+
 /**
  * get chunk info error testing
  */
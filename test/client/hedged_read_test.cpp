@@ -0,0 +1,307 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include "src/client/hedged_read.h"
+
+#include <brpc/server.h>
+#include <bthread/bthread.h>
+#include <butil/time.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "src/client/metacache.h"
+#include "src/common/concurrent/count_down_event.h"
+#include "test/client/mock/mock_chunkservice.h"
+
+namespace curve {
+namespace client {
+
+using ::testing::_;
+using ::testing::Invoke;
+
+using curve::chunkserver::ChunkRequest;
+using curve::common::CountDownEvent;
+
+namespace {
+
+const LogicPoolID kLogicPoolId = 1;
+const CopysetID kCopysetId = 1;
+const ChunkServerID kLeaderId = 1;
+const ChunkServerID kFollowerId = 2;
+
+// records the result handed to ReadChunkClosure
+class FakeReadChunkClosure : public ReadChunkClosure {
+ public:
+    explicit FakeReadChunkClosure(CountDownEvent* event)
+        : ReadChunkClosure(nullptr, nullptr),
+          event_(event) {}
+
+    void Run() override {
+        std::unique_ptr<brpc::Controller> cntlGuard(cntl_);
+        failed = cntl_->Failed();
+        status = response_->status();
+        csId = chunkserverID_;
+        event_->Signal();
+    }
+
+    bool failed = true;
+    CHUNK_OP_STATUS status = CHUNK_OP_STATUS::CHUNK_OP_STATUS_FAILURE_UNKNOWN;
+    ChunkServerID csId = 0;
+
+ private:
+    CountDownEvent* event_;
+};
+
+// reply status after delayMS
+void ReplyAfter(uint32_t delayMS, CHUNK_OP_STATUS status,
+                ::google::protobuf::RpcController* controller,
+                const ChunkRequest* request,
+                ChunkResponse* response,
+                google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    if (delayMS > 0) {
+        bthread_usleep(delayMS * 1000);
+    }
+    response->set_status(status);
+}
+
+}  // namespace
+
+class HedgedReadChunkTaskTest : public ::testing::Test {
+ public:
+    void SetUp() override {
+        ASSERT_EQ(0, leaderServer_.AddService(&leaderService_,
+                                              brpc::SERVER_DOESNT_OWN_SERVICE));
+        ASSERT_EQ(0, leaderServer_.Start(leaderAddr_.c_str(), nullptr));
+        ASSERT_EQ(0, followerServer_.AddService(
+                         &followerService_, brpc::SERVER_DOESNT_OWN_SERVICE));
+        ASSERT_EQ(0, followerServer_.Start(followerAddr_.c_str(), nullptr));
+
+        CopysetInfo cpinfo;
+        EndPoint leaderEp, followerEp;
+        butil::str2endpoint(leaderAddr_.c_str(), &leaderEp);
+        butil::str2endpoint(followerAddr_.c_str(), &followerEp);
+        ChunkServerAddr leaderCsAddr(leaderEp);
+        ChunkServerAddr followerCsAddr(followerEp);
+        cpinfo.AddCopysetPeerInfo(
+            CopysetPeerInfo(kLeaderId, leaderCsAddr, leaderCsAddr));
+        cpinfo.AddCopysetPeerInfo(
+            CopysetPeerInfo(kFollowerId, followerCsAddr, followerCsAddr));
+        metaCache_.UpdateCopysetInfo(kLogicPoolId, kCopysetId, cpinfo);
+
+        leader_ = senderManager_.GetOrCreateSender(kLeaderId, leaderEp,
+                                                   senderOpt_);
+        ASSERT_NE(nullptr, leader_);
+
+        param_.idinfo = ChunkIDInfo(1, kLogicPoolId, kCopysetId);
+        param_.offset = 0;
+        param_.length = 4096;
+        param_.appliedIndex = 10;
+        param_.timeoutMS = 3000;
+    }
+
+    void TearDown() override {
+        leaderServer_.Stop(0);
+        leaderServer_.Join();
+        followerServer_.Stop(0);
+        followerServer_.Join();
+    }
+
+ protected:
+    brpc::Server leaderServer_;
+    brpc::Server followerServer_;
+    MockChunkServiceImpl leaderService_;
+    MockChunkServiceImpl followerService_;
+    std::string leaderAddr_ = "127.0.0.1:19520";
+    std::string followerAddr_ = "127.0.0.1:19521";
+
+    MetaCache metaCache_;
+    RequestSenderManager senderManager_;
+    IOSenderOption senderOpt_;
+    std::shared_ptr<RequestSender> leader_;
+    HedgedReadChunkTask::Param param_;
+};
+
+TEST_F(HedgedReadChunkTaskTest, LeaderReturnsBeforeHedgeDelay) {
+    // leader returns before hedge delay, no hedge is issued
+    FileMetric metric("HedgedReadChunkTaskTest_NoHedge");
+    EXPECT_CALL(leaderService_, ReadChunk(_, _, _, _))
+        .WillOnce(Invoke([](::google::protobuf::RpcController* controller,
+                            const ChunkRequest* request,
+                            ChunkResponse* response,
+                            google::protobuf::Closure* done) {
+            ASSERT_FALSE(request->followerread());
+            ReplyAfter(0, CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                       controller, request, response, done);
+        }));
+    EXPECT_CALL(followerService_, ReadChunk(_, _, _, _))
+        .Times(0);
+
+    param_.hedgeDelayUS = 1000 * 1000;
+    CountDownEvent event(1);
+    FakeReadChunkClosure* done = new FakeReadChunkClosure(&event);
+    HedgedReadChunkTask::Start(param_, leader_, &metaCache_, &senderManager_,
+                               senderOpt_, &metric, done);
+    event.Wait();
+    ASSERT_FALSE(done->failed);
+    ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS, done->status);
+    ASSERT_EQ(kLeaderId, done->csId);
+    ASSERT_EQ(0, metric.hedgedReadMetric.issued.get_value());
+    delete done;
+}
+
+TEST_F(HedgedReadChunkTaskTest, LeaderWinsAndHedgeCanceled) {
+    // hedge issued, leader wins and the follower leg is canceled
+    FileMetric metric("HedgedReadChunkTaskTest_LeaderWins");
+    EXPECT_CALL(leaderService_, ReadChunk(_, _, _, _))
+        .WillOnce(Invoke([](::google::protobuf::RpcController* controller,
+                            const ChunkRequest* request,
+                            ChunkResponse* response,
+                            google::protobuf::Closure* done) {
+            ReplyAfter(100, CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                       controller, request, response, done);
+        }));
+    EXPECT_CALL(followerService_, ReadChunk(_, _, _, _))
+        .WillOnce(Invoke([](::google::protobuf::RpcController* controller,
+                            const ChunkRequest* request,
+                            ChunkResponse* response,
+                            google::protobuf::Closure* done) {
+            ASSERT_TRUE(request->followerread());
+            ASSERT_EQ(10, request->appliedindex());
+            ReplyAfter(1500, CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                       controller, request, response, done);
+        }));
+
+    param_.hedgeDelayUS = 10 * 1000;
+    CountDownEvent event(1);
+    FakeReadChunkClosure* done = new FakeReadChunkClosure(&event);
+    butil::Timer timer;
+    timer.start();
+    HedgedReadChunkTask::Start(param_, leader_, &metaCache_, &senderManager_,
+                               senderOpt_, &metric, done);
+    event.Wait();
+    timer.stop();
+    ASSERT_FALSE(done->failed);
+    ASSERT_EQ(kLeaderId, done->csId);
+    // did not wait for the follower
+    ASSERT_LT(timer.m_elapsed(), 1000);
+    ASSERT_EQ(1, metric.hedgedReadMetric.issued.get_value());
+    ASSERT_EQ(1, metric.hedgedReadMetric.lost.get_value());
+    ASSERT_EQ(0, metric.hedgedReadMetric.won.get_value());
+    delete done;
+}
+
+TEST_F(HedgedReadChunkTaskTest, HedgeWinsAndLeaderCanceled) {
+    // leader is slow, hedge wins and the leader leg is canceled
+    FileMetric metric("HedgedReadChunkTaskTest_HedgeWins");
+    EXPECT_CALL(leaderService_, ReadChunk(_, _, _, _))
+        .WillOnce(Invoke([](::google::protobuf::RpcController* controller,
+                            const ChunkRequest* request,
+                            ChunkResponse* response,
+                            google::protobuf::Closure* done) {
+            ReplyAfter(1500, CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                       controller, request, response, done);
+        }));
+    EXPECT_CALL(followerService_, ReadChunk(_, _, _, _))
+        .WillOnce(Invoke([](::google::protobuf::RpcController* controller,
+                            const ChunkRequest* request,
+                            ChunkResponse* response,
+                            google::protobuf::Closure* done) {
+            ReplyAfter(0, CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                       controller, request, response, done);
+        }));
+
+    param_.hedgeDelayUS = 10 * 1000;
+    CountDownEvent event(1);
+    FakeReadChunkClosure* done = new FakeReadChunkClosure(&event);
+    butil::Timer timer;
+    timer.start();
+    HedgedReadChunkTask::Start(param_, leader_, &metaCache_, &senderManager_,
+                               senderOpt_, &metric, done);
+    event.Wait();
+    timer.stop();
+    ASSERT_FALSE(done->failed);
+    ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS, done->status);
+    ASSERT_EQ(kFollowerId, done->csId);
+    ASSERT_LT(timer.m_elapsed(), 1000);
+    ASSERT_EQ(1, metric.hedgedReadMetric.issued.get_value());
+    ASSERT_EQ(1, metric.hedgedReadMetric.won.get_value());
+    delete done;
+}
+
+TEST_F(HedgedReadChunkTaskTest, HedgeFailedLeaderDecides) {
+    // follower lags and redirects, leader decides the result
+    FileMetric metric("HedgedReadChunkTaskTest_HedgeFailed");
+    EXPECT_CALL(leaderService_, ReadChunk(_, _, _, _))
+        .WillOnce(Invoke([](::google::protobuf::RpcController* controller,
+                            const ChunkRequest* request,
+                            ChunkResponse* response,
+                            google::protobuf::Closure* done) {
+            ReplyAfter(200, CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS,
+                       controller, request, response, done);
+        }));
+    EXPECT_CALL(followerService_, ReadChunk(_, _, _, _))
+        .WillOnce(Invoke([](::google::protobuf::RpcController* controller,
+                            const ChunkRequest* request,
+                            ChunkResponse* response,
+                            google::protobuf::Closure* done) {
+            ReplyAfter(0, CHUNK_OP_STATUS::CHUNK_OP_STATUS_REDIRECTED,
+                       controller, request, response, done);
+        }));
+
+    param_.hedgeDelayUS = 10 * 1000;
+    CountDownEvent event(1);
+    FakeReadChunkClosure* done = new FakeReadChunkClosure(&event);
+    HedgedReadChunkTask::Start(param_, leader_, &metaCache_, &senderManager_,
+                               senderOpt_, &metric, done);
+    event.Wait();
+    ASSERT_FALSE(done->failed);
+    ASSERT_EQ(CHUNK_OP_STATUS::CHUNK_OP_STATUS_SUCCESS, done->status);
+    ASSERT_EQ(kLeaderId, done->csId);
+    ASSERT_EQ(1, metric.hedgedReadMetric.failed.get_value());
+    ASSERT_EQ(0, metric.hedgedReadMetric.won.get_value());
+    delete done;
+}
+
+TEST(HedgedReadTest, TestCalcHedgeDelay) {
+    HedgedReadOption opt;
+    opt.latencyPercentile = 99;
+    opt.minDelayMS = 5;
+    opt.maxDelayMS = 200;
+
+    // no metric, use max delay
+    ASSERT_EQ(200 * 1000, HedgedReadChunkTask::CalcHedgeDelayUS(opt, nullptr));
+
+    // no latency sample yet, use max delay
+    std::unique_ptr<FileMetric> metric(new FileMetric("HedgedReadTest"));
+    ASSERT_EQ(200 * 1000,
+              HedgedReadChunkTask::CalcHedgeDelayUS(opt, metric.get()));
+
+    // max delay is never less than min delay
+    opt.maxDelayMS = 1;
+    ASSERT_EQ(5 * 1000, HedgedReadChunkTask::CalcHedgeDelayUS(opt, nullptr));
+}
+
+}  // namespace client
+}  // namespace curve
@@ -47,6 +47,7 @@
 #include "src/client/request_context.h"
 #include "src/client/splitor.h"
 #include "src/client/source_reader.h"
+#include "src/common/timeutility.h"
 #include "test/client/fake/fakeMDS.h"
 #include "test/client/fake/mockMDS.h"
 #include "test/client/fake/mock_schedule.h"
@@ -445,6 +446,99 @@ TEST_F(IOTrackerSplitorTest, StartRead) {
     delete[] data;
 }
 
+TEST_F(IOTrackerSplitorTest, StageTraceTest) {
+    MockRequestScheduler* mockschuler = new MockRequestScheduler;
+    mockschuler->DelegateToFake();
+
+    curve::client::IOManager4File* iomana = fileinstance_->GetIOManager4File();
+    MetaCache* mc = fileinstance_->GetIOManager4File()->GetMetaCache();
+
+    IOTraceOption traceOpt;
+    traceOpt.enable = true;
+    traceOpt.sampleRate = 1;
+    traceOpt.slowIOThresholdMS = 0;
+    IOTracker::InitTraceOption(traceOpt);
+
+    uint64_t offset = 4 * 1024 * 1024 - 4 * 1024;
+    uint64_t length = 4 * 1024 * 1024 + 8 * 1024;
+    std::unique_ptr<char[]> data(new char[length]);
+
+    FileMetric fileMetric("/StageTraceTest");
+    IOTracker iotracker(iomana, mc, mockschuler, &fileMetric);
+    iotracker.SetUserDataType(UserDataType::RawBuffer);
+    iotracker.StartRead(data.get(), offset, length, mdsclient_.get(),
+                        mc->GetFileInfo());
+    ASSERT_EQ(static_cast<int>(length), iotracker.Wait());
+
+    // every sampled io is slow with zero threshold
+    ASSERT_EQ(1, fileMetric.ioStageMetric.total.count());
+    ASSERT_EQ(1, fileMetric.ioStageMetric.split.count());
+    ASSERT_EQ(1, fileMetric.ioStageMetric.rpc.count());
+    ASSERT_EQ(1, fileMetric.ioStageMetric.slowIO.get_value());
+
+    // trace disabled
+    IOTracker::InitTraceOption(IOTraceOption());
+    IOTracker iotracker2(iomana, mc, mockschuler, &fileMetric);
+    iotracker2.SetUserDataType(UserDataType::RawBuffer);
+    iotracker2.StartRead(data.get(), offset, length, mdsclient_.get(),
+                         mc->GetFileInfo());
+    ASSERT_EQ(static_cast<int>(length), iotracker2.Wait());
+    ASSERT_EQ(1, fileMetric.ioStageMetric.total.count());
+
+    delete mockschuler;
+}
+
+// overhead of io stage trace on the client io path, the budget is 1%
+TEST_F(IOTrackerSplitorTest, DISABLED_StageTraceOverhead) {
+    MockRequestScheduler* mockschuler = new MockRequestScheduler;
+    mockschuler->DelegateToFake();
+
+    curve::client::IOManager4File* iomana = fileinstance_->GetIOManager4File();
+    MetaCache* mc = fileinstance_->GetIOManager4File()->GetMetaCache();
+
+    const int ioNum = 20000;
+    const uint64_t offset = 4 * 1024 * 1024 - 4 * 1024;
+    const uint64_t length = 8 * 1024;
+    std::unique_ptr<char[]> data(new char[length]);
+    FileMetric fileMetric("/StageTraceOverhead");
+
+    auto runIO = [&]() {
+        uint64_t startUs = curve::common::TimeUtility::GetTimeofDayUs();
+        for (int i = 0; i < ioNum; ++i) {
+            IOTracker iotracker(iomana, mc, mockschuler, &fileMetric);
+            iotracker.SetUserDataType(UserDataType::RawBuffer);
+            iotracker.StartRead(data.get(), offset, length, mdsclient_.get(),
+                                mc->GetFileInfo());
+            EXPECT_EQ(static_cast<int>(length), iotracker.Wait());
+        }
+        return static_cast<double>(
+            curve::common::TimeUtility::GetTimeofDayUs() - startUs) / ioNum;
+    };
+
+    // warm up
+    IOTracker::InitTraceOption(IOTraceOption());
+    runIO();
+    double disabledUs = runIO();
+
+    IOTraceOption traceOpt;
+    traceOpt.enable = true;
+    traceOpt.slowIOThresholdMS = 1000;
+    for (uint32_t sampleRate : {100u, 1u}) {
+        traceOpt.sampleRate = sampleRate;
+        IOTracker::InitTraceOption(traceOpt);
+        double tracedUs = runIO();
+        LOG(INFO) << "sample rate = " << sampleRate
+                  << ", io num = " << ioNum
+                  << ", disabled avg(us) = " << disabledUs
+                  << ", traced avg(us) = " << tracedUs
+                  << ", overhead = "
+                  << (tracedUs - disabledUs) * 100 / disabledUs << "%";
+    }
+
+    IOTracker::InitTraceOption(IOTraceOption());
+    delete mockschuler;
+}
+
 TEST_F(IOTrackerSplitorTest, StartWrite) {
     MockRequestScheduler* mockschuler = new MockRequestScheduler;
     mockschuler->DelegateToFake();
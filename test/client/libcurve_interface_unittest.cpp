@@ -24,6 +24,7 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <atomic>
 #include <chrono>              // NOLINT
 #include <condition_variable>  // NOLINT
 #include <iostream>
@@ -70,6 +71,17 @@ void readcallbacktest(CurveAioContext* context) {
     LOG(INFO) << "aio call back here, errorcode = " << context->ret;
 }
 
+std::atomic<int> batchdone(0);
+std::mutex batchmtx;
+std::condition_variable batchcv;
+
+void batchcallbacktest(CurveAioContext* context) {
+    ASSERT_EQ(static_cast<int>(context->length), context->ret);
+    std::lock_guard<std::mutex> lk(batchmtx);
+    batchdone.fetch_add(1);
+    batchcv.notify_one();
+}
+
 TEST(TestLibcurveInterface, InterfaceTest) {
     FLAGS_chunkserver_list =
          "127.0.0.1:9115:0,127.0.0.1:9116:0,127.0.0.1:9117:0";
@@ -169,6 +181,43 @@ TEST(TestLibcurveInterface, InterfaceTest) {
         ASSERT_EQ(readbuffer[i +  7 * 1024], 'h');
     }
 
+    // batch submit two writes and then two reads
+    {
+        char* batchwritebuf = new char[8 * 1024];
+        char* batchreadbuf = new char[8 * 1024];
+        memset(batchwritebuf, 'x', 4 * 1024);
+        memset(batchwritebuf + 4 * 1024, 'y', 4 * 1024);
+
+        CurveAioContext ctxs[4];
+        CurveAioContext* ctxptrs[4];
+        for (int i = 0; i < 4; ++i) {
+            ctxs[i].offset = 16 * 1024 + (i % 2) * 4 * 1024;
+            ctxs[i].length = 4 * 1024;
+            ctxs[i].op = i < 2 ? LIBCURVE_OP_WRITE : LIBCURVE_OP_READ;
+            ctxs[i].buf = (i < 2 ? batchwritebuf : batchreadbuf) +
+                          (i % 2) * 4 * 1024;
+            ctxs[i].cb = batchcallbacktest;
+            ctxptrs[i] = &ctxs[i];
+        }
+
+        batchdone.store(0);
+        ASSERT_EQ(0, AioSubmit(fd, ctxptrs, 2));
+        {
+            std::unique_lock<std::mutex> lk(batchmtx);
+            batchcv.wait(lk, []()->bool{return batchdone.load() == 2;});
+        }
+
+        ASSERT_EQ(0, AioSubmit(fd, ctxptrs + 2, 2));
+        {
+            std::unique_lock<std::mutex> lk(batchmtx);
+            batchcv.wait(lk, []()->bool{return batchdone.load() == 4;});
+        }
+
+        ASSERT_EQ(0, memcmp(batchwritebuf, batchreadbuf, 8 * 1024));
+        delete[] batchwritebuf;
+        delete[] batchreadbuf;
+    }
+
     mds.EnableNetUnstable(400);
     int count = 0;
     while (count < 20) {
@@ -611,6 +660,10 @@ TEST(TestLibcurveInterface, InterfaceExceptionTest) {
     ctx.cb = writecallbacktest;
     ASSERT_EQ(-LIBCURVE_ERROR::NOT_ALIGNED, AioWrite(1234, &ctx));
     ASSERT_EQ(-LIBCURVE_ERROR::NOT_ALIGNED, AioRead(1234, &ctx));
+    CurveAioContext* ctxptr = &ctx;
+    ctx.op = LIBCURVE_OP_WRITE;
+    ASSERT_EQ(-LIBCURVE_ERROR::NOT_ALIGNED, AioSubmit(1234, &ctxptr, 1));
+    ASSERT_EQ(-LIBCURVE_ERROR::FAILED, AioSubmit(1234, nullptr, 1));
     ASSERT_EQ(-LIBCURVE_ERROR::NOT_ALIGNED, Write(1234, buffer, 1, 4096));
     ASSERT_EQ(-LIBCURVE_ERROR::NOT_ALIGNED, Read(1234, buffer, 4096 , 123));
 
@@ -622,6 +675,9 @@ TEST(TestLibcurveInterface, InterfaceExceptionTest) {
 
     // aiowrite not opened file
     ASSERT_EQ(-LIBCURVE_ERROR::BAD_FD, AioWrite(1234, &writeaioctx));
+    CurveAioContext* writectxptr = &writeaioctx;
+    writeaioctx.op = LIBCURVE_OP_WRITE;
+    ASSERT_EQ(-LIBCURVE_ERROR::BAD_FD, AioSubmit(1234, &writectxptr, 1));
 
     // aioread not opened file
     char* readbuffer = new char[8 * 1024];
@@ -24,6 +24,7 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include <map>
 #include <string>
 #include <thread>   //NOLINT
 #include <chrono>   //NOLINT
@@ -266,6 +267,82 @@ TEST(MDSChangeTest, MDSFailoverTest) {
     ASSERT_LE(calledTimes, 510);
 }
 
+// 测试只读请求发往只读服务的mds，失败后回到leader
+TEST(MDSChangeTest, FollowerReadTest) {
+    class MDSClientDerived : public MDSClient {
+     public:
+        MDSClient::MDSRPCExcutor rpcexcutor;
+    };
+
+    MetaServerOption metaopt;
+    metaopt.mdsAddrs.push_back("127.0.0.1:9903");
+    metaopt.mdsAddrs.push_back("127.0.0.1:9904");
+    metaopt.mdsRPCTimeoutMs = 500;
+    metaopt.mdsRPCRetryIntervalUS = 10000;  // 10ms
+
+    MDSClientDerived mdsd;
+
+    // 场景1：没有配置只读服务地址，请求直接发往leader
+    mdsd.rpcexcutor.SetOption(metaopt);
+    int calledTimes = 0;
+    auto okTask = [&](int mdsindex, uint64_t rpctimeoutMS,
+                      brpc::Channel* channel, brpc::Controller* cntl)->int {
+        ++calledTimes;
+        return LIBCURVE_ERROR::OK;
+    };
+    ASSERT_EQ(LIBCURVE_ERROR::OK, mdsd.rpcexcutor.DoReadRPCTask(okTask, 1000));
+    ASSERT_EQ(1, calledTimes);
+
+    // 场景2：只读服务返回成功，不再发往leader
+    metaopt.mdsFollowerReadAddrs.push_back("127.0.0.1:9906");
+    metaopt.mdsFollowerReadAddrs.push_back("127.0.0.1:9907");
+    mdsd.rpcexcutor.SetOption(metaopt);
+    calledTimes = 0;
+    ASSERT_EQ(LIBCURVE_ERROR::OK, mdsd.rpcexcutor.DoReadRPCTask(okTask, 1000));
+    ASSERT_EQ(1, calledTimes);
+
+    // 场景3：只读服务的缓存过期返回EAGAIN，只尝试一次，然后发往leader，
+    //       leader上正常重试直到成功
+    calledTimes = 0;
+    auto staleTask = [&](int mdsindex, uint64_t rpctimeoutMS,
+                         brpc::Channel* channel, brpc::Controller* cntl)->int {
+        ++calledTimes;
+        return calledTimes <= 2 ? -EAGAIN : LIBCURVE_ERROR::OK;
+    };
+    ASSERT_EQ(LIBCURVE_ERROR::OK,
+              mdsd.rpcexcutor.DoReadRPCTask(staleTask, 1000));
+    ASSERT_EQ(3, calledTimes);
+
+    // 场景4：只读服务返回文件不存在，可能是缓存落后，由leader确认
+    calledTimes = 0;
+    auto notExistTask = [&](int mdsindex, uint64_t rpctimeoutMS,
+                            brpc::Channel* channel,
+                            brpc::Controller* cntl)->int {
+        ++calledTimes;
+        return calledTimes == 1 ? LIBCURVE_ERROR::NOTEXIST
+                                : LIBCURVE_ERROR::OK;
+    };
+    ASSERT_EQ(LIBCURVE_ERROR::OK,
+              mdsd.rpcexcutor.DoReadRPCTask(notExistTask, 1000));
+    ASSERT_EQ(2, calledTimes);
+
+    // 场景5：每个只读服务地址复用同一个channel
+    std::map<int, brpc::Channel*> channels;
+    auto channelTask = [&](int mdsindex, uint64_t rpctimeoutMS,
+                           brpc::Channel* channel,
+                           brpc::Controller* cntl)->int {
+        auto ret = channels.emplace(mdsindex, channel);
+        EXPECT_EQ(ret.first->second, channel);
+        return LIBCURVE_ERROR::OK;
+    };
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(LIBCURVE_ERROR::OK,
+                  mdsd.rpcexcutor.DoReadRPCTask(channelTask, 1000));
+    }
+    ASSERT_EQ(2, channels.size());
+    ASSERT_NE(channels[0], channels[1]);
+}
+
 }  // namespace client
 }  // namespace curve
 
@@ -175,6 +175,16 @@ class MockChunkServiceImpl : public ChunkService {
         const ::curve::chunkserver::ChunkRequest *request,
         ::curve::chunkserver::ChunkResponse *response,
         google::protobuf::Closure *done));
+    MOCK_METHOD4(CreateCloneChunks, void(::google::protobuf::RpcController
+        *controller,
+        const ::curve::chunkserver::ChunkRequest *request,
+        ::curve::chunkserver::ChunkResponse *response,
+        google::protobuf::Closure *done));
+    MOCK_METHOD4(RecoverChunks, void(::google::protobuf::RpcController
+        *controller,
+        const ::curve::chunkserver::ChunkRequest *request,
+        ::curve::chunkserver::ChunkResponse *response,
+        google::protobuf::Closure *done));
 
     void DelegateToFake() {
         ON_CALL(*this, WriteChunk(_, _, _, _))
@@ -0,0 +1,224 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include "src/client/readahead_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+namespace curve {
+namespace client {
+
+namespace {
+
+const uint64_t kKiB = 1024;
+const uint64_t kFileLength = 1024 * kKiB * kKiB;
+
+butil::IOBuf MakeData(uint64_t offset, uint64_t length) {
+    std::string data(length, 0);
+    for (uint64_t i = 0; i < length; ++i) {
+        data[i] = static_cast<char>((offset + i) % 251);
+    }
+
+    butil::IOBuf buf;
+    buf.append(data);
+    return buf;
+}
+
+}  // namespace
+
+class ReadaheadCacheTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        option_.enable = true;
+        option_.cacheBlockSizeKB = 128;
+        option_.cacheCapacityMB = 1;
+        option_.minWindowKB = 256;
+        option_.maxWindowKB = 1024;
+        option_.sequentialTriggerCount = 2;
+
+        metric_.reset(new ReadaheadMetric("ReadaheadCacheTest"));
+        cache_.reset(new ReadaheadCache(option_, metric_.get()));
+    }
+
+ protected:
+    ReadaheadOption option_;
+    std::unique_ptr<ReadaheadMetric> metric_;
+    std::unique_ptr<ReadaheadCache> cache_;
+};
+
+TEST_F(ReadaheadCacheTest, TestRandomReadNotTriggerReadahead) {
+    ReadaheadRange range;
+    ASSERT_FALSE(cache_->OnUserRead(0, 4 * kKiB, kFileLength, &range));
+    ASSERT_FALSE(cache_->OnUserRead(100 * kKiB, 4 * kKiB, kFileLength,
+                                    &range));
+    ASSERT_FALSE(cache_->OnUserRead(10 * kKiB, 4 * kKiB, kFileLength,
+                                    &range));
+    ASSERT_EQ(0, metric_->issued.get_value());
+}
+
+TEST_F(ReadaheadCacheTest, TestSequentialReadWindowGrows) {
+    ReadaheadRange range;
+    ASSERT_FALSE(cache_->OnUserRead(0, 64 * kKiB, kFileLength, &range));
+
+    // second continuous read triggers readahead with min window
+    ASSERT_TRUE(cache_->OnUserRead(64 * kKiB, 64 * kKiB, kFileLength,
+                                   &range));
+    ASSERT_EQ(128 * kKiB, range.offset);
+    ASSERT_EQ(256 * kKiB, range.length);
+    ASSERT_EQ(512 * kKiB, cache_->WindowBytes());
+
+    // less than half window ahead, readahead continues from last end
+    ASSERT_TRUE(cache_->OnUserRead(128 * kKiB, 64 * kKiB, kFileLength,
+                                   &range));
+    ASSERT_EQ(384 * kKiB, range.offset);
+    ASSERT_EQ(384 * kKiB, range.length);
+    ASSERT_EQ(1024 * kKiB, cache_->WindowBytes());
+
+    // enough data ahead, no more readahead
+    ASSERT_FALSE(cache_->OnUserRead(192 * kKiB, 64 * kKiB, kFileLength,
+                                    &range));
+
+    // window never exceeds max window
+    ASSERT_TRUE(cache_->OnUserRead(256 * kKiB, 512 * kKiB, kFileLength,
+                                   &range));
+    ASSERT_EQ(768 * kKiB, range.offset);
+    ASSERT_EQ(1024 * kKiB, range.length);
+    ASSERT_EQ(1024 * kKiB, cache_->WindowBytes());
+
+    // random read resets window
+    ASSERT_FALSE(cache_->OnUserRead(0, 4 * kKiB, kFileLength, &range));
+    ASSERT_EQ(option_.minWindowKB * kKiB, cache_->WindowBytes());
+}
+
+TEST_F(ReadaheadCacheTest, TestReadaheadNotExceedFileLength) {
+    ReadaheadRange range;
+    const uint64_t fileLength = 256 * kKiB;
+    ASSERT_FALSE(cache_->OnUserRead(0, 64 * kKiB, fileLength, &range));
+    ASSERT_TRUE(cache_->OnUserRead(64 * kKiB, 64 * kKiB, fileLength, &range));
+    ASSERT_EQ(128 * kKiB, range.offset);
+    ASSERT_EQ(128 * kKiB, range.length);
+
+    ASSERT_FALSE(cache_->OnUserRead(128 * kKiB, 128 * kKiB, fileLength,
+                                    &range));
+}
+
+TEST_F(ReadaheadCacheTest, TestReadHitAndMiss) {
+    ReadaheadRange range;
+    range.offset = 128 * kKiB;
+    range.length = 256 * kKiB;
+    range.generation = 0;
+    cache_->Insert(range, MakeData(range.offset, range.length));
+    ASSERT_EQ(256 * kKiB, cache_->CachedBytes());
+
+    butil::IOBuf data;
+    ASSERT_TRUE(cache_->Read(200 * kKiB, 100 * kKiB, &data));
+    ASSERT_TRUE(data.equals(MakeData(200 * kKiB, 100 * kKiB)));
+
+    // partially cached
+    ASSERT_FALSE(cache_->Read(300 * kKiB, 200 * kKiB, &data));
+    ASSERT_FALSE(cache_->Read(0, 4 * kKiB, &data));
+
+    ASSERT_EQ(1, metric_->hit.get_value());
+    ASSERT_EQ(2, metric_->miss.get_value());
+}
+
+TEST_F(ReadaheadCacheTest, TestWriteInvalidate) {
+    ReadaheadRange range;
+    range.offset = 0;
+    range.length = 512 * kKiB;
+    range.generation = 0;
+    cache_->Insert(range, MakeData(range.offset, range.length));
+
+    cache_->Invalidate(130 * kKiB, 4 * kKiB);
+    ASSERT_EQ(384 * kKiB, cache_->CachedBytes());
+
+    butil::IOBuf data;
+    ASSERT_TRUE(cache_->Read(0, 128 * kKiB, &data));
+    ASSERT_FALSE(cache_->Read(128 * kKiB, 4 * kKiB, &data));
+    ASSERT_TRUE(cache_->Read(256 * kKiB, 256 * kKiB, &data));
+
+    // readahead issued before write is dropped
+    cache_->Insert(range, MakeData(range.offset, range.length));
+    ASSERT_EQ(384 * kKiB, cache_->CachedBytes());
+    ASSERT_EQ(1, metric_->dropped.get_value());
+
+    // large invalidation
+    cache_->Invalidate(0, kFileLength);
+    ASSERT_EQ(0, cache_->CachedBytes());
+}
+
+TEST_F(ReadaheadCacheTest, TestReadaheadDuringInflightWrite) {
+    // write is submitted
+    cache_->Invalidate(0, 4 * kKiB);
+
+    // readahead issued while the write is inflight may read old data
+    ReadaheadRange before;
+    before.offset = 0;
+    before.length = 256 * kKiB;
+    before.generation = 1;
+    ReadaheadRange after = before;
+    after.offset = 256 * kKiB;
+
+    // returned before the write is done, evicted when the write is done
+    cache_->Insert(before, MakeData(before.offset, before.length));
+    ASSERT_EQ(256 * kKiB, cache_->CachedBytes());
+    cache_->Invalidate(0, 4 * kKiB);
+    butil::IOBuf data;
+    ASSERT_FALSE(cache_->Read(0, 4 * kKiB, &data));
+    ASSERT_TRUE(cache_->Read(128 * kKiB, 128 * kKiB, &data));
+
+    // returned after the write is done, dropped
+    cache_->Insert(after, MakeData(after.offset, after.length));
+    ASSERT_FALSE(cache_->Read(256 * kKiB, 4 * kKiB, &data));
+    ASSERT_EQ(1, metric_->dropped.get_value());
+}
+
+TEST_F(ReadaheadCacheTest, TestEvictLeastRecentlyUsed) {
+    ReadaheadRange range;
+    range.generation = 0;
+    range.length = 512 * kKiB;
+
+    range.offset = 0;
+    cache_->Insert(range, MakeData(range.offset, range.length));
+    range.offset = 512 * kKiB;
+    cache_->Insert(range, MakeData(range.offset, range.length));
+    ASSERT_EQ(1024 * kKiB, cache_->CachedBytes());
+
+    // touch first block
+    butil::IOBuf data;
+    ASSERT_TRUE(cache_->Read(0, 4 * kKiB, &data));
+
+    range.offset = 1024 * kKiB;
+    range.length = 128 * kKiB;
+    cache_->Insert(range, MakeData(range.offset, range.length));
+    ASSERT_EQ(1024 * kKiB, cache_->CachedBytes());
+
+    ASSERT_TRUE(cache_->Read(0, 4 * kKiB, &data));
+    ASSERT_FALSE(cache_->Read(128 * kKiB, 4 * kKiB, &data));
+    ASSERT_TRUE(cache_->Read(1024 * kKiB, 128 * kKiB, &data));
+}
+
+}  // namespace client
+}  // namespace curve
@@ -0,0 +1,252 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/common/chunk_object_layout.h"
+
+namespace curve {
+namespace common {
+
+TEST(ChunkObjectLayoutTest, IsZeroBufferTest) {
+    std::vector<char> buf(4096 + 7, 0);
+    ASSERT_TRUE(IsZeroBuffer(buf.data(), buf.size()));
+    ASSERT_TRUE(IsZeroBuffer(buf.data(), 0));
+
+    // 非0字节分别位于整块中和末尾不足一块的部分
+    buf[1000] = 1;
+    ASSERT_FALSE(IsZeroBuffer(buf.data(), buf.size()));
+    ASSERT_TRUE(IsZeroBuffer(buf.data(), 1000));
+    buf[1000] = 0;
+    buf[4096 + 6] = 1;
+    ASSERT_FALSE(IsZeroBuffer(buf.data(), buf.size()));
+    ASSERT_TRUE(IsZeroBuffer(buf.data(), 4096 + 6));
+}
+
+TEST(ChunkObjectLayoutTest, EncodeDecodeTest) {
+    ChunkObjectLayout layout(1024, 10);
+    layout.SetPartPresent(0);
+    layout.SetPartPresent(3);
+    layout.SetPartPresent(9);
+    layout.SetPartPresent(10);
+    ASSERT_EQ(3 * 1024, layout.GetDataLength());
+
+    std::string object(layout.GetDataLength(), 'a');
+    layout.Encode(&object);
+
+    ChunkObjectLayout decoded;
+    size_t needLen = 0;
+    ASSERT_EQ(LayoutDecodeStatus::OK, ChunkObjectLayout::Decode(
+        object.data(), object.size(), &decoded, &needLen));
+    ASSERT_EQ(1024, decoded.GetPartSize());
+    ASSERT_EQ(10, decoded.GetPartNum());
+    ASSERT_EQ(10 * 1024, decoded.GetChunkSize());
+    for (uint32_t i = 0; i < 10; ++i) {
+        ASSERT_EQ(layout.IsPartPresent(i), decoded.IsPartPresent(i));
+    }
+
+    // 只有对象尾部的一部分数据
+    size_t layoutLen = object.size() - layout.GetDataLength();
+    std::string tail = object.substr(object.size() -
+        ChunkObjectLayout::kTrailerSize);
+    ASSERT_EQ(LayoutDecodeStatus::NeedMore, ChunkObjectLayout::Decode(
+        tail.data(), tail.size(), &decoded, &needLen));
+    ASSERT_EQ(layoutLen, needLen);
+    tail = object.substr(object.size() - needLen);
+    ASSERT_EQ(LayoutDecodeStatus::OK, ChunkObjectLayout::Decode(
+        tail.data(), tail.size(), &decoded, &needLen));
+
+    // 按chunk原样存储的对象
+    std::string dense(4096, 'a');
+    ASSERT_EQ(LayoutDecodeStatus::NotLayout, ChunkObjectLayout::Decode(
+        dense.data(), dense.size(), &decoded, &needLen));
+    ASSERT_EQ(LayoutDecodeStatus::NotLayout, ChunkObjectLayout::Decode(
+        dense.data(), 0, &decoded, &needLen));
+
+    // layout数据损坏
+    std::string corrupted = object;
+    corrupted[layout.GetDataLength()] ^= 0x01;
+    ASSERT_EQ(LayoutDecodeStatus::Corrupted, ChunkObjectLayout::Decode(
+        corrupted.data(), corrupted.size(), &decoded, &needLen));
+}
+
+TEST(ChunkObjectLayoutTest, MapRangeTest) {
+    // 分片: 0 1 2 3 4 5，其中1 2 4存储在对象中
+    ChunkObjectLayout layout(100, 6);
+    layout.SetPartPresent(4);
+    layout.SetPartPresent(1);
+    layout.SetPartPresent(2);
+
+    std::vector<ObjectExtent> extents;
+    ASSERT_TRUE(layout.MapRange(0, 600, &extents));
+    ASSERT_EQ(5, extents.size());
+    // 分片0
+    ASSERT_TRUE(extents[0].hole);
+    ASSERT_EQ(0, extents[0].chunkOffset);
+    ASSERT_EQ(100, extents[0].length);
+    // 分片1 2合并
+    ASSERT_FALSE(extents[1].hole);
+    ASSERT_EQ(100, extents[1].chunkOffset);
+    ASSERT_EQ(0, extents[1].objectOffset);
+    ASSERT_EQ(200, extents[1].length);
+    // 分片3
+    ASSERT_TRUE(extents[2].hole);
+    ASSERT_EQ(300, extents[2].chunkOffset);
+    ASSERT_EQ(100, extents[2].length);
+    // 分片4
+    ASSERT_FALSE(extents[3].hole);
+    ASSERT_EQ(400, extents[3].chunkOffset);
+    ASSERT_EQ(200, extents[3].objectOffset);
+    ASSERT_EQ(100, extents[3].length);
+    // 分片5
+    ASSERT_TRUE(extents[4].hole);
+    ASSERT_EQ(500, extents[4].chunkOffset);
+    ASSERT_EQ(100, extents[4].length);
+
+    // 分片内部的一段区域
+    ASSERT_TRUE(layout.MapRange(150, 100, &extents));
+    ASSERT_EQ(1, extents.size());
+    ASSERT_FALSE(extents[0].hole);
+    ASSERT_EQ(150, extents[0].chunkOffset);
+    ASSERT_EQ(50, extents[0].objectOffset);
+    ASSERT_EQ(100, extents[0].length);
+
+    // 超出chunk范围
+    ASSERT_FALSE(layout.MapRange(500, 101, &extents));
+    ASSERT_FALSE(ChunkObjectLayout().MapRange(0, 1, &extents));
+}
+
+TEST(ChunkObjectLayoutTest, CompressedPartTest) {
+    // 分片: 0 1 2 3，0为空，1未压缩，2 3压缩后长度分别为30和40
+    ChunkObjectLayout layout(100, 4);
+    layout.SetPartPresent(1);
+    layout.SetPart(2, 30, CompressType::Zlib);
+    layout.SetPart(3, 40, CompressType::Snappy);
+    ASSERT_EQ(170, layout.GetDataLength());
+
+    std::string object(layout.GetDataLength(), 'a');
+    layout.Encode(&object);
+    ChunkObjectLayout decoded;
+    size_t needLen = 0;
+    ASSERT_EQ(LayoutDecodeStatus::OK, ChunkObjectLayout::Decode(
+        object.data(), object.size(), &decoded, &needLen));
+    for (uint32_t i = 0; i < 4; ++i) {
+        ASSERT_EQ(layout.GetStoredLength(i), decoded.GetStoredLength(i));
+        ASSERT_EQ(layout.GetCompressType(i), decoded.GetCompressType(i));
+    }
+
+    std::vector<ObjectExtent> extents;
+    ASSERT_TRUE(decoded.MapRange(50, 300, &extents));
+    ASSERT_EQ(4, extents.size());
+    ASSERT_TRUE(extents[0].hole);
+    ASSERT_EQ(50, extents[0].length);
+    // 未压缩的分片只读取需要的区域
+    ASSERT_FALSE(extents[1].hole);
+    ASSERT_EQ(CompressType::None, extents[1].compressType);
+    ASSERT_EQ(0, extents[1].objectOffset);
+    ASSERT_EQ(100, extents[1].objectLength);
+    // 压缩的分片读取整个分片，不与相邻分片合并
+    ASSERT_EQ(CompressType::Zlib, extents[2].compressType);
+    ASSERT_EQ(200, extents[2].chunkOffset);
+    ASSERT_EQ(100, extents[2].length);
+    ASSERT_EQ(100, extents[2].objectOffset);
+    ASSERT_EQ(30, extents[2].objectLength);
+    ASSERT_EQ(0, extents[2].partOffset);
+    ASSERT_EQ(CompressType::Snappy, extents[3].compressType);
+    ASSERT_EQ(300, extents[3].chunkOffset);
+    ASSERT_EQ(50, extents[3].length);
+    ASSERT_EQ(130, extents[3].objectOffset);
+    ASSERT_EQ(40, extents[3].objectLength);
+    ASSERT_EQ(0, extents[3].partOffset);
+
+    // 压缩分片内部的一段区域
+    ASSERT_TRUE(decoded.MapRange(320, 10, &extents));
+    ASSERT_EQ(1, extents.size());
+    ASSERT_EQ(320, extents[0].chunkOffset);
+    ASSERT_EQ(10, extents[0].length);
+    ASSERT_EQ(40, extents[0].objectLength);
+    ASSERT_EQ(20, extents[0].partOffset);
+
+    // 未压缩的分片长度与分片大小不一致
+    ChunkObjectLayout invalid(100, 2);
+    invalid.SetPart(0, 50, CompressType::None);
+    invalid.SetPart(1, 50, CompressType::Zlib);
+    std::string footer;
+    invalid.Encode(&footer);
+    ASSERT_EQ(LayoutDecodeStatus::Corrupted, ChunkObjectLayout::Decode(
+        footer.data(), footer.size(), &decoded, &needLen));
+}
+
+TEST(ChunkObjectLayoutTest, PartRefTest) {
+    // 分片: 0 1 2 3，0在chunk对象中，1为空，2 3去重存储，3压缩后长度为40
+    std::string hash2(ChunkObjectLayout::kPartHashSize, '\x12');
+    std::string hash3(ChunkObjectLayout::kPartHashSize, '\xab');
+    ChunkObjectLayout layout(100, 4);
+    layout.SetPartPresent(0);
+    layout.SetPartRef(2, 100, CompressType::None, hash2);
+    layout.SetPartRef(3, 40, CompressType::Zlib, hash3);
+    ASSERT_TRUE(layout.HasPartRef());
+    // 去重存储的分片不占用chunk对象的空间
+    ASSERT_EQ(100, layout.GetDataLength());
+
+    std::string object(layout.GetDataLength(), 'a');
+    layout.Encode(&object);
+    ChunkObjectLayout decoded;
+    size_t needLen = 0;
+    ASSERT_EQ(LayoutDecodeStatus::OK, ChunkObjectLayout::Decode(
+        object.data(), object.size(), &decoded, &needLen));
+    ASSERT_TRUE(decoded.GetPartHash(0).empty());
+    ASSERT_TRUE(decoded.GetPartHash(1).empty());
+    ASSERT_EQ(hash2, decoded.GetPartHash(2));
+    ASSERT_EQ(hash3, decoded.GetPartHash(3));
+    ASSERT_EQ(40, decoded.GetStoredLength(3));
+    ASSERT_EQ(CompressType::Zlib, decoded.GetCompressType(3));
+
+    std::vector<ObjectExtent> extents;
+    ASSERT_TRUE(decoded.MapRange(50, 300, &extents));
+    ASSERT_EQ(4, extents.size());
+    ASSERT_TRUE(extents[0].objectKey.empty());
+    ASSERT_EQ(50, extents[0].objectOffset);
+    ASSERT_TRUE(extents[1].hole);
+    // 去重存储的分片从各自的对象中读取，不与相邻分片合并
+    ASSERT_EQ(ChunkObjectLayout::PartObjectKey(hash2), extents[2].objectKey);
+    ASSERT_EQ(0, extents[2].objectOffset);
+    ASSERT_EQ(100, extents[2].objectLength);
+    ASSERT_EQ(ChunkObjectLayout::PartObjectKey(hash3), extents[3].objectKey);
+    ASSERT_EQ(0, extents[3].objectOffset);
+    ASSERT_EQ(40, extents[3].objectLength);
+    ASSERT_EQ(50, extents[3].length);
+
+    ASSERT_TRUE(decoded.MapRange(220, 10, &extents));
+    ASSERT_EQ(1, extents.size());
+    ASSERT_EQ(20, extents[0].objectOffset);
+    ASSERT_EQ(10, extents[0].objectLength);
+
+    ASSERT_EQ("chunkpart-01ab",
+              ChunkObjectLayout::PartObjectKey(std::string("\x01\xab")));
+}
+
+}  // namespace common
+}  // namespace curve
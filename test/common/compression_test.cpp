@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/common/compression.h"
+
+namespace curve {
+namespace common {
+
+TEST(CompressionTest, ParseCompressTypeTest) {
+    CompressType type;
+    ASSERT_TRUE(ParseCompressType("none", &type));
+    ASSERT_EQ(CompressType::None, type);
+    ASSERT_TRUE(ParseCompressType("snappy", &type));
+    ASSERT_EQ(CompressType::Snappy, type);
+    ASSERT_TRUE(ParseCompressType("zlib", &type));
+    ASSERT_EQ(CompressType::Zlib, type);
+    ASSERT_FALSE(ParseCompressType("lz4", &type));
+    ASSERT_STREQ("zlib", CompressTypeName(CompressType::Zlib));
+}
+
+TEST(CompressionTest, CompressDecompressTest) {
+    // 可压缩的数据
+    std::string raw;
+    for (int i = 0; i < 4096; ++i) {
+        raw.append(std::to_string(i % 100));
+    }
+
+    for (auto type : {CompressType::None, CompressType::Snappy,
+                      CompressType::Zlib}) {
+        std::string compressed;
+        ASSERT_TRUE(Compress(type, 6, raw.data(), raw.size(), &compressed));
+        if (type != CompressType::None) {
+            ASSERT_LT(compressed.size(), raw.size());
+        }
+
+        std::vector<char> out(raw.size());
+        ASSERT_TRUE(Decompress(type, compressed.data(), compressed.size(),
+                               out.data(), out.size()));
+        ASSERT_EQ(raw, std::string(out.data(), out.size()));
+
+        // 解压后的长度与预期不一致
+        ASSERT_FALSE(Decompress(type, compressed.data(), compressed.size(),
+                                out.data(), out.size() - 1));
+    }
+
+    // 数据损坏
+    std::string compressed;
+    ASSERT_TRUE(Compress(CompressType::Zlib, 1, raw.data(), raw.size(),
+                         &compressed));
+    compressed[compressed.size() / 2] ^= 0xff;
+    std::vector<char> out(raw.size());
+    ASSERT_FALSE(Decompress(CompressType::Zlib, compressed.data(),
+                            compressed.size(), out.data(), out.size()));
+}
+
+}  // namespace common
+}  // namespace curve
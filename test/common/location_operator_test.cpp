@@ -35,6 +35,9 @@ TEST(LocationOperatorTest, GenerateTest) {
 
     location = LocationOperator::GenerateCurveLocation("test", 0);
     ASSERT_STREQ("test:0@cs", location.c_str());
+
+    location = LocationOperator::GenerateS3PackLocation("test", 4096, 100);
+    ASSERT_STREQ("test:4096:100@s3pack", location.c_str());
 }
 
 TEST(LocationOperatorTest, GenerateCurveLocationTest) {
@@ -71,6 +74,11 @@ TEST(LocationOperatorTest, GenerateCurveLocationTest) {
     location = "test@test@cs";
     ASSERT_EQ(OriginType::CurveOrigin,
               LocationOperator::ParseLocation(location, nullptr));
+
+    location = "test:0:1@s3pack";
+    ASSERT_EQ(OriginType::S3PackOrigin,
+              LocationOperator::ParseLocation(location, &originPath));
+    ASSERT_STREQ(originPath.c_str(), "test:0:1");
 }
 
 TEST(LocationOperatorTest, ParseCurvePathTest) {
@@ -107,5 +115,43 @@ TEST(LocationOperatorTest, ParseCurvePathTest) {
         LocationOperator::ParseCurveChunkPath(originPath, nullptr, nullptr));
 }
 
+TEST(LocationOperatorTest, ParseS3PackPathTest) {
+    std::string originPath;
+    std::string objectName;
+    uint64_t offset;
+    uint64_t length;
+
+    originPath = "test:0";
+    ASSERT_FALSE(LocationOperator::ParseS3PackPath(
+        originPath, &objectName, &offset, &length));
+
+    originPath = ":0:1";
+    ASSERT_FALSE(LocationOperator::ParseS3PackPath(
+        originPath, &objectName, &offset, &length));
+
+    originPath = "test::1";
+    ASSERT_FALSE(LocationOperator::ParseS3PackPath(
+        originPath, &objectName, &offset, &length));
+
+    originPath = "test:a:1";
+    ASSERT_FALSE(LocationOperator::ParseS3PackPath(
+        originPath, &objectName, &offset, &length));
+
+    originPath = "test:4096:100";
+    ASSERT_TRUE(LocationOperator::ParseS3PackPath(
+        originPath, &objectName, &offset, &length));
+    ASSERT_STREQ(objectName.c_str(), "test");
+    ASSERT_EQ(4096, offset);
+    ASSERT_EQ(100, length);
+
+    originPath = "test:1:4096:100";
+    ASSERT_TRUE(LocationOperator::ParseS3PackPath(
+        originPath, &objectName, &offset, &length));
+    ASSERT_STREQ(objectName.c_str(), "test:1");
+
+    ASSERT_TRUE(LocationOperator::ParseS3PackPath(
+        originPath, nullptr, nullptr, nullptr));
+}
+
 }  // namespace common
 }  // namespace curve
@@ -52,6 +52,9 @@ class MockS3Adapter : public S3Adapter {
                                 char *,
                                 off_t,
                                 size_t));
+    MOCK_METHOD3(GetObjectTail, int(const std::string &,
+                                    size_t,
+                                    std::string *));
     MOCK_METHOD1(GetObjectAsync, void(std::shared_ptr<GetObjectAsyncContext>));
     MOCK_METHOD1(DeleteObject, int(const Aws::String &));
     MOCK_METHOD1(ObjectExist, bool(const Aws::String &));
@@ -74,6 +77,8 @@ class MockS3Adapter : public S3Adapter {
             const Aws::Vector<Aws::S3::Model::CompletedPart> &));
     MOCK_METHOD2(AbortMultiUpload, int(const Aws::String &,
                                            const Aws::String &));
+    MOCK_METHOD2(ListMultiUploads, int(const Aws::String &,
+        std::vector<std::pair<Aws::String, Aws::String>> *));
 };
 }  // namespace common
 }  // namespace curve
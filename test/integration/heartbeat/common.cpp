@@ -245,6 +245,14 @@ void HeartbeatIntegrationCommon::InitHeartbeatOption(
         conf->GetIntValue("mds.heartbeat.offlinetimeoutMs");
     heartbeatOption->cleanFollowerAfterMs =
         conf->GetIntValue("mds.heartbeat.clean_follower_afterMs");
+    if (!conf->GetUInt32Value("mds.heartbeat.workerNum",
+                              &heartbeatOption->workerNum)) {
+        heartbeatOption->workerNum = 0;
+    }
+    if (!conf->GetUInt32Value("mds.heartbeat.workerQueueCapacity",
+                              &heartbeatOption->workerQueueCapacity)) {
+        heartbeatOption->workerQueueCapacity = 1024;
+    }
 }
 
 void HeartbeatIntegrationCommon::InitSchedulerOption(
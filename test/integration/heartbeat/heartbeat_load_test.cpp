@@ -0,0 +1,219 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "test/integration/heartbeat/common.h"
+
+DEFINE_uint32(hb_load_chunkserver_num, 3000,
+              "number of chunkservers simulated, should be multiple of 3");
+DEFINE_uint32(hb_load_copyset_per_chunkserver, 100,
+              "number of copysets on each chunkserver");
+DEFINE_uint32(hb_load_round, 10, "rounds of heartbeats of each chunkserver");
+DEFINE_uint32(hb_load_client_thread, 64,
+              "number of threads sending heartbeats");
+DEFINE_uint32(hb_load_worker_num, 8,
+              "number of mds workers handling heartbeats, 0 for inline");
+
+namespace curve {
+namespace mds {
+
+// 压测mds心跳处理: 模拟大量chunkserver并发上报心跳, 统计吞吐和延迟
+// 默认不运行, 通过--gtest_also_run_disabled_tests执行
+class HeartbeatLoadTest : public ::testing::Test {
+ protected:
+    void InitConfiguration(Configuration *conf) {
+        conf->SetIntValue("mds.topology.ChunkServerStateUpdateSec", 0);
+        conf->SetIntValue("mds.topology.TopologyUpdateToRepoSec", 60);
+
+        // 心跳间隔设置较大, 避免压测过程中chunkserver被标记为offline
+        conf->SetIntValue("mds.heartbeat.intervalMs", 10000);
+        conf->SetIntValue("mds.heartbeat.misstimeoutMs", 30000);
+        conf->SetIntValue("mds.heartbeat.offlinetimeoutMs", 1800000);
+        conf->SetIntValue("mds.heartbeat.clean_follower_afterMs", 0);
+        conf->SetIntValue("mds.heartbeat.workerNum", FLAGS_hb_load_worker_num);
+        conf->SetIntValue("mds.heartbeat.workerQueueCapacity", 1024);
+
+        conf->SetStringValue("mds.listen.addr", "127.0.0.1:6881");
+
+        // 关闭调度
+        conf->SetBoolValue("mds.enable.copyset.scheduler", false);
+        conf->SetBoolValue("mds.enable.leader.scheduler", false);
+        conf->SetBoolValue("mds.enable.recover.scheduler", false);
+        conf->SetBoolValue("mds.replica.replica.scheduler", false);
+
+        conf->SetIntValue("mds.copyset.scheduler.intervalSec", 300);
+        conf->SetIntValue("mds.leader.scheduler.intervalSec", 300);
+        conf->SetIntValue("mds.recover.scheduler.intervalSec", 300);
+        conf->SetIntValue("mds.replica.scheduler.intervalSec", 300);
+
+        conf->SetIntValue("mds.schduler.operator.concurrent", 4);
+        conf->SetIntValue("mds.schduler.transfer.limitSec", 10);
+        conf->SetIntValue("mds.scheduler.add.limitSec", 10);
+        conf->SetIntValue("mds.scheduler.remove.limitSec", 10);
+        conf->SetDoubleValue("mds.scheduler.copysetNumRangePercent", 0.05);
+        conf->SetDoubleValue("mds.schduler.scatterWidthRangePerent", 0.2);
+        conf->SetIntValue("mds.scheduler.minScatterWidth", 50);
+    }
+
+    // 在basic集群的3个server上添加chunkserver, 每3个分布在不同zone的
+    // chunkserver组成一组, 组内创建copyset, leader在组内轮流分布
+    void PrepareLoadCluster() {
+        const uint32_t groupNum = FLAGS_hb_load_chunkserver_num / 3;
+        const uint32_t copysetNum = FLAGS_hb_load_copyset_per_chunkserver;
+        for (uint32_t g = 0; g < groupNum; ++g) {
+            std::set<ChunkServerIdType> members;
+            for (uint32_t z = 1; z <= 3; ++z) {
+                ChunkServerIdType id = kBaseChunkServerId + g * 3 + z - 1;
+                ChunkServer cs(id, "testToken", "nvme", z,
+                               "10.198.100." + std::to_string(z),
+                               kBasePort + g, "/");
+                hbtest_->PrepareAddChunkServer(cs);
+                members.emplace(id);
+            }
+            for (uint32_t c = 0; c < copysetNum; ++c) {
+                CopySetIdType copysetId = kBaseCopysetId + g * copysetNum + c;
+                hbtest_->PrepareAddCopySet(copysetId, 1, members);
+                hbtest_->UpdateCopysetTopo(copysetId, 1, 1,
+                    kBaseChunkServerId + g * 3 + c % 3, members);
+            }
+        }
+    }
+
+    void BuildRequests() {
+        const uint32_t copysetNum = FLAGS_hb_load_copyset_per_chunkserver;
+        requests_.resize(FLAGS_hb_load_chunkserver_num);
+        for (uint32_t i = 0; i < FLAGS_hb_load_chunkserver_num; ++i) {
+            ChunkServerIdType id = kBaseChunkServerId + i;
+            uint32_t g = i / 3;
+            auto *req = &requests_[i];
+            hbtest_->BuildBasicChunkServerRequest(id, req);
+            for (uint32_t c = 0; c < copysetNum; ++c) {
+                CopySetIdType copysetId = kBaseCopysetId + g * copysetNum + c;
+                ::curve::mds::topology::CopySetInfo info;
+                ASSERT_TRUE(hbtest_->topology_->GetCopySet(
+                    CopySetKey{1, copysetId}, &info));
+                hbtest_->AddCopySetToRequest(req, info);
+            }
+            req->set_copysetcount(copysetNum);
+        }
+    }
+
+    void SetUp() override {
+        Configuration conf;
+        InitConfiguration(&conf);
+        hbtest_ = std::make_shared<HeartbeatIntegrationCommon>(conf);
+        hbtest_->BuildBasicCluster();
+        PrepareLoadCluster();
+        BuildRequests();
+    }
+
+    void TearDown() override {
+        ASSERT_EQ(0, hbtest_->server_.Stop(100));
+        ASSERT_EQ(0, hbtest_->server_.Join());
+    }
+
+ protected:
+    static const ChunkServerIdType kBaseChunkServerId = 100;
+    static const CopySetIdType kBaseCopysetId = 100;
+    static const uint32_t kBasePort = 10000;
+
+    std::shared_ptr<HeartbeatIntegrationCommon> hbtest_;
+    std::vector<ChunkServerHeartbeatRequest> requests_;
+};
+
+TEST_F(HeartbeatLoadTest, DISABLED_heartbeat_throughput) {
+    brpc::Channel channel;
+    ASSERT_EQ(0, channel.Init(hbtest_->listenAddr_.c_str(), NULL));
+
+    const uint32_t threadNum = FLAGS_hb_load_client_thread;
+    std::vector<std::vector<uint64_t>> latencies(threadNum);
+    std::atomic<uint64_t> failed(0);
+    std::vector<std::thread> threads;
+    uint64_t startUs = curve::common::TimeUtility::GetTimeofDayUs();
+    for (uint32_t t = 0; t < threadNum; ++t) {
+        threads.emplace_back([&, t]() {
+            HeartbeatService_Stub stub(&channel);
+            for (uint32_t r = 0; r < FLAGS_hb_load_round; ++r) {
+                for (size_t i = t; i < requests_.size(); i += threadNum) {
+                    brpc::Controller cntl;
+                    cntl.set_timeout_ms(10000);
+                    ChunkServerHeartbeatResponse response;
+                    uint64_t beginUs =
+                        curve::common::TimeUtility::GetTimeofDayUs();
+                    stub.ChunkServerHeartbeat(
+                        &cntl, &requests_[i], &response, NULL);
+                    if (cntl.Failed() || response.statuscode() !=
+                        ::curve::mds::heartbeat::HeartbeatStatusCode::hbOK) {
+                        failed.fetch_add(1);
+                        continue;
+                    }
+                    latencies[t].push_back(
+                        curve::common::TimeUtility::GetTimeofDayUs() -
+                        beginUs);
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    uint64_t elapsedUs =
+        curve::common::TimeUtility::GetTimeofDayUs() - startUs;
+
+    std::vector<uint64_t> all;
+    for (auto &l : latencies) {
+        all.insert(all.end(), l.begin(), l.end());
+    }
+    ASSERT_EQ(0, failed.load());
+    ASSERT_FALSE(all.empty());
+    std::sort(all.begin(), all.end());
+    uint64_t sum = 0;
+    for (auto l : all) {
+        sum += l;
+    }
+
+    LOG(INFO) << "heartbeat load: chunkservers = "
+              << FLAGS_hb_load_chunkserver_num
+              << ", copysets per chunkserver = "
+              << FLAGS_hb_load_copyset_per_chunkserver
+              << ", client threads = " << threadNum
+              << ", mds workers = " << FLAGS_hb_load_worker_num
+              << ", heartbeats = " << all.size()
+              << ", qps = " << all.size() * 1000000 / std::max<uint64_t>(
+                                   elapsedUs, 1)
+              << ", avg latency us = " << sum / all.size()
+              << ", p99 latency us = " << all[all.size() * 99 / 100]
+              << ", max latency us = " << all.back();
+}
+
+}  // namespace mds
+}  // namespace curve
@@ -225,6 +225,34 @@ int FakeCurveFsClient::RecoverChunk(
     return LIBCURVE_ERROR::OK;
 }
 
+int FakeCurveFsClient::CreateCloneChunks(
+    std::vector<ChunkBatchItem> *items,
+    uint64_t csn,
+    uint64_t chunkSize,
+    SnapCloneClosure *scc) {
+    for (auto &item : *items) {
+        item.retCode = LIBCURVE_ERROR::OK;
+    }
+    scc->SetRetCode(LIBCURVE_ERROR::OK);
+    scc->Run();
+    fiu_return_on(
+        "test/integration/snapshotcloneserver/FakeCurveFsClient.CreateCloneChunks", -LIBCURVE_ERROR::FAILED);  // NOLINT
+    return LIBCURVE_ERROR::OK;
+}
+
+int FakeCurveFsClient::RecoverChunks(
+    std::vector<ChunkBatchItem> *items,
+    SnapCloneClosure *scc) {
+    for (auto &item : *items) {
+        item.retCode = LIBCURVE_ERROR::OK;
+    }
+    scc->SetRetCode(LIBCURVE_ERROR::OK);
+    scc->Run();
+    fiu_return_on(
+        "test/integration/snapshotcloneserver/FakeCurveFsClient.RecoverChunks", -LIBCURVE_ERROR::FAILED);  // NOLINT
+    return LIBCURVE_ERROR::OK;
+}
+
 int FakeCurveFsClient::CompleteCloneMeta(
     const std::string &filename,
     const std::string &user) {
@@ -110,6 +110,16 @@ class FakeCurveFsClient : public CurveFsClient {
         uint64_t len,
         SnapCloneClosure *scc) override;
 
+    int CreateCloneChunks(
+        std::vector<ChunkBatchItem> *items,
+        uint64_t csn,
+        uint64_t chunkSize,
+        SnapCloneClosure *scc) override;
+
+    int RecoverChunks(
+        std::vector<ChunkBatchItem> *items,
+        SnapCloneClosure *scc) override;
+
     int CompleteCloneMeta(
         const std::string &filename,
         const std::string &user) override;
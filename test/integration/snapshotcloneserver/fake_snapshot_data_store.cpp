@@ -60,6 +60,25 @@ int FakeSnapshotDataStore::DeleteChunkIndexData(
         "test/integration/snapshotcloneserver/FakeSnapshotDataStore.DeleteChunkIndexData", -1);  // NOLINT
     std::string key = name.ToIndexDataChunkKey();
     indexDataMap_.erase(key);
+    hotIndexMap_.erase(name.ToHotChunkIndexKey());
+    return 0;
+}
+
+int FakeSnapshotDataStore::PutHotChunkIndex(const ChunkIndexDataName &name,
+    const std::vector<ChunkIndexType> &indexes) {
+    std::lock_guard<std::mutex> guard(indexMapMutex_);
+    hotIndexMap_[name.ToHotChunkIndexKey()] = indexes;
+    return 0;
+}
+
+int FakeSnapshotDataStore::GetHotChunkIndex(const ChunkIndexDataName &name,
+    std::vector<ChunkIndexType> *indexes) {
+    std::lock_guard<std::mutex> guard(indexMapMutex_);
+    indexes->clear();
+    auto it = hotIndexMap_.find(name.ToHotChunkIndexKey());
+    if (it != hotIndexMap_.end()) {
+        *indexes = it->second;
+    }
     return 0;
 }
 
@@ -110,5 +129,19 @@ int FakeSnapshotDataStore::DataChunkTranferAbort(const ChunkDataName &name,
     return 0;
 }
 
+std::shared_ptr<ChunkPackWriter> FakeSnapshotDataStore::NewChunkPackWriter(
+    const std::string &prefix) {
+    return nullptr;
+}
+
+int FakeSnapshotDataStore::GetChunkPackData(
+    const ChunkPackLocation &location, std::string *data) {
+    return -1;
+}
+
+int FakeSnapshotDataStore::DeleteChunkPack(const std::string &packKey) {
+    return 0;
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
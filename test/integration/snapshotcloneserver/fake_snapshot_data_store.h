@@ -42,6 +42,10 @@ class FakeSnapshotDataStore : public SnapshotDataStore {
                           ChunkIndexData *meta) override;
     int DeleteChunkIndexData(const ChunkIndexDataName &name) override;
     bool ChunkIndexDataExist(const ChunkIndexDataName &name) override;
+    int PutHotChunkIndex(const ChunkIndexDataName &name,
+        const std::vector<ChunkIndexType> &indexes) override;
+    int GetHotChunkIndex(const ChunkIndexDataName &name,
+        std::vector<ChunkIndexType> *indexes) override;
 
     int DeleteChunkData(const ChunkDataName &name) override;
     bool ChunkDataExist(const ChunkDataName &name) override;
@@ -57,9 +61,15 @@ class FakeSnapshotDataStore : public SnapshotDataStore {
                                 std::shared_ptr<TransferTask> task) override;
     int DataChunkTranferAbort(const ChunkDataName &name,
                                std::shared_ptr<TransferTask> task) override;
+    std::shared_ptr<ChunkPackWriter> NewChunkPackWriter(
+        const std::string &prefix) override;
+    int GetChunkPackData(const ChunkPackLocation &location,
+                         std::string *data) override;
+    int DeleteChunkPack(const std::string &packKey) override;
 
  private:
     std::map<std::string, ChunkIndexData> indexDataMap_;
+    std::map<std::string, std::vector<ChunkIndexType>> hotIndexMap_;
     std::mutex indexMapMutex_;
     std::set<std::string> chunkData_;
     std::mutex chunkDataMutex_;
@@ -181,7 +181,71 @@ int FakeSnapshotCloneMetaStore::GetCloneInfoList(
     return -1;
 }
 
+int FakeSnapshotCloneMetaStore::GetChunkPartRef(const std::string &hash,
+    ChunkPartRefInfo *info) {
+    std::lock_guard<std::mutex> guard(chunkPartRefs_mutex);
+    auto search = chunkPartRefs_.find(hash);
+    if (search != chunkPartRefs_.end()) {
+        *info = search->second;
+    } else {
+        *info = ChunkPartRefInfo();
+        info->hash = hash;
+    }
+    return 0;
+}
+
+int FakeSnapshotCloneMetaStore::AddChunkPartRefs(
+    const std::string &chunkName,
+    const std::map<int, ChunkPartRefInfo> &parts) {
+    std::lock_guard<std::mutex> guard(chunkPartRefs_mutex);
+    for (const auto &part : parts) {
+        chunkPartRefs_[part.second.hash] = part.second;
+        chunkRefs_[part.second.hash].emplace(chunkName, part.first);
+    }
+    return 0;
+}
+
+int FakeSnapshotCloneMetaStore::RemoveChunkPartRefs(
+    const std::string &chunkName,
+    const std::map<int, std::string> &parts) {
+    std::lock_guard<std::mutex> guard(chunkPartRefs_mutex);
+    for (const auto &part : parts) {
+        auto search = chunkRefs_.find(part.second);
+        if (search == chunkRefs_.end()) {
+            continue;
+        }
+        search->second.erase(std::make_pair(chunkName, part.first));
+        if (search->second.empty()) {
+            chunkRefs_.erase(search);
+        }
+    }
+    return 0;
+}
 
+int FakeSnapshotCloneMetaStore::HasChunkPartRef(const std::string &hash,
+    bool *referenced) {
+    std::lock_guard<std::mutex> guard(chunkPartRefs_mutex);
+    *referenced = chunkRefs_.count(hash) != 0;
+    return 0;
+}
+
+int FakeSnapshotCloneMetaStore::DeleteChunkPartRef(const std::string &hash) {
+    std::lock_guard<std::mutex> guard(chunkPartRefs_mutex);
+    chunkPartRefs_.erase(hash);
+    return 0;
+}
+
+int FakeSnapshotCloneMetaStore::SetChunkDedupFlag() {
+    std::lock_guard<std::mutex> guard(chunkPartRefs_mutex);
+    chunkDedupFlag_ = true;
+    return 0;
+}
+
+int FakeSnapshotCloneMetaStore::GetChunkDedupFlag(bool *everEnabled) {
+    std::lock_guard<std::mutex> guard(chunkPartRefs_mutex);
+    *everEnabled = chunkDedupFlag_;
+    return 0;
+}
 
 }  // namespace snapshotcloneserver
 }  // namespace curve
@@ -26,6 +26,8 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <set>
+#include <utility>
 
 #include "src/snapshotcloneserver/common/snapshotclone_meta_store.h"
 
@@ -57,12 +59,35 @@ class FakeSnapshotCloneMetaStore : public SnapshotCloneMetaStore {
 
     int GetCloneInfoList(std::vector<CloneInfo> *list) override;
 
+    int GetChunkPartRef(const std::string &hash,
+                        ChunkPartRefInfo *info) override;
+
+    int AddChunkPartRefs(const std::string &chunkName,
+        const std::map<int, ChunkPartRefInfo> &parts) override;
+
+    int RemoveChunkPartRefs(const std::string &chunkName,
+        const std::map<int, std::string> &parts) override;
+
+    int HasChunkPartRef(const std::string &hash, bool *referenced) override;
+
+    int DeleteChunkPartRef(const std::string &hash) override;
+
+    int SetChunkDedupFlag() override;
+
+    int GetChunkDedupFlag(bool *everEnabled) override;
+
  private:
     std::map<UUID, SnapshotInfo> snapInfos_;
     std::mutex snapInfos_mutex;
 
     std::map<std::string, CloneInfo> cloneInfos_;
     curve::common::RWLock cloneInfos_lock_;
+
+    std::map<std::string, ChunkPartRefInfo> chunkPartRefs_;
+    // 分片数据的sha256 <=> 引用它的(chunk对象名, 分片序号)
+    std::map<std::string, std::set<std::pair<std::string, int>>> chunkRefs_;
+    std::mutex chunkPartRefs_mutex;
+    bool chunkDedupFlag_ = false;
 };
 
 
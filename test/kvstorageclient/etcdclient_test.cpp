@@ -37,6 +37,7 @@ namespace curve {
 namespace kvstorage {
 
 using ::curve::kvstorage::EtcdClientImp;
+using ::curve::kvstorage::WatchEvent;
 using ::curve::mds::FileInfo;
 using ::curve::mds::FileType;
 using ::curve::mds::NameSpaceStorageCodec;
@@ -288,7 +289,31 @@ TEST_F(TestEtcdClinetImp, test_EtcdClientInterface) {
     ops.emplace_back(op9);
     ASSERT_EQ(EtcdErrCode::EtcdInvalidArgument, client_->TxnN(ops));
 
-    // 10. abnormal
+    // 10. TxnNWithRevision, more than 3 operations
+    std::vector<std::string> batchKeys{"batch1", "batch2", "batch3", "batch4"};
+    ops.clear();
+    for (auto &key : batchKeys) {
+        ops.emplace_back(Operation{ OpType::OpPut,
+                                    const_cast<char *>(key.c_str()),
+                                    const_cast<char *>(key.c_str()),
+                                    static_cast<int>(key.size()),
+                                    static_cast<int>(key.size()) });
+    }
+    int64_t txnRevision = 0;
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->TxnNWithRevision(ops, &txnRevision));
+    int64_t curRevision = 0;
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client_->GetCurrentRevision(&curRevision));
+    ASSERT_EQ(curRevision, txnRevision);
+    for (auto &key : batchKeys) {
+        ASSERT_EQ(EtcdErrCode::EtcdOK, client_->Get(key, &out));
+        ASSERT_EQ(key, out);
+    }
+    ops.clear();
+    ASSERT_EQ(EtcdErrCode::EtcdInvalidArgument,
+              client_->TxnNWithRevision(ops, &txnRevision));
+
+    // 11. abnormal
     ops.clear();
     ops.emplace_back(op3);
     ops.emplace_back(op4);
@@ -378,6 +403,57 @@ TEST_F(TestEtcdClinetImp, test_return_with_revision) {
     ASSERT_EQ(startRevision + 2, revision);
 }
 
+TEST_F(TestEtcdClinetImp, test_WatchWithPrefix) {
+    int64_t startRevision;
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client_->GetCurrentRevision(&startRevision));
+
+    int64_t putRevision, deleteRevision;
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->PutRewithRevision("watch1", "v1", &putRevision));
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->Put("other", "v2"));
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->DeleteRewithRevision("watch1", &deleteRevision));
+
+    // changes before the watch starts are returned at once
+    std::vector<WatchEvent> events;
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->WatchWithPrefix("watch", startRevision + 1, 1000,
+                                       &events));
+    ASSERT_EQ(2, events.size());
+    ASSERT_EQ(OpType::OpPut, events[0].type);
+    ASSERT_EQ("watch1", events[0].key);
+    ASSERT_EQ("v1", events[0].value);
+    ASSERT_EQ(putRevision, events[0].revision);
+    ASSERT_EQ(OpType::OpDelete, events[1].type);
+    ASSERT_EQ(deleteRevision, events[1].revision);
+
+    // nothing changed, returns after timeout
+    ASSERT_EQ(EtcdErrCode::EtcdWatchTimeout,
+              client_->WatchWithPrefix("watch", deleteRevision + 1, 100,
+                                       &events));
+    ASSERT_TRUE(events.empty());
+
+    // keys at the revisions
+    int64_t count;
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->CountWithRevision("watch", "watci", putRevision, 0,
+                                         &count));
+    ASSERT_EQ(1, count);
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->CountWithRevision("watch", "watci", deleteRevision, 0,
+                                         &count));
+    ASSERT_EQ(0, count);
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->CountWithRevision("watch", "watci", putRevision,
+                                         putRevision + 1, &count));
+    ASSERT_EQ(0, count);
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client_->CountWithRevision("watch", "watci", putRevision,
+                                         startRevision + 1, &count));
+    ASSERT_EQ(1, count);
+}
+
 TEST_F(TestEtcdClinetImp, test_CampaignLeader) {
     std::string pfx("/leadere-election/");
     int sessionnInterSec = 1;
@@ -23,6 +23,8 @@
 #include <gtest/gtest.h>
 #include <glog/logging.h>
 #include <sys/time.h>
+#include <atomic>
+#include <future>  // NOLINT
 #include "src/mds/heartbeat/heartbeat_manager.h"
 #include "src/mds/heartbeat/chunkserver_healthy_checker.h"
 #include "src/common/timeutility.h"
@@ -35,12 +37,26 @@ using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
 using ::testing::_;
+using ::testing::Invoke;
 using ::curve::mds::topology::MockTopology;
 using ::curve::mds::topology::MockTopologyStat;
+using ::curve::mds::topology::ChunkServerStat;
 
 namespace curve {
 namespace mds {
 namespace heartbeat {
+class CountClosure : public google::protobuf::Closure {
+ public:
+    explicit CountClosure(std::atomic<int> *count) : count_(count) {}
+    void Run() override {
+        count_->fetch_add(1);
+        delete this;
+    }
+
+ private:
+    std::atomic<int> *count_;
+};
+
 class TestHeartbeatManager : public ::testing::Test {
  protected:
   TestHeartbeatManager() {}
@@ -934,6 +950,286 @@ TEST_F(TestHeartbeatManager, test_patrol_copySetInfo_return_order) {
     ASSERT_EQ(TRANSFER_LEADER, response.needupdatecopysets(0).type());
     ASSERT_EQ(3, response.needupdatecopysets(0).peers_size());
 }
+TEST_F(TestHeartbeatManager, test_delta_heartbeat) {
+    ::curve::mds::topology::ChunkServer chunkServer1(
+        1, "hello", "", 1, "192.168.10.1", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    ::curve::mds::topology::ChunkServer chunkServer2(
+        2, "hello", "", 1, "192.168.10.2", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    ::curve::mds::topology::ChunkServer chunkServer3(
+        3, "hello", "", 1, "192.168.10.3", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    EXPECT_CALL(*topology_, GetChunkServer(1, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(chunkServer1), Return(true)));
+    ::curve::mds::topology::CopySetInfo copySetInfo(1, 1);
+    copySetInfo.SetEpoch(10);
+    copySetInfo.SetLeader(1);
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copySetInfo), Return(true)));
+    std::vector<ChunkServerStat> stats;
+    EXPECT_CALL(*topologyStat_, UpdateChunkServerStat(1, _))
+        .WillRepeatedly(Invoke(
+            [&](ChunkServerIdType, const ChunkServerStat &stat) {
+                stats.push_back(stat);
+            }));
+
+    // 1. full report, copyset(1,1) led by chunkserver1 is recorded
+    auto request = GetChunkServerHeartbeatRequestForTest();
+    request.set_reportversion(1);
+    {
+        ChunkServerHeartbeatResponse response;
+        EXPECT_CALL(*topology_, GetChunkServerNotRetired(_, _, _))
+            .WillOnce(DoAll(SetArgPointee<2>(chunkServer1), Return(true)))
+            .WillOnce(DoAll(SetArgPointee<2>(chunkServer2), Return(true)))
+            .WillOnce(DoAll(SetArgPointee<2>(chunkServer3), Return(true)));
+        EXPECT_CALL(*coordinator_, CopySetHeartbeat(_, _, _))
+            .WillOnce(Return(::curve::mds::topology::UNINTIALIZE_ID));
+        heartbeatManager_->ChunkServerHeartbeat(request, &response);
+        ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
+        ASSERT_FALSE(response.needfullreport());
+        ASSERT_EQ(1, stats.back().copysetStats.size());
+    }
+
+    // 2. delta report without changed copyset, unchanged copyset is only
+    //    passed to coordinator when it has operator
+    request.clear_copysetinfos();
+    request.set_reportversion(2);
+    request.set_baseversion(1);
+    {
+        ChunkServerHeartbeatResponse response;
+        EXPECT_CALL(*coordinator_, HasOperator(CopySetKey(1, 1)))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*coordinator_, CopySetHeartbeat(_, _, _)).Times(0);
+        heartbeatManager_->ChunkServerHeartbeat(request, &response);
+        ASSERT_EQ(HeartbeatStatusCode::hbOK, response.statuscode());
+        ASSERT_FALSE(response.needfullreport());
+        // stats of unchanged copyset are kept
+        ASSERT_EQ(1, stats.back().copysetStats.size());
+    }
+    request.set_reportversion(3);
+    request.set_baseversion(2);
+    {
+        ChunkServerHeartbeatResponse response;
+        EXPECT_CALL(*coordinator_, HasOperator(CopySetKey(1, 1)))
+            .WillOnce(Return(true));
+        EXPECT_CALL(*coordinator_, CopySetHeartbeat(_, _, _))
+            .WillOnce(Return(::curve::mds::topology::UNINTIALIZE_ID));
+        heartbeatManager_->ChunkServerHeartbeat(request, &response);
+        ASSERT_FALSE(response.needfullreport());
+    }
+
+    // 3. copyset removed
+    request.set_reportversion(4);
+    request.set_baseversion(3);
+    auto removed = request.add_removedcopysets();
+    removed->set_logicalpoolid(1);
+    removed->set_copysetid(1);
+    {
+        ChunkServerHeartbeatResponse response;
+        EXPECT_CALL(*coordinator_, HasOperator(_)).Times(0);
+        heartbeatManager_->ChunkServerHeartbeat(request, &response);
+        ASSERT_FALSE(response.needfullreport());
+        ASSERT_EQ(0, stats.back().copysetStats.size());
+    }
+
+    // 4. delta not based on applied version, ask for full report
+    request.clear_removedcopysets();
+    request.set_reportversion(6);
+    request.set_baseversion(5);
+    {
+        ChunkServerHeartbeatResponse response;
+        heartbeatManager_->ChunkServerHeartbeat(request, &response);
+        ASSERT_TRUE(response.needfullreport());
+    }
+    // applied version is reset, following delta is rejected too
+    request.set_reportversion(5);
+    request.set_baseversion(4);
+    {
+        ChunkServerHeartbeatResponse response;
+        heartbeatManager_->ChunkServerHeartbeat(request, &response);
+        ASSERT_TRUE(response.needfullreport());
+    }
+}
+
+TEST_F(TestHeartbeatManager, test_prune_chunkserver_reports) {
+    ::curve::mds::topology::ChunkServer chunkServer1(
+        1, "hello", "", 1, "192.168.10.1", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    ::curve::mds::topology::ChunkServer chunkServer2(
+        2, "hello", "", 1, "192.168.10.2", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    ::curve::mds::topology::ChunkServer chunkServer3(
+        3, "hello", "", 1, "192.168.10.3", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+    EXPECT_CALL(*topology_, GetChunkServer(1, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(chunkServer1), Return(true)));
+    ::curve::mds::topology::CopySetInfo copySetInfo(1, 1);
+    copySetInfo.SetEpoch(10);
+    copySetInfo.SetLeader(1);
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copySetInfo), Return(true)));
+    EXPECT_CALL(*topologyStat_, UpdateChunkServerStat(1, _))
+        .WillRepeatedly(Return());
+    EXPECT_CALL(*coordinator_, HasOperator(_))
+        .WillRepeatedly(Return(false));
+
+    // no report, topology is not queried
+    EXPECT_CALL(*topology_, GetChunkServerInCluster(_)).Times(0);
+    heartbeatManager_->PruneChunkServerReports();
+
+    // full report of chunkserver1
+    auto request = GetChunkServerHeartbeatRequestForTest();
+    request.set_reportversion(1);
+    {
+        ChunkServerHeartbeatResponse response;
+        EXPECT_CALL(*topology_, GetChunkServerNotRetired(_, _, _))
+            .WillOnce(DoAll(SetArgPointee<2>(chunkServer1), Return(true)))
+            .WillOnce(DoAll(SetArgPointee<2>(chunkServer2), Return(true)))
+            .WillOnce(DoAll(SetArgPointee<2>(chunkServer3), Return(true)));
+        EXPECT_CALL(*coordinator_, CopySetHeartbeat(_, _, _))
+            .WillOnce(Return(::curve::mds::topology::UNINTIALIZE_ID));
+        heartbeatManager_->ChunkServerHeartbeat(request, &response);
+        ASSERT_FALSE(response.needfullreport());
+    }
+
+    // chunkserver1 is still in cluster, its report is kept
+    request.clear_copysetinfos();
+    request.set_reportversion(2);
+    request.set_baseversion(1);
+    {
+        EXPECT_CALL(*topology_, GetChunkServerInCluster(_))
+            .WillOnce(Return(std::vector<ChunkServerIdType>{1, 2}));
+        heartbeatManager_->PruneChunkServerReports();
+
+        ChunkServerHeartbeatResponse response;
+        heartbeatManager_->ChunkServerHeartbeat(request, &response);
+        ASSERT_FALSE(response.needfullreport());
+    }
+
+    // chunkserver1 is retired or removed, its report is dropped
+    request.set_reportversion(3);
+    request.set_baseversion(2);
+    {
+        EXPECT_CALL(*topology_, GetChunkServerInCluster(_))
+            .WillOnce(Return(std::vector<ChunkServerIdType>{2}));
+        heartbeatManager_->PruneChunkServerReports();
+
+        ChunkServerHeartbeatResponse response;
+        heartbeatManager_->ChunkServerHeartbeat(request, &response);
+        ASSERT_TRUE(response.needfullreport());
+    }
+}
+
+TEST_F(TestHeartbeatManager, test_async_heartbeat_in_workers) {
+    HeartbeatOption option;
+    option.cleanFollowerAfterMs = 0;
+    option.heartbeatMissTimeOutMs = 10000;
+    option.offLineTimeOutMs = 30000;
+    option.mdsStartTime = steady_clock::now();
+    option.workerNum = 4;
+    option.workerQueueCapacity = 100;
+    heartbeatManager_ = std::make_shared<HeartbeatManager>(
+        option, topology_, topologyStat_, coordinator_);
+
+    const int kChunkServerNum = 10;
+    const int kHeartbeatNum = 100;
+    std::vector<ChunkServerHeartbeatRequest> requests(kHeartbeatNum);
+    std::vector<ChunkServerHeartbeatResponse> responses(kHeartbeatNum);
+    for (int i = 0; i < kHeartbeatNum; ++i) {
+        requests[i] = GetChunkServerHeartbeatRequestForTest();
+        requests[i].set_chunkserverid(i % kChunkServerNum + 1);
+    }
+    EXPECT_CALL(*topology_, GetChunkServer(_, _))
+        .Times(2 * kHeartbeatNum)
+        .WillRepeatedly(Return(false));
+
+    // 1. workers are not running, handled inline
+    std::atomic<int> doneCount(0);
+    for (int i = 0; i < kHeartbeatNum; ++i) {
+        heartbeatManager_->AsyncChunkServerHeartbeat(
+            &requests[i], &responses[i], new CountClosure(&doneCount));
+        ASSERT_EQ(i + 1, doneCount.load());
+        ASSERT_EQ(HeartbeatStatusCode::hbChunkserverUnknown,
+                  responses[i].statuscode());
+    }
+
+    // 2. handled by workers, all queued heartbeats are done after stop
+    heartbeatManager_->Run();
+    doneCount.store(0);
+    for (int i = 0; i < kHeartbeatNum; ++i) {
+        responses[i].Clear();
+        ASSERT_TRUE(heartbeatManager_->AsyncChunkServerHeartbeat(
+            &requests[i], &responses[i], new CountClosure(&doneCount)));
+    }
+    heartbeatManager_->Stop();
+    ASSERT_EQ(kHeartbeatNum, doneCount.load());
+    for (int i = 0; i < kHeartbeatNum; ++i) {
+        ASSERT_EQ(HeartbeatStatusCode::hbChunkserverUnknown,
+                  responses[i].statuscode());
+    }
+}
+
+TEST_F(TestHeartbeatManager, test_async_heartbeat_reject_when_queue_full) {
+    HeartbeatOption option;
+    option.cleanFollowerAfterMs = 0;
+    option.heartbeatMissTimeOutMs = 10000;
+    option.offLineTimeOutMs = 30000;
+    option.mdsStartTime = steady_clock::now();
+    option.workerNum = 1;
+    option.workerQueueCapacity = 2;
+    heartbeatManager_ = std::make_shared<HeartbeatManager>(
+        option, topology_, topologyStat_, coordinator_);
+
+    const int kHeartbeatNum = 4;
+    std::vector<ChunkServerHeartbeatRequest> requests(kHeartbeatNum);
+    std::vector<ChunkServerHeartbeatResponse> responses(kHeartbeatNum);
+    for (int i = 0; i < kHeartbeatNum; ++i) {
+        requests[i] = GetChunkServerHeartbeatRequestForTest();
+    }
+
+    // the worker is blocked in the first heartbeat until released
+    std::promise<void> entered;
+    std::promise<void> release;
+    std::shared_future<void> released(release.get_future());
+    EXPECT_CALL(*topology_, GetChunkServer(_, _))
+        .Times(kHeartbeatNum - 1)
+        .WillOnce(Invoke([&](ChunkServerIdType,
+                             ::curve::mds::topology::ChunkServer *) {
+            entered.set_value();
+            released.wait();
+            return false;
+        }))
+        .WillRepeatedly(Return(false));
+
+    heartbeatManager_->Run();
+    std::atomic<int> doneCount(0);
+    ASSERT_TRUE(heartbeatManager_->AsyncChunkServerHeartbeat(
+        &requests[0], &responses[0], new CountClosure(&doneCount)));
+    entered.get_future().wait();
+
+    // queue is full after two heartbeats, the third one is rejected
+    // without blocking and its closure is not run
+    ASSERT_TRUE(heartbeatManager_->AsyncChunkServerHeartbeat(
+        &requests[1], &responses[1], new CountClosure(&doneCount)));
+    ASSERT_TRUE(heartbeatManager_->AsyncChunkServerHeartbeat(
+        &requests[2], &responses[2], new CountClosure(&doneCount)));
+    CountClosure *rejected = new CountClosure(&doneCount);
+    ASSERT_FALSE(heartbeatManager_->AsyncChunkServerHeartbeat(
+        &requests[3], &responses[3], rejected));
+    ASSERT_EQ(0, doneCount.load());
+
+    // queued heartbeats are handled in one batch
+    release.set_value();
+    heartbeatManager_->Stop();
+    ASSERT_EQ(kHeartbeatNum - 1, doneCount.load());
+    for (int i = 0; i < kHeartbeatNum - 1; ++i) {
+        ASSERT_EQ(HeartbeatStatusCode::hbChunkserverUnknown,
+                  responses[i].statuscode());
+    }
+    rejected->Run();
+}
+
 }  // namespace heartbeat
 }  // namespace mds
 }  // namespace curve
@@ -42,6 +42,8 @@ class MockCoordinator : public ::curve::mds::schedule::Coordinator {
 
     MOCK_METHOD2(ChunkserverGoingToAdd, bool(ChunkServerIdType, CopySetKey));
 
+    MOCK_METHOD1(HasOperator, bool(CopySetKey));
+
     MOCK_METHOD1(RapidLeaderSchedule, int(PoolIdType));
 
     MOCK_METHOD2(QueryChunkServerRecoverStatus,
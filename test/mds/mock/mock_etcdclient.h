@@ -35,6 +35,7 @@ namespace curve {
 namespace mds {
 
 using ::curve::kvstorage::EtcdClientImp;
+using ::curve::kvstorage::WatchEvent;
 
 class MockEtcdClient : public EtcdClientImp {
  public:
@@ -47,6 +48,8 @@ class MockEtcdClient : public EtcdClientImp {
                            std::vector<std::pair<std::string, std::string>>*));
     MOCK_METHOD1(Delete, int(const std::string&));
     MOCK_METHOD1(TxnN, int(const std::vector<Operation>&));
+    MOCK_METHOD2(TxnNWithRevision,
+        int(const std::vector<Operation>&, int64_t*));
     MOCK_METHOD3(CompareAndSwap, int(const std::string&, const std::string&,
         const std::string&));
     MOCK_METHOD5(CampaignLeader, int(const std::string&, const std::string&,
@@ -61,14 +64,21 @@ class MockEtcdClient : public EtcdClientImp {
     MOCK_METHOD3(PutRewithRevision, int(const std::string &,
         const std::string &, int64_t *));
     MOCK_METHOD2(DeleteRewithRevision, int(const std::string &, int64_t *));
+    MOCK_METHOD5(CountWithRevision, int(const std::string &,
+        const std::string &, int64_t, int64_t, int64_t *));
+    MOCK_METHOD4(WatchWithPrefix, int(const std::string &, int64_t, uint32_t,
+        std::vector<WatchEvent> *));
 };
 
 class MockLRUCache : public LRUCache {
  public:
     virtual ~MockLRUCache() {}
-    MOCK_METHOD2(Put, void(const std::string&, const std::string&));
-    MOCK_METHOD2(Get, bool(const std::string&, std::string*));
+    MOCK_METHOD2(Put, void(const std::string&, const CacheValue&));
+    MOCK_METHOD2(Get, bool(const std::string&, CacheValue*));
     MOCK_METHOD1(Remove, void(const std::string&));
+    MOCK_METHOD1(GetRevision, uint64_t(const std::string&));
+    MOCK_METHOD3(PutIfRevisionMatch,
+        bool(const std::string&, const CacheValue&, uint64_t));
 };
 }  // namespace mds
 }  // namespace curve
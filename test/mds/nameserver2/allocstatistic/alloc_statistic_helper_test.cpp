@@ -21,10 +21,16 @@
  */
 
 #include <gtest/gtest.h>
+#include <chrono>  // NOLINT
+#include <map>
 #include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "src/mds/nameserver2/helper/namespace_helper.h"
 #include "src/mds/nameserver2/allocstatistic/alloc_statistic_helper.h"
 #include "src/common/namespace_define.h"
+#include "src/common/timeutility.h"
 #include "test/mds/mock/mock_etcdclient.h"
 
 using ::testing::_;
@@ -32,11 +38,13 @@ using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
 using ::testing::Matcher;
+using ::testing::Invoke;
 
 using ::curve::common::SEGMENTALLOCSIZEKEYEND;
 using ::curve::common::SEGMENTALLOCSIZEKEY;
 using ::curve::common::SEGMENTINFOKEYPREFIX;
 using ::curve::common::SEGMENTINFOKEYEND;
+using ::curve::common::INODESTOREKEY;
 
 namespace curve {
 namespace mds {
@@ -179,6 +187,198 @@ TEST(TestAllocStatisticHelper, test_CalculateSegmentAlloc) {
         ASSERT_EQ(501L * (1 << 30), out[2]);
     }
 }
+
+TEST(TestAllocStatisticHelper, test_DecodeSegmentAlloc) {
+    PageFileSegment segment;
+    segment.set_segmentsize(1 << 30);
+    segment.set_logicalpoolid(3);
+    segment.set_chunksize(16 * 1024 * 1024);
+    segment.set_startoffset(1 << 30);
+    for (int i = 0; i < 64; i++) {
+        auto chunk = segment.add_chunks();
+        chunk->set_chunkid(i);
+        chunk->set_copysetid(i);
+    }
+    std::string encodeSegment;
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeSegment(segment, &encodeSegment));
+
+    PoolIdType lid;
+    uint64_t segmentSize;
+    ASSERT_TRUE(AllocStatisticHelper::DecodeSegmentAlloc(
+        encodeSegment, &lid, &segmentSize));
+    ASSERT_EQ(3, lid);
+    ASSERT_EQ(1 << 30, segmentSize);
+
+    ASSERT_FALSE(AllocStatisticHelper::DecodeSegmentAlloc(
+        "hello", &lid, &segmentSize));
+    ASSERT_FALSE(AllocStatisticHelper::DecodeSegmentAlloc(
+        "", &lid, &segmentSize));
+}
+
+namespace {
+// segments of files with inode id in [1, fileNum], every file has
+// segmentNum segments, pools of file are 1 and 2 alternately
+std::map<std::string, std::string> BuildSegments(
+    uint64_t fileNum, uint64_t segmentNum) {
+    PageFileSegment segment;
+    segment.set_segmentsize(1 << 30);
+    segment.set_chunksize(16 * 1024 * 1024);
+    for (int i = 0; i < 64; i++) {
+        auto chunk = segment.add_chunks();
+        chunk->set_chunkid(i);
+        chunk->set_copysetid(i);
+    }
+
+    std::map<std::string, std::string> segments;
+    for (uint64_t inodeId = 1; inodeId <= fileNum; inodeId++) {
+        segment.set_logicalpoolid(inodeId % 2 + 1);
+        for (uint64_t i = 0; i < segmentNum; i++) {
+            segment.set_startoffset(i << 30);
+            std::string value;
+            NameSpaceStorageCodec::EncodeSegment(segment, &value);
+            segments[NameSpaceStorageCodec::EncodeSegmentStoreKey(
+                inodeId, i << 30)] = value;
+        }
+    }
+    return segments;
+}
+
+// list from segments like etcd, startKey is included
+int FakeListWithLimit(const std::map<std::string, std::string> &segments,
+                      uint32_t latencyUs, const std::string &startKey,
+                      const std::string &endKey, int64_t limit,
+                      std::vector<std::string> *values, std::string *lastKey) {
+    if (latencyUs > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(latencyUs));
+    }
+    auto iter = segments.lower_bound(startKey);
+    auto end = segments.lower_bound(endKey);
+    for (; iter != end && values->size() < limit; ++iter) {
+        values->emplace_back(iter->second);
+        *lastKey = iter->first;
+    }
+    return EtcdErrCode::EtcdOK;
+}
+}  // namespace
+
+TEST(TestAllocStatisticHelper, test_CalculateSegmentAllocConcurrently) {
+    auto mockEtcdClient = std::make_shared<MockEtcdClient>();
+    const uint64_t fileNum = 100;
+    const uint64_t segmentNum = 25;
+    auto segments = BuildSegments(fileNum, segmentNum);
+    {
+        // 1. get inode id fail
+        EXPECT_CALL(*mockEtcdClient, Get(INODESTOREKEY, _))
+            .WillOnce(Return(EtcdErrCode::EtcdUnknown));
+        std::map<PoolIdType, int64_t> out;
+        ASSERT_EQ(-1, AllocStatisticHelper::CalculateSegmentAlloc(
+            2, mockEtcdClient, 4, &out));
+    }
+    {
+        // 2. list ok, ranges are scanned concurrently
+        EXPECT_CALL(*mockEtcdClient, Get(INODESTOREKEY, _))
+            .WillOnce(DoAll(SetArgPointee<1>(std::to_string(fileNum)),
+                            Return(EtcdErrCode::EtcdOK)));
+        EXPECT_CALL(*mockEtcdClient, ListWithLimitAndRevision(
+            _, _, GETBUNDLE, 2, _, _))
+            .WillRepeatedly(Invoke([&](const std::string &startKey,
+                                       const std::string &endKey,
+                                       int64_t limit, int64_t,
+                                       std::vector<std::string> *values,
+                                       std::string *lastKey) {
+                return FakeListWithLimit(segments, 0, startKey, endKey,
+                                         limit, values, lastKey);
+            }));
+        std::map<PoolIdType, int64_t> out;
+        ASSERT_EQ(0, AllocStatisticHelper::CalculateSegmentAlloc(
+            2, mockEtcdClient, 4, &out));
+        const int64_t poolAlloc = fileNum / 2 * segmentNum * (1 << 30);
+        ASSERT_EQ(2, out.size());
+        ASSERT_EQ(poolAlloc, out[1]);
+        ASSERT_EQ(poolAlloc, out[2]);
+    }
+    {
+        // 3. one of the ranges list fail
+        EXPECT_CALL(*mockEtcdClient, Get(INODESTOREKEY, _))
+            .WillOnce(DoAll(SetArgPointee<1>(std::to_string(fileNum)),
+                            Return(EtcdErrCode::EtcdOK)));
+        EXPECT_CALL(*mockEtcdClient, ListWithLimitAndRevision(
+            _, _, GETBUNDLE, 2, _, _))
+            .WillOnce(Return(EtcdErrCode::EtcdUnknown))
+            .WillRepeatedly(Invoke([&](const std::string &startKey,
+                                       const std::string &endKey,
+                                       int64_t limit, int64_t,
+                                       std::vector<std::string> *values,
+                                       std::string *lastKey) {
+                return FakeListWithLimit(segments, 0, startKey, endKey,
+                                         limit, values, lastKey);
+            }));
+        std::map<PoolIdType, int64_t> out;
+        ASSERT_EQ(-1, AllocStatisticHelper::CalculateSegmentAlloc(
+            2, mockEtcdClient, 4, &out));
+        ASSERT_TRUE(out.empty());
+    }
+}
+
+// startup time of calculating segment alloc of 2 million segments,
+// with 1ms latency of every list request
+TEST(TestAllocStatisticHelper, DISABLED_calculate_segment_alloc_benchmark) {
+    auto mockEtcdClient = std::make_shared<MockEtcdClient>();
+    const uint64_t fileNum = 20000;
+    const uint64_t segmentNum = 100;
+    const uint32_t latencyUs = 1000;
+    auto segments = BuildSegments(fileNum, segmentNum);
+
+    EXPECT_CALL(*mockEtcdClient, Get(INODESTOREKEY, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(std::to_string(fileNum)),
+                              Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient, ListWithLimitAndRevision(
+        _, _, GETBUNDLE, 2, _, _))
+        .WillRepeatedly(Invoke([&](const std::string &startKey,
+                                   const std::string &endKey,
+                                   int64_t limit, int64_t,
+                                   std::vector<std::string> *values,
+                                   std::string *lastKey) {
+            return FakeListWithLimit(segments, latencyUs, startKey, endKey,
+                                     limit, values, lastKey);
+        }));
+
+    for (uint32_t concurrency : {1, 4, 16}) {
+        std::map<PoolIdType, int64_t> out;
+        uint64_t startUs = ::curve::common::TimeUtility::GetTimeofDayUs();
+        ASSERT_EQ(0, AllocStatisticHelper::CalculateSegmentAlloc(
+            2, mockEtcdClient, concurrency, &out));
+        uint64_t costUs =
+            ::curve::common::TimeUtility::GetTimeofDayUs() - startUs;
+        ASSERT_EQ(static_cast<int64_t>(fileNum / 2 * segmentNum * (1 << 30)),
+                  out[1]);
+        LOG(INFO) << "calculate " << segments.size() << " segments with "
+                  << concurrency << " concurrency, cost " << costUs / 1000
+                  << " ms";
+    }
+
+    // decode cost of full protobuf vs logical pool id and segment size
+    uint64_t startUs = ::curve::common::TimeUtility::GetTimeofDayUs();
+    for (const auto &item : segments) {
+        PageFileSegment segment;
+        ASSERT_TRUE(NameSpaceStorageCodec::DecodeSegment(item.second,
+                                                         &segment));
+    }
+    uint64_t fullDecodeUs =
+        ::curve::common::TimeUtility::GetTimeofDayUs() - startUs;
+    startUs = ::curve::common::TimeUtility::GetTimeofDayUs();
+    for (const auto &item : segments) {
+        PoolIdType lid;
+        uint64_t segmentSize;
+        ASSERT_TRUE(AllocStatisticHelper::DecodeSegmentAlloc(
+            item.second, &lid, &segmentSize));
+    }
+    uint64_t lightDecodeUs =
+        ::curve::common::TimeUtility::GetTimeofDayUs() - startUs;
+    LOG(INFO) << "decode " << segments.size() << " segments, full decode cost "
+              << fullDecodeUs / 1000 << " ms, alloc decode cost "
+              << lightDecodeUs / 1000 << " ms";
+}
 }  // namespace mds
 }  // namespace curve
 
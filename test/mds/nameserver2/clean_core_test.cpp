@@ -23,6 +23,10 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <glog/logging.h>
+
+#include <atomic>
+#include <vector>
+
 #include "src/mds/nameserver2/clean_core.h"
 #include "test/mds/nameserver2/mock/mock_namespace_storage.h"
 #include "test/mds/mock/mock_topology.h"
@@ -34,6 +38,7 @@ using ::testing::_;
 using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
+using ::testing::Invoke;
 using curve::mds::topology::MockTopology;
 using ::curve::mds::chunkserverclient::ChunkServerClientOption;
 using ::curve::mds::chunkserverclient::MockChunkServerClient;
@@ -380,5 +385,142 @@ TEST_F(CleanCoreTest, TestCleanDiscardSegment) {
     }
 }
 
+TEST_F(CleanCoreTest, TestCleanFileWithBatchDeleteChunk) {
+    const int kDefaultChunkSize = 16 * 1024 * 1024;
+    const int kChunkNumPerSegment = 8;
+    const uint32_t segmentNum = kMiniFileLength / DefaultSegmentSize;
+
+    CleanCoreOption option;
+    option.batchDeleteChunk = true;
+    option.maxChunksPerBatch = 3;
+    option.deleteChunkConcurrency = 4;
+    option.segmentsPerRound = 4;
+    auto cleanCore = std::make_shared<CleanCore>(
+        storage_, client_, allocStatistic_, option);
+    client_->SetChunkServerClient(csClient_);
+
+    // chunks of a segment are in copyset 0 and copyset 1
+    PageFileSegment segment;
+    segment.set_logicalpoolid(1);
+    segment.set_segmentsize(DefaultSegmentSize);
+    segment.set_chunksize(kDefaultChunkSize);
+    for (int i = 0; i < kChunkNumPerSegment; ++i) {
+        auto* chunk = segment.add_chunks();
+        chunk->set_copysetid(i % 2);
+        chunk->set_chunkid(i);
+    }
+    for (uint32_t i = 0; i < segmentNum; i++) {
+        EXPECT_CALL(*storage_, GetSegment(_, i * DefaultSegmentSize, _))
+            .WillOnce(DoAll(SetArgPointee<2>(segment),
+                            Return(StoreStatus::OK)));
+    }
+
+    // rounds of 4, 4, 2 segments, every copyset has 16, 16, 8 chunks
+    // in a round, which are deleted in 6, 6, 3 batches
+    const int batchNum = (6 + 6 + 3) * 2;
+    CopySetInfo copyset;
+    copyset.SetLeader(1);
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .Times(batchNum)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copyset), Return(true)));
+    std::atomic<int> deletedChunks(0);
+    EXPECT_CALL(*csClient_, DeleteChunk(_, _, _, _, _))
+        .Times(0);
+    EXPECT_CALL(*csClient_, DeleteChunks(1, 1, _, _, _))
+        .Times(batchNum)
+        .WillRepeatedly(Invoke([&](ChunkServerIdType, LogicalPoolID,
+                                   CopysetID copysetId,
+                                   const std::vector<ChunkID> &chunkIds,
+                                   uint64_t) {
+            EXPECT_LE(chunkIds.size(), option.maxChunksPerBatch);
+            for (auto chunkId : chunkIds) {
+                EXPECT_EQ(copysetId, chunkId % 2);
+            }
+            deletedChunks += chunkIds.size();
+            return kMdsSuccess;
+        }));
+
+    EXPECT_CALL(*storage_, DeleteSegment(_, _, _))
+        .Times(segmentNum)
+        .WillRepeatedly(Return(StoreStatus::OK));
+    EXPECT_CALL(*allocStatistic_, DeAllocSpace(_, _, _))
+        .Times(segmentNum);
+    EXPECT_CALL(*storage_, DeleteFile(_, _))
+        .WillOnce(Return(StoreStatus::OK));
+
+    FileInfo cleanFile;
+    cleanFile.set_length(kMiniFileLength);
+    cleanFile.set_segmentsize(DefaultSegmentSize);
+    TaskProgress progress;
+    ASSERT_EQ(StatusCode::kOK, cleanCore->CleanFile(cleanFile, &progress));
+    ASSERT_EQ(static_cast<int>(segmentNum * kChunkNumPerSegment),
+              deletedChunks.load());
+    ASSERT_EQ(100, progress.GetProgress());
+    ASSERT_EQ(TaskStatus::SUCCESS, progress.GetStatus());
+}
+
+TEST_F(CleanCoreTest, TestBatchDeleteChunkFallback) {
+    const int kDefaultChunkSize = 16 * 1024 * 1024;
+    const int kChunkNumPerSegment = 4;
+    const uint32_t segmentNum = kMiniFileLength / DefaultSegmentSize;
+
+    CleanCoreOption option;
+    option.batchDeleteChunk = true;
+    option.maxChunksPerBatch = 64;
+    option.deleteChunkConcurrency = 1;
+    option.segmentsPerRound = 4;
+    auto cleanCore = std::make_shared<CleanCore>(
+        storage_, client_, allocStatistic_, option);
+    client_->SetChunkServerClient(csClient_);
+
+    PageFileSegment segment;
+    segment.set_logicalpoolid(1);
+    segment.set_segmentsize(DefaultSegmentSize);
+    segment.set_chunksize(kDefaultChunkSize);
+    for (int i = 0; i < kChunkNumPerSegment; ++i) {
+        auto* chunk = segment.add_chunks();
+        chunk->set_copysetid(1);
+        chunk->set_chunkid(i);
+    }
+    for (uint32_t i = 0; i < segmentNum; i++) {
+        EXPECT_CALL(*storage_, GetSegment(_, i * DefaultSegmentSize, _))
+            .WillOnce(DoAll(SetArgPointee<2>(segment),
+                            Return(StoreStatus::OK)));
+    }
+
+    CopySetInfo copyset;
+    copyset.SetLeader(1);
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copyset), Return(true)));
+
+    // chunkserver is not upgraded, chunks are deleted one by one
+    EXPECT_CALL(*csClient_, DeleteChunks(1, 1, 1, _, _))
+        .WillRepeatedly(Return(kCsClientNotSupported));
+    std::atomic<int> deletedChunks(0);
+    EXPECT_CALL(*csClient_, DeleteChunk(1, 1, 1, _, _))
+        .WillRepeatedly(Invoke([&](ChunkServerIdType, LogicalPoolID,
+                                   CopysetID, ChunkID, uint64_t) {
+            deletedChunks++;
+            return kMdsSuccess;
+        }));
+
+    EXPECT_CALL(*storage_, DeleteSegment(_, _, _))
+        .Times(segmentNum)
+        .WillRepeatedly(Return(StoreStatus::OK));
+    EXPECT_CALL(*allocStatistic_, DeAllocSpace(_, _, _))
+        .Times(segmentNum);
+    EXPECT_CALL(*storage_, DeleteFile(_, _))
+        .WillOnce(Return(StoreStatus::OK));
+
+    FileInfo cleanFile;
+    cleanFile.set_length(kMiniFileLength);
+    cleanFile.set_segmentsize(DefaultSegmentSize);
+    TaskProgress progress;
+    ASSERT_EQ(StatusCode::kOK, cleanCore->CleanFile(cleanFile, &progress));
+    ASSERT_EQ(static_cast<int>(segmentNum * kChunkNumPerSegment),
+              deletedChunks.load());
+    ASSERT_EQ(TaskStatus::SUCCESS, progress.GetStatus());
+}
+
 }  // namespace mds
 }  // namespace curve
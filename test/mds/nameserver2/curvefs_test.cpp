@@ -21,9 +21,16 @@
  */
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <map>
+#include <thread>  //NOLINT
+#include <vector>
 #include "src/mds/nameserver2/curvefs.h"
 #include "src/mds/nameserver2/idgenerator/inode_id_generator.h"
 #include "src/mds/nameserver2/namespace_storage.h"
+#include "src/mds/nameserver2/helper/namespace_helper.h"
 #include "src/common/timeutility.h"
 #include "src/mds/common/mds_define.h"
 
@@ -36,6 +43,7 @@
 #include "test/mds/nameserver2/mock/mock_file_record_manager.h"
 #include "test/mds/mock/mock_alloc_statistic.h"
 #include "test/mds/mock/mock_topology.h"
+#include "test/mds/mock/mock_etcdclient.h"
 
 using ::testing::AtLeast;
 using ::testing::StrEq;
@@ -45,6 +53,7 @@ using ::testing::ReturnArg;
 using ::testing::DoAll;
 using ::testing::SetArgPointee;
 using ::testing::SaveArg;
+using ::testing::Invoke;
 using curve::common::Authenticator;
 
 using curve::common::TimeUtility;
@@ -2568,6 +2577,249 @@ TEST_F(CurveFSTest, TestDeAllocateSegment) {
     }
 }
 
+TEST_F(CurveFSTest, TestListSegment) {
+    const std::string filename = "/TestListSegment";
+    std::vector<PageFileSegment> segments;
+    uint64_t nextOffset = 0;
+
+    // GetFileInfo failed
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(Return(StoreStatus::InternalError));
+
+        ASSERT_EQ(StatusCode::kStorageError,
+                  curvefs_->ListSegment(filename, 0, 0, 1024, &segments,
+                                        &nextOffset));
+    }
+
+    // not pagefile
+    {
+        FileInfo fileInfo;
+        fileInfo.set_filetype(FileType::INODE_DIRECTORY);
+
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+
+        ASSERT_EQ(StatusCode::kParaError,
+                  curvefs_->ListSegment(filename, 0, 0, 1024, &segments,
+                                        &nextOffset));
+    }
+
+    FileInfo fileInfo;
+    fileInfo.set_id(100);
+    fileInfo.set_filetype(FileType::INODE_PAGEFILE);
+    fileInfo.set_length(100 * kGB);
+    fileInfo.set_segmentsize(1 * kGB);
+
+    // offset not aligned
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+
+        ASSERT_EQ(StatusCode::kParaError,
+                  curvefs_->ListSegment(filename, 1, 0, 1024, &segments,
+                                        &nextOffset));
+    }
+
+    // list storage failed
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, ListSegmentInRange(100, 0, 100 * kGB, _))
+            .WillOnce(Return(StoreStatus::InternalError));
+
+        ASSERT_EQ(StatusCode::kStorageError,
+                  curvefs_->ListSegment(filename, 0, 0, 1024, &segments,
+                                        &nextOffset));
+    }
+
+    // list ok, range is clipped by file length
+    {
+        std::vector<PageFileSegment> storeSegments(2);
+        storeSegments[0].set_startoffset(1 * kGB);
+        storeSegments[1].set_startoffset(3 * kGB);
+
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .Times(2)
+            .WillRepeatedly(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, ListSegmentInRange(100, 1 * kGB, 5 * kGB, _))
+            .WillOnce(DoAll(SetArgPointee<3>(storeSegments),
+                            Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, ListSegmentInRange(100, 1 * kGB, 100 * kGB, _))
+            .WillOnce(Return(StoreStatus::OK));
+
+        ASSERT_EQ(StatusCode::kOK,
+                  curvefs_->ListSegment(filename, 1 * kGB, 4 * kGB, 1024,
+                                        &segments, &nextOffset));
+        ASSERT_EQ(2, segments.size());
+        ASSERT_EQ(3 * kGB, segments[1].startoffset());
+
+        segments.clear();
+        ASSERT_EQ(StatusCode::kOK,
+                  curvefs_->ListSegment(filename, 1 * kGB, 200 * kGB, 1024,
+                                        &segments, &nextOffset));
+        ASSERT_TRUE(segments.empty());
+        ASSERT_EQ(100 * kGB, nextOffset);
+    }
+
+    // maxSegmentNum is 0
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+
+        ASSERT_EQ(StatusCode::kParaError,
+                  curvefs_->ListSegment(filename, 0, 0, 0, &segments,
+                                        &nextOffset));
+    }
+
+    // range is clipped by maxSegmentNum
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .Times(2)
+            .WillRepeatedly(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, ListSegmentInRange(100, 0, 10 * kGB, _))
+            .WillOnce(Return(StoreStatus::OK));
+        EXPECT_CALL(*storage_, ListSegmentInRange(100, 90 * kGB, 100 * kGB, _))
+            .WillOnce(Return(StoreStatus::OK));
+
+        segments.clear();
+        ASSERT_EQ(StatusCode::kOK,
+                  curvefs_->ListSegment(filename, 0, 0, 10, &segments,
+                                        &nextOffset));
+        ASSERT_EQ(10 * kGB, nextOffset);
+
+        ASSERT_EQ(StatusCode::kOK,
+                  curvefs_->ListSegment(filename, 90 * kGB, 0, 10, &segments,
+                                        &nextOffset));
+        ASSERT_EQ(100 * kGB, nextOffset);
+    }
+}
+
+TEST_F(CurveFSTest, TestPreallocateSegment) {
+    const std::string filename = "/TestPreallocateSegment";
+    uint64_t nextOffset = 0;
+
+    // GetFileInfo failed
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(Return(StoreStatus::InternalError));
+
+        ASSERT_EQ(StatusCode::kStorageError,
+                  curvefs_->PreallocateSegment(filename, 0, 0, 4,
+                                               &nextOffset));
+    }
+
+    FileInfo fileInfo;
+    fileInfo.set_id(100);
+    fileInfo.set_filetype(FileType::INODE_PAGEFILE);
+    fileInfo.set_length(10 * kGB);
+    fileInfo.set_segmentsize(1 * kGB);
+    fileInfo.set_chunksize(16 * kMB);
+
+    // offset not aligned
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+
+        ASSERT_EQ(StatusCode::kParaError,
+                  curvefs_->PreallocateSegment(filename, 1, 0, 4,
+                                               &nextOffset));
+    }
+
+    // range exceeds file length, offset + length overflows
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .Times(3)
+            .WillRepeatedly(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, ListSegmentInRange(_, _, _, _)).Times(0);
+
+        ASSERT_EQ(StatusCode::kParaError,
+                  curvefs_->PreallocateSegment(filename, 8 * kGB, 4 * kGB, 4,
+                                               &nextOffset));
+        ASSERT_EQ(StatusCode::kParaError,
+                  curvefs_->PreallocateSegment(filename, 12 * kGB, 0, 4,
+                                               &nextOffset));
+        ASSERT_EQ(StatusCode::kParaError,
+                  curvefs_->PreallocateSegment(
+                      filename, 2 * kGB,
+                      std::numeric_limits<uint64_t>::max() - 1 * kGB, 4,
+                      &nextOffset));
+    }
+
+    // allocated segments are skipped, at most 4 segments in one call
+    {
+        std::vector<PageFileSegment> allocated(2);
+        allocated[0].set_startoffset(1 * kGB);
+        allocated[1].set_startoffset(3 * kGB);
+
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, ListSegmentInRange(100, 0, 10 * kGB, _))
+            .WillOnce(DoAll(SetArgPointee<3>(allocated),
+                            Return(StoreStatus::OK)));
+        EXPECT_CALL(*mockChunkAllocator_,
+                    AllocateChunkSegment(_, 1 * kGB, 16 * kMB, _, _))
+            .Times(4)
+            .WillRepeatedly(Return(true));
+        EXPECT_CALL(*storage_, PutSegments(100, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(10), Return(StoreStatus::OK)));
+        EXPECT_CALL(*allocStatistic_, AllocSpace(_, _, 10))
+            .Times(4);
+
+        ASSERT_EQ(StatusCode::kOK,
+                  curvefs_->PreallocateSegment(filename, 0, 0, 4,
+                                               &nextOffset));
+        // 0, 2, 4, 5 are allocated
+        ASSERT_EQ(6 * kGB, nextOffset);
+    }
+
+    // allocate chunk segment failed
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, ListSegmentInRange(100, 6 * kGB, 8 * kGB, _))
+            .WillOnce(Return(StoreStatus::OK));
+        EXPECT_CALL(*mockChunkAllocator_,
+                    AllocateChunkSegment(_, _, _, _, _))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*storage_, PutSegments(_, _, _)).Times(0);
+
+        ASSERT_EQ(StatusCode::kSegmentAllocateError,
+                  curvefs_->PreallocateSegment(filename, 6 * kGB, 2 * kGB, 4,
+                                               &nextOffset));
+    }
+
+    // put segments failed
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, ListSegmentInRange(100, 6 * kGB, 10 * kGB, _))
+            .WillOnce(Return(StoreStatus::OK));
+        EXPECT_CALL(*mockChunkAllocator_,
+                    AllocateChunkSegment(_, _, _, _, _))
+            .Times(4)
+            .WillRepeatedly(Return(true));
+        EXPECT_CALL(*storage_, PutSegments(100, _, _))
+            .WillOnce(Return(StoreStatus::InternalError));
+
+        ASSERT_EQ(StatusCode::kStorageError,
+                  curvefs_->PreallocateSegment(filename, 6 * kGB, 0, 4,
+                                               &nextOffset));
+    }
+}
+
 TEST_F(CurveFSTest, testCreateSnapshotFile) {
     {
         // test client time not expired
@@ -4468,6 +4720,151 @@ TEST_F(CurveFSTest, TestUpdateFileThrottleParams) {
     }
 }
 
+// qps of the hot rpcs GetFileInfo, GetOrAllocateSegment and RefreshSession
+// served by CurveFS with the real namespace storage and cache, including the
+// owner check done by the service before each of them; etcd is only read
+// when the cache misses
+TEST(CurveFSPerformanceTest, DISABLED_TestHotRpcQps) {
+    const int threadNum = 8;
+    const int opPerThread = 50000;
+    const std::string owner = "user1";
+    const std::string fileName = "/dir/file";
+
+    FileInfo recycleBin;
+    recycleBin.set_parentid(ROOTINODEID);
+    recycleBin.set_id(RECYCLEBININODEID);
+    recycleBin.set_filename(RECYCLEBINDIRNAME);
+    recycleBin.set_filetype(FileType::INODE_DIRECTORY);
+    recycleBin.set_owner("root");
+    FileInfo dir;
+    dir.set_parentid(ROOTINODEID);
+    dir.set_id(100);
+    dir.set_filename("dir");
+    dir.set_filetype(FileType::INODE_DIRECTORY);
+    dir.set_owner(owner);
+    FileInfo file;
+    file.set_parentid(dir.id());
+    file.set_id(101);
+    file.set_filename("file");
+    file.set_filetype(FileType::INODE_PAGEFILE);
+    file.set_owner(owner);
+    file.set_chunksize(16 * kMB);
+    file.set_segmentsize(1 * kGB);
+    file.set_length(10 * kGB);
+    PageFileSegment segment;
+    segment.set_logicalpoolid(1);
+    segment.set_segmentsize(file.segmentsize());
+    segment.set_chunksize(file.chunksize());
+    segment.set_startoffset(0);
+    for (uint32_t i = 0; i < file.segmentsize() / file.chunksize(); i++) {
+        PageFileChunkInfo *chunk = segment.add_chunks();
+        chunk->set_chunkid(i);
+        chunk->set_copysetid(i);
+    }
+
+    std::map<std::string, std::string> kvs;
+    // recycle bin is looked up by its path when CurveFS is initialized
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeFileInfo(recycleBin,
+        &kvs[NameSpaceStorageCodec::EncodeFileStoreKey(
+            ROOTINODEID, RECYCLEBINDIR)]));
+    for (const FileInfo *info : {&dir, &file}) {
+        ASSERT_TRUE(NameSpaceStorageCodec::EncodeFileInfo(*info,
+            &kvs[NameSpaceStorageCodec::EncodeFileStoreKey(
+                info->parentid(), info->filename())]));
+    }
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeSegment(segment,
+        &kvs[NameSpaceStorageCodec::EncodeSegmentStoreKey(file.id(), 0)]));
+
+    auto etcdClient = std::make_shared<MockEtcdClient>();
+    EXPECT_CALL(*etcdClient, Get(_, _))
+        .WillRepeatedly(Invoke([&kvs](const std::string &key,
+                                      std::string *out) -> int {
+            auto iter = kvs.find(key);
+            if (iter == kvs.end()) {
+                return EtcdErrCode::EtcdKeyNotExist;
+            }
+            *out = iter->second;
+            return EtcdErrCode::EtcdOK;
+        }));
+    auto storage = std::make_shared<NameServerStorageImp>(etcdClient,
+        std::make_shared<LRUCache>());
+
+    struct CurveFSOption curveFSOptions;
+    curveFSOptions.defaultChunkSize = 16 * kMB;
+    curveFSOptions.defaultSegmentSize = 1 * kGB;
+    curveFSOptions.minFileLength = 10 * kGB;
+    curveFSOptions.maxFileLength = 20 * kTB;
+    curveFSOptions.authOptions.rootOwner = "root";
+    curveFSOptions.authOptions.rootPassword = "root_password";
+    curveFSOptions.fileRecordOptions.fileRecordExpiredTimeUs = 5 * 1000;
+    curveFSOptions.fileRecordOptions.scanIntervalTimeUs = 1 * 1000;
+    ASSERT_TRUE(kCurveFS.Init(storage,
+                              std::make_shared<MockInodeIDGenerator>(),
+                              std::make_shared<MockChunkAllocator>(),
+                              std::make_shared<MockCleanManager>(),
+                              std::make_shared<MockFileRecordManager>(),
+                              std::make_shared<MockAllocStatistic>(),
+                              curveFSOptions,
+                              std::make_shared<MockTopology>(),
+                              std::make_shared<MockSnapshotCloneClient>()));
+    kCurveFS.Run();
+
+    std::map<std::string, std::function<StatusCode(uint64_t)>> rpcs;
+    rpcs["GetFileInfo"] = [&](uint64_t date) {
+        StatusCode ret = kCurveFS.CheckFileOwner(fileName, owner, "", date);
+        if (ret != StatusCode::kOK) {
+            return ret;
+        }
+        FileInfo fileInfo;
+        return kCurveFS.GetFileInfo(fileName, &fileInfo);
+    };
+    rpcs["GetOrAllocateSegment"] = [&](uint64_t date) {
+        StatusCode ret = kCurveFS.CheckFileOwner(fileName, owner, "", date);
+        if (ret != StatusCode::kOK) {
+            return ret;
+        }
+        PageFileSegment pageFileSegment;
+        return kCurveFS.GetOrAllocateSegment(fileName, 0, false,
+                                             &pageFileSegment);
+    };
+    rpcs["RefreshSession"] = [&](uint64_t date) {
+        StatusCode ret = kCurveFS.CheckFileOwner(fileName, owner, "", date);
+        if (ret != StatusCode::kOK) {
+            return ret;
+        }
+        FileInfo fileInfo;
+        return kCurveFS.RefreshSession(fileName, "", date, "", "127.0.0.1",
+                                       8888, "1.0.0", &fileInfo);
+    };
+
+    for (auto &rpc : rpcs) {
+        std::atomic<uint64_t> failed(0);
+        uint64_t startUs = TimeUtility::GetTimeofDayUs();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadNum; ++t) {
+            threads.emplace_back([&]() {
+                uint64_t date = TimeUtility::GetTimeofDayUs();
+                for (int i = 0; i < opPerThread; ++i) {
+                    if (rpc.second(date) != StatusCode::kOK) {
+                        failed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        uint64_t costUs = TimeUtility::GetTimeofDayUs() - startUs;
+
+        ASSERT_EQ(0, failed.load());
+        LOG(INFO) << rpc.first << ", threads = " << threadNum
+                  << ", qps = "
+                  << threadNum * opPerThread * 1000000.0 / (costUs + 1);
+    }
+
+    kCurveFS.Uninit();
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     ::testing::InitGoogleMock(&argc, argv);
@@ -0,0 +1,199 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "src/mds/nameserver2/etcd_write_batcher.h"
+#include "test/mds/mock/mock_etcdclient.h"
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+
+namespace curve {
+namespace mds {
+
+class TestEtcdWriteBatcher : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        client_ = std::make_shared<MockEtcdClient>();
+        option_.enable = true;
+        option_.maxBatchSize = 4;
+        option_.batchWindowUs = 1000 * 1000;
+    }
+
+    void TearDown() override {
+        batcher_ = nullptr;
+        client_ = nullptr;
+    }
+
+    void StartBatcher() {
+        batcher_ = std::make_shared<EtcdWriteBatcher>(client_, option_);
+        batcher_->Start();
+    }
+
+ protected:
+    std::shared_ptr<MockEtcdClient> client_;
+    EtcdWriteBatchOption option_;
+    std::shared_ptr<EtcdWriteBatcher> batcher_;
+};
+
+TEST_F(TestEtcdWriteBatcher, test_lone_write_not_wait_window) {
+    StartBatcher();
+
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(10), Return(EtcdErrCode::EtcdOK)));
+
+    // no other writer is waiting, committed without waiting the window
+    int64_t revision = 0;
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(EtcdErrCode::EtcdOK, batcher_->Put("key", "value", &revision));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(10, revision);
+    ASSERT_LT(elapsed, std::chrono::microseconds(option_.batchWindowUs / 2));
+}
+
+TEST_F(TestEtcdWriteBatcher, test_concurrent_writes_in_one_txn) {
+    StartBatcher();
+
+    std::vector<int> batchSizes;
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(
+            Invoke([&](const std::vector<Operation> &ops, int64_t *) {
+                batchSizes.push_back(ops.size());
+                if (batchSizes.size() == 1) {
+                    // hold the first commit, writes coming meanwhile
+                    // are gathered into the next batch
+                    std::this_thread::sleep_for(
+                        std::chrono::milliseconds(200));
+                }
+            }),
+            SetArgPointee<1>(10),
+            Return(EtcdErrCode::EtcdOK)));
+
+    // a lone write is committed at once
+    std::thread first([&]() {
+        ASSERT_EQ(EtcdErrCode::EtcdOK,
+                  batcher_->Put("first", "value", nullptr));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // batch is full, committed without waiting the window
+    std::vector<std::thread> threads;
+    std::vector<int64_t> revisions(option_.maxBatchSize, 0);
+    std::vector<int> rets(option_.maxBatchSize, -1);
+    for (uint32_t i = 0; i < option_.maxBatchSize; ++i) {
+        threads.emplace_back([&, i]() {
+            std::string key = "key" + std::to_string(i);
+            if (i % 2 == 0) {
+                rets[i] = batcher_->Put(key, "value", &revisions[i]);
+            } else {
+                rets[i] = batcher_->Delete(key, &revisions[i]);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    first.join();
+
+    ASSERT_EQ(2, batchSizes.size());
+    ASSERT_EQ(1, batchSizes[0]);
+    ASSERT_EQ(option_.maxBatchSize, batchSizes[1]);
+    for (uint32_t i = 0; i < option_.maxBatchSize; ++i) {
+        ASSERT_EQ(EtcdErrCode::EtcdOK, rets[i]);
+        ASSERT_EQ(10, revisions[i]);
+    }
+}
+
+TEST_F(TestEtcdWriteBatcher, test_same_key_in_order) {
+    option_.batchWindowUs = 200 * 1000;
+    StartBatcher();
+
+    std::vector<std::string> committed;
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(
+            Invoke([&](const std::vector<Operation> &ops, int64_t *) {
+                ASSERT_EQ(1, ops.size());
+                committed.emplace_back(ops[0].value, ops[0].valueLen);
+            }),
+            SetArgPointee<1>(10),
+            Return(EtcdErrCode::EtcdOK)));
+
+    std::thread t1([&]() {
+        ASSERT_EQ(EtcdErrCode::EtcdOK, batcher_->Put("key", "v1", nullptr));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::thread t2([&]() {
+        ASSERT_EQ(EtcdErrCode::EtcdOK, batcher_->Put("key", "v2", nullptr));
+    });
+    t1.join();
+    t2.join();
+
+    // operations on the same key are never in one txn
+    ASSERT_EQ(2, committed.size());
+    ASSERT_EQ("v1", committed[0]);
+    ASSERT_EQ("v2", committed[1]);
+}
+
+TEST_F(TestEtcdWriteBatcher, test_commit_fail) {
+    option_.batchWindowUs = 0;
+    StartBatcher();
+
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _))
+        .WillOnce(Return(EtcdErrCode::EtcdDeadlineExceeded));
+    int64_t revision = 0;
+    ASSERT_EQ(EtcdErrCode::EtcdDeadlineExceeded,
+              batcher_->Put("key", "value", &revision));
+    ASSERT_EQ(0, revision);
+}
+
+TEST_F(TestEtcdWriteBatcher, test_write_after_stop) {
+    StartBatcher();
+    batcher_->Stop();
+
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _)).Times(0);
+    EXPECT_CALL(*client_, PutRewithRevision("key", "value", _))
+        .WillOnce(DoAll(SetArgPointee<2>(5), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*client_, DeleteRewithRevision("key", _))
+        .WillOnce(DoAll(SetArgPointee<1>(6), Return(EtcdErrCode::EtcdOK)));
+
+    int64_t revision = 0;
+    ASSERT_EQ(EtcdErrCode::EtcdOK, batcher_->Put("key", "value", &revision));
+    ASSERT_EQ(5, revision);
+    ASSERT_EQ(EtcdErrCode::EtcdOK, batcher_->Delete("key", &revision));
+    ASSERT_EQ(6, revision);
+}
+
+}  // namespace mds
+}  // namespace curve
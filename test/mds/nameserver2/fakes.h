@@ -326,6 +326,29 @@ class FakeNameServerStorage : public NameServerStorage {
         return StoreStatus::OK;
     }
 
+    StoreStatus ListSegmentInRange(InodeID id,
+                            uint64_t startOffset,
+                            uint64_t endOffset,
+                            std::vector<PageFileSegment> *segments) override {
+        std::lock_guard<std::mutex> guard(lock_);
+        std::string startStoreKey =
+                NameSpaceStorageCodec::EncodeSegmentStoreKey(id, startOffset);
+        std::string endStoreKey =
+                NameSpaceStorageCodec::EncodeSegmentStoreKey(id, endOffset);
+
+        for (auto iter = memKvMap_.begin(); iter != memKvMap_.end(); iter++) {
+            if (iter->first.compare(startStoreKey) >= 0) {
+                if (iter->first.compare(endStoreKey) < 0) {
+                    PageFileSegment segment;
+                    segment.ParseFromString(iter->second);
+                    segments->push_back(segment);
+                }
+            }
+        }
+
+        return StoreStatus::OK;
+    }
+
     StoreStatus ListSnapshotFile(InodeID startid,
                          InodeID endid,
                          std::vector<FileInfo> * files) override {
@@ -377,6 +400,15 @@ class FakeNameServerStorage : public NameServerStorage {
         return StoreStatus::OK;
     }
 
+    StoreStatus PutSegments(InodeID id,
+                            const std::vector<PageFileSegment> &segments,
+                            int64_t *revision) override {
+        for (auto &segment : segments) {
+            PutSegment(id, segment.startoffset(), &segment, revision);
+        }
+        return StoreStatus::OK;
+    }
+
     StoreStatus DeleteSegment(
         InodeID id, uint64_t off, int64_t *revision) override {
         std::lock_guard<std::mutex> guard(lock_);
@@ -22,9 +22,13 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <glog/logging.h>
 
+#include <atomic>
 #include <chrono>    //NOLINT
+#include <string>
 #include <thread>    // NOLINT
+#include <vector>
 
 #include "src/common/timeutility.h"
 #include "src/mds/common/mds_define.h"
@@ -144,5 +148,122 @@ TEST(FileRecordManagerTest, open_file_num_test) {
     fileRecordManager.Stop();
 }
 
+TEST(FileRecordManagerTest, update_client_info_test) {
+    FileRecordOptions fileRecordOptions;
+    fileRecordOptions.scanIntervalTimeUs = 5 * 1000;
+    fileRecordOptions.fileRecordExpiredTimeUs = 20 * 1000;
+
+    FileRecordManager fileRecordManager;
+    fileRecordManager.Init(fileRecordOptions);
+
+    fileRecordManager.UpdateFileRecord("file1", "0.0.5", "127.0.0.1", 1234);
+    fileRecordManager.UpdateFileRecord("file1", "0.0.6", "127.0.0.2", 1235);
+    ASSERT_EQ(1, fileRecordManager.GetOpenFileNum());
+
+    // 续约时更新client信息
+    std::string v;
+    ASSERT_TRUE(fileRecordManager.GetFileClientVersion("file1", &v));
+    ASSERT_EQ("0.0.6", v);
+    ClientIpPortType clientIpPort;
+    ASSERT_TRUE(fileRecordManager.FindFileMountPoint("file1", &clientIpPort));
+    ASSERT_EQ("127.0.0.2", clientIpPort.first);
+    ASSERT_EQ(1235, clientIpPort.second);
+}
+
+TEST(FileRecordManagerTest, shard_test) {
+    FileRecordOptions fileRecordOptions;
+    fileRecordOptions.scanIntervalTimeUs = 1 * 1000;
+    fileRecordOptions.fileRecordExpiredTimeUs = 4 * 1000;
+    fileRecordOptions.shardNum = 4;
+
+    FileRecordManager fileRecordManager;
+    fileRecordManager.Init(fileRecordOptions);
+    fileRecordManager.Start();
+
+    const int fileNum = 1000;
+    for (int i = 0; i < fileNum; ++i) {
+        fileRecordManager.UpdateFileRecord(
+            "file" + std::to_string(i), "", "127.0.0.1", 1000 + i);
+    }
+    ASSERT_EQ(fileNum, fileRecordManager.GetOpenFileNum());
+    ASSERT_EQ(fileNum, fileRecordManager.ListAllClient().size());
+
+    for (int i = 0; i < fileNum; i += 2) {
+        fileRecordManager.RemoveFileRecord("file" + std::to_string(i));
+    }
+    ASSERT_EQ(fileNum / 2, fileRecordManager.GetOpenFileNum());
+
+    // 删除后重新打开，旧记录在时间轮中的条目不影响新记录
+    fileRecordManager.UpdateFileRecord("file0", "", "127.0.0.1", 1000);
+    ASSERT_EQ(fileNum / 2 + 1, fileRecordManager.GetOpenFileNum());
+
+    // 不续约，所有记录都会超时
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(0, fileRecordManager.GetOpenFileNum());
+
+    fileRecordManager.Stop();
+}
+
+// 模拟大量client定期续约，测试续约吞吐和后台扫描的开销
+// 运行方式: --gtest_also_run_disabled_tests
+TEST(FileRecordManagerTest, DISABLED_million_sessions_benchmark) {
+    FileRecordOptions fileRecordOptions;
+    fileRecordOptions.scanIntervalTimeUs = 500 * 1000;
+    fileRecordOptions.fileRecordExpiredTimeUs = 5 * 1000 * 1000;
+    fileRecordOptions.shardNum = 64;
+
+    FileRecordManager fileRecordManager;
+    fileRecordManager.Init(fileRecordOptions);
+    fileRecordManager.Start();
+
+    const int sessionNum = 1000000;
+    const int threadNum = 16;
+    const int roundNum = 5;
+
+    std::vector<std::string> fileNames;
+    fileNames.reserve(sessionNum);
+    for (int i = 0; i < sessionNum; ++i) {
+        fileNames.emplace_back("/benchmark/file" + std::to_string(i));
+    }
+
+    auto run = [&](int rounds) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadNum; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int r = 0; r < rounds; ++r) {
+                    for (int i = t; i < sessionNum; i += threadNum) {
+                        fileRecordManager.UpdateFileRecord(
+                            fileNames[i], "0.0.6", "127.0.0.1", 9000 + t);
+                    }
+                }
+            });
+        }
+        for (auto& th : threads) {
+            th.join();
+        }
+    };
+
+    // 打开所有文件
+    uint64_t startUs = curve::common::TimeUtility::GetTimeofDayUs();
+    run(1);
+    uint64_t openUs = curve::common::TimeUtility::GetTimeofDayUs() - startUs;
+    ASSERT_EQ(sessionNum, fileRecordManager.GetOpenFileNum());
+
+    // 续约
+    startUs = curve::common::TimeUtility::GetTimeofDayUs();
+    run(roundNum);
+    uint64_t refreshUs =
+        curve::common::TimeUtility::GetTimeofDayUs() - startUs;
+    ASSERT_EQ(sessionNum, fileRecordManager.GetOpenFileNum());
+
+    LOG(INFO) << "sessions: " << sessionNum
+              << ", threads: " << threadNum
+              << ", open qps: " << sessionNum * 1000000ULL / (openUs + 1)
+              << ", refresh qps: "
+              << 1ULL * sessionNum * roundNum * 1000000ULL / (refreshUs + 1);
+
+    fileRecordManager.Stop();
+}
+
 }  // namespace mds
 }  // namespace curve
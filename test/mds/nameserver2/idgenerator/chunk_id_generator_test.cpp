@@ -77,5 +77,41 @@ TEST_F(TestChunkIdGenerator, test_all) {
         ASSERT_EQ(i, res);
     }
 }
+
+TEST_F(TestChunkIdGenerator, test_gen_chunk_ids) {
+    uint64_t alloc1 = CHUNKINITIALIZE + CHUNKBUNDLEALLOCATED;
+    // remaining ids are not enough, a bundle larger than default is applied
+    uint64_t alloc2 = alloc1 + CHUNKBUNDLEALLOCATED + 10;
+    std::string strAlloc1 = NameSpaceStorageCodec::EncodeID(alloc1);
+    EXPECT_CALL(*client_, Get(CHUNKSTOREKEY, _))
+        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist))
+        .WillOnce(
+            DoAll(SetArgPointee<1>(strAlloc1), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*client_, CompareAndSwap(
+        CHUNKSTOREKEY, "", NameSpaceStorageCodec::EncodeID(alloc1)))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+    EXPECT_CALL(*client_, CompareAndSwap(
+        CHUNKSTOREKEY, strAlloc1, NameSpaceStorageCodec::EncodeID(alloc2)))
+        .WillOnce(Return(EtcdErrCode::EtcdOK));
+
+    std::vector<ChunkID> ids;
+    ASSERT_TRUE(chunkIdGen_->GenChunkIDs(10, &ids));
+    ASSERT_EQ(10, ids.size());
+    ASSERT_EQ(CHUNKINITIALIZE + 1, ids.front());
+    ASSERT_EQ(CHUNKINITIALIZE + 10, ids.back());
+
+    // 990 ids left in current bundle, apply 1010 more
+    ASSERT_TRUE(chunkIdGen_->GenChunkIDs(2 * CHUNKBUNDLEALLOCATED, &ids));
+    ASSERT_EQ(2 * CHUNKBUNDLEALLOCATED, ids.size());
+    for (uint32_t i = 0; i < ids.size(); i++) {
+        ASSERT_EQ(CHUNKINITIALIZE + 11 + i, ids[i]);
+    }
+    ASSERT_EQ(alloc2, ids.back());
+
+    // fail to apply bundle
+    EXPECT_CALL(*client_, Get(CHUNKSTOREKEY, _))
+        .WillOnce(Return(EtcdErrCode::EtcdDeadlineExceeded));
+    ASSERT_FALSE(chunkIdGen_->GenChunkIDs(20, &ids));
+}
 }  // namespace mds
 }  // namespace curve
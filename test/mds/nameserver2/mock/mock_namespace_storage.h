@@ -77,6 +77,10 @@ class MockNameServerStorage : public NameServerStorage {
                                          const PageFileSegment *,
                                          int64_t *));
 
+    MOCK_METHOD3(PutSegments, StoreStatus(InodeID,
+                                          const std::vector<PageFileSegment> &,
+                                          int64_t *));
+
     MOCK_METHOD3(DeleteSegment, StoreStatus(InodeID, uint64_t, int64_t*));
 
     MOCK_METHOD2(SnapShotFile, StoreStatus(const FileInfo *,
@@ -85,6 +89,9 @@ class MockNameServerStorage : public NameServerStorage {
         StoreStatus(std::vector<FileInfo> *snapShotFiles));
     MOCK_METHOD2(ListSegment,
         StoreStatus(InodeID, std::vector<PageFileSegment>*));
+    MOCK_METHOD4(ListSegmentInRange,
+        StoreStatus(InodeID, uint64_t, uint64_t,
+                    std::vector<PageFileSegment>*));
 
     MOCK_METHOD2(DiscardSegment,
                  StoreStatus(const FileInfo&, const PageFileSegment&));
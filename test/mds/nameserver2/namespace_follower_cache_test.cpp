@@ -0,0 +1,496 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <brpc/controller.h>
+
+#include <chrono>  // NOLINT
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "src/common/namespace_define.h"
+#include "src/common/timeutility.h"
+#include "src/mds/nameserver2/follower_namespace_service.h"
+#include "src/mds/nameserver2/helper/namespace_helper.h"
+#include "src/mds/nameserver2/namespace_follower_cache.h"
+#include "test/mds/mock/mock_etcdclient.h"
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::curve::common::TimeUtility;
+
+namespace curve {
+namespace mds {
+
+const uint32_t kChunkSize = 16 * 1024 * 1024;
+const uint32_t kSegmentSize = 1024 * 1024 * 1024;
+
+/**
+ * FakeEtcd keeps keys and change history in memory, it stands in for etcd
+ * with the mock client
+ */
+class FakeEtcd {
+ public:
+    FakeEtcd() : revision_(1), compactRevision_(0) {}
+
+    void PutFile(const FileInfo &fileInfo) {
+        std::string key = NameSpaceStorageCodec::EncodeFileStoreKey(
+            fileInfo.parentid(), fileInfo.filename());
+        std::string value;
+        ASSERT_TRUE(NameSpaceStorageCodec::EncodeFileInfo(fileInfo, &value));
+        kvs_[key] = value;
+        history_.push_back({OpType::OpPut, key, value, ++revision_});
+        log_.push_back(history_.back());
+    }
+
+    void DeleteFile(InodeID parentId, const std::string &fileName) {
+        std::string key =
+            NameSpaceStorageCodec::EncodeFileStoreKey(parentId, fileName);
+        kvs_.erase(key);
+        history_.push_back({OpType::OpDelete, key, "", ++revision_});
+        log_.push_back(history_.back());
+    }
+
+    void PutSegment(InodeID id, const PageFileSegment &segment) {
+        std::string key = NameSpaceStorageCodec::EncodeSegmentStoreKey(
+            id, segment.startoffset());
+        std::string value;
+        ASSERT_TRUE(NameSpaceStorageCodec::EncodeSegment(segment, &value));
+        kvs_[key] = value;
+        ++revision_;
+    }
+
+    void Compact() {
+        compactRevision_ = revision_;
+        history_.clear();
+    }
+
+    void Bind(MockEtcdClient *client) {
+        ON_CALL(*client, GetCurrentRevision(_))
+            .WillByDefault(Invoke([this](int64_t *revision) {
+                *revision = revision_;
+                return EtcdErrCode::EtcdOK;
+            }));
+        ON_CALL(*client, ListWithLimitAndRevision(_, _, _, _, _, _))
+            .WillByDefault(Invoke(this, &FakeEtcd::List));
+        ON_CALL(*client, WatchWithPrefix(_, _, _, _))
+            .WillByDefault(Invoke(this, &FakeEtcd::Watch));
+        ON_CALL(*client, CountWithRevision(_, _, _, _, _))
+            .WillByDefault(Invoke(this, &FakeEtcd::Count));
+        ON_CALL(*client, Get(_, _))
+            .WillByDefault(Invoke([this](const std::string &key,
+                                         std::string *out) {
+                auto iter = kvs_.find(key);
+                if (iter == kvs_.end()) {
+                    return EtcdErrCode::EtcdKeyNotExist;
+                }
+                *out = iter->second;
+                return EtcdErrCode::EtcdOK;
+            }));
+    }
+
+ private:
+    int List(const std::string &startKey, const std::string &endKey,
+             int64_t limit, int64_t revision,
+             std::vector<std::string> *values, std::string *lastKey) {
+        for (auto iter = kvs_.lower_bound(startKey);
+             iter != kvs_.end() && iter->first < endKey &&
+             values->size() < limit; ++iter) {
+            values->emplace_back(iter->second);
+            *lastKey = iter->first;
+        }
+        return EtcdErrCode::EtcdOK;
+    }
+
+    int Watch(const std::string &prefix, int64_t startRevision,
+              uint32_t timeoutMs, std::vector<WatchEvent> *events) {
+        events->clear();
+        if (startRevision <= compactRevision_) {
+            return EtcdErrCode::EtcdOutOfRange;
+        }
+        for (const auto &event : history_) {
+            if (event.revision >= startRevision &&
+                event.key.compare(0, prefix.size(), prefix) == 0) {
+                events->push_back(event);
+            }
+        }
+        return events->empty() ? EtcdErrCode::EtcdWatchTimeout
+                               : EtcdErrCode::EtcdOK;
+    }
+
+    int Count(const std::string &startKey, const std::string &endKey,
+              int64_t revision, int64_t minModRevision, int64_t *count) {
+        if (revision < compactRevision_) {
+            return EtcdErrCode::EtcdOutOfRange;
+        }
+        // key -> mod revision at the given revision
+        std::map<std::string, int64_t> keys;
+        for (const auto &event : log_) {
+            if (event.revision > revision || event.key < startKey ||
+                event.key >= endKey) {
+                continue;
+            }
+            if (event.type == OpType::OpDelete) {
+                keys.erase(event.key);
+            } else {
+                keys[event.key] = event.revision;
+            }
+        }
+        *count = 0;
+        for (const auto &key : keys) {
+            if (key.second >= minModRevision) {
+                ++*count;
+            }
+        }
+        return EtcdErrCode::EtcdOK;
+    }
+
+ private:
+    std::map<std::string, std::string> kvs_;
+    std::vector<WatchEvent> history_;
+    // history including the compacted part
+    std::vector<WatchEvent> log_;
+    int64_t revision_;
+    int64_t compactRevision_;
+};
+
+FileInfo MakeFile(InodeID id, InodeID parentId, const std::string &name,
+                  FileType type, const std::string &owner = "user1") {
+    FileInfo fileInfo;
+    fileInfo.set_id(id);
+    fileInfo.set_parentid(parentId);
+    fileInfo.set_filename(name);
+    fileInfo.set_filetype(type);
+    fileInfo.set_owner(owner);
+    fileInfo.set_chunksize(kChunkSize);
+    fileInfo.set_segmentsize(kSegmentSize);
+    fileInfo.set_length(type == FileType::INODE_PAGEFILE ?
+                        2 * kSegmentSize : 0);
+    return fileInfo;
+}
+
+class TestNameSpaceFollowerCache : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        client_ = std::make_shared<NiceMock<MockEtcdClient>>();
+        etcd_.Bind(client_.get());
+        option_.enable = true;
+        option_.watchTimeoutMs = 10;
+        option_.maxStalenessMs = 3000;
+        option_.retryIntervalMs = 10;
+
+        // /dir, /dir/file1
+        etcd_.PutFile(MakeFile(1, 0, "dir", FileType::INODE_DIRECTORY));
+        etcd_.PutFile(MakeFile(2, 1, "file1", FileType::INODE_PAGEFILE));
+    }
+
+    void TearDown() override {
+        cache_ = nullptr;
+        client_ = nullptr;
+    }
+
+    void InitCache() {
+        cache_ = std::make_shared<NameSpaceFollowerCache>(client_, option_);
+        ASSERT_TRUE(cache_->Init());
+    }
+
+ protected:
+    FakeEtcd etcd_;
+    std::shared_ptr<NiceMock<MockEtcdClient>> client_;
+    FollowerReadOption option_;
+    std::shared_ptr<NameSpaceFollowerCache> cache_;
+};
+
+TEST_F(TestNameSpaceFollowerCache, test_load) {
+    // more files than one list bundle
+    for (int i = 0; i < 2500; i++) {
+        etcd_.PutFile(MakeFile(100 + i, 1, "file" + std::to_string(100 + i),
+                               FileType::INODE_PAGEFILE));
+    }
+    InitCache();
+    ASSERT_TRUE(cache_->IsFresh());
+
+    FileInfo fileInfo;
+    ASSERT_EQ(StoreStatus::OK, cache_->GetFile(0, "dir", &fileInfo));
+    ASSERT_EQ(1, fileInfo.id());
+    ASSERT_EQ(StoreStatus::OK, cache_->GetFile(1, "file2599", &fileInfo));
+    ASSERT_EQ(2599, fileInfo.id());
+    ASSERT_EQ(StoreStatus::KeyNotExist,
+              cache_->GetFile(1, "file3000", &fileInfo));
+
+    std::vector<FileInfo> files;
+    ASSERT_EQ(StoreStatus::OK, cache_->ListFile(1, 2, &files));
+    ASSERT_EQ(2501, files.size());
+    files.clear();
+    ASSERT_EQ(StoreStatus::OK, cache_->ListFile(0, 1, &files));
+    ASSERT_EQ(1, files.size());
+}
+
+TEST_F(TestNameSpaceFollowerCache, test_sync_changes) {
+    InitCache();
+    int64_t loadRevision = cache_->GetSyncedRevision();
+    std::shared_ptr<const FileInfo> oldFile;
+    ASSERT_EQ(StoreStatus::OK, cache_->GetFile(1, "file1", &oldFile));
+    uint64_t oldLength = oldFile->length();
+    ASSERT_NE(3 * kSegmentSize, oldLength);
+
+    etcd_.PutFile(MakeFile(3, 1, "file2", FileType::INODE_PAGEFILE));
+    FileInfo resized = MakeFile(2, 1, "file1", FileType::INODE_PAGEFILE);
+    resized.set_length(3 * kSegmentSize);
+    etcd_.PutFile(resized);
+    etcd_.DeleteFile(0, "dir");
+
+    ASSERT_TRUE(cache_->SyncOnce());
+    ASSERT_EQ(loadRevision + 3, cache_->GetSyncedRevision());
+
+    FileInfo fileInfo;
+    ASSERT_EQ(StoreStatus::OK, cache_->GetFile(1, "file2", &fileInfo));
+    ASSERT_EQ(3, fileInfo.id());
+    ASSERT_EQ(StoreStatus::OK, cache_->GetFile(1, "file1", &fileInfo));
+    ASSERT_EQ(3 * kSegmentSize, fileInfo.length());
+    // file infos already returned are not modified by later changes
+    ASSERT_EQ(oldLength, oldFile->length());
+    ASSERT_EQ(StoreStatus::KeyNotExist, cache_->GetFile(0, "dir", &fileInfo));
+
+    // segments are read from etcd directly
+    PageFileSegment segment;
+    segment.set_logicalpoolid(1);
+    segment.set_segmentsize(kSegmentSize);
+    segment.set_chunksize(kChunkSize);
+    segment.set_startoffset(kSegmentSize);
+    etcd_.PutSegment(2, segment);
+    PageFileSegment out;
+    ASSERT_EQ(StoreStatus::OK, cache_->GetSegment(2, kSegmentSize, &out));
+    ASSERT_EQ(kSegmentSize, out.startoffset());
+    ASSERT_EQ(StoreStatus::KeyNotExist, cache_->GetSegment(2, 0, &out));
+
+    // nothing changed except the segment
+    ASSERT_TRUE(cache_->SyncOnce());
+    ASSERT_EQ(loadRevision + 4, cache_->GetSyncedRevision());
+    ASSERT_TRUE(cache_->IsFresh());
+}
+
+TEST_F(TestNameSpaceFollowerCache, test_not_skip_changes_on_watch_timeout) {
+    InitCache();
+    int64_t loadRevision = cache_->GetSyncedRevision();
+    etcd_.PutFile(MakeFile(3, 1, "file2", FileType::INODE_PAGEFILE));
+
+    // the watch times out before history comes
+    EXPECT_CALL(*client_, WatchWithPrefix(_, _, _, _))
+        .WillOnce(Return(EtcdErrCode::EtcdWatchTimeout))
+        .WillOnce(Return(EtcdErrCode::EtcdWatchClosed));
+    ASSERT_FALSE(cache_->SyncOnce());
+    ASSERT_EQ(loadRevision, cache_->GetSyncedRevision());
+    ASSERT_FALSE(cache_->SyncOnce());
+    ASSERT_EQ(loadRevision, cache_->GetSyncedRevision());
+
+    // a file created and deleted leaves files unchanged
+    etcd_.PutFile(MakeFile(4, 1, "file3", FileType::INODE_PAGEFILE));
+    etcd_.DeleteFile(1, "file3");
+    etcd_.DeleteFile(1, "file2");
+    EXPECT_CALL(*client_, WatchWithPrefix(_, _, _, _))
+        .WillOnce(Return(EtcdErrCode::EtcdWatchTimeout));
+    ASSERT_TRUE(cache_->SyncOnce());
+    ASSERT_EQ(loadRevision + 4, cache_->GetSyncedRevision());
+
+    // a file deleted is a change even if nothing is modified
+    etcd_.DeleteFile(1, "file1");
+    EXPECT_CALL(*client_, WatchWithPrefix(_, _, _, _))
+        .WillOnce(Return(EtcdErrCode::EtcdWatchTimeout));
+    ASSERT_FALSE(cache_->SyncOnce());
+    ASSERT_EQ(loadRevision + 4, cache_->GetSyncedRevision());
+}
+
+TEST_F(TestNameSpaceFollowerCache, test_reload_after_compaction) {
+    InitCache();
+
+    etcd_.PutFile(MakeFile(3, 1, "file2", FileType::INODE_PAGEFILE));
+    etcd_.DeleteFile(1, "file1");
+    etcd_.Compact();
+
+    ASSERT_TRUE(cache_->SyncOnce());
+    FileInfo fileInfo;
+    ASSERT_EQ(StoreStatus::OK, cache_->GetFile(1, "file2", &fileInfo));
+    ASSERT_EQ(StoreStatus::KeyNotExist,
+              cache_->GetFile(1, "file1", &fileInfo));
+    ASSERT_TRUE(cache_->IsFresh());
+}
+
+TEST_F(TestNameSpaceFollowerCache, test_stale_when_watch_fail) {
+    option_.maxStalenessMs = 100;
+    InitCache();
+    ASSERT_TRUE(cache_->IsFresh());
+
+    EXPECT_CALL(*client_, WatchWithPrefix(_, _, _, _))
+        .WillRepeatedly(Return(EtcdErrCode::EtcdDeadlineExceeded));
+    cache_->Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_FALSE(cache_->IsFresh());
+    cache_->Stop();
+}
+
+TEST_F(TestNameSpaceFollowerCache, test_sync_thread) {
+    InitCache();
+    etcd_.PutFile(MakeFile(3, 1, "file2", FileType::INODE_PAGEFILE));
+    cache_->Start();
+
+    FileInfo fileInfo;
+    for (int i = 0; i < 100; i++) {
+        if (cache_->GetFile(1, "file2", &fileInfo) == StoreStatus::OK) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(3, fileInfo.id());
+    ASSERT_TRUE(cache_->IsFresh());
+    cache_->Stop();
+}
+
+TEST_F(TestNameSpaceFollowerCache, test_follower_storage) {
+    InitCache();
+    NameSpaceFollowerStorage storage(cache_);
+
+    FileInfo fileInfo;
+    ASSERT_EQ(StoreStatus::OK, storage.GetFile(1, "file1", &fileInfo));
+    ASSERT_EQ(2, fileInfo.id());
+    std::vector<FileInfo> files;
+    ASSERT_EQ(StoreStatus::OK, storage.ListFile(1, 2, &files));
+    ASSERT_EQ(1, files.size());
+
+    // read-only
+    ASSERT_EQ(StoreStatus::InternalError, storage.PutFile(fileInfo));
+    ASSERT_EQ(StoreStatus::InternalError, storage.DeleteFile(1, "file1"));
+    int64_t revision;
+    PageFileSegment segment;
+    ASSERT_EQ(StoreStatus::InternalError,
+              storage.PutSegment(2, 0, &segment, &revision));
+    ASSERT_EQ(StoreStatus::OK, storage.GetFile(1, "file1", &fileInfo));
+}
+
+TEST_F(TestNameSpaceFollowerCache, test_follower_service) {
+    InitCache();
+    RootAuthOption authOption;
+    authOption.rootOwner = "root";
+    authOption.rootPassword = "root_password";
+    FollowerNameSpaceService service(cache_, authOption);
+
+    // get file info
+    {
+        brpc::Controller cntl;
+        GetFileInfoRequest request;
+        GetFileInfoResponse response;
+        request.set_filename("/dir/file1");
+        request.set_owner("user1");
+        request.set_date(TimeUtility::GetTimeofDayUs());
+        service.GetFileInfo(&cntl, &request, &response, nullptr);
+        ASSERT_FALSE(cntl.Failed());
+        ASSERT_EQ(StatusCode::kOK, response.statuscode());
+        ASSERT_EQ(2, response.fileinfo().id());
+    }
+    {
+        brpc::Controller cntl;
+        GetFileInfoRequest request;
+        GetFileInfoResponse response;
+        request.set_filename("/dir/file1");
+        request.set_owner("user2");
+        request.set_date(TimeUtility::GetTimeofDayUs());
+        service.GetFileInfo(&cntl, &request, &response, nullptr);
+        ASSERT_EQ(StatusCode::kOwnerAuthFail, response.statuscode());
+    }
+    {
+        brpc::Controller cntl;
+        GetFileInfoRequest request;
+        GetFileInfoResponse response;
+        request.set_filename("/dir/file2");
+        request.set_owner("user1");
+        request.set_date(TimeUtility::GetTimeofDayUs());
+        service.GetFileInfo(&cntl, &request, &response, nullptr);
+        ASSERT_EQ(StatusCode::kFileNotExists, response.statuscode());
+    }
+
+    // list dir
+    {
+        brpc::Controller cntl;
+        ListDirRequest request;
+        ListDirResponse response;
+        request.set_filename("/dir");
+        request.set_owner("user1");
+        request.set_date(TimeUtility::GetTimeofDayUs());
+        service.ListDir(&cntl, &request, &response, nullptr);
+        ASSERT_EQ(StatusCode::kOK, response.statuscode());
+        ASSERT_EQ(1, response.fileinfo_size());
+        ASSERT_EQ("file1", response.fileinfo(0).filename());
+    }
+
+    // get segment, allocating is not allowed
+    {
+        brpc::Controller cntl;
+        GetOrAllocateSegmentRequest request;
+        GetOrAllocateSegmentResponse response;
+        request.set_filename("/dir/file1");
+        request.set_offset(0);
+        request.set_allocateifnotexist(false);
+        request.set_owner("user1");
+        request.set_date(TimeUtility::GetTimeofDayUs());
+        service.GetOrAllocateSegment(&cntl, &request, &response, nullptr);
+        ASSERT_EQ(StatusCode::kSegmentNotAllocated, response.statuscode());
+    }
+    {
+        brpc::Controller cntl;
+        GetOrAllocateSegmentRequest request;
+        GetOrAllocateSegmentResponse response;
+        request.set_filename("/dir/file1");
+        request.set_offset(0);
+        request.set_allocateifnotexist(true);
+        request.set_owner("user1");
+        request.set_date(TimeUtility::GetTimeofDayUs());
+        service.GetOrAllocateSegment(&cntl, &request, &response, nullptr);
+        ASSERT_TRUE(cntl.Failed());
+    }
+}
+
+TEST_F(TestNameSpaceFollowerCache, test_follower_service_stale) {
+    option_.maxStalenessMs = 10;
+    InitCache();
+    RootAuthOption authOption;
+    FollowerNameSpaceService service(cache_, authOption);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    brpc::Controller cntl;
+    GetFileInfoRequest request;
+    GetFileInfoResponse response;
+    request.set_filename("/dir/file1");
+    request.set_owner("user1");
+    request.set_date(TimeUtility::GetTimeofDayUs());
+    service.GetFileInfo(&cntl, &request, &response, nullptr);
+    ASSERT_TRUE(cntl.Failed());
+    ASSERT_EQ(EAGAIN, cntl.ErrorCode());
+}
+
+}  // namespace mds
+}  // namespace curve
@@ -2806,5 +2806,80 @@ TEST_F(NameSpaceServiceTest, TestDeAllocateSegment) {
     }
 }
 
+TEST_F(NameSpaceServiceTest, TestExtendFileWithPreallocate) {
+    brpc::Server server;
+
+    NameSpaceService nameSpaceSerivce(new FileLockManager(13));
+
+    ASSERT_EQ(0, server.AddService(&nameSpaceSerivce,
+                                   brpc::SERVER_DOESNT_OWN_SERVICE));
+
+    brpc::ServerOptions opt;
+    opt.idle_timeout_sec = -1;
+    ASSERT_EQ(0, server.Start("127.0.0.1", {8900, 8999}, &opt));
+
+    brpc::Channel channel;
+    ASSERT_EQ(channel.Init(server.listen_address(), nullptr), 0);
+
+    CurveFSService_Stub stub(&channel);
+    brpc::Controller cntl;
+    std::string filename = "/TestExtendFileWithPreallocate";
+    std::string owner = "curve";
+
+    CreateFileRequest createRequest;
+    CreateFileResponse createResponse;
+    createRequest.set_filename(filename);
+    createRequest.set_owner(owner);
+    createRequest.set_date(TimeUtility::GetTimeofDayUs());
+    createRequest.set_filetype(INODE_PAGEFILE);
+    createRequest.set_filelength(10 * kGB);
+    stub.CreateFile(&cntl, &createRequest, &createResponse, nullptr);
+    ASSERT_FALSE(cntl.Failed());
+    ASSERT_EQ(StatusCode::kOK, createResponse.statuscode());
+
+    cntl.Reset();
+    ExtendFileRequest extendRequest;
+    ExtendFileResponse extendResponse;
+    extendRequest.set_filename(filename);
+    extendRequest.set_owner(owner);
+    extendRequest.set_date(TimeUtility::GetTimeofDayUs());
+    extendRequest.set_newsize(12 * kGB);
+    extendRequest.set_preallocate(true);
+    stub.ExtendFile(&cntl, &extendRequest, &extendResponse, nullptr);
+    ASSERT_FALSE(cntl.Failed());
+    ASSERT_EQ(StatusCode::kOK, extendResponse.statuscode());
+
+    auto getSegment = [&](uint64_t offset) {
+        cntl.Reset();
+        GetOrAllocateSegmentRequest request;
+        GetOrAllocateSegmentResponse response;
+        request.set_filename(filename);
+        request.set_offset(offset);
+        request.set_allocateifnotexist(false);
+        request.set_owner(owner);
+        request.set_date(TimeUtility::GetTimeofDayUs());
+        stub.GetOrAllocateSegment(&cntl, &request, &response, nullptr);
+        EXPECT_FALSE(cntl.Failed());
+        return response.statuscode();
+    };
+
+    // segments of the extended range are preallocated in background
+    for (int i = 0; i < 100; ++i) {
+        if (getSegment(11 * kGB) == StatusCode::kOK) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    ASSERT_EQ(StatusCode::kOK, getSegment(10 * kGB));
+    ASSERT_EQ(StatusCode::kOK, getSegment(11 * kGB));
+
+    // the range before extend is not allocated
+    ASSERT_EQ(StatusCode::kSegmentNotAllocated, getSegment(0));
+    ASSERT_EQ(StatusCode::kSegmentNotAllocated, getSegment(9 * kGB));
+
+    server.Stop(0);
+    server.Join();
+}
+
 }  // namespace mds
 }  // namespace curve
@@ -22,8 +22,11 @@
 
 #include <gtest/gtest.h>
 #include <glog/logging.h>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "src/mds/nameserver2/namespace_storage_cache.h"
 #include "src/mds/nameserver2/namespace_storage.h"
 #include "src/mds/nameserver2/helper/namespace_helper.h"
@@ -31,35 +34,56 @@
 
 namespace curve {
 namespace mds {
+
+namespace {
+
+CacheValue MakeFileInfo(const std::string &filename) {
+    auto fileinfo = std::make_shared<FileInfo>();
+    fileinfo->set_filename(filename);
+    return fileinfo;
+}
+
+std::string FileName(const CacheValue &value) {
+    return static_cast<const FileInfo&>(*value).filename();
+}
+
+uint64_t ItemSize(const std::string &key, const CacheValue &value) {
+    return key.size() + value->ByteSizeLong();
+}
+
+}  // namespace
+
 TEST(CaCheTest, test_cache_with_capacity_limit) {
     int maxCount = 5;
-    std::shared_ptr<LRUCache> cache = std::make_shared<LRUCache>(maxCount);
+    // one shard, evicted exactly in lru order
+    std::shared_ptr<LRUCache> cache = std::make_shared<LRUCache>(maxCount, 1);
 
     // 1. 测试 put/get
     uint64_t cacheSize = 0;
     for (int i = 1; i <= maxCount + 1; i++) {
-        cache->Put(std::to_string(i), std::to_string(i));
+        std::string key = std::to_string(i);
+        cache->Put(key, MakeFileInfo(key));
+        cacheSize += ItemSize(key, MakeFileInfo(key));
         if (i <= maxCount) {
-            cacheSize += std::to_string(i).size() * 2;
             ASSERT_EQ(i, cache->GetCacheMetrics()->cacheCount.get_value());
         } else {
-            cacheSize +=
-                std::to_string(i).size() * 2 - std::to_string(1).size() * 2;
-            ASSERT_EQ(
-                cacheSize, cache->GetCacheMetrics()->cacheBytes.get_value());
+            cacheSize -= ItemSize("1", MakeFileInfo("1"));
+            ASSERT_EQ(maxCount,
+                cache->GetCacheMetrics()->cacheCount.get_value());
         }
+        ASSERT_EQ(cacheSize, cache->GetCacheMetrics()->cacheBytes.get_value());
 
-        std::string res;
-        ASSERT_TRUE(cache->Get(std::to_string(i), &res));
-        ASSERT_EQ(std::to_string(i), res);
+        CacheValue res;
+        ASSERT_TRUE(cache->Get(key, &res));
+        ASSERT_EQ(key, FileName(res));
     }
 
     // 2. 第一个元素被剔出
-    std::string res;
+    CacheValue res;
     ASSERT_FALSE(cache->Get(std::to_string(1), &res));
     for (int i = 2; i <= maxCount + 1; i++) {
         ASSERT_TRUE(cache->Get(std::to_string(i), &res));
-        ASSERT_EQ(std::to_string(i), res);
+        ASSERT_EQ(std::to_string(i), FileName(res));
     }
 
     // 3. 测试删除元素
@@ -68,63 +92,150 @@ TEST(CaCheTest, test_cache_with_capacity_limit) {
     // 删除list中存在的元素
     cache->Remove("2");
     ASSERT_FALSE(cache->Get("2", &res));
-    cacheSize -= std::to_string(2).size() * 2;
+    cacheSize -= ItemSize("2", MakeFileInfo("2"));
     ASSERT_EQ(maxCount - 1, cache->GetCacheMetrics()->cacheCount.get_value());
     ASSERT_EQ(cacheSize, cache->GetCacheMetrics()->cacheBytes.get_value());
 
     // 4. 重复put
-    cache->Put("4", "hello");
+    cache->Put("4", MakeFileInfo("hello"));
     ASSERT_TRUE(cache->Get("4", &res));
-    ASSERT_EQ("hello", res);
+    ASSERT_EQ("hello", FileName(res));
     ASSERT_EQ(maxCount - 1, cache->GetCacheMetrics()->cacheCount.get_value());
-    cacheSize -= std::to_string(4).size() * 2;
-    cacheSize += std::to_string(4).size() + std::string("hello").size();
+    cacheSize -= ItemSize("4", MakeFileInfo("4"));
+    cacheSize += ItemSize("4", MakeFileInfo("hello"));
     ASSERT_EQ(cacheSize, cache->GetCacheMetrics()->cacheBytes.get_value());
+
+    // 5. get moves item to front, the oldest one is evicted
+    ASSERT_TRUE(cache->Get("3", &res));
+    cache->Put("7", MakeFileInfo("7"));
+    cache->Put("8", MakeFileInfo("8"));
+    ASSERT_TRUE(cache->Get("3", &res));
+    ASSERT_TRUE(cache->Get("4", &res));
+    ASSERT_FALSE(cache->Get("5", &res));
 }
 
 TEST(CaCheTest, test_cache_with_capacity_no_limit) {
     std::shared_ptr<LRUCache> cache = std::make_shared<LRUCache>();
 
     // 1. 测试 put/get
-    std::string res;
+    CacheValue res;
     for (int i = 1; i <= 10; i++) {
-        cache->Put(std::to_string(i), std::to_string(i));
+        cache->Put(std::to_string(i), MakeFileInfo(std::to_string(i)));
         ASSERT_TRUE(cache->Get(std::to_string(i), &res));
-        ASSERT_EQ(std::to_string(i), res);
+        ASSERT_EQ(std::to_string(i), FileName(res));
     }
 
     // 2. 测试元素删除
     cache->Remove("1");
     ASSERT_FALSE(cache->Get("1", &res));
 }
+
+TEST(CaCheTest, test_cache_with_shards) {
+    int maxCount = 64;
+    std::shared_ptr<LRUCache> cache = std::make_shared<LRUCache>(maxCount, 4);
+
+    for (int i = 0; i < 10 * maxCount; i++) {
+        cache->Put(std::to_string(i), MakeFileInfo(std::to_string(i)));
+    }
+
+    ASSERT_LE(cache->GetCacheMetrics()->cacheCount.get_value(), maxCount);
+
+    // recently put items are kept
+    CacheValue res;
+    ASSERT_TRUE(cache->Get(std::to_string(10 * maxCount - 1), &res));
+}
+
+TEST(CaCheTest, test_cache_negative_entry) {
+    std::shared_ptr<LRUCache> cache = std::make_shared<LRUCache>(5, 1);
+    std::string key = NameSpaceStorageCodec::EncodeFileStoreKey(1, "file");
+
+    // negative entry read from etcd is cached
+    uint64_t revision = cache->GetRevision(key);
+    ASSERT_TRUE(cache->PutIfRevisionMatch(key, nullptr, revision));
+    CacheValue res = MakeFileInfo("stale");
+    ASSERT_TRUE(cache->Get(key, &res));
+    ASSERT_EQ(nullptr, res);
+    ASSERT_EQ(key.size(),
+              cache->GetCacheMetrics()->cacheBytes.get_value());
+
+    // file created, negative entry is overwritten
+    cache->Put(key, MakeFileInfo("file"));
+    ASSERT_TRUE(cache->Get(key, &res));
+    ASSERT_EQ("file", FileName(res));
+
+    // file created concurrently with reading etcd,
+    // negative entry is not put into cache
+    cache->Remove(key);
+    revision = cache->GetRevision(key);
+    cache->Put(key, MakeFileInfo("file"));
+    ASSERT_FALSE(cache->PutIfRevisionMatch(key, nullptr, revision));
+    ASSERT_TRUE(cache->Get(key, &res));
+    ASSERT_EQ("file", FileName(res));
+}
+
+TEST(CaCheTest, test_cache_negative_entry_capacity_limit) {
+    int maxCount = 5;
+    int maxNegativeCount = 2;
+    std::shared_ptr<LRUCache> cache =
+        std::make_shared<LRUCache>(maxCount, 1, maxNegativeCount);
+    for (int i = 0; i < maxCount; i++) {
+        cache->Put(std::to_string(i), MakeFileInfo(std::to_string(i)));
+    }
+
+    // a burst of missing-name lookups only evicts negative entries
+    for (int i = 0; i < 10 * maxCount; i++) {
+        std::string key = "missing" + std::to_string(i);
+        uint64_t revision = cache->GetRevision(key);
+        ASSERT_TRUE(cache->PutIfRevisionMatch(key, nullptr, revision));
+    }
+    ASSERT_EQ(maxCount + maxNegativeCount,
+              cache->GetCacheMetrics()->cacheCount.get_value());
+    CacheValue res;
+    for (int i = 0; i < maxCount; i++) {
+        ASSERT_TRUE(cache->Get(std::to_string(i), &res));
+        ASSERT_EQ(std::to_string(i), FileName(res));
+    }
+    ASSERT_FALSE(cache->Get("missing0", &res));
+    ASSERT_TRUE(cache->Get("missing" + std::to_string(10 * maxCount - 1),
+                           &res));
+    ASSERT_EQ(nullptr, res);
+
+    // negative entry overwritten by the created file moves to the lru list
+    // of real values
+    std::string key = "missing" + std::to_string(10 * maxCount - 1);
+    cache->Put(key, MakeFileInfo("created"));
+    ASSERT_EQ(maxCount + maxNegativeCount - 1,
+              cache->GetCacheMetrics()->cacheCount.get_value());
+    ASSERT_TRUE(cache->Get(key, &res));
+    ASSERT_EQ("created", FileName(res));
+    ASSERT_FALSE(cache->Get("0", &res));
+}
+
 TEST(CaCheTest, test_cache_with_large_data_capacity_no_limit) {
     uint64_t DefaultChunkSize = 16 * kMB;
     std::shared_ptr<LRUCache> cache = std::make_shared<LRUCache>();
 
     int i = 1;
-    FileInfo fileinfo;
+    auto fileinfo = std::make_shared<FileInfo>();
     std::string filename = "helloword-" + std::to_string(i) + ".log";
-    fileinfo.set_id(i);
-    fileinfo.set_filename(filename);
-    fileinfo.set_parentid(i << 8);
-    fileinfo.set_filetype(FileType::INODE_PAGEFILE);
-    fileinfo.set_chunksize(DefaultChunkSize);
-    fileinfo.set_length(10 << 20);
-    fileinfo.set_ctime(::curve::common::TimeUtility::GetTimeofDayUs());
-    fileinfo.set_seqnum(1);
-    std::string encodeFileInfo;
-    ASSERT_TRUE(fileinfo.SerializeToString(&encodeFileInfo));
+    fileinfo->set_id(i);
+    fileinfo->set_filename(filename);
+    fileinfo->set_parentid(i << 8);
+    fileinfo->set_filetype(FileType::INODE_PAGEFILE);
+    fileinfo->set_chunksize(DefaultChunkSize);
+    fileinfo->set_length(10 << 20);
+    fileinfo->set_ctime(::curve::common::TimeUtility::GetTimeofDayUs());
+    fileinfo->set_seqnum(1);
     std::string encodeKey =
             NameSpaceStorageCodec::EncodeFileStoreKey(i << 8, filename);
 
     // 1. put/get
-    cache->Put(encodeKey, encodeFileInfo);
-    std::string out;
+    cache->Put(encodeKey, fileinfo);
+    CacheValue out;
     ASSERT_TRUE(cache->Get(encodeKey, &out));
-    FileInfo fileinfoout;
-    ASSERT_TRUE(NameSpaceStorageCodec::DecodeFileInfo(out, &fileinfoout));
-    NameSpaceStorageCodec::DecodeFileInfo(out, &fileinfoout);
+    const FileInfo& fileinfoout = static_cast<const FileInfo&>(*out);
     ASSERT_EQ(filename, fileinfoout.filename());
+    ASSERT_EQ(DefaultChunkSize, fileinfoout.chunksize());
 
     // 2. remove
     cache->Remove(encodeKey);
@@ -138,9 +249,9 @@ TEST(CaCheTest, TestCacheHitAndMissMetric) {
 
     std::string existKey = "hello";
     std::string notExistKey = "world";
-    cache->Put(existKey, existKey);
+    cache->Put(existKey, MakeFileInfo(existKey));
 
-    std::string out;
+    CacheValue out;
     for (int i = 0; i < 10; ++i) {
         ASSERT_TRUE(cache->Get(existKey, &out));
         ASSERT_FALSE(cache->Get(notExistKey, &out));
@@ -157,6 +268,74 @@ TEST(CaCheTest, TestCacheHitAndMissMetric) {
     ASSERT_EQ(10, cache->GetCacheMetrics()->cacheMiss.get_value());
 }
 
+TEST(CaCheTest, TestPutIfRevisionMatch) {
+    std::shared_ptr<LRUCache> cache = std::make_shared<LRUCache>();
+    CacheValue out;
+
+    // 1. no modification since revision, value is filled
+    uint64_t revision = cache->GetRevision("key");
+    ASSERT_TRUE(cache->PutIfRevisionMatch("key", MakeFileInfo("v1"),
+                                          revision));
+    ASSERT_TRUE(cache->Get("key", &out));
+    ASSERT_EQ("v1", FileName(out));
+
+    // 2. key is updated while reading from etcd, stale value is skipped
+    revision = cache->GetRevision("key");
+    cache->Put("key", MakeFileInfo("v2"));
+    ASSERT_FALSE(cache->PutIfRevisionMatch("key", MakeFileInfo("v1"),
+                                           revision));
+    ASSERT_TRUE(cache->Get("key", &out));
+    ASSERT_EQ("v2", FileName(out));
+
+    // 3. key is removed while reading from etcd
+    revision = cache->GetRevision("key");
+    cache->Remove("key");
+    ASSERT_FALSE(cache->PutIfRevisionMatch("key", MakeFileInfo("v2"),
+                                           revision));
+    ASSERT_FALSE(cache->Get("key", &out));
+}
+
+TEST(CaCheTest, DISABLED_TestConcurrentGetPerformance) {
+    const int keyNum = 10000;
+    const int threadNum = 8;
+    const int getPerThread = 200000;
+
+    for (int shardNum : {1, LRUCache::kDefaultShardNum}) {
+        std::shared_ptr<LRUCache> cache =
+            std::make_shared<LRUCache>(keyNum, shardNum);
+        for (int i = 0; i < keyNum; ++i) {
+            cache->Put(std::to_string(i), MakeFileInfo(std::to_string(i)));
+        }
+
+        std::atomic<uint64_t> hit(0);
+        uint64_t startUs = ::curve::common::TimeUtility::GetTimeofDayUs();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadNum; ++t) {
+            threads.emplace_back([&, t]() {
+                CacheValue out;
+                FileInfo copied;
+                for (int i = 0; i < getPerThread; ++i) {
+                    std::string key = std::to_string((i * 7 + t) % keyNum);
+                    if (cache->Get(key, &out)) {
+                        copied.CopyFrom(static_cast<const FileInfo&>(*out));
+                        hit.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        uint64_t costUs =
+            ::curve::common::TimeUtility::GetTimeofDayUs() - startUs;
+
+        ASSERT_EQ(threadNum * getPerThread, hit.load());
+        LOG(INFO) << "shard num = " << shardNum
+                  << ", threads = " << threadNum
+                  << ", get qps = "
+                  << threadNum * getPerThread * 1000000.0 / (costUs + 1);
+    }
+}
 
 }  // namespace mds
 }  // namespace curve
@@ -161,9 +161,13 @@ TEST_F(TestNameServerStorageImp, test_GetFile) {
     // 1. get file err
     FileInfo fileinfo;
     EXPECT_CALL(*cache_, Get(_, _)).Times(2).WillRepeatedly(Return(false));
+    EXPECT_CALL(*cache_, GetRevision(_)).Times(2).WillRepeatedly(Return(1));
     EXPECT_CALL(*client_, Get(_, _))
         .WillOnce(Return(EtcdErrCode::EtcdDeadlineExceeded))
         .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist));
+    // only file not exist is cached as negative entry
+    EXPECT_CALL(*cache_, PutIfRevisionMatch(_, CacheValue(nullptr), 1))
+        .WillOnce(Return(true));
     ASSERT_EQ(StoreStatus::InternalError, storage_->GetFile(fileinfo.parentid(),
                                                             fileinfo.filename(),
                                                             &fileinfo));
@@ -171,6 +175,15 @@ TEST_F(TestNameServerStorageImp, test_GetFile) {
                                                           fileinfo.filename(),
                                                           &fileinfo));
 
+    // negative entry hit, not go to etcd
+    EXPECT_CALL(*cache_, Get(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(CacheValue(nullptr)),
+                        Return(true)));
+    EXPECT_CALL(*client_, Get(_, _)).Times(0);
+    ASSERT_EQ(StoreStatus::KeyNotExist, storage_->GetFile(fileinfo.parentid(),
+                                                          fileinfo.filename(),
+                                                          &fileinfo));
+
     // 2. get file ok
     FileInfo getInfo;
     std::string encodeFileinfo;
@@ -178,8 +191,9 @@ TEST_F(TestNameServerStorageImp, test_GetFile) {
     ASSERT_TRUE(NameSpaceStorageCodec::EncodeFileInfo(fileinfo,
                                                       &encodeFileinfo));
     EXPECT_CALL(*cache_, Get(_, _)).WillOnce(Return(false));
-    EXPECT_CALL(*cache_, Put(_, _))
-        .Times(1);
+    EXPECT_CALL(*cache_, GetRevision(_)).WillOnce(Return(1));
+    EXPECT_CALL(*cache_, PutIfRevisionMatch(_, _, 1))
+        .WillOnce(Return(true));
     EXPECT_CALL(*client_, Get(_, _))
         .WillOnce(DoAll(SetArgPointee<1>(encodeFileinfo),
                   Return(EtcdErrCode::EtcdOK)));
@@ -190,13 +204,25 @@ TEST_F(TestNameServerStorageImp, test_GetFile) {
     ASSERT_EQ(fileinfo.parentid(), getInfo.parentid());
 
     // 3. get file from cache ok
+    CacheValue cachedFileInfo = std::make_shared<const FileInfo>(fileinfo);
     EXPECT_CALL(*cache_, Get(_, _))
-        .WillOnce(DoAll(SetArgPointee<1>(encodeFileinfo), Return(true)));
+        .WillOnce(DoAll(SetArgPointee<1>(cachedFileInfo), Return(true)));
+    EXPECT_CALL(*client_, Get(_, _)).Times(0);
     ASSERT_EQ(StoreStatus::OK, storage_->GetFile(fileinfo.parentid(),
                                                  fileinfo.filename(),
                                                  &getInfo));
     ASSERT_EQ(fileinfo.filename(), getInfo.filename());
     ASSERT_EQ(fileinfo.parentid(), getInfo.parentid());
+
+    // 4. cached file info is shared without copy
+    std::shared_ptr<const FileInfo> sharedInfo;
+    EXPECT_CALL(*cache_, Get(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(cachedFileInfo), Return(true)));
+    EXPECT_CALL(*client_, Get(_, _)).Times(0);
+    ASSERT_EQ(StoreStatus::OK, storage_->GetFile(fileinfo.parentid(),
+                                                 fileinfo.filename(),
+                                                 &sharedInfo));
+    ASSERT_EQ(cachedFileInfo.get(), sharedInfo.get());
 }
 
 TEST_F(TestNameServerStorageImp, test_DeleteFile) {
@@ -366,6 +392,61 @@ TEST_F(TestNameServerStorageImp, test_putsegment) {
         storage_->PutSegment(0, 0, &segment, &revision));
 }
 
+TEST_F(TestNameServerStorageImp, test_putsegments) {
+    std::vector<PageFileSegment> segments(3);
+    for (int i = 0; i < 3; i++) {
+        segments[i].set_segmentsize(1024*1024*1024);
+        segments[i].set_chunksize(16*1024*1024);
+        segments[i].set_startoffset(i * 1024*1024*1024ull);
+        segments[i].set_logicalpoolid(1);
+    }
+
+    // empty segments
+    int64_t revision = 0;
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _)).Times(0);
+    ASSERT_EQ(StoreStatus::OK,
+              storage_->PutSegments(0, std::vector<PageFileSegment>{},
+                                    &revision));
+
+    // all segments in one txn
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(100), Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(Return(EtcdErrCode::EtcdCanceled));
+    EXPECT_CALL(*cache_, Put(_, _)).Times(3);
+    ASSERT_EQ(StoreStatus::OK, storage_->PutSegments(0, segments, &revision));
+    ASSERT_EQ(100, revision);
+    ASSERT_EQ(StoreStatus::InternalError,
+              storage_->PutSegments(0, segments, &revision));
+}
+
+TEST_F(TestNameServerStorageImp, test_putsegment_with_batcher) {
+    EtcdWriteBatchOption option;
+    option.enable = true;
+    option.maxBatchSize = 16;
+    option.batchWindowUs = 0;
+    auto batcher = std::make_shared<EtcdWriteBatcher>(client_, option);
+    batcher->Start();
+    auto storage =
+        std::make_shared<NameServerStorageImp>(client_, cache_, batcher);
+
+    PageFileSegment segment;
+    segment.set_segmentsize(1024*1024*1024);
+    segment.set_chunksize(16*1024*1024);
+    segment.set_startoffset(0);
+    segment.set_logicalpoolid(1);
+    EXPECT_CALL(*client_, PutRewithRevision(_, _, _)).Times(0);
+    EXPECT_CALL(*client_, TxnNWithRevision(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(100), Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(Return(EtcdErrCode::EtcdCanceled));
+    EXPECT_CALL(*cache_, Put(_, _)).Times(1);
+    int64_t revision = 0;
+    ASSERT_EQ(StoreStatus::OK, storage->PutSegment(0, 0, &segment, &revision));
+    ASSERT_EQ(100, revision);
+    ASSERT_EQ(StoreStatus::InternalError,
+        storage->PutSegment(0, 0, &segment, &revision));
+    batcher->Stop();
+}
+
 TEST_F(TestNameServerStorageImp, test_getSegment) {
     // 1. get err
     PageFileSegment segment;
@@ -382,6 +463,9 @@ TEST_F(TestNameServerStorageImp, test_getSegment) {
     GetPageFileSegmentForTest(&key, &segment);
     ASSERT_TRUE(NameSpaceStorageCodec::EncodeSegment(segment, &encodeSegment));
     EXPECT_CALL(*cache_, Get(_, _)).WillOnce(Return(false));
+    EXPECT_CALL(*cache_, GetRevision(_)).WillOnce(Return(1));
+    EXPECT_CALL(*cache_, PutIfRevisionMatch(_, _, 1))
+        .WillOnce(Return(true));
     EXPECT_CALL(*client_, Get(_, _))
         .WillOnce(DoAll(SetArgPointee<1>(encodeSegment),
                         Return(EtcdErrCode::EtcdOK)));
@@ -390,11 +474,21 @@ TEST_F(TestNameServerStorageImp, test_getSegment) {
     ASSERT_EQ(segment.chunks_size(), getSegment.chunks_size());
 
     // 3. get file from cache ok
+    CacheValue cachedSegment = std::make_shared<const PageFileSegment>(segment);
     EXPECT_CALL(*cache_, Get(_, _))
-        .WillOnce(DoAll(SetArgPointee<1>(encodeSegment), Return(true)));
+        .WillOnce(DoAll(SetArgPointee<1>(cachedSegment), Return(true)));
+    EXPECT_CALL(*client_, Get(_, _)).Times(0);
     ASSERT_EQ(StoreStatus::OK, storage_->GetSegment(0, 0, &getSegment));
     ASSERT_EQ(segment.chunksize(), getSegment.chunksize());
     ASSERT_EQ(segment.chunks_size(), getSegment.chunks_size());
+
+    // 4. cached segment is shared without copy
+    std::shared_ptr<const PageFileSegment> sharedSegment;
+    EXPECT_CALL(*cache_, Get(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(cachedSegment), Return(true)));
+    EXPECT_CALL(*client_, Get(_, _)).Times(0);
+    ASSERT_EQ(StoreStatus::OK, storage_->GetSegment(0, 0, &sharedSegment));
+    ASSERT_EQ(cachedSegment.get(), sharedSegment.get());
 }
 
 TEST_F(TestNameServerStorageImp, test_deleteSegment) {
@@ -441,6 +535,37 @@ TEST_F(TestNameServerStorageImp, test_ListSegment) {
     ASSERT_EQ(segment.DebugString(), segments[0].DebugString());
 }
 
+TEST_F(TestNameServerStorageImp, test_ListSegmentInRange) {
+    std::vector<PageFileSegment> segments;
+    // 1. empty range
+    ASSERT_EQ(StoreStatus::OK,
+        storage_->ListSegmentInRange(1, 100, 100, &segments));
+    ASSERT_TRUE(segments.empty());
+
+    // 2. list err
+    EXPECT_CALL(*client_, List(_, _, Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(Return(EtcdErrCode::EtcdCanceled));
+    ASSERT_EQ(StoreStatus::InternalError,
+        storage_->ListSegmentInRange(1, 0, 100, &segments));
+
+    // 3. list ok, keys are bounded in the same inode
+    std::string key, encodeSegment;
+    PageFileSegment segment;
+    GetPageFileSegmentForTest(&key, &segment);
+    ASSERT_TRUE(NameSpaceStorageCodec::EncodeSegment(segment, &encodeSegment));
+    EXPECT_CALL(*client_, List(
+            NameSpaceStorageCodec::EncodeSegmentStoreKey(1, 0),
+            NameSpaceStorageCodec::EncodeSegmentStoreKey(1, 100),
+            Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(DoAll(
+            SetArgPointee<2>(std::vector<std::string>{encodeSegment}),
+            Return(EtcdErrCode::EtcdOK)));
+    ASSERT_EQ(StoreStatus::OK,
+        storage_->ListSegmentInRange(1, 0, 100, &segments));
+    ASSERT_EQ(1, segments.size());
+    ASSERT_EQ(segment.DebugString(), segments[0].DebugString());
+}
+
 TEST_F(TestNameServerStorageImp, test_DiscardSegment) {
     const uint32_t chunkSize = 16 * 1024 * 1024;
 
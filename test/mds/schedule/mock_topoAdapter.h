@@ -25,6 +25,7 @@
 #include <gmock/gmock.h>
 #include <vector>
 #include <map>
+#include <utility>
 #include "src/mds/schedule/topoAdapter.h"
 
 namespace curve {
@@ -78,6 +79,9 @@ class MockTopoAdapter : public TopoAdapter {
 
     MOCK_METHOD1(GetChunkServersInLogicalPool,
         std::vector<ChunkServerInfo>(PoolIdType));
+
+    MOCK_METHOD1(GetChunkServersOrderByCopySetNum,
+        std::vector<std::pair<ChunkServerIdType, uint32_t>>(PoolIdType));
 };
 }  // namespace schedule
 }  // namespace mds
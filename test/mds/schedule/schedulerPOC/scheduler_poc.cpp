@@ -30,6 +30,7 @@
 #include <random>
 #include "src/mds/topology/topology_item.h"
 #include "src/mds/topology/topology.h"
+#include "src/mds/topology/copyset_distribution.h"
 #include "src/mds/topology/topology_service_manager.h"
 #include "src/mds/schedule/topoAdapter.h"
 #include "src/mds/schedule/scheduler.h"
@@ -38,6 +39,7 @@
 #include "src/mds/copyset/copyset_policy.h"
 #include "src/mds/copyset/copyset_manager.h"
 #include "src/mds/schedule/scheduleMetrics.h"
+#include "src/common/timeutility.h"
 #include "test/mds/schedule/schedulerPOC/mock_topology.h"
 #include "test/mds/mock/mock_topology.h"
 
@@ -79,11 +81,9 @@ class FakeTopo : public ::curve::mds::topology::TopologyImpl {
         std::make_shared<MockTokenGenerator>(),
         std::make_shared<MockStorage>()) {}
 
-    void BuildMassiveTopo() {
-        constexpr int serverNum = 9;
-        constexpr int diskNumPerServer = 20;
+    void BuildMassiveTopo(int serverNum = 9, int diskNumPerServer = 20,
+                          int numCopysets = 6000) {
         constexpr int zoneNum = 3;
-        constexpr int numCopysets = 6000;
 
         // gen server
         for (int i = 1; i <= serverNum; i++) {
@@ -130,6 +130,7 @@ class FakeTopo : public ::curve::mds::topology::TopologyImpl {
             info.SetCopySetMembers(it.replicas);
             info.SetLeader(*it.replicas.begin());
             copySetMap_[info.GetCopySetKey()]  = info;
+            distribution_.AddCopySet(info.GetCopySetKey(), it.replicas);
         }
 
         logicalPoolSet_.insert(0);
@@ -197,13 +198,12 @@ class FakeTopo : public ::curve::mds::topology::TopologyImpl {
         ChunkServerIdType csId,
         CopySetFilter filter = [](const ::curve::mds::topology::CopySetInfo&) {
             return true;}) const override {
-        std::vector<CopySetKey> ret;
-        for (auto it : copySetMap_) {
-            if (it.second.GetCopySetMembers().count(csId) > 0) {
-                ret.push_back(it.first);
-            }
-        }
-        return ret;
+        return distribution_.GetCopySetsInChunkServer(csId);
+    }
+
+    std::vector<std::pair<ChunkServerIdType, uint32_t>>
+    GetChunkServersOrderByCopySetNum(PoolIdType logicalPoolId) const override {
+        return distribution_.GetChunkServersOrderByCopySetNum(logicalPoolId);
     }
 
     std::vector<::curve::mds::topology::CopySetInfo>
@@ -290,6 +290,8 @@ class FakeTopo : public ::curve::mds::topology::TopologyImpl {
         CopySetKey key(data.GetLogicalPoolId(), data.GetId());
         auto it = copySetMap_.find(key);
         if (it != copySetMap_.end()) {
+            distribution_.UpdateCopySet(key, it->second.GetCopySetMembers(),
+                data.GetCopySetMembers());
             it->second = data;
             return 0;
         }
@@ -302,6 +304,8 @@ class FakeTopo : public ::curve::mds::topology::TopologyImpl {
     std::map<ServerIdType, Server> serverMap_;
     std::map<ChunkServerIdType, ChunkServer> chunkServerMap_;
     std::map<CopySetKey, ::curve::mds::topology::CopySetInfo> copySetMap_;
+    // 每个chunkserver上的copyset索引, 随copySetMap_更新
+    ::curve::mds::topology::CopySetDistribution distribution_;
     std::set<PoolIdType> logicalPoolSet_;
     ClusterInfo cluster_;
 };
@@ -1286,6 +1290,48 @@ TEST_F(CopysetSchedulerPOC, test_scatterwith_after_copysetRebalance_5) { //NOLIN
     PrintCopySetNumInOnlineChunkServer();
 }
 
+TEST_F(CopysetSchedulerPOC, DISABLED_test_copyset_schedule_with_massive_copysets) { //NOLINT
+    // 测试大规模集群下copyset均衡调度每一轮的耗时
+
+    // 1. 构造150台server, 每台20个chunkserver, 共10w个copyset的集群,
+    //    每个chunkserver上的copyset数量与默认集群相同
+    std::shared_ptr<FakeTopo> fakeTopo = std::make_shared<FakeTopo>();
+    fakeTopo->BuildMassiveTopo(150, 20, 100000);
+    topo_ = fakeTopo;
+    topoStat_ = std::make_shared<FakeTopologyStat>(topo_);
+    PrintCopySetNumInLogicalPool();
+
+    // 2. 一个chunkserver offline后恢复, 使copyset分布不均衡
+    BuilRecoverScheduler(1);
+    ChunkServerIdType choose = RandomOfflineOneChunkServer();
+    do {
+        recoverScheduler_->Schedule();
+        ApplyOperatorsInOpController(std::set<ChunkServerIdType>{choose});
+    } while (topo_->GetCopySetsInChunkServer(choose).size() > 0);
+    SetChunkServerOnline(choose);
+
+    // 3. copysetScheduler回迁, 统计每一轮调度的耗时
+    BuildCopySetScheduler(1);
+    std::vector<ChunkServerIdType> csList = topo_->GetChunkServerInCluster();
+    std::set<ChunkServerIdType> csSet(csList.begin(), csList.end());
+    constexpr int maxRound = 200;
+    int round = 0;
+    int operatorCount = 0;
+    uint64_t totalUs = 0;
+    do {
+        uint64_t startUs = ::curve::common::TimeUtility::GetTimeofDayUs();
+        operatorCount = copySetScheduler_->Schedule();
+        totalUs += ::curve::common::TimeUtility::GetTimeofDayUs() - startUs;
+        round++;
+        ApplyOperatorsInOpController(csSet);
+    } while (operatorCount > 0 && round < maxRound);
+
+    PrintCopySetNumInLogicalPool();
+    LOG(INFO) << "copyset scheduler run " << round << " rounds with "
+              << topo_->GetCopySetsInCluster().size() << " copysets, "
+              << "average cost " << totalUs / round << " us per round";
+}
+
 TEST_F(CopysetSchedulerPOC, DISABLED_test_leader_rebalance) {
     leaderCountOn = true;
     BuildLeaderScheduler(4);
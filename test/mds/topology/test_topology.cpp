@@ -22,10 +22,14 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <thread>  // NOLINT
+
 #include "test/mds/topology/mock_topology.h"
 #include "src/mds/topology/topology.h"
 #include "src/mds/topology/topology_item.h"
 #include "src/common/configuration.h"
+#include "src/common/timeutility.h"
 
 namespace curve {
 namespace mds {
@@ -2631,6 +2635,183 @@ TEST_F(TestTopology, UpdateCopySetTopo_CopySetNotFound) {
     ASSERT_EQ(kTopoErrCodeCopySetNotFound, ret);
 }
 
+TEST_F(TestTopology, UpdateCopySetsTopo_batch) {
+    PoolIdType logicalPoolId = 0x01;
+    PoolIdType physicalPoolId = 0x11;
+    CopySetIdType copysetId = 0x51;
+
+    PrepareAddPhysicalPool(physicalPoolId);
+    PrepareAddZone(0x21, "zone1", physicalPoolId);
+    PrepareAddZone(0x22, "zone2", physicalPoolId);
+    PrepareAddZone(0x23, "zone3", physicalPoolId);
+    PrepareAddServer(
+        0x31, "server1", "127.0.0.1" , 0, "127.0.0.1" , 0, 0x21, 0x11);
+    PrepareAddServer(
+        0x32, "server2", "127.0.0.1" , 0, "127.0.0.1" , 0, 0x22, 0x11);
+    PrepareAddServer(
+        0x33, "server3", "127.0.0.1" , 0, "127.0.0.1" , 0, 0x23, 0x11);
+    PrepareAddChunkServer(0x41, "token1", "nvme", 0x31, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x42, "token2", "nvme", 0x32, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x43, "token3", "nvme", 0x33, "127.0.0.1", 8200);
+    PrepareAddLogicalPool(logicalPoolId, "logicalPool1", physicalPoolId);
+    std::set<ChunkServerIdType> replicas;
+    replicas.insert(0x41);
+    replicas.insert(0x42);
+    replicas.insert(0x43);
+    PrepareAddCopySet(copysetId, logicalPoolId, replicas);
+    PrepareAddCopySet(copysetId + 1, logicalPoolId, replicas);
+
+    std::vector<CopySetInfo> csInfos;
+    for (CopySetIdType id = copysetId; id < copysetId + 3; ++id) {
+        CopySetInfo csInfo(logicalPoolId, id);
+        csInfo.SetEpoch(2);
+        csInfo.SetLeader(0x42);
+        csInfo.SetCopySetMembers(replicas);
+        csInfos.push_back(csInfo);
+    }
+
+    std::vector<int> errCodes;
+    topology_->UpdateCopySetsTopo(csInfos, &errCodes);
+
+    // the last one does not exist
+    ASSERT_EQ(3, errCodes.size());
+    ASSERT_EQ(kTopoErrCodeSuccess, errCodes[0]);
+    ASSERT_EQ(kTopoErrCodeSuccess, errCodes[1]);
+    ASSERT_EQ(kTopoErrCodeCopySetNotFound, errCodes[2]);
+
+    for (CopySetIdType id = copysetId; id < copysetId + 2; ++id) {
+        CopySetInfo out;
+        ASSERT_TRUE(topology_->GetCopySet(
+            std::pair<PoolIdType, CopySetIdType>(logicalPoolId, id), &out));
+        ASSERT_EQ(2, out.GetEpoch());
+        ASSERT_EQ(0x42, out.GetLeader());
+    }
+}
+
+TEST_F(TestTopology, GetCopySetSnapshot_rebuildAfterChange) {
+    PoolIdType logicalPoolId = 0x01;
+    PoolIdType physicalPoolId = 0x11;
+    CopySetIdType copysetId = 0x51;
+
+    PrepareAddPhysicalPool(physicalPoolId);
+    PrepareAddLogicalPool(logicalPoolId, "logicalPool1", physicalPoolId);
+    PrepareAddLogicalPool(0x02, "logicalPool2", physicalPoolId);
+    std::set<ChunkServerIdType> replicas{0x41, 0x42, 0x43};
+    PrepareAddCopySet(copysetId, logicalPoolId, replicas);
+    PrepareAddCopySet(copysetId + 1, logicalPoolId, replicas);
+    PrepareAddCopySet(copysetId, 0x02, replicas);
+
+    // snapshot is shared until copysets change
+    auto snapshot1 = topology_->GetCopySetSnapshot();
+    ASSERT_EQ(3, snapshot1->copySets.size());
+    ASSERT_EQ(snapshot1, topology_->GetCopySetSnapshot());
+    ASSERT_EQ(2, topology_->GetCopySetInfosInLogicalPool(
+        logicalPoolId).size());
+    ASSERT_EQ(1, topology_->GetCopySetsInLogicalPool(0x02).size());
+
+    CopySetInfo csInfo(logicalPoolId, copysetId);
+    csInfo.SetEpoch(2);
+    csInfo.SetLeader(0x41);
+    csInfo.SetCopySetMembers(replicas);
+    ASSERT_EQ(kTopoErrCodeSuccess, topology_->UpdateCopySetTopo(csInfo));
+
+    // old snapshot is immutable, new one reflects the change
+    auto snapshot2 = topology_->GetCopySetSnapshot();
+    ASSERT_NE(snapshot1, snapshot2);
+    CopySetKey key(logicalPoolId, copysetId);
+    ASSERT_EQ(0, snapshot1->copySets.at(key).GetEpoch());
+    ASSERT_EQ(2, snapshot2->copySets.at(key).GetEpoch());
+
+    // reports repeating the recorded state do not invalidate the snapshot
+    ASSERT_EQ(kTopoErrCodeSuccess, topology_->UpdateCopySetTopo(csInfo));
+    std::vector<int> errCodes;
+    topology_->UpdateCopySetsTopo({csInfo, csInfo}, &errCodes);
+    ASSERT_EQ(std::vector<int>({kTopoErrCodeSuccess, kTopoErrCodeSuccess}),
+              errCodes);
+    ASSERT_EQ(snapshot2, topology_->GetCopySetSnapshot());
+
+    EXPECT_CALL(*storage_, DeleteCopySet(_))
+        .WillOnce(Return(true));
+    ASSERT_EQ(kTopoErrCodeSuccess, topology_->RemoveCopySet(key));
+    ASSERT_EQ(1, topology_->GetCopySetInfosInLogicalPool(
+        logicalPoolId).size());
+    ASSERT_EQ(2, topology_->GetCopySetsInCluster().size());
+    ASSERT_EQ(3, snapshot2->copySets.size());
+}
+
+// time of topology reads in a scheduler round on a large cluster, while
+// heartbeats keep updating copysets
+TEST_F(TestTopology, DISABLED_scheduler_round_with_100k_copysets) {
+    const PoolIdType logicalPoolId = 0x01;
+    const PoolIdType physicalPoolId = 0x11;
+    const uint32_t copysetNum = 100000;
+    const uint32_t chunkserverNum = 300;
+    const int roundNum = 10;
+
+    PrepareAddPhysicalPool(physicalPoolId);
+    PrepareAddLogicalPool(logicalPoolId, "logicalPool1", physicalPoolId);
+    EXPECT_CALL(*storage_, StorageCopySet(_))
+        .WillRepeatedly(Return(true));
+    for (uint32_t i = 0; i < copysetNum; ++i) {
+        CopySetInfo cs(logicalPoolId, i + 1);
+        cs.SetCopySetMembers(std::set<ChunkServerIdType>{
+            i % chunkserverNum + 1,
+            (i + 1) % chunkserverNum + 1,
+            (i + 2) % chunkserverNum + 1});
+        ASSERT_EQ(kTopoErrCodeSuccess, topology_->AddCopySet(cs));
+    }
+
+    // heartbeats update leader of copysets in batches
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> updated(0);
+    std::thread heartbeat([&]() {
+        uint64_t epoch = 1;
+        while (!stop.load()) {
+            std::vector<CopySetInfo> batch;
+            for (uint32_t i = 0; i < 100; ++i) {
+                CopySetKey key(logicalPoolId,
+                               (epoch * 100 + i) % copysetNum + 1);
+                CopySetInfo info;
+                ASSERT_TRUE(topology_->GetCopySet(key, &info));
+                info.SetEpoch(epoch);
+                info.SetLeader(*info.GetCopySetMembers().begin());
+                batch.emplace_back(info);
+            }
+            std::vector<int> errCodes;
+            topology_->UpdateCopySetsTopo(batch, &errCodes);
+            updated.fetch_add(batch.size());
+            ++epoch;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    });
+
+    // reads of copyset, leader, rapid leader and scan scheduler and
+    // copysets of some chunkservers in each round
+    uint64_t totalUs = 0;
+    for (int round = 0; round < roundNum; ++round) {
+        uint64_t startUs = curve::common::TimeUtility::GetTimeofDayUs();
+        size_t count = 0;
+        for (int i = 0; i < 4; ++i) {
+            count += topology_->GetCopySetInfosInLogicalPool(
+                logicalPoolId).size();
+        }
+        for (ChunkServerIdType cs = 1; cs <= 10; ++cs) {
+            count += topology_->GetCopySetsInChunkServer(cs).size();
+        }
+        uint64_t costUs = curve::common::TimeUtility::GetTimeofDayUs() -
+            startUs;
+        totalUs += costUs;
+        ASSERT_GT(count, 4 * copysetNum);
+        LOG(INFO) << "round " << round << " cost " << costUs << " us";
+    }
+    stop.store(true);
+    heartbeat.join();
+
+    LOG(INFO) << "copyset num = " << copysetNum
+              << ", avg round cost = " << totalUs / roundNum << " us"
+              << ", copysets updated by heartbeat = " << updated.load();
+}
+
 TEST_F(TestTopology, GetCopySet_success) {
     PoolIdType logicalPoolId = 0x01;
     PoolIdType physicalPoolId = 0x11;
@@ -2787,6 +2968,74 @@ TEST_F(TestTopology, GetCopySetsInChunkServer_success) {
     ASSERT_EQ(1, csList.size());
 }
 
+TEST_F(TestTopology, GetChunkServersOrderByCopySetNum_success) {
+    PoolIdType logicalPoolId = 0x01;
+    PoolIdType physicalPoolId = 0x11;
+    CopySetIdType copysetId = 0x51;
+
+    PrepareAddPhysicalPool(physicalPoolId);
+    PrepareAddZone(0x21, "zone1", physicalPoolId);
+    PrepareAddZone(0x22, "zone2", physicalPoolId);
+    PrepareAddZone(0x23, "zone3", physicalPoolId);
+    PrepareAddServer(
+        0x31, "server1", "127.0.0.1" , 0, "127.0.0.1" , 0, 0x21, 0x11);
+    PrepareAddServer(
+        0x32, "server2", "127.0.0.1" , 0, "127.0.0.1" , 0, 0x22, 0x11);
+    PrepareAddServer(
+        0x33, "server3", "127.0.0.1" , 0, "127.0.0.1" , 0, 0x23, 0x11);
+    PrepareAddChunkServer(0x41, "token1", "nvme", 0x31, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x42, "token2", "nvme", 0x32, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x43, "token3", "nvme", 0x33, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x44, "token4", "nvme", 0x33, "127.0.0.1", 8201);
+    PrepareAddLogicalPool(logicalPoolId, "logicalPool1", physicalPoolId);
+    std::set<ChunkServerIdType> replicas;
+    replicas.insert(0x41);
+    replicas.insert(0x42);
+    replicas.insert(0x43);
+    PrepareAddCopySet(copysetId, logicalPoolId, replicas);
+    PrepareAddCopySet(copysetId + 1, logicalPoolId, replicas);
+
+    auto csList = topology_->GetChunkServersOrderByCopySetNum(logicalPoolId);
+    ASSERT_EQ(3, csList.size());
+    for (auto &item : csList) {
+        ASSERT_EQ(2, item.second);
+    }
+    ASSERT_TRUE(topology_->GetChunkServersOrderByCopySetNum(
+        logicalPoolId + 1).empty());
+
+    // move one copyset from 0x43 to 0x44
+    std::set<ChunkServerIdType> newReplicas = replicas;
+    newReplicas.erase(0x43);
+    newReplicas.insert(0x44);
+    CopySetInfo csInfo(logicalPoolId, copysetId + 1);
+    csInfo.SetCopySetMembers(newReplicas);
+    ASSERT_EQ(kTopoErrCodeSuccess, topology_->UpdateCopySetTopo(csInfo));
+
+    csList = topology_->GetChunkServersOrderByCopySetNum(logicalPoolId);
+    ASSERT_EQ(4, csList.size());
+    ASSERT_EQ(2, csList[0].second);
+    ASSERT_EQ(2, csList[1].second);
+    ASSERT_EQ(1, csList[2].second);
+    ASSERT_EQ(1, csList[3].second);
+    ASSERT_EQ(1, topology_->GetCopySetsInChunkServer(0x43).size());
+    ASSERT_EQ(1, topology_->GetCopySetsInChunkServer(0x44).size());
+    ASSERT_EQ(copysetId + 1,
+        topology_->GetCopySetsInChunkServer(0x44)[0].second);
+
+    // chunkservers without copyset are removed from the index
+    EXPECT_CALL(*storage_, DeleteCopySet(_))
+        .WillOnce(Return(true));
+    ASSERT_EQ(kTopoErrCodeSuccess, topology_->RemoveCopySet(
+        CopySetKey(logicalPoolId, copysetId + 1)));
+    csList = topology_->GetChunkServersOrderByCopySetNum(logicalPoolId);
+    ASSERT_EQ(3, csList.size());
+    for (auto &item : csList) {
+        ASSERT_NE(0x44, item.first);
+        ASSERT_EQ(1, item.second);
+    }
+    ASSERT_TRUE(topology_->GetCopySetsInChunkServer(0x44).empty());
+}
+
 
 
 
@@ -23,8 +23,10 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <cmath>
 #include <memory>
-
+#include <random>
+#include <set>
 
 #include "src/mds/topology/topology_chunk_allocator.h"
 #include "src/mds/common/mds_define.h"
@@ -43,6 +45,7 @@ using ::testing::_;
 using ::testing::AnyOf;
 using ::testing::SetArgPointee;
 using ::testing::Invoke;
+using ::testing::DoAll;
 
 
 class TestTopologyChunkAllocator : public ::testing::Test {
@@ -429,6 +432,89 @@ TEST_F(TestTopologyChunkAllocator,
     ASSERT_FALSE(ret);
 }
 
+TEST_F(TestTopologyChunkAllocator,
+    Test_AllocateChunkRandomInSingleLogicalPool_byWeight) {
+    std::vector<CopysetIdInfo> infos;
+
+    PoolIdType logicalPoolId = 0x01;
+    PoolIdType physicalPoolId = 0x11;
+    CopySetIdType copysetId = 0x51;
+
+    PrepareAddPhysicalPool(physicalPoolId);
+    PrepareAddZone(0x21, "zone1", physicalPoolId);
+    PrepareAddServer(0x31, "server1", "127.0.0.1", "127.0.0.1", 0x21, 0x11);
+    PrepareAddChunkServer(0x41, "token1", "nvme", 0x31, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x42, "token2", "nvme", 0x31, "127.0.0.1", 8201);
+    PrepareAddChunkServer(0x43, "token3", "nvme", 0x31, "127.0.0.1", 8202);
+    PrepareAddChunkServer(0x44, "token4", "nvme", 0x31, "127.0.0.1", 8203);
+    PrepareAddLogicalPool(logicalPoolId, "logicalPool1", physicalPoolId,
+        PAGEFILE);
+    PrepareAddCopySet(copysetId, logicalPoolId, {0x41, 0x42, 0x43});
+    PrepareAddCopySet(copysetId + 1, logicalPoolId, {0x41, 0x42, 0x44});
+    PrepareAddCopySet(copysetId + 2, logicalPoolId, {0x41, 0x42, 0x43},
+        false);
+
+    TopologyOption option;
+    option.enableLogicalPoolStatus = true;
+    option.chooseCopysetPolicy =
+        static_cast<int>(ChooseCopysetPolicy::kWeight);
+    auto topologyStat = std::make_shared<MockTopologyStat>();
+    testObj_ = std::make_shared<TopologyChunkAllocatorImpl>(topology_,
+        allocStatistic_, option, topologyStat);
+
+    // 0x44已满, 包含0x44的copyset权重为0; 0x43没有统计信息, 按权重1处理
+    EXPECT_CALL(*topologyStat, GetChunkServerStat(_, _))
+        .WillRepeatedly(Invoke([](ChunkServerIdType csId,
+                                  ChunkServerStat *stat) {
+            if (csId == 0x43) {
+                return false;
+            }
+            stat->chunkSizeUsedBytes = 1024;
+            stat->chunkSizeLeftBytes = (csId == 0x44) ? 0 : 1024;
+            return true;
+        }));
+    EXPECT_CALL(*allocStatistic_, GetAllocByLogicalPool(_, _))
+        .WillRepeatedly(Return(true));
+
+    bool ret =
+        testObj_->AllocateChunkRandomInSingleLogicalPool(INODE_PAGEFILE,
+            100,
+            1024,
+            &infos);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(100, infos.size());
+    for (const auto &info : infos) {
+        ASSERT_EQ(logicalPoolId, info.logicalPoolId);
+        ASSERT_EQ(copysetId, info.copySetId);
+    }
+
+    // 权重表在更新周期内被复用
+    ret = testObj_->AllocateChunkRandomInSingleLogicalPool(INODE_PAGEFILE,
+            1,
+            1024,
+            &infos);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(1, infos.size());
+    ASSERT_EQ(copysetId, infos[0].copySetId);
+
+    // 可用状态变化后权重表立即更新
+    EXPECT_CALL(*storage_, UpdateCopySet(_))
+        .WillRepeatedly(Return(true));
+    ASSERT_EQ(kTopoErrCodeSuccess, topology_->SetCopySetAvalFlag(
+        CopySetKey(logicalPoolId, copysetId), false));
+    ASSERT_EQ(kTopoErrCodeSuccess, topology_->SetCopySetAvalFlag(
+        CopySetKey(logicalPoolId, copysetId + 2), true));
+    ret = testObj_->AllocateChunkRandomInSingleLogicalPool(INODE_PAGEFILE,
+            100,
+            1024,
+            &infos);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(100, infos.size());
+    for (const auto &info : infos) {
+        ASSERT_EQ(copysetId + 2, info.copySetId);
+    }
+}
+
 TEST(TestAllocateChunkPolicy, TestAllocateChunkRandomInSingleLogicalPoolPoc) {
     // 2000个copyset分配100000次，每次分配64个chunk
     std::vector<CopySetIdType> copySetIds;
@@ -628,6 +714,149 @@ TEST(TestAllocateChunkPolicy,
     }
 }
 
+TEST(TestAllocateChunkPolicy, TestAliasTable) {
+    AliasTable table;
+    std::mt19937 gen(1);
+    ASSERT_FALSE(table.Build({}));
+    ASSERT_FALSE(table.Build({0, 0, 0}));
+    ASSERT_EQ(0, table.Size());
+
+    std::vector<double> weights = {1, 2, 3, 4, 0};
+    ASSERT_TRUE(table.Build(weights));
+    ASSERT_EQ(weights.size(), table.Size());
+
+    // 采样频率与权重成正比
+    int sampleNum = 1000000;
+    std::vector<int> counts(weights.size(), 0);
+    for (int i = 0; i < sampleNum; i++) {
+        counts[table.Sample(&gen)]++;
+    }
+    ASSERT_EQ(0, counts[4]);
+    for (int i = 0; i < 4; i++) {
+        double expect = sampleNum * weights[i] / 10;
+        ASSERT_LT(std::fabs(counts[i] - expect) / expect, 0.05);
+    }
+}
+
+TEST(TestAllocateChunkPolicy, TestCalcCopySetWeight) {
+    std::map<ChunkServerIdType, ChunkServerStat> stats;
+    // 空闲1/2, 无负载
+    stats[1].chunkSizeUsedBytes = 100;
+    stats[1].chunkSizeLeftBytes = 100;
+    // 空闲1/2, 负载为平均值的2倍
+    stats[2].chunkSizeUsedBytes = 100;
+    stats[2].chunkSizeLeftBytes = 100;
+    stats[2].readIOPS = 100;
+    stats[2].writeIOPS = 100;
+    // 空闲1/4, 负载为平均值
+    stats[3].chunkSizeUsedBytes = 300;
+    stats[3].chunkSizeLeftBytes = 100;
+    stats[3].writeIOPS = 100;
+
+    std::map<ChunkServerIdType, double> weights;
+    AllocateChunkPolicy::CalcChunkServerWeights(stats, 100, &weights);
+    ASSERT_EQ(3, weights.size());
+    ASSERT_DOUBLE_EQ(0.5, weights[1]);
+    ASSERT_DOUBLE_EQ(0.5 / 3, weights[2]);
+    ASSERT_DOUBLE_EQ(0.25 / 2, weights[3]);
+
+    // 不考虑负载
+    AllocateChunkPolicy::CalcChunkServerWeights(stats, 0, &weights);
+    ASSERT_DOUBLE_EQ(0.5, weights[1]);
+    ASSERT_DOUBLE_EQ(0.5, weights[2]);
+    ASSERT_DOUBLE_EQ(0.25, weights[3]);
+
+    ASSERT_DOUBLE_EQ(0.25,
+        AllocateChunkPolicy::CalcCopySetWeight({1, 2, 3}, weights));
+    ASSERT_DOUBLE_EQ(0.5,
+        AllocateChunkPolicy::CalcCopySetWeight({1, 4}, weights));
+    ASSERT_DOUBLE_EQ(0, AllocateChunkPolicy::CalcCopySetWeight({}, weights));
+}
+
+// 模拟在负载不均的集群中持续分配chunk, 比较随机选copyset和按权重选copyset
+// 最终各chunkserver负载的变异系数
+TEST(TestAllocateChunkPolicy, TestChooseCopysetByWeightSimulation) {
+    const uint32_t csNum = 100;
+    const uint32_t copysetNum = 1000;
+    const uint32_t rounds = 50;
+    const uint32_t chunksPerRound = 2000;
+
+    std::mt19937 gen(1);
+    std::vector<std::set<ChunkServerIdType>> members(copysetNum);
+    std::uniform_int_distribution<ChunkServerIdType> csDis(0, csNum - 1);
+    for (auto &m : members) {
+        while (m.size() < 3) {
+            m.insert(csDis(gen));
+        }
+    }
+    std::vector<CopySetIdType> copySetIds;
+    for (uint32_t i = 0; i < copysetNum; i++) {
+        copySetIds.push_back(i);
+    }
+
+    auto simulate = [&](bool byWeight, double *cv) {
+        std::map<ChunkServerIdType, ChunkServerStat> stats;
+        for (ChunkServerIdType id = 0; id < csNum; id++) {
+            stats[id].chunkSizeUsedBytes = 0;
+            stats[id].chunkSizeLeftBytes = 1000000;
+            // 10%的chunkserver初始负载较高
+            stats[id].writeIOPS = (id % 10 == 0) ? 2000 : 100;
+        }
+
+        for (uint32_t r = 0; r < rounds; r++) {
+            std::vector<CopysetIdInfo> infos;
+            if (byWeight) {
+                std::map<ChunkServerIdType, double> csWeights;
+                AllocateChunkPolicy::CalcChunkServerWeights(
+                    stats, 100, &csWeights);
+                CopySetWeightTable table;
+                table.copySetIds = copySetIds;
+                for (const auto &m : members) {
+                    table.weights.push_back(
+                        AllocateChunkPolicy::CalcCopySetWeight(m, csWeights));
+                }
+                ASSERT_TRUE(table.aliasTable.Build(table.weights));
+                ASSERT_TRUE(
+                    AllocateChunkPolicy::AllocateChunkByWeightInSingleLogicalPool(  // NOLINT
+                        table, 1, chunksPerRound, &infos));
+            } else {
+                ASSERT_TRUE(
+                    AllocateChunkPolicy::AllocateChunkRandomInSingleLogicalPool(
+                        copySetIds, 1, chunksPerRound, &infos));
+            }
+            // 每个新chunk给其副本所在chunkserver带来负载和空间占用
+            for (const auto &info : infos) {
+                for (auto csId : members[info.copySetId]) {
+                    stats[csId].writeIOPS += 1;
+                    stats[csId].chunkSizeUsedBytes += 100;
+                    stats[csId].chunkSizeLeftBytes -= 100;
+                }
+            }
+        }
+
+        double sum = 0;
+        for (const auto &item : stats) {
+            sum += item.second.writeIOPS;
+        }
+        double avg = sum / csNum;
+        double variance = 0;
+        for (const auto &item : stats) {
+            double diff = item.second.writeIOPS - avg;
+            variance += diff * diff;
+        }
+        variance /= csNum;
+        *cv = std::sqrt(variance) / avg;
+    };
+
+    double randomCv = 0;
+    double weightCv = 0;
+    simulate(false, &randomCv);
+    simulate(true, &weightCv);
+    LOG(INFO) << "chunkserver load coefficient of variation, random = "
+              << randomCv << ", weight = " << weightCv;
+    ASSERT_LT(weightCv, randomCv);
+}
+
 }  // namespace topology
 }  // namespace mds
 }  // namespace curve
@@ -48,8 +48,12 @@ class MockS3Adapter : public S3Adapter {
                                 const std::string &));
     MOCK_METHOD2(GetObject, int(const Aws::String &,
                                 std::string *));
+    MOCK_METHOD4(GetObject, int(const std::string &, char *, off_t,
+                                size_t));
     MOCK_METHOD1(DeleteObject, int(const Aws::String &));
     MOCK_METHOD1(ObjectExist, bool(const Aws::String &));
+    MOCK_METHOD3(GetObjectTail, int(const std::string &, size_t,
+                                    std::string *));
 /*
     MOCK_METHOD2(UpdateObjectMeta, int(const Aws::String &,
                          const Aws::Map<Aws::String, Aws::String> &));
@@ -69,6 +73,8 @@ class MockS3Adapter : public S3Adapter {
             const Aws::Vector<Aws::S3::Model::CompletedPart> &));
     MOCK_METHOD2(AbortMultiUpload, int(const Aws::String &,
                                            const Aws::String &));
+    MOCK_METHOD2(ListMultiUploads, int(const Aws::String &,
+        std::vector<std::pair<Aws::String, Aws::String>> *));
 };
 }  // namespace snapshotcloneserver
 }  // namespace curve
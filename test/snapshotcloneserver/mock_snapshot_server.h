@@ -108,6 +108,17 @@ class MockSnapshotCloneMetaStore : public SnapshotCloneMetaStore {
         int(const std::string &fileName, std::vector<CloneInfo> *list));
     MOCK_METHOD1(GetCloneInfoList,
         int(std::vector<CloneInfo> *list));
+    MOCK_METHOD2(GetChunkPartRef,
+        int(const std::string &hash, ChunkPartRefInfo *info));
+    MOCK_METHOD2(AddChunkPartRefs, int(const std::string &chunkName,
+        const std::map<int, ChunkPartRefInfo> &parts));
+    MOCK_METHOD2(RemoveChunkPartRefs, int(const std::string &chunkName,
+        const std::map<int, std::string> &parts));
+    MOCK_METHOD2(HasChunkPartRef,
+        int(const std::string &hash, bool *referenced));
+    MOCK_METHOD1(DeleteChunkPartRef, int(const std::string &hash));
+    MOCK_METHOD0(SetChunkDedupFlag, int());
+    MOCK_METHOD1(GetChunkDedupFlag, int(bool *everEnabled));
 };
 
 class MockSnapshotDataStore : public SnapshotDataStore {
@@ -123,6 +134,12 @@ class MockSnapshotDataStore : public SnapshotDataStore {
         int(const ChunkIndexDataName &name));
     MOCK_METHOD1(ChunkIndexDataExist,
         bool(const ChunkIndexDataName &name));
+    MOCK_METHOD2(PutHotChunkIndex,
+        int(const ChunkIndexDataName &name,
+            const std::vector<ChunkIndexType> &indexes));
+    MOCK_METHOD2(GetHotChunkIndex,
+        int(const ChunkIndexDataName &name,
+            std::vector<ChunkIndexType> *indexes));
     MOCK_METHOD2(GetChunkData,
         int(const ChunkDataName &name,
             ChunkData *data));
@@ -149,6 +166,23 @@ class MockSnapshotDataStore : public SnapshotDataStore {
     MOCK_METHOD2(DataChunkTranferAbort,
         int(const ChunkDataName &name,
              std::shared_ptr<TransferTask> task));
+    MOCK_METHOD1(NewChunkPackWriter,
+        std::shared_ptr<ChunkPackWriter>(const std::string &prefix));
+    MOCK_METHOD2(GetChunkPackData,
+        int(const ChunkPackLocation &location,
+            std::string *data));
+    MOCK_METHOD1(DeleteChunkPack,
+        int(const std::string &packKey));
+};
+
+class MockChunkPackWriter : public ChunkPackWriter {
+ public:
+    MOCK_METHOD2(Append,
+        int(const ChunkDataName &name, const std::string &data));
+    MOCK_METHOD0(Flush, int());
+    MOCK_METHOD0(Abort, void());
+    MOCK_METHOD0(TakeSealedLocations,
+        std::vector<std::pair<ChunkDataName, ChunkPackLocation>>());
 };
 
 class MockCurveFsClient : public CurveFsClient {
@@ -220,6 +254,16 @@ class MockCurveFsClient : public CurveFsClient {
         uint64_t len,
         SnapCloneClosure* scc));
 
+    MOCK_METHOD4(CreateCloneChunks,
+        int(std::vector<ChunkBatchItem> *items,
+        uint64_t csn,
+        uint64_t chunkSize,
+        SnapCloneClosure* scc));
+
+    MOCK_METHOD2(RecoverChunks,
+        int(std::vector<ChunkBatchItem> *items,
+        SnapCloneClosure* scc));
+
     MOCK_METHOD2(CompleteCloneMeta,
         int(const std::string &filename,
         const std::string &user));
@@ -430,6 +474,8 @@ class MockKVStorageClient : public KVStorageClient {
                            std::vector<std::pair<std::string, std::string>>*));
     MOCK_METHOD1(Delete, int(const std::string&));
     MOCK_METHOD1(TxnN, int(const std::vector<Operation>&));
+    MOCK_METHOD2(TxnNWithRevision,
+        int(const std::vector<Operation>&, int64_t*));
     MOCK_METHOD3(CompareAndSwap, int(const std::string&, const std::string&,
         const std::string&));
     MOCK_METHOD5(CampaignLeader, int(const std::string&, const std::string&,
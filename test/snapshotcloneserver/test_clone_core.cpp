@@ -39,6 +39,7 @@ using ::testing::AllOf;
 using ::testing::SetArgPointee;
 using ::testing::Invoke;
 using ::testing::DoAll;
+using ::testing::SaveArg;
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -719,6 +720,282 @@ TEST_F(TestCloneCoreImpl,
     core_->HandleCloneOrRecoverTask(task);
 }
 
+TEST_F(TestCloneCoreImpl,
+    HandleCloneOrRecoverTaskSuccessForCloneBySnapshotInBatch) {
+    // 2个chunk位于同一个copyset，合并为一个请求，每个chunk恢复2个分片
+    option.cloneChunkBatchSize = 4;
+    option.cloneChunkSplitSize = 512 * 1024;
+    core_ = std::make_shared<CloneCoreImpl>(client_,
+        metaStore_,
+        dataStore_,
+        snapshotRef_,
+        cloneRef_,
+        option);
+
+    CloneInfo info("id1", "user1", CloneTaskType::kClone,
+    "snapid1", "file1", CloneFileType::kSnapshot, false);
+    info.SetStatus(CloneStatus::cloning);
+    auto cloneMetric = std::make_shared<CloneInfoMetric>("id1");
+    auto cloneClosure = std::make_shared<CloneClosure>();
+    std::shared_ptr<CloneTaskInfo> task =
+        std::make_shared<CloneTaskInfo>(info, cloneMetric, cloneClosure);
+
+    EXPECT_CALL(*metaStore_, UpdateCloneInfo(_))
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    MockBuildFileInfoFromSnapshotSuccess(task);
+    MockCreateCloneFileSuccess(task);
+
+    SegmentInfo segInfoOut;
+    segInfoOut.segmentsize = 2 * 1024 * 1024;
+    segInfoOut.chunksize = 1024 * 1024;
+    segInfoOut.startoffset = 0;
+    segInfoOut.chunkvec = {{1, 1, 1},
+                           {2, 1, 1}};
+    segInfoOut.lpcpIDInfo.lpid = 1;
+    segInfoOut.lpcpIDInfo.cpidVec = {1, 1};
+    EXPECT_CALL(*client_, GetOrAllocateSegmentInfo(_, 0, _, _, _))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<4>(segInfoOut),
+                Return(LIBCURVE_ERROR::OK)));
+
+    // 第1次chunk2失败，重试时只发送chunk2，返回已存在，chunk2不需要恢复
+    EXPECT_CALL(*client_, CreateCloneChunks(_, 0, 1024 * 1024, _))
+        .WillOnce(DoAll(
+            Invoke([](std::vector<ChunkBatchItem> *items,
+                      uint64_t csn,
+                      uint64_t chunkSize,
+                      SnapCloneClosure* scc){
+                    ASSERT_EQ(2, items->size());
+                    (*items)[0].retCode = LIBCURVE_ERROR::OK;
+                    (*items)[1].retCode = -LIBCURVE_ERROR::FAILED;
+                    scc->SetRetCode(LIBCURVE_ERROR::OK);
+                    scc->Run();
+                }),
+            Return(LIBCURVE_ERROR::OK)))
+        .WillOnce(DoAll(
+            Invoke([](std::vector<ChunkBatchItem> *items,
+                      uint64_t csn,
+                      uint64_t chunkSize,
+                      SnapCloneClosure* scc){
+                    ASSERT_EQ(1, items->size());
+                    ASSERT_EQ(2, (*items)[0].idinfo.cid_);
+                    (*items)[0].retCode = -LIBCURVE_ERROR::EXISTS;
+                    scc->SetRetCode(LIBCURVE_ERROR::OK);
+                    scc->Run();
+                }),
+            Return(LIBCURVE_ERROR::OK)));
+
+    std::vector<uint64_t> offsets;
+    EXPECT_CALL(*client_, RecoverChunks(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(
+            Invoke([&offsets](std::vector<ChunkBatchItem> *items,
+                              SnapCloneClosure* scc){
+                    ASSERT_EQ(1, items->size());
+                    ASSERT_EQ(1, (*items)[0].idinfo.cid_);
+                    ASSERT_EQ(512 * 1024, (*items)[0].len);
+                    offsets.push_back((*items)[0].offset);
+                    (*items)[0].retCode = LIBCURVE_ERROR::OK;
+                    scc->SetRetCode(LIBCURVE_ERROR::OK);
+                    scc->Run();
+                }),
+            Return(LIBCURVE_ERROR::OK)));
+
+    MockCompleteCloneMetaSuccess(task);
+    MockCompleteCloneFileSuccess(task);
+    MockChangeOwnerSuccess(task);
+    MockRenameCloneFileSuccess(task);
+
+    core_->HandleCloneOrRecoverTask(task);
+    ASSERT_EQ(CloneStatus::done, task->GetCloneInfo().GetStatus());
+    ASSERT_EQ(std::vector<uint64_t>({0, 512 * 1024}), offsets);
+}
+
+TEST_F(TestCloneCoreImpl,
+    HandleCloneOrRecoverTaskStage2RecoverHotChunkFirst) {
+    // 之前记录的热点chunk优先恢复，恢复前已在本地的chunk加入记录
+    option.cloneChunkBatchSize = 4;
+    core_ = std::make_shared<CloneCoreImpl>(client_,
+        metaStore_,
+        dataStore_,
+        snapshotRef_,
+        cloneRef_,
+        option);
+
+    CloneInfo info("id1", "user1", CloneTaskType::kClone,
+    "snapid1", "file1", 1, 2, 100, CloneFileType::kSnapshot, true,
+    CloneStep::kRecoverChunk, CloneStatus::cloning);
+    info.SetStatus(CloneStatus::cloning);
+    auto cloneMetric = std::make_shared<CloneInfoMetric>("id1");
+    auto cloneClosure = std::make_shared<CloneClosure>();
+    std::shared_ptr<CloneTaskInfo> task =
+        std::make_shared<CloneTaskInfo>(info, cloneMetric, cloneClosure);
+
+    EXPECT_CALL(*metaStore_, UpdateCloneInfo(_))
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    MockBuildFileInfoFromSnapshotSuccess(task);
+    MockCloneMetaSuccess(task);
+
+    // 排序时读取一次，保存时加锁后再读取一次
+    std::vector<ChunkIndexType> hotChunkIndexes = {1};
+    ChunkIndexDataName hotIndexName;
+    EXPECT_CALL(*dataStore_, GetHotChunkIndex(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(
+            SaveArg<0>(&hotIndexName),
+            SetArgPointee<1>(hotChunkIndexes),
+            Return(kErrCodeSuccess)));
+
+    // chunk index 0 -> chunkId 1, chunk index 1 -> chunkId 2
+    std::vector<uint64_t> chunkIds;
+    EXPECT_CALL(*client_, RecoverChunks(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(
+            Invoke([&chunkIds](std::vector<ChunkBatchItem> *items,
+                               SnapCloneClosure* scc){
+                    ASSERT_EQ(1, items->size());
+                    chunkIds.push_back((*items)[0].idinfo.cid_);
+                    (*items)[0].retCode = LIBCURVE_ERROR::OK;
+                    (*items)[0].accessed = (*items)[0].idinfo.cid_ == 1;
+                    scc->SetRetCode(LIBCURVE_ERROR::OK);
+                    scc->Run();
+                }),
+            Return(LIBCURVE_ERROR::OK)));
+
+    std::vector<ChunkIndexType> savedChunkIndexes;
+    EXPECT_CALL(*dataStore_, PutHotChunkIndex(_, _))
+        .WillOnce(DoAll(
+            SaveArg<1>(&savedChunkIndexes),
+            Return(kErrCodeSuccess)));
+
+    MockCompleteCloneFileSuccess(task);
+
+    core_->HandleCloneOrRecoverTask(task);
+    ASSERT_EQ(CloneStatus::done, task->GetCloneInfo().GetStatus());
+    ASSERT_EQ("file1", hotIndexName.fileName_);
+    ASSERT_EQ(100, hotIndexName.fileSeqNum_);
+    ASSERT_EQ(std::vector<uint64_t>({2, 1}), chunkIds);
+    // 本次在本地的chunk排在最前面
+    ASSERT_EQ(std::vector<ChunkIndexType>({0, 1}), savedChunkIndexes);
+}
+
+TEST_F(TestCloneCoreImpl,
+    HandleCloneOrRecoverTaskStage2SkipRetriedHotChunk) {
+    // 重试后才返回在本地的chunk不记录，记录超过上限时丢弃最旧的
+    option.cloneChunkBatchSize = 4;
+    option.hotChunkListMaxSize = 2;
+    core_ = std::make_shared<CloneCoreImpl>(client_,
+        metaStore_,
+        dataStore_,
+        snapshotRef_,
+        cloneRef_,
+        option);
+
+    CloneInfo info("id1", "user1", CloneTaskType::kClone,
+    "snapid1", "file1", 1, 2, 100, CloneFileType::kSnapshot, true,
+    CloneStep::kRecoverChunk, CloneStatus::cloning);
+    info.SetStatus(CloneStatus::cloning);
+    auto cloneMetric = std::make_shared<CloneInfoMetric>("id1");
+    auto cloneClosure = std::make_shared<CloneClosure>();
+    std::shared_ptr<CloneTaskInfo> task =
+        std::make_shared<CloneTaskInfo>(info, cloneMetric, cloneClosure);
+
+    EXPECT_CALL(*metaStore_, UpdateCloneInfo(_))
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    MockBuildFileInfoFromSnapshotSuccess(task);
+    MockCloneMetaSuccess(task);
+
+    std::vector<ChunkIndexType> hotChunkIndexes = {5, 6};
+    EXPECT_CALL(*dataStore_, GetHotChunkIndex(_, _))
+        .WillRepeatedly(DoAll(
+            SetArgPointee<1>(hotChunkIndexes),
+            Return(kErrCodeSuccess)));
+
+    // chunk index 0 -> chunkId 1，第一次请求失败；chunk index 1 -> chunkId 2
+    int chunk1Requests = 0;
+    EXPECT_CALL(*client_, RecoverChunks(_, _))
+        .Times(3)
+        .WillRepeatedly(DoAll(
+            Invoke([&chunk1Requests](std::vector<ChunkBatchItem> *items,
+                                     SnapCloneClosure* scc){
+                    ASSERT_EQ(1, items->size());
+                    ChunkBatchItem &item = (*items)[0];
+                    item.retCode = LIBCURVE_ERROR::OK;
+                    item.accessed = true;
+                    if (item.idinfo.cid_ == 1 && 0 == chunk1Requests++) {
+                        item.retCode = -LIBCURVE_ERROR::FAILED;
+                        item.accessed = false;
+                    }
+                    scc->SetRetCode(LIBCURVE_ERROR::OK);
+                    scc->Run();
+                }),
+            Return(LIBCURVE_ERROR::OK)));
+
+    std::vector<ChunkIndexType> savedChunkIndexes;
+    EXPECT_CALL(*dataStore_, PutHotChunkIndex(_, _))
+        .WillOnce(DoAll(
+            SaveArg<1>(&savedChunkIndexes),
+            Return(kErrCodeSuccess)));
+
+    MockCompleteCloneFileSuccess(task);
+
+    core_->HandleCloneOrRecoverTask(task);
+    ASSERT_EQ(CloneStatus::done, task->GetCloneInfo().GetStatus());
+    ASSERT_EQ(std::vector<ChunkIndexType>({1, 5}), savedChunkIndexes);
+}
+
+TEST_F(TestCloneCoreImpl,
+    HandleCloneOrRecoverTaskStage2ResumedNotSaveHotChunk) {
+    // 重启后恢复的任务，之前恢复过的chunk也在本地，不记录热点chunk
+    option.cloneChunkBatchSize = 4;
+    core_ = std::make_shared<CloneCoreImpl>(client_,
+        metaStore_,
+        dataStore_,
+        snapshotRef_,
+        cloneRef_,
+        option);
+
+    CloneInfo info("id1", "user1", CloneTaskType::kClone,
+    "snapid1", "file1", 1, 2, 100, CloneFileType::kSnapshot, true,
+    CloneStep::kRecoverChunk, CloneStatus::cloning);
+    info.SetStatus(CloneStatus::cloning);
+    auto cloneMetric = std::make_shared<CloneInfoMetric>("id1");
+    auto cloneClosure = std::make_shared<CloneClosure>();
+    std::shared_ptr<CloneTaskInfo> task =
+        std::make_shared<CloneTaskInfo>(info, cloneMetric, cloneClosure);
+    task->SetResumed();
+
+    EXPECT_CALL(*metaStore_, UpdateCloneInfo(_))
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    MockBuildFileInfoFromSnapshotSuccess(task);
+    MockCloneMetaSuccess(task);
+
+    EXPECT_CALL(*dataStore_, GetHotChunkIndex(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*client_, RecoverChunks(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(
+            Invoke([](std::vector<ChunkBatchItem> *items,
+                      SnapCloneClosure* scc){
+                    (*items)[0].retCode = LIBCURVE_ERROR::OK;
+                    (*items)[0].accessed = true;
+                    scc->SetRetCode(LIBCURVE_ERROR::OK);
+                    scc->Run();
+                }),
+            Return(LIBCURVE_ERROR::OK)));
+    EXPECT_CALL(*dataStore_, PutHotChunkIndex(_, _))
+        .Times(0);
+
+    MockCompleteCloneFileSuccess(task);
+
+    core_->HandleCloneOrRecoverTask(task);
+    ASSERT_EQ(CloneStatus::done, task->GetCloneInfo().GetStatus());
+}
+
 TEST_F(TestCloneCoreImpl,
     HandleCloneOrRecoverTaskFailOnBuildFileInfoFromSnapshot) {
     CloneInfo info("id1", "user1", CloneTaskType::kClone,
@@ -40,6 +40,7 @@ using ::testing::AllOf;
 using ::testing::SetArgPointee;
 using ::testing::Invoke;
 using ::testing::DoAll;
+using ::testing::SaveArg;
 
 class TestSnapshotCoreImpl : public ::testing::Test {
  public:
@@ -58,8 +59,11 @@ class TestSnapshotCoreImpl : public ::testing::Test {
         option.checkSnapshotStatusIntervalMs = 1000u;
         option.maxSnapshotLimit = 64;
         option.snapshotCoreThreadNum = 1;
+        option.snapshotUploadThreadNum = 1;
+        option.snapshotTransferMemoryLimit = 2u * 1024u * 1024u;
         option.clientAsyncMethodRetryTimeSec = 1;
         option.clientAsyncMethodRetryIntervalMs = 500;
+        option.chunkPackGcRatio = 0.5;
         core_ = std::make_shared<SnapshotCoreImpl>(client_,
                 metaStore_,
                 dataStore_,
@@ -2587,6 +2591,415 @@ TEST_F(TestSnapshotCoreImpl,
     ASSERT_EQ(Status::error, task->GetSnapshotInfo().GetStatus());
 }
 
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleDeleteSnapshotTaskKeepSharedChunkPack) {
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetSeqNum(seqNum);
+    info.SetStatus(Status::deleting);
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    SnapshotInfo info2("uuid2", user, fileName, "desc2");
+    info2.SetSeqNum(seqNum - 1);
+    info2.SetStatus(Status::done);
+    std::vector<SnapshotInfo> snapInfos;
+    snapInfos.push_back(info);
+    snapInfos.push_back(info2);
+
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(snapInfos),
+                    Return(kErrCodeSuccess)));
+
+    // chunk1与快照2共用pack1，pack2只被当前快照引用
+    ChunkIndexData indexData1;
+    indexData1.PutChunkDataName(ChunkDataName(fileName, seqNum, 0));
+    indexData1.PutChunkDataName(ChunkDataName(fileName, 1, 1));
+    indexData1.PutChunkDataName(ChunkDataName(fileName, seqNum, 2));
+    indexData1.PutChunkPackLocation(0, ChunkPackLocation("pack1", 0, 100, 200));
+    indexData1.PutChunkPackLocation(1,
+        ChunkPackLocation("pack1", 100, 100, 200));
+    indexData1.PutChunkPackLocation(2, ChunkPackLocation("pack2", 0, 100, 100));
+    ChunkIndexData indexData2;
+    indexData2.PutChunkDataName(ChunkDataName(fileName, 1, 1));
+    indexData2.PutChunkPackLocation(1,
+        ChunkPackLocation("pack1", 100, 100, 200));
+    EXPECT_CALL(*dataStore_, GetChunkIndexData(_, _))
+        .Times(2)
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(indexData2),
+                    Return(kErrCodeSuccess)))
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(indexData1),
+                    Return(kErrCodeSuccess)));
+
+    EXPECT_CALL(*dataStore_, ChunkIndexDataExist(_))
+        .WillRepeatedly(Return(true));
+
+    // pack1中仍有一半数据有效，不删除也不重写
+    EXPECT_CALL(*dataStore_, DeleteChunkPack("pack1"))
+        .Times(0);
+    EXPECT_CALL(*dataStore_, NewChunkPackWriter(_))
+        .Times(0);
+    EXPECT_CALL(*dataStore_, DeleteChunkPack("pack2"))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*dataStore_, DeleteChunkData(_))
+        .Times(0);
+
+    EXPECT_CALL(*dataStore_, DeleteChunkIndexData(_))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    EXPECT_CALL(*metaStore_, DeleteSnapshot(uuid))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    core_->HandleDeleteSnapshotTask(task);
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
+}
+
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleDeleteSnapshotTaskRewriteChunkPack) {
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetSeqNum(seqNum);
+    info.SetStatus(Status::deleting);
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    SnapshotInfo info2("uuid2", user, fileName, "desc2");
+    info2.SetSeqNum(seqNum - 1);
+    info2.SetStatus(Status::done);
+    SnapshotInfo info3("uuid3", user, fileName, "desc3");
+    info3.SetSeqNum(seqNum - 2);
+    info3.SetStatus(Status::done);
+    std::vector<SnapshotInfo> snapInfos;
+    snapInfos.push_back(info);
+    snapInfos.push_back(info2);
+    snapInfos.push_back(info3);
+
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(snapInfos),
+                    Return(kErrCodeSuccess)));
+
+    // 删除后pack1中只剩快照2和快照3共用的chunk1，有效数据低于一半
+    ChunkIndexData indexData1;
+    indexData1.PutChunkDataName(ChunkDataName(fileName, seqNum, 0));
+    indexData1.PutChunkPackLocation(0, ChunkPackLocation("pack1", 0, 300, 400));
+    ChunkIndexData indexData2;
+    indexData2.PutChunkDataName(ChunkDataName(fileName, 1, 1));
+    indexData2.PutChunkPackLocation(1,
+        ChunkPackLocation("pack1", 300, 100, 400));
+    EXPECT_CALL(*dataStore_, GetChunkIndexData(_, _))
+        .Times(3)
+        .WillRepeatedly(Invoke([&](const ChunkIndexDataName &name,
+                                   ChunkIndexData *indexData) {
+            *indexData = (name.fileSeqNum_ == seqNum) ? indexData1
+                                                      : indexData2;
+            return kErrCodeSuccess;
+        }));
+
+    EXPECT_CALL(*dataStore_, ChunkIndexDataExist(_))
+        .WillRepeatedly(Return(true));
+
+    auto packWriter = std::make_shared<MockChunkPackWriter>();
+    EXPECT_CALL(*dataStore_, NewChunkPackWriter(fileName))
+        .WillOnce(Return(packWriter));
+    EXPECT_CALL(*dataStore_,
+        GetChunkPackData(ChunkPackLocation("pack1", 300, 100, 400), _))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*packWriter, Append(ChunkDataName(fileName, 1, 1), _))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*packWriter, Flush())
+        .WillOnce(Return(0));
+    std::vector<std::pair<ChunkDataName, ChunkPackLocation>> sealed;
+    sealed.emplace_back(ChunkDataName(fileName, 1, 1),
+        ChunkPackLocation("pack2", 0, 100, 100));
+    EXPECT_CALL(*packWriter, TakeSealedLocations())
+        .WillOnce(Return(sealed));
+
+    // 引用pack1的两个快照的索引都要更新
+    std::vector<uint64_t> putSeqs;
+    EXPECT_CALL(*dataStore_, PutChunkIndexData(_, _))
+        .Times(2)
+        .WillRepeatedly(Invoke([&](const ChunkIndexDataName &name,
+                                   const ChunkIndexData &indexData) {
+            ChunkPackLocation location;
+            EXPECT_TRUE(indexData.GetChunkPackLocation(1, &location));
+            EXPECT_EQ(ChunkPackLocation("pack2", 0, 100, 100), location);
+            putSeqs.push_back(name.fileSeqNum_);
+            return kErrCodeSuccess;
+        }));
+    EXPECT_CALL(*dataStore_, DeleteChunkPack("pack1"))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    EXPECT_CALL(*dataStore_, DeleteChunkIndexData(_))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    EXPECT_CALL(*metaStore_, DeleteSnapshot(uuid))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    core_->HandleDeleteSnapshotTask(task);
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
+    ASSERT_EQ(std::vector<uint64_t>({seqNum - 1, seqNum - 2}), putSeqs);
+}
+
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleDeleteSnapshotTaskSkipRewriteChunkPackWhenCloning) {
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetSeqNum(seqNum);
+    info.SetStatus(Status::deleting);
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    SnapshotInfo info2("uuid2", user, fileName, "desc2");
+    info2.SetSeqNum(seqNum - 1);
+    info2.SetStatus(Status::done);
+    std::vector<SnapshotInfo> snapInfos;
+    snapInfos.push_back(info);
+    snapInfos.push_back(info2);
+
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(snapInfos),
+                    Return(kErrCodeSuccess)));
+
+    ChunkIndexData indexData1;
+    indexData1.PutChunkDataName(ChunkDataName(fileName, seqNum, 0));
+    indexData1.PutChunkPackLocation(0, ChunkPackLocation("pack1", 0, 300, 400));
+    ChunkIndexData indexData2;
+    indexData2.PutChunkDataName(ChunkDataName(fileName, 1, 1));
+    indexData2.PutChunkPackLocation(1,
+        ChunkPackLocation("pack1", 300, 100, 400));
+    EXPECT_CALL(*dataStore_, GetChunkIndexData(_, _))
+        .Times(2)
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(indexData2),
+                    Return(kErrCodeSuccess)))
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(indexData1),
+                    Return(kErrCodeSuccess)));
+
+    EXPECT_CALL(*dataStore_, ChunkIndexDataExist(_))
+        .WillRepeatedly(Return(true));
+
+    // 快照2正在被克隆，不能重写pack1
+    snapshotRef_->IncrementSnapshotRef("uuid2");
+    auto packWriter = std::make_shared<MockChunkPackWriter>();
+    EXPECT_CALL(*dataStore_, NewChunkPackWriter(fileName))
+        .WillOnce(Return(packWriter));
+    EXPECT_CALL(*dataStore_, GetChunkPackData(_, _))
+        .Times(0);
+    EXPECT_CALL(*packWriter, Append(_, _))
+        .Times(0);
+    EXPECT_CALL(*dataStore_, PutChunkIndexData(_, _))
+        .Times(0);
+    EXPECT_CALL(*dataStore_, DeleteChunkPack(_))
+        .Times(0);
+
+    EXPECT_CALL(*dataStore_, DeleteChunkIndexData(_))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    EXPECT_CALL(*metaStore_, DeleteSnapshot(uuid))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    core_->HandleDeleteSnapshotTask(task);
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
+}
+
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleDeleteSnapshotTaskRewriteChunkPackPutIndexDataFail) {
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetSeqNum(seqNum);
+    info.SetStatus(Status::deleting);
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    SnapshotInfo info2("uuid2", user, fileName, "desc2");
+    info2.SetSeqNum(seqNum - 1);
+    info2.SetStatus(Status::done);
+    SnapshotInfo info3("uuid3", user, fileName, "desc3");
+    info3.SetSeqNum(seqNum - 2);
+    info3.SetStatus(Status::done);
+    std::vector<SnapshotInfo> snapInfos;
+    snapInfos.push_back(info);
+    snapInfos.push_back(info2);
+    snapInfos.push_back(info3);
+
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(snapInfos),
+                    Return(kErrCodeSuccess)));
+
+    ChunkIndexData indexData1;
+    indexData1.PutChunkDataName(ChunkDataName(fileName, seqNum, 0));
+    indexData1.PutChunkPackLocation(0, ChunkPackLocation("pack1", 0, 300, 400));
+    ChunkIndexData indexData2;
+    indexData2.PutChunkDataName(ChunkDataName(fileName, 1, 1));
+    indexData2.PutChunkPackLocation(1,
+        ChunkPackLocation("pack1", 300, 100, 400));
+    EXPECT_CALL(*dataStore_, GetChunkIndexData(_, _))
+        .Times(3)
+        .WillRepeatedly(Invoke([&](const ChunkIndexDataName &name,
+                                   ChunkIndexData *indexData) {
+            *indexData = (name.fileSeqNum_ == seqNum) ? indexData1
+                                                      : indexData2;
+            return kErrCodeSuccess;
+        }));
+
+    EXPECT_CALL(*dataStore_, ChunkIndexDataExist(_))
+        .WillRepeatedly(Return(true));
+
+    auto packWriter = std::make_shared<MockChunkPackWriter>();
+    EXPECT_CALL(*dataStore_, NewChunkPackWriter(fileName))
+        .WillOnce(Return(packWriter));
+    EXPECT_CALL(*dataStore_, GetChunkPackData(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*packWriter, Append(_, _))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*packWriter, Flush())
+        .WillOnce(Return(0));
+    std::vector<std::pair<ChunkDataName, ChunkPackLocation>> sealed;
+    sealed.emplace_back(ChunkDataName(fileName, 1, 1),
+        ChunkPackLocation("pack2", 0, 100, 100));
+    EXPECT_CALL(*packWriter, TakeSealedLocations())
+        .WillOnce(Return(sealed));
+
+    // 快照3的索引更新失败，快照2的索引已指向pack2，两个pack都不能删除
+    EXPECT_CALL(*dataStore_, PutChunkIndexData(_, _))
+        .Times(2)
+        .WillOnce(Return(kErrCodeSuccess))
+        .WillOnce(Return(kErrCodeInternalError));
+    EXPECT_CALL(*dataStore_, DeleteChunkPack(_))
+        .Times(0);
+
+    // 重写失败不影响删除快照
+    EXPECT_CALL(*dataStore_, DeleteChunkIndexData(_))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    EXPECT_CALL(*metaStore_, DeleteSnapshot(uuid))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    core_->HandleDeleteSnapshotTask(task);
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
+}
+
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleCreateSnapshotTaskReuseChunkPackLocation) {
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetSeqNum(seqNum);
+    info.SetChunkSize(2 * option.chunkSplitSize);
+    info.SetSegmentSize(4 * option.chunkSplitSize);
+    info.SetFileLength(8 * option.chunkSplitSize);
+    info.SetStatus(Status::pending);
+
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    EXPECT_CALL(*dataStore_, ChunkIndexDataExist(_))
+        .WillOnce(Return(true));
+
+    ChunkIndexData indexData;
+    indexData.PutChunkDataName(ChunkDataName(fileName, seqNum, 0));
+    indexData.PutChunkDataName(ChunkDataName(fileName, 1, 1));
+
+    // 快照2中chunk1已打包存储
+    ChunkIndexData indexData2;
+    indexData2.PutChunkDataName(ChunkDataName(fileName, 1, 1));
+    indexData2.PutChunkPackLocation(1,
+        ChunkPackLocation("pack1", 100, 100, 200));
+
+    EXPECT_CALL(*dataStore_, GetChunkIndexData(_, _))
+        .Times(2)
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(indexData),
+                    Return(kErrCodeSuccess)))
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(indexData2),
+                    Return(kErrCodeSuccess)));
+
+    SegmentInfo segInfo;
+    segInfo.chunkvec.push_back(ChunkIDInfo(1, 1, 1));
+    segInfo.chunkvec.push_back(ChunkIDInfo(2, 2, 2));
+    EXPECT_CALL(*client_, GetSnapshotSegmentInfo(fileName,
+            user,
+            seqNum,
+            _,
+            _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<4>(segInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    SnapshotInfo info2("uuid2", user, fileName, "desc2");
+    info2.SetSeqNum(seqNum - 1);
+    info2.SetStatus(Status::done);
+    std::vector<SnapshotInfo> snapInfos;
+    snapInfos.push_back(info);
+    snapInfos.push_back(info2);
+
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(snapInfos),
+                    Return(kErrCodeSuccess)));
+
+    // 当前快照的索引中要记录共用chunk在pack中的位置，
+    // 更新索引失败则快照失败
+    ChunkIndexData putIndexData;
+    EXPECT_CALL(*dataStore_, PutChunkIndexData(_, _))
+        .WillOnce(DoAll(
+                    SaveArg<1>(&putIndexData),
+                    Return(kErrCodeInternalError)));
+
+    EXPECT_CALL(*metaStore_, UpdateSnapshot(_))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    core_->HandleCreateSnapshotTask(task);
+
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::error, task->GetSnapshotInfo().GetStatus());
+    ChunkPackLocation location;
+    ASSERT_TRUE(putIndexData.GetChunkPackLocation(1, &location));
+    ASSERT_EQ(ChunkPackLocation("pack1", 100, 100, 200), location);
+    ASSERT_FALSE(putIndexData.GetChunkPackLocation(0, &location));
+}
+
 TEST_F(TestSnapshotCoreImpl, TestHandleCreateSnapshotTaskCancelSuccess) {
     UUID uuid = "uuid1";
     std::string user = "user1";
@@ -21,12 +21,20 @@
  ************************************************************************/
 
 #include<iostream>
+#include <map>
+#include <set>
+#include <utility>
 #include <gmock/gmock.h>  //NOLINT
 #include <gtest/gtest.h>  //NOLINT
 #include "src/snapshotcloneserver/snapshot/snapshot_data_store_s3.h"
 #include "src/snapshotcloneserver/snapshot/snapshot_data_store.h"
 #include "test/snapshotcloneserver/mock_s3_adapter.h"
+#include "test/snapshotcloneserver/mock_snapshot_server.h"
 using ::testing::_;
+using ::testing::Invoke;
+using ::testing::DoAll;
+using ::testing::SetArgPointee;
+using ::testing::SaveArg;
 namespace curve {
 namespace snapshotcloneserver {
 
@@ -64,10 +72,29 @@ TEST_F(TestS3SnapshotDataStore, testInit) {
         .Times(2)
         .WillOnce(Return(0))
         .WillOnce(Return(-1));
+    EXPECT_CALL(*adapter4Data_, ListMultiUploads(_, _))
+        .WillOnce(Return(0));
     ASSERT_EQ(0, store_->Init(""));
     ASSERT_EQ(0, store_->Init(""));
     ASSERT_EQ(-1, store_->Init(""));
 }
+
+TEST_F(TestS3SnapshotDataStore, testInitAbortUnsealedChunkPack) {
+    EXPECT_CALL(*adapter4Meta_, Init(_));
+    EXPECT_CALL(*adapter4Data_, Init(_));
+    EXPECT_CALL(*adapter4Meta_, BucketExist())
+        .WillOnce(Return(true));
+    // 只终止pack的分片上传
+    std::vector<std::pair<Aws::String, Aws::String>> uploads = {
+        {"/file1-pack-uuid1", "upload1"},
+        {"/file1-0-1", "upload2"}};
+    EXPECT_CALL(*adapter4Data_, ListMultiUploads(Aws::String(""), _))
+        .WillOnce(DoAll(SetArgPointee<1>(uploads), Return(0)));
+    EXPECT_CALL(*adapter4Data_, AbortMultiUpload(
+            Aws::String("/file1-pack-uuid1"), Aws::String("upload1")))
+        .WillOnce(Return(-1));
+    ASSERT_EQ(0, store_->Init(""));
+}
 TEST_F(TestS3SnapshotDataStore, testChunkIndexDataExist) {
     ChunkIndexDataName indexDataName("test", 1);
     Aws::String obj = "test-1";
@@ -108,6 +135,14 @@ TEST_F(TestS3SnapshotDataStore, testGetIndexChunk) {
 TEST_F(TestS3SnapshotDataStore, testDeleteIndexChunk) {
     ChunkIndexDataName indexDataName("test", 1);
     Aws::String obj = "test-1";
+    Aws::String hotObj = "test-1-hot";
+    // 热点chunk记录存在时一并删除，删除失败不影响结果
+    EXPECT_CALL(*adapter4Meta_, ObjectExist(hotObj))
+        .Times(2)
+        .WillOnce(Return(true))
+        .WillOnce(Return(false));
+    EXPECT_CALL(*adapter4Meta_, DeleteObject(hotObj))
+        .WillOnce(Return(-1));
     EXPECT_CALL(*adapter4Meta_, DeleteObject(obj))
         .Times(2)
         .WillOnce(Return(0))
@@ -116,6 +151,32 @@ TEST_F(TestS3SnapshotDataStore, testDeleteIndexChunk) {
     ASSERT_EQ(-1, store_->DeleteChunkIndexData(indexDataName));
 }
 
+TEST_F(TestS3SnapshotDataStore, testHotChunkIndex) {
+    ChunkIndexDataName indexDataName("test", 1);
+    Aws::String obj = "test-1-hot";
+    std::vector<ChunkIndexType> indexes = {5, 1, 3};
+    std::string cxt;
+    EXPECT_CALL(*adapter4Meta_, PutObject(obj, _))
+        .WillOnce(DoAll(SaveArg<1>(&cxt), Return(0)));
+    ASSERT_EQ(0, store_->PutHotChunkIndex(indexDataName, indexes));
+
+    std::vector<ChunkIndexType> out = {7};
+    // 没有记录
+    EXPECT_CALL(*adapter4Meta_, ObjectExist(obj))
+        .Times(3)
+        .WillOnce(Return(false))
+        .WillRepeatedly(Return(true));
+    ASSERT_EQ(0, store_->GetHotChunkIndex(indexDataName, &out));
+    ASSERT_TRUE(out.empty());
+    EXPECT_CALL(*adapter4Meta_, GetObject(obj, _))
+        .Times(2)
+        .WillOnce(DoAll(SetArgPointee<1>(cxt), Return(0)))
+        .WillOnce(Return(-1));
+    ASSERT_EQ(0, store_->GetHotChunkIndex(indexDataName, &out));
+    ASSERT_EQ(indexes, out);
+    ASSERT_EQ(-1, store_->GetHotChunkIndex(indexDataName, &out));
+}
+
 TEST_F(TestS3SnapshotDataStore, testDataChunkOp) {
     ChunkDataName cdName("test", 1, 1);
     std::string cdKey = cdName.ToDataChunkKey();
@@ -174,6 +235,419 @@ TEST_F(TestS3SnapshotDataStore, testDataChunkTransferComplete) {
     ASSERT_EQ(0, store_->DataChunkTranferComplete(cdName, task));
     ASSERT_EQ(-1, store_->DataChunkTranferComplete(cdName, task));
 }
+TEST_F(TestS3SnapshotDataStore, testSparseDataChunkTransfer) {
+    ChunkObjectOption option;
+    option.sparse = true;
+    S3SnapshotDataStore store(option);
+    store.SetMetaAdapter(adapter4Meta_);
+    store.SetDataAdapter(adapter4Data_);
+
+    ChunkDataName cdName("test", 1, 1);
+    std::shared_ptr<TransferTask> task = std::make_shared<TransferTask>();
+    const int partSize = 1024;
+    char* buf = new char[partSize];
+
+    // 第0和第2个分片全为0，不上传
+    std::string footer;
+    EXPECT_CALL(*adapter4Data_, UploadOnePart(_, _, _, _, _))
+        .Times(3)
+        .WillRepeatedly(Invoke([&] (const Aws::String &key,
+                                    const Aws::String uploadId,
+                                    int partNum, int size, const char *data) {
+            if (partNum == 5) {
+                footer.assign(data, size);
+            }
+            return Aws::S3::Model::CompletedPart()
+                .WithETag("mytest").WithPartNumber(partNum);
+        }));
+    for (int i = 0; i < 4; ++i) {
+        memset(buf, 0, partSize);
+        if (i % 2 == 1) {
+            buf[partSize - 1] = 1;
+        }
+        ASSERT_EQ(0, store.DataChunkTranferAddPart(
+            cdName, task, i, partSize, buf));
+    }
+
+    // 完成时上传layout，分片号为2 4 5
+    std::vector<int> partNums;
+    EXPECT_CALL(*adapter4Data_, CompleteMultiUpload(_, _, _))
+        .WillOnce(Invoke([&] (const Aws::String &key,
+                              const Aws::String &uploadId,
+                const Aws::Vector<Aws::S3::Model::CompletedPart> &parts) {
+            for (const auto &part : parts) {
+                partNums.push_back(part.GetPartNumber());
+            }
+            return 0;
+        }));
+    ASSERT_EQ(0, store.DataChunkTranferComplete(cdName, task));
+    ASSERT_EQ(std::vector<int>({2, 4, 5}), partNums);
+
+    ChunkObjectLayout layout;
+    size_t needLen = 0;
+    ASSERT_EQ(curve::common::LayoutDecodeStatus::OK,
+              ChunkObjectLayout::Decode(footer.data(), footer.size(),
+                                        &layout, &needLen));
+    ASSERT_EQ(partSize, layout.GetPartSize());
+    ASSERT_EQ(4, layout.GetPartNum());
+    ASSERT_FALSE(layout.IsPartPresent(0));
+    ASSERT_TRUE(layout.IsPartPresent(1));
+    ASSERT_FALSE(layout.IsPartPresent(2));
+    ASSERT_TRUE(layout.IsPartPresent(3));
+    delete [] buf;
+}
+
+TEST_F(TestS3SnapshotDataStore, testCompressedDataChunkTransfer) {
+    ChunkObjectOption option;
+    option.compressType = CompressType::Zlib;
+    option.compressLevel = 6;
+    S3SnapshotDataStore store(option);
+    store.SetMetaAdapter(adapter4Meta_);
+    store.SetDataAdapter(adapter4Data_);
+
+    ChunkDataName cdName("test", 1, 1);
+    std::shared_ptr<TransferTask> task = std::make_shared<TransferTask>();
+    const int partSize = 1024;
+    char* buf = new char[partSize];
+
+    // 第0个分片可以压缩，第1个分片压缩后不会变小，按原样存储
+    std::map<int, std::string> uploaded;
+    EXPECT_CALL(*adapter4Data_, UploadOnePart(_, _, _, _, _))
+        .Times(3)
+        .WillRepeatedly(Invoke([&] (const Aws::String &key,
+                                    const Aws::String uploadId,
+                                    int partNum, int size, const char *data) {
+            uploaded[partNum].assign(data, size);
+            return Aws::S3::Model::CompletedPart()
+                .WithETag("mytest").WithPartNumber(partNum);
+        }));
+    memset(buf, 'a', partSize);
+    ASSERT_EQ(0, store.DataChunkTranferAddPart(
+        cdName, task, 0, partSize, buf));
+    unsigned int seed = 1;
+    for (int i = 0; i < partSize; ++i) {
+        buf[i] = static_cast<char>(rand_r(&seed));
+    }
+    ASSERT_EQ(0, store.DataChunkTranferAddPart(
+        cdName, task, 1, partSize, buf));
+
+    EXPECT_CALL(*adapter4Data_, CompleteMultiUpload(_, _, _))
+        .WillOnce(Return(0));
+    ASSERT_EQ(0, store.DataChunkTranferComplete(cdName, task));
+
+    ChunkObjectLayout layout;
+    size_t needLen = 0;
+    ASSERT_EQ(curve::common::LayoutDecodeStatus::OK,
+              ChunkObjectLayout::Decode(uploaded[3].data(),
+                  uploaded[3].size(), &layout, &needLen));
+    ASSERT_EQ(CompressType::Zlib, layout.GetCompressType(0));
+    ASSERT_EQ(uploaded[1].size(), layout.GetStoredLength(0));
+    ASSERT_LT(layout.GetStoredLength(0), partSize);
+    ASSERT_EQ(CompressType::None, layout.GetCompressType(1));
+    ASSERT_EQ(partSize, layout.GetStoredLength(1));
+
+    // 压缩的分片可以单独解压
+    std::vector<char> out(partSize);
+    ASSERT_TRUE(curve::common::Decompress(CompressType::Zlib,
+        uploaded[1].data(), uploaded[1].size(), out.data(), out.size()));
+    ASSERT_EQ(std::string(partSize, 'a'), std::string(out.begin(), out.end()));
+    delete [] buf;
+}
+
+TEST_F(TestS3SnapshotDataStore, testDedupDataChunkTransfer) {
+    ChunkObjectOption option;
+    option.dedup = true;
+    S3SnapshotDataStore store(option);
+    store.SetMetaAdapter(adapter4Meta_);
+    store.SetDataAdapter(adapter4Data_);
+    auto metaStore = std::make_shared<MockSnapshotCloneMetaStore>();
+    store.SetMetaStore(metaStore);
+
+    // 用map模拟metastore中的分片数据记录和引用记录
+    std::map<std::string, ChunkPartRefInfo> infos;
+    std::map<std::string, std::set<std::pair<std::string, int>>> refs;
+    EXPECT_CALL(*metaStore, GetChunkPartRef(_, _))
+        .WillRepeatedly(Invoke([&] (const std::string &hash,
+                                    ChunkPartRefInfo *info) {
+            *info = ChunkPartRefInfo();
+            info->hash = hash;
+            if (infos.count(hash) != 0) {
+                *info = infos[hash];
+            }
+            return 0;
+        }));
+    int addRefsCalls = 0;
+    EXPECT_CALL(*metaStore, AddChunkPartRefs(_, _))
+        .WillRepeatedly(Invoke([&] (const std::string &chunkName,
+                const std::map<int, ChunkPartRefInfo> &parts) {
+            addRefsCalls++;
+            for (const auto &part : parts) {
+                infos[part.second.hash] = part.second;
+                refs[part.second.hash].emplace(chunkName, part.first);
+            }
+            return 0;
+        }));
+    EXPECT_CALL(*metaStore, RemoveChunkPartRefs(_, _))
+        .WillRepeatedly(Invoke([&] (const std::string &chunkName,
+                const std::map<int, std::string> &parts) {
+            for (const auto &part : parts) {
+                refs[part.second].erase(std::make_pair(chunkName, part.first));
+                if (refs[part.second].empty()) {
+                    refs.erase(part.second);
+                }
+            }
+            return 0;
+        }));
+    EXPECT_CALL(*metaStore, HasChunkPartRef(_, _))
+        .WillRepeatedly(Invoke([&] (const std::string &hash,
+                                    bool *referenced) {
+            *referenced = refs.count(hash) != 0;
+            return 0;
+        }));
+    EXPECT_CALL(*metaStore, DeleteChunkPartRef(_))
+        .WillRepeatedly(Invoke([&] (const std::string &hash) {
+            infos.erase(hash);
+            return 0;
+        }));
+    std::map<std::string, std::string> objects;
+    EXPECT_CALL(*adapter4Data_, PutObject(_, _))
+        .WillRepeatedly(Invoke([&] (const Aws::String &key,
+                                    const std::string &data) {
+            objects[std::string(key.c_str(), key.size())] = data;
+            return 0;
+        }));
+
+    // 分片0和1内容相同，分片2全为0，分片3内容不同
+    ChunkDataName cdName("test", 1, 1);
+    std::shared_ptr<TransferTask> task = std::make_shared<TransferTask>();
+    const int partSize = 1024;
+    std::vector<char> buf(partSize, 'a');
+    ASSERT_EQ(0, store.DataChunkTranferInit(cdName, task));
+    ASSERT_EQ(0, store.DataChunkTranferAddPart(
+        cdName, task, 0, partSize, buf.data()));
+    ASSERT_EQ(0, store.DataChunkTranferAddPart(
+        cdName, task, 1, partSize, buf.data()));
+    std::vector<char> zero(partSize, 0);
+    ASSERT_EQ(0, store.DataChunkTranferAddPart(
+        cdName, task, 2, partSize, zero.data()));
+    std::vector<char> buf2(partSize, 'b');
+    ASSERT_EQ(0, store.DataChunkTranferAddPart(
+        cdName, task, 3, partSize, buf2.data()));
+    // 内容相同的分片只写入一次，引用在转储完成时才记录
+    ASSERT_EQ(2, objects.size());
+    ASSERT_TRUE(refs.empty());
+
+    // 一个chunk的引用一次批量记录
+    ASSERT_EQ(0, store.DataChunkTranferComplete(cdName, task));
+    ASSERT_EQ(1, addRefsCalls);
+    ASSERT_EQ(3, objects.size());
+    const std::string object = objects[cdName.ToDataChunkKey()];
+    ChunkObjectLayout layout;
+    size_t needLen = 0;
+    ASSERT_EQ(curve::common::LayoutDecodeStatus::OK,
+              ChunkObjectLayout::Decode(object.data(), object.size(),
+                                        &layout, &needLen));
+    // chunk对象中只有layout
+    ASSERT_EQ(0, layout.GetDataLength());
+    std::string hashA = layout.GetPartHash(0);
+    std::string hashB = layout.GetPartHash(3);
+    ASSERT_EQ(hashA, layout.GetPartHash(1));
+    ASSERT_FALSE(layout.IsPartPresent(2));
+    ASSERT_NE(hashA, hashB);
+    ASSERT_EQ(2, infos.size());
+    ASSERT_EQ(2, refs[hashA].size());
+    ASSERT_EQ(1, refs[hashB].size());
+    ASSERT_EQ(std::string(partSize, 'b'),
+              objects[ChunkObjectLayout::PartObjectKey(hashB)]);
+
+    // 重新转储同一个chunk不会重复记录引用
+    task = std::make_shared<TransferTask>();
+    ASSERT_EQ(0, store.DataChunkTranferAddPart(
+        cdName, task, 0, partSize, buf.data()));
+    ASSERT_EQ(0, store.DataChunkTranferAddPart(
+        cdName, task, 1, partSize, buf.data()));
+    ASSERT_EQ(0, store.DataChunkTranferAddPart(
+        cdName, task, 3, partSize, buf2.data()));
+    ASSERT_EQ(0, store.DataChunkTranferComplete(cdName, task));
+    ASSERT_EQ(2, refs[hashA].size());
+    ASSERT_EQ(1, refs[hashB].size());
+
+    // 转储失败时不影响其他chunk的引用
+    ChunkDataName cdName2("test", 2, 1);
+    task = std::make_shared<TransferTask>();
+    ASSERT_EQ(0, store.DataChunkTranferAddPart(
+        cdName2, task, 0, partSize, buf.data()));
+    EXPECT_CALL(*adapter4Data_, DeleteObject(
+        Aws::String(cdName2.ToDataChunkKey().c_str())))
+        .WillOnce(Return(0));
+    ASSERT_EQ(0, store.DataChunkTranferAbort(cdName2, task));
+    ASSERT_EQ(2, refs[hashA].size());
+
+    // 转储中的chunk引用的分片数据在记录引用前不会被删除
+    ChunkDataName cdName3("test", 3, 1);
+    std::shared_ptr<TransferTask> task3 = std::make_shared<TransferTask>();
+    ASSERT_EQ(0, store.DataChunkTranferAddPart(
+        cdName3, task3, 0, partSize, buf2.data()));
+
+    // 删除chunk对象后不再被引用的分片数据被删除
+    EXPECT_CALL(*adapter4Meta_, GetObjectTail(cdName.ToDataChunkKey(), _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(object), Return(0)));
+    EXPECT_CALL(*adapter4Meta_, DeleteObject(
+        Aws::String(cdName.ToDataChunkKey().c_str())))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*adapter4Data_, DeleteObject(Aws::String(
+        ChunkObjectLayout::PartObjectKey(hashA).c_str())))
+        .WillOnce(Return(0));
+    ASSERT_EQ(0, store.DeleteChunkData(cdName));
+    ASSERT_EQ(0, refs.count(hashA));
+    ASSERT_EQ(0, infos.count(hashA));
+    ASSERT_EQ(1, infos.count(hashB));
+
+    ASSERT_EQ(0, store.DataChunkTranferComplete(cdName3, task3));
+    ASSERT_EQ(1, refs[hashB].size());
+
+    // 关闭去重后删除之前去重存储的chunk对象也会释放引用，
+    // 删除分片数据失败后重试删除可以继续释放
+    S3SnapshotDataStore plainStore;
+    plainStore.SetMetaAdapter(adapter4Meta_);
+    plainStore.SetDataAdapter(adapter4Data_);
+    plainStore.SetMetaStore(metaStore);
+    const std::string object3 = objects[cdName3.ToDataChunkKey()];
+    EXPECT_CALL(*adapter4Meta_, GetObjectTail(cdName3.ToDataChunkKey(), _, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<2>(object3), Return(0)));
+    EXPECT_CALL(*adapter4Data_, DeleteObject(Aws::String(
+        ChunkObjectLayout::PartObjectKey(hashB).c_str())))
+        .WillOnce(Return(-1))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*adapter4Meta_, DeleteObject(
+        Aws::String(cdName3.ToDataChunkKey().c_str())))
+        .WillOnce(Return(0));
+    ASSERT_EQ(-1, plainStore.DeleteChunkData(cdName3));
+    ASSERT_EQ(0, plainStore.DeleteChunkData(cdName3));
+    ASSERT_TRUE(refs.empty());
+    ASSERT_TRUE(infos.empty());
+}
+
+TEST_F(TestS3SnapshotDataStore, testInitChunkDedupFlag) {
+    auto metaStore = std::make_shared<MockSnapshotCloneMetaStore>();
+    EXPECT_CALL(*adapter4Meta_, Init(_)).Times(3);
+    EXPECT_CALL(*adapter4Data_, Init(_)).Times(3);
+    EXPECT_CALL(*adapter4Meta_, BucketExist())
+        .WillRepeatedly(Return(false));
+    EXPECT_CALL(*adapter4Meta_, CreateBucket())
+        .WillRepeatedly(Return(0));
+
+    // 开启去重时记录标记
+    ChunkObjectOption option;
+    option.dedup = true;
+    S3SnapshotDataStore dedupStore(option);
+    dedupStore.SetMetaAdapter(adapter4Meta_);
+    dedupStore.SetDataAdapter(adapter4Data_);
+    dedupStore.SetMetaStore(metaStore);
+    EXPECT_CALL(*metaStore, SetChunkDedupFlag())
+        .WillOnce(Return(-1))
+        .WillOnce(Return(0));
+    ASSERT_EQ(-1, dedupStore.Init(""));
+    ASSERT_EQ(0, dedupStore.Init(""));
+
+    // 从未开启过去重时删除chunk不读取layout
+    store_->SetMetaStore(metaStore);
+    EXPECT_CALL(*metaStore, GetChunkDedupFlag(_))
+        .WillOnce(DoAll(SetArgPointee<0>(false), Return(0)));
+    ASSERT_EQ(0, store_->Init(""));
+    ChunkDataName cdName("test", 1, 1);
+    EXPECT_CALL(*adapter4Meta_, GetObjectTail(_, _, _))
+        .Times(0);
+    EXPECT_CALL(*adapter4Meta_, DeleteObject(
+        Aws::String(cdName.ToDataChunkKey().c_str())))
+        .WillOnce(Return(0));
+    ASSERT_EQ(0, store_->DeleteChunkData(cdName));
+}
+
+TEST_F(TestS3SnapshotDataStore, testPackDataChunkTransfer) {
+    ChunkObjectOption option;
+    option.packSize = 3000;
+    option.packPartSize = 1024;
+    S3SnapshotDataStore store(option);
+    store.SetMetaAdapter(adapter4Meta_);
+    store.SetDataAdapter(adapter4Data_);
+
+    std::shared_ptr<ChunkPackWriter> writer = store.NewChunkPackWriter("test");
+    ASSERT_NE(nullptr, writer);
+
+    // 两个chunk共写入一个pack，不单独初始化chunk对象的上传
+    std::string packKey;
+    EXPECT_CALL(*adapter4Data_, MultiUploadInit(_))
+        .WillOnce(Invoke([&] (const Aws::String &key) {
+            packKey.assign(key.c_str(), key.size());
+            return Aws::String("packUploadId");
+        }));
+    std::vector<int> partSizes;
+    EXPECT_CALL(*adapter4Data_, UploadOnePart(_, _, _, _, _))
+        .Times(2)
+        .WillRepeatedly(Invoke([&] (const Aws::String &key,
+                                    const Aws::String uploadId,
+                                    int partNum, int size, const char *data) {
+            partSizes.push_back(size);
+            return Aws::S3::Model::CompletedPart()
+                .WithETag("mytest").WithPartNumber(partNum);
+        }));
+    EXPECT_CALL(*adapter4Data_, CompleteMultiUpload(_, _, _))
+        .WillOnce(Return(0));
+
+    const int partSize = 1024;
+    std::vector<char> buf(partSize, 'a');
+    ChunkDataName cdName1("test", 1, 1);
+    ChunkDataName cdName2("test", 1, 2);
+    for (const auto &cdName : {cdName1, cdName2}) {
+        std::shared_ptr<TransferTask> task = std::make_shared<TransferTask>();
+        task->packWriter_ = writer;
+        ASSERT_EQ(0, store.DataChunkTranferInit(cdName, task));
+        for (int i = 0; i < 2; ++i) {
+            ASSERT_EQ(0, store.DataChunkTranferAddPart(
+                cdName, task, i + 1, partSize, buf.data()));
+        }
+        ASSERT_EQ(0, store.DataChunkTranferComplete(cdName, task));
+    }
+    ASSERT_EQ(0, writer->Flush());
+    // 第一个chunk写入后凑满一个分片，第二个chunk写入后pack满
+    ASSERT_EQ(std::vector<int>({2048, 2048}), partSizes);
+
+    auto locations = writer->TakeSealedLocations();
+    ASSERT_EQ(2, locations.size());
+    ASSERT_EQ(cdName1, locations[0].first);
+    ASSERT_EQ(ChunkPackLocation(packKey, 0, 2048, 4096), locations[0].second);
+    ASSERT_EQ(cdName2, locations[1].first);
+    ASSERT_EQ(ChunkPackLocation(packKey, 2048, 2048, 4096),
+              locations[1].second);
+    ASSERT_TRUE(writer->TakeSealedLocations().empty());
+
+    // 从pack中读取chunk数据
+    EXPECT_CALL(*adapter4Data_, GetObject(packKey, _, 2048, 2048))
+        .WillOnce(Return(0))
+        .WillOnce(Return(-1));
+    std::string data;
+    ASSERT_EQ(0, store.GetChunkPackData(locations[1].second, &data));
+    ASSERT_EQ(2048, data.size());
+    ASSERT_EQ(-1, store.GetChunkPackData(locations[1].second, &data));
+
+    // 上传失败时整个pack作废
+    EXPECT_CALL(*adapter4Data_, MultiUploadInit(_))
+        .WillOnce(Return(Aws::String("packUploadId")));
+    EXPECT_CALL(*adapter4Data_, UploadOnePart(_, _, _, _, _))
+        .WillOnce(Return(Aws::S3::Model::CompletedPart()
+            .WithETag("errorTag").WithPartNumber(-1)));
+    EXPECT_CALL(*adapter4Data_, AbortMultiUpload(_, _))
+        .WillOnce(Return(0));
+    ASSERT_EQ(0, writer->Append(cdName1, std::string(100, 'a')));
+    ASSERT_EQ(-1, writer->Flush());
+    ASSERT_TRUE(writer->TakeSealedLocations().empty());
+
+    // 未开启打包存储
+    ASSERT_EQ(nullptr, store_->NewChunkPackWriter("test"));
+}
+
 TEST_F(TestS3SnapshotDataStore, testDataChunkTransferAbort) {
     ChunkDataName cdName("test", 1, 1);
     std::shared_ptr<TransferTask> task = std::make_shared<TransferTask>();
@@ -280,6 +754,28 @@ TEST(TestChunkIndexData, TestGetAllChunkIndex) {
     ASSERT_EQ(100, ret[0]);
 }
 
+TEST(TestChunkIndexData, TestChunkPackLocation) {
+    ChunkIndexData indexData;
+    indexData.SetFileName("file1");
+    indexData.PutChunkDataName(ChunkDataName("file1", 10, 100));
+    indexData.PutChunkDataName(ChunkDataName("file1", 10, 101));
+    ChunkPackLocation loc("file1-pack-1", 4096, 1024, 8192);
+    indexData.PutChunkPackLocation(100, loc);
+    // 不存在的chunk不记录pack位置
+    indexData.PutChunkPackLocation(102, loc);
+    ASSERT_EQ(1, indexData.GetAllChunkPackLocation().size());
+
+    std::string data;
+    ASSERT_TRUE(indexData.Serialize(&data));
+    ChunkIndexData out;
+    ASSERT_TRUE(out.Unserialize(data));
+    ChunkPackLocation outLoc;
+    ASSERT_TRUE(out.GetChunkPackLocation(100, &outLoc));
+    ASSERT_EQ(loc, outLoc);
+    ASSERT_FALSE(out.GetChunkPackLocation(101, &outLoc));
+    ASSERT_EQ(2, out.GetAllChunkIndex().size());
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
 
@@ -27,6 +27,8 @@
 #include <memory>
 #include <map>
 #include <string>
+#include <set>
+#include <utility>
 
 #include "src/snapshotcloneserver/common/snapshotclone_meta_store_etcd.h"
 #include "src/kvstorageclient/etcd_client.h"
@@ -47,6 +49,8 @@ using ::testing::AllOf;
 using ::testing::SetArgPointee;
 using ::testing::Invoke;
 using ::testing::DoAll;
+using ::testing::SaveArg;
+using ::testing::DoAll;
 using ::testing::Matcher;
 
 namespace curve {
@@ -757,6 +761,155 @@ TEST_F(TestSnapshotCloneMetaStoreEtcd,
 
 
 
+// chunk part ref
+
+TEST_F(TestSnapshotCloneMetaStoreEtcd, TestChunkPartRef) {
+    std::string hash(32, 'a');
+    ChunkPartRefInfo info;
+    info.hash = hash;
+    info.storedLength = 100;
+    info.compressType = curve::common::CompressType::Snappy;
+    std::string value;
+    ASSERT_TRUE(codec_->EncodeChunkPartRefData(info, &value));
+
+    std::string key = codec_->EncodeChunkPartRefKey(hash);
+    ChunkPartRefInfo out;
+    EXPECT_CALL(*kvStorageClient_, Get(key, _))
+        .WillOnce(DoAll(SetArgPointee<1>(value),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist))
+        .WillOnce(Return(EtcdErrCode::EtcdUnknown));
+    ASSERT_EQ(0, metaStore_->GetChunkPartRef(hash, &out));
+    ASSERT_EQ(hash, out.hash);
+    ASSERT_EQ(100, out.storedLength);
+    ASSERT_EQ(curve::common::CompressType::Snappy, out.compressType);
+    // 记录不存在时storedLength为0
+    ASSERT_EQ(0, metaStore_->GetChunkPartRef(hash, &out));
+    ASSERT_EQ(hash, out.hash);
+    ASSERT_EQ(0, out.storedLength);
+    ASSERT_EQ(-1, metaStore_->GetChunkPartRef(hash, &out));
+
+    EXPECT_CALL(*kvStorageClient_, Delete(key))
+        .WillOnce(Return(EtcdErrCode::EtcdOK))
+        .WillOnce(Return(EtcdErrCode::EtcdUnknown));
+    ASSERT_EQ(0, metaStore_->DeleteChunkPartRef(hash));
+    ASSERT_EQ(-1, metaStore_->DeleteChunkPartRef(hash));
+}
+
+TEST_F(TestSnapshotCloneMetaStoreEtcd, TestAddAndRemoveChunkPartRefs) {
+    std::string hashA(32, 'a');
+    std::string hashB(32, 'b');
+    std::map<int, ChunkPartRefInfo> parts;
+    parts[0].hash = hashA;
+    parts[0].storedLength = 100;
+    parts[1] = parts[0];
+    parts[3].hash = hashB;
+    parts[3].storedLength = 200;
+
+    // 一个chunk的引用在一个事务中记录，分片数据的记录只写一次
+    std::vector<std::pair<int, std::string>> ops;
+    auto saveOps = [&] (const std::vector<Operation> &txn, int64_t *rev) {
+        ops.clear();
+        for (const auto &op : txn) {
+            ops.emplace_back(op.opType, std::string(op.key, op.keyLen));
+        }
+        return EtcdErrCode::EtcdOK;
+    };
+    EXPECT_CALL(*kvStorageClient_, TxnNWithRevision(_, _))
+        .WillOnce(Invoke(saveOps))
+        .WillOnce(Return(EtcdErrCode::EtcdUnknown));
+    ASSERT_EQ(0, metaStore_->AddChunkPartRefs("chunk1", parts));
+    ASSERT_EQ(5, ops.size());
+    std::set<std::string> keys;
+    for (const auto &op : ops) {
+        ASSERT_EQ(OpType::OpPut, op.first);
+        keys.insert(op.second);
+    }
+    ASSERT_EQ(1, keys.count(codec_->EncodeChunkPartRefKey(hashA)));
+    ASSERT_EQ(1, keys.count(codec_->EncodeChunkPartRefKey(hashB)));
+    ASSERT_EQ(1, keys.count(codec_->EncodeChunkRefKey(hashA, "chunk1", 0)));
+    ASSERT_EQ(1, keys.count(codec_->EncodeChunkRefKey(hashA, "chunk1", 1)));
+    ASSERT_EQ(1, keys.count(codec_->EncodeChunkRefKey(hashB, "chunk1", 3)));
+    ASSERT_EQ(-1, metaStore_->AddChunkPartRefs("chunk1", parts));
+
+    // 引用记录在分片数据记录的key范围内
+    std::string refKey = codec_->EncodeChunkRefKey(hashA, "chunk1", 0);
+    ASSERT_GE(refKey, SnapshotCloneCodec::GetChunkRefKeyPrefix(hashA));
+    ASSERT_LT(refKey, SnapshotCloneCodec::GetChunkRefKeyEnd(hashA));
+
+    // 超过etcd事务的操作数上限时分批提交
+    std::map<int, ChunkPartRefInfo> many;
+    for (int i = 0; i < 100; ++i) {
+        many[i].hash = std::string(31, 'c') + static_cast<char>(i);
+        many[i].storedLength = 100;
+    }
+    std::vector<size_t> txnSizes;
+    EXPECT_CALL(*kvStorageClient_, TxnNWithRevision(_, _))
+        .Times(2)
+        .WillRepeatedly(Invoke([&] (const std::vector<Operation> &txn,
+                                    int64_t *rev) {
+            txnSizes.push_back(txn.size());
+            return EtcdErrCode::EtcdOK;
+        }));
+    ASSERT_EQ(0, metaStore_->AddChunkPartRefs("chunk2", many));
+    ASSERT_EQ(128, txnSizes[0]);
+    ASSERT_EQ(72, txnSizes[1]);
+
+    std::map<int, std::string> hashes;
+    hashes[0] = hashA;
+    hashes[1] = hashA;
+    hashes[3] = hashB;
+    EXPECT_CALL(*kvStorageClient_, TxnNWithRevision(_, _))
+        .WillOnce(Invoke(saveOps))
+        .WillOnce(Return(EtcdErrCode::EtcdUnknown));
+    ASSERT_EQ(0, metaStore_->RemoveChunkPartRefs("chunk1", hashes));
+    ASSERT_EQ(3, ops.size());
+    for (const auto &op : ops) {
+        ASSERT_EQ(OpType::OpDelete, op.first);
+    }
+    ASSERT_EQ(codec_->EncodeChunkRefKey(hashB, "chunk1", 3), ops[2].second);
+    ASSERT_EQ(-1, metaStore_->RemoveChunkPartRefs("chunk1", hashes));
+}
+
+TEST_F(TestSnapshotCloneMetaStoreEtcd, TestHasChunkPartRef) {
+    std::string hash(32, 'a');
+    std::vector<std::string> refs{""};
+    EXPECT_CALL(*kvStorageClient_, List(
+            SnapshotCloneCodec::GetChunkRefKeyPrefix(hash),
+            SnapshotCloneCodec::GetChunkRefKeyEnd(hash),
+            Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(refs),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(DoAll(SetArgPointee<2>(std::vector<std::string>()),
+                        Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(Return(EtcdErrCode::EtcdUnknown));
+    bool referenced = false;
+    ASSERT_EQ(0, metaStore_->HasChunkPartRef(hash, &referenced));
+    ASSERT_TRUE(referenced);
+    ASSERT_EQ(0, metaStore_->HasChunkPartRef(hash, &referenced));
+    ASSERT_FALSE(referenced);
+    ASSERT_EQ(-1, metaStore_->HasChunkPartRef(hash, &referenced));
+}
+
+TEST_F(TestSnapshotCloneMetaStoreEtcd, TestChunkDedupFlag) {
+    std::string key = SnapshotCloneCodec::GetChunkDedupFlagKey();
+    EXPECT_CALL(*kvStorageClient_, Put(key, _))
+        .WillOnce(Return(EtcdErrCode::EtcdOK))
+        .WillOnce(Return(EtcdErrCode::EtcdUnknown));
+    ASSERT_EQ(0, metaStore_->SetChunkDedupFlag());
+    ASSERT_EQ(-1, metaStore_->SetChunkDedupFlag());
+
+    EXPECT_CALL(*kvStorageClient_, Get(key, _))
+        .WillOnce(Return(EtcdErrCode::EtcdKeyNotExist))
+        .WillOnce(Return(EtcdErrCode::EtcdOK))
+        .WillOnce(Return(EtcdErrCode::EtcdUnknown));
+    bool everEnabled = true;
+    ASSERT_EQ(0, metaStore_->GetChunkDedupFlag(&everEnabled));
+    ASSERT_FALSE(everEnabled);
+    ASSERT_EQ(0, metaStore_->GetChunkDedupFlag(&everEnabled));
+    ASSERT_TRUE(everEnabled);
+    ASSERT_EQ(-1, metaStore_->GetChunkDedupFlag(&everEnabled));
+}
 
 }  // namespace snapshotcloneserver
 }  // namespace curve
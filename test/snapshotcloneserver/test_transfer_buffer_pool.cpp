@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2020 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2021-03-01
+ * Author: curve
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <thread>  // NOLINT
+
+#include "src/snapshotcloneserver/snapshot/transfer_buffer_pool.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+TEST(TestTransferBufferPool, AcquireAndRelease) {
+    auto pool = std::make_shared<TransferBufferPool>(1024, 2048 + 100);
+    ASSERT_EQ(2, pool->GetMaxBufferNum());
+
+    std::unique_ptr<TransferBuffer> buf1 = pool->Acquire();
+    std::unique_ptr<TransferBuffer> buf2 = pool->TryAcquire();
+    ASSERT_NE(nullptr, buf2);
+    ASSERT_EQ(2, pool->GetInUseNum());
+    // 达到上限
+    ASSERT_EQ(nullptr, pool->TryAcquire());
+
+    // 归还的buffer被复用
+    char *data = buf1->Data();
+    buf1.reset();
+    ASSERT_EQ(1, pool->GetInUseNum());
+    buf1 = pool->TryAcquire();
+    ASSERT_EQ(data, buf1->Data());
+
+    // 达到上限时阻塞，直到有buffer归还
+    std::atomic<bool> acquired(false);
+    std::thread t([&] {
+        std::unique_ptr<TransferBuffer> buf3 = pool->Acquire();
+        acquired = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(acquired);
+    buf2.reset();
+    t.join();
+    ASSERT_TRUE(acquired);
+    ASSERT_EQ(1, pool->GetInUseNum());
+}
+
+TEST(TestTransferBufferPool, CapacityLessThanBufferSize) {
+    // 上限小于单个buffer大小时仍可申请1个buffer
+    auto pool = std::make_shared<TransferBufferPool>(1024, 100);
+    ASSERT_EQ(1, pool->GetMaxBufferNum());
+    std::unique_ptr<TransferBuffer> buf = pool->TryAcquire();
+    ASSERT_NE(nullptr, buf);
+    ASSERT_EQ(nullptr, pool->TryAcquire());
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
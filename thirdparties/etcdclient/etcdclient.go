@@ -57,6 +57,8 @@ enum EtcdErrCode
     EtcdGetLeaderKeyOK = 28,
     EtcdObserverLeaderNotExist = 29,
     EtcdObjectLenNotEnough = 30,
+    EtcdWatchTimeout = 31,
+    EtcdWatchClosed = 32,
 };
 
 enum OpType {
@@ -93,6 +95,7 @@ import (
 	"strings"
 	"sync"
 	"time"
+	"unsafe"
 )
 
 const (
@@ -100,9 +103,11 @@ const (
 	EtcdPut        = "Put"
 	EtcdGet        = "Get"
 	EtcdList       = "List"
+	EtcdWatch      = "Watch"
 	EtcdDelete     = "Delete"
 	EtcdTxn2       = "Txn2"
 	EtcdTxn3       = "Txn3"
+	EtcdTxnN       = "TxnN"
 	EtcdCmpAndSwp  = "CmpAndSwp"
 	EtcdNewMutex   = "NewMutex"
 	EtcdNewSession = "NewSession"
@@ -331,6 +336,78 @@ func EtcdClientListWithLimitAndRevision(timeout C.uint, startKey, endKey *C.char
 	return errCode, AddManagedObject(resp.Kvs), len(resp.Kvs), resp.Header.Revision
 }
 
+// count the keys in [startKey, endKey) at revision, only keys modified at
+// or after minModRevision are counted if minModRevision > 0
+//export EtcdClientCountWithRevision
+func EtcdClientCountWithRevision(timeout C.uint, startKey, endKey *C.char,
+	startLen, endLen C.int, revision, minModRevision int64) (
+	C.enum_EtcdErrCode, int64) {
+	goStartKey := C.GoStringN(startKey, startLen)
+	goEndKey := C.GoStringN(endKey, endLen)
+	ctx, cancle := context.WithTimeout(context.Background(),
+		time.Duration(int(timeout))*time.Millisecond)
+	defer cancle()
+
+	ops := []clientv3.OpOption{
+		clientv3.WithRange(goEndKey),
+		clientv3.WithRev(revision)}
+	if minModRevision > 0 {
+		// the server counts before filtering by mod revision, so list
+		// the keys and count them here
+		ops = append(ops, clientv3.WithKeysOnly(),
+			clientv3.WithMinModRev(minModRevision))
+	} else {
+		ops = append(ops, clientv3.WithCountOnly())
+	}
+
+	resp, err := globalClient.Get(ctx, goStartKey, ops...)
+	errCode := GetErrCode(EtcdList, err)
+	if errCode != C.EtcdOK {
+		return errCode, 0
+	}
+	if minModRevision > 0 {
+		return errCode, int64(len(resp.Kvs))
+	}
+	return errCode, resp.Count
+}
+
+// watch changes of keys with the prefix since startRevision, return when
+// changes come, EtcdWatchTimeout if no change comes before timeout and
+// EtcdWatchClosed if the watch channel is closed
+//export EtcdClientWatch
+func EtcdClientWatch(timeout C.int, prefix *C.char, prefixLen C.int,
+	startRevision int64) (C.enum_EtcdErrCode, uint64, int) {
+	goPrefix := C.GoStringN(prefix, prefixLen)
+	ctx, cancel := context.WithTimeout(context.Background(),
+		time.Duration(int(timeout))*time.Millisecond)
+	defer cancel()
+
+	wch := globalClient.Watch(clientv3.WithRequireLeader(ctx), goPrefix,
+		clientv3.WithPrefix(), clientv3.WithRev(startRevision))
+	for {
+		select {
+		case <-ctx.Done():
+			return C.EtcdWatchTimeout, 0, 0
+		case wresp, ok := <-wch:
+			if !ok {
+				// the channel is also closed when ctx times out
+				if ctx.Err() == context.DeadlineExceeded {
+					return C.EtcdWatchTimeout, 0, 0
+				}
+				return C.EtcdWatchClosed, 0, 0
+			}
+			if err := wresp.Err(); err != nil {
+				return GetErrCode(EtcdWatch, err), 0, 0
+			}
+			count := len(wresp.Events)
+			if count == 0 {
+				continue
+			}
+			return C.EtcdOK, AddManagedObject(wresp.Events), count
+		}
+	}
+}
+
 //export EtcdClientDelete
 func EtcdClientDelete(
 	timeout C.int, key *C.char, keyLen C.int) C.enum_EtcdErrCode {
@@ -394,6 +471,28 @@ func EtcdClientTxn3(
 	return GetErrCode(EtcdTxn3, err)
 }
 
+//export EtcdClientTxnN
+func EtcdClientTxnN(timeout C.int, ops *C.struct_Operation,
+	opNum C.int) (C.enum_EtcdErrCode, int64) {
+	cops := (*[1 << 20]C.struct_Operation)(
+		unsafe.Pointer(ops))[:int(opNum):int(opNum)]
+	etcdOps, err := GenOpList(cops)
+	if err != nil {
+		log.Printf("unknown op types, err: %v", err)
+		return C.EtcdTxnUnkownOp, 0
+	}
+
+	ctx, cancel := context.WithTimeout(context.Background(),
+		time.Duration(int(timeout))*time.Millisecond)
+	defer cancel()
+
+	resp, err := globalClient.Txn(ctx).Then(etcdOps...).Commit()
+	if err == nil {
+		return GetErrCode(EtcdTxnN, err), resp.Header.Revision
+	}
+	return GetErrCode(EtcdTxnN, err), 0
+}
+
 //export EtcdClientCompareAndSwap
 func EtcdClientCompareAndSwap(timeout C.int, key, prev, target *C.char,
 	keyLen, preLen, targetLen C.int) C.enum_EtcdErrCode {
@@ -593,6 +692,29 @@ func EtcdClientGetMultiObject(
 	}
 }
 
+//export EtcdClientGetWatchEvent
+func EtcdClientGetWatchEvent(oid uint64, serial int) (C.enum_EtcdErrCode,
+	C.enum_OpType, *C.char, int, *C.char, int, int64) {
+	if value, exist := GetManagedObject(oid); !exist {
+		return C.EtcdObjectNotExist, 0, nil, 0, nil, 0, 0
+	} else if res, ok := value.([]*clientv3.Event); ok {
+		if serial >= len(res) {
+			return C.EtcdObjectLenNotEnough, 0, nil, 0, nil, 0, 0
+		}
+		opType := C.OpPut
+		if res[serial].Type == mvccpb.DELETE {
+			opType = C.OpDelete
+		}
+		kv := res[serial].Kv
+		return C.EtcdOK, C.enum_OpType(opType),
+			C.CString(string(kv.Value)), len(kv.Value),
+			C.CString(string(kv.Key)), len(kv.Key),
+			kv.ModRevision
+	} else {
+		return C.EtcdErrObjectType, 0, nil, 0, nil, 0, 0
+	}
+}
+
 //export EtcdClientRemoveObject
 func EtcdClientRemoveObject(oid uint64) {
 	RemoveManagedObject(oid)